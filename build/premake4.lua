@@ -179,6 +179,7 @@ project "steersimlib"
 		}
 		libdirs { "lib" }
 		links {
+			"GLEW",
 			"Xrandr",
 			"X11",
 			"dl",
@@ -700,6 +701,49 @@ project "steerbench"
 		}
 
 
+project "steertool"
+	language "C++"
+	kind "ConsoleApp"
+	includedirs { 
+		"../steerlib/include",
+		"../steertool/include",
+		"../external",
+		"../util/include" 
+	}
+	files { 
+		"../steertool/include/*.h",
+		"../steertool/src/*.cpp"
+	}
+	links { 		
+		"steerlib",
+		"util"
+	}
+
+	targetdir "bin"
+	buildoptions("-std=c++0x -ggdb" )	
+
+	-- linux library cflags and libs
+	configuration { "linux", "gmake" }
+		linkoptions { 
+			"-Wl,-rpath," .. path.getabsolute("lib") ,
+		}
+		links { 		
+			"dl",
+			"pthread",
+			"tinyxml"
+		}
+		libdirs { "lib" }
+
+	-- mac includes and libs
+	configuration { "macosx" }
+		buildoptions { "-Wunused-value -Wshadow -Wreorder -Wsign-compare -Wall" }
+		links { 
+			"dl",
+			"pthread",
+			"tinyxml"
+		}
+
+
 if file_exists("premake4-dev.lua")
 	then
 	dofile("premake4-dev.lua")
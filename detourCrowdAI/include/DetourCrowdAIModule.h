@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __DETOUR_CROWD_AI_MODULE_H__
+#define __DETOUR_CROWD_AI_MODULE_H__
+
+/// @file DetourCrowdAIModule.h
+/// @brief Declares the DetourCrowdAIModule plugin.
+
+#include <vector>
+#include "SteerLib.h"
+#include "Logger.h"
+#include "DetourCrowd_Parameters.h"
+#include "DetourCrowdNavMesh.h"
+#include "DetourCrowdAgent.h"
+
+class dtCrowd;
+
+/**
+ * @brief A plugin that steers agents with the dtCrowd of the Detour library, on a Recast navigation mesh.
+ *
+ * In preprocessSimulation() the module builds a navigation mesh of the ground and the static obstacles (see
+ * DetourCrowdNavMesh) and a dtCrowd on it.  Each DetourCrowdAgent is one agent of the crowd, and each goal becomes a
+ * move request to the nearest point of the mesh.  Every frame, preprocessFrame() updates the whole crowd at once:
+ * the path requests are answered by one shared path queue, the neighbors come from the crowd's proximity grid,
+ * and each agent follows its path corridor, which is only re-planned when it becomes invalid.  Agents of other
+ * modules are not part of the crowd, so the agents of this module do not avoid them.
+ *
+ * Options, all optional (e.g. -ai detourCrowdAI,avoidance_quality,1,separation,false):
+ *  - preferred_speed, max_acceleration, separation_weight: the steering of all agents.
+ *  - avoidance_quality: 0 to 3, the number of velocities sampled by the obstacle avoidance, as in the CrowdTool of
+ *    the navmeshBuilder (low, medium, good, high).
+ *  - anticipate_turns, optimize_visibility, optimize_topology, obstacle_avoidance, separation: the dtCrowd update
+ *    flags, all true by default except separation, as in the CrowdTool.  The separation pushes agents apart over
+ *    their whole collision query range, which can cancel the desired velocity of agents heading for the same spot.
+ *  - cell_size, cell_height, walkable_radius, walkable_height, walkable_climb: the navigation mesh.
+ *  - max_agents, max_agent_radius: the starting size of the crowd; it is rebuilt larger when needed.
+ *  - ailogFileName, stats: as for the other AI modules.
+ */
+class DetourCrowdAIModule : public SteerLib::ModuleInterface
+{
+public:
+	DetourCrowdAIModule();
+	~DetourCrowdAIModule();
+
+	std::string getDependencies() { return ""; }
+	std::string getConflicts() { return ""; }
+	std::string getData() { return _data; }
+	LogData * getLogData()
+	{
+		LogData * lD = new LogData();
+		lD->setLogger(this->_logger);
+		lD->setLogData(this->_logData);
+		return lD;
+	}
+	void init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo );
+	void finish();
+	SteerLib::AgentInterface * createAgent();
+	void destroyAgent( SteerLib::AgentInterface * agent );
+
+	void initializeSimulation();
+	void preprocessSimulation();
+	void preprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
+	void cleanupSimulation();
+
+	/// Returns the crowd agent of an agent of this module, or NULL if it is not in the crowd.
+	const struct dtCrowdAgent * getCrowdAgent(const DetourCrowdAgent * agent) const;
+	DetourCrowdNavMesh & getNavMesh() { return _navMesh; }
+
+protected:
+	/// Removes an agent from the crowd, e.g. when it is disabled.
+	void _removeFromCrowd(DetourCrowdAgent * agent);
+	/// Adds the enabled agents whose crowd state is out of date, sends agents with new goals on their way, and removes disabled agents.
+	void _synchronizeCrowd();
+	void _addToCrowd(DetourCrowdAgent * agent);
+	void _requestMoveTarget(DetourCrowdAgent * agent);
+	/// Pushes apart the agents of the crowd that still overlap after dtCrowd::update().
+	void _resolveOverlaps();
+	/// Creates a new dtCrowd of the given size; every agent is put back into it at the next _synchronizeCrowd().
+	void _createCrowd(int maxAgents, float maxAgentRadius);
+	void _destroyCrowd();
+
+	SteerLib::EngineInterface * _gEngine;
+	std::vector<DetourCrowdAgent*> _agents;
+
+	DetourCrowdNavMeshOptions _navMeshOptions;
+	DetourCrowdNavMesh _navMesh;
+	dtCrowd * _crowd;
+	int _crowdMaxAgents;
+	float _crowdMaxAgentRadius;
+	int _numCrowdAgents;
+	/// The half size of the box that goals are projected onto the navigation mesh from.
+	float _targetSearchExtents[3];
+	/// The active agents of the crowd and their displacements in one pass of _resolveOverlaps(), kept to avoid reallocating them every frame.
+	std::vector<struct dtCrowdAgent*> _activeCrowdAgents;
+	std::vector<float> _overlapDisplacements;
+
+	float _preferredSpeed;
+	float _maxAcceleration;
+	float _separationWeight;
+	unsigned char _avoidanceQuality;
+	unsigned char _updateFlags;
+
+	/// Times the batched crowd updates of preprocessFrame(); updateAI() only copies the results.
+	Util::PerformanceProfiler _crowdUpdateProfiler;
+
+	std::string logFilename;
+	bool logStats;
+	bool _showStats;
+	Logger * _logger;
+	std::vector<LogObject *> _logData;
+	std::string _data;
+
+	friend class DetourCrowdAgent;
+};
+
+#endif
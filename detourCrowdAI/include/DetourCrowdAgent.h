@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __DETOUR_CROWD_AGENT_H__
+#define __DETOUR_CROWD_AGENT_H__
+
+/// @file DetourCrowdAgent.h
+/// @brief Declares the DetourCrowdAgent class.
+
+#include <queue>
+#include "SteerLib.h"
+
+class DetourCrowdAIModule;
+
+/**
+ * @brief An agent of the detourCrowdAI plugin, steered by a Detour dtCrowd.
+ *
+ * The agent does not steer itself.  DetourCrowdAIModule::preprocessFrame() moves all agents of the module at once
+ * with dtCrowd::update(), which follows each agent's path corridor on the navigation mesh and avoids the other
+ * agents with the sampling of dtObstacleAvoidanceQuery.  updateAI() then only copies the new position and velocity
+ * of the agent from the crowd into the spatial database, and moves on to the next goal when the agent arrives.
+ *
+ * This class is instantiated when the engine calls DetourCrowdAIModule::createAgent().
+ */
+class DetourCrowdAgent : public SteerLib::AgentInterface
+{
+public:
+	DetourCrowdAgent(DetourCrowdAIModule * module, SteerLib::EngineInterface * engineInfo, size_t id);
+	~DetourCrowdAgent();
+	void reset(const SteerLib::AgentInitialConditions & initialConditions, SteerLib::EngineInterface * engineInfo);
+	void updateAI(float timeStamp, float dt, unsigned int frameNumber);
+	void disable();
+	void draw();
+
+	bool enabled() const { return _enabled; }
+	Util::Point position() const { return _position; }
+	Util::Vector forward() const { return _forward; }
+	Util::Vector velocity() const { return _velocity; }
+	float radius() const { return _radius; }
+	const SteerLib::AgentGoalInfo & currentGoal() const { return _goalQueue.front(); }
+	size_t id() const { return _id; }
+	const std::queue<SteerLib::AgentGoalInfo> & agentGoals() const { return _goalQueue; }
+	void addGoal(const SteerLib::AgentGoalInfo & newGoal);
+	void clearGoals();
+	void setParameters(SteerLib::Behaviour behave) { }
+	void restoreState(SteerLib::SimulationStateReader & reader);
+
+	/// @name The SteerLib::SpatialDatabaseItemInterface
+	/// @brief These functions are required so that the agent can be used by the SteerLib::SpatialDataBaseInterface spatial database;
+	/// The Util namespace helper functions do the job nicely for basic circular agents.
+	//@{
+	bool intersects(const Util::Ray &r, float &t) { return Util::rayIntersectsCircle2D(_position, _radius, r, t); }
+	bool overlaps(const Util::Point & p, float radius) { return Util::circleOverlapsCircle2D( _position, _radius, p, radius); }
+	float computePenetration(const Util::Point & p, float radius) { return Util::computeCircleCirclePenetration2D( _position, _radius, p, radius); }
+	//@}
+
+	/// The index of this agent in the module's dtCrowd, or -1 if it is not in the crowd.
+	int getCrowdIndex() const { return _crowdIndex; }
+
+protected:
+	virtual SteerLib::EngineInterface * getSimulationEngine() { return _gEngine; }
+
+	DetourCrowdAIModule * _module;
+	SteerLib::EngineInterface * _gEngine;
+	/// Set by DetourCrowdAIModule; -1 while the agent is not in the crowd.
+	int _crowdIndex;
+	/// True if the crowd must (re)place this agent at _position and send it to the current goal, e.g. after reset() or restoreState().
+	bool _crowdOutOfDate;
+	/// True if the crowd must send this agent to the current goal, after the goal changed.
+	bool _goalOutOfDate;
+	/// The point on the navigation mesh that the crowd steers towards for the current goal.
+	Util::Point _crowdTarget;
+
+	friend class DetourCrowdAIModule;
+};
+
+#endif
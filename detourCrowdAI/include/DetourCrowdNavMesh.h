@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __DETOUR_CROWD_NAV_MESH_H__
+#define __DETOUR_CROWD_NAV_MESH_H__
+
+/// @file DetourCrowdNavMesh.h
+/// @brief Declares the DetourCrowdNavMesh class, the navigation mesh of the detourCrowdAI plugin.
+
+#include <vector>
+#include "SteerLib.h"
+
+class dtNavMesh;
+class dtNavMeshQuery;
+
+/// The options of a DetourCrowdNavMesh, in world units; the constructor sets the defaults.
+struct DetourCrowdNavMeshOptions {
+	DetourCrowdNavMeshOptions();
+	/// The size of the voxels that the geometry is rasterized into; smaller cells follow the obstacles more closely, but take longer to build.
+	float cellSize;
+	float cellHeight;
+	/// The walkable area is shrunk by this distance from the obstacles, so that agents of this radius can stand anywhere on the mesh.
+	float walkableRadius;
+	float walkableHeight;
+	/// The highest step that agents can take; surfaces higher than this above the ground, such as the tops of obstacles, are not walkable.
+	float walkableClimb;
+	float maxEdgeLength;
+	float maxEdgeError;
+	int minRegionSize;
+	int mergeRegionSize;
+	/// The size of the node pool of the query used to find goals on the mesh.
+	int maxSearchNodes;
+};
+
+/**
+ * @brief A Detour navigation mesh of the ground plane and the static obstacles of a SteerSuite simulation.
+ *
+ * The mesh is built by Recast in one tile, the same way as the Sample_SoloMesh of the navmeshBuilder, but without
+ * any of the debug drawing or GUI of that tool, so it can run in steersim -commandline.  The input is the geometry
+ * returned by SteerLib::EngineInterface::getStaticGeometry().
+ */
+class DetourCrowdNavMesh
+{
+public:
+	DetourCrowdNavMesh();
+	~DetourCrowdNavMesh();
+
+	/// Builds the mesh from triangles given as triples of indices into vertices; throws a Util::GenericException if Recast or Detour fail.
+	void build(const std::vector<Util::Point> & vertices, const std::vector<size_t> & triangles, const DetourCrowdNavMeshOptions & options);
+	/// Frees the mesh; getNavMesh() returns NULL until the next build().
+	void clear();
+
+	dtNavMesh * getNavMesh() { return _navMesh; }
+	/// A query on the mesh for the module's own searches; dtCrowd keeps a separate one.
+	dtNavMeshQuery * getNavMeshQuery() { return _navQuery; }
+	int getNumPolygons() const { return _numPolygons; }
+	/// Returns the time taken by the last build(), in seconds.
+	float getBuildTime() const { return _buildTime; }
+
+protected:
+	dtNavMesh * _navMesh;
+	dtNavMeshQuery * _navQuery;
+	int _numPolygons;
+	float _buildTime;
+
+private:
+	DetourCrowdNavMesh(const DetourCrowdNavMesh & );  // not implemented, not copyable
+	DetourCrowdNavMesh& operator= (const DetourCrowdNavMesh & );  // not implemented, not assignable
+};
+
+#endif
@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __DETOUR_CROWD_PARAMETERS_H__
+#define __DETOUR_CROWD_PARAMETERS_H__
+
+/// @file DetourCrowd_Parameters.h
+/// @brief The default values of the detourCrowdAI options.
+
+// the navigation mesh; see DetourCrowdNavMeshOptions.
+#define DEFAULT_DETOUR_CELL_SIZE 0.25f
+#define DEFAULT_DETOUR_CELL_HEIGHT 0.1f
+#define DEFAULT_DETOUR_WALKABLE_RADIUS 0.5f
+#define DEFAULT_DETOUR_WALKABLE_HEIGHT 1.0f
+#define DEFAULT_DETOUR_WALKABLE_CLIMB 0.2f
+#define DEFAULT_DETOUR_MAX_EDGE_LENGTH 12.0f
+#define DEFAULT_DETOUR_MAX_EDGE_ERROR 1.3f
+#define DEFAULT_DETOUR_MIN_REGION_SIZE 8
+#define DEFAULT_DETOUR_MERGE_REGION_SIZE 20
+#define DEFAULT_DETOUR_MAX_SEARCH_NODES 2048
+
+// the crowd; it grows as needed, so these only set the starting sizes.
+#define DEFAULT_DETOUR_MAX_AGENTS 256
+#define DEFAULT_DETOUR_MAX_AGENT_RADIUS 1.0f
+
+// the agents.
+#define DEFAULT_DETOUR_PREFERRED_SPEED 1.33f
+#define DEFAULT_DETOUR_MAX_ACCELERATION 8.0f
+#define DEFAULT_DETOUR_COLLISION_QUERY_MULTIPLIER 4.0f
+#define DEFAULT_DETOUR_PATH_OPTIMIZATION_MULTIPLIER 30.0f
+#define DEFAULT_DETOUR_SEPARATION_WEIGHT 2.0f
+#define DEFAULT_DETOUR_AVOIDANCE_QUALITY 3
+
+// an agent has reached a goal when it is within this many radii of the goal, or of the point on the
+// navigation mesh nearest to the goal; the same as the sfAI, so that the two can be compared on the same test cases.
+// it is larger than the distance at which dtCrowd starts to slow agents down before the end of their path.
+#define DETOUR_GOAL_THRESHOLD_MULTIPLIER 2.5f
+
+// the number of passes that push overlapping agents apart after each crowd update, on top of the collision
+// resolution of dtCrowd; see DetourCrowdAIModule::_resolveOverlaps().  very dense scenes (hundreds of agents
+// queued at a bottleneck) can still pack more agents into a cell than maxItemsPerGridCell allows.
+#define DETOUR_OVERLAP_ITERATIONS 4
+
+#endif
@@ -0,0 +1,516 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file DetourCrowdAIModule.cpp
+/// @brief Implements the DetourCrowdAIModule plugin.
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "SteerLib.h"
+#include "SimulationPlugin.h"
+#include "DetourCrowdAIModule.h"
+#include "DetourCrowdAgent.h"
+#include "DetourCrowd.h"
+#include "DetourCommon.h"
+#include "DetourNavMeshQuery.h"
+
+#include "LogObject.h"
+#include "LogManager.h"
+
+// the number of obstacle avoidance configurations, set up as in the CrowdTool of the navmeshBuilder.
+#define DETOUR_NUM_AVOIDANCE_QUALITIES 4
+
+// goals are projected onto the navigation mesh from this far away, horizontally, e.g. from inside an obstacle.
+#define DETOUR_TARGET_SEARCH_EXTENT 5.0f
+
+
+PLUGIN_API SteerLib::ModuleInterface * createModule()
+{
+	return new DetourCrowdAIModule;
+}
+
+PLUGIN_API void destroyModule( SteerLib::ModuleInterface*  module )
+{
+	delete module;
+}
+
+
+DetourCrowdAIModule::DetourCrowdAIModule()
+{
+	_gEngine = NULL;
+	_crowd = NULL;
+	_crowdMaxAgents = DEFAULT_DETOUR_MAX_AGENTS;
+	_crowdMaxAgentRadius = DEFAULT_DETOUR_MAX_AGENT_RADIUS;
+	_numCrowdAgents = 0;
+	_logger = NULL;
+}
+
+DetourCrowdAIModule::~DetourCrowdAIModule()
+{
+	_destroyCrowd();
+}
+
+
+void DetourCrowdAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo )
+{
+	_gEngine = engineInfo;
+
+	_preferredSpeed = DEFAULT_DETOUR_PREFERRED_SPEED;
+	_maxAcceleration = DEFAULT_DETOUR_MAX_ACCELERATION;
+	_separationWeight = DEFAULT_DETOUR_SEPARATION_WEIGHT;
+	_crowdMaxAgents = DEFAULT_DETOUR_MAX_AGENTS;
+	_crowdMaxAgentRadius = DEFAULT_DETOUR_MAX_AGENT_RADIUS;
+	logFilename = "detourCrowdAI.log";
+	logStats = false;
+	_showStats = false;
+
+	unsigned int avoidanceQuality = DEFAULT_DETOUR_AVOIDANCE_QUALITY;
+	bool anticipateTurns = true;
+	bool optimizeVisibility = true;
+	bool optimizeTopology = true;
+	bool obstacleAvoidance = true;
+	bool separation = false;
+
+	SteerLib::OptionDictionary::const_iterator optionIter;
+	for (optionIter = options.begin(); optionIter != options.end(); ++optionIter) {
+		std::stringstream value((*optionIter).second);
+		if ((*optionIter).first == "preferred_speed") {
+			value >> _preferredSpeed;
+		}
+		else if ((*optionIter).first == "max_acceleration") {
+			value >> _maxAcceleration;
+		}
+		else if ((*optionIter).first == "separation_weight") {
+			value >> _separationWeight;
+		}
+		else if ((*optionIter).first == "avoidance_quality") {
+			value >> avoidanceQuality;
+		}
+		else if ((*optionIter).first == "anticipate_turns") {
+			anticipateTurns = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "optimize_visibility") {
+			optimizeVisibility = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "optimize_topology") {
+			optimizeTopology = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "obstacle_avoidance") {
+			obstacleAvoidance = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "separation") {
+			separation = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "cell_size") {
+			value >> _navMeshOptions.cellSize;
+		}
+		else if ((*optionIter).first == "cell_height") {
+			value >> _navMeshOptions.cellHeight;
+		}
+		else if ((*optionIter).first == "walkable_radius") {
+			value >> _navMeshOptions.walkableRadius;
+		}
+		else if ((*optionIter).first == "walkable_height") {
+			value >> _navMeshOptions.walkableHeight;
+		}
+		else if ((*optionIter).first == "walkable_climb") {
+			value >> _navMeshOptions.walkableClimb;
+		}
+		else if ((*optionIter).first == "max_agents") {
+			value >> _crowdMaxAgents;
+		}
+		else if ((*optionIter).first == "max_agent_radius") {
+			value >> _crowdMaxAgentRadius;
+		}
+		else if ((*optionIter).first == "ailogFileName") {
+			logFilename = value.str();
+			logStats = true;
+		}
+		else if ((*optionIter).first == "stats") {
+			_showStats = Util::getBoolFromString(value.str());
+		}
+		else {
+			throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to detourCrowdAI module.");
+		}
+	}
+
+	if (avoidanceQuality >= DETOUR_NUM_AVOIDANCE_QUALITIES) {
+		throw Util::GenericException("detourCrowdAI: avoidance_quality must be between 0 and " + Util::toString(DETOUR_NUM_AVOIDANCE_QUALITIES-1) + ".");
+	}
+	if (_crowdMaxAgents <= 0 || _crowdMaxAgentRadius <= 0.0f) {
+		throw Util::GenericException("detourCrowdAI: max_agents and max_agent_radius must be positive.");
+	}
+	_avoidanceQuality = (unsigned char)avoidanceQuality;
+
+	_updateFlags = 0;
+	if (anticipateTurns) _updateFlags |= DT_CROWD_ANTICIPATE_TURNS;
+	if (optimizeVisibility) _updateFlags |= DT_CROWD_OPTIMIZE_VIS;
+	if (optimizeTopology) _updateFlags |= DT_CROWD_OPTIMIZE_TOPO;
+	if (obstacleAvoidance) _updateFlags |= DT_CROWD_OBSTACLE_AVOIDANCE;
+	if (separation) _updateFlags |= DT_CROWD_SEPARATION;
+
+	_targetSearchExtents[0] = DETOUR_TARGET_SEARCH_EXTENT;
+	_targetSearchExtents[1] = _navMeshOptions.walkableHeight;
+	_targetSearchExtents[2] = DETOUR_TARGET_SEARCH_EXTENT;
+
+	_logger = LogManager::getInstance()->createLogger(logFilename,LoggerType::BASIC_WRITE);
+
+	_logger->addDataField("number_of_times_executed",DataType::LongLong );
+	_logger->addDataField("total_ticks_accumulated",DataType::LongLong );
+	_logger->addDataField("shortest_execution",DataType::LongLong );
+	_logger->addDataField("longest_execution",DataType::LongLong );
+	_logger->addDataField("fastest_execution", DataType::Float);
+	_logger->addDataField("slowest_execution", DataType::Float);
+	_logger->addDataField("average_time_per_call", DataType::Float);
+	_logger->addDataField("total_time_of_all_calls", DataType::Float);
+	_logger->addDataField("tick_frequency", DataType::Float);
+
+	if( logStats )
+	{
+		// write the labels of each field
+		std::stringstream labelStream;
+		unsigned int i;
+		for (i=0; i < _logger->getNumberOfFields() - 1; i++)
+			labelStream << _logger->getFieldName(i) << " ";
+		labelStream << _logger->getFieldName(i);
+		_data = labelStream.str() + "\n";
+
+		_logger->writeData(labelStream.str());
+	}
+}
+
+void DetourCrowdAIModule::finish()
+{
+	_destroyCrowd();
+	_navMesh.clear();
+}
+
+SteerLib::AgentInterface * DetourCrowdAIModule::createAgent()
+{
+	DetourCrowdAgent * agent = new DetourCrowdAgent(this, _gEngine, _agents.size());
+	_agents.push_back(agent);
+	return agent;
+}
+
+void DetourCrowdAIModule::destroyAgent( SteerLib::AgentInterface * agent )
+{
+	DetourCrowdAgent * crowdAgent = dynamic_cast<DetourCrowdAgent*>(agent);
+	if (crowdAgent != NULL) {
+		_removeFromCrowd(crowdAgent);
+		std::vector<DetourCrowdAgent*>::iterator iter = std::find(_agents.begin(), _agents.end(), crowdAgent);
+		if (iter != _agents.end()) {
+			_agents.erase(iter);
+		}
+	}
+	delete agent;
+}
+
+void DetourCrowdAIModule::initializeSimulation()
+{
+	_crowdUpdateProfiler.reset();
+}
+
+void DetourCrowdAIModule::preprocessSimulation()
+{
+	// the obstacles of the test case exist by now, and the agents are reset right after this.
+	std::pair<std::vector<Util::Point>,std::vector<size_t> > geometry = _gEngine->getStaticGeometry();
+	_navMesh.build(geometry.first, geometry.second, _navMeshOptions);
+	if (_showStats) {
+		std::cout << "detourCrowdAI: built a navigation mesh of " << _navMesh.getNumPolygons() << " polygons in " << _navMesh.getBuildTime() << " seconds." << std::endl;
+	}
+
+	_createCrowd(std::max(_crowdMaxAgents, (int)_agents.size()), _crowdMaxAgentRadius);
+}
+
+void DetourCrowdAIModule::preprocessFrame(float timeStamp, float dt, unsigned int frameNumber)
+{
+	if (_crowd == NULL) {
+		return;
+	}
+
+	Util::AutomaticFunctionProfiler profileThisFunction( &_crowdUpdateProfiler );
+	_synchronizeCrowd();
+	if (_numCrowdAgents > 0) {
+		_crowd->update(dt, NULL);
+		_resolveOverlaps();
+	}
+}
+
+void DetourCrowdAIModule::cleanupSimulation()
+{
+	LogObject logObject;
+
+	logObject.addLogData(_crowdUpdateProfiler.getNumTimesExecuted());
+	logObject.addLogData(_crowdUpdateProfiler.getTotalTicksAccumulated());
+	logObject.addLogData(_crowdUpdateProfiler.getMinTicks());
+	logObject.addLogData(_crowdUpdateProfiler.getMaxTicks());
+	logObject.addLogData(_crowdUpdateProfiler.getMinExecutionTimeMills());
+	logObject.addLogData(_crowdUpdateProfiler.getMaxExecutionTimeMills());
+	logObject.addLogData(_crowdUpdateProfiler.getAverageExecutionTimeMills());
+	logObject.addLogData(_crowdUpdateProfiler.getTotalTime());
+	logObject.addLogData(_crowdUpdateProfiler.getTickFrequency());
+
+	_data = _data + _logger->logObjectToString(logObject);
+	_logData.push_back(logObject.copy());
+	if ( logStats )
+	{
+		_logger->writeLogObject(logObject);
+	}
+	if ( _showStats )
+	{
+		std::cout << "detourCrowdAI: " << _crowdUpdateProfiler.getNumTimesExecuted() << " crowd updates, " << _crowdUpdateProfiler.getAverageExecutionTimeMills() << " ms on average." << std::endl;
+	}
+	_crowdUpdateProfiler.reset();
+
+	// the agents are destroyed by the engine after this; the crowd is rebuilt with the next navigation mesh.
+	_destroyCrowd();
+	_navMesh.clear();
+}
+
+const dtCrowdAgent * DetourCrowdAIModule::getCrowdAgent(const DetourCrowdAgent * agent) const
+{
+	if (_crowd == NULL || agent->_crowdIndex < 0) {
+		return NULL;
+	}
+	return _crowd->getAgent(agent->_crowdIndex);
+}
+
+
+//
+// _synchronizeCrowd() - brings the crowd up to date with the agents, which may have been reset, disabled, restored
+//                       from a snapshot or given new goals since the last frame.
+//
+void DetourCrowdAIModule::_synchronizeCrowd()
+{
+	int numEnabledAgents = 0;
+	float maxAgentRadius = 0.0f;
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		if (_agents[i]->enabled()) {
+			numEnabledAgents++;
+			maxAgentRadius = std::max(maxAgentRadius, _agents[i]->radius());
+		}
+	}
+	if (numEnabledAgents > _crowdMaxAgents || maxAgentRadius > _crowdMaxAgentRadius) {
+		_createCrowd(std::max(numEnabledAgents, 2 * _crowdMaxAgents), std::max(maxAgentRadius, _crowdMaxAgentRadius));
+	}
+
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		DetourCrowdAgent * agent = _agents[i];
+		if (!agent->enabled()) {
+			_removeFromCrowd(agent);
+		}
+		else if (agent->_crowdOutOfDate || agent->_crowdIndex < 0) {
+			_removeFromCrowd(agent);
+			_addToCrowd(agent);
+		}
+		else if (agent->_goalOutOfDate) {
+			_requestMoveTarget(agent);
+		}
+	}
+}
+
+void DetourCrowdAIModule::_addToCrowd(DetourCrowdAgent * agent)
+{
+	dtCrowdAgentParams params;
+	memset(&params, 0, sizeof(params));
+	params.radius = agent->radius();
+	params.height = _navMeshOptions.walkableHeight;
+	params.maxAcceleration = _maxAcceleration;
+	params.maxSpeed = _preferredSpeed;
+	params.collisionQueryRange = agent->radius() * DEFAULT_DETOUR_COLLISION_QUERY_MULTIPLIER;
+	params.pathOptimizationRange = agent->radius() * DEFAULT_DETOUR_PATH_OPTIMIZATION_MULTIPLIER;
+	params.separationWeight = _separationWeight;
+	params.updateFlags = _updateFlags;
+	params.obstacleAvoidanceType = _avoidanceQuality;
+	params.queryFilterType = 0;
+	params.userData = agent;
+
+	const Util::Point position = agent->position();
+	const float pos[3] = { position.x, position.y, position.z };
+	int crowdIndex = _crowd->addAgent(pos, &params);
+	if (crowdIndex < 0) {
+		throw Util::GenericException("detourCrowdAI: could not add an agent to the crowd of " + Util::toString(_crowdMaxAgents) + " agents.");
+	}
+	_numCrowdAgents++;
+
+	agent->_crowdIndex = crowdIndex;
+	agent->_crowdOutOfDate = false;
+	_requestMoveTarget(agent);
+}
+
+void DetourCrowdAIModule::_removeFromCrowd(DetourCrowdAgent * agent)
+{
+	if (agent->_crowdIndex >= 0) {
+		if (_crowd != NULL) {
+			_crowd->removeAgent(agent->_crowdIndex);
+			_numCrowdAgents--;
+		}
+		agent->_crowdIndex = -1;
+	}
+}
+
+//
+// _requestMoveTarget() - sends an agent of the crowd to the point of the navigation mesh nearest to its current goal.
+//
+void DetourCrowdAIModule::_requestMoveTarget(DetourCrowdAgent * agent)
+{
+	agent->_goalOutOfDate = false;
+	if (agent->agentGoals().empty()) {
+		_crowd->resetMoveTarget(agent->_crowdIndex);
+		return;
+	}
+
+	const Util::Point goal = agent->currentGoal().targetLocation;
+	const float goalPos[3] = { goal.x, goal.y, goal.z };
+	float target[3];
+	dtPolyRef targetRef = 0;
+	dtStatus status = _navMesh.getNavMeshQuery()->findNearestPoly(goalPos, _targetSearchExtents, _crowd->getFilter(0), &targetRef, target);
+	if (dtStatusFailed(status) || targetRef == 0) {
+		// the goal is too far from the navigation mesh; the agent waits where it is.
+		_crowd->resetMoveTarget(agent->_crowdIndex);
+		agent->_crowdTarget = goal;
+		return;
+	}
+
+	_crowd->requestMoveTarget(agent->_crowdIndex, targetRef, target);
+	agent->_crowdTarget = Util::Point(target[0], target[1], target[2]);
+}
+
+//
+// _resolveOverlaps() - dtCrowd resolves collisions with at most DT_CROWDAGENT_MAX_NEIGHBOURS neighbors of each agent and
+//                      averages their pushes, so in a jam the agents in the middle are pushed from all sides at once,
+//                      do not move, and the crowd keeps walking into them.  Here every overlapping pair pushes, and the
+//                      pushes add up, so that a jam spreads out instead; the agents are then moved back onto the mesh.
+//
+void DetourCrowdAIModule::_resolveOverlaps()
+{
+	// the proximity grid of the crowd refers to the agents by their place in the list of active agents.
+	_activeCrowdAgents.resize(_crowd->getAgentCount());
+	const int numAgents = _crowd->getActiveAgents(&_activeCrowdAgents[0], (int)_activeCrowdAgents.size());
+	const dtProximityGrid * grid = _crowd->getGrid();
+	_overlapDisplacements.assign(3 * numAgents, 0.0f);
+
+	// the grid holds the positions from before the update, so the query range allows for how far the agents moved since.
+	static const int MAX_OVERLAP_CANDIDATES = 64;
+	unsigned short candidates[MAX_OVERLAP_CANDIDATES];
+	const float queryRange = 2.5f * _crowdMaxAgentRadius;
+
+	bool anyOverlap = false;
+	for (int iter = 0; iter < DETOUR_OVERLAP_ITERATIONS; iter++) {
+		bool overlap = false;
+		for (int i = 0; i < numAgents; i++) {
+			const dtCrowdAgent * ag = _activeCrowdAgents[i];
+			float * disp = &_overlapDisplacements[3*i];
+			dtVset(disp, 0.0f, 0.0f, 0.0f);
+			if (ag->state != DT_CROWDAGENT_STATE_WALKING) {
+				continue;
+			}
+
+			const int numCandidates = grid->queryItems(ag->npos[0] - queryRange, ag->npos[2] - queryRange,
+					ag->npos[0] + queryRange, ag->npos[2] + queryRange, candidates, MAX_OVERLAP_CANDIDATES);
+			for (int j = 0; j < numCandidates; j++) {
+				const dtCrowdAgent * nei = _activeCrowdAgents[candidates[j]];
+				if (nei == ag || nei->state != DT_CROWDAGENT_STATE_WALKING) {
+					continue;
+				}
+				float diff[3];
+				dtVsub(diff, ag->npos, nei->npos);
+				diff[1] = 0.0f;
+				const float minDist = ag->params.radius + nei->params.radius;
+				const float distSqr = dtVlenSqr(diff);
+				if (distSqr >= minDist * minDist) {
+					continue;
+				}
+				const float dist = sqrtf(distSqr);
+				if (dist < 0.0001f) {
+					// on top of each other; the two agents step to opposite sides of where they are going.
+					dtVset(diff, ag->dvel[2], 0.0f, -ag->dvel[0]);
+					if (dtVlenSqr(diff) < 0.0001f) {
+						dtVset(diff, 1.0f, 0.0f, 0.0f);
+					}
+					if (i > candidates[j]) {
+						dtVscale(diff, diff, -1.0f);
+					}
+					dtVnormalize(diff);
+					dtVmad(disp, disp, diff, 0.5f * minDist);
+				}
+				else {
+					dtVmad(disp, disp, diff, 0.5f * (minDist - dist) / dist);
+				}
+				overlap = true;
+			}
+
+			// an agent pushed from many sides at once moves at most its radius per pass.
+			const float len = dtVlen(disp);
+			if (len > ag->params.radius) {
+				dtVscale(disp, disp, ag->params.radius / len);
+			}
+		}
+		if (!overlap) {
+			break;
+		}
+		anyOverlap = true;
+
+		for (int i = 0; i < numAgents; i++) {
+			dtVadd(_activeCrowdAgents[i]->npos, _activeCrowdAgents[i]->npos, &_overlapDisplacements[3*i]);
+		}
+	}
+
+	if (!anyOverlap) {
+		return;
+	}
+	for (int i = 0; i < numAgents; i++) {
+		dtCrowdAgent * ag = _activeCrowdAgents[i];
+		if (ag->state == DT_CROWDAGENT_STATE_WALKING) {
+			ag->corridor.movePosition(ag->npos, _navMesh.getNavMeshQuery(), _crowd->getFilter(0));
+			dtVcopy(ag->npos, ag->corridor.getPos());
+		}
+	}
+}
+
+void DetourCrowdAIModule::_createCrowd(int maxAgents, float maxAgentRadius)
+{
+	_destroyCrowd();
+
+	_crowd = dtAllocCrowd();
+	if (_crowd == NULL || !_crowd->init(maxAgents, maxAgentRadius, _navMesh.getNavMesh())) {
+		_destroyCrowd();
+		throw Util::GenericException("detourCrowdAI: could not create a crowd of " + Util::toString(maxAgents) + " agents.");
+	}
+	_crowdMaxAgents = maxAgents;
+	_crowdMaxAgentRadius = maxAgentRadius;
+
+	// low, medium, good and high quality obstacle avoidance, from 11 to 66 sampled velocities per agent.
+	static const unsigned char adaptiveDivs[DETOUR_NUM_AVOIDANCE_QUALITIES] = { 5, 5, 7, 7 };
+	static const unsigned char adaptiveRings[DETOUR_NUM_AVOIDANCE_QUALITIES] = { 2, 2, 2, 3 };
+	static const unsigned char adaptiveDepth[DETOUR_NUM_AVOIDANCE_QUALITIES] = { 1, 2, 3, 3 };
+	dtObstacleAvoidanceParams params;
+	memcpy(&params, _crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+	for (int i = 0; i < DETOUR_NUM_AVOIDANCE_QUALITIES; i++) {
+		params.velBias = 0.5f;
+		params.adaptiveDivs = adaptiveDivs[i];
+		params.adaptiveRings = adaptiveRings[i];
+		params.adaptiveDepth = adaptiveDepth[i];
+		_crowd->setObstacleAvoidanceParams(i, &params);
+	}
+
+	// every agent is added to the new crowd at the next frame.
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		_agents[i]->_crowdIndex = -1;
+		_agents[i]->_crowdOutOfDate = true;
+	}
+}
+
+void DetourCrowdAIModule::_destroyCrowd()
+{
+	dtFreeCrowd(_crowd);
+	_crowd = NULL;
+	_numCrowdAgents = 0;
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		_agents[i]->_crowdIndex = -1;
+	}
+}
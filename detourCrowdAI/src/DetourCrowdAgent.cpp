@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file DetourCrowdAgent.cpp
+/// @brief Implements the DetourCrowdAgent class.
+
+#include "DetourCrowdAgent.h"
+#include "DetourCrowdAIModule.h"
+#include "DetourCrowd.h"
+
+using namespace Util;
+using namespace SteerLib;
+
+
+DetourCrowdAgent::DetourCrowdAgent(DetourCrowdAIModule * module, SteerLib::EngineInterface * engineInfo, size_t id)
+{
+	_module = module;
+	_gEngine = engineInfo;
+	_id = id;
+	_enabled = false;
+	_radius = 0.0f;
+	_crowdIndex = -1;
+	_crowdOutOfDate = true;
+	_goalOutOfDate = false;
+}
+
+DetourCrowdAgent::~DetourCrowdAgent()
+{
+}
+
+void DetourCrowdAgent::disable()
+{
+	// if we tried to disable a second time, most likely we accidentally ignored that it was disabled, and should catch that error.
+	assert(_enabled==true);
+
+	//  1. remove from database
+	AxisAlignedBox b = AxisAlignedBox(_position.x - _radius, _position.x + _radius, 0.0f, 0.0f, _position.z - _radius, _position.z + _radius);
+	getSimulationEngine()->getSpatialDatabase()->removeObject(dynamic_cast<SpatialDatabaseItemPtr>(this), b);
+
+	//  2. set enabled = false
+	_enabled = false;
+
+	//  3. free the agent's place in the crowd
+	_module->_removeFromCrowd(this);
+}
+
+void DetourCrowdAgent::reset(const SteerLib::AgentInitialConditions & initialConditions, SteerLib::EngineInterface * engineInfo)
+{
+	// compute the "old" bounding box of the agent before it is reset.  its OK that it will be invalid if the agent was previously disabled
+	// because the value is not used in that case.
+	Util::AxisAlignedBox oldBounds(_position.x-_radius, _position.x+_radius, 0.0f, 0.0f, _position.z-_radius, _position.z+_radius);
+
+	if ( initialConditions.colorSet == true )
+	{
+		this->_color = initialConditions.color;
+	}
+	else
+	{
+		this->_color = Util::gBlue;
+	}
+
+	_position = initialConditions.position;
+	_forward = normalize(initialConditions.direction);
+	_radius = initialConditions.radius;
+	_velocity = initialConditions.speed * _forward;
+
+	// compute the "new" bounding box of the agent
+	Util::AxisAlignedBox newBounds(_position.x-_radius, _position.x+_radius, 0.0f, 0.0f, _position.z-_radius, _position.z+_radius);
+
+	if (!_enabled) {
+		// if the agent was not enabled, then it does not already exist in the database, so add it.
+		getSimulationEngine()->getSpatialDatabase()->addObject( dynamic_cast<SpatialDatabaseItemPtr>(this), newBounds);
+	}
+	else {
+		// if the agent was enabled, then the agent already existed in the database, so update it instead of adding it.
+		getSimulationEngine()->getSpatialDatabase()->updateObject( dynamic_cast<SpatialDatabaseItemPtr>(this), oldBounds, newBounds);
+	}
+
+	_enabled = true;
+
+	if (initialConditions.goals.size() == 0)
+	{
+		throw Util::GenericException("No goals were specified!\n");
+	}
+
+	while (!_goalQueue.empty())
+	{
+		_goalQueue.pop();
+	}
+
+	// iterate over the sequence of goals specified by the initial conditions.
+	for (unsigned int i=0; i<initialConditions.goals.size(); i++) {
+		if (initialConditions.goals[i].goalType == SteerLib::GOAL_TYPE_SEEK_STATIC_TARGET ||
+				initialConditions.goals[i].goalType == SteerLib::GOAL_TYPE_AXIS_ALIGNED_BOX_GOAL)
+		{
+			SteerLib::AgentGoalInfo goal = initialConditions.goals[i];
+			if (goal.targetIsRandom)
+			{
+				// if the goal is random, we must randomly generate the goal.
+				goal.targetLocation = getSimulationEngine()->getSpatialDatabase()->randomPositionWithoutCollisions(1.0f, true);
+			}
+			_goalQueue.push(goal);
+		}
+		else {
+			throw Util::GenericException("Unsupported goal type; DetourCrowdAgent only supports GOAL_TYPE_SEEK_STATIC_TARGET and GOAL_TYPE_AXIS_ALIGNED_BOX_GOAL.");
+		}
+	}
+
+	// the module (re)places the agent in the crowd at the start of the next frame.
+	_crowdOutOfDate = true;
+	_goalOutOfDate = false;
+
+	assert(_forward.length()!=0.0f);
+	assert(_goalQueue.size() != 0);
+	assert(_radius != 0.0f);
+}
+
+void DetourCrowdAgent::addGoal(const SteerLib::AgentGoalInfo & newGoal)
+{
+	if (newGoal.goalType != SteerLib::GOAL_TYPE_SEEK_STATIC_TARGET &&
+			newGoal.goalType != SteerLib::GOAL_TYPE_AXIS_ALIGNED_BOX_GOAL)
+	{
+		throw Util::GenericException("Unsupported goal type; DetourCrowdAgent only supports GOAL_TYPE_SEEK_STATIC_TARGET and GOAL_TYPE_AXIS_ALIGNED_BOX_GOAL.");
+	}
+	_goalQueue.push(newGoal);
+	if (_goalQueue.size() == 1)
+	{
+		_goalOutOfDate = true;
+	}
+}
+
+void DetourCrowdAgent::clearGoals()
+{
+	while (!_goalQueue.empty())
+	{
+		_goalQueue.pop();
+	}
+	_goalOutOfDate = true;
+}
+
+void DetourCrowdAgent::restoreState(SteerLib::SimulationStateReader & reader)
+{
+	AgentInterface::restoreState(reader);
+	// the crowd still has the agent where it was before the snapshot was restored.
+	_crowdOutOfDate = true;
+	_goalOutOfDate = false;
+}
+
+void DetourCrowdAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
+{
+	if (!enabled())
+	{
+		return;
+	}
+
+	// the crowd moved the agent in DetourCrowdAIModule::preprocessFrame(); agents that are not in the crowd yet,
+	// e.g. because they were reset during this frame, stay where they are until the next frame.
+	const dtCrowdAgent * crowdAgent = _module->getCrowdAgent(this);
+	if (crowdAgent == NULL || !crowdAgent->active || _crowdOutOfDate)
+	{
+		return;
+	}
+
+	Util::AxisAlignedBox oldBounds(_position.x - _radius, _position.x + _radius, 0.0f, 0.0f, _position.z - _radius, _position.z + _radius);
+
+	_position = Util::Point(crowdAgent->npos[0], _position.y, crowdAgent->npos[2]);
+	_velocity = Util::Vector(crowdAgent->vel[0], 0.0f, crowdAgent->vel[2]);
+	if ( _velocity.lengthSquared() > 0.0f )
+	{
+		// Only assign forward direction if agent is moving
+		// Otherwise keep last forward
+		_forward = normalize(_velocity);
+	}
+
+	Util::AxisAlignedBox newBounds(_position.x - _radius, _position.x + _radius, 0.0f, 0.0f, _position.z - _radius, _position.z + _radius);
+	getSimulationEngine()->getSpatialDatabase()->updateObject( this, oldBounds, newBounds);
+
+	if (_goalQueue.empty() || _goalOutOfDate)
+	{
+		return;
+	}
+
+	// a goal off the navigation mesh, e.g. too close to a wall for the agent's radius, is reached at the nearest point of the mesh.
+	const SteerLib::AgentGoalInfo & goalInfo = _goalQueue.front();
+	const float goalThreshold = _radius * DETOUR_GOAL_THRESHOLD_MULTIPLIER;
+	Util::Vector toGoal = goalInfo.targetLocation - _position;
+	Util::Vector toCrowdTarget = _crowdTarget - _position;
+	toGoal.y = 0.0f;
+	toCrowdTarget.y = 0.0f;
+	if (toGoal.length() < goalThreshold || toCrowdTarget.length() < goalThreshold ||
+			(goalInfo.goalType == GOAL_TYPE_AXIS_ALIGNED_BOX_GOAL &&
+					Util::boxOverlapsCircle2D(goalInfo.targetRegion.xmin, goalInfo.targetRegion.xmax,
+							goalInfo.targetRegion.zmin, goalInfo.targetRegion.zmax, _position, _radius)))
+	{
+		_goalQueue.pop();
+		if (_goalQueue.size() != 0)
+		{
+			// in this case, there are still more goals; the module sends the agent to the next goal at the next frame.
+			_goalOutOfDate = true;
+		}
+		else
+		{
+			// in this case, there are no more goals, so disable the agent and remove it from the spatial database.
+			disable();
+		}
+	}
+}
+
+void DetourCrowdAgent::draw()
+{
+#ifdef ENABLE_GUI
+	AgentInterface::draw();
+
+	// the corners of the path corridor that the crowd steers the selected agent along.
+	const dtCrowdAgent * crowdAgent = _module->getCrowdAgent(this);
+	if (crowdAgent != NULL && _gEngine->isAgentSelected(this))
+	{
+		Util::Point previous = _position;
+		for (int i = 0; i < crowdAgent->ncorners; i++)
+		{
+			Util::Point corner(crowdAgent->cornerVerts[3*i], 0.0f, crowdAgent->cornerVerts[3*i+2]);
+			Util::DrawLib::drawLine(previous, corner, gYellow);
+			Util::DrawLib::drawStar(corner, Util::Vector(1,0,0), 0.34f, gBlue);
+			previous = corner;
+		}
+	}
+#endif
+}
@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file DetourCrowdNavMesh.cpp
+/// @brief Implements the DetourCrowdNavMesh class.
+
+#include <math.h>
+#include <string.h>
+#include "DetourCrowdNavMesh.h"
+#include "DetourCrowd_Parameters.h"
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+
+// the only polygon flag; Detour's default query filter accepts any polygon with a flag set.
+#define DETOUR_POLYFLAGS_WALK 0x01
+
+
+DetourCrowdNavMeshOptions::DetourCrowdNavMeshOptions()
+{
+	cellSize = DEFAULT_DETOUR_CELL_SIZE;
+	cellHeight = DEFAULT_DETOUR_CELL_HEIGHT;
+	walkableRadius = DEFAULT_DETOUR_WALKABLE_RADIUS;
+	walkableHeight = DEFAULT_DETOUR_WALKABLE_HEIGHT;
+	walkableClimb = DEFAULT_DETOUR_WALKABLE_CLIMB;
+	maxEdgeLength = DEFAULT_DETOUR_MAX_EDGE_LENGTH;
+	maxEdgeError = DEFAULT_DETOUR_MAX_EDGE_ERROR;
+	minRegionSize = DEFAULT_DETOUR_MIN_REGION_SIZE;
+	mergeRegionSize = DEFAULT_DETOUR_MERGE_REGION_SIZE;
+	maxSearchNodes = DEFAULT_DETOUR_MAX_SEARCH_NODES;
+}
+
+
+//
+// RecastBuildData - the intermediate results of one build, freed however the build ends.
+//
+namespace {
+	struct RecastBuildData {
+		RecastBuildData() : solid(NULL), chf(NULL), cset(NULL), pmesh(NULL), dmesh(NULL) { }
+		~RecastBuildData()
+		{
+			rcFreeHeightField(solid);
+			rcFreeCompactHeightfield(chf);
+			rcFreeContourSet(cset);
+			rcFreePolyMesh(pmesh);
+			rcFreePolyMeshDetail(dmesh);
+		}
+		rcHeightfield * solid;
+		rcCompactHeightfield * chf;
+		rcContourSet * cset;
+		rcPolyMesh * pmesh;
+		rcPolyMeshDetail * dmesh;
+	};
+}
+
+
+DetourCrowdNavMesh::DetourCrowdNavMesh()
+{
+	_navMesh = NULL;
+	_navQuery = NULL;
+	_numPolygons = 0;
+	_buildTime = 0.0f;
+}
+
+
+DetourCrowdNavMesh::~DetourCrowdNavMesh()
+{
+	clear();
+}
+
+
+void DetourCrowdNavMesh::clear()
+{
+	dtFreeNavMeshQuery(_navQuery);
+	_navQuery = NULL;
+	dtFreeNavMesh(_navMesh);
+	_navMesh = NULL;
+	_numPolygons = 0;
+}
+
+
+void DetourCrowdNavMesh::build(const std::vector<Util::Point> & vertices, const std::vector<size_t> & triangles, const DetourCrowdNavMeshOptions & options)
+{
+	clear();
+
+	if (vertices.empty() || triangles.size() < 3) {
+		throw Util::GenericException("DetourCrowdNavMesh: there is no geometry to build the navigation mesh from.");
+	}
+	if (options.cellSize <= 0.0f || options.cellHeight <= 0.0f) {
+		throw Util::GenericException("DetourCrowdNavMesh: the cell size and cell height must be positive.");
+	}
+
+	Util::PerformanceProfiler buildTimer;
+	buildTimer.reset();
+	buildTimer.start();
+
+	const int numVerts = (int)vertices.size();
+	const int numTris = (int)(triangles.size() / 3);
+	std::vector<float> verts(3 * numVerts);
+	for (int i = 0; i < numVerts; i++) {
+		verts[3*i] = vertices[i].x;
+		verts[3*i+1] = vertices[i].y;
+		verts[3*i+2] = vertices[i].z;
+	}
+	std::vector<int> tris(3 * numTris);
+	for (int i = 0; i < 3 * numTris; i++) {
+		tris[i] = (int)triangles[i];
+	}
+
+	rcConfig cfg;
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.cs = options.cellSize;
+	cfg.ch = options.cellHeight;
+	cfg.walkableSlopeAngle = 45.0f;
+	cfg.walkableHeight = (int)ceilf(options.walkableHeight / cfg.ch);
+	cfg.walkableClimb = (int)floorf(options.walkableClimb / cfg.ch);
+	cfg.walkableRadius = (int)ceilf(options.walkableRadius / cfg.cs);
+	cfg.maxEdgeLen = (int)(options.maxEdgeLength / cfg.cs);
+	cfg.maxSimplificationError = options.maxEdgeError;
+	cfg.minRegionArea = options.minRegionSize * options.minRegionSize;
+	cfg.mergeRegionArea = options.mergeRegionSize * options.mergeRegionSize;
+	cfg.maxVertsPerPoly = DT_VERTS_PER_POLYGON;
+	cfg.detailSampleDist = cfg.cs * 6.0f;
+	cfg.detailSampleMaxError = cfg.ch;
+	rcCalcBounds(&verts[0], numVerts, cfg.bmin, cfg.bmax);
+	rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+
+	// logging and timers are off; nothing of Recast is shown outside of the exceptions below.
+	rcContext ctx(false);
+	RecastBuildData data;
+
+	//
+	// rasterize the triangles; only the ground is walkable, the tops of obstacles are not, even if they are flat.
+	//
+	data.solid = rcAllocHeightfield();
+	if (data.solid == NULL || !rcCreateHeightfield(&ctx, *data.solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not create the heightfield of " + Util::toString(cfg.width) + " x " + Util::toString(cfg.height) + " cells.");
+	}
+	std::vector<unsigned char> triAreas(numTris, 0);
+	rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, &verts[0], numVerts, &tris[0], numTris, &triAreas[0]);
+	for (int i = 0; i < numTris; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (verts[3*tris[3*i+j]+1] > options.walkableClimb) {
+				triAreas[i] = RC_NULL_AREA;
+			}
+		}
+	}
+	rcRasterizeTriangles(&ctx, &verts[0], numVerts, &tris[0], &triAreas[0], numTris, *data.solid, cfg.walkableClimb);
+
+	rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *data.solid);
+	rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.solid);
+	rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *data.solid);
+
+	//
+	// partition the walkable surface, shrunk by the agent radius, into regions.
+	//
+	data.chf = rcAllocCompactHeightfield();
+	if (data.chf == NULL || !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.solid, *data.chf)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not build the compact heightfield.");
+	}
+	rcFreeHeightField(data.solid);
+	data.solid = NULL;
+
+	if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *data.chf)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not erode the walkable area.");
+	}
+	if (!rcBuildDistanceField(&ctx, *data.chf) || !rcBuildRegions(&ctx, *data.chf, 0, cfg.minRegionArea, cfg.mergeRegionArea)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not build the regions.");
+	}
+
+	//
+	// trace the regions into polygons.
+	//
+	data.cset = rcAllocContourSet();
+	if (data.cset == NULL || !rcBuildContours(&ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cset)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not build the contours.");
+	}
+	data.pmesh = rcAllocPolyMesh();
+	if (data.pmesh == NULL || !rcBuildPolyMesh(&ctx, *data.cset, cfg.maxVertsPerPoly, *data.pmesh)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not build the polygon mesh.");
+	}
+	data.dmesh = rcAllocPolyMeshDetail();
+	if (data.dmesh == NULL || !rcBuildPolyMeshDetail(&ctx, *data.pmesh, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.dmesh)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not build the detail mesh.");
+	}
+	if (data.pmesh->npolys == 0) {
+		throw Util::GenericException("DetourCrowdNavMesh: the navigation mesh is empty; there is no walkable ground wider than the agent radius.");
+	}
+
+	//
+	// create the Detour mesh.
+	//
+	for (int i = 0; i < data.pmesh->npolys; i++) {
+		data.pmesh->flags[i] = (data.pmesh->areas[i] == RC_WALKABLE_AREA) ? DETOUR_POLYFLAGS_WALK : 0;
+	}
+
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = data.pmesh->verts;
+	params.vertCount = data.pmesh->nverts;
+	params.polys = data.pmesh->polys;
+	params.polyAreas = data.pmesh->areas;
+	params.polyFlags = data.pmesh->flags;
+	params.polyCount = data.pmesh->npolys;
+	params.nvp = data.pmesh->nvp;
+	params.detailMeshes = data.dmesh->meshes;
+	params.detailVerts = data.dmesh->verts;
+	params.detailVertsCount = data.dmesh->nverts;
+	params.detailTris = data.dmesh->tris;
+	params.detailTriCount = data.dmesh->ntris;
+	params.walkableHeight = options.walkableHeight;
+	params.walkableRadius = options.walkableRadius;
+	params.walkableClimb = options.walkableClimb;
+	rcVcopy(params.bmin, data.pmesh->bmin);
+	rcVcopy(params.bmax, data.pmesh->bmax);
+	params.cs = cfg.cs;
+	params.ch = cfg.ch;
+	params.buildBvTree = true;
+
+	unsigned char * navData = NULL;
+	int navDataSize = 0;
+	if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
+		throw Util::GenericException("DetourCrowdNavMesh: could not create the Detour navigation mesh data.");
+	}
+
+	_navMesh = dtAllocNavMesh();
+	if (_navMesh == NULL || dtStatusFailed(_navMesh->init(navData, navDataSize, DT_TILE_FREE_DATA))) {
+		dtFree(navData);
+		clear();
+		throw Util::GenericException("DetourCrowdNavMesh: could not initialize the Detour navigation mesh.");
+	}
+
+	_navQuery = dtAllocNavMeshQuery();
+	if (_navQuery == NULL || dtStatusFailed(_navQuery->init(_navMesh, options.maxSearchNodes))) {
+		clear();
+		throw Util::GenericException("DetourCrowdNavMesh: could not initialize the Detour navigation mesh query.");
+	}
+
+	_numPolygons = data.pmesh->npolys;
+	buildTimer.stop();
+	_buildTime = buildTimer.getTotalTime();
+}
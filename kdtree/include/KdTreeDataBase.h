@@ -106,6 +106,8 @@ namespace SteerLib
 		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
 		/// Returns an STL set of objects found in the specified range of GridCells.
 		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex, SpatialDatabaseItemPtr exclude) {}
+		/// Returns the agents and obstacles found by getItemsInRange() as two separate lists.
+		void getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
 		/**
 		 * \brief   Computes the agent neighbors of the specified agent.
 		 * \param   agent    A pointer to the agent for which agent neighbors are to be computed.
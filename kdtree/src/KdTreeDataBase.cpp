@@ -77,6 +77,26 @@ void KdTreeDataBase::getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighbor
 
 }
 
+void KdTreeDataBase::getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude)
+{
+	std::set<SpatialDatabaseItemPtr> neighborList;
+	getItemsInRange(neighborList, xmin, xmax, zmin, zmax, exclude);
+
+	agents.clear();
+	obstacles.clear();
+	for (std::set<SpatialDatabaseItemPtr>::iterator neighbor = neighborList.begin(); neighbor != neighborList.end(); ++neighbor)
+	{
+		if ((*neighbor)->asAgent() != NULL)
+		{
+			agents.push_back((*neighbor)->asAgent());
+		}
+		else if ((*neighbor)->asObstacle() != NULL)
+		{
+			obstacles.push_back((*neighbor)->asObstacle());
+		}
+	}
+}
+
 
 void KdTreeDataBase::draw()
 {
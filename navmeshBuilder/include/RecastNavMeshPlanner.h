@@ -44,6 +44,14 @@ public:
 	virtual bool refresh();
 	//@}
 
+	/// @name Search statistics
+	//@{
+	/// Returns the number of polygons closed by the last Detour search.
+	virtual unsigned int getNumNodesExpandedInLastSearch();
+	/// Returns the size of the navigation mesh tiles and of the node pool of the Detour query.
+	virtual size_t getMemoryUsage();
+	//@}
+
 	// If there is anything to draw
 	virtual void draw();
 
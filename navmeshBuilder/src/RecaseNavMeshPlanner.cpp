@@ -10,6 +10,7 @@
  */
 
 #include "RecastNavMeshPlanner.h"
+#include "DetourNode.h"
 
 // Sample* createSolo() { return new Sample_SoloMesh(); }
 
@@ -142,6 +143,53 @@ bool RecastNavMeshPlanner::refresh()
 	return true;
 }
 
+unsigned int RecastNavMeshPlanner::getNumNodesExpandedInLastSearch()
+{
+	// the node pool keeps the nodes of the last search until the next one; the expanded nodes are the closed ones.
+	dtNavMeshQuery * navQuery = _sample->getNavMeshQuery();
+	if ( navQuery == NULL )
+	{
+		return 0;
+	}
+	const dtNodePool * nodePool = navQuery->getNodePool();
+	unsigned int numNodesExpanded = 0;
+	for (int bucket = 0; bucket < nodePool->getHashSize(); bucket++)
+	{
+		for (dtNodeIndex i = nodePool->getFirst(bucket); i != DT_NULL_IDX; i = nodePool->getNext(i))
+		{
+			if ( nodePool->getNodeAtIdx(i+1)->flags & DT_NODE_CLOSED )
+			{
+				numNodesExpanded++;
+			}
+		}
+	}
+	return numNodesExpanded;
+}
+
+size_t RecastNavMeshPlanner::getMemoryUsage()
+{
+	size_t numBytes = 0;
+	dtNavMesh * navMesh = _sample->getNavMesh();
+	if ( navMesh != NULL )
+	{
+		const dtNavMesh * constNavMesh = navMesh;
+		for (int t = 0; t < constNavMesh->getMaxTiles(); t++)
+		{
+			const dtMeshTile * tile = constNavMesh->getTile(t);
+			if ( tile->header != NULL )
+			{
+				numBytes += tile->dataSize;
+			}
+		}
+	}
+	dtNavMeshQuery * navQuery = _sample->getNavMeshQuery();
+	if ( navQuery != NULL )
+	{
+		numBytes += navQuery->getNodePool()->getMemUsed();
+	}
+	return numBytes;
+}
+
 std::pair<std::vector<Util::Point> , std::vector<size_t>> RecastNavMeshPlanner::getNavMeshGeometry()
 {
 	return _sample->getNavMeshGeometry();
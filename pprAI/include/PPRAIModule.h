@@ -87,9 +87,6 @@ namespace PPRGlobals {
 	extern int ped_furthest_local_target_distance;
 	extern int ped_next_waypoint_distance;
 	extern int ped_max_num_waypoints;
-
-
-	extern PhaseProfilers * gPhaseProfilers;
 }
 
 class PPRAIModule : public SteerLib::ModuleInterface
@@ -106,16 +103,25 @@ public:
 	void init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo );
 	void finish();
 	SteerLib::AgentInterface * createAgent();
-	void destroyAgent( SteerLib::AgentInterface * agent ) { if (agent) delete agent;  agent = NULL; }
+	void destroyAgent( SteerLib::AgentInterface * agent );
 
 	void initializeSimulation();
 	void cleanupSimulation();
+	void preprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
+	void saveSimulationState( SteerLib::SimulationStateWriter & writer );
+	void restoreSimulationState( SteerLib::SimulationStateReader & reader );
 
 private:
 	std::string logFilename;
 	Logger * _pprLogger;
 
 	SteerLib::EngineInterface * _gEngine;
+	// every engine has its own module instance, so engines that simulate on different threads do not share profilers.
+	PPRGlobals::PhaseProfilers _phaseProfilers;
+
+	// spreads the phases of this module's agents evenly across frames.
+	Util::PhaseScheduler _phaseScheduler;
+	unsigned int _numAgents;
 
 };
 
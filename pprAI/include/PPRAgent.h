@@ -15,7 +15,7 @@
 
 // #define USE_ANNOTATIONS
 
-#define AGENT_PTR(agent) (dynamic_cast<AgentInterface*>(agent))
+#define AGENT_PTR(agent) ((agent)->asAgent())
 
 
 //======================================================================================
@@ -28,6 +28,7 @@ namespace PPRGlobals {
 	// NOTE this is forward declared for an inline function defined below
 	// other declarations for this namespace belong in PPRAIModule.h
 	// extern SteerLib::EngineInterface * gEngine;
+	struct PhaseProfilers;
 }
 
 
@@ -125,6 +126,10 @@ public:
 		REACTIVE_SITUATION_STATIC_OBJECTS_ZERO_AGENTS,  REACTIVE_SITUATION_STATIC_OBJECTS_ONE_AGENT,  REACTIVE_SITUATION_STATIC_OBJECTS_TWO_AGENTS, 
 		REACTIVE_SITUATION_NO_THREATS,  REACTIVE_SITUATION_UNKNOWN };
 
+	// the phases scheduled by the module's Util::PhaseScheduler, in the order they are added to it.
+	enum PhaseEnum { LONG_TERM_PLANNING_PHASE,  MID_TERM_PLANNING_PHASE,  SHORT_TERM_PLANNING_PHASE,
+		PERCEPTIVE_PHASE,  PREDICTIVE_PHASE,  REACTIVE_PHASE,  NUM_PHASES };
+
 	// native functionality:
 	SteeringStateEnum steeringState() { return _steeringState; }
 	Util::Vector velocity() const { return _forward * _currentSpeed; }
@@ -132,6 +137,8 @@ public:
 	Util::Point localTargetLocation() { return _localTargetLocation; }
 	Util::Vector localTargetDirection() { return _finalSteeringCommand.targetDirection; }
 	void setParameters(SteerLib::Behaviour behave);
+	void saveState(SteerLib::SimulationStateWriter & writer);
+	void restoreState(SteerLib::SimulationStateReader & reader);
 	bool isSelected() { 
 		// return PPRGlobals::gEngine->isAgentSelected(this);
 		return _gEngine->isAgentSelected(this);
@@ -168,6 +175,7 @@ protected:
 	inline bool threatListContainsAgent(SteerLib::AgentInterface * agent) { unsigned int dummy; return threatListContainsAgent(agent, dummy); }
 	void disable();
 	void drawPlannedPath();
+	bool beginScheduledPhase(PhaseEnum phase); // returns false if the phase should be deferred to the next frame.
 
 	virtual SteerLib::EngineInterface * getSimulationEngine();
 
@@ -228,6 +236,13 @@ protected:
 	unsigned int _framesToNextPredictivePhase;
 	unsigned int _framesToNextReactivePhase;
 
+	// used to spread the phases of all agents evenly across frames; see Util::PhaseScheduler.
+	Util::PhaseScheduler * _phaseScheduler;
+	// the profilers of the module that created this agent.
+	PPRGlobals::PhaseProfilers * _phaseProfilers;
+	bool _phaseHasRun[NUM_PHASES];
+	unsigned int _phaseStaggerDelay[NUM_PHASES];  // how much later than the usual interval the second run of each phase is scheduled.
+
 
 	// GEOMETRY STATE of the agent (can potentially change per frame)
 	Util::Vector _rightSide;
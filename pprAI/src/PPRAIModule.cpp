@@ -17,6 +17,7 @@
 #define PERCEPTIVE_PHASE_INTERVAL      1
 #define PREDICTIVE_PHASE_INTERVAL      1
 #define REACTIVE_PHASE_INTERVAL        1
+#define PHASE_BUDGET_FACTOR            2.0f
 
 #define PERCENT 100.0f
 #define TO_MILLISECONDS 1000.0f
@@ -85,8 +86,6 @@ namespace PPRGlobals {
 	int ped_furthest_local_target_distance;
 	int ped_next_waypoint_distance;
 	int ped_max_num_waypoints;
-
-	PhaseProfilers * gPhaseProfilers;
 }
 
 using namespace PPRGlobals;
@@ -99,6 +98,8 @@ void PPRAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::En
 	// gSpatialDatabase = engineInfo->getSpatialDatabase();
 
 	_gEngine = engineInfo;
+	_numAgents = 0;
+	float phaseBudgetFactor = PHASE_BUDGET_FACTOR;
 
 
 	gLongTermPlanningPhaseInterval = LONG_TERM_PLANNING_INTERVAL;
@@ -185,6 +186,10 @@ void PPRAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::En
 		{
 			gUseDynamicPhaseScheduling = Util::getBoolFromString(value.str());
 		}
+		else if ((*optionIter).first == "phasebudget")
+		{
+			value >> phaseBudgetFactor;
+		}
 		else if ((*optionIter).first == "ped_max_speed")
 		{
 			value >> ped_max_speed;
@@ -368,6 +373,19 @@ void PPRAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::En
 	}
 
 
+	//
+	// the phases are added in the same order as PPRAgent::PhaseEnum.
+	//
+	_phaseScheduler.clear();
+	_phaseScheduler.addPhase("longplan", gLongTermPlanningPhaseInterval);
+	_phaseScheduler.addPhase("midplan", gMidTermPlanningPhaseInterval);
+	_phaseScheduler.addPhase("shortplan", gShortTermPlanningPhaseInterval);
+	_phaseScheduler.addPhase("perceptive", gPerceptivePhaseInterval);
+	_phaseScheduler.addPhase("predictive", gPredictivePhaseInterval);
+	_phaseScheduler.addPhase("reactive", gReactivePhaseInterval);
+	_phaseScheduler.setBudgetFactor(phaseBudgetFactor);
+
+
 	if (gShowStats)
 	{
 		std::cout << std::endl;
@@ -379,6 +397,7 @@ void PPRAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::En
 			std::cout << " perceptive: " << gPerceptivePhaseInterval << "\n";
 			std::cout << " predictive: " << gPredictivePhaseInterval << "\n";
 			std::cout << "   reactive: " << gReactivePhaseInterval << "\n";
+			std::cout << " PHASE BUDGET FACTOR: " << phaseBudgetFactor << "\n";
 		}
 		else {
 			std::cout << " PHASE INTERVALS (in frames):\n";
@@ -538,16 +557,26 @@ void PPRAIModule::initializeSimulation()
 	//
 	// initialize the performance profilers
 	//
-	gPhaseProfilers = new PhaseProfilers;
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
 	
+	_phaseScheduler.resetStatistics();
+}
+
+
+//
+// preprocessFrame() - starts a new frame of the phase scheduler, before any agents are updated.
+//
+void PPRAIModule::preprocessFrame(float timeStamp, float dt, unsigned int frameNumber)
+{
+	_phaseScheduler.setNumClients(_numAgents);
+	_phaseScheduler.beginFrame();
 }
 
 
@@ -574,129 +603,129 @@ void PPRAIModule::cleanupSimulation()
 
 			std::cout << "--- Long-term planning ---\n";
 			std::cout << std::endl;
-			gPhaseProfilers->longTermPhaseProfiler.displayStatistics(std::cout);
-		}
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->longTermPhaseProfiler.getTickFrequency());
+			_phaseProfilers.longTermPhaseProfiler.displayStatistics(std::cout);
+		}
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.longTermPhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Mid-term planning ---\n";
-				gPhaseProfilers->midTermPhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.midTermPhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Short-term planning ---\n";
-				gPhaseProfilers->shortTermPhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.shortTermPhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Perceptive phase ---\n";
-				gPhaseProfilers->perceptivePhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.perceptivePhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Predictive phase ---\n";
-				gPhaseProfilers->predictivePhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.predictivePhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Reactive phase ---\n";
-				gPhaseProfilers->reactivePhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.reactivePhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- Steering phase ---\n";
-				gPhaseProfilers->steeringPhaseProfiler.displayStatistics(std::cout);
+				_phaseProfilers.steeringPhaseProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
 				std::cout << "--- TOTAL AI ---\n";
-				gPhaseProfilers->aiProfiler.displayStatistics(std::cout);
+				_phaseProfilers.aiProfiler.displayStatistics(std::cout);
 				std::cout << std::endl;
 			}
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getNumTimesExecuted());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTicksAccumulated());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinTicks());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxTicks());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getAverageExecutionTimeMills());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTime());
-			pprLogObject.addLogData(gPhaseProfilers->aiProfiler.getTickFrequency());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getNumTimesExecuted());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTicksAccumulated());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getMinTicks());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxTicks());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getMinExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getAverageExecutionTimeMills());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTime());
+			pprLogObject.addLogData(_phaseProfilers.aiProfiler.getTickFrequency());
 
 			if (gShowAllStats)
 			{
@@ -708,35 +737,35 @@ void PPRAIModule::cleanupSimulation()
 				std::cout << "         because it excludes space-time planning)\n\n";
 			}
 			float totalAgentTime =
-				gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTime() + 
-				gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTime() +
-				gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTime() +
-				gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTime() +
-				gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTime() +
-				gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTime();
+				_phaseProfilers.midTermPhaseProfiler.getAverageExecutionTime() + 
+				_phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTime() +
+				_phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTime() +
+				_phaseProfilers.predictivePhaseProfiler.getAverageExecutionTime() +
+				_phaseProfilers.reactivePhaseProfiler.getAverageExecutionTime() +
+				_phaseProfilers.steeringPhaseProfiler.getAverageExecutionTime();
 			float totalAgentTime_5Hz_amortized =   // 5 Hz skips every 4 frames, so scale by 0.25
-				gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTime() * 0.25f + 
-				gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTime() * 0.25f +
-				gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTime() * 0.25f +
-				gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTime() * 0.25f +
-				gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTime() +  // reactive and steering phases still execute 20 Hz.
-				gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTime();
+				_phaseProfilers.midTermPhaseProfiler.getAverageExecutionTime() * 0.25f + 
+				_phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTime() * 0.25f +
+				_phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTime() * 0.25f +
+				_phaseProfilers.predictivePhaseProfiler.getAverageExecutionTime() * 0.25f +
+				_phaseProfilers.reactivePhaseProfiler.getAverageExecutionTime() +  // reactive and steering phases still execute 20 Hz.
+				_phaseProfilers.steeringPhaseProfiler.getAverageExecutionTime();
 			float totalAgentTime_4Hz_amortized =    // 4 Hz skips every 5 frames, so scale by 0.2
-				gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTime() * 0.2f + 
-				gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTime() * 0.2f +
-				gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTime() * 0.2f +
-				gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTime() * 0.2f +
-				gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTime() +  // reactive and steering phases still execute 20 Hz.
-				gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTime();
+				_phaseProfilers.midTermPhaseProfiler.getAverageExecutionTime() * 0.2f + 
+				_phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTime() * 0.2f +
+				_phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTime() * 0.2f +
+				_phaseProfilers.predictivePhaseProfiler.getAverageExecutionTime() * 0.2f +
+				_phaseProfilers.reactivePhaseProfiler.getAverageExecutionTime() +  // reactive and steering phases still execute 20 Hz.
+				_phaseProfilers.steeringPhaseProfiler.getAverageExecutionTime();
 
 			if (gShowAllStats)
 			{
-				std::cout << " percent mid-term:   " << gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT<< "\n";
-				std::cout << " percent short-term: " << gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT<< "\n";
-				std::cout << " percent perceptive: " << gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
-				std::cout << " percent predictive: " << gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
-				std::cout << " percent reactive:   " << gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
-				std::cout << " percent steering:   " << gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
+				std::cout << " percent mid-term:   " << _phaseProfilers.midTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT<< "\n";
+				std::cout << " percent short-term: " << _phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT<< "\n";
+				std::cout << " percent perceptive: " << _phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
+				std::cout << " percent predictive: " << _phaseProfilers.predictivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
+				std::cout << " percent reactive:   " << _phaseProfilers.reactivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
+				std::cout << " percent steering:   " << _phaseProfilers.steeringPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT << "\n";
 				std::cout << "\n";
 				std::cout << " Average per agent, no amortization: " << totalAgentTime * 1000.0 << " milliseconds\n";
 				std::cout << " Average per agent, 5Hz (skip 4 frames): " << totalAgentTime_5Hz_amortized * 1000.0 << " milliseconds\n";
@@ -745,12 +774,12 @@ void PPRAIModule::cleanupSimulation()
 			}
 
 
-			pprLogObject.addLogData(gPhaseProfilers->midTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
-			pprLogObject.addLogData(gPhaseProfilers->shortTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
-			pprLogObject.addLogData(gPhaseProfilers->perceptivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
-			pprLogObject.addLogData(gPhaseProfilers->predictivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
-			pprLogObject.addLogData(gPhaseProfilers->reactivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
-			pprLogObject.addLogData(gPhaseProfilers->steeringPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.midTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.shortTermPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.perceptivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.predictivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.reactivePhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
+			pprLogObject.addLogData(_phaseProfilers.steeringPhaseProfiler.getAverageExecutionTime()/totalAgentTime * PERCENT);
 			pprLogObject.addLogData(totalAgentTime * TO_MILLISECONDS);
 			pprLogObject.addLogData(totalAgentTime_5Hz_amortized * TO_MILLISECONDS);
 			pprLogObject.addLogData(totalAgentTime_4Hz_amortized * TO_MILLISECONDS);
@@ -762,12 +791,12 @@ void PPRAIModule::cleanupSimulation()
 			std::cout << "--- PROFILE RESULTS (excluding long-term planning) ---\n\n";
 		}
 		float totalTimeForAllAgents =
-			gPhaseProfilers->midTermPhaseProfiler.getTotalTime()+
-			gPhaseProfilers->shortTermPhaseProfiler.getTotalTime() +
-			gPhaseProfilers->perceptivePhaseProfiler.getTotalTime() +
-			gPhaseProfilers->predictivePhaseProfiler.getTotalTime() +
-			gPhaseProfilers->reactivePhaseProfiler.getTotalTime() +
-			gPhaseProfilers->steeringPhaseProfiler.getTotalTime();
+			_phaseProfilers.midTermPhaseProfiler.getTotalTime()+
+			_phaseProfilers.shortTermPhaseProfiler.getTotalTime() +
+			_phaseProfilers.perceptivePhaseProfiler.getTotalTime() +
+			_phaseProfilers.predictivePhaseProfiler.getTotalTime() +
+			_phaseProfilers.reactivePhaseProfiler.getTotalTime() +
+			_phaseProfilers.steeringPhaseProfiler.getTotalTime();
 
 		// TODO: right now this is hacked, later on need to add an arg or access to the engine to get this value correctly:
 		if (gShowStats || gShowAllStats)
@@ -775,25 +804,25 @@ void PPRAIModule::cleanupSimulation()
 			std::cerr << " TODO: 20 frames per second is a hard-coded assumption in the following calculations\n";
 		}
 		float baseFrequency = 20.0f;
-		float totalNumberOfFrames = (float)gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted();
+		float totalNumberOfFrames = (float)_phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted();
 
-		float average_frequency_mid_term = gPhaseProfilers->midTermPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->midTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-		float average_frequency_short_term = gPhaseProfilers->shortTermPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; //  << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->shortTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-		float average_frequency_perceptive = gPhaseProfilers->perceptivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->perceptivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-		float average_frequency_predictive = gPhaseProfilers->predictivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->predictivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-		float average_frequency_reactive = gPhaseProfilers->reactivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->reactivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-		float average_frequency_steering = gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_mid_term = _phaseProfilers.midTermPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.midTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_short_term = _phaseProfilers.shortTermPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; //  << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.shortTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_perceptive = _phaseProfilers.perceptivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.perceptivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_predictive = _phaseProfilers.predictivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.predictivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_reactive = _phaseProfilers.reactivePhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.reactivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+		float average_frequency_steering = _phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted()/totalNumberOfFrames * baseFrequency; // << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
 
 		if (gShowStats || gShowAllStats)
 		{
 			std::cout << "\n";
 
-			std::cout << " average frequency mid-term:   " << average_frequency_mid_term << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->midTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-			std::cout << " average frequency short-term: " << average_frequency_short_term << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->shortTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-			std::cout << " average frequency perceptive: " << average_frequency_perceptive << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->perceptivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-			std::cout << " average frequency predictive: " << average_frequency_predictive << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->predictivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-			std::cout << " average frequency reactive:   " << average_frequency_reactive << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->reactivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
-			std::cout << " average frequency steering:   " << average_frequency_steering << " Hz (skipping " << totalNumberOfFrames/((float)gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency mid-term:   " << average_frequency_mid_term << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.midTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency short-term: " << average_frequency_short_term << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.shortTermPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency perceptive: " << average_frequency_perceptive << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.perceptivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency predictive: " << average_frequency_predictive << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.predictivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency reactive:   " << average_frequency_reactive << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.reactivePhaseProfiler.getNumTimesExecuted()) << " frames)\n";
+			std::cout << " average frequency steering:   " << average_frequency_steering << " Hz (skipping " << totalNumberOfFrames/((float)_phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted()) << " frames)\n";
 			std::cout << "\n";
 		}
 
@@ -805,13 +834,13 @@ void PPRAIModule::cleanupSimulation()
 		pprLogObject.addLogData(average_frequency_steering);
 
 
-		float amortized_percent_mid_term = gPhaseProfilers->midTermPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float amortized_percent_short_term = gPhaseProfilers->shortTermPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float amortized_percent_perceptive = gPhaseProfilers->perceptivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float amortized_percent_predictive = gPhaseProfilers->predictivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float amortized_percent_reactive = gPhaseProfilers->reactivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float amortized_percent_steering = gPhaseProfilers->steeringPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
-		float AVERAGE_PER_AGENT_PER_UPDATE = totalTimeForAllAgents / ((float)gPhaseProfilers->steeringPhaseProfiler.getNumTimesExecuted()) * TO_MILLISECONDS;
+		float amortized_percent_mid_term = _phaseProfilers.midTermPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float amortized_percent_short_term = _phaseProfilers.shortTermPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float amortized_percent_perceptive = _phaseProfilers.perceptivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float amortized_percent_predictive = _phaseProfilers.predictivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float amortized_percent_reactive = _phaseProfilers.reactivePhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float amortized_percent_steering = _phaseProfilers.steeringPhaseProfiler.getTotalTime()/totalTimeForAllAgents * PERCENT;
+		float AVERAGE_PER_AGENT_PER_UPDATE = totalTimeForAllAgents / ((float)_phaseProfilers.steeringPhaseProfiler.getNumTimesExecuted()) * TO_MILLISECONDS;
 
 		if (gShowStats || gShowAllStats)
 		{
@@ -838,14 +867,51 @@ void PPRAIModule::cleanupSimulation()
 
 	}
 
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	if ((gShowStats || gShowAllStats) && !gUseDynamicPhaseScheduling)
+	{
+		std::cout << "--- PHASE SCHEDULER ---\n";
+		_phaseScheduler.displayStatistics(std::cout);
+		std::cout << std::endl;
+	}
+
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
+}
+
+
+//
+// saveSimulationState() - saves the stagger state of the phase scheduler, so that restored runs schedule new agents the same way.
+//
+void PPRAIModule::saveSimulationState( SteerLib::SimulationStateWriter & writer )
+{
+	writer.write(_phaseScheduler.getNumPhases());
+	for (unsigned int phase = 0; phase < _phaseScheduler.getNumPhases(); phase++) {
+		writer.write(_phaseScheduler.getStaggerCounter(phase));
+	}
+}
+
+
+//
+// restoreSimulationState()
+//
+void PPRAIModule::restoreSimulationState( SteerLib::SimulationStateReader & reader )
+{
+	unsigned int numPhases;
+	reader.read(numPhases);
+	if (numPhases != _phaseScheduler.getNumPhases()) {
+		throw GenericException("PPRAIModule::restoreSimulationState(): the snapshot was saved with a different phase schedule.");
+	}
+	for (unsigned int phase = 0; phase < numPhases; phase++) {
+		unsigned int staggerCounter;
+		reader.read(staggerCounter);
+		_phaseScheduler.setStaggerCounter(phase, staggerCounter);
+	}
 }
 
 void PPRAIModule::finish()
@@ -857,10 +923,22 @@ SteerLib::AgentInterface * PPRAIModule::createAgent()
 {
 	PPRAgent * agent = new PPRAgent;
 	agent->_gEngine = this->_gEngine;
+	agent->_phaseScheduler = &_phaseScheduler;
+	agent->_phaseProfilers = &_phaseProfilers;
 	agent->_id = _gEngine->getAgents().size();	
+	_numAgents++;
 	return agent;
 }
 
+void PPRAIModule::destroyAgent( SteerLib::AgentInterface * agent )
+{
+	if (agent) {
+		delete agent;
+		_numAgents--;
+	}
+	agent = NULL;
+}
+
 
 
 PLUGIN_API SteerLib::ModuleInterface * createModule() { return new PPRAIModule; }
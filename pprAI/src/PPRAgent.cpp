@@ -70,6 +70,8 @@ PPRAgent::PPRAgent()
 	_midTermPath.clear();//  = new int[_PPRParams.ped_next_waypoint_distance+2];
 	_enabled = false;
 	_id=0;
+	_phaseScheduler = NULL;
+	_phaseProfilers = NULL;
 }
 
 
@@ -90,6 +92,154 @@ SteerLib::EngineInterface * PPRAgent::getSimulationEngine()
 	return _gEngine;
 }
 
+
+//
+// saveState() - the planning, perception and prediction state persists across frames, so it is saved along with the AgentInterface state.
+//
+void PPRAgent::saveState(SteerLib::SimulationStateWriter & writer)
+{
+	AgentInterface::saveState(writer);
+
+	writer.write(_currentWaypointIndex);
+	writer.writeVector(_midTermPath);
+	writer.write(_midTermPathSize);
+	writer.write(_localTargetLocation);
+
+	writer.write((unsigned int)_neighbors.size());
+	for (std::set<SteerLib::SpatialDatabaseItemPtr>::iterator neighbor = _neighbors.begin(); neighbor != _neighbors.end(); ++neighbor) {
+		writer.writeItemReference(*neighbor);
+	}
+	writer.write(_numAgentsInVisualField);
+
+	writer.write(_timeToWait);
+	writer.write(_minThreatTime);
+	writer.write(_maxThreatTime);
+	writer.write(_mostImminentThreatIndex);
+	writer.write((unsigned int)_threatList.size());
+	for (unsigned int i=0; i < _threatList.size(); i++) {
+		writer.writeItemReference(_threatList[i].threatGuy);
+		writer.write(_threatList[i].minTime);
+		writer.write(_threatList[i].maxTime);
+		writer.write(_threatList[i].originalMaxTime);
+		writer.write(_threatList[i].threatType);
+		writer.write(_threatList[i].imminent);
+		writer.write(_threatList[i].oncomingToRightSide);
+	}
+	writer.write(_crowdControlDirection);
+	writer.write(_steeringState);
+	writer.write(_finalSteeringCommand);
+
+	writer.write(_nextFrameToRunLongTermPlanningPhase);
+	writer.write(_nextFrameToRunMidTermPlanningPhase);
+	writer.write(_nextFrameToRunShortTermPlanningPhase);
+	writer.write(_nextFrameToRunPerceptivePhase);
+	writer.write(_nextFrameToRunPredictivePhase);
+	writer.write(_nextFrameToRunReactivePhase);
+	writer.write(_lastFrameLongTermWasCalled);
+	writer.write(_lastFrameMidTermWasCalled);
+	writer.write(_lastFrameShortTermWasCalled);
+	writer.write(_lastFramePerceptiveWasCalled);
+	writer.write(_lastFramePredictiveWasCalled);
+	writer.write(_lastFrameReactiveWasCalled);
+	writer.write(_framesToNextLongTermPlanning);
+	writer.write(_framesToNextMidTermPlanning);
+	writer.write(_framesToNextShortTermPlanning);
+	writer.write(_framesToNextPerceptivePhase);
+	writer.write(_framesToNextPredictivePhase);
+	writer.write(_framesToNextReactivePhase);
+	writer.write(_phaseHasRun);
+	writer.write(_phaseStaggerDelay);
+
+	writer.write(_rightSide);
+	writer.write(_mass);
+	writer.write(_maxSpeed);
+	writer.write(_maxForce);
+	writer.write(_currentSpeed);
+	writer.write(_currentTimeStamp);
+	writer.write(_dt);
+	writer.write(_currentFrameNumber);
+	writer.writeGoal(_currentGoal);
+}
+
+
+//
+// restoreState() - reads back everything written by saveState(), in the same order.
+//
+void PPRAgent::restoreState(SteerLib::SimulationStateReader & reader)
+{
+	AgentInterface::restoreState(reader);
+
+	reader.read(_currentWaypointIndex);
+	reader.readVector(_midTermPath);
+	reader.read(_midTermPathSize);
+	reader.read(_localTargetLocation);
+
+	unsigned int numNeighbors;
+	reader.read(numNeighbors);
+	_neighbors.clear();
+	for (unsigned int i=0; i < numNeighbors; i++) {
+		SteerLib::SpatialDatabaseItemPtr neighbor = reader.readItemReference();
+		if (neighbor != NULL) _neighbors.insert(neighbor);
+	}
+	reader.read(_numAgentsInVisualField);
+
+	reader.read(_timeToWait);
+	reader.read(_minThreatTime);
+	reader.read(_maxThreatTime);
+	reader.read(_mostImminentThreatIndex);
+	unsigned int numThreats;
+	reader.read(numThreats);
+	_threatList.clear();
+	for (unsigned int i=0; i < numThreats; i++) {
+		PredictedThreat threat;
+		threat.threatGuy = AGENT_PTR(reader.readItemReference());
+		reader.read(threat.minTime);
+		reader.read(threat.maxTime);
+		reader.read(threat.originalMaxTime);
+		reader.read(threat.threatType);
+		reader.read(threat.imminent);
+		reader.read(threat.oncomingToRightSide);
+		if (threat.threatGuy == NULL) {
+			throw GenericException("PPRAgent::restoreState(): a predicted threat refers to an agent that does not exist.");
+		}
+		_threatList.push_back(threat);
+	}
+	reader.read(_crowdControlDirection);
+	reader.read(_steeringState);
+	reader.read(_finalSteeringCommand);
+
+	reader.read(_nextFrameToRunLongTermPlanningPhase);
+	reader.read(_nextFrameToRunMidTermPlanningPhase);
+	reader.read(_nextFrameToRunShortTermPlanningPhase);
+	reader.read(_nextFrameToRunPerceptivePhase);
+	reader.read(_nextFrameToRunPredictivePhase);
+	reader.read(_nextFrameToRunReactivePhase);
+	reader.read(_lastFrameLongTermWasCalled);
+	reader.read(_lastFrameMidTermWasCalled);
+	reader.read(_lastFrameShortTermWasCalled);
+	reader.read(_lastFramePerceptiveWasCalled);
+	reader.read(_lastFramePredictiveWasCalled);
+	reader.read(_lastFrameReactiveWasCalled);
+	reader.read(_framesToNextLongTermPlanning);
+	reader.read(_framesToNextMidTermPlanning);
+	reader.read(_framesToNextShortTermPlanning);
+	reader.read(_framesToNextPerceptivePhase);
+	reader.read(_framesToNextPredictivePhase);
+	reader.read(_framesToNextReactivePhase);
+	reader.read(_phaseHasRun);
+	reader.read(_phaseStaggerDelay);
+
+	reader.read(_rightSide);
+	reader.read(_mass);
+	reader.read(_maxSpeed);
+	reader.read(_maxForce);
+	reader.read(_currentSpeed);
+	reader.read(_currentTimeStamp);
+	reader.read(_dt);
+	reader.read(_currentFrameNumber);
+	reader.readGoal(_currentGoal);
+}
+
 void PPRAgent::setParameters(Behaviour behave)
 {
 	this->_PPRParams.setParameters(behave);
@@ -194,6 +344,16 @@ void PPRAgent::reset(const SteerLib::AgentInitialConditions & initialConditions,
 	_framesToNextPredictivePhase = 1;
 	_framesToNextReactivePhase = 1;
 
+	// the first run of every phase happens right away for all agents; to avoid running later phases
+	// in the same frames for all agents, the second run is delayed by a different number of frames for each agent.
+	for (unsigned int phase = 0; phase < NUM_PHASES; phase++) {
+		_phaseHasRun[phase] = false;
+		_phaseStaggerDelay[phase] = 0;
+		if ((_phaseScheduler != NULL) && (_phaseScheduler->getNumPhases() == NUM_PHASES)) {
+			_phaseStaggerDelay[phase] = _phaseScheduler->getStaggerDelay(phase);
+		}
+	}
+
 	// GEOMETRY STATE
 	// other geometry state was initialized above using the given initial conditions.
 	_rightSide = rightSideInXZPlane(_forward);
@@ -265,7 +425,7 @@ void PPRAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 	// std::cout << "updating PPR Agent" << std::endl;
 	if (!_enabled) return;
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->aiProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->aiProfiler );
 
 	// initialize some vars for this update step
 	// todo, this should eventually be removed after addressing the small issue with _currentFrameNumber.
@@ -279,31 +439,31 @@ void PPRAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 	// run any phases that were scheduled for this frame.
 	//
 
-	if (_currentFrameNumber >= _nextFrameToRunLongTermPlanningPhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunLongTermPlanningPhase) && beginScheduledPhase(LONG_TERM_PLANNING_PHASE)) {
 		runLongTermPlanningPhase();
 		_lastFrameLongTermWasCalled = _currentFrameNumber;
 	}
 
 
-	if (_currentFrameNumber >= _nextFrameToRunMidTermPlanningPhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunMidTermPlanningPhase) && beginScheduledPhase(MID_TERM_PLANNING_PHASE)) {
 		runMidTermPlanningPhase();
 		_lastFrameMidTermWasCalled = _currentFrameNumber;
 	}
 
 
-	if (_currentFrameNumber >= _nextFrameToRunShortTermPlanningPhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunShortTermPlanningPhase) && beginScheduledPhase(SHORT_TERM_PLANNING_PHASE)) {
 		runShortTermPlanningPhase();
 		_lastFrameShortTermWasCalled = _currentFrameNumber;
 	}
 
 
-	if (_currentFrameNumber >= _nextFrameToRunPerceptivePhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunPerceptivePhase) && beginScheduledPhase(PERCEPTIVE_PHASE)) {
 		runPerceptivePhase();
 		_lastFramePerceptiveWasCalled = _currentFrameNumber;
 	}
 
 
-	if (_currentFrameNumber >= _nextFrameToRunPredictivePhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunPredictivePhase) && beginScheduledPhase(PREDICTIVE_PHASE)) {
 
 		// MUBBASIR FOR REACTIVE APPROACH 
 		runPredictivePhase();
@@ -313,7 +473,7 @@ void PPRAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 	}
 
 
-	if (_currentFrameNumber >= _nextFrameToRunReactivePhase) {
+	if ((_currentFrameNumber >= _nextFrameToRunReactivePhase) && beginScheduledPhase(REACTIVE_PHASE)) {
 
 		// clearing the decision is not absolutely necessary, but significantly helps debugging,
 		// and avoids accidental re-use of the previous command.
@@ -333,12 +493,12 @@ void PPRAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 		_nextFrameToRunReactivePhase = _lastFrameReactiveWasCalled + _framesToNextReactivePhase;
 	}
 	else {
-		_nextFrameToRunLongTermPlanningPhase = _lastFrameLongTermWasCalled + gLongTermPlanningPhaseInterval;
-		_nextFrameToRunMidTermPlanningPhase = _lastFrameMidTermWasCalled + gMidTermPlanningPhaseInterval;
-		_nextFrameToRunShortTermPlanningPhase = _lastFrameShortTermWasCalled + gShortTermPlanningPhaseInterval;
-		_nextFrameToRunPerceptivePhase = _lastFramePerceptiveWasCalled + gPerceptivePhaseInterval;
-		_nextFrameToRunPredictivePhase = _lastFramePredictiveWasCalled + gPredictivePhaseInterval;
-		_nextFrameToRunReactivePhase = _lastFrameReactiveWasCalled + gReactivePhaseInterval;
+		_nextFrameToRunLongTermPlanningPhase = _lastFrameLongTermWasCalled + gLongTermPlanningPhaseInterval + _phaseStaggerDelay[LONG_TERM_PLANNING_PHASE];
+		_nextFrameToRunMidTermPlanningPhase = _lastFrameMidTermWasCalled + gMidTermPlanningPhaseInterval + _phaseStaggerDelay[MID_TERM_PLANNING_PHASE];
+		_nextFrameToRunShortTermPlanningPhase = _lastFrameShortTermWasCalled + gShortTermPlanningPhaseInterval + _phaseStaggerDelay[SHORT_TERM_PLANNING_PHASE];
+		_nextFrameToRunPerceptivePhase = _lastFramePerceptiveWasCalled + gPerceptivePhaseInterval + _phaseStaggerDelay[PERCEPTIVE_PHASE];
+		_nextFrameToRunPredictivePhase = _lastFramePredictiveWasCalled + gPredictivePhaseInterval + _phaseStaggerDelay[PREDICTIVE_PHASE];
+		_nextFrameToRunReactivePhase = _lastFrameReactiveWasCalled + gReactivePhaseInterval + _phaseStaggerDelay[REACTIVE_PHASE];
 	}
 
 
@@ -349,6 +509,19 @@ void PPRAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 }
 
 
+//
+// beginScheduledPhase() - asks the module's phase scheduler whether a phase that is due can run in this frame.
+//
+bool PPRAgent::beginScheduledPhase(PhaseEnum phase)
+{
+	if (gUseDynamicPhaseScheduling || (_phaseScheduler == NULL) || (_phaseScheduler->getNumPhases() != NUM_PHASES)) {
+		return true;
+	}
+
+	return _phaseScheduler->beginScheduledPhase(phase, _phaseHasRun[phase], _phaseStaggerDelay[phase]);
+}
+
+
 //
 // runCognitivePhase()
 //
@@ -403,7 +576,7 @@ void PPRAgent::runLongTermPlanningPhase()
 		if (!_enabled) return;
 	}
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->longTermPhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->longTermPhaseProfiler );
 
 	//==========================================================================
 
@@ -489,7 +662,7 @@ void PPRAgent::runMidTermPlanningPhase()
 		if (!_enabled) return;
 	}
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->midTermPhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->midTermPhaseProfiler );
 
 	// if we reached the current waypoint, then increment to the next waypoint
 	if (reachedCurrentWaypoint()) {
@@ -572,7 +745,7 @@ void PPRAgent::runShortTermPlanningPhase()
 	}
 
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->shortTermPhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->shortTermPhaseProfiler );
 	int myIndexPosition = getSimulationEngine()->getSpatialDatabase()->getCellIndexFromLocation(_position.x, _position.z);
 
 
@@ -716,7 +889,7 @@ void PPRAgent::runPerceptivePhase()
 {
 	if (!_enabled) return;
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->perceptivePhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->perceptivePhaseProfiler );
 	collectObjectsInVisualField();
 
 	if (gUseDynamicPhaseScheduling) {
@@ -740,7 +913,7 @@ void PPRAgent::runPredictivePhase()
 {
 	if (!_enabled) return;
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->predictivePhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->predictivePhaseProfiler );
 
 	bool threatListChanged = false;
 	bool alreadyExists = false;
@@ -786,7 +959,7 @@ void PPRAgent::runPredictivePhase()
 			if (!(*neighbor)->isAgent())
 				continue;
 
-			SteerLib::AgentInterface * otherGuy = dynamic_cast<SteerLib::AgentInterface *>(*neighbor);
+			SteerLib::AgentInterface * otherGuy = (*neighbor)->asAgent();
 
 			//Vector aff = _position - otherGuy->position();
 			//if (aff.lengthlength) _numAgentsInVisualField++;
@@ -1028,7 +1201,7 @@ void PPRAgent::runReactivePhase()
 		if (!_enabled) return;
 	}
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->reactivePhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->reactivePhaseProfiler );
 
 	FeelerInfo feelers;
 
@@ -1100,9 +1273,9 @@ void PPRAgent::runReactivePhase()
 
 		// check if we hit agents that were not already in our _threatList
 		bool foundNewThreat = false;
-		if (   ((feelers.object_front) && (feelers.object_front->isAgent()) && (!threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front))))
-			|| ((feelers.object_left) && (feelers.object_left->isAgent()) && (!threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left))))
-			|| ((feelers.object_right) && (feelers.object_right->isAgent()) && (!threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right)))))
+		if (   ((feelers.object_front) && (feelers.object_front->isAgent()) && (!threatListContainsAgent(feelers.object_front->asAgent())))
+			|| ((feelers.object_left) && (feelers.object_left->isAgent()) && (!threatListContainsAgent(feelers.object_left->asAgent())))
+			|| ((feelers.object_right) && (feelers.object_right->isAgent()) && (!threatListContainsAgent(feelers.object_right->asAgent()))))
 		{
 			foundNewThreat = true;
 		}
@@ -1111,9 +1284,9 @@ void PPRAgent::runReactivePhase()
 		// TODO: its not clear whether we should react to existing non-imminent threats or not ???
 		bool existingThreatRaisedAgain = false;
 		unsigned int tempIndex;
-		if (   ((feelers.object_front) && (feelers.object_front->isAgent()) && (threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front), tempIndex)) && (!_threatList[tempIndex].imminent) )
-			|| ((feelers.object_left) && (feelers.object_left->isAgent()) && (threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left), tempIndex)) && (!_threatList[tempIndex].imminent) )
-			|| ((feelers.object_right) && (feelers.object_right->isAgent()) && (threatListContainsAgent(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right), tempIndex)) && (!_threatList[tempIndex].imminent) ))
+		if (   ((feelers.object_front) && (feelers.object_front->isAgent()) && (threatListContainsAgent(feelers.object_front->asAgent(), tempIndex)) && (!_threatList[tempIndex].imminent) )
+			|| ((feelers.object_left) && (feelers.object_left->isAgent()) && (threatListContainsAgent(feelers.object_left->asAgent(), tempIndex)) && (!_threatList[tempIndex].imminent) )
+			|| ((feelers.object_right) && (feelers.object_right->isAgent()) && (threatListContainsAgent(feelers.object_right->asAgent(), tempIndex)) && (!_threatList[tempIndex].imminent) ))
 		{
 			existingThreatRaisedAgain = true;
 		}
@@ -1129,7 +1302,7 @@ void PPRAgent::runReactivePhase()
 		unsigned int numAgentsNotPosingThreat = 0;
 		if ((feelers.object_front) && (feelers.object_front->isAgent())) {
 			numAgentsHit++;
-			SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front);
+			SteerLib::AgentInterface * p = feelers.object_front->asAgent();
 			Vector dV = _velocity - p->velocity();
 			Vector dO = _position - p->position();
 			float distanceThreshold = _radius + p->radius() + _PPRParams.ped_dynamic_collision_padding;
@@ -1145,7 +1318,7 @@ void PPRAgent::runReactivePhase()
 		}
 		if ((feelers.object_left) && (feelers.object_left!=feelers.object_front) && (feelers.object_left->isAgent())) {
 			numAgentsHit++;
-			SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left);
+			SteerLib::AgentInterface * p = feelers.object_left->asAgent();
 			Vector dV = _velocity - p->velocity();
 			Vector dO = _position - p->position();
 			float distanceThreshold = _radius + p->radius() + _PPRParams.ped_dynamic_collision_padding;
@@ -1161,7 +1334,7 @@ void PPRAgent::runReactivePhase()
 		}
 		if ((feelers.object_right) && (feelers.object_right!=feelers.object_front) && (feelers.object_right!=feelers.object_left) && (feelers.object_right->isAgent())) {
 			numAgentsHit++;
-			SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right);
+			SteerLib::AgentInterface * p = feelers.object_right->asAgent();
 			Vector dV = _velocity - p->velocity();
 			Vector dO = _position - p->position();
 			float distanceThreshold = _radius + p->radius() + _PPRParams.ped_dynamic_collision_padding;
@@ -1244,17 +1417,17 @@ void PPRAgent::runReactivePhase()
 			
 			// match speed:
 			if ((feelers.object_left)&&(feelers.object_left->isAgent())) {
-				float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left))->velocity());
+				float tempVelocity = dot(forward(),feelers.object_left->asAgent()->velocity());
 				//if (tempVelocity > -1.0f)
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 			}
 			if ((feelers.object_right)&&(feelers.object_right->isAgent())) {
-				float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right))->velocity());
+				float tempVelocity = dot(forward(),feelers.object_right->asAgent()->velocity());
 				//if (tempVelocity > -1.0f)
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 			}
 			if ((feelers.object_front)&&(feelers.object_front->isAgent())) {
-				float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front))->velocity());
+				float tempVelocity = dot(forward(),feelers.object_front->asAgent()->velocity());
 				//if (tempVelocity > -1.0f)
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 			}
@@ -1266,7 +1439,7 @@ void PPRAgent::runReactivePhase()
 
 			SpatialDatabaseItemPtr obj = (feelers.object_front) ? feelers.object_front : (feelers.object_right) ? feelers.object_right : feelers.object_left;
 			assert(obj!=NULL);
-			SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(obj);
+			SteerLib::AgentInterface * p = obj->asAgent();
 
 
 			float cosTheta = dot(_forward, p->forward());
@@ -1351,7 +1524,7 @@ void PPRAgent::runReactivePhase()
 				//  - you are crossing the other guy's path, you are perceived to be "in front"
 				SpatialDatabaseItemPtr obj = (feelers.object_front) ? feelers.object_front : (feelers.object_right) ? feelers.object_right : feelers.object_left;
 				assert(obj!=NULL);
-				SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(obj);
+				SteerLib::AgentInterface * p = obj->asAgent();
 				float cosTheta = dot(_forward, p->forward());
 				if ( cosTheta < _PPRParams.ped_oncoming_reaction_threshold ) {
 					if ((feelers.object_front || feelers.object_left) && (!feelers.object_right)) {
@@ -1399,8 +1572,8 @@ void PPRAgent::runReactivePhase()
 				// feelers, especially with larger objects
 
 				// assert(objLeft!=objRight);
-				SteerLib::AgentInterface * pLeft = dynamic_cast<SteerLib::AgentInterface*>(objLeft);
-				SteerLib::AgentInterface * pRight = dynamic_cast<SteerLib::AgentInterface*>(objRight);
+				SteerLib::AgentInterface * pLeft = objLeft->asAgent();
+				SteerLib::AgentInterface * pRight = objRight->asAgent();
 				float cosThetaLeft = dot(_forward, pLeft->forward());
 				float cosThetaRight = dot(_forward, pRight->forward());
 				if ((cosThetaLeft < _PPRParams.ped_oncoming_reaction_threshold) && (cosThetaRight < _PPRParams.ped_oncoming_reaction_threshold)) {
@@ -1480,7 +1653,7 @@ void PPRAgent::runReactivePhase()
 				SpatialDatabaseItemPtr objAgent = (feelers.object_front && feelers.object_front->isAgent()) ? feelers.object_front : (feelers.object_right && feelers.object_right->isAgent()) ? feelers.object_right : feelers.object_left;
 				SpatialDatabaseItemPtr obstacle = (feelers.object_front && !feelers.object_front->isAgent()) ? feelers.object_front : (feelers.object_right && !feelers.object_right->isAgent()) ? feelers.object_right : feelers.object_left;
 
-				SteerLib::AgentInterface * p = dynamic_cast<SteerLib::AgentInterface*>(objAgent);
+				SteerLib::AgentInterface * p = objAgent->asAgent();
 
 				if ( dot(p->forward(), _forward) < _PPRParams.ped_oncoming_reaction_threshold ) {
 					if (obstacle == feelers.object_right) {
@@ -1542,15 +1715,15 @@ void PPRAgent::runReactivePhase()
 				//SteerLib::AgentInterface * pRight = dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right);
 				//if (isSelected()) cerr << "REACTION: three agents - I'll just match their speed and hope it doesnt get clogged?\n";
 				if ((feelers.object_left)&&(feelers.object_left->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_left->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if ((feelers.object_right)&&(feelers.object_right->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_right->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if ((feelers.object_front)&&(feelers.object_front->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_front->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if (comfortZoneViolated) {
@@ -1567,15 +1740,15 @@ void PPRAgent::runReactivePhase()
 				SpatialDatabaseItemPtr obstacle = (feelers.object_front && !feelers.object_front->isAgent()) ? feelers.object_front : (feelers.object_right && !feelers.object_right->isAgent()) ? feelers.object_right : feelers.object_left;
 
 				if ((feelers.object_left)&&(feelers.object_left->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_left))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_left->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if ((feelers.object_right)&&(feelers.object_right->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_right))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_right->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if ((feelers.object_front)&&(feelers.object_front->isAgent())) {
-					float tempVelocity = dot(forward(),(dynamic_cast<SteerLib::AgentInterface*>(feelers.object_front))->velocity());
+					float tempVelocity = dot(forward(),feelers.object_front->asAgent()->velocity());
 					_finalSteeringCommand.targetSpeed = std::min<float>(_finalSteeringCommand.targetSpeed,tempVelocity);
 				}
 				if (comfortZoneViolated) {
@@ -1770,7 +1943,7 @@ void PPRAgent::doSteering()
 	if (!_enabled) return;
 
 
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->steeringPhaseProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->steeringPhaseProfiler );
 
 	switch ( _finalSteeringCommand.steeringMode) {
 		case SteeringCommand::LOCOMOTION_MODE_COMMAND:
@@ -2194,7 +2367,7 @@ void PPRAgent::draw()
 	AgentInterface::draw();
 #ifdef ENABLE_GUI
 	if (!_enabled) return;
-	AutomaticFunctionProfiler profileThisFunction( &PPRGlobals::gPhaseProfilers->drawProfiler );
+	AutomaticFunctionProfiler profileThisFunction( &_phaseProfilers->drawProfiler );
 
 	/*
 	std::cout << "max speed is " << _PPRParams.ped_max_speed << " and quert radius is " <<
@@ -15,7 +15,7 @@
 
 // #define USE_ANNOTATIONS
 
-#define AGENT_PTR(agent) (dynamic_cast<AgentInterface*>(agent))
+#define AGENT_PTR(agent) ((agent)->asAgent())
 
 
 //======================================================================================
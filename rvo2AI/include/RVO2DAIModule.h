@@ -14,6 +14,7 @@
 #include "SteerLib.h"
 #include <vector>
 #include "RVO2D_Parameters.h"
+#include "RVO2DAgent.h"
 #include "Logger.h"
 
 
@@ -60,9 +61,6 @@ namespace RVO2DGlobals {
 	extern float rvo_time_horizon_obstacles;
 	extern int rvo_max_neighbors;
 	extern int next_waypoint_distance;
-
-
-	extern PhaseProfilers * gPhaseProfilers;
 }
 
 
@@ -77,7 +75,7 @@ public:
 	std::string getDependencies() { return ""; }
 	
 	std::string getConflicts() { return ""; }
-	std::string getData() { return ""; }
+	std::string getData() { return _data; }
 	LogData * getLogData()
 	{
 		LogData * lD = new LogData();
@@ -94,13 +92,52 @@ public:
 	void postprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
 	std::vector<SteerLib::AgentInterface * > agents_;
 
+	/// Returns the scratch buffers of a thread; the per-agent update in RVO2DAgent::updateAI() uses thread 0.
+	RVO2DScratch & getScratch(unsigned int threadIndex) { return _scratch[threadIndex]; }
+	/// Returns the profilers of this module; every engine has its own module instance, so engines that simulate on different threads do not share them.
+	RVO2DGlobals::PhaseProfilers & getPhaseProfilers() { return _phaseProfilers; }
+
 protected:
+	/// The data given to each task of the Util::ThreadedTaskManager in batch mode.
+	struct BatchTask {
+		RVO2DAIModule * module;
+		unsigned int firstAgent;
+		unsigned int endAgent;
+		float dt;
+	};
+	static void _runBatchTask(unsigned int threadIndex, void * data);
+	void _computeBatchVelocities(float dt);
+	void _computeNewVelocities(unsigned int threadIndex, unsigned int firstAgent, unsigned int endAgent, float dt);
+
 	std::string logFilename; // = "pprAI.log";
 	bool logStats; // = false;
 	Logger * _rvoLogger;
+	std::string _data;
 	std::vector<LogObject *> _logData;
 
 	SteerLib::EngineInterface * _gEngine;
+	RVO2DGlobals::PhaseProfilers _phaseProfilers;
+
+	/// @name Batch mode
+	/// @brief Runs ORCA for all agents in preprocessFrame(), optionally on several threads, instead of one agent at a time in updateAI().
+	///
+	/// By default, each agent runs ORCA in its own updateAI(), so it sees the agents that were updated before it in the
+	/// same frame at their new positions.  With the start_of_frame option, the module runs ORCA for every agent in
+	/// preprocessFrame() instead, one agent at a time, so every agent sees the positions and velocities of the start of
+	/// the frame, as in the original RVO2 library.  Batch mode uses the same start-of-frame update and only splits the
+	/// agents among batch_threads threads, so its trajectories are identical to those of start_of_frame.
+	//@{
+	bool _useBatch;
+	bool _startOfFrame;
+	bool _batchCheck;
+	unsigned int _batchThreads;
+	Util::ThreadedTaskManager * _batchTaskManager;
+	std::vector<RVO2DAgent*> _batchAgents;
+	std::vector<BatchTask> _batchTasks;
+	std::vector<RVO2DScratch> _scratch;
+	long long _batchNumChecked;
+	long long _batchNumMismatches;
+	//@}
 };
 
 #endif
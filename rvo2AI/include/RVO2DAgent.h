@@ -32,6 +32,23 @@
 
 #define USE_ACCLMESH 1
 
+/**
+ * @brief Scratch buffers for computing the new velocity of one agent.
+ *
+ * Every thread that runs RVO2DAgent::computeNeighbors() and RVO2DAgent::computeNewVelocity() uses its own instance,
+ * owned by the RVO2DAIModule.  The buffers keep their capacity from one agent to the next, so after the first few
+ * frames the neighbor query and the linear programs do not allocate any memory.
+ */
+struct RVO2DScratch
+{
+	std::vector<SteerLib::AgentInterface*> neighborAgents;
+	std::vector<SteerLib::ObstacleInterface*> neighborObstacles;
+	/// The loops of the neighboring obstacles, see SteerLib::StaticObstacleGeometry::getLoopsInRange().
+	std::vector<unsigned int> neighborObstacleLoops;
+	/// The projected lines built by linearProgram3().
+	std::vector<Line> projLines;
+};
+
 class RVO2DAgent : public SteerLib::AgentInterface
 {
 public:
@@ -101,15 +118,29 @@ protected:
 	 */
 	void insertObstacleNeighbor(const ObstacleInterface *obstacle, float rangeSq);
 
+	/**
+	 * \brief      Inserts an edge of a static obstacle, compiled by the engine,
+	 *             into the set of obstacle neighbors of this agent.
+	 * \param      segment         The edge to be inserted.
+	 * \param      rangeSq         The squared range around this agent.
+	 */
+	void insertObstacleSegmentNeighbor(const SteerLib::StaticObstacleGeometry::Segment *segment, float rangeSq);
+
+	/**
+	 * \brief   Computes the preferred velocity of this agent, towards its
+	 *          current local target.
+	 */
+	void computePreferredVelocity();
+
 	/**
 	 * \brief   Computes the neighbors of this agent.
 	 */
-	void computeNeighbors();
+	void computeNeighbors(RVO2DScratch & scratch);
 
 	/**
 	 * \brief   Computes the new velocity of this agent.
 	 */
-	void computeNewVelocity(float dt);
+	void computeNewVelocity(float dt, RVO2DScratch & scratch);
 
 	/**
 		 * \brief   Updates the three-dimensional position and three-dimensional velocity of this agent.
@@ -128,9 +159,12 @@ protected:
 	int next_waypoint_distance_;
 	// std::vector<std::pair<float, const SteerLib::AgentInterface *> > agentNeighbors_;
 	// std::vector<std::pair<float, const Obstacle *> > obstacleNeighbors_;
+	std::vector<std::pair<float, const SteerLib::StaticObstacleGeometry::Segment *> > obstacleSegmentNeighbors_;
 	std::vector<Util::Plane> orcaPlanes_;
 	std::vector<Line> orcaLines_;
 	SteerLib::ModuleInterface * rvoModule;
+	/// True if the module already computed _newVelocity for this frame in batch mode.
+	bool _batchVelocityValid;
 
 	SteerLib::EngineInterface * _gEngine;
 
@@ -180,8 +214,9 @@ size_t linearProgram2(const std::vector<Line> &lines, float radius,
  * \param      beginLine     The line on which the 2-d linear program failed.
  * \param      radius        The radius of the circular constraint.
  * \param      result        A reference to the result of the linear program.
+ * \param      projLines     Scratch buffer for the projected lines; its contents are overwritten.
  */
 void linearProgram3(const std::vector<Line> &lines, size_t numObstLines, size_t beginLine,
-					float radius, Util::Vector &result);
+					float radius, Util::Vector &result, std::vector<Line> &projLines);
 
 #endif
@@ -16,6 +16,9 @@
 #include "LogObject.h"
 #include "LogManager.h"
 
+// in batch mode, each thread gets this many tasks per frame, so that threads that finish early can take over some work.
+#define BATCH_TASKS_PER_THREAD 4
+
 
 // globally accessible to the simpleAI plugin
 // SteerLib::EngineInterface * gEngine;
@@ -46,9 +49,6 @@ namespace RVO2DGlobals
 	float rvo_time_horizon_obstacles;
 	int rvo_max_neighbors;
 	int next_waypoint_distance;
-
-
-	PhaseProfilers * gPhaseProfilers;
 }
 
 using namespace RVO2DGlobals;
@@ -75,6 +75,14 @@ void RVO2DAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::
 	gShowAllStats = false;
 	logFilename = "rvo2AI.log";
 	dont_plan=false;
+	_data = "";
+	_useBatch = false;
+	_startOfFrame = false;
+	_batchCheck = false;
+	_batchThreads = 1;
+	_batchTaskManager = NULL;
+	_batchNumChecked = 0;
+	_batchNumMismatches = 0;
 
 	rvo_max_neighbors = MAX_NEIGHBORS;
 	rvo_max_speed = MAX_SPEED;
@@ -137,12 +145,43 @@ void RVO2DAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::
 		{
 			dont_plan = Util::getBoolFromString(value.str());
 		}
+		else if ((*optionIter).first == "batch")
+		{
+			_useBatch = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "start_of_frame")
+		{
+			// computes every velocity from the state at the start of the frame, one agent at a time; batch mode always does
+			_startOfFrame = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "batch_threads")
+		{
+			// only used in batch mode
+			value >> _batchThreads;
+		}
+		else if ((*optionIter).first == "batch_check")
+		{
+			// re-computes every batch velocity with the per-agent solver from the same start-of-frame state and counts differences; implies batch mode
+			_batchCheck = Util::getBoolFromString(value.str());
+			_useBatch = _useBatch || _batchCheck;
+		}
 		else
 		{
 			// throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to PPR AI module.");
 		}
 	}
 
+	_startOfFrame = _startOfFrame || _useBatch;
+	if (_batchThreads == 0)
+	{
+		throw Util::GenericException("RVO2DAIModule: batch_threads must be at least 1.");
+	}
+	_scratch.resize(_batchThreads);
+	if (_useBatch && _batchThreads > 1)
+	{
+		_batchTaskManager = new Util::ThreadedTaskManager(_batchThreads);
+	}
+
 	_rvoLogger = LogManager::getInstance()->createLogger(logFilename,LoggerType::BASIC_WRITE);
 
 	_rvoLogger->addDataField("number_of_times_executed",DataType::LongLong );
@@ -175,21 +214,21 @@ void RVO2DAIModule::initializeSimulation()
 	//
 	// initialize the performance profilers
 	//
-	gPhaseProfilers = new PhaseProfilers;
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
 
 }
 
 void RVO2DAIModule::finish()
 {
-	// nothing to do here
+	delete _batchTaskManager;
+	_batchTaskManager = NULL;
 }
 
 void RVO2DAIModule::preprocessSimulation()
@@ -209,12 +248,100 @@ void RVO2DAIModule::preprocessFrame(float timeStamp, float dt, unsigned int fram
 		// kdTree_->buildAgentTree();
 	}
 
-	/*
-	for (int i = 0; i < static_cast<int>(agents_.size()); ++i)
+	if ( _startOfFrame )
 	{
-		dynamic_cast<RVO2DAgent *>(agents_[i])->computeNeighbors();
-		dynamic_cast<RVO2DAgent *>(agents_[i])->computeNewVelocity(dt);
-	}*/
+		_computeBatchVelocities(dt);
+	}
+}
+
+//
+// _computeBatchVelocities() - computes the new velocity of every enabled agent of this module from the start-of-frame
+//                             state, like the original RVO2 library does; updateAI() then only moves the agents.
+//                             With start_of_frame the agents are solved one at a time on this thread; in batch mode
+//                             they are split among the batch threads.  Each velocity only depends on the
+//                             start-of-frame state, so both give exactly the same trajectories.
+//                             The preferred velocities are computed first, one agent at a time, because they may
+//                             update the agents' paths; the neighbor queries and linear programs only change the
+//                             agent they belong to, so they can run on several threads.
+//
+void RVO2DAIModule::_computeBatchVelocities(float dt)
+{
+	const std::vector<SteerLib::AgentInterface*> & agents = _gEngine->getAgents();
+	_batchAgents.clear();
+	for (unsigned int i = 0; i < agents.size(); i++)
+	{
+		RVO2DAgent * agent = dynamic_cast<RVO2DAgent*>(agents[i]);
+		if (agent != NULL && agent->rvoModule == this && agent->enabled())
+		{
+			agent->computePreferredVelocity();
+			_batchAgents.push_back(agent);
+		}
+	}
+
+	const unsigned int numAgents = (unsigned int)_batchAgents.size();
+	if (_batchTaskManager == NULL || numAgents < 2)
+	{
+		_computeNewVelocities(0, 0, numAgents, dt);
+	}
+	else
+	{
+		const unsigned int numTasks = std::min(numAgents, _batchThreads * BATCH_TASKS_PER_THREAD);
+		_batchTasks.resize(numTasks);
+		for (unsigned int i = 0; i < numTasks; i++)
+		{
+			_batchTasks[i].module = this;
+			_batchTasks[i].firstAgent = (unsigned int)(((unsigned long long)numAgents * i) / numTasks);
+			_batchTasks[i].endAgent = (unsigned int)(((unsigned long long)numAgents * (i+1)) / numTasks);
+			_batchTasks[i].dt = dt;
+			Util::Task task;
+			task.function = &RVO2DAIModule::_runBatchTask;
+			task.data = &_batchTasks[i];
+			_batchTaskManager->addTask(task, (i == numTasks-1));
+		}
+		_batchTaskManager->waitForAllTasksToComplete();
+	}
+
+	for (unsigned int i = 0; i < numAgents; i++)
+	{
+		RVO2DAgent * agent = _batchAgents[i];
+		agent->_batchVelocityValid = true;
+
+		if (_batchCheck)
+		{
+			// the per-agent solver must give exactly the same velocity from the same state; no other agent has moved yet
+			const Util::Vector batchVelocity = agent->_newVelocity;
+			agent->computeNeighbors(_scratch[0]);
+			agent->computeNewVelocity(dt, _scratch[0]);
+			if (agent->_newVelocity.x != batchVelocity.x || agent->_newVelocity.z != batchVelocity.z)
+			{
+				_batchNumMismatches++;
+			}
+			agent->_newVelocity = batchVelocity;
+			_batchNumChecked++;
+		}
+	}
+}
+
+//
+// _runBatchTask() - the task executed by the worker threads in batch mode.
+//
+void RVO2DAIModule::_runBatchTask(unsigned int threadIndex, void * data)
+{
+	BatchTask * batchTask = (BatchTask*)data;
+	batchTask->module->_computeNewVelocities(threadIndex, batchTask->firstAgent, batchTask->endAgent, batchTask->dt);
+}
+
+//
+// _computeNewVelocities() - runs ORCA for a range of the batch agents, using the scratch buffers of one thread.
+//
+void RVO2DAIModule::_computeNewVelocities(unsigned int threadIndex, unsigned int firstAgent, unsigned int endAgent, float dt)
+{
+	RVO2DScratch & scratch = _scratch[threadIndex];
+	for (unsigned int i = firstAgent; i < endAgent; i++)
+	{
+		_batchAgents[i]->computeNeighbors(scratch);
+		_batchAgents[i]->computeNewVelocity(dt, scratch);
+	}
 }
 
 void RVO2DAIModule::postprocessFrame(float timeStamp, float dt, unsigned int frameNumber)
@@ -283,20 +410,34 @@ void RVO2DAIModule::destroyAgent( SteerLib::AgentInterface * agent )
 void RVO2DAIModule::cleanupSimulation()
 {
 	agents_.clear();
+
+	if ( _batchCheck )
+	{
+		// reported with the module's results, as "batch_check <agent updates> <updates that differ>"
+		std::stringstream batchCheckStream;
+		batchCheckStream << "batch_check " << _batchNumChecked << " " << _batchNumMismatches;
+		_data = _data + batchCheckStream.str() + "\n";
+		if ( logStats )
+		{
+			_rvoLogger->writeData(batchCheckStream.str());
+		}
+		_batchNumChecked = 0;
+		_batchNumMismatches = 0;
+	}
 	// kdTree_->deleteObstacleTree(kdTree_->obstacleTree_);
 	// kdTree_->agents_.clear();
 
 		LogObject rvoLogObject;
 
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getNumTimesExecuted());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTicksAccumulated());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinTicks());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxTicks());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getAverageExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTime());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTickFrequency());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getNumTimesExecuted());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTicksAccumulated());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMinTicks());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxTicks());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMinExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getAverageExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTime());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTickFrequency());
 
 		_logData.push_back(rvoLogObject.copy());
 	if ( logStats )
@@ -306,13 +447,13 @@ void RVO2DAIModule::cleanupSimulation()
 		// cleanup profiling metrics for next simulation/scenario
 	}
 
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
 	// kdTree_->deleteObstacleTree(kdTree_->obstacleTree_);
 }
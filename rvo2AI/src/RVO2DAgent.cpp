@@ -37,6 +37,7 @@ RVO2DAgent::RVO2DAgent()
 	_RVO2DParams.rvo_time_horizon_obstacles  = rvo_time_horizon_obstacles ;
 	_RVO2DParams.next_waypoint_distance = next_waypoint_distance;
 	_enabled = false;
+	_batchVelocityValid = false;
 }
 
 RVO2DAgent::~RVO2DAgent()
@@ -112,8 +113,10 @@ void RVO2DAgent::reset(const SteerLib::AgentInitialConditions & initialCondition
 	_waypoints.clear();
 	agentNeighbors_.clear();
 	obstacleNeighbors_.clear();
+	obstacleSegmentNeighbors_.clear();
 	orcaPlanes_.clear();
 	orcaLines_.clear();
+	_batchVelocityValid = false;
 
 	Util::AxisAlignedBox oldBounds(_position.x-_radius, _position.x+_radius, 0.0f, 0.5f, _position.z-_radius, _position.z+_radius);
 
@@ -245,12 +248,34 @@ bool compareDist(std::pair<float, const SteerLib::AgentInterface *> a1,
 		return a1.first < a2.first;
 	}
 
-void RVO2DAgent::computeNeighbors()
+void RVO2DAgent::computeNeighbors(RVO2DScratch & scratch)
 {
 	obstacleNeighbors_.clear();
+	obstacleSegmentNeighbors_.clear();
 	float rangeSq = sqr(_RVO2DParams.rvo_time_horizon_obstacles * _RVO2DParams.rvo_max_speed + _radius);
 	// dynamic_cast<RVO2DAIModule *>(rvoModule)->kdTree_->computeObstacleNeighbors(this, rangeSq);
-	getSimulationEngine()->getSpatialDatabase()->computeObstacleNeighbors(this, rangeSq);
+	/*
+	 * The spatial database finds the nearby obstacles, and the engine's compiled
+	 * obstacle outlines provide their edges.
+	 */
+	const float range = std::max(sqrtf(rangeSq), _RVO2DParams.rvo_neighbor_distance);
+	getSimulationEngine()->getSpatialDatabase()->getAgentsAndObstaclesInRange(scratch.neighborAgents, scratch.neighborObstacles,
+			_position.x - range, _position.x + range, _position.z - range, _position.z + range, this);
+	// only the loops near the agent, so that a large grid map does not contribute all of its blocked rectangles.
+	const StaticObstacleGeometry & obstacleGeometry = getSimulationEngine()->getStaticObstacleGeometry();
+	scratch.neighborObstacleLoops.clear();
+	for (unsigned int i = 0; i < scratch.neighborObstacles.size(); i++)
+	{
+		obstacleGeometry.getLoopsInRange(scratch.neighborObstacles[i], _position.x - range, _position.x + range, _position.z - range, _position.z + range, scratch.neighborObstacleLoops);
+	}
+	for (unsigned int i = 0; i < scratch.neighborObstacleLoops.size(); i++)
+	{
+		const StaticObstacleGeometry::Loop & loop = obstacleGeometry.getLoops()[scratch.neighborObstacleLoops[i]];
+		for (unsigned int s = loop.firstSegment; s < loop.firstSegment + loop.numSegments; s++)
+		{
+			insertObstacleSegmentNeighbor(&obstacleGeometry.getSegments()[s], rangeSq);
+		}
+	}
 
 	// std::cout << "Number of obstacle neighbours " << obstacleNeighbors_.size() << std::endl;
 
@@ -265,7 +290,11 @@ void RVO2DAgent::computeNeighbors()
 		rangeSq = sqr(_RVO2DParams.rvo_neighbor_distance);
 		// dynamic_cast<RVO2DAIModule *>(rvoModule)->kdTree_->computeAgentNeighbors(this, rangeSq);
 		// std::cout << "RVO spatial database: " << getSimulationEngine()->getSpatialDatabase() << std::endl;
-		getSimulationEngine()->getSpatialDatabase()->computeAgentNeighbors(this, rangeSq);
+		// the grid database does not implement computeAgentNeighbors(), so the agents come from the query above.
+		for (unsigned int i = 0; i < scratch.neighborAgents.size(); i++)
+		{
+			insertAgentNeighbor(scratch.neighborAgents[i], rangeSq);
+		}
 		/*
 		 * This was updated to use the SteerLib griddatabase instead
 		 * It is a bad idea to keep two serperate structures to facilitate
@@ -313,20 +342,21 @@ bool RVO2DAgent::compareDist(SteerLib::AgentInterface * a1, SteerLib::AgentInter
 */
 
 /* Search for the best new velocity. */
-void RVO2DAgent::computeNewVelocity(float dt)
+void RVO2DAgent::computeNewVelocity(float dt, RVO2DScratch & scratch)
 {
 	orcaLines_.clear();
 
 	const float invTimeHorizonObst = 1.0f / _RVO2DParams.rvo_time_horizon_obstacles;
 
-	/* Create obstacle ORCA lines. */
-	for (size_t i = 0; i < obstacleNeighbors_.size(); ++i) {
+	/* Create obstacle ORCA lines, from the obstacle outlines compiled by the engine. */
+	const std::vector<StaticObstacleGeometry::Segment> & segments = getSimulationEngine()->getStaticObstacleGeometry().getSegments();
+	for (size_t i = 0; i < obstacleSegmentNeighbors_.size(); ++i) {
 
-		const ObstacleInterface *obstacle1 = obstacleNeighbors_[i].second;
-		const ObstacleInterface *obstacle2 = obstacle1->nextObstacle_;
+		const StaticObstacleGeometry::Segment *obstacle1 = obstacleSegmentNeighbors_[i].second;
+		const StaticObstacleGeometry::Segment *obstacle2 = &segments[obstacle1->next];
 
-		const Util::Vector relativePosition1 = obstacle1->point_ - position();
-		const Util::Vector relativePosition2 = obstacle2->point_ - position();
+		const Util::Vector relativePosition1 = obstacle1->start - position();
+		const Util::Vector relativePosition2 = obstacle2->start - position();
 
 		/*
 		 * Check if velocity obstacle of obstacle is already taken care of by
@@ -352,7 +382,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 
 		const float radiusSq = sqr(_radius);
 
-		const Util::Vector obstacleVector = obstacle2->point_ - obstacle1->point_;
+		const Util::Vector obstacleVector = obstacle2->start - obstacle1->start;
 		const float s = (-relativePosition1 * obstacleVector) / absSq(obstacleVector);
 		const float distSqLine = absSq(-relativePosition1 - s * obstacleVector);
 
@@ -360,7 +390,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 
 		if (s < 0.0f && distSq1 <= radiusSq) {
 			/* Collision with left vertex. Ignore if non-convex. */
-			if (obstacle1->isConvex_) {
+			if (obstacle1->startIsConvex) {
 				line.point = Util::Vector(0.0f, 0.0f, 0.0f);
 				line.direction = normalize(Util::Vector(-relativePosition1.z, 0.0f, relativePosition1.x));
 				orcaLines_.push_back(line);
@@ -371,7 +401,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 		else if (s > 1.0f && distSq2 <= radiusSq) {
 			/* Collision with right vertex. Ignore if non-convex
 			 * or if it will be taken care of by neighoring obstace */
-			if (obstacle2->isConvex_ && det(relativePosition2, obstacle2->unitDir_) >= 0.0f) {
+			if (obstacle2->startIsConvex && det(relativePosition2, obstacle2->direction) >= 0.0f) {
 				line.point = Util::Vector(0.0f, 0.0f, 0.0f);
 				line.direction = normalize(Util::Vector(-relativePosition2.z, 0.0f, relativePosition2.x));
 				orcaLines_.push_back(line);
@@ -382,7 +412,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 		else if (s >= 0.0f && s < 1.0f && distSqLine <= radiusSq) {
 			/* Collision with obstacle segment. */
 			line.point = Util::Vector(0.0f, 0.0f, 0.0f);
-			line.direction = -obstacle1->unitDir_;
+			line.direction = -obstacle1->direction;
 			orcaLines_.push_back(line);
 			continue;
 		}
@@ -400,7 +430,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 			 * Obstacle viewed obliquely so that left vertex
 			 * defines velocity obstacle.
 			 */
-			if (!obstacle1->isConvex_) {
+			if (!obstacle1->startIsConvex) {
 				/* Ignore obstacle. */
 				continue;
 			}
@@ -416,7 +446,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 			 * Obstacle viewed obliquely so that
 			 * right vertex defines velocity obstacle.
 			 */
-			if (!obstacle2->isConvex_) {
+			if (!obstacle2->startIsConvex) {
 				/* Ignore obstacle. */
 				continue;
 			}
@@ -429,22 +459,22 @@ void RVO2DAgent::computeNewVelocity(float dt)
 		}
 		else {
 			/* Usual situation. */
-			if (obstacle1->isConvex_) {
+			if (obstacle1->startIsConvex) {
 				const float leg1 = std::sqrt(distSq1 - radiusSq);
 				leftLegDirection = Util::Vector(relativePosition1.x * leg1 - relativePosition1.z * radius(), 0.0f, relativePosition1.x * radius() + relativePosition1.z * leg1) / distSq1;
 			}
 			else {
 				/* Left vertex non-convex; left leg extends cut-off line. */
-				leftLegDirection = -obstacle1->unitDir_;
+				leftLegDirection = -obstacle1->direction;
 			}
 
-			if (obstacle2->isConvex_) {
+			if (obstacle2->startIsConvex) {
 				const float leg2 = std::sqrt(distSq2 - radiusSq);
 				rightLegDirection = Util::Vector(relativePosition2.x * leg2 + relativePosition2.z * radius(), 0.0f, -relativePosition2.x * radius() + relativePosition2.z * leg2) / distSq2;
 			}
 			else {
 				/* Right vertex non-convex; right leg extends cut-off line. */
-				rightLegDirection = obstacle1->unitDir_;
+				rightLegDirection = obstacle1->direction;
 			}
 		}
 
@@ -454,26 +484,26 @@ void RVO2DAgent::computeNewVelocity(float dt)
 		 * "foreign" leg, no constraint is added.
 		 */
 
-		const ObstacleInterface *const leftNeighbor = obstacle1->prevObstacle_;
+		const StaticObstacleGeometry::Segment *const leftNeighbor = &segments[obstacle1->previous];
 
 		bool isLeftLegForeign = false;
 		bool isRightLegForeign = false;
 
-		if (obstacle1->isConvex_ && det(leftLegDirection, -leftNeighbor->unitDir_) >= 0.0f) {
+		if (obstacle1->startIsConvex && det(leftLegDirection, -leftNeighbor->direction) >= 0.0f) {
 			/* Left leg points into obstacle. */
-			leftLegDirection = -leftNeighbor->unitDir_;
+			leftLegDirection = -leftNeighbor->direction;
 			isLeftLegForeign = true;
 		}
 
-		if (obstacle2->isConvex_ && det(rightLegDirection, obstacle2->unitDir_) <= 0.0f) {
+		if (obstacle2->startIsConvex && det(rightLegDirection, obstacle2->direction) <= 0.0f) {
 			/* Right leg points into obstacle. */
-			rightLegDirection = obstacle2->unitDir_;
+			rightLegDirection = obstacle2->direction;
 			isRightLegForeign = true;
 		}
 
 		/* Compute cut-off centers. */
-		const Util::Vector leftCutoff = invTimeHorizonObst * (obstacle1->point_ - position());
-		const Util::Vector rightCutoff = invTimeHorizonObst * (obstacle2->point_ - position());
+		const Util::Vector leftCutoff = invTimeHorizonObst * (obstacle1->start - position());
+		const Util::Vector rightCutoff = invTimeHorizonObst * (obstacle2->start - position());
 		const Util::Vector cutoffVec = rightCutoff - leftCutoff;
 
 		/* Project current velocity on velocity obstacle. */
@@ -512,7 +542,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 
 		if (distSqCutoff <= distSqLeft && distSqCutoff <= distSqRight) {
 			/* Project on cut-off line. */
-			line.direction = -obstacle1->unitDir_;
+			line.direction = -obstacle1->direction;
 			line.point = leftCutoff + radius() * invTimeHorizonObst * Util::Vector(-line.direction.z, 0.0f, line.direction.x);
 			orcaLines_.push_back(line);
 			continue;
@@ -614,7 +644,7 @@ void RVO2DAgent::computeNewVelocity(float dt)
 	size_t lineFail = linearProgram2(orcaLines_, _RVO2DParams.rvo_max_speed, _prefVelocity, false, _newVelocity);
 
 	if (lineFail < orcaLines_.size()) {
-		linearProgram3(orcaLines_, numObstLines, lineFail, _RVO2DParams.rvo_max_speed, _newVelocity);
+		linearProgram3(orcaLines_, numObstLines, lineFail, _RVO2DParams.rvo_max_speed, _newVelocity, scratch.projLines);
 	}
 }
 
@@ -665,17 +695,32 @@ void RVO2DAgent::insertObstacleNeighbor(const ObstacleInterface *obstacle, float
 }
 
 
-void RVO2DAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
+void RVO2DAgent::insertObstacleSegmentNeighbor(const StaticObstacleGeometry::Segment *segment, float rangeSq)
 {
-	// std::cout << "_RVO2DParams.rvo_max_speed " << _RVO2DParams._RVO2DParams.rvo_max_speed << std::endl;
-	Util::AutomaticFunctionProfiler profileThisFunction( &RVO2DGlobals::gPhaseProfilers->aiProfiler );
-	if (!enabled())
-	{
+	/* Only edges that face this agent can constrain its velocity. */
+	if (StaticObstacleGeometry::signedDistance(*segment, position()) <= 0.0f) {
 		return;
 	}
 
-	Util::AxisAlignedBox oldBounds(_position.x - _radius, _position.x + _radius, 0.0f, 0.0f, _position.z - _radius, _position.z + _radius);
-	SteerLib::AgentGoalInfo goalInfo = _goalQueue.front();
+	const float distSq = distSqPointLineSegment(segment->start, segment->end, position());
+
+	if (distSq < rangeSq) {
+		obstacleSegmentNeighbors_.push_back(std::make_pair(distSq, segment));
+
+		size_t i = obstacleSegmentNeighbors_.size() - 1;
+
+		while (i != 0 && distSq < obstacleSegmentNeighbors_[i - 1].first) {
+			obstacleSegmentNeighbors_[i] = obstacleSegmentNeighbors_[i - 1];
+			--i;
+		}
+
+		obstacleSegmentNeighbors_[i] = std::make_pair(distSq, segment);
+	}
+}
+
+
+void RVO2DAgent::computePreferredVelocity()
+{
 	Util::Vector goalDirection;
 	if ( ! _midTermPath.empty() ) // && (!this->hasLineOfSightTo(goalInfo.targetLocation)) )
 	{
@@ -691,14 +736,39 @@ void RVO2DAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 	}
 	else
 	{
-		goalDirection = normalize(goalInfo.targetLocation - position());
+		goalDirection = normalize(_goalQueue.front().targetLocation - position());
 	}
 	_prefVelocity = goalDirection * _RVO2DParams.rvo_max_speed;
 #ifdef _DEBUG_ENTROPY
 	std::cout << "Preferred velocity is: " << prefVelocity_ << std::endl;
 #endif
-	(this)->computeNeighbors();
-	(this)->computeNewVelocity(dt);
+}
+
+
+void RVO2DAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
+{
+	// std::cout << "_RVO2DParams.rvo_max_speed " << _RVO2DParams._RVO2DParams.rvo_max_speed << std::endl;
+	Util::AutomaticFunctionProfiler profileThisFunction( &static_cast<RVO2DAIModule *>(rvoModule)->getPhaseProfilers().aiProfiler );
+	if (!enabled())
+	{
+		return;
+	}
+
+	Util::AxisAlignedBox oldBounds(_position.x - _radius, _position.x + _radius, 0.0f, 0.0f, _position.z - _radius, _position.z + _radius);
+	SteerLib::AgentGoalInfo goalInfo = _goalQueue.front();
+	Util::Vector goalDirection;
+	if (_batchVelocityValid)
+	{
+		// the module already ran ORCA for this frame, see RVO2DAIModule::preprocessFrame()
+		_batchVelocityValid = false;
+	}
+	else
+	{
+		RVO2DScratch & scratch = static_cast<RVO2DAIModule *>(rvoModule)->getScratch(0);
+		(this)->computePreferredVelocity();
+		(this)->computeNeighbors(scratch);
+		(this)->computeNewVelocity(dt, scratch);
+	}
 	// (this)->computeNewVelocity(dt);
 	_prefVelocity.y = 0.0f;
 
@@ -974,14 +1044,14 @@ size_t linearProgram2(const std::vector<Line> &lines, float radius, const Util::
 	return lines.size();
 }
 
-void linearProgram3(const std::vector<Line> &lines, size_t numObstLines, size_t beginLine, float radius, Util::Vector &result)
+void linearProgram3(const std::vector<Line> &lines, size_t numObstLines, size_t beginLine, float radius, Util::Vector &result, std::vector<Line> &projLines)
 {
 	float distance = 0.0f;
 
 	for (size_t i = beginLine; i < lines.size(); ++i) {
 		if (det(lines[i].direction, lines[i].point - result) > distance) {
 			/* Result does not satisfy constraint of line i. */
-			std::vector<Line> projLines(lines.begin(), lines.begin() + static_cast<ptrdiff_t>(numObstLines));
+			projLines.assign(lines.begin(), lines.begin() + static_cast<ptrdiff_t>(numObstLines));
 
 			for (size_t j = numObstLines; j < i; ++j) {
 				Line line;
@@ -16,10 +16,6 @@
 
 
 
-// globally accessible to the simpleAI plugin
-extern SteerLib::EngineInterface * gEngine;
-extern SteerLib::SpatialDataBaseInterface * gSpatialDatabase;
-
 namespace SimpleAIGlobals {
 
 	struct PhaseProfilers {
@@ -44,8 +40,6 @@ namespace SimpleAIGlobals {
 	extern bool gUseDynamicPhaseScheduling;
 	extern bool gShowStats;
 	extern bool gShowAllStats;
-
-	extern PhaseProfilers * gPhaseProfilers;
 }
 
 
@@ -90,6 +84,10 @@ protected:
 	std::string logFilename; // = "AI.log";
 	bool logStats; // = false;
 	Logger * _logger;
+	// the engine and database are kept per module (not as globals) so that several engines can run simpleAI on different threads.
+	SteerLib::EngineInterface * _gEngine;
+	SteerLib::SpatialDataBaseInterface * _gSpatialDatabase;
+	SimpleAIGlobals::PhaseProfilers _phaseProfilers;
 };
 
 #endif
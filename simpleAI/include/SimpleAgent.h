@@ -68,6 +68,13 @@ protected:
 
 
 	virtual SteerLib::EngineInterface * getSimulationEngine();
+
+	// set by the SimpleAIModule that created this agent.
+	SteerLib::EngineInterface * _gEngine;
+	SteerLib::SpatialDataBaseInterface * _gSpatialDatabase;
+	SimpleAIGlobals::PhaseProfilers * _phaseProfilers;
+
+	friend class SimpleAIModule;
 };
 
 #endif
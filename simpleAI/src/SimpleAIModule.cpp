@@ -17,10 +17,6 @@
 #include "LogManager.h"
 
 
-// globally accessible to the simpleAI plugin
-SteerLib::EngineInterface * gEngine;
-SteerLib::SpatialDataBaseInterface * gSpatialDatabase;
-
 namespace SimpleAIGlobals
 {
 	unsigned int gLongTermPlanningPhaseInterval;
@@ -32,8 +28,6 @@ namespace SimpleAIGlobals
 	bool gUseDynamicPhaseScheduling;
 	bool gShowStats;
 	bool gShowAllStats;
-
-	PhaseProfilers * gPhaseProfilers;
 }
 
 using namespace SimpleAIGlobals;
@@ -51,8 +45,8 @@ PLUGIN_API void destroyModule( SteerLib::ModuleInterface*  module )
 
 void SimpleAIModule::init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo )
 {
-	gEngine = engineInfo;
-	gSpatialDatabase = engineInfo->getSpatialDatabase();
+	_gEngine = engineInfo;
+	_gSpatialDatabase = engineInfo->getSpatialDatabase();
 
 	gUseDynamicPhaseScheduling = false;
 	gShowStats = false;
@@ -118,15 +112,14 @@ void SimpleAIModule::initializeSimulation()
 	//
 	// initialize the performance profilers
 	//
-	gPhaseProfilers = new PhaseProfilers;
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
 
 }
 
@@ -152,27 +145,27 @@ void SimpleAIModule::cleanupSimulation()
 	{
 		LogObject logObject;
 
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getNumTimesExecuted());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTicksAccumulated());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getMinTicks());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getMaxTicks());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getMinExecutionTimeMills());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getMaxExecutionTimeMills());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getAverageExecutionTimeMills());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTime());
-		logObject.addLogData(gPhaseProfilers->aiProfiler.getTickFrequency());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getNumTimesExecuted());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getTotalTicksAccumulated());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getMinTicks());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getMaxTicks());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getMinExecutionTimeMills());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getMaxExecutionTimeMills());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getAverageExecutionTimeMills());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getTotalTime());
+		logObject.addLogData(_phaseProfilers.aiProfiler.getTickFrequency());
 
 		_logger->writeLogObject(logObject);
 
 		// cleanup profileing metrics for next simulation/scenario
-		gPhaseProfilers->aiProfiler.reset();
-		gPhaseProfilers->longTermPhaseProfiler.reset();
-		gPhaseProfilers->midTermPhaseProfiler.reset();
-		gPhaseProfilers->shortTermPhaseProfiler.reset();
-		gPhaseProfilers->perceptivePhaseProfiler.reset();
-		gPhaseProfilers->predictivePhaseProfiler.reset();
-		gPhaseProfilers->reactivePhaseProfiler.reset();
-		gPhaseProfilers->steeringPhaseProfiler.reset();
+		_phaseProfilers.aiProfiler.reset();
+		_phaseProfilers.longTermPhaseProfiler.reset();
+		_phaseProfilers.midTermPhaseProfiler.reset();
+		_phaseProfilers.shortTermPhaseProfiler.reset();
+		_phaseProfilers.perceptivePhaseProfiler.reset();
+		_phaseProfilers.predictivePhaseProfiler.reset();
+		_phaseProfilers.reactivePhaseProfiler.reset();
+		_phaseProfilers.steeringPhaseProfiler.reset();
 	}
 
 	// kdTree_->deleteObstacleTree(kdTree_->obstacleTree_);
@@ -185,7 +178,11 @@ void SimpleAIModule::finish()
 
 SteerLib::AgentInterface * SimpleAIModule::createAgent()
 {
-	return new SimpleAgent; 
+	SimpleAgent * agent = new SimpleAgent;
+	agent->_gEngine = _gEngine;
+	agent->_gSpatialDatabase = _gSpatialDatabase;
+	agent->_phaseProfilers = &_phaseProfilers;
+	return agent;
 }
 
 void SimpleAIModule::destroyAgent( SteerLib::AgentInterface * agent )
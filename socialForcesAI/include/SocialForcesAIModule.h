@@ -14,6 +14,7 @@
 #include "SteerLib.h"
 #include <vector>
 #include "SocialForces_Parameters.h"
+#include "SocialForcesBatch.h"
 #include "Logger.h"
 
 
@@ -21,6 +22,7 @@
 // extern SteerLib::EngineInterface * gEngine;
 // extern SteerLib::SpatialDataBaseInterface * gSpatialDatabase;
 
+class SocialForcesAgent;
 
 
 /**
@@ -69,6 +71,9 @@ public:
 	void postprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
 	std::vector<SteerLib::AgentInterface * > agents_;
 
+	/// Returns the profilers of this module; every engine has its own module instance, so engines that simulate on different threads do not share them.
+	SocialForcesGlobals::PhaseProfilers & getPhaseProfilers() { return _phaseProfilers; }
+
 protected:
 	std::string logFilename; // = "pprAI.log";
 	bool logStats; // = false;
@@ -77,6 +82,27 @@ protected:
 	std::vector<LogObject *> _logData;
 
 	SteerLib::EngineInterface * _gEngine;
+	SocialForcesGlobals::PhaseProfilers _phaseProfilers;
+
+	/// Computes the forces of all Social Forces agents at once, from the state at the start of the frame.
+	void _computeBatchForces(float dt);
+	/// Returns the index of the agent in _batch, adding the agent if it is not in the batch yet.
+	unsigned int _getBatchIndex(SteerLib::AgentInterface * agent);
+
+	// batch mode
+	bool _useBatch;
+	bool _batchCheck;
+	SocialForcesBatch _batch;
+	std::vector<SocialForcesAgent*> _batchAgents;
+	// the batch index of every agent in the batch, sorted by address, to find the index of a neighbor.
+	std::vector<std::pair<SteerLib::AgentInterface*, unsigned int> > _batchIndices;
+	std::vector< std::vector<SteerLib::AgentInterface*> > _batchAgentNeighbors;
+	std::vector< std::vector<SteerLib::ObstacleInterface*> > _batchObstacleNeighbors;
+	// batch_check results; a frame fails if any force component differs from the scalar functions by more than the tolerance.
+	float _batchCheckTolerance;
+	float _batchCheckMaxError;
+	unsigned int _batchCheckNumFrames;
+	unsigned int _batchCheckNumFailedFrames;
 };
 
 #endif
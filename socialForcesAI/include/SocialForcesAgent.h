@@ -12,6 +12,7 @@
 
 #include <queue>
 #include <list>
+#include <set>
 #include "SteerLib.h"
 // #include "SimpleAgent.h"
 // #include "SocialForcesAIModule.h"
@@ -104,6 +105,17 @@ private:
 	Util::Vector calcAgentRepulsionForce(float dt);
 	Util::Vector calcWallRepulsionForce(float dt);
 
+	/// Finds the agents and obstacles within the query radius of this agent.
+	void collectNeighbors(std::vector<SteerLib::AgentInterface*> & agentNeighbors, std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors);
+	/// The repulsion force of the given neighbors.
+	Util::Vector calcRepulsionForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt);
+	/// The proximity force of the given neighbors; batch mode passes no agents, because it computes the agent terms separately.
+	Util::Vector calcProximityForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt);
+	Util::Vector calcAgentRepulsionForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, float dt);
+	Util::Vector calcWallRepulsionForce(const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt);
+
+	/// Returns the distance and closest point on the face of the obstacle facing this agent, and that face's outward normal.
+	std::pair<float, Util::Point> calcWallDistance(SteerLib::ObstacleInterface* obs, Util::Vector & wall_normal);
 	Util::Vector calcWallNormal(SteerLib::ObstacleInterface* obs);
 	std::pair<Util::Point, Util::Point> calcWallPointsFromNormal(SteerLib::ObstacleInterface* obs, Util::Vector normal);
 	Util::Vector calcObsNormal(SteerLib::ObstacleInterface* obs);
@@ -111,6 +123,11 @@ private:
 	// For midterm planning stores the plan to the current goal
 	// holds the location of the best local target along the midtermpath
 
+	// In batch mode, the module computes the forces of the frame before updateAI() is called, so that every agent sees the state at the start of the frame.
+	Util::Vector _frameRepulsionForce;
+	Util::Vector _frameProximityForce;
+	bool _frameForcesValid;
+
 	friend class SocialForcesAIModule;
 
 };
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __SocialForces_BATCH__
+#define __SocialForces_BATCH__
+
+/// @file SocialForcesBatch.h
+/// @brief Declares the SocialForcesBatch class, which evaluates agent-agent social forces for all agents at once.
+
+#include <vector>
+#include <cstddef>
+
+
+/**
+ * @brief Structure-of-arrays agent data and neighbour lists for evaluating the agent-agent Social Forces terms in bulk.
+ *
+ * The Social Forces agent normally computes its forces one neighbour at a time through the AgentInterface virtual
+ * functions.  In batch mode, the SocialForcesAIModule copies the 2D (XZ) state of every enabled agent into
+ * this class once per frame, records a neighbour list for each Social Forces agent, and calls computeForces(), which
+ * evaluates the pairwise terms over the neighbour lists four neighbours at a time with SSE (or with plain C++ where SSE2
+ * is not available).
+ *
+ * The terms computed here are the agent parts of SocialForcesAgent::calcProximityForce() and
+ * SocialForcesAgent::calcAgentRepulsionForce(), using the same formulas; they match the scalar functions up to
+ * floating-point summation order and the accuracy of the vectorized exp().  The wall and obstacle terms are not
+ * vectorized; the module still computes them with the scalar functions.
+ *
+ * Without batch mode, each agent computes its forces in its own updateAI(), so it sees the agents updated before it
+ * at their new positions.  In batch mode, all forces come from the state at the start of the frame, so the trajectories
+ * of the two modes differ; the batch_check option compares the batch forces of every frame with the scalar functions
+ * evaluated on the same state, and reports the frames that differ by more than batch_check_tolerance in the module's data.
+ */
+class SocialForcesBatch
+{
+public:
+	/// The per-agent Social Forces parameters used by the agent-agent terms.
+	struct Parameters {
+		float agentA;
+		float agentB;
+		float agentBodyForce;
+		float slidingFrictionForce;
+	};
+
+	/// Removes all agents and neighbour lists.
+	void clear();
+
+	/// Adds the state of one agent, and returns its index.
+	unsigned int addAgent(float x, float z, float velocityX, float velocityZ, float radius);
+
+	/// Starts the neighbour list of one agent, which will receive the forces of the neighbours added with addNeighbor(); returns the index of the list.
+	unsigned int beginNeighborList(unsigned int agentIndex, const Parameters & parameters);
+	/// Adds a neighbour to the current list; if useRepulsion is false, only the proximity force of that neighbour is computed.
+	void addNeighbor(unsigned int neighborIndex, bool useRepulsion);
+
+	/// Computes the forces for all neighbour lists.
+	void computeForces(float dt);
+
+	unsigned int getNumAgents() const { return (unsigned int)_x.size(); }
+	unsigned int getNumNeighborLists() const { return (unsigned int)_listAgent.size(); }
+	/// Returns the total number of neighbours in all lists.
+	size_t getNumNeighbors() const { return _neighborIndex.size(); }
+
+	/// @name Results of computeForces(), per neighbour list
+	//@{
+	float getProximityForceX(unsigned int list) const { return _proximityX[list]; }
+	float getProximityForceZ(unsigned int list) const { return _proximityZ[list]; }
+	float getRepulsionForceX(unsigned int list) const { return _repulsionX[list]; }
+	float getRepulsionForceZ(unsigned int list) const { return _repulsionZ[list]; }
+	//@}
+
+protected:
+	void _computeForcesScalar(unsigned int list, float dt);
+	void _computeForcesSSE(unsigned int list, float dt);
+
+	// agent state
+	std::vector<float> _x;
+	std::vector<float> _z;
+	std::vector<float> _velocityX;
+	std::vector<float> _velocityZ;
+	std::vector<float> _radius;
+
+	// neighbour lists, stored one after another; list i uses entries _listStart[i] to _listStart[i+1]-1.
+	std::vector<unsigned int> _listAgent;
+	std::vector<Parameters> _listParameters;
+	std::vector<size_t> _listStart;
+	std::vector<unsigned int> _neighborIndex;
+	std::vector<bool> _neighborUsesRepulsion;
+
+	// results
+	std::vector<float> _proximityX;
+	std::vector<float> _proximityZ;
+	std::vector<float> _repulsionX;
+	std::vector<float> _repulsionZ;
+};
+
+
+#endif
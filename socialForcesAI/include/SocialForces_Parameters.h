@@ -42,6 +42,7 @@
 #define USE_PLANNING 1
 // #define DRAW_ANNOTATIONS 1
 #define USE_CIRCLES 1
+#define DEFAULT_BATCH_CHECK_TOLERANCE 0.0001f // largest difference of a batch force component from the scalar functions
 // #define _DEBUG_ 1
 namespace SocialForcesGlobals {
 
@@ -86,9 +87,6 @@ namespace SocialForcesGlobals {
 	extern float sf_wall_a;
 	extern float sf_max_speed;
 
-
-
-	extern PhaseProfilers * gPhaseProfilers;
 }
 
 
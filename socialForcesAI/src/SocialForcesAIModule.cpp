@@ -15,6 +15,8 @@
 #include "LogObject.h"
 #include "LogManager.h"
 
+#include <algorithm>
+
 
 // globally accessible to the simpleAI plugin
 // SteerLib::EngineInterface * gEngine;
@@ -50,9 +52,6 @@ namespace SocialForcesGlobals
 	float sf_wall_b;
 	float sf_wall_a;
 	float sf_max_speed;
-
-
-	PhaseProfilers * gPhaseProfilers;
 }
 
 using namespace SocialForcesGlobals;
@@ -81,6 +80,12 @@ void SocialForcesAIModule::init( const SteerLib::OptionDictionary & options, Ste
 	gShowAllStats = false;
 	logFilename = "sfAI.log";
 	dont_plan = false;
+	_useBatch = false;
+	_batchCheck = false;
+	_batchCheckTolerance = DEFAULT_BATCH_CHECK_TOLERANCE;
+	_batchCheckMaxError = 0.0f;
+	_batchCheckNumFrames = 0;
+	_batchCheckNumFailedFrames = 0;
 
 	sf_acceleration = ACCELERATION;
 	sf_personal_space_threshold = PERSONAL_SPACE_THRESHOLD;
@@ -175,6 +180,20 @@ void SocialForcesAIModule::init( const SteerLib::OptionDictionary & options, Ste
 		{
 			dont_plan = Util::getBoolFromString(value.str());
 		}
+		else if ((*optionIter).first == "batch")
+		{
+			_useBatch = Util::getBoolFromString(value.str());
+		}
+		else if ((*optionIter).first == "batch_check")
+		{
+			// compares every batch force against the scalar functions; implies batch mode
+			_batchCheck = Util::getBoolFromString(value.str());
+			_useBatch = _useBatch || _batchCheck;
+		}
+		else if ((*optionIter).first == "batch_check_tolerance")
+		{
+			value >> _batchCheckTolerance;
+		}
 		else
 		{
 			// throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to PPR AI module.");
@@ -213,15 +232,14 @@ void SocialForcesAIModule::initializeSimulation()
 	//
 	// initialize the performance profilers
 	//
-	gPhaseProfilers = new PhaseProfilers;
-	gPhaseProfilers->aiProfiler.reset();
-	gPhaseProfilers->longTermPhaseProfiler.reset();
-	gPhaseProfilers->midTermPhaseProfiler.reset();
-	gPhaseProfilers->shortTermPhaseProfiler.reset();
-	gPhaseProfilers->perceptivePhaseProfiler.reset();
-	gPhaseProfilers->predictivePhaseProfiler.reset();
-	gPhaseProfilers->reactivePhaseProfiler.reset();
-	gPhaseProfilers->steeringPhaseProfiler.reset();
+	_phaseProfilers.aiProfiler.reset();
+	_phaseProfilers.longTermPhaseProfiler.reset();
+	_phaseProfilers.midTermPhaseProfiler.reset();
+	_phaseProfilers.shortTermPhaseProfiler.reset();
+	_phaseProfilers.perceptivePhaseProfiler.reset();
+	_phaseProfilers.predictivePhaseProfiler.reset();
+	_phaseProfilers.reactivePhaseProfiler.reset();
+	_phaseProfilers.steeringPhaseProfiler.reset();
 
 }
 
@@ -243,9 +261,9 @@ void SocialForcesAIModule::preprocessFrame(float timeStamp, float dt, unsigned i
 		// Adding in this extra one because it seemed sometimes agents would forget about obstacles.
 
 	}
-	if ( !agents_.empty() )
+	if ( _useBatch )
 	{
-
+		_computeBatchForces(dt);
 	}
 
 	/*
@@ -256,6 +274,99 @@ void SocialForcesAIModule::preprocessFrame(float timeStamp, float dt, unsigned i
 	}*/
 }
 
+//
+// _computeBatchForces() - gathers all agents into the batch, computes the agent-agent forces with the vectorized kernel,
+// and hands the total forces to each Social Forces agent for its next updateAI().  All forces are computed from the state
+// at the start of the frame.  The wall and obstacle terms are not part of the kernel; they are still computed with the
+// scalar functions, from the obstacle neighbors of the same query.  With batch_check, the scalar functions also compute
+// the complete forces of every agent from the same state, and the largest difference of each frame is checked against
+// the tolerance.
+//
+void SocialForcesAIModule::_computeBatchForces(float dt)
+{
+	const std::vector<SteerLib::AgentInterface*> & agents = _gEngine->getAgents();
+	const std::vector<SteerLib::AgentInterface*> noAgentNeighbors;
+
+	_batch.clear();
+	_batchAgents.clear();
+	_batchIndices.clear();
+	for (unsigned int i = 0; i < agents.size(); i++) {
+		SteerLib::AgentInterface * agent = agents[i];
+		if (!agent->enabled()) {
+			continue;
+		}
+		_batchIndices.push_back(std::make_pair(agent, _batch.addAgent(agent->position().x, agent->position().z, agent->velocity().x, agent->velocity().z, agent->radius())));
+		SocialForcesAgent * sfAgent = dynamic_cast<SocialForcesAgent*>(agent);
+		if (sfAgent != NULL && sfAgent->rvoModule == this) {
+			_batchAgents.push_back(sfAgent);
+		}
+	}
+	std::sort(_batchIndices.begin(), _batchIndices.end());
+
+	// one spatial query per agent, shared by the batch kernel and the obstacle terms; the lists keep their capacity across frames.
+	if (_batchAgentNeighbors.size() < _batchAgents.size()) {
+		_batchAgentNeighbors.resize(_batchAgents.size());
+		_batchObstacleNeighbors.resize(_batchAgents.size());
+	}
+	for (unsigned int i = 0; i < _batchAgents.size(); i++) {
+		SocialForcesAgent * agent = _batchAgents[i];
+		std::vector<SteerLib::AgentInterface*> & agentNeighbors = _batchAgentNeighbors[i];
+		agent->collectNeighbors(agentNeighbors, _batchObstacleNeighbors[i]);
+
+		SocialForcesBatch::Parameters parameters;
+		parameters.agentA = agent->_SocialForcesParams.sf_agent_a;
+		parameters.agentB = agent->_SocialForcesParams.sf_agent_b;
+		parameters.agentBodyForce = agent->_SocialForcesParams.sf_agent_body_force;
+		parameters.slidingFrictionForce = agent->_SocialForcesParams.sf_sliding_friction_force;
+		_batch.beginNeighborList(_getBatchIndex(agent), parameters);
+
+		for (unsigned int n = 0; n < agentNeighbors.size(); n++) {
+			SteerLib::AgentInterface * other = agentNeighbors[n];
+			_batch.addNeighbor(_getBatchIndex(other), agent->id() != other->id());
+		}
+	}
+
+	_batch.computeForces(dt);
+
+	float frameError = 0.0f;
+	for (unsigned int i = 0; i < _batchAgents.size(); i++) {
+		SocialForcesAgent * agent = _batchAgents[i];
+		Util::Vector agentRepulsion(_batch.getRepulsionForceX(i), 0.0f, _batch.getRepulsionForceZ(i));
+		Util::Vector agentProximity(_batch.getProximityForceX(i), 0.0f, _batch.getProximityForceZ(i));
+		agent->_frameRepulsionForce = agent->calcWallRepulsionForce(_batchObstacleNeighbors[i], dt) + (agent->_SocialForcesParams.sf_agent_repulsion_importance * agentRepulsion);
+		agent->_frameProximityForce = agent->calcProximityForce(noAgentNeighbors, _batchObstacleNeighbors[i], dt) + agentProximity;
+		agent->_frameForcesValid = true;
+
+		if (_batchCheck) {
+			Util::Vector repulsionError = agent->calcRepulsionForce(_batchAgentNeighbors[i], _batchObstacleNeighbors[i], dt) - agent->_frameRepulsionForce;
+			Util::Vector proximityError = agent->calcProximityForce(_batchAgentNeighbors[i], _batchObstacleNeighbors[i], dt) - agent->_frameProximityForce;
+			frameError = std::max(frameError, std::max(std::max(fabsf(repulsionError.x), fabsf(repulsionError.z)), std::max(fabsf(proximityError.x), fabsf(proximityError.z))));
+		}
+	}
+
+	if (_batchCheck) {
+		_batchCheckMaxError = std::max(_batchCheckMaxError, frameError);
+		_batchCheckNumFrames++;
+		if (frameError > _batchCheckTolerance) {
+			_batchCheckNumFailedFrames++;
+		}
+	}
+}
+
+//
+// _getBatchIndex() - finds the agent in the sorted batch indices; every enabled agent was added at the start of the frame,
+// so only an agent that a spatial query returns while it is disabled has to be added here.
+//
+unsigned int SocialForcesAIModule::_getBatchIndex(SteerLib::AgentInterface * agent)
+{
+	std::vector<std::pair<SteerLib::AgentInterface*, unsigned int> >::iterator index;
+	index = std::lower_bound(_batchIndices.begin(), _batchIndices.end(), std::make_pair(agent, 0u));
+	if (index == _batchIndices.end() || index->first != agent) {
+		index = _batchIndices.insert(index, std::make_pair(agent, _batch.addAgent(agent->position().x, agent->position().z, agent->velocity().x, agent->velocity().z, agent->radius())));
+	}
+	return index->second;
+}
+
 void SocialForcesAIModule::postprocessFrame(float timeStamp, float dt, unsigned int frameNumber)
 {
 	// do nothing for now
@@ -323,31 +434,46 @@ void SocialForcesAIModule::cleanupSimulation()
 {
 	agents_.clear();
 
+	if ( _batchCheck )
+	{
+		// reported with the module's results, as "batch_check <frames> <frames over tolerance> <max error> <tolerance>"
+		std::stringstream batchCheckStream;
+		batchCheckStream << "batch_check " << _batchCheckNumFrames << " " << _batchCheckNumFailedFrames << " " << _batchCheckMaxError << " " << _batchCheckTolerance;
+		_data = _data + batchCheckStream.str() + "\n";
+		if ( logStats )
+		{
+			_rvoLogger->writeData(batchCheckStream.str());
+		}
+		_batchCheckMaxError = 0.0f;
+		_batchCheckNumFrames = 0;
+		_batchCheckNumFailedFrames = 0;
+	}
+
 		LogObject rvoLogObject;
 
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getNumTimesExecuted());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTicksAccumulated());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinTicks());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxTicks());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMinExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getMaxExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getAverageExecutionTimeMills());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTotalTime());
-		rvoLogObject.addLogData(gPhaseProfilers->aiProfiler.getTickFrequency());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getNumTimesExecuted());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTicksAccumulated());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMinTicks());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxTicks());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMinExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getMaxExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getAverageExecutionTimeMills());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTotalTime());
+		rvoLogObject.addLogData(_phaseProfilers.aiProfiler.getTickFrequency());
 
 		_rvoLogger->writeLogObject(rvoLogObject);
 		_data = _data + _rvoLogger->logObjectToString(rvoLogObject);
 		_logData.push_back(rvoLogObject.copy());
 
 		// cleanup profileing metrics for next simulation/scenario
-		gPhaseProfilers->aiProfiler.reset();
-		gPhaseProfilers->longTermPhaseProfiler.reset();
-		gPhaseProfilers->midTermPhaseProfiler.reset();
-		gPhaseProfilers->shortTermPhaseProfiler.reset();
-		gPhaseProfilers->perceptivePhaseProfiler.reset();
-		gPhaseProfilers->predictivePhaseProfiler.reset();
-		gPhaseProfilers->reactivePhaseProfiler.reset();
-		gPhaseProfilers->steeringPhaseProfiler.reset();
+		_phaseProfilers.aiProfiler.reset();
+		_phaseProfilers.longTermPhaseProfiler.reset();
+		_phaseProfilers.midTermPhaseProfiler.reset();
+		_phaseProfilers.shortTermPhaseProfiler.reset();
+		_phaseProfilers.perceptivePhaseProfiler.reset();
+		_phaseProfilers.predictivePhaseProfiler.reset();
+		_phaseProfilers.reactivePhaseProfiler.reset();
+		_phaseProfilers.steeringPhaseProfiler.reset();
 	if ( logStats )
 	{
 		_rvoLogger->writeLogObject(rvoLogObject);
@@ -41,6 +41,7 @@ SocialForcesAgent::SocialForcesAgent()
 	_SocialForcesParams.sf_wall_a = sf_wall_a;
 	_SocialForcesParams.sf_max_speed = sf_max_speed;
 
+	_frameForcesValid = false;
 	_enabled = false;
 }
 
@@ -246,27 +247,40 @@ std::pair<float, Util::Point> minimum_distance(Util::Point l1, Util::Point l2, U
 }
 
 
+void SocialForcesAgent::collectNeighbors(std::vector<SteerLib::AgentInterface*> & agentNeighbors, std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors)
+{
+	getSimulationEngine()->getSpatialDatabase()->getAgentsAndObstaclesInRange(agentNeighbors, obstacleNeighbors,
+			_position.x-(this->_radius + _SocialForcesParams.sf_query_radius),
+			_position.x+(this->_radius + _SocialForcesParams.sf_query_radius),
+			_position.z-(this->_radius + _SocialForcesParams.sf_query_radius),
+			_position.z+(this->_radius + _SocialForcesParams.sf_query_radius),
+			dynamic_cast<SteerLib::SpatialDatabaseItemPtr>(this));
+}
+
 Util::Vector SocialForcesAgent::calcProximityForce(float dt)
 {
-	std::set<SteerLib::SpatialDatabaseItemPtr> _neighbors;
-		getSimulationEngine()->getSpatialDatabase()->getItemsInRange(_neighbors,
-				_position.x-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.x+(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z+(this->_radius + _SocialForcesParams.sf_query_radius),
-				dynamic_cast<SteerLib::SpatialDatabaseItemPtr>(this));
+	std::vector<SteerLib::AgentInterface*> agentNeighbors;
+	std::vector<SteerLib::ObstacleInterface*> obstacleNeighbors;
+	collectNeighbors(agentNeighbors, obstacleNeighbors);
+	return calcProximityForce(agentNeighbors, obstacleNeighbors, dt);
+}
 
+Util::Vector SocialForcesAgent::calcProximityForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt)
+{
 	SteerLib::AgentInterface * tmp_agent;
 	SteerLib::ObstacleInterface * tmp_ob;
 	Util::Vector away = Util::Vector(0,0,0);
 	Util::Vector away_obs = Util::Vector(0,0,0);
 
-	for (std::set<SteerLib::SpatialDatabaseItemPtr>::iterator neighbour = _neighbors.begin();  neighbour != _neighbors.end();  neighbour++)
-	// for (int a =0; a < tmp_agents.size(); a++)
+	// visit the neighbors in address order, like the set of the original single query, so that agent and circle terms add up in the same order
+	unsigned int a = 0;
+	unsigned int o = 0;
+	while ( (a < agentNeighbors.size()) || (o < obstacleNeighbors.size()) )
 	{
-		if ( (*neighbour)->isAgent() )
+		if ( (o == obstacleNeighbors.size()) || ((a < agentNeighbors.size()) &&
+				(static_cast<SteerLib::SpatialDatabaseItemPtr>(agentNeighbors[a]) < static_cast<SteerLib::SpatialDatabaseItemPtr>(obstacleNeighbors[o]))) )
 		{
-			tmp_agent = dynamic_cast<SteerLib::AgentInterface *>(*neighbour);
+			tmp_agent = agentNeighbors[a++];
 
 			// direction away from other agent
 			Util::Vector away_tmp = normalize(position() - tmp_agent->position());
@@ -334,8 +348,7 @@ Util::Vector SocialForcesAgent::calcProximityForce(float dt)
 		}
 		else
 		{
-			// It is an obstacle
-			tmp_ob = dynamic_cast<SteerLib::ObstacleInterface *>(*neighbour);
+			tmp_ob = obstacleNeighbors[o++];
 			CircleObstacle * obs_cir = dynamic_cast<SteerLib::CircleObstacle *>(tmp_ob);
 			if ( obs_cir != NULL && USE_CIRCLES)
 			{
@@ -376,11 +389,8 @@ Util::Vector SocialForcesAgent::calcProximityForce(float dt)
 			}
 			else
 			{
-				Util::Vector wall_normal = calcWallNormal( tmp_ob );
-				std::pair<Util::Point,Util::Point> line = calcWallPointsFromNormal(tmp_ob, wall_normal);
-				// Util::Point midpoint = Util::Point((line.first.x+line.second.x)/2, ((line.first.y+line.second.y)/2)+1,
-					// 	(line.first.z+line.second.z)/2);
-				std::pair<float, Util::Point> min_stuff = minimum_distance(line.first, line.second, position());
+				Util::Vector wall_normal;
+				std::pair<float, Util::Point> min_stuff = calcWallDistance(tmp_ob, wall_normal);
 				// wall distance
 
 				Util::Vector away_obs_tmp = normalize(position() - min_stuff.second);
@@ -413,7 +423,6 @@ Util::Vector SocialForcesAgent::calcProximityForce(float dt)
 						);
 			}
 		}
-
 	}
 	return away + away_obs;
 }
@@ -424,35 +433,35 @@ Util::Vector SocialForcesAgent::calcRepulsionForce(float dt)
 	std::cout << "wall repulsion; " << calcWallRepulsionForce(dt) << " agent repulsion " <<
 			(_SocialForcesParams.sf_agent_repulsion_importance * calcAgentRepulsionForce(dt)) << std::endl;
 #endif
-	return calcWallRepulsionForce(dt) + (_SocialForcesParams.sf_agent_repulsion_importance * calcAgentRepulsionForce(dt));
+	std::vector<SteerLib::AgentInterface*> agentNeighbors;
+	std::vector<SteerLib::ObstacleInterface*> obstacleNeighbors;
+	collectNeighbors(agentNeighbors, obstacleNeighbors);
+	return calcRepulsionForce(agentNeighbors, obstacleNeighbors, dt);
+}
+
+Util::Vector SocialForcesAgent::calcRepulsionForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt)
+{
+	return calcWallRepulsionForce(obstacleNeighbors, dt) + (_SocialForcesParams.sf_agent_repulsion_importance * calcAgentRepulsionForce(agentNeighbors, dt));
 }
 
 Util::Vector SocialForcesAgent::calcAgentRepulsionForce(float dt)
+{
+	std::vector<SteerLib::AgentInterface*> agentNeighbors;
+	std::vector<SteerLib::ObstacleInterface*> obstacleNeighbors;
+	collectNeighbors(agentNeighbors, obstacleNeighbors);
+	return calcAgentRepulsionForce(agentNeighbors, dt);
+}
+
+Util::Vector SocialForcesAgent::calcAgentRepulsionForce(const std::vector<SteerLib::AgentInterface*> & agentNeighbors, float dt)
 {
 
 	Util::Vector agent_repulsion_force = Util::Vector(0,0,0);
 
-	std::set<SteerLib::SpatialDatabaseItemPtr> _neighbors;
-		getSimulationEngine()->getSpatialDatabase()->getItemsInRange(_neighbors,
-				_position.x-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.x+(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z+(this->_radius + _SocialForcesParams.sf_query_radius),
-				(this));
-
 	SteerLib::AgentInterface * tmp_agent;
 
-	for (std::set<SteerLib::SpatialDatabaseItemPtr>::iterator neighbour = _neighbors.begin();  neighbour != _neighbors.end();  neighbour++)
-	// for (int a =0; a < tmp_agents.size(); a++)
+	for (unsigned int a = 0; a < agentNeighbors.size(); a++)
 	{
-		if ( (*neighbour)->isAgent() )
-		{
-			tmp_agent = dynamic_cast<SteerLib::AgentInterface *>(*neighbour);
-		}
-		else
-		{
-			continue;
-		}
+		tmp_agent = agentNeighbors[a];
 		if ( ( id() != tmp_agent->id() ) &&
 				(tmp_agent->computePenetration(this->position(), this->radius()) > 0.000001)
 			)
@@ -496,31 +505,22 @@ Util::Vector SocialForcesAgent::calcAgentRepulsionForce(float dt)
 
 Util::Vector SocialForcesAgent::calcWallRepulsionForce(float dt)
 {
+	std::vector<SteerLib::AgentInterface*> agentNeighbors;
+	std::vector<SteerLib::ObstacleInterface*> obstacleNeighbors;
+	collectNeighbors(agentNeighbors, obstacleNeighbors);
+	return calcWallRepulsionForce(obstacleNeighbors, dt);
+}
 
-	Util::Vector wall_repulsion_force = Util::Vector(0,0,0);
-
+Util::Vector SocialForcesAgent::calcWallRepulsionForce(const std::vector<SteerLib::ObstacleInterface*> & obstacleNeighbors, float dt)
+{
 
-	std::set<SteerLib::SpatialDatabaseItemPtr> _neighbors;
-		getSimulationEngine()->getSpatialDatabase()->getItemsInRange(_neighbors,
-				_position.x-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.x+(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z-(this->_radius + _SocialForcesParams.sf_query_radius),
-				_position.z+(this->_radius + _SocialForcesParams.sf_query_radius),
-				dynamic_cast<SteerLib::SpatialDatabaseItemPtr>(this));
+	Util::Vector wall_repulsion_force = Util::Vector(0,0,0);
 
 	SteerLib::ObstacleInterface * tmp_ob;
 
-	for (std::set<SteerLib::SpatialDatabaseItemPtr>::iterator neighbour = _neighbors.begin();  neighbour != _neighbors.end();  neighbour++)
-	// for (std::set<SteerLib::ObstacleInterface * >::iterator tmp_o = _neighbors.begin();  tmp_o != _neighbors.end();  tmp_o++)
+	for (unsigned int o = 0; o < obstacleNeighbors.size(); o++)
 	{
-		if ( !(*neighbour)->isAgent() )
-		{
-			tmp_ob = dynamic_cast<SteerLib::ObstacleInterface *>(*neighbour);
-		}
-		else
-		{
-			continue;
-		}
+		tmp_ob = obstacleNeighbors[o];
 		if ( tmp_ob->computePenetration(this->position(), this->radius()) > 0.000001 )
 		{
 			CircleObstacle * cir_obs = dynamic_cast<SteerLib::CircleObstacle *>(tmp_ob);
@@ -567,11 +567,8 @@ Util::Vector SocialForcesAgent::calcWallRepulsionForce(float dt)
 			}
 			else
 			{
-				Util::Vector wall_normal = calcWallNormal( tmp_ob );
-				std::pair<Util::Point,Util::Point> line = calcWallPointsFromNormal(tmp_ob, wall_normal);
-				// Util::Point midpoint = Util::Point((line.first.x+line.second.x)/2, ((line.first.y+line.second.y)/2)+1,
-					// 	(line.first.z+line.second.z)/2);
-				std::pair<float, Util::Point> min_stuff = minimum_distance(line.first, line.second, position());
+				Util::Vector wall_normal;
+				std::pair<float, Util::Point> min_stuff = calcWallDistance(tmp_ob, wall_normal);
 				// wall distance
 				wall_repulsion_force = wall_repulsion_force +
 					((
@@ -610,6 +607,25 @@ Util::Vector SocialForcesAgent::calcWallRepulsionForce(float dt)
 	return wall_repulsion_force;
 }
 
+//
+// calcWallDistance() - finds the face of the obstacle that faces the agent; returns the distance to that face and the closest point on it.
+//
+std::pair<float, Util::Point> SocialForcesAgent::calcWallDistance(SteerLib::ObstacleInterface* obs, Util::Vector & wall_normal)
+{
+	// the engine has already compiled the outline of every static obstacle
+	const SteerLib::StaticObstacleGeometry::Segment * face = getSimulationEngine()->getStaticObstacleGeometry().findFacingSegment(obs, position());
+	if ( face != NULL )
+	{
+		wall_normal = face->normal;
+		return minimum_distance(face->start, face->end, position());
+	}
+
+	// not compiled by the engine; treat the obstacle as its bounding box
+	wall_normal = calcWallNormal( obs );
+	std::pair<Util::Point,Util::Point> line = calcWallPointsFromNormal(obs, wall_normal);
+	return minimum_distance(line.first, line.second, position());
+}
+
 std::pair<Util::Point, Util::Point> SocialForcesAgent::calcWallPointsFromNormal(SteerLib::ObstacleInterface* obs, Util::Vector normal)
 {
 	Util::AxisAlignedBox box = obs->getBounds();
@@ -766,7 +782,7 @@ void SocialForcesAgent::computeNeighbors()
 void SocialForcesAgent::updateAI(float timeStamp, float dt, unsigned int frameNumber)
 {
 	// std::cout << "_SocialForcesParams.rvo_max_speed " << _SocialForcesParams._SocialForcesParams.rvo_max_speed << std::endl;
-	Util::AutomaticFunctionProfiler profileThisFunction( &SocialForcesGlobals::gPhaseProfilers->aiProfiler );
+	Util::AutomaticFunctionProfiler profileThisFunction( &static_cast<SocialForcesAIModule *>(rvoModule)->getPhaseProfilers().aiProfiler );
 	if (!enabled())
 	{
 		return;
@@ -798,14 +814,26 @@ void SocialForcesAgent::updateAI(float timeStamp, float dt, unsigned int frameNu
 	prefForce = prefForce + velocity();
 	// _velocity = prefForce;
 
-	Util::Vector repulsionForce = calcRepulsionForce(dt);
+	Util::Vector repulsionForce;
+	Util::Vector proximityForce;
+	if (_frameForcesValid)
+	{
+		// batch mode: computed by SocialForcesAIModule::preprocessFrame() from the state at the start of this frame
+		repulsionForce = _frameRepulsionForce;
+		proximityForce = _frameProximityForce;
+		_frameForcesValid = false;
+	}
+	else
+	{
+		repulsionForce = calcRepulsionForce(dt);
+		proximityForce = calcProximityForce(dt);
+	}
 	if ( repulsionForce.x != repulsionForce.x)
 	{
 		std::cout << "Found some nan" << std::endl;
 		repulsionForce = velocity();
 		// throw GenericException("SocialForces numerical issue");
 	}
-	Util::Vector proximityForce = calcProximityForce(dt);
 // #define _DEBUG_ 1
 #ifdef _DEBUG_
 	std::cout << "agent" << id() << " repulsion force " << repulsionForce << std::endl;
@@ -904,7 +932,7 @@ void SocialForcesAgent::draw()
 					+
 					(
 						(
-							dynamic_cast<AgentInterface*>(*neighbor)->position()
+							(*neighbor)->asAgent()->position()
 							-
 							this->position()
 						)
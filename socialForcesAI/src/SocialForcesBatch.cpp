@@ -0,0 +1,268 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file SocialForcesBatch.cpp
+/// @brief Implements the SocialForcesBatch class.
+
+#include <math.h>
+#include "SocialForcesBatch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SOCIAL_FORCES_BATCH_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// same threshold as SocialForcesAgent::calcAgentRepulsionForce()
+#define PENETRATION_THRESHOLD 0.000001f
+
+
+void SocialForcesBatch::clear()
+{
+	_x.clear();
+	_z.clear();
+	_velocityX.clear();
+	_velocityZ.clear();
+	_radius.clear();
+
+	_listAgent.clear();
+	_listParameters.clear();
+	_listStart.clear();
+	_listStart.push_back(0);
+	_neighborIndex.clear();
+	_neighborUsesRepulsion.clear();
+}
+
+unsigned int SocialForcesBatch::addAgent(float x, float z, float velocityX, float velocityZ, float radius)
+{
+	_x.push_back(x);
+	_z.push_back(z);
+	_velocityX.push_back(velocityX);
+	_velocityZ.push_back(velocityZ);
+	_radius.push_back(radius);
+	return (unsigned int)_x.size() - 1;
+}
+
+unsigned int SocialForcesBatch::beginNeighborList(unsigned int agentIndex, const Parameters & parameters)
+{
+	if (_listStart.empty()) {
+		_listStart.push_back(0);
+	}
+	_listAgent.push_back(agentIndex);
+	_listParameters.push_back(parameters);
+	_listStart.push_back(_neighborIndex.size());
+	return (unsigned int)_listAgent.size() - 1;
+}
+
+void SocialForcesBatch::addNeighbor(unsigned int neighborIndex, bool useRepulsion)
+{
+	_neighborIndex.push_back(neighborIndex);
+	_neighborUsesRepulsion.push_back(useRepulsion);
+	_listStart.back() = _neighborIndex.size();
+}
+
+void SocialForcesBatch::computeForces(float dt)
+{
+	_proximityX.assign(_listAgent.size(), 0.0f);
+	_proximityZ.assign(_listAgent.size(), 0.0f);
+	_repulsionX.assign(_listAgent.size(), 0.0f);
+	_repulsionZ.assign(_listAgent.size(), 0.0f);
+
+	for (unsigned int list = 0; list < _listAgent.size(); list++) {
+#ifdef SOCIAL_FORCES_BATCH_USE_SSE
+		_computeForcesSSE(list, dt);
+#else
+		_computeForcesScalar(list, dt);
+#endif
+	}
+}
+
+
+//
+// _computeForcesScalar() - the reference version of the kernel; used where SSE2 is not available.
+//
+void SocialForcesBatch::_computeForcesScalar(unsigned int list, float dt)
+{
+	const Parameters & params = _listParameters[list];
+	unsigned int i = _listAgent[list];
+
+	for (size_t k = _listStart[list]; k < _listStart[list+1]; k++) {
+		unsigned int j = _neighborIndex[k];
+		float dx = _x[i] - _x[j];
+		float dz = _z[i] - _z[j];
+		float dist = sqrtf(dx*dx + dz*dz);
+		float distInv = 1.0f / dist;
+		float penetration = (_radius[i] + _radius[j]) - dist;
+
+		// proximity force: exponential falloff away from the neighbour
+		float proximity = params.agentA * expf(penetration / params.agentB);
+		_proximityX[list] += dx * distInv * proximity * dt;
+		_proximityZ[list] += dz * distInv * proximity * dt;
+
+		if (!_neighborUsesRepulsion[k] || !(penetration > PENETRATION_THRESHOLD)) {
+			continue;
+		}
+
+		// body force along the normal, and sliding friction along the tangent
+		float body = penetration * params.agentBodyForce * dt;
+		float c = dx * _velocityZ[i] - dz * _velocityX[i];
+		float tangentX = -c * dz;
+		float tangentZ = c * dx;
+		float tangentLengthInv = 1.0f / sqrtf(tangentX*tangentX + tangentZ*tangentZ);
+		tangentX *= tangentLengthInv;
+		tangentZ *= tangentLengthInv;
+		float tangentVelocityDiff = (_velocityX[j] - _velocityX[i]) * tangentX + (_velocityZ[j] - _velocityZ[i]) * tangentZ;
+		float friction = params.slidingFrictionForce * dt * penetration * tangentVelocityDiff;
+
+		_repulsionX[list] += body * dx * distInv + friction * tangentX;
+		_repulsionZ[list] += body * dz * distInv + friction * tangentZ;
+	}
+}
+
+
+#ifdef SOCIAL_FORCES_BATCH_USE_SSE
+
+//
+// _expSSE() - exp() of four floats, using the range reduction and polynomial of the Cephes expf(); relative error is about 1e-7.
+//
+static inline __m128 _expSSE(__m128 x)
+{
+	// the constant is the first operand, so that NaN inputs stay NaN.
+	x = _mm_min_ps(_mm_set1_ps(88.3762626647949f), x);
+	x = _mm_max_ps(_mm_set1_ps(-88.3762626647949f), x);
+
+	// exp(x) = 2^n * exp(r), where n = floor(x / ln(2) + 0.5)
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	fx = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, fx), _mm_set1_ps(1.0f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 y = _mm_set1_ps(1.9875691500e-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+
+	__m128i n = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127));
+	return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+}
+
+static inline float _horizontalSumSSE(__m128 v)
+{
+	float lanes[4];
+	_mm_storeu_ps(lanes, v);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+
+//
+// _computeForcesSSE() - the same computation as _computeForcesScalar(), four neighbours at a time.
+//
+void SocialForcesBatch::_computeForcesSSE(unsigned int list, float dt)
+{
+	const Parameters & params = _listParameters[list];
+	unsigned int i = _listAgent[list];
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 dtV = _mm_set1_ps(dt);
+	const __m128 agentA = _mm_set1_ps(params.agentA);
+	const __m128 agentB = _mm_set1_ps(params.agentB);
+	const __m128 bodyForce = _mm_set1_ps(params.agentBodyForce);
+	const __m128 slidingFrictionForce = _mm_set1_ps(params.slidingFrictionForce);
+	const __m128 threshold = _mm_set1_ps(PENETRATION_THRESHOLD);
+
+	const __m128 xi = _mm_set1_ps(_x[i]);
+	const __m128 zi = _mm_set1_ps(_z[i]);
+	const __m128 velocityXi = _mm_set1_ps(_velocityX[i]);
+	const __m128 velocityZi = _mm_set1_ps(_velocityZ[i]);
+	const __m128 radiusI = _mm_set1_ps(_radius[i]);
+
+	__m128 proximityX = zero;
+	__m128 proximityZ = zero;
+	__m128 repulsionX = zero;
+	__m128 repulsionZ = zero;
+
+	const size_t end = _listStart[list+1];
+	for (size_t k = _listStart[list]; k < end; k += 4) {
+		// gather up to four neighbours; unused lanes get a harmless far-away neighbour and are masked out.
+		float x[4], z[4], velocityX[4], velocityZ[4], radius[4], valid[4], useRepulsion[4];
+		for (unsigned int lane = 0; lane < 4; lane++) {
+			if (k + lane < end) {
+				unsigned int j = _neighborIndex[k + lane];
+				x[lane] = _x[j];
+				z[lane] = _z[j];
+				velocityX[lane] = _velocityX[j];
+				velocityZ[lane] = _velocityZ[j];
+				radius[lane] = _radius[j];
+				valid[lane] = 1.0f;
+				useRepulsion[lane] = _neighborUsesRepulsion[k + lane] ? 1.0f : 0.0f;
+			}
+			else {
+				x[lane] = _x[i] + 1000.0f;
+				z[lane] = _z[i];
+				velocityX[lane] = 0.0f;
+				velocityZ[lane] = 0.0f;
+				radius[lane] = 0.0f;
+				valid[lane] = 0.0f;
+				useRepulsion[lane] = 0.0f;
+			}
+		}
+		const __m128 validMask = _mm_cmpgt_ps(_mm_loadu_ps(valid), zero);
+		const __m128 velocityXj = _mm_loadu_ps(velocityX);
+		const __m128 velocityZj = _mm_loadu_ps(velocityZ);
+
+		__m128 dx = _mm_sub_ps(xi, _mm_loadu_ps(x));
+		__m128 dz = _mm_sub_ps(zi, _mm_loadu_ps(z));
+		__m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)));
+		__m128 distInv = _mm_div_ps(one, dist);
+		__m128 penetration = _mm_sub_ps(_mm_add_ps(radiusI, _mm_loadu_ps(radius)), dist);
+		__m128 normalX = _mm_mul_ps(dx, distInv);
+		__m128 normalZ = _mm_mul_ps(dz, distInv);
+
+		// proximity force: exponential falloff away from the neighbour
+		__m128 proximity = _mm_mul_ps(_mm_mul_ps(agentA, _expSSE(_mm_div_ps(penetration, agentB))), dtV);
+		proximityX = _mm_add_ps(proximityX, _mm_and_ps(validMask, _mm_mul_ps(normalX, proximity)));
+		proximityZ = _mm_add_ps(proximityZ, _mm_and_ps(validMask, _mm_mul_ps(normalZ, proximity)));
+
+		// body force along the normal, and sliding friction along the tangent
+		__m128 repulsionMask = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(useRepulsion), zero), _mm_cmpgt_ps(penetration, threshold));
+		if (_mm_movemask_ps(repulsionMask) == 0) {
+			continue;
+		}
+		__m128 body = _mm_mul_ps(_mm_mul_ps(penetration, bodyForce), dtV);
+		__m128 c = _mm_sub_ps(_mm_mul_ps(dx, velocityZi), _mm_mul_ps(dz, velocityXi));
+		__m128 tangentX = _mm_sub_ps(zero, _mm_mul_ps(c, dz));
+		__m128 tangentZ = _mm_mul_ps(c, dx);
+		__m128 tangentLengthInv = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(tangentX, tangentX), _mm_mul_ps(tangentZ, tangentZ))));
+		tangentX = _mm_mul_ps(tangentX, tangentLengthInv);
+		tangentZ = _mm_mul_ps(tangentZ, tangentLengthInv);
+		__m128 tangentVelocityDiff = _mm_add_ps(
+			_mm_mul_ps(_mm_sub_ps(velocityXj, velocityXi), tangentX),
+			_mm_mul_ps(_mm_sub_ps(velocityZj, velocityZi), tangentZ));
+		__m128 friction = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(slidingFrictionForce, dtV), penetration), tangentVelocityDiff);
+
+		repulsionX = _mm_add_ps(repulsionX, _mm_and_ps(repulsionMask, _mm_add_ps(_mm_mul_ps(body, normalX), _mm_mul_ps(friction, tangentX))));
+		repulsionZ = _mm_add_ps(repulsionZ, _mm_and_ps(repulsionMask, _mm_add_ps(_mm_mul_ps(body, normalZ), _mm_mul_ps(friction, tangentZ))));
+	}
+
+	_proximityX[list] = _horizontalSumSSE(proximityX);
+	_proximityZ[list] = _horizontalSumSSE(proximityZ);
+	_repulsionX[list] = _horizontalSumSSE(repulsionX);
+	_repulsionZ[list] = _horizontalSumSSE(repulsionZ);
+}
+
+#else
+
+void SocialForcesBatch::_computeForcesSSE(unsigned int list, float dt)
+{
+	_computeForcesScalar(list, dt);
+}
+
+#endif
@@ -26,27 +26,36 @@
 #include "testcaseio/TestCaseIO.h"
 #include "testcaseio/AgentInitialConditions.h"
 #include "testcaseio/ObstacleInitialConditions.h"
+#include "testcaseio/MovingAIIO.h"
 
 #include "griddatabase/GridCell.h"
 #include "interfaces/SpatialDataBaseInterface.h"
 #include "util/GenericException.h"
 #include "griddatabase/GridDatabasePlanningDomain.h"
+#include "griddatabase/HashedGridDatabase2D.h"
 
 #include "obstacles/BoxObstacle.h"
 #include "obstacles/OrientedBoxObstacle.h"
 #include "obstacles/CircleObstacle.h"
+#include "obstacles/GridMapObstacle.h"
+#include "obstacles/StaticObstacleGeometry.h"
 
 #include "planning/BestFirstSearchPlanner.h"
 
 #include "simulation/Camera.h"
 #include "simulation/Clock.h"
+#include "simulation/RenderSnapshot.h"
 #include "simulation/SimulationOptions.h"
 #include "simulation/SimulationEngine.h"
+#include "simulation/SimulationSnapshot.h"
 #include "simulation/SteeringCommand.h"
+#include "simulation/TopDownRenderer.h"
 
 #include "benchmarking/AgentMetricsCollector.h"
 #include "benchmarking/MetricsData.h"
 #include "benchmarking/SimulationMetricsCollector.h"
+#include "benchmarking/StreamingMetrics.h"
+#include "benchmarking/PathPlanningBenchmark.h"
 #include "benchmarking/BenchmarkEngine.h"
 #include "benchmarking/CompositeTechnique01.h"
 #include "benchmarking/CompositeTechnique02.h"
@@ -63,10 +72,12 @@
 
 #include "modules/DummyAIModule.h"
 #include "modules/MetricsCollectorModule.h"
+#include "modules/PathPlanningBenchmarkModule.h"
 #include "modules/RecFilePlayerModule.h"
 #include "modules/SimulationRecorderModule.h"
 #include "modules/SteerBenchModule.h"
 #include "modules/SteerBugModule.h"
 #include "modules/TestCasePlayerModule.h"
+#include "modules/TopDownRendererModule.h"
 
 #endif
@@ -13,14 +13,19 @@
 #include "util/Color.h"
 #include "util/CommandLineParser.h"
 #include "util/DrawLib.h"
+#include "util/DrawBatch.h"
 #include "util/DynamicLibrary.h"
 #include "util/GenericException.h"
 #include "util/Geometry.h"
+#include "util/Geometry2D.h"
 #include "util/HighResCounter.h"
+#include "util/ImageWriter.h"
 #include "util/MemoryMapper.h"
 #include "util/Misc.h"
 #include "util/Mutex.h"
 #include "util/PerformanceProfiler.h"
+#include "util/PhaseScheduler.h"
+#include "util/RasterImage.h"
 #include "util/StateMachine.h"
 #include "util/ThreadedTaskManager.h"
 #include "util/XMLParser.h"
@@ -23,6 +23,7 @@
 #include "interfaces/SpatialDataBaseInterface.h"
 #include "recfileio/RecFileIO.h"
 #include "benchmarking/MetricsData.h"
+#include "benchmarking/StreamingMetrics.h"
 #include "interfaces/AgentInterface.h"
 
 #define ANGULAR_PRIORITY 1.0f
@@ -55,12 +56,17 @@ namespace SteerLib {
 	 * Anyone interested in scrutinizing the benchmark process will want to look at the update()
 	 * function here as well as the implementation of individual benchmark techniques.
 	 *
+	 * The "over window" metrics are computed from fixed-size sliding windows (see WindowedMetric and MetricsWindowSizes),
+	 * so their memory does not grow with the length of the simulation.  Of a collision that has ended, only the maximum
+	 * penetration and the duration are kept.  Thresholds that are queried often can be registered with
+	 * addCollisionThreshold(), so that getNumThresholdedCollisions() does not scan the past collisions.
+	 *
 	 */
 	class STEERLIB_API AgentMetricsCollector
 	{
 	public:
 		/// During initialization, the metrics collector is permanently associated with a particular agent.
-		AgentMetricsCollector( SteerLib::AgentInterface * agent );
+		AgentMetricsCollector( SteerLib::AgentInterface * agent, const MetricsWindowSizes & windowSizes = MetricsWindowSizes() );
 		/// Resets all metrics, and uses the latest status of the agent to form new initial conditions.
 		void reset();
 		/// Should be called exactly once every simulation step, after the agent has been updated in that step.
@@ -71,11 +77,23 @@ namespace SteerLib {
 		/// Returns all the metrics in their current form.
 		AgentMetrics * getCurrentMetrics() { return &_metrics; }
 		/// Returns information about all current collisions.
-		std::map<uintptr_t, SteerLib::CollisionInfo> * getCurrentCollisions() { return &_currentCollidingObjects; }
+		SteerLib::CollisionTable * getCurrentCollisions() { return &_currentCollidingObjects; }
 		/// Returns the number of total unique collisions, both past and present.
-	    size_t getNumTotalCollisions() { return _pastCollisions.size() + _currentCollidingObjects.size(); }
-		/// Returns the number of unique past collisions (i.e. ones that are no longer still in a collision state) that are greater than both specified thresholds.
+	    size_t getNumTotalCollisions() { return _numPastCollisions + _currentCollidingObjects.size(); }
+		/// Returns the number of unique collisions, past and present, that are greater than both specified thresholds; past collisions are counted on demand unless the thresholds were registered with addCollisionThreshold().
 	    unsigned int getNumThresholdedCollisions(float penetrationThreshold, float timeDurationThreshold); // implemented in .cpp
+		/// Keeps a running count of the past collisions that are greater than both thresholds, so that getNumThresholdedCollisions() answers them without a scan.
+	    void addCollisionThreshold(float penetrationThreshold, float timeDurationThreshold);
+		/// Returns the sizes of the sliding windows.
+	    const MetricsWindowSizes & getWindowSizes() const { return _windowSizes; }
+		//@}
+
+	    /// @name the sliding windows of per-frame values, e.g. for their variance, minimum or maximum
+		//@{
+	    const WindowedMetric & getDistanceWindow() const { return _distanceWindow; }
+	    const WindowedMetric & getTurnWindow() const { return _turnWindow; }
+	    const WindowedMetric & getChangeInSpeedWindow() const { return _changeInSpeedWindow; }
+	    const WindowedMetric & getAccelerationWindow() const { return _accelerationWindow; }
 		//@}
 	    
 	    /// dumps formatted console output with information of all current statistics.
@@ -87,6 +105,21 @@ namespace SteerLib {
 		void _updateCollisionStats(SteerLib::SpatialDataBaseInterface * gridDB, SteerLib::AgentInterface * updatedAgent, float currentTimeStamp);
 	    void _checkAndUpdateOneCollision(uintptr_t collisionKey, float penetration, float currentTimeStamp);
 	    void _updateAgentInformation(SteerLib::AgentInterface * updatedAgent);
+	    void _resetWindows();
+	    unsigned int _countPastCollisions(float penetrationThreshold, float timeDurationThreshold);
+
+	    /// The number of past collisions greater than a penetration and duration threshold.
+	    struct ThresholdedCollisionCount {
+	        float penetrationThreshold;
+	        float timeDurationThreshold;
+	        unsigned int numPastCollisions;
+	    };
+
+	    /// What is kept of a collision that has ended.
+	    struct PastCollision {
+	        float maxPenetration;
+	        float timeDuration;
+	    };
 
 	    unsigned int _numFramesMeasured;
 
@@ -101,19 +134,23 @@ namespace SteerLib {
 	    AgentMetrics _metrics;
 	    
 	    // window statistics:
-	    // these arrays can be accessed like normal arrays, but they also have functionality to implement a sliding window.
-	    windowArray<Util::Point> _positionWindow; // stores the agent position at each frame
-	    //windowArray<int> _collisionWindow; // stores the number of collisions each frame
-	    windowArray<float> _turnWindow; // stores the amount of turning each frame
-	    windowArray<float> _distanceWindow; // stores the distance traveled each frame
-	    windowArray<float> _changeInSpeedWindow; // stores the change in speed at each frame
-	    windowArray<Util::Vector> _velocityWindow; // stores the velocity vector at each frame
-	    windowArray<float> _accelerationWindow; // stores the *magnitude* only of change in velocity (not instantaneous acceleration) at each frame.
-	    windowArray<Util::Vector> _instantaneousAccelerationWindow; // stores the *magnitude* only of change in velocity (not instantaneous acceleration) at each frame.
+	    // sliding windows over the last frames, with running aggregates; their sizes are set by _windowSizes.
+	    MetricsWindowSizes _windowSizes;
+	    MetricRingBuffer<Util::Point> _positionWindow; // stores the agent position at each frame
+	    WindowedMetric _turnWindow; // stores the amount of turning each frame
+	    WindowedMetric _distanceWindow; // stores the distance traveled each frame
+	    WindowedMetric _changeInSpeedWindow; // stores the change in speed at each frame
+	    WindowedMetric _accelerationWindow; // stores the *magnitude* only of change in velocity (not instantaneous acceleration) at each frame.
+	    WindowedMetric _velocitySignChangeWindow; // stores 1 for each frame where the velocity changed sign (relative to the previous frame), otherwise 0
+	    WindowedMetric _accelerationSignChangeWindow; // stores 1 for each frame where the instantaneous acceleration changed sign, otherwise 0
+	    Util::Vector _previousVelocity;
+	    Util::Vector _previousInstantaneousAcceleration;
 
 		// collision history
-		std::map<uintptr_t, SteerLib::CollisionInfo> _currentCollidingObjects; // a list of agents and obstacles that this agent is colliding with.  hopefully won't ever be too large.
-	    std::vector<CollisionInfo> _pastCollisions;
+		SteerLib::CollisionTable _currentCollidingObjects; // a list of agents and obstacles that this agent is colliding with.  hopefully won't ever be too large.
+	    unsigned int _numPastCollisions;
+	    std::vector<PastCollision> _pastCollisions;
+	    std::vector<ThresholdedCollisionCount> _thresholdedCollisionCounts;
 	};
 
 
@@ -136,6 +136,8 @@ Functionality shared by the various filters.
 #include <vector>
 #include <stdlib.h>
 #include "util/dmatrix.h"
+#include "util/FixedMatrix.h"
+#include "mersenne/MersenneTwister.h"
 #include "benchmarking/CompositeTechniqueEntropy.h"
 
 
@@ -202,6 +204,34 @@ namespace Util {
 		return u * sqrt(-2*log(s)/s);
 	}
 
+	/*!
+	*  @brief       Randomly samples from the uniform distribution over range [0,1], using the specified
+	*               random number generator instead of rand().
+	*  @returns     A uniform random number in [0,1].
+	*  \ingroup globalfunc
+	*/
+	inline double mrandom(MTRand & randomNumberGenerator) {
+		return randomNumberGenerator.rand();
+	}
+
+	/*!
+	*  @brief       Randomly samples from the univariate standard Gaussian distribution N(0,1), using the
+	*               specified random number generator instead of rand().
+	*  @returns     A random number from the univariate standard Gaussian distribution N(0,1).
+	*  \ingroup globalfunc
+	*/
+	inline double normal(MTRand & randomNumberGenerator) {
+		double u, v, s(0);
+
+		while (s == 0 || s > 1) {
+			u = 2*mrandom(randomNumberGenerator)-1;
+			v = 2*mrandom(randomNumberGenerator)-1;
+			s = u*u + v*v;
+		}
+
+		return u * sqrt(-2*log(s)/s);
+	}
+
 	/*!
 	*  @brief       Randomly samples from the multivariate standard Gaussian distribution N(0,I).
 	*  @tparam      dim     The dimension of the distribution.
@@ -216,6 +246,21 @@ namespace Util {
 		return sample;
 	}
 
+	/*!
+	*  @brief       Randomly samples from the multivariate standard Gaussian distribution N(0,I), using the
+	*               specified random number generator instead of rand().
+	*  @tparam      dim     The dimension of the distribution.
+	*  @returns     A random vector from the multivariate standard Gaussian distribution N(0,I).
+	*  \ingroup globalfunc
+	*/
+	inline Matrix sampleGaussian(size_t dim, MTRand & randomNumberGenerator) {
+		Matrix sample(dim);
+		for (size_t j = 0; j < dim; ++j) {
+			sample[j] = normal(randomNumberGenerator);
+		}
+		return sample;
+	}
+
 	/*!
 	*  @brief       Randomly samples from the multivariate Gaussian distribution with specified
 	*               mean and variance.
@@ -240,6 +285,93 @@ namespace Util {
 		return SVec * SVal * sample + mean;
 	}
 
+	/*!
+	*  @brief       Transforms a sample of the multivariate standard Gaussian distribution N(0,I) into a
+	*               sample of the Gaussian distribution with specified mean and variance.
+	*  @tparam      dim     The dimension of the distribution.
+	*  @param       sample  The sample from N(0,I).
+	*  @param       mean    The mean of the distribution.
+	*  @param       var     The variance (covariance matrix) of the distribution.
+	*  @returns     The corresponding sample of the specified Gaussian distribution.
+	*  \ingroup globalfunc
+	*/
+	template <size_t dim>
+	inline FixedMatrix<dim,1> gaussianFromStandardSample(const FixedMatrix<dim,1>& sample, const FixedMatrix<dim,1>& mean, const FixedMatrix<dim,dim>& var) {
+		FixedMatrix<dim,dim> SVec, SVal;
+		jacobi(var, SVec, SVal);
+		for (size_t i = 0; i < dim; ++i) {
+			if (SVal(i,i) < 0) {
+				SVal(i,i) = 0;
+			} else {
+				SVal(i,i) = sqrt(SVal(i,i));
+			}
+		}
+		return SVec * SVal * sample + mean;
+	}
+
+	/*!
+	*  @brief       Randomly samples from the multivariate standard Gaussian distribution N(0,I), without
+	*               allocating.
+	*  @tparam      dim     The dimension of the distribution.
+	*  @returns     A random vector from the multivariate standard Gaussian distribution N(0,I); the same
+	*               vector as sampleGaussian(dim) would give.
+	*  \ingroup globalfunc
+	*/
+	template <size_t dim>
+	inline FixedMatrix<dim,1> sampleGaussian() {
+		FixedMatrix<dim,1> sample;
+		for (size_t j = 0; j < dim; ++j) {
+			sample[j] = normal();
+		}
+		return sample;
+	}
+
+	/*!
+	*  @brief       Randomly samples from the multivariate Gaussian distribution with specified
+	*               mean and variance, without allocating.
+	*  @tparam      dim     The dimension of the distribution.
+	*  @param       mean    The mean of the distribution.
+	*  @param       var     The variance (covariance matrix) of the distribution.
+	*  @returns     A random vector from the specified Gaussian distribution; the same vector as
+	*               sampleGaussian(const Matrix&, const Matrix&) would give.
+	*  \ingroup globalfunc
+	*/
+	template <size_t dim>
+	inline FixedMatrix<dim,1> sampleGaussian(const FixedMatrix<dim,1>& mean, const FixedMatrix<dim,dim>& var) {
+		return gaussianFromStandardSample(sampleGaussian<dim>(), mean, var);
+	}
+
+	/*!
+	*  @brief       Randomly samples from the multivariate standard Gaussian distribution N(0,I), without
+	*               allocating, using the specified random number generator instead of rand().
+	*  @tparam      dim     The dimension of the distribution.
+	*  @returns     A random vector from the multivariate standard Gaussian distribution N(0,I).
+	*  \ingroup globalfunc
+	*/
+	template <size_t dim>
+	inline FixedMatrix<dim,1> sampleGaussian(MTRand & randomNumberGenerator) {
+		FixedMatrix<dim,1> sample;
+		for (size_t j = 0; j < dim; ++j) {
+			sample[j] = normal(randomNumberGenerator);
+		}
+		return sample;
+	}
+
+	/*!
+	*  @brief       Randomly samples from the multivariate Gaussian distribution with specified
+	*               mean and variance, without allocating, using the specified random number generator
+	*               instead of rand().
+	*  @tparam      dim     The dimension of the distribution.
+	*  @param       mean    The mean of the distribution.
+	*  @param       var     The variance (covariance matrix) of the distribution.
+	*  @returns     A random vector from the specified Gaussian distribution.
+	*  \ingroup globalfunc
+	*/
+	template <size_t dim>
+	inline FixedMatrix<dim,1> sampleGaussian(const FixedMatrix<dim,1>& mean, const FixedMatrix<dim,dim>& var, MTRand & randomNumberGenerator) {
+		return gaussianFromStandardSample(sampleGaussian<dim>(randomNumberGenerator), mean, var);
+	}
+
 	/*!
 	*  @brief       Evaluates the probability density function of a multivariate Gaussian distribution
 	with zero mean and specified variance at a specified point.
@@ -496,22 +628,14 @@ namespace Util {
 	}
 
 	/*!
-	*  @brief       Performs the measurement update step of the Ensemble Kalman Filter.
-	*  @tparam      xDim    The dimension of the state.
-	*  @tparam      zDim    The dimension of the measurement.
-	*  @tparam      nDim    The dimension of the measurement noise.
-	*  @param[in,out]       X       In: the ensemble of states defining the prior distribution.
-	*                              Out: the ensemble of states defining the posterior distribution.
-	*                              It is required that the ensemble size (<i>|X|</i>) is bigger than the dimension
-	*                              of the measurement, i.e. <i>|X| > zDim</i>, to prevent singularities in the
-	*                              computation.
+	*  @brief       Performs the measurement update step of the Ensemble Kalman Filter, given the
+	*               measurements predicted for each ensemble member.
+	*  @param[in,out]       X       The ensemble of states, as for the other enkfMeasurementUpdate().
+	*  @param       Z       The measurement predicted by <i>h</i> for each ensemble member.
 	*  @param       z       The measurement that is incorporated.
-	*  @param       h       A pointer to the measurement function of the form <i>z = h(x,n), n ~ N(0,I)</i>, that is
-	*                       used to perform the measurement update step.
 	*  \ingroup enkf
 	*/
-	inline void enkfMeasurementUpdate(std::vector<Matrix>& X, const Matrix& z,
-			size_t nDim, SteerLib::CompositeTechniqueEntropy * entropy2)
+	inline void enkfMeasurementUpdate(std::vector<Matrix>& X, const std::vector<Matrix>& Z, const Matrix& z)
 	{
 		size_t xDim = X[0].numRows();
 		size_t zDim = z.numRows();
@@ -523,12 +647,6 @@ namespace Util {
 		}
 		xHat /= (double)X.size();
 
-		// run ensemble members through h -- O(N*zDim)
-		std::vector<Matrix> Z(X.size());
-		for (size_t i = 0; i < Z.size(); ++i) {
-			Z[i] = entropy2->h(X[i], sampleGaussian(nDim));
-		}
-
 		// compute mean measurement -- O(N*zDim)
 		Matrix zHat = zeros(zDim);
 		for (size_t i = 0; i < Z.size(); ++i) {
@@ -538,16 +656,22 @@ namespace Util {
 		}
 		zHat /= (double)Z.size();
 
+		// the deviations from the means are computed into these, so the loops below do not allocate
+		Matrix dx(xDim), dz(zDim);
+
 		// calculate variance -- O(N*zDim*zDim)
 		Matrix Pzz = zeros(zDim,zDim);
 		for (size_t i = 0; i < Z.size(); ++i) {
-			Pzz += (Z[i] - zHat)*~(Z[i] - zHat);
+			subtract(Z[i], zHat, dz);
+			addOuterProduct(Pzz, dz, dz);
 		}
 
 		// calculate cross-covariance -- O(N*xDim*zDim)
 		Matrix Pxz = zeros(xDim,zDim);
 		for (size_t i = 0; i < Z.size(); ++i) {
-			Pxz += (X[i] - xHat)*~(Z[i] - zHat);
+			subtract(X[i], xHat, dx);
+			subtract(Z[i], zHat, dz);
+			addOuterProduct(Pxz, dx, dz);
 		}
 
 		// compute Kalman gain -- O(xDim*zDim*zDim + zDim^3)
@@ -555,8 +679,61 @@ namespace Util {
 
 		// update ensemble members -- O(N*xDim*zDim)
 		for (size_t i = 0; i < X.size(); ++i) {
-			X[i] += K*(z - Z[i]);
+			subtract(z, Z[i], dz);
+			multiplyAdd(X[i], K, dz);
+		}
+	}
+
+	/*!
+	*  @brief       Performs the measurement update step of the Ensemble Kalman Filter.
+	*  @tparam      xDim    The dimension of the state.
+	*  @tparam      zDim    The dimension of the measurement.
+	*  @tparam      nDim    The dimension of the measurement noise.
+	*  @param[in,out]       X       In: the ensemble of states defining the prior distribution.
+	*                              Out: the ensemble of states defining the posterior distribution.
+	*                              It is required that the ensemble size (<i>|X|</i>) is bigger than the dimension
+	*                              of the measurement, i.e. <i>|X| > zDim</i>, to prevent singularities in the
+	*                              computation.
+	*  @param       z       The measurement that is incorporated.
+	*  @param       h       A pointer to the measurement function of the form <i>z = h(x,n), n ~ N(0,I)</i>, that is
+	*                       used to perform the measurement update step.
+	*  \ingroup enkf
+	*/
+	inline void enkfMeasurementUpdate(std::vector<Matrix>& X, const Matrix& z,
+			size_t nDim, SteerLib::CompositeTechniqueEntropy * entropy2)
+	{
+		// run ensemble members through h -- O(N*zDim)
+		std::vector<Matrix> Z(X.size());
+		for (size_t i = 0; i < Z.size(); ++i) {
+			Z[i] = entropy2->h(X[i], sampleGaussian(nDim));
+		}
+
+		enkfMeasurementUpdate(X, Z, z);
+	}
+
+	/*!
+	*  @brief       Performs the measurement update step of the Ensemble Kalman Filter, drawing the
+	*               measurement noise of each ensemble member from its own random number generator.
+	*
+	*  The result does not depend on the order in which the ensemble members were propagated, which
+	*  makes it suitable for ensembles that are propagated on several threads.
+	*  @param[in,out]       X       The ensemble of states, as for the other enkfMeasurementUpdate().
+	*  @param       z       The measurement that is incorporated.
+	*  @param       randomNumberGenerators  One random number generator per ensemble member.
+	*  \ingroup enkf
+	*/
+	inline void enkfMeasurementUpdate(std::vector<Matrix>& X, const Matrix& z,
+			size_t nDim, SteerLib::CompositeTechniqueEntropy * entropy2, const std::vector<MTRand*>& randomNumberGenerators)
+	{
+		assert(randomNumberGenerators.size() == X.size());
+
+		// run ensemble members through h -- O(N*zDim)
+		std::vector<Matrix> Z(X.size());
+		for (size_t i = 0; i < Z.size(); ++i) {
+			Z[i] = entropy2->h(X[i], sampleGaussian(nDim, *randomNumberGenerators[i]));
 		}
+
+		enkfMeasurementUpdate(X, Z, z);
 	}
 
 	/*!
@@ -593,10 +770,14 @@ namespace Util {
 		}
 		zHat /= (double)Z.size();
 
+		// the deviations from the means are computed into these, so the loops below do not allocate
+		Matrix dx(xDim), dz(zDim);
+
 		// calculate variance -- O(N*zDim*zDim)
 		Matrix Pzz = zeros(zDim,zDim);
 		for (size_t i = 0; i < Z.size(); ++i) {
-			Pzz += (Z[i] - zHat)*~(Z[i] - zHat);
+			subtract(Z[i], zHat, dz);
+			addOuterProduct(Pzz, dz, dz);
 		}
 
 		for (size_t t = 0; t < Xs.size(); ++t) {
@@ -611,7 +792,9 @@ namespace Util {
 			// calculate cross-covariance -- O(N*xDim*zDim)
 			Matrix Pxz = zeros(xDim,zDim);
 			for (size_t i = 0; i < Z.size(); ++i) {
-				Pxz += (Xs[t][i] - xHat)*~(Z[i] - zHat);
+				subtract(Xs[t][i], xHat, dx);
+				subtract(Z[i], zHat, dz);
+				addOuterProduct(Pxz, dx, dz);
 			}
 
 			// compute Kalman gain -- O(xDim*zDim*zDim + zDim^3)
@@ -619,7 +802,8 @@ namespace Util {
 
 			// update ensemble members -- O(N*xDim*zDim)
 			for (size_t i = 0; i < Xs[t].size(); ++i) {
-				Xs[t][i] += K*(z - Z[i]);
+				subtract(z, Z[i], dz);
+				multiplyAdd(Xs[t][i], K, dz);
 			}
 		}
 	}
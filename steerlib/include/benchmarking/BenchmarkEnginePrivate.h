@@ -14,6 +14,7 @@
 #include "Globals.h"
 #include "interfaces/BenchmarkTechniqueInterface.h"
 #include "interfaces/ObstacleInterface.h"
+#include "recfileio/RecFileIO.h"
 #include "benchmarking/AgentMetricsCollector.h"
 #include "benchmarking/SimulationMetricsCollector.h"
 #include "benchmarking/BenchmarkEnginePrivate.h"
@@ -105,6 +106,7 @@ namespace SteerLib {
 		unsigned int _currentFrameNumber;
 		SteerLib::SpatialDataBaseInterface * _spatialDatabase;
 		SteerLib::RecFileReader * _recFileReader;
+		std::vector<SteerLib::RecFileAgentState> _agentStates;
 		std::vector<SteerLib::AgentInterface*> _agents;
 		std::vector<SteerLib::ObstacleInterface*> _obstacles;
 		SteerLib::SimulationMetricsCollector * _simulationMetricsCollector;
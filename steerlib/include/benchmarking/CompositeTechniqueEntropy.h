@@ -19,12 +19,22 @@
 #include "util/GenericException.h"
 #include "interfaces/AgentInterface.h"
 #include "util/dmatrix.h"
+#include "util/ThreadedTaskManager.h"
+#include "simulation/SimulationOptions.h"
 #include "CompositeTechnique02.h"
 
+class MTRand;
+
 //  rm frames/frame*.ppm; ../build/bin/steersim -module scenario,scenarioAI=pprAI,useBenchmark,benchmarkTechnique=compositeEntropy,benchmarkLog=data//0/test.log,checkAgentValid,reducedGoals,fixedSpeed,checkAgentRelevant,minAgents=3,ailogFileName=data//0/pprAI.log,maxFrames=2000,checkAgentInteraction,egocentric,RealDataName=data/RealWorldData/bot-300-050-050_combined_MB.txt,scenarioSetPath=data/RealWorldData/ou-060-180-180/,scenarioSetInitId=0,numScenarios=1,dbName=steersuitedb,skipInsert=True,ped_max_speed=4.000000,ped_max_force=11.477351,ped_max_speed_factor=1.036524,ped_faster_speed_factor=1.910091,ped_slightly_faster_speed_factor=3.193959,ped_typical_speed_factor=1.500000,ped_slightly_slower_speed_factor=0.700720,ped_slower_speed_factor=0.633337,ped_cornering_turn_rate=3.760000,ped_adjustment_turn_rate=1.540000,ped_faster_avoidance_turn_rate=1.154095,ped_typical_avoidance_turn_rate=0.182240,ped_braking_rate=0.661048,ped_comfort_zone=0.753389,ped_query_radius=7.348530,ped_similar_direction_dot_product_threshold=0.856956,ped_same_direction_dot_product_threshold=0.890000,ped_oncoming_prediction_threshold=-0.924088,ped_oncoming_reaction_threshold=-0.869304,ped_wrong_direction_dot_product_threshold=0.580059,ped_threat_distance_threshold=12.600148,ped_threat_min_time_threshold=1.166572,ped_threat_max_time_threshold=4.975509,ped_predictive_anticipation_factor=5.844836,ped_reactive_anticipation_factor=0.330000,ped_crowd_influence_factor=0.247909,ped_facing_static_object_threshold=0.215440,ped_ordinary_steering_strength=0.050671,ped_oncoming_threat_avoidance_strength=0.075143,ped_cross_threat_avoidance_strength=0.874220,ped_max_turning_rate=0.230000,ped_feeling_crowded_threshold=4.000000,ped_scoot_rate=0.371777,ped_reached_target_distance_threshold=0.614635,ped_dynamic_collision_padding=0.305582,ped_furthest_local_target_distance=36.000000,ped_next_waypoint_distance=38.000000,ped_max_num_waypoints=16.000000,recFile=ppr_opt_18-agent.rec -config configs/Entropy-config.xml -saveFramesTo frames/
 
+/// The default number of threads that propagate the ensemble; 0 keeps the propagation on the simulation engine itself.
+#define DEFAULT_NUM_ENTROPY_THREADS 0
+/// The default seed of the random number generators of the ensemble members, used when the ensemble is propagated on worker engines.
+#define DEFAULT_ENTROPY_SEED 1
+
 namespace SteerLib
 {
+	class SimulationEngine;
 
 	class STEERLIB_API CompositeTechniqueEntropy : public SteerLib::CompositeBenchmarkTechnique02
 	{
@@ -204,6 +214,46 @@ namespace SteerLib
 		unsigned int _f_hat_calls;
 		unsigned int _replay_data;
 
+		/*
+		 * Propagation of the ensemble members on worker engines (the numEntropyThreads option).
+		 *
+		 * Every worker has its own engine, with its own instance of the agent module and its own agents, so
+		 * ensemble members can be simulated concurrently.  Each ensemble member draws its noise from its own
+		 * random number generator, so the result only depends on entropySeed and not on the number of threads.
+		 * Agent modules that keep their engine or agents in globals (reactiveAI) get no workers, and the ensemble is
+		 * propagated on the simulation engine as with numEntropyThreads 0.
+		 */
+		struct Worker {
+			SteerLib::SimulationEngine * engine;
+			SteerLib::ModuleInterface * agentModule;
+		};
+
+		struct PropagationTask {
+			CompositeTechniqueEntropy * technique;
+			unsigned int sampleIndex;
+			/// If false, the states are propagated without motion noise.
+			bool addNoise;
+			/// The states that are propagated one after another, each one time step.
+			std::vector<const Matrix*> states;
+			std::vector<Matrix> results;
+			std::string errorMessage;
+		};
+
+		Matrix _propagateSample(const Matrix& x, const Matrix& m1, SteerLib::EngineInterface * engine,
+				SteerLib::ModuleInterface * agentModule, MTRand * randomNumberGenerator);
+		void _createWorkers();
+		void _destroyWorkers();
+		void _propagate(std::vector<PropagationTask> & tasks);
+		void _propagateEnsemble(std::vector<Matrix> & X);
+		static void _runPropagationTask(unsigned int threadIndex, void * data);
+
+		unsigned int _numThreads;
+		unsigned int _randomSeed;
+		std::vector<Worker> _workers;
+		std::vector<MTRand*> _sampleRandomNumberGenerators;
+		SteerLib::SimulationOptions _workerOptions;
+		Util::ThreadedTaskManager * _taskManager;
+
 	};
 }
 
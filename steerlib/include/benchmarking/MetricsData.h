@@ -17,6 +17,7 @@
 ///   - where does CollisionInfo belong?
 ///
 
+#include <vector>
 #include "Globals.h"
 #include "util/Geometry.h"
 #include "util/Misc.h"
@@ -36,6 +37,100 @@ namespace SteerLib {
 	};
 
 
+	/**
+	 * @brief A flat hash table of the CollisionInfo of current collisions, keyed by CollisionInfo::collisionKey.
+	 *
+	 * Each agent's metrics collector looks up every neighbor in this table every frame, so it is an open-addressing
+	 * table with linear probing in one contiguous array instead of a node-based std::map.  Collision keys are the
+	 * addresses of spatial database items, so a key of 0 marks an empty slot.  Erasing shifts the following entries
+	 * back instead of leaving tombstones, so lookups stay short however many collisions start and end.
+	 *
+	 * Iterate over the entries by checking isOccupied() for each slot from 0 to getNumSlots()-1; the order of the
+	 * slots is unspecified.
+	 */
+	class STEERLIB_API CollisionTable
+	{
+	public:
+		CollisionTable() : _numEntries(0) { }
+
+		/// Removes all entries, but keeps the allocated slots.
+		void clear() {
+			for (size_t i=0; i < _slots.size(); i++) _slots[i].collisionKey = 0;
+			_numEntries = 0;
+		}
+		size_t size() const { return _numEntries; }
+		bool empty() const { return _numEntries == 0; }
+
+		/// Returns the entry with the given key, or NULL if there is none.
+		CollisionInfo * find(uintptr_t collisionKey) {
+			if (_numEntries == 0) return NULL;
+			for (size_t i = _homeSlot(collisionKey); ; i = (i+1) & (_slots.size()-1)) {
+				if (_slots[i].collisionKey == collisionKey) return &_slots[i];
+				if (_slots[i].collisionKey == 0) return NULL;
+			}
+		}
+
+		/// Adds an entry whose key is not in the table yet, and returns the stored copy.
+		CollisionInfo & insert(const CollisionInfo & collision) {
+			assert(collision.collisionKey != 0);
+			assert(find(collision.collisionKey) == NULL);
+			if ((_numEntries+1)*4 > _slots.size()*3) _grow();
+			size_t i = _homeSlot(collision.collisionKey);
+			while (_slots[i].collisionKey != 0) i = (i+1) & (_slots.size()-1);
+			_slots[i] = collision;
+			_numEntries++;
+			return _slots[i];
+		}
+
+		/// Removes the entry with the given key and copies it to erasedCollision; returns false if there is no such entry.
+		bool erase(uintptr_t collisionKey, CollisionInfo & erasedCollision) {
+			CollisionInfo * found = find(collisionKey);
+			if (found == NULL) return false;
+			erasedCollision = *found;
+
+			// move later entries of the same probe sequence back into the hole, so that find() still reaches them.
+			const size_t mask = _slots.size()-1;
+			size_t hole = (size_t)(found - &_slots[0]);
+			for (size_t i = (hole+1) & mask; _slots[i].collisionKey != 0; i = (i+1) & mask) {
+				size_t home = _homeSlot(_slots[i].collisionKey);
+				if (((i - home) & mask) >= ((i - hole) & mask)) {
+					_slots[hole] = _slots[i];
+					hole = i;
+				}
+			}
+			_slots[hole].collisionKey = 0;
+			_numEntries--;
+			return true;
+		}
+
+		size_t getNumSlots() const { return _slots.size(); }
+		bool isOccupied(size_t slot) const { return _slots[slot].collisionKey != 0; }
+		const CollisionInfo & getSlot(size_t slot) const { return _slots[slot]; }
+
+	protected:
+		size_t _homeSlot(uintptr_t collisionKey) const {
+			// the low bits of an address are mostly zero, so mix the key before masking.
+			size_t hash = (size_t)(collisionKey >> 3) * (size_t)2654435761u;
+			return (hash ^ (hash >> 16)) & (_slots.size()-1);
+		}
+
+		void _grow() {
+			std::vector<CollisionInfo> oldSlots;
+			oldSlots.swap(_slots);
+			CollisionInfo emptySlot;
+			emptySlot.collisionKey = 0;
+			_slots.assign(oldSlots.empty() ? 8 : oldSlots.size()*2, emptySlot);
+			_numEntries = 0;
+			for (size_t i=0; i < oldSlots.size(); i++) {
+				if (oldSlots[i].collisionKey != 0) insert(oldSlots[i]);
+			}
+		}
+
+		std::vector<CollisionInfo> _slots;
+		size_t _numEntries;
+	};
+
+
 	/**
 	 * @brief Contains all metrics for an agent.
 	 *
@@ -167,45 +262,6 @@ namespace SteerLib {
 	};
 
 
-
-
-#define WINDOW_SIZE 60
-
-	/**
-	* @brief Implements a history window for a metric over 60 frames.
-	*
-	* @todo
-	*  - need to migrate to a time interval rather than specific number of frames for window analysis.
-	*    the time interval should probably be 3 seconds.
-	*
-	*/
-	template <class T> class STEERLIB_API windowArray {
-	public:
-		windowArray() {
-			start = 0;
-			end = WINDOW_SIZE - 1;
-		}
-		int size() {
-			return WINDOW_SIZE;
-		}
-		void advanceByOne(T newValue) {
-			start = start+1;
-			end = (start+WINDOW_SIZE-1) % WINDOW_SIZE;
-			values[end] = newValue;
-		}
-		T& operator[] (int index) { 
-			if ((index < 0) || (index >= WINDOW_SIZE)) {
-				throw Util::GenericException("windowArray[" + Util::toString(index) + "] out of range.  Valid range is 0 to " + Util::toString(WINDOW_SIZE-1) + ".");
-			}
-			int realIndex = (start+index)%WINDOW_SIZE;
-			return values[realIndex];
-		}
-	private:
-		unsigned int start, end;
-		T values[WINDOW_SIZE];
-	};
-
-
 } // end namespace SteerLib
 
 #endif
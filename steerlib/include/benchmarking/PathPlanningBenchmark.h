@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_PATH_PLANNING_BENCHMARK_H__
+#define __STEERLIB_PATH_PLANNING_BENCHMARK_H__
+
+/// @file PathPlanningBenchmark.h
+/// @brief Declares SteerLib::PathPlanningBenchmark, which measures path planners on the queries of a MovingAI .scen file.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Globals.h"
+#include "interfaces/PlanningDomainInterface.h"
+#include "obstacles/GridMapObstacle.h"
+#include "testcaseio/MovingAIIO.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+/// The default search horizon given to findPath() for each benchmark query.
+#define DEFAULT_PATH_BENCHMARK_MAX_NODES 1000000
+
+namespace SteerLib {
+
+	class GridDatabase2D;
+
+	/**
+	 * @brief The measurements of one planner over all the queries of a scenario.
+	 *
+	 * Lengths are in map cells, like the optimal lengths of the .scen file.  The suboptimality of a query is the length
+	 * of the path found divided by the optimal length, so 1.0 is optimal; it is only averaged over the queries that
+	 * reached their goal.
+	 */
+	struct STEERLIB_API PathPlanningBenchmarkResults {
+		std::string plannerName;
+		unsigned int numQueries;
+		/// Queries where findPath() returned true and the path ends at the goal cell.
+		unsigned int numPathsFound;
+		/// Total time spent in findPath(), in seconds.
+		double totalTime;
+		double queriesPerSecond;
+		unsigned long long totalNodesExpanded;
+		double meanNodesExpanded;
+		/// The planner's own estimate of its memory, from PlanningDomainInterface::getMemoryUsage(); 0 if it does not keep one.
+		size_t memoryUsage;
+		double meanSuboptimality;
+		double maxSuboptimality;
+	};
+
+	/**
+	 * @brief Runs the start/goal queries of a MovingAI scenario through any path planner and reports how it performs.
+	 *
+	 * Each query is planned with PlanningDomainInterface::findPath() between the centers of its start and goal cells
+	 * in the given map.  The benchmark measures queries per second, the search nodes expanded, the memory the planner
+	 * reports, and the suboptimality of each path against the reference length in the .scen file.
+	 *
+	 * The planner must already know the map: createGridDatabaseForMap() builds a grid database that matches it cell
+	 * for cell, for the grid A* of GridDatabasePlanningDomain.  Planners that belong to the engine, such as the
+	 * navigation mesh planner, are benchmarked by the pathPlanningBenchmark module after the map is loaded as a test case.
+	 *
+	 * Example, for the grid A*:
+	 * \code
+	 * GridMapObstacle * map = MovingAIReader::readMap("arena.map");
+	 * std::vector<MovingAIScenarioEntry> entries;
+	 * MovingAIReader::readScenario("arena.map.scen", entries);
+	 * GridDatabase2D * grid = PathPlanningBenchmark::createGridDatabaseForMap(map);
+	 * GridDatabasePlanningDomain gridDomain(grid, NULL);
+	 * PathPlanningBenchmark benchmark(map, entries);
+	 * PathPlanningBenchmarkResults results;
+	 * benchmark.run("gridDomain", &gridDomain, DEFAULT_PATH_BENCHMARK_MAX_NODES, results);
+	 * PathPlanningBenchmark::printResults(std::cout, results);
+	 * \endcode
+	 */
+	class STEERLIB_API PathPlanningBenchmark {
+	public:
+		/// The map and the entries are not copied, and must remain valid while the benchmark is used.
+		PathPlanningBenchmark(GridMapObstacle * map, const std::vector<MovingAIScenarioEntry> & entries);
+
+		/// Plans every query with the given planner; throws a Util::GenericException if a query lies outside the map.
+		void run(const std::string & plannerName, PlanningDomainInterface * planner, unsigned int maxNodesToExpand, PathPlanningBenchmarkResults & results);
+
+		/// Writes the results in a human-readable form.
+		static void printResults(std::ostream & out, const PathPlanningBenchmarkResults & results);
+
+		/// Creates a grid database with one grid cell per map cell, containing the map; the caller owns the database and the map.
+		static GridDatabase2D * createGridDatabaseForMap(GridMapObstacle * map);
+
+	protected:
+		/// Returns the length of a path in map cells.
+		float _computePathLength(const std::vector<Util::Point> & path);
+
+		GridMapObstacle * _map;
+		const std::vector<MovingAIScenarioEntry> & _entries;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
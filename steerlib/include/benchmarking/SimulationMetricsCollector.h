@@ -17,6 +17,7 @@
 #include "interfaces/SpatialDataBaseInterface.h"
 #include "recfileio/RecFileIO.h"
 #include "interfaces/AgentInterface.h"
+#include "util/ThreadedTaskManager.h"
 
 #ifdef _WIN32
 // on win32, there is an unfortunate conflict between exporting symbols for a
@@ -32,13 +33,19 @@ namespace SteerLib {
 	/**
 	 * @brief Functionality for collecting all metrics of a simulation, including an AgentMetricsCollector for each agent.
 	 *
+	 * If the collector is created with more than one thread, update() splits the agents into contiguous ranges and
+	 * updates the agent collectors of each range in parallel.  Each AgentMetricsCollector only changes its own data,
+	 * and only reads the (already updated) agents and the spatial database, so the results are exactly the same as
+	 * updating the agents one after another.  The spatial database must allow concurrent range queries, which
+	 * the grid database does.
+	 *
 	 * @todo
 	 *    - add more documentation for this class
 	 */
     class STEERLIB_API SimulationMetricsCollector
 	{
 	public:
-	    SimulationMetricsCollector( const std::vector<SteerLib::AgentInterface*> & agents);
+	    SimulationMetricsCollector( const std::vector<SteerLib::AgentInterface*> & agents, unsigned int numThreads = 1, const MetricsWindowSizes & windowSizes = MetricsWindowSizes());
 	    ~SimulationMetricsCollector();
 	    
 		void reset();
@@ -48,14 +55,34 @@ namespace SteerLib {
 	    size_t getNumAgents() { return _agentCollectors.size(); }
 
 		void printCurrentMetrics(unsigned int agentIndex, std::ostream & out);
+		/// Calls AgentMetricsCollector::addCollisionThreshold() for every agent.
+		void addCollisionThreshold(float penetrationThreshold, float timeDurationThreshold);
 
 	protected:
 	    void _resetEnvironmentMetrics();
 	    void _updateAgentMetrics(SteerLib::SpatialDataBaseInterface * gridDB, const std::vector<SteerLib::AgentInterface*> & updatedAgents, float currentTimeStamp, float timePassedSinceLastFrame);
 	    void _updateEnvironmentMetrics(SteerLib::SpatialDataBaseInterface * gridDB, float currentTimeStamp, float timePassedSinceLastFrame);
-	    
+	    void _updateAgentMetricsRange(unsigned int firstAgent, unsigned int endAgent);
+	    static void _runUpdateTask(unsigned int threadIndex, void * data);
+
+	    /// A contiguous range of agents updated by one task.
+	    struct UpdateTask {
+	        SimulationMetricsCollector * collector;
+	        unsigned int firstAgent;
+	        unsigned int endAgent;
+	    };
+
 	    std::vector<AgentMetricsCollector*> _agentCollectors;
 	    EnvironmentMetrics _environmentMetrics;
+
+	    Util::ThreadedTaskManager * _taskManager;
+	    std::vector<UpdateTask> _updateTasks;
+
+	    // arguments of the update() in progress, read by the update tasks
+	    SteerLib::SpatialDataBaseInterface * _currentGridDB;
+	    const std::vector<SteerLib::AgentInterface*> * _currentAgents;
+	    float _currentTimeStamp;
+	    float _currentTimePassed;
     
 	};
     
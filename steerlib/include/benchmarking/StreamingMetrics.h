@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_STREAMING_METRICS_H__
+#define __STEERLIB_STREAMING_METRICS_H__
+
+/// @file StreamingMetrics.h
+/// @brief Declares fixed-size sliding windows with incrementally updated aggregates, used by the metrics collectors.
+
+#include <vector>
+#include "Globals.h"
+#include "util/GenericException.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+/// The default number of frames in each sliding window of the agent metrics.
+#define DEFAULT_METRICS_WINDOW_SIZE 60
+/// The frame rate assumed when converting a window of frames into a duration, for the "average over window" metrics.
+#define METRICS_WINDOW_FRAMES_PER_SECOND 20.0f
+
+namespace SteerLib {
+
+	/**
+	 * @brief A ring buffer that keeps the most recent values, up to a capacity chosen before use.
+	 *
+	 * Once the buffer is full, each push() overwrites the oldest value, so the memory used never grows.  Index 0 is
+	 * the oldest value and index size()-1 the newest.
+	 */
+	template <class T> class MetricRingBuffer {
+	public:
+		MetricRingBuffer() : _start(0), _size(0) { }
+		explicit MetricRingBuffer(unsigned int capacity) : _values(capacity), _start(0), _size(0) { }
+
+		/// Discards all values and sets a new capacity.
+		void setCapacity(unsigned int capacity) { _values.assign(capacity, T()); clear(); }
+		/// Discards all values, keeping the capacity.
+		void clear() { _start = 0; _size = 0; }
+
+		unsigned int capacity() const { return (unsigned int)_values.size(); }
+		unsigned int size() const { return _size; }
+		bool full() const { return _size == _values.size(); }
+
+		/// Adds a value; if the buffer is full, the oldest value is removed.
+		void push(const T & value) {
+			if (_values.empty()) return;
+			if (full()) {
+				_values[_start] = value;
+				_start = (_start + 1) % _values.size();
+			}
+			else {
+				_values[(_start + _size) % _values.size()] = value;
+				_size++;
+			}
+		}
+
+		/// Removes the oldest value; the buffer must not be empty.
+		void popOldest() { _start = (_start + 1) % _values.size(); _size--; }
+		/// Removes the newest value; the buffer must not be empty.
+		void popNewest() { _size--; }
+
+		/// Returns the i-th oldest value.
+		const T & operator[](unsigned int i) const { return _values[(_start + i) % _values.size()]; }
+		const T & oldest() const { return (*this)[0]; }
+		const T & newest() const { return (*this)[_size - 1]; }
+
+	protected:
+		std::vector<T> _values;
+		unsigned int _start;
+		unsigned int _size;
+	};
+
+
+	/**
+	 * @brief A sliding window of scalar samples with O(1) updates of its sum, mean, variance, minimum and maximum.
+	 *
+	 * The sum and the mean and variance (Welford's algorithm, extended to remove the sample that leaves the window)
+	 * are updated incrementally in double precision.  So that rounding errors cannot build up over a long run, they
+	 * are recomputed from the samples each time the window has been completely replaced, which keeps the cost of
+	 * push() constant on average.  The minimum and maximum are kept with monotonic queues of at most one window of
+	 * entries each.
+	 */
+	class STEERLIB_API WindowedMetric {
+	public:
+		WindowedMetric();
+		explicit WindowedMetric(unsigned int windowSize);
+
+		/// Discards all samples and sets the number of samples in the window; throws if windowSize is 0.
+		void setWindowSize(unsigned int windowSize);
+		/// Discards all samples.
+		void clear();
+
+		/// Adds a sample; once the window is full, the oldest sample leaves the window.
+		void push(float value);
+
+		unsigned int windowSize() const { return _samples.capacity(); }
+		unsigned int size() const { return _samples.size(); }
+		bool full() const { return _samples.full(); }
+		/// Returns the i-th oldest sample in the window.
+		float operator[](unsigned int i) const { return _samples[i]; }
+
+		/// @name Aggregates over the samples currently in the window; all are 0 if the window is empty.
+		//@{
+		float sum() const { return (float)_sum; }
+		float mean() const { return (float)_mean; }
+		/// The population variance of the samples in the window.
+		float variance() const { return (_samples.size() == 0) ? 0.0f : (float)(_m2 / (double)_samples.size()); }
+		float min() const { return (_minQueue.size() == 0) ? 0.0f : _minQueue.oldest().value; }
+		float max() const { return (_maxQueue.size() == 0) ? 0.0f : _maxQueue.oldest().value; }
+		//@}
+
+	protected:
+		struct QueueEntry {
+			unsigned long long sampleNumber;
+			float value;
+		};
+
+		void _recomputeAggregates();
+		void _pushToQueue(MetricRingBuffer<QueueEntry> & queue, float value, bool keepLarger);
+
+		MetricRingBuffer<float> _samples;
+		unsigned long long _numSamplesPushed;
+		unsigned int _numPushedSinceRecompute;
+		double _sum;
+		double _mean;
+		double _m2;
+		MetricRingBuffer<QueueEntry> _minQueue;
+		MetricRingBuffer<QueueEntry> _maxQueue;
+	};
+
+
+	/**
+	 * @brief The number of frames in each sliding window used by an AgentMetricsCollector.
+	 *
+	 * All windows default to DEFAULT_METRICS_WINDOW_SIZE frames.
+	 */
+	struct STEERLIB_API MetricsWindowSizes {
+		MetricsWindowSizes() {
+			distanceWindowSize = DEFAULT_METRICS_WINDOW_SIZE;
+			turningWindowSize = DEFAULT_METRICS_WINDOW_SIZE;
+			changeInSpeedWindowSize = DEFAULT_METRICS_WINDOW_SIZE;
+			accelerationWindowSize = DEFAULT_METRICS_WINDOW_SIZE;
+		}
+		/// Window of the distance traveled, the displacement, and the number of times the velocity changed sign.
+		unsigned int distanceWindowSize;
+		/// Window of the degrees turned.
+		unsigned int turningWindowSize;
+		/// Window of the change in speed.
+		unsigned int changeInSpeedWindowSize;
+		/// Window of the acceleration, and the number of times the acceleration changed sign.
+		unsigned int accelerationWindowSize;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
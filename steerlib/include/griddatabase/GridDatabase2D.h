@@ -57,6 +57,8 @@ namespace SteerLib {
 	 *    number of cells to create along the x and z directions.
 	 *  - You also define the max number of items to store in each cell.  Trying to storing more than 
 	 *    this number of items in a single grid cell will cause a Util::GenericException to be thrown.
+	 *  - A GridMapObstacle is not referenced from the cells.  The database adds its traversal cost to the cells that
+	 *    contain its blocked map cells, and tests it directly in the neighbor, overlap and ray tracing queries.
 	 *
 	 * <h3> Performance considerations </h3>
 	 * Algorithmically, all types of queries are fairly efficient, by narrowing the computation cost down to 
@@ -109,6 +111,8 @@ namespace SteerLib {
 		inline unsigned int getNumCellsX() { return _xNumCells; }
 		/// Returns the number of grid cells along the a direction.
 		inline unsigned int getNumCellsZ() { return _zNumCells; }
+		/// Returns the number of bytes used by the grid cells, their item lists, and the bitmaps of the obstacle layers.
+		size_t getMemoryUsage();
 		//@}
 
 		/// @name Conversions between index, location, and grid coordinates
@@ -155,8 +159,12 @@ namespace SteerLib {
 		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
 		/// Returns an STL set of objects found in the specified range of GridCells.
 		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex, SpatialDatabaseItemPtr exclude);
+		/// Returns the agents and obstacles found in the specified spatial range as two separate lists, without building an STL set.
+		void getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
 		void computeAgentNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const ;
 		void computeObstacleNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const ;
+		/// Returns true if any object in the database overlaps the circle (p, radius); unlike getItemsInRange() this does not build an STL set.
+		bool overlapsAnyItem(const Util::Point & p, float radius, bool excludeAgents);
 		/// Returns an STL set of objects in the specified range, culling agent objects to a hemisphere centered around the facingDirection.
 		void getItemsInVisualField(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude, const Util::Point & position, const Util::Vector & facingDirection, float radiusSquared);
 		//@}
@@ -203,6 +211,8 @@ namespace SteerLib {
 
 		/// Uses openGL and DrawLib to visualize the grid.
 		void draw();
+		/// Copies the cells that draw() would shade; returns false if the grid is not drawn.
+		bool getCellsToDraw(std::vector<GridCellRenderState> & cells);
 
 		/// Gets the location of this agent, really used to get the y-location
 		virtual Util::Point getLocation(SpatialDatabaseItemPtr exclude1) { return Util::Point(0.0,0.0,0.0); }
@@ -210,6 +220,14 @@ namespace SteerLib {
 		virtual Util::Vector getUpVector(SpatialDatabaseItemPtr exclude1) { return Util::Vector(0.0, 1.0, 0.0); }
 		//@}
 
+	protected:
+		/// Ray tracing through the items referenced by the grid cells, ignoring the obstacle layers.
+		bool _traceCells(const Util::Ray & r, float & t, SpatialDatabaseItemPtr &hitObject, SpatialDatabaseItemPtr exclude, bool excludeAgents);
+		/// Line of sight through the items referenced by the grid cells, ignoring the obstacle layers.
+		bool _hasLineOfSightThroughCells(const Util::Ray & r, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2);
+		/// The color that draw() shades a cell with; the more agents (blue) and obstacles (red) it holds, the brighter.
+		Util::Color _getCellColor(unsigned int cellIndex);
+
 	}; // end class GridDatabase2D
 
 
@@ -10,6 +10,7 @@
 /// @file GridDatabase2DPrivate.h
 /// @brief Defines private functionality for the SteerLib::GridDatabase2D spatial database.
 
+#include <vector>
 #include "Globals.h"
 #include "util/Geometry.h"
 #include "util/GenericException.h"
@@ -26,10 +27,14 @@
 #pragma warning( disable : 4251 )
 #endif
 
+// forward declaration
+class MTRand;
+
 namespace SteerLib {
 
 	// forward declarations
 	// class GridDatabasePlanningDomain;
+	class GridMapObstacle;
 
 
 	/** 
@@ -48,6 +53,10 @@ namespace SteerLib {
 
 		/// Helper function that converts a spatial range to a 2-D integer index range.
 		inline bool _clampSpatialBoundsToIndexRange(float xmin, float xmax, float zmin, float zmax, unsigned int & xMinIndex, unsigned int & xMaxIndex, unsigned int & zMinIndex, unsigned int & zMaxIndex);
+		/// Helper function that adds (or, with a negative sign, removes) the traversal cost of an obstacle layer to every grid cell that contains one of its blocked cells.
+		void _addObstacleLayerTraversalCost(GridMapObstacle * layer, float sign);
+		/// Helper function that returns true if the obstacle layer has a blocked cell inside the given range of grid cells.
+		bool _obstacleLayerIsInRange(GridMapObstacle * layer, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex);
 
 		float _xOrigin; // location of the min x,y point of the grid.
 		float _zOrigin;
@@ -69,6 +78,10 @@ namespace SteerLib {
 
 		/// A 2-D array of grid cells, but organized in a 1-D array.
 		GridCell* _cells;
+		/// Obstacles made of many blocked grid cells (such as game maps); instead of being referenced from every cell they cover, they are tested separately by each query.
+		std::vector<GridMapObstacle*> _obstacleLayers;
+		/// The generator used by the random position queries that are not given one; each database has its own, so that engines on different threads do not share it.
+		MTRand * _randomNumberGenerator;
 
 		/// The state space interface used by the planner to plan paths through the database.
 		// GridDatabasePlanningDomain * _planningDomain;
@@ -33,6 +33,7 @@ namespace SteerLib {
 		GridDatabasePlanningDomain(SteerLib::GridDatabase2D * spatialDatabase, SteerLib::EngineInterface * engineInfo) : _spatialDatabase(spatialDatabase)
 		{
 			_engineInfo = engineInfo;
+			_numNodesExpanded = 0;
 			std::cout << "Created a grid database planning domain *************" << std::endl;
 		}
 		// virtual ~GridDatabasePlanningDomain() {}
@@ -45,6 +46,9 @@ namespace SteerLib {
 
 		virtual bool refresh();
 		virtual void draw() {};
+
+		virtual unsigned int getNumNodesExpandedInLastSearch() { return _numNodesExpanded; }
+		virtual size_t getMemoryUsage() { return _spatialDatabase->getMemoryUsage(); }
 	protected:
 		virtual bool planPath(unsigned int startLocation, unsigned int goalLocation, std::stack<unsigned int> & outputPlan);
 
@@ -72,6 +76,7 @@ namespace SteerLib {
 		{
 			transitions.reserve(7); // there will only be 7 potential actions for any given state (the eighth one would be the previous state we came from, doesn't count)
 			transitions.clear();
+			_numNodesExpanded++;
 			unsigned int x, z;
 			_spatialDatabase->getGridCoordinatesFromIndex(currentState, x, z);
 			//
@@ -167,6 +172,8 @@ namespace SteerLib {
 		SteerLib::GridDatabase2D * _spatialDatabase;
 		SteerLib::DefaultAction<unsigned int> _tempAction;
 		SteerLib::EngineInterface * _engineInfo;
+		/// The number of times generateTransitions() was called since the last planPath().
+		unsigned int _numNodesExpanded;
 	};
 
 
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_GRID_DATABASE_REGION_SAMPLER_H__
+#define __STEERLIB_GRID_DATABASE_REGION_SAMPLER_H__
+
+/// @file GridDatabaseRegionSampler.h
+/// @brief Declares SteerLib::GridDatabaseRegionSampler, used to place objects randomly without collisions.
+
+#include <vector>
+#include "Globals.h"
+#include "util/Geometry.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+// forward declaration
+class MTRand;
+
+namespace SteerLib {
+
+	// forward declaration
+	class SpatialDataBaseInterface;
+
+	/**
+	 * @brief Draws random, non-overlapping positions for circles of a fixed radius within a region of a spatial database.
+	 *
+	 * The sampler first throws a small number of uniform darts exactly like the original rejection sampling
+	 * of GridDatabase2D, so sparse regions produce the same positions as before.  If those darts fail,
+	 * the region is rasterized into small cells and every cell that is completely free (considering the static
+	 * occupancy and all objects already in the database) is kept in a free list.  Positions are then drawn
+	 * uniformly from a random free cell, which always succeeds in constant time without retrying.
+	 *
+	 * The free list is conservative: a cell is only free if a circle centered anywhere inside it fits.  When
+	 * no free cells remain, the sampler falls back to a bounded number of uniform darts before giving up.
+	 *
+	 * Objects added to the database after the free cells were computed are not seen by the sampler
+	 * automatically; call #markOccupied() for each one (TestCaseReader does this when placing agents).
+	 *
+	 * Rasterizing only pays off when many positions are drawn from the same region.  Callers that need a single
+	 * position (such as SpatialDataBaseInterface::randomPositionInRegionWithoutCollisions()) should use
+	 * #randomPositionFromDarts() instead, which never computes the free cells.
+	 */
+	class STEERLIB_API GridDatabaseRegionSampler {
+	public:
+		GridDatabaseRegionSampler(SpatialDataBaseInterface * spatialDatabase, const Util::AxisAlignedBox & region, float radius, bool excludeAgents);
+
+		/// Finds a random position in the region with no overlapping objects; returns false if the region has no free space left.
+		bool randomPosition(MTRand & randomNumberGenerator, Util::Point & result);
+		/// Finds a random position with no overlapping objects using at most numDarts uniform darts, without computing the free cells; returns false if all darts fail.
+		bool randomPositionFromDarts(MTRand & randomNumberGenerator, Util::Point & result, unsigned int numDarts);
+		/// Removes the free space covered by a circle that was just added to the database.
+		void markOccupied(const Util::Point & position, float radius);
+
+		/// Returns true if this sampler places objects of the given radius within the given region.
+		bool matches(const Util::AxisAlignedBox & region, float radius, bool excludeAgents) const;
+		/// Returns the number of free cells, or 0 if the free cells have not been computed yet.
+		inline unsigned int getNumFreeCells() const { return (unsigned int)_freeCells.size(); }
+
+		/// Number of uniform darts thrown before the free cells are computed.
+		static const unsigned int NUM_DARTS_BEFORE_RASTERIZING = 64;
+		/// Number of uniform darts thrown after the free cells are exhausted, before giving up.
+		static const unsigned int NUM_DARTS_AFTER_EXHAUSTED = 10000;
+		/// Upper bound on the number of cells used to rasterize a region.
+		static const unsigned int MAX_NUM_RASTER_CELLS = 1 << 20;
+
+	protected:
+		bool _throwDart(MTRand & randomNumberGenerator, Util::Point & result);
+		void _rasterize();
+		void _removeFreeCell(unsigned int cellIndex);
+
+		SpatialDataBaseInterface * _spatialDatabase;
+		Util::AxisAlignedBox _region;
+		float _radius;
+		bool _excludeAgents;
+		bool _rasterized;
+
+		/// Valid positions are within [_xmin, _xmin + _xspan] x [_zmin, _zmin + _zspan].
+		float _xmin, _zmin, _xspan, _zspan;
+		float _cellSize;
+		/// Half the diagonal of a raster cell, the farthest any point of a cell is from its center.
+		float _cellHalfDiagonal;
+		unsigned int _xNumCells, _zNumCells;
+
+		/// Indices of all cells that are still completely free.
+		std::vector<unsigned int> _freeCells;
+		/// For each cell, its position in _freeCells, or -1 if the cell is not free.
+		std::vector<int> _freeCellSlots;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_HASHED_GRID_DATABASE_H__
+#define __STEERLIB_HASHED_GRID_DATABASE_H__
+
+/// @file HashedGridDatabase2D.h
+/// @brief Defines the public interface for the SteerLib::HashedGridDatabase2D spatial database.
+
+#include <set>
+#include <vector>
+
+#include "Globals.h"
+#include "interfaces/SpatialDatabaseItem.h"
+#include "interfaces/SpatialDataBaseInterface.h"
+
+#ifdef _WIN32
+// on win32, there is an unfortunate conflict between exporting symbols for a
+// dynamic/shared library and STL code.  A good document describing the problem
+// in detail is http://www.unknownroad.com/rtfm/VisualStudio/warningC4251.html
+// the "least evil" solution is just to simply ignore this warning.
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+// forward declaration
+class MTRand;
+
+namespace SteerLib {
+
+	// forward declarations
+	class GridMapObstacle;
+
+	/**
+	 * @brief A 2-D spatial database without world bounds, that only allocates the grid cells that contain objects.
+	 *
+	 * This database organizes objects on a uniform grid like GridDatabase2D, but the cells are kept in a hash table
+	 * and are only allocated when an object is added to them.  Objects anywhere on the x-z plane are referenced and
+	 * found by the queries, including agents that walk off the edge of the test case, and the memory used grows with
+	 * the number of occupied cells instead of with the size of the world.  A cell also has no fixed capacity, so
+	 * there is no maxItemsPerGridCell to tune.
+	 *
+	 * <h3> Notes </h3>
+	 *  - The database implementation is not (yet) thread-safe.
+	 *  - The cell size is given by a nominal window: the grid size and number of cells that would be used for a
+	 *    GridDatabase2D.  The window also defines the integer cell indices of the SpatialDataBaseInterface, so that
+	 *    grid-based planners (which need a finite index space) see the same cells as with a GridDatabase2D; cells
+	 *    outside the window have no index, and getCellIndexFromLocation() returns -1 for them.  All other queries
+	 *    work everywhere.
+	 *  - The hash keys are the Morton codes (bits of x and z interleaved) of the signed cell coordinates, so nearby
+	 *    cells have nearby keys.  The cells themselves are stored contiguously, and the table is open-addressed with
+	 *    linear probing, so that looking up a cell does not chase pointers.
+	 *  - A cell that becomes empty is kept until there are more empty cells than half of the occupied ones, and then
+	 *    all empty cells are released at once and the table is rebuilt; agents crossing back and forth between two
+	 *    cells do not allocate.
+	 *  - Range queries and ray traces are clipped to the bounds of the allocated cells.  When a range covers more
+	 *    cells than are allocated, the allocated cells are visited instead of probing the table for every cell.
+	 *  - A GridMapObstacle is not referenced from the cells, as in GridDatabase2D; it is tested directly by the
+	 *    queries, and its traversal cost is added to the cells that contain its blocked map cells when asked for.
+	 *
+	 * @see
+	 *  - GridDatabase2D, the fixed-size grid with a fixed number of items per cell.
+	 */
+	class STEERLIB_API HashedGridDatabase2D : public SpatialDataBaseInterface {
+	public:
+		/// @name Constructors and destructors
+		//@{
+		HashedGridDatabase2D(float xmin, float xmax, float zmin, float zmax, unsigned int numXCells, unsigned int numZCells, bool drawGrid);
+		~HashedGridDatabase2D();
+		//@}
+
+		/// @name Accessor functions
+		//@{
+		/// Returns the x value of the "top-left" corner of the nominal window.
+		inline float getOriginX() { return _xOrigin; }
+		/// Returns the z value of the "top-left" corner of the nominal window.
+		inline float getOriginZ() { return _zOrigin; }
+		/// Returns the size of the nominal window along the x direction.
+		inline float getGridSizeX() { return _xGridSize; }
+		/// Returns the size of the nominal window along the z direction.
+		inline float getGridSizeZ() { return _zGridSize; }
+		/// Returns the size of one grid cell along the x direction.
+		inline float getCellSizeX() { return _xCellSize; }
+		/// Returns the size of one grid cell along the z direction.
+		inline float getCellSizeZ() { return _zCellSize; }
+		/// Returns the number of grid cells of the nominal window along the x direction.
+		inline unsigned int getNumCellsX() { return _xNumCells; }
+		/// Returns the number of grid cells of the nominal window along the z direction.
+		inline unsigned int getNumCellsZ() { return _zNumCells; }
+		/// Returns the number of grid cells that are currently allocated, including empty cells that were not released yet.
+		inline unsigned int getNumAllocatedCells() { return (unsigned int)_cells.size(); }
+		/// Returns the number of bytes used by the hash table, the grid cells, their item lists, and the bitmaps of the obstacle layers.
+		size_t getMemoryUsage();
+		//@}
+
+		/// @name Conversions between index, location, and grid coordinates
+		//@{
+		/// Returns an integer index of the GridCell where (x,z) is located, or -1 if it is outside the nominal window.
+		inline int getCellIndexFromLocation( float x, float z);
+		/// Returns an integer index of the GridCell where Point v is located, or -1 if it is outside the nominal window.
+		inline int getCellIndexFromLocation( const Util::Point &v ) { return getCellIndexFromLocation(v.x, v.z); }
+		/// Returns the location of the center of the GridCell indexed by cellIndex; the "return value" is placed in the result arg.
+		inline void getLocationFromIndex( unsigned int cellIndex, Util::Point & result );
+		/// Returns 2-D <b>integer</b> index coordinates of a GridCell indexed by cellIndex.
+		inline void getGridCoordinatesFromIndex(unsigned int cellIndex, unsigned int &xIndex, unsigned int & zIndex);
+		/// Returns the index of the GridCell that is indexed by 2-D integer coordinates (x,z).
+		inline unsigned int getCellIndexFromGridCoords(unsigned int x, unsigned int z) { return (x * _zNumCells) + z; }
+		//@}
+
+		/// @name Database update functions
+		//@{
+		/// Adds an object to the database
+		void addObject( SpatialDatabaseItemPtr item, const Util::AxisAlignedBox & newBounds );
+		/// Removes an object from the database.  <b>It is the user's responsibility to make sure oldBounds is correct.</b>
+		void removeObject( SpatialDatabaseItemPtr item, const Util::AxisAlignedBox &oldBounds );
+		/// Updates an existing object in the database.  <b>It is the user's responsibility to make sure oldBounds is correct.</b>
+		void updateObject( SpatialDatabaseItemPtr item, const Util::AxisAlignedBox & oldBounds, const Util::AxisAlignedBox & newBounds );
+		/// Removes all objects, and releases all grid cells.
+		virtual void clearDatabase();
+		//@}
+
+		/// @name Traversability queries
+		//@{
+		/// Returns true if there are any objects referenced in the GridCell.
+		inline bool hasAnyItems( unsigned int cellIndex ) { unsigned int x, z; getGridCoordinatesFromIndex(cellIndex, x, z); return hasAnyItems(x, z); }
+		/// Returns true if there are any objects referenced in the GridCell.
+		bool hasAnyItems( unsigned int x, unsigned int z );
+		/// Returns the sum total of traversal costs of all objects referenced in the GridCell.
+		inline float getTraversalCost( unsigned int cellIndex ) { unsigned int x, z; getGridCoordinatesFromIndex(cellIndex, x, z); return getTraversalCost(x, z); }
+		/// Returns the sum total of traversal costs of all objects referenced in the GridCell.
+		float getTraversalCost( unsigned int x, unsigned int z );
+		//@}
+
+		/// @name Nearest neighbor queries
+		//@{
+		/// Returns an STL set of objects found in the specified spatial range.  Objects slightly outside the range may also be included.
+		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
+		/// Returns an STL set of objects found in the specified range of GridCells of the nominal window.
+		void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex, SpatialDatabaseItemPtr exclude);
+		/// Returns the agents and obstacles found in the specified spatial range as two separate lists, without building an STL set.
+		void getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude);
+		void computeAgentNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const ;
+		void computeObstacleNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const ;
+		/// Returns true if any object in the database overlaps the circle (p, radius); unlike getItemsInRange() this does not build an STL set.
+		bool overlapsAnyItem(const Util::Point & p, float radius, bool excludeAgents);
+		/// Returns an STL set of objects in the specified range, culling agent objects to a hemisphere centered around the facingDirection.
+		void getItemsInVisualField(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude, const Util::Point & position, const Util::Vector & facingDirection, float radiusSquared);
+		//@}
+
+		/// @name Ray tracing queries
+		//@{
+		/// Returns "true" if the ray found an intersection in-between r.mint and r.maxt
+		bool trace(const Util::Ray & r, float & t, SpatialDatabaseItemPtr &hitObject, SpatialDatabaseItemPtr exclude, bool excludeAgents);
+		/// Returns "true" if no intersections were found with objects that might block line of sight. i.e., ignores objects that return blocksLineOfSight()==false.
+		bool hasLineOfSight(const Util::Ray & r, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2);
+		/// Returns "true" if no intersections were found with objects that might block line of sight. i.e., ignores objects that return blocksLineOfSight()==false.
+		bool hasLineOfSight(const Util::Point & p1, const Util::Point & p2, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2);
+		//@}
+
+		/// @name Miscellaneous functions
+		//@{
+		/// Finds a random 2D point within the nominal window that has no other objects within the requested radius.
+		Util::Point randomPositionWithoutCollisions(float radius, bool excludeAgents);
+		/// Finds a random 2D point, within the specified region, that has no other objects within the requested radius.
+		Util::Point randomPositionInRegionWithoutCollisions(const Util::AxisAlignedBox & region, float radius, bool excludeAgents);
+		/// Finds a random 2D point, within the specified region, that has no other objects within the requested radius, using an exising (already seeded) Mersenne Twister random number generator.
+		Util::Point randomPositionInRegionWithoutCollisions(const Util::AxisAlignedBox & region, float radius, bool excludeAgents, MTRand & randomNumberGenerator);
+		/// Resets the agent to a random position in the region where it does not overlap other objects, facing a random direction, and leaves it disabled; returns false if the item is not an agent or the region is full.
+		bool randomPositionInRegionWithoutCollisions(const Util::AxisAlignedBox & region, SpatialDatabaseItemPtr item, bool excludeAgents, MTRand & randomNumberGenerator);
+		/// Finds a random 2D point, within the specified region, using an exising (already seeded) Mersenne Twister random number generator.
+		Util::Point randomPositionInRegion(const Util::AxisAlignedBox & region, float radius, MTRand & randomNumberGenerator);
+
+		/// Uses openGL and DrawLib to visualize the allocated grid cells.
+		void draw();
+		/// Copies the cells that draw() would shade; returns false if the grid is not drawn.
+		bool getCellsToDraw(std::vector<GridCellRenderState> & cells);
+
+		/// Gets the location of this agent, really used to get the y-location
+		virtual Util::Point getLocation(SpatialDatabaseItemPtr exclude1) { return Util::Point(0.0,0.0,0.0); }
+		/// Get Normal for item, This get the normal for an item, used to determine the orientation of the item
+		virtual Util::Vector getUpVector(SpatialDatabaseItemPtr exclude1) { return Util::Vector(0.0, 1.0, 0.0); }
+		//@}
+
+		/// Cell coordinates are clamped to +/- this value, so that the coordinates of far away (or infinite) bounds stay inside the key space.
+		static const int MAX_CELL_COORDINATE = 1 << 30;
+
+	protected:
+		/// One allocated grid cell; unlike GridCell, the list of items grows as needed.
+		struct HashedGridCell {
+			std::vector<SpatialDatabaseItemPtr> items;
+			float traversalCost;
+			int x;
+			int z;
+		};
+
+		/// The state of a walk over the allocated cells inside a range of cell coordinates; see _beginCellRange().
+		struct CellRange {
+			int xMin, xMax, zMin, zMax;
+			int x, z; // the next cell to probe, when probing the table
+			unsigned int cellIndex; // the next cell to visit, when visiting all allocated cells
+			bool visitAllCells;
+		};
+
+		/// Returns the Morton code of the signed cell coordinates (x,z), used as the hash key of the cell; it is never 0.
+		static inline unsigned long long _getCellKey(int x, int z);
+		/// Returns the slot of the table where the key is, or the empty slot where it would be inserted.
+		inline unsigned int _findSlot(unsigned long long key);
+		/// Returns the allocated cell at (x,z), or NULL if there is none.
+		inline HashedGridCell * _findCell(int x, int z);
+		/// Returns the cell at (x,z), allocating it (and growing the table) if needed.
+		HashedGridCell & _findOrAllocateCell(int x, int z);
+		/// Re-inserts all allocated cells into an empty table large enough to keep it at most half full.
+		void _rebuildTable();
+		/// Converts a spatial range to the (unclipped) range of cell coordinates that overlap it.
+		void _getCellRange(float xmin, float xmax, float zmin, float zmax, int & xMin, int & xMax, int & zMin, int & zMax);
+		/// Starts a walk over the allocated cells inside a range of cell coordinates; the walk does not allocate, so queries stay reentrant.
+		void _beginCellRange(int xMin, int xMax, int zMin, int zMax, CellRange & range);
+		/// Returns the next allocated cell of the walk that has items, in no particular order, or NULL at the end of the walk.
+		inline HashedGridCell * _nextCellInRange(CellRange & range);
+		/// Releases the empty cells if there are too many of them, and recomputes the bounds of the allocated cells.
+		void _releaseEmptyCells();
+		/// Returns true if the obstacle layer has a blocked cell inside the given range of cell coordinates.
+		bool _obstacleLayerIsInRange(GridMapObstacle * layer, int xMin, int xMax, int zMin, int zMax);
+		/// Walks the allocated cells along the ray, and returns the closest item that the ray hits; ignores the obstacle layers.
+		bool _traceCells(const Util::Ray & r, float & t, SpatialDatabaseItemPtr & hitObject, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2, bool excludeAgents, bool onlyLineOfSightBlockers);
+		/// The color that draw() shades an allocated cell with; the more agents (blue) and obstacles (red) it holds, the brighter.
+		Util::Color _getCellColor(const HashedGridCell & cell);
+
+		float _xOrigin; // location of the min x,z point of the nominal window.
+		float _zOrigin;
+		float _xGridSize; // size of the nominal window
+		float _zGridSize;
+		float _xCellSize; // size of each cell
+		float _zCellSize;
+		float _xInvCellSize; // (1/size) of each cell
+		float _zInvCellSize;
+		unsigned int _xNumCells; // number of cells of the nominal window along the x or z axis
+		unsigned int _zNumCells;
+
+		bool _drawGrid; // should the grid be drawn?
+
+		/// The allocated grid cells, in the order they were allocated.
+		std::vector<HashedGridCell> _cells;
+		/// The hash table: the Morton code of the cell in each slot, or 0 for an empty slot.  Its size is a power of two.
+		std::vector<unsigned long long> _tableKeys;
+		/// The index into _cells of the cell in each slot of the hash table.
+		std::vector<unsigned int> _tableCells;
+		/// The number of bits to shift a hashed key to get a slot, i.e. 64 - log2 of the table size.
+		unsigned int _tableShift;
+		/// The number of allocated cells that have no items.
+		unsigned int _numEmptyCells;
+		/// The range of cell coordinates that contains all allocated cells; only valid if there are any.
+		int _xMinAllocated, _xMaxAllocated, _zMinAllocated, _zMaxAllocated;
+		/// Obstacles made of many blocked grid cells (such as game maps); instead of being referenced from every cell they cover, they are tested separately by each query.
+		std::vector<GridMapObstacle*> _obstacleLayers;
+		/// The generator used by the random position queries that are not given one; each database has its own, so that engines on different threads do not share it.
+		MTRand * _randomNumberGenerator;
+
+	}; // end class HashedGridDatabase2D
+
+
+
+	inline int HashedGridDatabase2D::getCellIndexFromLocation( float x, float z)
+	{
+		if (x < _xOrigin) return -1;
+		if (z < _zOrigin) return -1;
+		if (x >= _xOrigin + _xGridSize) return -1;
+		if (z >= _zOrigin + _zGridSize) return -1;
+		unsigned int ix = (unsigned int) ((x - _xOrigin) * _xInvCellSize);
+		unsigned int iz = (unsigned int) ((z - _zOrigin) * _zInvCellSize);
+		if (ix >= _xNumCells) ix = _xNumCells - 1;
+		if (iz >= _zNumCells) iz = _zNumCells - 1;
+		return getCellIndexFromGridCoords(ix, iz);
+	}
+
+	inline void HashedGridDatabase2D::getLocationFromIndex( unsigned int cellIndex, Util::Point & result ) {
+		unsigned int x,z;
+		getGridCoordinatesFromIndex(cellIndex, x, z);
+		result.x = (((float)x) + 0.5f)*_xCellSize + _xOrigin;
+		result.y = 0.0f;
+		result.z = (((float)z) + 0.5f)*_zCellSize + _zOrigin;
+	}
+
+	inline void HashedGridDatabase2D::getGridCoordinatesFromIndex(unsigned int cellIndex, unsigned int &xIndex, unsigned int & zIndex) {
+		xIndex = cellIndex / _zNumCells; // integer division so that remainders also get truncated
+		zIndex = cellIndex - (xIndex * _zNumCells);
+	}
+
+
+} // end namespace SteerLib;
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
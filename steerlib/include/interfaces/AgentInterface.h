@@ -26,6 +26,8 @@ namespace SteerLib {
 
 	// forward declaration
 	class STEERLIB_API EngineInterface;
+	class STEERLIB_API SimulationStateWriter;
+	class STEERLIB_API SimulationStateReader;
 
 
 	/**
@@ -52,6 +54,7 @@ namespace SteerLib {
 	class STEERLIB_API AgentInterface : public SteerLib::SpatialDatabaseItem
 	{
 	public:
+		AgentInterface() : SpatialDatabaseItem(SPATIAL_DATABASE_ITEM_AGENT) { }
 		virtual ~AgentInterface() { }
 		/// @name Core functionality
 		//@{
@@ -94,6 +97,15 @@ namespace SteerLib {
 		virtual void clearGoals() = 0;
 		//@}
 
+		/// @name Snapshots
+		/// @brief Used by SimulationEngine::saveSnapshot() and SimulationEngine::restoreSnapshot() to branch simulations.
+		//@{
+		/// Writes the agent's state; the default writes the members declared in AgentInterface, so agents with more state should override both functions and call these first.
+		virtual void saveState(SteerLib::SimulationStateWriter & writer);
+		/// Restores the state written by saveState(); the engine takes the agent out of the spatial database before this call, and re-inserts it afterwards if it is enabled.
+		virtual void restoreState(SteerLib::SimulationStateReader & reader);
+		//@}
+
 		/// @name The SpatialDatabaseItem interface
 		/// @brief Some defaults are given, but can be overridden if desired.
 		//@{
@@ -233,6 +245,11 @@ namespace SteerLib {
 		return out;
 	}
 
+	inline AgentInterface * SpatialDatabaseItem::asAgent()
+	{
+		return (_spatialDatabaseItemType == SPATIAL_DATABASE_ITEM_AGENT) ? static_cast<AgentInterface*>(this) : NULL;
+	}
+
 } // end namespace SteerLib
 
 #endif
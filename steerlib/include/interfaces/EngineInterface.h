@@ -16,6 +16,7 @@
 #include "recfileio/RecFileIO.h"
 #include "interfaces/AgentInterface.h"
 #include "interfaces/ObstacleInterface.h"
+#include "obstacles/StaticObstacleGeometry.h"
 #include "interfaces/EngineControllerInterface.h"
 #include "util/DrawLib.h"
 #include "util/DynamicLibrary.h"
@@ -83,6 +84,8 @@ namespace SteerLib {
 		virtual const std::set<SteerLib::AgentInterface*> & getSelectedAgents() = 0;
 		/// Returns a reference to an STL set containing a list of all obstacles.
 		virtual const std::set<SteerLib::ObstacleInterface*> & getObstacles() = 0;
+		/// Returns the outlines of all obstacles as flat arrays of segments and circles; compiled once, and again after obstacles are added or removed.
+		virtual const SteerLib::StaticObstacleGeometry & getStaticObstacleGeometry() = 0;
 		/// Returns a pointer to the ModuleInterface of the module with the name moduleName.
 		virtual SteerLib::ModuleInterface * getModule(const std::string & moduleName) = 0;
 		/// Returns a pointer to the ModuleMetaInformation of the module with the name moduleName.
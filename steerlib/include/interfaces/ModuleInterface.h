@@ -130,6 +130,15 @@ namespace SteerLib {
 		/// Uses OpenGL to draw any module-specific information to the screen; <b>WARNING:</b> this may be called multiple times per simulation step.
 		virtual void draw() { }
 		//@}
+
+		/// @name Snapshots
+		/// @brief These (optional) functions let a module's per-simulation state be part of a SimulationSnapshot.  Agents save their own state through AgentInterface::saveState(), so most modules do not need them.
+		//@{
+		/// Writes any state that changes during the simulation and is not owned by agents.
+		virtual void saveSimulationState( SteerLib::SimulationStateWriter & writer ) { }
+		/// Restores the state written by saveSimulationState(); called after all agents have been restored.
+		virtual void restoreSimulationState( SteerLib::SimulationStateReader & reader ) { }
+		//@}
 	};
 
 } // end namespace SteerLib
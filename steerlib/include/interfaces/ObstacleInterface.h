@@ -21,7 +21,7 @@ namespace SteerLib {
 	 */
 	class STEERLIB_API ObstacleInterface : public SteerLib::SpatialDatabaseItem {
 	public:
-		ObstacleInterface() : nextObstacle_(NULL), prevObstacle_(NULL), id_(0), isConvex_(false) {}
+		ObstacleInterface() : SpatialDatabaseItem(SPATIAL_DATABASE_ITEM_OBSTACLE), nextObstacle_(NULL), prevObstacle_(NULL), id_(0), isConvex_(false) {}
 		virtual ~ObstacleInterface() { }
 		virtual void init() { }
 		virtual void update(float timeStamp, float dt, unsigned int frameNumber) { }
@@ -52,6 +52,11 @@ namespace SteerLib {
 		//@}
 	};
 
+	inline ObstacleInterface * SpatialDatabaseItem::asObstacle()
+	{
+		return (_spatialDatabaseItemType == SPATIAL_DATABASE_ITEM_OBSTACLE) ? static_cast<ObstacleInterface*>(this) : NULL;
+	}
+
 } // end namespace SteerLib
 
 #endif
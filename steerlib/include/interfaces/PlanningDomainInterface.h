@@ -38,6 +38,15 @@ namespace SteerLib{
 
 		//@}
 
+		/// @name Search statistics
+		/// @brief Reported by the PathPlanningBenchmark; planners that do not keep them return 0.
+		//@{
+		/// Returns the number of search nodes expanded by the most recent findPath() or findSmoothPath().
+		virtual unsigned int getNumNodesExpandedInLastSearch() { return 0; }
+		/// Returns the number of bytes used by the data the planner searches, such as its grid or navigation mesh.
+		virtual size_t getMemoryUsage() { return 0; }
+		//@}
+
 	};
 }
 
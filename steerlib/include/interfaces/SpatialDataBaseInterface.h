@@ -13,6 +13,7 @@
 #include "Globals.h"
 #include "interfaces/SpatialDatabaseItem.h"
 #include "util/Geometry.h"
+#include "simulation/RenderSnapshot.h"
 
 #include <set>
 #include <stack>
@@ -103,6 +104,8 @@ namespace SteerLib {
 		virtual void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude) = 0;
 		/// Returns an STL set of objects found in the specified range of GridCells.
 		virtual void getItemsInRange(std::set<SpatialDatabaseItemPtr> & neighborList, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex, SpatialDatabaseItemPtr exclude) = 0;
+		/// Like getItemsInRange(), but returns agents and obstacles in two separate lists (cleared first), in the same order as the STL set would have them; items that are neither are skipped.
+		virtual void getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude) = 0;
 		/**
 		 * \brief   Computes the agent neighbors of the specified agent.
 		 * \param   agent    A pointer to the agent for which agent neighbors are to be computed.
@@ -119,6 +122,17 @@ namespace SteerLib {
 		virtual void computeObstacleNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const  = 0;
 		/// Returns an STL set of objects in the specified range, culling agent objects to a hemisphere centered around the facingDirection.
 		virtual void getItemsInVisualField(std::set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude, const Util::Point & position, const Util::Vector & facingDirection, float radiusSquared) = 0;
+		/// Returns true if any object in the database overlaps the circle (p, radius); databases can override this to avoid building an STL set.
+		virtual bool overlapsAnyItem(const Util::Point & p, float radius, bool excludeAgents)
+		{
+			std::set<SpatialDatabaseItemPtr> neighbors;
+			getItemsInRange(neighbors, p.x - radius, p.x + radius, p.z - radius, p.z + radius, NULL);
+			for (std::set<SpatialDatabaseItemPtr>::iterator neighbor = neighbors.begin(); neighbor != neighbors.end(); ++neighbor) {
+				if (excludeAgents && (*neighbor)->isAgent()) continue;
+				if ((*neighbor)->overlaps(p, radius)) return true;
+			}
+			return false;
+		}
 		//@}
 
 		/// @name Ray tracing queries
@@ -150,6 +164,8 @@ namespace SteerLib {
 
 		/// Uses openGL and DrawLib to visualize the grid.
 		virtual void draw() = 0;
+		/// Copies the cells that draw() would shade, so that another thread can draw them while the database changes; returns false if the database does not draw itself.
+		virtual bool getCellsToDraw(std::vector<GridCellRenderState> & cells) { cells.clear(); return false; }
 
 		/// Gets the location of this agent, really used to get the y-location
 		virtual Util::Point getLocation(SpatialDatabaseItemPtr exclude1) =0;
@@ -15,6 +15,18 @@
 
 namespace SteerLib {
 
+	// forward declaration
+	class STEERLIB_API AgentInterface;
+	class STEERLIB_API ObstacleInterface;
+
+	/// The kind of object behind a SpatialDatabaseItem, set once when the object is constructed.
+	enum SpatialDatabaseItemType {
+		/// Any item that is not derived from AgentInterface or ObstacleInterface, e.g. RawAgentInfo and RawObstacleInfo.
+		SPATIAL_DATABASE_ITEM_OTHER,
+		SPATIAL_DATABASE_ITEM_AGENT,
+		SPATIAL_DATABASE_ITEM_OBSTACLE
+	};
+
 	/**
 	 * @brief The virtual interface used by objects in the spatial database.
 	 *
@@ -29,11 +41,23 @@ namespace SteerLib {
 	 *  - the SpatialDataBaseInterface spatial database
 	 *  - examples of this virtual interface being used: RawAgentInfo, RawObstacleInfo.
 	 *
+	 * Every item also carries a type tag, set by the AgentInterface and ObstacleInterface constructors.  Code that walks
+	 * over neighbors should use asAgent() and asObstacle() (or SpatialDataBaseInterface::getAgentsAndObstaclesInRange())
+	 * instead of dynamic_cast; they only check the tag and adjust the pointer, without any run-time type lookup.
+	 *
 	 */
 	class STEERLIB_API SpatialDatabaseItem {
 	public:
 		/// Overriding this default (empty) destructor is optional.
 		virtual ~SpatialDatabaseItem() {}
+
+		/// Returns the type tag of the item.
+		SpatialDatabaseItemType getSpatialDatabaseItemType() const { return _spatialDatabaseItemType; }
+		/// Returns the item as an AgentInterface, or NULL if the item is not derived from AgentInterface; defined in AgentInterface.h.
+		inline AgentInterface * asAgent();
+		/// Returns the item as an ObstacleInterface, or NULL if the item is not derived from ObstacleInterface; defined in ObstacleInterface.h.
+		inline ObstacleInterface * asObstacle();
+
 		/// Returns true if the object is an agent, false if not.
 		virtual bool isAgent() = 0;
 		/// Returns true if the object blocks line-of-sight.  Usually agents and invisible boundaries (like a pool or a street) should return false, while larger objects should return true.
@@ -49,6 +73,14 @@ namespace SteerLib {
 		// virtual bool overlaps(const SteerLib::SpatialDatabaseItemPtr item) = 0;
 		/// Returns the amount of penetration that a circle has if it overlaps, or 0.0 if there is no overlap.
 		virtual float computePenetration(const Util::Point & p, float radius) = 0;
+
+	protected:
+		SpatialDatabaseItem() : _spatialDatabaseItemType(SPATIAL_DATABASE_ITEM_OTHER) {}
+		/// Used by AgentInterface and ObstacleInterface to tag themselves.
+		explicit SpatialDatabaseItem(SpatialDatabaseItemType spatialDatabaseItemType) : _spatialDatabaseItemType(spatialDatabaseItemType) {}
+
+	private:
+		SpatialDatabaseItemType _spatialDatabaseItemType;
 	};
 
 	typedef SpatialDatabaseItem* SpatialDatabaseItemPtr;
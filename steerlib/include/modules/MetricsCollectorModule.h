@@ -27,6 +27,33 @@ namespace SteerLib {
 		void init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo ) {
 			_engine = engineInfo;
 			_simulationMetrics = NULL;
+			_numThreads = 1;
+			_windowSizes = SteerLib::MetricsWindowSizes();
+
+			SteerLib::OptionDictionary::const_iterator optionIter;
+			for (optionIter = options.begin(); optionIter != options.end(); ++optionIter) {
+				if ((*optionIter).first == "threads") {
+					std::istringstream((*optionIter).second) >> _numThreads;
+					if (_numThreads == 0) {
+						throw Util::GenericException("metricsCollector option \"threads\" must be at least 1.");
+					}
+				}
+				else if ((*optionIter).first == "distance_window") {
+					std::istringstream((*optionIter).second) >> _windowSizes.distanceWindowSize;
+				}
+				else if ((*optionIter).first == "turning_window") {
+					std::istringstream((*optionIter).second) >> _windowSizes.turningWindowSize;
+				}
+				else if ((*optionIter).first == "speed_change_window") {
+					std::istringstream((*optionIter).second) >> _windowSizes.changeInSpeedWindowSize;
+				}
+				else if ((*optionIter).first == "acceleration_window") {
+					std::istringstream((*optionIter).second) >> _windowSizes.accelerationWindowSize;
+				}
+				else {
+					throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to metricsCollector module.");
+				}
+			}
 		}
 
 		void finish() {
@@ -42,7 +69,7 @@ namespace SteerLib {
 			delete _simulationMetrics;
 
 			// allocate and setup metrics collection
-			_simulationMetrics = new SteerLib::SimulationMetricsCollector( _engine->getAgents() );
+			_simulationMetrics = new SteerLib::SimulationMetricsCollector( _engine->getAgents(), _numThreads, _windowSizes );
 
 		}
 
@@ -61,6 +88,10 @@ namespace SteerLib {
 	protected:
 		SteerLib::EngineInterface * _engine;
 		SteerLib::SimulationMetricsCollector * _simulationMetrics;
+		/// Number of threads used to update the agent metrics; set with the "threads" option.
+		unsigned int _numThreads;
+		/// Number of frames in each sliding window; set with the "distance_window", "turning_window", "speed_change_window" and "acceleration_window" options.
+		SteerLib::MetricsWindowSizes _windowSizes;
 	};
 
 } // end namespace SteerLib
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_PATH_PLANNING_BENCHMARK_MODULE__
+#define __STEERLIB_PATH_PLANNING_BENCHMARK_MODULE__
+
+/// @file PathPlanningBenchmarkModule.h
+/// @brief Declares the PathPlanningBenchmarkModule built-in module.
+
+#include "interfaces/ModuleInterface.h"
+#include "interfaces/EngineInterface.h"
+
+namespace SteerLib {
+
+	/**
+	 * @brief Runs the queries of a MovingAI .scen file through the engine's path planner, and reports the results.
+	 *
+	 * The test case must be a MovingAI .map file, loaded by the testCasePlayer.  When the simulation ends, every query
+	 * of the scenario is planned with the planning domain chosen in the planningDomain options of the engine (for
+	 * example gridDomain or navmeshDomain), using a PathPlanningBenchmark.  For gridDomain, the gridDatabase options
+	 * should give one grid cell per map cell, otherwise the suboptimality also reflects the different resolution.
+	 * A map without agents ends after one frame, for example:
+	 *
+	 *   steersim -commandline -testcase arena.map -ai dummyAI -module pathPlanningBenchmark,scenario=arena.map.scen
+	 *
+	 * Options:
+	 *   - scenario: the .scen file (required).
+	 *   - maxNodes: the search horizon given to each query.
+	 *   - logfile: a file to write the results to, instead of the standard output.
+	 */
+	class PathPlanningBenchmarkModule : public SteerLib::ModuleInterface
+	{
+	public:
+		std::string getDependencies() { return "testCasePlayer"; }
+		std::string getConflicts() { return ""; }
+		std::string getData() { return ""; }
+		LogData * getLogData() { return new LogData(); }
+		void init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo );
+		void finish() { }
+		void postprocessSimulation();
+
+	protected:
+		SteerLib::EngineInterface * _engine;
+		std::string _scenarioFilename;
+		std::string _logFilename;
+		unsigned int _maxNodesToExpand;
+	};
+
+} // end namespace SteerLib
+
+#endif
@@ -13,6 +13,7 @@
 #include "interfaces/ModuleInterface.h"
 #include "interfaces/EngineInterface.h"
 #include "obstacles/BoxObstacle.h"
+#include "recfileio/RecFileIO.h"
 
 namespace SteerLib
 {
@@ -105,6 +106,9 @@ namespace SteerLib
 
 		std::vector<SteerLib::BoxObstacle *> _obstacles;
 		std::string _recFilename;
+		unsigned int _numReadAheadFrames;
+		/// The state of all agents at the current playback time, read with one call per frame.
+		std::vector<SteerLib::RecFileAgentState> _agentStates;
 
 	};
 
@@ -29,9 +29,13 @@ namespace SteerLib {
 		void postprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
 		void cleanupSimulation();
 
+		/// Changes the test case (and the seed used for its random initial conditions) loaded by the next initializeSimulation(); used to run many simulations without re-loading modules.
+		void setTestCase( const std::string & testCaseFilename, unsigned int randomSeed );
+
 	protected:
 		SteerLib::EngineInterface * _engine;
 		std::string _testCaseFilename;
+		unsigned int _randomSeed;
 		std::string _aiModuleName;
 		std::string _aiModuleSearchPath;
 		SteerLib::ModuleInterface * _aiModule;
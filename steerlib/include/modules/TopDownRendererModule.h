@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_TOP_DOWN_RENDERER_MODULE__
+#define __STEERLIB_TOP_DOWN_RENDERER_MODULE__
+
+/// @file TopDownRendererModule.h
+/// @brief Declares the TopDownRendererModule built-in module.
+
+#include <vector>
+#include "interfaces/ModuleInterface.h"
+#include "interfaces/EngineInterface.h"
+#include "simulation/TopDownRenderer.h"
+
+namespace SteerLib {
+
+	/**
+	 * @brief Writes a top-down PNG image of the simulation every few frames, using a SteerLib::TopDownRenderer.
+	 *
+	 * The images are rendered without openGL, so this module also works with the command-line engine driver, for
+	 * example:
+	 *
+	 *   steersim -commandline -testcase 4-way-oncoming.xml -ai simpleAI -module topDownRenderer,prefix=frames/run1_,trail=30
+	 *
+	 * Options:
+	 *   - prefix: the images are named <prefix>NNNNN.png (default "topdown").
+	 *   - width, height: the size of the images in pixels.
+	 *   - frameStep: renders every frameStep-th frame (default 1).
+	 *   - threads: the number of threads that render and write the images.
+	 *   - trail: the number of rendered frames of each agent's path that are drawn behind it (default 0).
+	 *   - headings: set to "false" to draw agents without their heading.
+	 */
+	class TopDownRendererModule : public SteerLib::ModuleInterface
+	{
+	public:
+		std::string getDependencies() { return ""; }
+		std::string getConflicts() { return ""; }
+		std::string getData() { return ""; }
+		LogData * getLogData() { return new LogData(); }
+		void init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo );
+		void finish();
+		void preprocessSimulation();
+		void postprocessFrame(float timeStamp, float dt, unsigned int frameNumber);
+		void postprocessSimulation();
+
+	protected:
+		void _addFrame();
+
+		SteerLib::EngineInterface * _engine;
+		SteerLib::TopDownRendererOptions _options;
+		SteerLib::TopDownRenderer * _renderer;
+		std::string _filePrefix;
+		unsigned int _frameStep;
+		/// Reused for every frame.
+		std::vector<RecFileAgentState> _agentStates;
+	};
+
+} // end namespace SteerLib
+
+#endif
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_GRID_MAP_OBSTACLE_H__
+#define __STEERLIB_GRID_MAP_OBSTACLE_H__
+
+/// @file GridMapObstacle.h
+/// @brief Declares the GridMapObstacle class, a layer of blocked grid cells stored as a bitmap.
+
+#include <vector>
+#include "interfaces/ObstacleInterface.h"
+#include "Globals.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	/**
+	 * @brief A single obstacle made of all the blocked cells of a regular grid, such as a MovingAI game map.
+	 *
+	 * Game maps have thousands of blocked cells.  Converting each run of cells into a BoxObstacle makes thousands of
+	 * separate objects that are each inserted into the spatial database and tested through virtual calls.  This class
+	 * instead keeps one bit per cell, and answers the SpatialDatabaseItem queries by looking only at the cells near the
+	 * query.
+	 *
+	 * Cell (x,z) covers the square from (originX + x*cellSize, originZ + z*cellSize) to one cellSize further along
+	 * both axes.  The obstacle is one unit tall, like the boxes of the converted test cases.
+	 *
+	 * GridDatabase2D and HashedGridDatabase2D recognize this obstacle: instead of referencing it from every grid cell it
+	 * covers, they count its traversal cost only for the cells that contain blocked map cells, and test it separately in
+	 * their queries.
+	 *
+	 * @see
+	 *  - MovingAIReader, which loads this obstacle from a .map file.
+	 */
+	class STEERLIB_API GridMapObstacle : public SteerLib::ObstacleInterface
+	{
+	public:
+		/// Creates a map where no cell is blocked.
+		GridMapObstacle(float originX, float originZ, float cellSize, unsigned int numCellsX, unsigned int numCellsZ, float traversalCost=1001.0f);
+
+		/// @name Accessing the cells
+		//@{
+		inline unsigned int getNumCellsX() const { return _numCellsX; }
+		inline unsigned int getNumCellsZ() const { return _numCellsZ; }
+		inline float getCellSize() const { return _cellSize; }
+		inline float getOriginX() const { return _originX; }
+		inline float getOriginZ() const { return _originZ; }
+		inline bool isBlocked(unsigned int x, unsigned int z) const { return (_bits[z * _wordsPerRow + (x >> 5)] & (1u << (x & 31))) != 0; }
+		void setBlocked(unsigned int x, unsigned int z, bool blocked);
+		/// Returns true if the point lies in a blocked cell; points outside the map are not blocked.
+		bool isBlocked(const Util::Point & p) const;
+		/// Returns true if any blocked cell overlaps the region; cells that only touch its boundary do not count.
+		bool isRegionBlocked(float xmin, float xmax, float zmin, float zmax) const;
+		/// Returns the location of the center of cell (x,z).
+		inline Util::Point getCellCenter(unsigned int x, unsigned int z) const { return Util::Point(_originX + ((float)x + 0.5f) * _cellSize, 0.0f, _originZ + ((float)z + 0.5f) * _cellSize); }
+		unsigned int getNumBlockedCells() const;
+		/// Returns the number of bytes used by the bitmap.
+		inline size_t getBitmapSizeInBytes() const { return _bits.size() * sizeof(unsigned int); }
+		/// Covers the blocked cells with disjoint rectangles, merging each run of cells along x with identical runs in the next rows.
+		void getBlockedRectangles(std::vector<Util::AxisAlignedBox> & rectangles) const;
+		//@}
+
+		/// @name The ObstacleInterface
+		//@{
+		void draw(); // implementation in .cpp
+		const Util::AxisAlignedBox & getBounds() { return _bounds; }
+		/// Moves the map so that its corner is at (bounds.xmin, bounds.zmin); the cell size does not change.
+		virtual void setBounds(const Util::AxisAlignedBox & bounds);
+		//@}
+
+		/// @name The SpatialDatabaseItem interface
+		/// @brief The blocked cells block line of sight and cannot be traversed; the free cells are not part of the obstacle.
+		//@{
+		virtual bool isAgent() { return false; }
+		bool blocksLineOfSight() { return true; }
+		float getTraversalCost() { return _traversalCost; }
+		virtual bool intersects(const Util::Ray &r, float &t);
+		virtual bool overlaps(const Util::Point & p, float radius);
+		virtual float computePenetration(const Util::Point & p, float radius);
+		virtual std::pair<std::vector<Util::Point>,std::vector<size_t> > getStaticGeometry();
+		virtual std::vector<Util::Point> get2DStaticGeometry();
+		//@}
+
+	protected:
+		/// Converts a spatial range into the range of cells that overlap it; returns false if no cell does.
+		bool _clampToCellRange(float xmin, float xmax, float zmin, float zmax, unsigned int & xMinIndex, unsigned int & xMaxIndex, unsigned int & zMinIndex, unsigned int & zMaxIndex) const;
+		void _updateBounds();
+
+		float _originX;
+		float _originZ;
+		float _cellSize;
+		float _invCellSize;
+		unsigned int _numCellsX;
+		unsigned int _numCellsZ;
+		/// Number of 32-bit words in each row of the bitmap; each row starts on a new word.
+		unsigned int _wordsPerRow;
+		std::vector<unsigned int> _bits;
+		Util::AxisAlignedBox _bounds;
+		float _traversalCost;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -71,8 +71,11 @@ namespace SteerLib {
 
 		virtual std::vector<Util::Point> get2DStaticGeometry()
 		{
-			std::cout << "get static geometry not implemented yet" << std::endl;
 			std::vector<Util::Point> ps;
+			ps.push_back(Util::Point(_a.x, 0.0f, _a.z));
+			ps.push_back(Util::Point(_b.x, 0.0f, _b.z));
+			ps.push_back(Util::Point(_c.x, 0.0f, _c.z));
+			ps.push_back(Util::Point(_d.x, 0.0f, _d.z));
 			return ps;
 		}
 
@@ -31,6 +31,8 @@ namespace SteerLib
 
 		void draw(); // implementation in .cpp
 		const Util::AxisAlignedBox & getBounds();
+		/// Returns the boxes on either side of the door.
+		const std::vector<OrientedBoxObstacle *> & getWallSections() const { return _wallSections; }
 
 	protected:
 		double doorLocation;
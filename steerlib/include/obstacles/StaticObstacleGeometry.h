@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_STATIC_OBSTACLE_GEOMETRY_H__
+#define __STEERLIB_STATIC_OBSTACLE_GEOMETRY_H__
+
+/// @file StaticObstacleGeometry.h
+/// @brief Declares the SteerLib::StaticObstacleGeometry class, a flat 2D representation of all obstacles compiled once by the engine.
+
+#include <map>
+#include <set>
+#include <vector>
+#include "Globals.h"
+#include "interfaces/ObstacleInterface.h"
+#include "util/Geometry.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	/**
+	 * @brief The outlines of all obstacles as flat arrays of 2D line segments and circles, with precomputed normals.
+	 *
+	 * AI modules usually need the same few facts about a nearby obstacle every frame: its edges, the outward normal of
+	 * each edge, and which edge faces the agent.  Instead of re-deriving these from getBounds() or from linked obstacle
+	 * vertices every frame, the SimulationEngine compiles every obstacle once into this class (see
+	 * EngineInterface::getStaticObstacleGeometry()).  An AI still finds nearby obstacles with the spatial database, and
+	 * then looks up their compiled geometry with getCompiledObstacle() or findFacingSegment().
+	 *
+	 * Every obstacle becomes a closed loop of segments in the XZ plane, in counter-clockwise order (positive area, as
+	 * used by the RVO2 obstacle code), so the outward normal of each segment is on its right-hand side.  A loop of only
+	 * two vertices (a thin wall) becomes two segments, one for each side.  Circle obstacles additionally get an exact
+	 * circle; their segments approximate the circle with the same vertices as CircleObstacle::getCirclePoints().
+	 *
+	 * Some obstacles have several separate loops: the sections of a wall with a door, or the blocked rectangles of a
+	 * GridMapObstacle.  findFacingSegment() only considers the loop nearest to the point, and getLoopsInRange() finds the
+	 * loops near a query.  An obstacle with many loops also gets a coarse bucket grid of its loops, so that these
+	 * queries do not visit every blocked rectangle of a large map.
+	 *
+	 * The geometry is static: obstacles that change shape after they are compiled must be re-compiled.
+	 */
+	class STEERLIB_API StaticObstacleGeometry
+	{
+	public:
+		/// One edge of an obstacle outline.
+		struct Segment {
+			Util::Point start;
+			Util::Point end;
+			/// Unit vector from start to end.
+			Util::Vector direction;
+			/// Unit vector perpendicular to the segment, pointing out of the obstacle.
+			Util::Vector normal;
+			float length;
+			/// True if the outline is convex at the start vertex.
+			bool startIsConvex;
+			/// Indices of the neighbouring segments in the same loop.
+			unsigned int previous;
+			unsigned int next;
+			SteerLib::ObstacleInterface * obstacle;
+		};
+
+		/// The exact shape of a circle obstacle.
+		struct Circle {
+			Util::Point center;
+			float radius;
+			SteerLib::ObstacleInterface * obstacle;
+		};
+
+		/// One closed outline; its segments are consecutive.
+		struct Loop {
+			unsigned int firstSegment;
+			unsigned int numSegments;
+			Util::AxisAlignedBox bounds;
+		};
+
+		/// The range of segments, loops and circles that belong to one obstacle.
+		struct CompiledObstacle {
+			unsigned int firstSegment;
+			unsigned int numSegments;
+			unsigned int firstLoop;
+			unsigned int numLoops;
+			unsigned int firstCircle;
+			unsigned int numCircles;
+			/// Index of the bucket grid of the loops, or -1 if the obstacle has only a few loops.
+			int loopGrid;
+		};
+
+		/// Removes all compiled obstacles.
+		void clear();
+		/// Removes all compiled obstacles, then compiles the given obstacles.
+		void compile(const std::set<SteerLib::ObstacleInterface*> & obstacles);
+		/// Compiles one more obstacle.
+		void addObstacle(SteerLib::ObstacleInterface * obstacle);
+
+		const std::vector<Segment> & getSegments() const { return _segments; }
+		const std::vector<Loop> & getLoops() const { return _loops; }
+		const std::vector<Circle> & getCircles() const { return _circles; }
+		unsigned int getNumObstacles() const { return (unsigned int)_compiledObstacles.size(); }
+
+		/// Returns the compiled geometry of an obstacle, or NULL if the obstacle was not compiled.
+		const CompiledObstacle * getCompiledObstacle(const SteerLib::ObstacleInterface * obstacle) const;
+		/// Returns the segment of the obstacle that faces the point, i.e. the one of the nearest loop with the largest signed distance from the point; NULL if the obstacle has no segments.
+		const Segment * findFacingSegment(const SteerLib::ObstacleInterface * obstacle, const Util::Point & p) const;
+		/// Appends the indices of the obstacle's loops whose bounds overlap the range, in increasing order, to loops.
+		void getLoopsInRange(const SteerLib::ObstacleInterface * obstacle, float xmin, float xmax, float zmin, float zmax, std::vector<unsigned int> & loops) const;
+
+		/// Returns the signed distance from the (infinite) line of the segment to the point; positive outside the obstacle.
+		static float signedDistance(const Segment & segment, const Util::Point & p) { return Util::dot(p - segment.start, segment.normal); }
+		/// Returns the point on the segment closest to the point.
+		static Util::Point closestPointOnSegment(const Segment & segment, const Util::Point & p);
+
+	protected:
+		/// Buckets of a uniform grid over an obstacle; each bucket lists the loops that overlap it.
+		struct LoopGrid {
+			float xmin;
+			float zmin;
+			float cellSize;
+			unsigned int numCellsX;
+			unsigned int numCellsZ;
+			/// The loops of bucket (x,z) are loopIndices[cellStarts[i]] to loopIndices[cellStarts[i+1]-1], where i = x * numCellsZ + z.
+			std::vector<unsigned int> cellStarts;
+			std::vector<unsigned int> loopIndices;
+		};
+
+		void _addLoop(SteerLib::ObstacleInterface * obstacle, std::vector<Util::Point> vertices);
+		void _buildLoopGrid(CompiledObstacle & compiled);
+		unsigned int _findNearestLoop(const CompiledObstacle & compiled, const Util::Point & p) const;
+		float _distanceToLoop(const Loop & loop, const Util::Point & p) const;
+
+		/// Obstacles with more loops than this get a LoopGrid.
+		static const unsigned int MIN_LOOPS_FOR_LOOP_GRID = 16;
+
+		std::vector<Segment> _segments;
+		std::vector<Loop> _loops;
+		std::vector<LoopGrid> _loopGrids;
+		std::vector<Circle> _circles;
+		std::map<const SteerLib::ObstacleInterface*, CompiledObstacle> _compiledObstacles;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -78,9 +78,14 @@ namespace SteerLib {
 			if (n1.f != n2.f) {
 				return (n1.f < n2.f);
 			}
-			else {
+			else if (n1.g != n2.g) {
 				return (n1.g > n2.g);
 			}
+			else {
+				// the open set is a std::set, so nodes of different states must never compare equal;
+				// otherwise a node with the same f and g as one already open is silently dropped.
+				return (n1.action.state < n2.action.state);
+			}
 		}
 	};
 
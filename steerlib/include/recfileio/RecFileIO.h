@@ -14,6 +14,9 @@
 #include "util/Geometry.h"
 #include "recfileio/RecFileIOPrivate.h"
 
+/// The default number of frames read ahead by the rec file players; see SteerLib::RecFileReader::setReadAhead().
+#define DEFAULT_REC_FILE_READ_AHEAD_FRAMES 64
+
 namespace SteerLib {
 
 	//added by Cory, we're starting to have a lot of rec file formats running around
@@ -25,6 +28,19 @@ namespace SteerLib {
 		DATA_REC,
 		SHADOW_REC
 	};
+
+	/**
+	 * @brief The state of one agent, as returned by the RecFileReader queries that read all agents at once.
+	 *
+	 * The values are the same as those returned by the corresponding per-agent queries.
+	 */
+	struct STEERLIB_API RecFileAgentState {
+		Util::Point position;
+		Util::Vector direction;
+		Util::Point goal;
+		float radius;
+		bool enabled;
+	};
 	/** 
 	 * @brief The public interface for reading SteerSuite rec files (recordings of agents steering).
 	 *
@@ -46,7 +62,8 @@ namespace SteerLib {
 	 * This particular error-check was omitted for performance reasons.
 	 *
 	 * Internally, the rec file is memory mapped, so randomly accessing data at
-	 * different frames or timestamps should still perform well.
+	 * different frames or timestamps should still perform well.  For playback, getAgentStatesAtTime() reads
+	 * all agents with a single frame lookup, and setReadAhead() loads the upcoming frames in a background thread.
 	 *
 	 * There are two different sets of agent queries.  The first returns exact values for position
 	 * and orientation for a given recorded frame.  The second returns interpolated values for 
@@ -174,6 +191,27 @@ namespace SteerLib {
 		/// Returns the obstacle bounds of an obstacle at the specified time stamp.
 		inline Util::AxisAlignedBox getObstacleBoundsAtTime( unsigned int obstacleIndex, float time ) { Util::AxisAlignedBox b; getObstacleBoundsAtTime(obstacleIndex, time, b.xmin, b.xmax, b.ymin, b.ymax, b.zmin, b.zmax); return b; }
 		//@}
+
+		/// @name Queries of all agents at once
+		/// @brief These functions fill the state of every agent into a caller-provided array of getNumAgents() items; they give the same values as the per-agent queries, but look up the frames only once.
+		//@{
+		/// Returns the state of all agents at the specified frame number.
+		void getAgentStatesAtFrame( unsigned int frameNumber, RecFileAgentState * agentStates );
+		/// Returns the state of all agents at the specified frame number, resizing agentStates to the number of agents.
+		inline void getAgentStatesAtFrame( unsigned int frameNumber, std::vector<RecFileAgentState> & agentStates ) { agentStates.resize(getNumAgents()); if (!agentStates.empty()) getAgentStatesAtFrame(frameNumber, &agentStates[0]); }
+		/// Returns the state of all agents at the specified time stamp, interpolated the same way as the per-agent queries.
+		void getAgentStatesAtTime( float time, RecFileAgentState * agentStates );
+		/// Returns the state of all agents at the specified time stamp, resizing agentStates to the number of agents.
+		inline void getAgentStatesAtTime( float time, std::vector<RecFileAgentState> & agentStates ) { agentStates.resize(getNumAgents()); if (!agentStates.empty()) getAgentStatesAtTime(time, &agentStates[0]); }
+		//@}
+
+		/// @name Reading ahead
+		//@{
+		/// While frames are read in order, reads up to numFrames frames ahead in a background thread, so that playback does not wait for the disk; 0 (the default) disables reading ahead.  Call after open(); close() disables reading ahead.
+		void setReadAhead( unsigned int numFrames );
+		/// Returns the number of frames that are read ahead, or 0 if reading ahead is disabled.
+		unsigned int getReadAhead() { return _numReadAheadFrames; }
+		//@}
 	};
 
 
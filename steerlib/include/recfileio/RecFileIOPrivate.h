@@ -18,6 +18,7 @@
 #include <vector>
 #include "Globals.h"
 #include "util/MemoryMapper.h"
+#include "util/ThreadedTaskManager.h"
 
 #ifdef _WIN32
 // on win32, there is an unfortunate conflict between exporting symbols for a
@@ -201,6 +202,18 @@ namespace SteerLib {
 		RecFileReaderPrivate() { }
 
 		void _getFramesForTime(float time, unsigned int &frameIndex1, unsigned int &frameIndex2);
+		/// Called with every frame that is read; while frames are read in order, schedules the next frames to be read in the background.
+		void _readAhead(unsigned int frameIndex);
+		/// Waits for any read-ahead in progress, and stops the read-ahead thread.
+		void _stopReadAhead();
+		/// The task executed by the read-ahead thread; touches every page of a range of frames, so that the OS loads them before they are needed.
+		static void _readAheadTask(unsigned int threadIndex, void * data);
+
+		/// A range of bytes for the read-ahead thread; allocated for each task and deleted by the task.
+		struct ReadAheadRange {
+			const char * firstByte;
+			size_t numBytes;
+		};
 
 		std::string _filename;
 		std::string _testCaseName;
@@ -216,6 +229,11 @@ namespace SteerLib {
 
 		unsigned int f1_used_in_getFramesForTimeFunction, f2_used_in_getFramesForTimeFunction;
 		float prevTime_used_in_getFramesForTimeFunction;
+
+		Util::ThreadedTaskManager * _readAheadTaskManager;
+		unsigned int _numReadAheadFrames;
+		unsigned int _lastFrameRead;
+		unsigned int _readAheadEndFrame;
 	};
 
 
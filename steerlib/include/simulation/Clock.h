@@ -168,10 +168,21 @@ namespace SteerLib {
 	};
 */
 
+	/**
+	 * @brief The simulation and real-time clocks of the engine.
+	 *
+	 * In the real-time modes, advanceSimulationAndUpdateRealTime() waits until the frame's real time is due.  How it
+	 * waits is the frame pacing: FRAME_PACING_BUSY_WAIT polls the counter the whole time (most accurate, but uses a
+	 * full core), FRAME_PACING_SLEEP gives up the processor until the deadline (cheapest, but wakes up as late as
+	 * the operating system's timer allows), and FRAME_PACING_HYBRID, the default, sleeps until the spin time before
+	 * the deadline and polls the counter for the rest.  The pacing statistics tell how late each wait ended, so the
+	 * spin time can be tuned for the machine.
+	 */
 	class STEERLIB_API Clock
 	{
 	public:
 		enum ClockModeEnum { CLOCK_MODE_FIXED_AS_FAST_AS_POSSIBLE,  CLOCK_MODE_FIXED_REAL_TIME,  CLOCK_MODE_VARIABLE_REAL_TIME };
+		enum FramePacingEnum { FRAME_PACING_BUSY_WAIT,  FRAME_PACING_SLEEP,  FRAME_PACING_HYBRID };
 
 		Clock();
 		Clock(ClockModeEnum clockMode, float fixedFps, float minSimulationDt, float maxSimulationDt);
@@ -210,6 +221,28 @@ namespace SteerLib {
 		inline float getRealFps() { return _measuredFps; }
 		/// Returns the current frame number; the first frame is frame 0 before advanceOneStep() is called.
 		inline unsigned int getCurrentFrameNumber() { return _simulationFrameNumber; }
+		/// Returns how the clock waits for the next frame in the real-time modes.
+		inline FramePacingEnum getFramePacing() { return _framePacing; }
+		/// Returns the time (in seconds) that FRAME_PACING_HYBRID spins before each deadline.
+		inline float getFramePacingSpinTime() { return _counterTicksToSeconds(_spinTicks); }
+		//@}
+
+		/// @name Frame pacing statistics
+		/// @brief Measured over the frames that had to wait for their deadline since the last reset() or resetPacingStatistics().
+		//@{
+		/// Returns the number of frames that waited for their deadline.
+		inline unsigned int getNumPacedFrames() { return _numPacedFrames; }
+		/// Returns the mean time (in seconds) between the deadline and the end of the wait.
+		float getMeanPacingLateness();
+		/// Returns the standard deviation (in seconds) of the time between the deadline and the end of the wait; this is the frame jitter added by pacing.
+		float getPacingLatenessStandardDeviation();
+		/// Returns the largest time (in seconds) between a deadline and the end of its wait.
+		inline float getMaxPacingLateness() { return _counterTicksToSeconds(_maxPacingLatenessTicks); }
+		/// Returns the total time (in seconds) spent sleeping while waiting for deadlines.
+		inline float getTotalPacingSleepTime() { return _counterTicksToSeconds(_totalPacingSleepTicks); }
+		/// Returns the total time (in seconds) spent polling the counter while waiting for deadlines; this is the CPU time used by pacing.
+		inline float getTotalPacingSpinTime() { return _counterTicksToSeconds(_totalPacingSpinTicks); }
+		void resetPacingStatistics();
 		//@}
 
 		/// @name Accessor "set" functions
@@ -219,12 +252,25 @@ namespace SteerLib {
 		/// Sets the frame rate to be used when the user is interactively stepping through a simularion, and when the clock mode is FIXED_FRAME_RATE.
 		void setMaxTimeBetweenFrames(float framesPerSecond);
 		void setClockMode(ClockModeEnum clockMode, float fixedFps, float minSimulationDt, float maxSimulationDt);
+		/// Sets how the clock waits for the next frame in the real-time modes; spinTime (in seconds) is only used by FRAME_PACING_HYBRID.
+		void setFramePacing(FramePacingEnum framePacing, float spinTime);
+		//@}
+
+		/// @name Snapshot support
+		/// @brief Only the simulation clock is saved and restored; the real-time clock keeps running so that frame pacing and fps measurements do not jump.
+		//@{
+		/// Returns the simulation frame number, total simulation time and last simulation dt (times in seconds).
+		void getSimulationState(unsigned int & frameNumber, double & totalSimulationTime, double & simulationDt);
+		/// Sets the simulation frame number, total simulation time and last simulation dt (times in seconds).
+		void setSimulationState(unsigned int frameNumber, double totalSimulationTime, double simulationDt);
 		//@}
 
 	protected:
 		/// @name Protected helper functions
 		//@{
 		void _waitForFrameSync(const unsigned long long & minDesiredTicks);
+		/// Gives up the processor for about the given number of counter ticks.
+		void _sleepForTicks(unsigned long long ticks);
 		void _updateFpsMeasurement();
 		inline float _counterTicksToSeconds(unsigned long long ticks) {
 			return (float)ticks * _inverseFrequency;
@@ -257,6 +303,16 @@ namespace SteerLib {
 		unsigned long long _maxSimulationDt;
 
 		ClockModeEnum _clockMode;
+		FramePacingEnum _framePacing;
+		unsigned long long _spinTicks;
+
+		unsigned int _numPacedFrames;
+		double _sumPacingLatenessTicks;
+		double _sumSquaredPacingLatenessTicks;
+		unsigned long long _maxPacingLatenessTicks;
+		unsigned long long _totalPacingSleepTicks;
+		unsigned long long _totalPacingSpinTicks;
+
 		float _fixedSimulationFrameRate;
 		float _measuredFps;
 		float _inverseFrequency;
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_RENDER_SNAPSHOT_H__
+#define __STEERLIB_RENDER_SNAPSHOT_H__
+
+/// @file RenderSnapshot.h
+/// @brief Declares SteerLib::RenderSnapshot and SteerLib::RenderSnapshotBuffer, which hand the state of each simulated frame to a render thread.
+
+#include <vector>
+#include "Globals.h"
+#include "util/Geometry.h"
+#include "util/Color.h"
+#include "util/Mutex.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	class AgentInterface;
+	class ObstacleInterface;
+
+	/// The state of one enabled agent, as it was when the frame was published.
+	struct STEERLIB_API AgentRenderState {
+		/// Identifies the agent (e.g. for mouse selection); it must not be dereferenced while the simulation is running.
+		SteerLib::AgentInterface * agent;
+		Util::Point position;
+		Util::Vector forward;
+		float radius;
+		bool selected;
+		/// True if the agent's current goal is a static target, which is drawn as a flag at goalLocation.
+		bool hasStaticGoal;
+		Util::Point goalLocation;
+	};
+
+	/// One shaded cell of the spatial database, as it was when the frame was published.
+	struct STEERLIB_API GridCellRenderState {
+		Util::AxisAlignedBox bounds;
+		Util::Color color;
+	};
+
+	/**
+	 * @brief Everything needed to draw one simulated frame, copied out of the engine when the frame finished.
+	 *
+	 * A snapshot is filled by SimulationEngine on the simulation thread and drawn with SimulationEngine::drawRenderSnapshot()
+	 * on the render thread.  Obstacles are kept as pointers, because they are static while a simulation is running.  The
+	 * spatial database changes every frame, so the cells it would draw are copied (see SpatialDataBaseInterface::getCellsToDraw()).
+	 */
+	class STEERLIB_API RenderSnapshot {
+	public:
+		RenderSnapshot() : frameNumber(0), simulationTime(0.0f), drawGrid(false) { }
+
+		unsigned int frameNumber;
+		float simulationTime;
+		std::vector<AgentRenderState> agents;
+		std::vector<SteerLib::ObstacleInterface*> obstacles;
+		/// True if the spatial database draws itself; then gridBounds is its nominal window and gridCells are its shaded cells.
+		bool drawGrid;
+		Util::AxisAlignedBox gridBounds;
+		std::vector<GridCellRenderState> gridCells;
+	};
+
+	/**
+	 * @brief A triple buffer of RenderSnapshot objects, shared by one simulation thread and one render thread.
+	 *
+	 * The writer fills the snapshot returned by beginWrite() and then calls publish(); the reader calls acquireLatest()
+	 * whenever it is about to draw.  Each side owns one of the three snapshots, and the third holds the most recently
+	 * published frame, so neither side ever waits for the other to finish: the lock is only held to swap two indices.
+	 * If the writer publishes several frames between two draws, the reader skips to the latest one.  The snapshots are
+	 * re-used, so once their vectors have grown to the size of the crowd, publishing a frame does not allocate memory.
+	 */
+	class STEERLIB_API RenderSnapshotBuffer {
+	public:
+		RenderSnapshotBuffer();
+
+		/// Returns the snapshot that the writer may fill; call only from the simulation thread.
+		RenderSnapshot & beginWrite() { return _snapshots[_writeIndex]; }
+		/// Makes the snapshot returned by beginWrite() the latest frame.
+		void publish();
+		/// Returns the latest published frame, or NULL if nothing was published yet; call only from the render thread.  The snapshot remains valid until the next call.
+		const RenderSnapshot * acquireLatest();
+		/// Forgets all published frames; must not be called while either thread is using the buffer.
+		void clear();
+
+	protected:
+		RenderSnapshot _snapshots[3];
+		unsigned int _writeIndex;
+		unsigned int _readyIndex;
+		unsigned int _readIndex;
+		bool _hasNewSnapshot;
+		bool _hasReadSnapshot;
+		Util::Mutex _lock;
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -15,10 +15,17 @@
 ///   - add support/safety for a module to unload itself
 
 #include "interfaces/EngineInterface.h"
+#include "simulation/RenderSnapshot.h"
+#include "simulation/SimulationSnapshot.h"
 #include "util/StateMachine.h"
 
 #define KEY_PRESSED 1
 
+namespace Util {
+	class DrawBatch;
+	class ViewFrustum;
+}
+
 #ifdef _WIN32
 // on win32, there is an unfortunate conflict between exporting symbols for a
 // dynamic/shared library and STL code.  A good document describing the problem
@@ -159,6 +166,25 @@ namespace SteerLib {
 		/// stops execution
 		void stop();
 		//@}
+
+		/// @name Snapshots
+		/// @brief Checkpoints of a running simulation, so that many continuations can branch from one warm-up run; see SteerLib::SimulationSnapshot.
+		//@{
+		/// Saves the simulation clock, all agents, and the state of all modules; can be called any time between preprocessSimulation() and postprocessSimulation().
+		void saveSnapshot(SteerLib::SimulationSnapshot & snapshot);
+		/// Restores a snapshot taken by this engine or by another engine running the same test case with the same modules; afterwards the simulation continues normally with update(), even if it had already finished.
+		void restoreSnapshot(const SteerLib::SimulationSnapshot & snapshot);
+		//@}
+
+		/// @name Render snapshots
+		/// @brief Lets a GUI simulate on one thread and draw on another; see SteerLib::RenderSnapshotBuffer.
+		//@{
+		/// When enabled, the engine publishes a RenderSnapshot after preprocessSimulation() and after every simulated frame, and update() no longer updates the camera, which then belongs to the render thread.
+		void setRenderSnapshotsEnabled(bool enabled) { _renderSnapshotsEnabled = enabled;  _renderSnapshots.clear(); }
+		bool getRenderSnapshotsEnabled() { return _renderSnapshotsEnabled; }
+		/// The render thread calls RenderSnapshotBuffer::acquireLatest() on this buffer to get the frame to draw.
+		SteerLib::RenderSnapshotBuffer & getRenderSnapshotBuffer() { return _renderSnapshots; }
+		//@}
 	#ifdef ENABLE_GUI
 		/// Handles keyboard and mouse input by forwarding the keyboard event to all modules.
 		void processKeyboardInput(int key, int action);
@@ -170,6 +196,8 @@ namespace SteerLib {
 		void resizeGL(int width, int height);
 		/// Draws the scene using openGL; should only be called after initializing the engine, but a simulation does not have to be loaded.
 		void draw();
+		/// Draws a published frame instead of the live simulation, so that it can be called while another thread runs update(); module annotations (ModuleInterface::draw()) are not drawn, because they read the live simulation state.
+		void drawRenderSnapshot(const SteerLib::RenderSnapshot & snapshot);
 	#endif
 
 		/// @name EngineInterface functionality
@@ -180,6 +208,7 @@ namespace SteerLib {
 		virtual const std::vector<SteerLib::AgentInterface*> & getAgents() { return _agents; }
 		virtual const std::set<SteerLib::AgentInterface*> & getSelectedAgents() { return _selectedAgents; }
 		virtual const std::set<SteerLib::ObstacleInterface*> & getObstacles() { return _obstacles; }
+		virtual const SteerLib::StaticObstacleGeometry & getStaticObstacleGeometry();
 		virtual SteerLib::ModuleInterface * getModule(const std::string & moduleName);
 		virtual SteerLib::ModuleMetaInformation * getModuleMetaInfo(const std::string & moduleName);
 		virtual SteerLib::ModuleMetaInformation * getModuleMetaInfo(SteerLib::ModuleInterface * module);
@@ -248,12 +277,22 @@ namespace SteerLib {
 		bool _unloadModule(SteerLib::ModuleInterface * moduleToDestroy, bool recursivelyUnloadDependencies, bool errorIfCannotUnload );
 		/// Helper function to initialize and start the engine state machine that makes sure the engine is always in a valid state.
 		void _setupStateMachine();
+		/// Returns the bounds that agents use for their entry in the spatial database.
+		Util::AxisAlignedBox _getAgentDatabaseBounds(SteerLib::AgentInterface * agent);
+		/// Lists the agents and obstacles that snapshot item references are indices into.
+		void _getSnapshotItems(std::vector<SteerLib::SpatialDatabaseItemPtr> & items);
+		/// Copies the drawable state of the current frame into the render snapshot buffer.
+		void _publishRenderSnapshot();
 
 	#ifdef ENABLE_GUI
 		void _drawEnvironment();
 		void _drawModules();
 		void _drawObstacles();
 		void _drawAgents();
+		/// Compiles the obstacles into one display list per tile of the scene, for the batched drawing mode.
+		void _buildObstacleDrawTiles();
+		/// Calls the display lists of the obstacle tiles that intersect the frustum.
+		void _drawObstacleTiles(const Util::ViewFrustum & frustum);
 	#endif
 
 		class EngineStateMachineCallback : public Util::StateMachineCallbackInterface
@@ -300,7 +339,26 @@ namespace SteerLib {
 		SteerLib::SpatialDataBaseInterface * _spatialDatabase;
 		SteerLib::PlanningDomainInterface * _pathPlanner;
 		std::set<SteerLib::ObstacleInterface*> _obstacles;
+		/// The compiled outlines of _obstacles; re-compiled when needed after obstacles are added or removed.
+		SteerLib::StaticObstacleGeometry _staticObstacleGeometry;
+		bool _staticObstacleGeometryIsCurrent;
 		SteerLib::EngineControllerInterface * _engineController;
+		SteerLib::RenderSnapshotBuffer _renderSnapshots;
+		bool _renderSnapshotsEnabled;
+		//@}
+
+		/// @name Batched drawing (the GUI option useBatchedDrawing)
+		//@{
+		/// A group of nearby obstacles, compiled into one openGL display list.
+		struct ObstacleDrawTile {
+			Util::AxisAlignedBox bounds;
+			unsigned int displayList;
+		};
+		std::vector<ObstacleDrawTile> _obstacleDrawTiles;
+		/// false when obstacles were added or removed since the tiles were compiled.
+		bool _obstacleDrawTilesAreCurrent;
+		/// Created by initGL().
+		Util::DrawBatch * _drawBatch;
 		//@}
 
 
@@ -262,6 +262,8 @@ namespace SteerLib {
 			float minVariableDt;
 			float maxVariableDt;
 			std::string clockMode;
+			std::string framePacing;
+			float framePacingSpinTime;
 		};
 
 		struct GridDatabaseOptions {
@@ -296,6 +298,11 @@ namespace SteerLib {
 			float cameraFovy;
 			Util::Color backgroundColor;
 			float lineWidth;
+			bool useSimulationThread;
+			bool useBatchedDrawing;
+			std::string frameDumpFormat;
+			unsigned int numFrameDumpThreads;
+			unsigned int maxQueuedFrameDumps;
 		};
 
 		struct CommandLineEngineDriverOptions {
@@ -315,6 +322,21 @@ namespace SteerLib {
 		struct QtEngineDriverOptions {
 		};
 
+		struct EnsembleEngineDriverOptions {
+			std::string runListFilename;
+			unsigned int numRuns;
+			unsigned int firstSeed;
+			unsigned int numThreads;
+			std::string outputFilename;
+		};
+
+		struct ServerEngineDriverOptions {
+			std::string socketPath;
+			std::string sharedMemoryName;
+			unsigned int numStateSlots;
+			unsigned int maxAgents;
+		};
+
 		/// @name Options data
 		/// @brief The actual options are stored in these public data structures.
 		///
@@ -338,6 +360,8 @@ namespace SteerLib {
 		CommandLineEngineDriverOptions   commandLineEngineDriverOptions;
 		GLFWEngineDriverOptions   glfwEngineDriverOptions;
 		QtEngineDriverOptions   qtEngineDriverOptions;
+		EnsembleEngineDriverOptions   ensembleEngineDriverOptions;
+		ServerEngineDriverOptions   serverEngineDriverOptions;
 		SteerLib::ModuleOptionsDatabase   moduleOptionsDatabase;
 		//@}
 
@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_SIMULATION_SNAPSHOT_H__
+#define __STEERLIB_SIMULATION_SNAPSHOT_H__
+
+/// @file SimulationSnapshot.h
+/// @brief Declares SteerLib::SimulationSnapshot and the state reader/writer classes used by agents and modules to save their state.
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <map>
+#include <cstring>
+#include "Globals.h"
+#include "testcaseio/AgentInitialConditions.h"
+#include "interfaces/SpatialDatabaseItem.h"
+#include "util/GenericException.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	/// The magic number that identifies a simulation snapshot file.
+	const unsigned int SIMULATION_SNAPSHOT_MAGIC_NUMBER = 0x5a4e5053;
+	/// The version of the snapshot format; snapshots of a different version are rejected.
+	const unsigned int SIMULATION_SNAPSHOT_VERSION = 1;
+
+
+	/**
+	 * @brief Appends the binary state of agents and modules to a simulation snapshot.
+	 *
+	 * The write() and writeVector() functions copy raw bytes, so they should only be used
+	 * for plain data such as floats, Util::Point, Util::Vector, Util::Color and Util::AxisAlignedBox.
+	 * Pointers should never be written directly; references to agents and obstacles are written with writeItemReference(),
+	 * which stores the item's index among the engine's agents (followed by its obstacles).
+	 */
+	class STEERLIB_API SimulationStateWriter {
+	public:
+		SimulationStateWriter() : _itemIndices(NULL) { }
+		/// The engine sets this before agents and modules save their state, so that they can write references to items.
+		void setItemIndices(const std::map<const SteerLib::SpatialDatabaseItem*, int> * itemIndices) { _itemIndices = itemIndices; }
+
+		template<typename T>
+		void write(const T & value) { _data.append((const char*)&value, sizeof(T)); }
+
+		template<typename T>
+		void writeVector(const std::vector<T> & values) {
+			write((unsigned int)values.size());
+			if (!values.empty()) _data.append((const char*)&values[0], sizeof(T) * values.size());
+		}
+
+		template<typename T>
+		void writeDeque(const std::deque<T> & values) {
+			write((unsigned int)values.size());
+			for (unsigned int i=0; i < values.size(); i++) write(values[i]);
+		}
+
+		void writeString(const std::string & value);
+		void writeGoal(const SteerLib::AgentGoalInfo & goal);
+		void writeGoalQueue(const std::queue<SteerLib::AgentGoalInfo> & goals);
+		void writeInitialConditions(const SteerLib::AgentInitialConditions & initialConditions);
+		/// Writes a reference to an agent or obstacle known to the engine; NULL and unknown items are read back as NULL.
+		void writeItemReference(const SteerLib::SpatialDatabaseItem * item);
+
+		/// Returns the bytes written so far.
+		const std::string & getData() const { return _data; }
+
+	protected:
+		std::string _data;
+		const std::map<const SteerLib::SpatialDatabaseItem*, int> * _itemIndices;
+	};
+
+
+	/**
+	 * @brief Reads back the state that was written by a SimulationStateWriter.
+	 *
+	 * Values must be read in exactly the same order they were written; reading past the end throws a Util::GenericException.
+	 */
+	class STEERLIB_API SimulationStateReader {
+	public:
+		SimulationStateReader(const std::string & data) : _data(data), _cursor(0), _items(NULL) { }
+		/// The engine sets this before agents and modules restore their state, so that they can read references to items.
+		void setItems(const std::vector<SteerLib::SpatialDatabaseItemPtr> * items) { _items = items; }
+
+		template<typename T>
+		void read(T & value) {
+			_checkAvailable(sizeof(T));
+			memcpy(&value, _data.data() + _cursor, sizeof(T));
+			_cursor += sizeof(T);
+		}
+
+		template<typename T>
+		void readVector(std::vector<T> & values) {
+			unsigned int numValues;
+			read(numValues);
+			_checkAvailable(sizeof(T) * (size_t)numValues);
+			values.resize(numValues);
+			if (numValues > 0) memcpy(&values[0], _data.data() + _cursor, sizeof(T) * numValues);
+			_cursor += sizeof(T) * numValues;
+		}
+
+		template<typename T>
+		void readDeque(std::deque<T> & values) {
+			unsigned int numValues;
+			read(numValues);
+			_checkAvailable(sizeof(T) * (size_t)numValues);
+			values.resize(numValues);
+			for (unsigned int i=0; i < numValues; i++) read(values[i]);
+		}
+
+		void readString(std::string & value);
+		void readGoal(SteerLib::AgentGoalInfo & goal);
+		void readGoalQueue(std::queue<SteerLib::AgentGoalInfo> & goals);
+		void readInitialConditions(SteerLib::AgentInitialConditions & initialConditions);
+		/// Reads a reference written by SimulationStateWriter::writeItemReference().
+		SteerLib::SpatialDatabaseItemPtr readItemReference();
+
+		/// Returns true if all the data has been read.
+		bool atEnd() const { return _cursor == _data.size(); }
+
+	protected:
+		void _checkAvailable(size_t numBytes) {
+			if (numBytes > _data.size() - _cursor) throw Util::GenericException("Simulation snapshot data is truncated or does not match the agent/module that is reading it.");
+		}
+
+		const std::string & _data;
+		size_t _cursor;
+		const std::vector<SteerLib::SpatialDatabaseItemPtr> * _items;
+	};
+
+
+	/**
+	 * @brief A checkpoint of a running simulation, used to branch many continuations from a single warm-up run.
+	 *
+	 * A snapshot is taken with SimulationEngine::saveSnapshot() and restored with SimulationEngine::restoreSnapshot().  It holds
+	 * the simulation clock, the engine's frame counters, the state of every agent (see AgentInterface::saveState()), and the state
+	 * of every module that implements ModuleInterface::saveSimulationState().  The spatial database is not stored directly;
+	 * the engine re-inserts agents at their restored positions.
+	 *
+	 * Static data (obstacles, the path planner, module options) is not part of a snapshot, so a snapshot can only be restored into
+	 * an engine that is running the same test case with the same modules, either the engine that created it or another engine that
+	 * loaded the same scenario.  Snapshots can be kept in memory or written to disk with writeToFile().  Item references to
+	 * obstacles use the order of EngineInterface::getObstacles(), which is sorted by address; they are exact when restoring
+	 * within the same process, but may refer to different obstacles when a snapshot file is restored by another process.  Many AI
+	 * modules also visit their neighbors in address order, so a snapshot restored into a different engine continues identically
+	 * only up to floating point rounding.
+	 *
+	 * Metrics collectors (SimulationMetricsCollector and AgentMetricsCollector, e.g. those of the metricsCollector module and of
+	 * benchmark techniques) are not part of a snapshot.  Restoring a snapshot does not roll them back, so after a restore their
+	 * metrics cover the frames simulated before the restore as well as after it; to measure only one continuation, reset the
+	 * collectors after restoring, or take the snapshot without the metrics modules and restore it into a fresh engine that loads them.
+	 */
+	class STEERLIB_API SimulationSnapshot {
+	public:
+		/// The saved state of one agent.
+		struct AgentRecord {
+			/// Name of the module that owns the agent.
+			std::string ownerModuleName;
+			/// Emitter that spawned the agent, or -1.
+			int emitterNum;
+			/// Conditions used to re-create the agent if it does not exist in the engine being restored.
+			std::string initialConditions;
+			/// The agent's state, as written by AgentInterface::saveState().
+			std::string state;
+		};
+
+		SimulationSnapshot() { clear(); }
+
+		void clear();
+		void writeToFile(const std::string & filename) const;
+		void readFromFile(const std::string & filename);
+
+		/// Returns the simulation frame number when the snapshot was taken.
+		unsigned int getFrameNumber() const { return frameNumber; }
+		/// Returns the simulation time (in seconds) when the snapshot was taken.
+		double getSimulationTime() const { return totalSimulationTime; }
+		/// Returns the number of agents in the snapshot.
+		size_t getNumAgents() const { return agents.size(); }
+
+		/// @name Snapshot contents; filled and read by SimulationEngine.
+		//@{
+		unsigned int frameNumber;
+		double totalSimulationTime;
+		double simulationDt;
+		unsigned int numFramesSimulated;
+		std::vector<AgentRecord> agents;
+		/// Pairs of module name and that module's saved state, in execution order.
+		std::vector<std::pair<std::string, std::string> > modules;
+		//@}
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
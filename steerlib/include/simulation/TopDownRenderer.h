@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_TOP_DOWN_RENDERER_H__
+#define __STEERLIB_TOP_DOWN_RENDERER_H__
+
+/// @file TopDownRenderer.h
+/// @brief Declares SteerLib::TopDownRenderer, which renders top-down PNG frames of a simulation without openGL.
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "Globals.h"
+#include "util/Geometry.h"
+#include "util/Mutex.h"
+#include "util/RasterImage.h"
+#include "util/ThreadedTaskManager.h"
+#include "recfileio/RecFileIO.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	/// The options of a SteerLib::TopDownRenderer; the constructor sets the defaults.
+	struct STEERLIB_API TopDownRendererOptions {
+		TopDownRendererOptions();
+		unsigned int imageWidth;
+		unsigned int imageHeight;
+		/// The number of threads that render and write frames.
+		unsigned int numThreads;
+		/// The maximum number of frames waiting to be rendered; addFrame() waits when the queue is full.
+		unsigned int maxQueuedFrames;
+		/// The number of previous frames of each agent's path that are drawn behind it; 0 draws no trails.
+		unsigned int trailLength;
+		/// Draws a line from the center of each agent in the direction it faces.
+		bool drawHeadings;
+		/// The zlib compression level of the PNG files, from 1 (fastest) to 9 (smallest).
+		int compressionLevel;
+	};
+
+	/**
+	 * @brief Renders agents, obstacles and agent trails as seen from above into PNG files, on a pool of threads.
+	 *
+	 * This renderer does not need openGL, a display, or a GPU, so it can make thumbnails and videos of simulations on
+	 * machines that only run steersim -commandline.  Frames are given in order with addFrame(), either from a
+	 * recording (see renderRecFile()) or from the live engine (see the topDownRenderer module); the calling thread
+	 * only copies the agent states and updates the trails, and the frames are rasterized and compressed by the
+	 * worker threads.  As with the FrameCapture of the GUI drivers, at most maxQueuedFrames frames wait at any time.
+	 *
+	 * Agents are indexed the same way in every frame, so that their trails can be followed.  The obstacles and world
+	 * bounds are shared by all frames; set them before the first frame, or after finish().  If the world bounds
+	 * are not set, the first frame shows the obstacles and the agents of that frame.
+	 */
+	class STEERLIB_API TopDownRenderer {
+	public:
+		TopDownRenderer(const TopDownRendererOptions & options);
+		/// Waits for the queued frames; call finish() first to see any errors.
+		~TopDownRenderer();
+
+		void setObstacles(const std::vector<Util::AxisAlignedBox> & obstacles);
+		/// Sets the part of the ground plane that is shown (only x and z are used).
+		void setWorldBounds(const Util::AxisAlignedBox & bounds);
+
+		/// Queues a frame that is written to filename.
+		void addFrame(const std::vector<RecFileAgentState> & agents, const std::string & filename);
+		/// Waits until all queued frames are written; throws the first error of the worker threads, if any.
+		void finish();
+		/// Returns the number of frames given to addFrame().
+		unsigned int getNumFramesAdded() const { return _numFramesAdded; }
+
+		/// Renders frames 0, frameStep, 2*frameStep, ... of the rec file to <filePrefix>NNNNN.png, and returns the number of frames written.
+		unsigned int renderRecFile(RecFileReader & recFile, const std::string & filePrefix, unsigned int frameStep = 1);
+
+	protected:
+		struct Frame {
+			TopDownRenderer * owner;
+			std::string filename;
+			std::vector<RecFileAgentState> agents;
+			/// The trail of agent i is the polyline trailPoints[trailStarts[i]] .. trailPoints[trailStarts[i+1]-1].
+			std::vector<Util::Point> trailPoints;
+			std::vector<unsigned int> trailStarts;
+		};
+
+		static void _renderFrameTask(unsigned int threadIndex, void * data);
+		void _renderFrame(Frame * frame, Util::RasterImage & image);
+		Frame * _acquireFreeFrame();
+		void _throwWorkerError();
+
+		TopDownRendererOptions _options;
+		Util::ThreadedTaskManager * _taskManager;
+		/// One image per worker thread, reused for every frame.
+		std::vector<Util::RasterImage*> _images;
+
+		std::vector<Util::AxisAlignedBox> _obstacles;
+		Util::AxisAlignedBox _worldBounds;
+		bool _worldBoundsAreSet;
+		/// The recent positions of each agent, oldest first.
+		std::vector< std::deque<Util::Point> > _trails;
+		unsigned int _numFramesAdded;
+
+		/// Protects the frame pool and the error message.
+		Util::Mutex _lock;
+		std::vector<Frame*> _allFrames;
+		std::vector<Frame*> _freeFrames;
+		std::string _errorMessage;
+
+	private:
+		TopDownRenderer(const TopDownRenderer & );  // not implemented, not copyable
+		TopDownRenderer& operator= (const TopDownRenderer & );  // not implemented, not assignable
+	};
+
+} // end namespace SteerLib
+
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
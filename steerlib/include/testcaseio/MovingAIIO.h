@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __STEERLIB_MOVING_AI_IO_H__
+#define __STEERLIB_MOVING_AI_IO_H__
+
+/// @file MovingAIIO.h
+/// @brief Declares SteerLib::MovingAIReader, which reads the .map and .scen files of the MovingAI pathfinding benchmarks.
+
+#include <string>
+#include <vector>
+#include "Globals.h"
+#include "obstacles/GridMapObstacle.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace SteerLib {
+
+	/**
+	 * @brief One start/goal query of a MovingAI .scen file.
+	 *
+	 * The coordinates are map cells: x is the column and y is the row of the .map file, which become the x and z cell
+	 * coordinates of the GridMapObstacle.
+	 */
+	struct STEERLIB_API MovingAIScenarioEntry {
+		unsigned int bucket;
+		std::string mapName;
+		unsigned int mapWidth, mapHeight;
+		unsigned int startX, startY;
+		unsigned int goalX, goalY;
+		/// The length of the optimal octile path, where diagonal moves cost sqrt(2) and may not cut corners.
+		double optimalLength;
+	};
+
+	/**
+	 * @brief Reads the grid maps and scenario files of the MovingAI pathfinding benchmarks.
+	 *
+	 * A .map file is an "octile" grid where each character is one cell.  The cells '.', 'G' and 'S' are passable; all
+	 * others ('@', 'O', 'T', 'W') are blocked.  The map becomes a single GridMapObstacle whose cells are cellSize wide,
+	 * centered on the origin, with the rows of the file along z.
+	 *
+	 * TestCaseReader::readTestCaseFromFile() loads .map files directly, so they can be used anywhere a test case is expected.
+	 */
+	class STEERLIB_API MovingAIReader {
+	public:
+		/// Returns true if the file starts like a MovingAI .map file.
+		static bool isAMovingAIMap( const std::string & filename );
+		/// Reads a .map file; the caller owns the returned obstacle.  Throws a Util::GenericException if the file is not a valid map.
+		static GridMapObstacle * readMap( const std::string & filename, float cellSize = 1.0f );
+		/// Reads all the queries of a .scen file into entries (which is cleared first).
+		static void readScenario( const std::string & filename, std::vector<MovingAIScenarioEntry> & entries );
+	};
+
+} // end namespace SteerLib
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
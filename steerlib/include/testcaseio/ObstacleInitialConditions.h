@@ -16,6 +16,7 @@
 #include "obstacles/OrientedBoxObstacle.h"
 #include "obstacles/OrientedWallObstacle.h"
 #include "obstacles/PolygonObstacle.h"
+#include "obstacles/GridMapObstacle.h"
 
 namespace SteerLib {
 
@@ -97,6 +98,14 @@ namespace SteerLib {
 		virtual ObstacleInterface* createObstacle() { return new PolygonObstacle(_vertices); }
 	};
 
+	struct GridMapObstacleInitialConditions : public ObstacleInitialConditions
+	{
+		SteerLib::GridMapObstacle map;
+		GridMapObstacleInitialConditions(const SteerLib::GridMapObstacle & map_) : map(map_) {}
+
+		virtual ObstacleInterface* createObstacle() { return new SteerLib::GridMapObstacle(map); }
+	};
+
 	inline std::ostream &operator<<(std::ostream &out, const PolygonObstacleInitialConditions &a)
 		{ // methods used here must be const
 			out << "polygon initial conditions:"<<  std::endl;
@@ -59,8 +59,16 @@ namespace SteerLib {
 	class STEERLIB_API TestCaseReader : public TestCaseReaderPrivate {
 	public:
 		TestCaseReader();
-		/// Parses the specified XML test case; after this function returns the class contains all initialized information about the test case.
+		/// Re-seeds the random number generator used to resolve random initial conditions; call this before #readTestCaseFromFile() to get a different random instance of the test case.
+		void setRandomSeed( unsigned int seed ) { _randomNumberGenerator.seed(seed); }
+		/// Parses the specified XML test case; after this function returns the class contains all initialized information about the test case.  Compiled test cases and MovingAI maps are detected and loaded with #readTestCaseFromBinaryFile() and #readTestCaseFromMovingAIMap() instead.
 		void readTestCaseFromFile( const std::string & testCaseFilename );
+		/// Loads a compiled test case produced by TestCaseBinaryWriter; the file is memory mapped and no XML parsing or random placement is performed.
+		void readTestCaseFromBinaryFile( const std::string & testCaseFilename );
+		/// Returns true if the specified filename seems to be a valid compiled test case.
+		static bool isAValidBinaryTestCase( const std::string & testCaseFilename );
+		/// Loads a MovingAI .map file as a test case with no agents; the whole map becomes one GridMapObstacle and the world bounds are the bounds of the map.
+		void readTestCaseFromMovingAIMap( const std::string & mapFilename );
 
 		/// @name General queries about the test case
 		//@{
@@ -100,6 +108,26 @@ namespace SteerLib {
 		//@}
 	};
 
+	/**
+	 * @brief The public interface for compiling a SteerSuite XML test case into a binary test case.
+	 *
+	 * The compiled test case contains the initial conditions exactly as TestCaseReader resolved them from the XML
+	 * test case, including expanded regions and randomly placed agents and obstacles.  It can be loaded much faster
+	 * with TestCaseReader::readTestCaseFromBinaryFile(), which is also used automatically by
+	 * TestCaseReader::readTestCaseFromFile() when it is given a compiled test case.
+	 *
+	 * The XML test case remains the source of truth; recompile after editing it.
+	 *
+	 * @see
+	 *  - TestCaseIOPrivate.h for a description of the file layout.
+	 */
+	class STEERLIB_API TestCaseBinaryWriter {
+	public:
+		TestCaseBinaryWriter() { }
+		/// Writes the initial conditions held by testCase into a compiled test case; sourceFilename is stored only for reference.
+		void writeBinaryTestCase( const std::string & filename, TestCaseReader & testCase, const std::string & sourceFilename = "" );
+	};
+
     /**
      * @brief The public interface for writing the current scenario as a SteerSuite XML test case.
      *
@@ -302,6 +302,201 @@ namespace SteerLib {
 
 
 
+	//
+	// ---------------------------------
+	// Compiled (binary) test cases
+	//
+	// A compiled test case stores the fully initialized conditions of an XML test case, i.e. after agent and
+	// obstacle regions have been expanded and random positions have been resolved.  Loading a compiled test
+	// case is therefore a matter of memory mapping the file and copying the fixed-size records, with no XML
+	// parsing and no random placement.  The XML test case remains the source of truth; compiled files are
+	// produced from it with TestCaseBinaryWriter (or "steertool -compile").
+	//
+	// internally, it stores these sections, each aligned to 8 bytes:
+	//  - header
+	//  - list of camera views
+	//  - list of agents, followed by the list of agent emitters
+	//  - list of goals, referenced by agents as a range
+	//  - list of behaviour parameters, referenced by goals as a range
+	//  - list of obstacles
+	//  - list of polygon vertices, referenced by polygon obstacles as a range
+	//  - list of 32-bit words with the blocked cells of grid map obstacles, referenced by grid map obstacles as a range
+	//  - string table; all strings are referenced by their byte offset into this table.
+	//
+	// ---------------------------------
+	//
+
+	/// The "magic number" placed at the beginning of every compiled test case; used to identify compiled test cases and to check big-endian/little-endian issues.
+	const unsigned int TESTCASE_BINARY_MAGIC_NUMBER = 0x5e7b7ca5;
+	/// The current version of the compiled test case format.
+	const unsigned int TESTCASE_BINARY_VERSION = 2;
+	/// The file extension used for compiled test cases.
+	const char * const TESTCASE_BINARY_EXTENSION = ".tcbin";
+
+	/**
+	 * @brief The header data contained in the very beginning of a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryHeader {
+		/// A unique number to help identify a compiled test case, and to detect big-endian/little-endian issues.
+		unsigned int magic;
+		/// Integer number representing the version of the compiled test case.
+		unsigned int version;
+		/// Size in bytes of this data structure.
+		unsigned int headerSize;
+		/// Size in bytes of the entire file, used to validate the file before reading it.
+		unsigned int fileSize;
+
+		unsigned int numCameraViews;
+		unsigned int numAgents;
+		unsigned int numAgentEmitters;
+		unsigned int numGoals;
+		unsigned int numBehaviourParameters;
+		unsigned int numObstacles;
+		unsigned int numVertices;
+		unsigned int numGridMapWords;
+		unsigned int stringTableSize;
+
+		/// @name Offsets in bytes from the beginning of the file, where each section is located.
+		//@{
+		unsigned int cameraListOffset;
+		unsigned int agentListOffset;
+		unsigned int agentEmitterListOffset;
+		unsigned int goalListOffset;
+		unsigned int behaviourParameterListOffset;
+		unsigned int obstacleListOffset;
+		unsigned int vertexListOffset;
+		unsigned int gridMapWordListOffset;
+		unsigned int stringTableOffset;
+		//@}
+
+		/// @name Contents of the XML test case header, strings are offsets into the string table.
+		//@{
+		unsigned int nameString;
+		unsigned int descriptionString;
+		unsigned int versionString;
+		unsigned int passingCriteriaString;
+		/// The XML file this test case was compiled from.
+		unsigned int sourceFilenameString;
+		float worldBounds[6];
+		//@}
+	};
+
+	/**
+	 * @brief A camera view record in a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryCameraInfo {
+		float position[3];
+		float lookat[3];
+		float up[3];
+		float fovy;
+	};
+
+	/**
+	 * @brief An agent (or agent emitter) record in a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryAgentInfo {
+		unsigned int nameString;
+		float position[3];
+		float direction[3];
+		float radius;
+		float speed;
+		float color[3];
+		unsigned int colorSet;
+		unsigned int fromRandom;
+		float randBox[6];
+		/// Index of the first goal of this agent in the goal list.
+		unsigned int firstGoal;
+		unsigned int numGoals;
+	};
+
+	/**
+	 * @brief A goal record in a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryGoalInfo {
+		unsigned int goalType;
+		unsigned int targetIsRandom;
+		float timeDuration;
+		float desiredSpeed;
+		float targetLocation[3];
+		float targetDirection[3];
+		float targetRegion[6];
+		unsigned int targetNameString;
+		unsigned int flowTypeString;
+		unsigned int steeringAlgString;
+		/// Index of the first behaviour parameter of this goal in the behaviour parameter list.
+		unsigned int firstBehaviourParameter;
+		unsigned int numBehaviourParameters;
+	};
+
+	/**
+	 * @brief A key/value behaviour parameter record in a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryBehaviourParameter {
+		unsigned int keyString;
+		unsigned int valueString;
+	};
+
+	/// Identifies which ObstacleInitialConditions type a compiled obstacle record describes.
+	enum TestCaseBinaryObstacleTypeEnum {
+		TESTCASE_BINARY_BOX_OBSTACLE,
+		TESTCASE_BINARY_CIRCLE_OBSTACLE,
+		TESTCASE_BINARY_ORIENTED_BOX_OBSTACLE,
+		TESTCASE_BINARY_ORIENTED_WALL_OBSTACLE,
+		TESTCASE_BINARY_POLYGON_OBSTACLE,
+		TESTCASE_BINARY_GRID_MAP_OBSTACLE
+	};
+
+	/**
+	 * @brief An obstacle record in a compiled test case; only the fields relevant to obstacleType are valid.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryObstacleInfo {
+		double doorLocation;
+		double doorRadius;
+		unsigned int obstacleType;
+		/// xmin, xmax, ymin, ymax, zmin, zmax of a box obstacle.
+		float bounds[6];
+		float position[3];
+		float radius;
+		float height;
+		float lengthX;
+		float lengthZ;
+		float thetaY;
+		/// Index of the first vertex of a polygon obstacle in the vertex list.
+		unsigned int firstVertex;
+		unsigned int numVertices;
+		/// @name The cells of a grid map obstacle, whose corner is at position.
+		/// @brief Bit (x & 31) of word (z * ((numCellsX + 31) / 32) + x / 32) is set if cell (x,z) is blocked; the words start at firstGridMapWord in the grid map word list.
+		//@{
+		float cellSize;
+		unsigned int numCellsX;
+		unsigned int numCellsZ;
+		float traversalCost;
+		unsigned int firstGridMapWord;
+		//@}
+	};
+
+	/**
+	 * @brief A polygon vertex record in a compiled test case.
+	 *
+	 * <b>This struct is used for file IO, so do not reorder items.</b>
+	 */
+	struct TestCaseBinaryVertexData {
+		float x, y, z;
+	};
+
+
 	/**
 	 * @brief Private data for the TestCaseReader public interface
 	 *
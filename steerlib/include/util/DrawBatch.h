@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __UTIL_DRAW_BATCH_H__
+#define __UTIL_DRAW_BATCH_H__
+
+/// @file DrawBatch.h
+/// @brief Declares Util::ViewFrustum and Util::DrawBatch, which draw large crowds with a few openGL calls.
+
+#ifdef ENABLE_GUI
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+#include <vector>
+#include "util/DrawLib.h"
+
+namespace Util {
+
+	/**
+	 * @brief The six planes of the current openGL view volume, used to skip geometry that cannot be seen.
+	 *
+	 * The planes are extracted from the product of the projection and modelview matrices, so the frustum is the one
+	 * of whatever camera (or stereo eye) was applied last.
+	 */
+	class UTIL_API ViewFrustum {
+	public:
+		/// Extracts the frustum from the current openGL matrices; call it after the camera is applied.
+		void extractFromCurrentView();
+		/// Returns false only if the sphere is entirely outside the frustum.
+		bool intersectsSphere(const Point & center, float radius) const;
+		/// Returns false only if the box is entirely outside the frustum.
+		bool intersectsBox(const AxisAlignedBox & box) const;
+
+	protected:
+		/// a*x + b*y + c*z + d >= 0 inside each plane.
+		float _planes[6][4];
+	};
+
+
+	/**
+	 * @brief Collects agent discs and goal flags, and draws all of them with a single glDrawElements() call.
+	 *
+	 * Drawing each agent with DrawLib::drawAgentDisc() costs a display list call and several matrix operations per agent,
+	 * which becomes the bottleneck long before the geometry does, especially on software openGL.  Instead, a batch
+	 * transforms a low-detail copy of the same shapes into one vertex array on the CPU, skipping the shapes that are
+	 * outside the view frustum.  Only openGL 1.1 vertex arrays are used.
+	 *
+	 * The batch keeps its arrays between frames, so after the first few frames clear() and draw() do not allocate memory.
+	 */
+	class UTIL_API DrawBatch {
+	public:
+		DrawBatch() : _numShapesDrawn(0) { }
+
+		/// Removes all shapes, keeping the memory for the next frame.
+		void clear() { _agentDiscs.clear();  _flags.clear(); }
+		/// Adds a disc like DrawLib::drawAgentDisc(pos, dir, radius, color).
+		void addAgentDisc(const Point & pos, const Vector & dir, float radius, const Color & color);
+		/// Adds a flag like DrawLib::drawFlag(loc, color, scale).
+		void addFlag(const Point & loc, const Color & color, float scale = 1.0f);
+
+		/// Draws all the shapes that intersect the frustum.
+		void draw(const ViewFrustum & frustum);
+
+		/// Returns the number of shapes that were inside the frustum during the last draw().
+		unsigned int getNumShapesDrawn() const { return _numShapesDrawn; }
+
+	protected:
+		struct Shape {
+			Point position;
+			float cosAngle, sinAngle;
+			float radius;
+			Color color;
+		};
+
+		void _addShapes(const std::vector<Shape> & shapes, bool isAgentDisc, const ViewFrustum & frustum);
+
+		std::vector<Shape> _agentDiscs;
+		std::vector<Shape> _flags;
+
+		std::vector<float> _vertices;
+		std::vector<float> _normals;
+		std::vector<unsigned char> _colors;
+		std::vector<GLuint> _indices;
+		unsigned int _numShapesDrawn;
+	};
+
+} // end namespace Util
+
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif // ifdef ENABLE_GUI
+
+#endif
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+#ifndef __FIXED_MATRIX_H__
+#define __FIXED_MATRIX_H__
+
+/// @file FixedMatrix.h
+/// @brief Declares FixedMatrix, a matrix whose size is known at compile time and whose elements are stored by value.
+
+#include "util/dmatrix.h"
+
+/**
+ * @brief A matrix with a compile-time size, stored by value.
+ *
+ * Matrix allocates its elements on the heap, so every temporary in an expression such as
+ * <i>SVec * SVal * sample + mean</i> is a new and delete.  FixedMatrix keeps its elements inside
+ * the object, so creating, copying and returning one never allocates, and mismatched sizes are
+ * compile errors instead of asserts.  It is meant for the small matrices whose size does not
+ * depend on the input, such as the per-agent state and noise in the Bayesian filters.
+ *
+ * The operators compute the same values in the same order as those of Matrix, so code moved
+ * from Matrix to FixedMatrix gives the same results.  Like Matrix, a default-constructed
+ * FixedMatrix is not initialized; use zeros() or identity().
+ */
+template <size_t numRows_, size_t numColumns_>
+class FixedMatrix {
+
+private:
+  double _elems[numRows_ * numColumns_];
+
+public:
+  // constructors
+  inline FixedMatrix() { }
+
+  // copy of a Matrix of the same size
+  explicit inline FixedMatrix(const Matrix& q) {
+    assert(q.numRows() == numRows_ && q.numColumns() == numColumns_);
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] = q[i];
+    }
+  }
+
+  static inline FixedMatrix zeros() {
+    FixedMatrix m;
+    m.reset();
+    return m;
+  }
+
+  static inline FixedMatrix identity() {
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_; ++i) {
+      for (size_t j = 0; j < numColumns_; ++j) {
+        m(i, j) = (i == j ? double(1) : double(0));
+      }
+    }
+    return m;
+  }
+
+  // copy of the block of q that starts at (row, column)
+  static inline FixedMatrix subMatrixOf(const Matrix& q, size_t row, size_t column) {
+    assert(row + numRows_ <= q.numRows() && column + numColumns_ <= q.numColumns());
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_; ++i) {
+      for (size_t j = 0; j < numColumns_; ++j) {
+        m(i, j) = q(row + i, column + j);
+      }
+    }
+    return m;
+  }
+
+  // conversion back to a (heap allocated) Matrix
+  inline Matrix toMatrix() const {
+    Matrix m(numRows_, numColumns_);
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      m[i] = _elems[i];
+    }
+    return m;
+  }
+
+  // Retrieval
+  static inline size_t numRows() {
+    return numRows_;
+  }
+  static inline size_t numColumns() {
+    return numColumns_;
+  }
+
+  // Subscript operator
+  inline double& operator () (size_t row, size_t column) {
+    assert(row < numRows_ && column < numColumns_);
+    return _elems[row * numColumns_ + column];
+  }
+  inline double  operator () (size_t row, size_t column) const {
+    assert(row < numRows_ && column < numColumns_);
+    return _elems[row * numColumns_ + column];
+  }
+
+  inline double& operator [] (size_t elt) {
+    assert(elt < numRows_ * numColumns_);
+    return _elems[elt];
+  }
+  inline double  operator [] (size_t elt) const {
+    assert(elt < numRows_ * numColumns_);
+    return _elems[elt];
+  }
+
+  // Reset to zeros
+  inline void reset() {
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] = double(0);
+    }
+  }
+
+  // Matrix addition
+  inline FixedMatrix operator+(const FixedMatrix& q) const {
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      m._elems[i] = _elems[i] + q._elems[i];
+    }
+    return m;
+  }
+  inline const FixedMatrix& operator+=(const FixedMatrix& q) {
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] += q._elems[i];
+    }
+    return *this;
+  }
+
+  // Matrix subtraction
+  inline FixedMatrix operator-(const FixedMatrix& q) const {
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      m._elems[i] = _elems[i] - q._elems[i];
+    }
+    return m;
+  }
+  inline const FixedMatrix& operator-=(const FixedMatrix& q) {
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] -= q._elems[i];
+    }
+    return *this;
+  }
+
+  // Scalar multiplication
+  inline FixedMatrix operator*(double a) const {
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      m._elems[i] = _elems[i] * a;
+    }
+    return m;
+  }
+  inline const FixedMatrix& operator*=(double a) {
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] *= a;
+    }
+    return *this;
+  }
+
+  // Scalar division
+  inline FixedMatrix operator/(double a) const {
+    FixedMatrix m;
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      m._elems[i] = _elems[i] / a;
+    }
+    return m;
+  }
+  inline const FixedMatrix& operator/=(double a) {
+    for (size_t i = 0; i < numRows_ * numColumns_; ++i) {
+      _elems[i] /= a;
+    }
+    return *this;
+  }
+
+  // Matrix multiplication
+  template <size_t numColumnsQ>
+  inline FixedMatrix<numRows_, numColumnsQ> operator*(const FixedMatrix<numColumns_, numColumnsQ>& q) const {
+    FixedMatrix<numRows_, numColumnsQ> m;
+    multiply(*this, q, m);
+    return m;
+  }
+
+  // Matrix transpose
+  inline FixedMatrix<numColumns_, numRows_> operator~() const {
+    FixedMatrix<numColumns_, numRows_> m;
+    for (size_t i = 0; i < numColumns_; ++i) {
+      for (size_t j = 0; j < numRows_; ++j) {
+        m(i, j) = (*this)(j, i);
+      }
+    }
+    return m;
+  }
+
+};
+
+template <size_t numRows_, size_t numColumns_>
+inline FixedMatrix<numRows_, numColumns_> operator*(double a, const FixedMatrix<numRows_, numColumns_>& q) { return q*a; }
+
+// result = a*b; result must not be a or b
+template <size_t numRows_, size_t numInner_, size_t numColumns_>
+inline void multiply(const FixedMatrix<numRows_, numInner_>& a, const FixedMatrix<numInner_, numColumns_>& b, FixedMatrix<numRows_, numColumns_>& result) {
+  for (size_t i = 0; i < numRows_; ++i) {
+    for (size_t j = 0; j < numColumns_; ++j) {
+      double temp = double(0);
+      for (size_t k = 0; k < numInner_; ++k) {
+        temp += a(i, k) * b(k, j);
+      }
+      result(i, j) = temp;
+    }
+  }
+}
+
+// m += a*~b, for column vectors a and b
+template <size_t numRows_, size_t numColumns_>
+inline void addOuterProduct(FixedMatrix<numRows_, numColumns_>& m, const FixedMatrix<numRows_, 1>& a, const FixedMatrix<numColumns_, 1>& b) {
+  for (size_t i = 0; i < numRows_; ++i) {
+    for (size_t j = 0; j < numColumns_; ++j) {
+      m(i, j) += a[i] * b[j];
+    }
+  }
+}
+
+// Eigen decomposition of a symmetric matrix, the same as jacobi() for a Matrix
+template <size_t size_>
+inline void jacobi(const FixedMatrix<size_, size_>& q, FixedMatrix<size_, size_>& V, FixedMatrix<size_, size_>& D) {
+  D = q;
+  V = FixedMatrix<size_, size_>::identity();
+  jacobiRotate(V, D, size_);
+}
+
+template <size_t numRows_, size_t numColumns_>
+inline std::ostream& operator<<(std::ostream& os, const FixedMatrix<numRows_, numColumns_>& q) {
+  for (size_t i = 0; i < numRows_; ++i) {
+    for (size_t j = 0; j < numColumns_; ++j) {
+      os << q(i,j) << "\t";
+    }
+    os << std::endl;
+  }
+  return os;
+}
+
+#endif
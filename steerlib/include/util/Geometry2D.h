@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __UTIL_GEOMETRY_2D_H__
+#define __UTIL_GEOMETRY_2D_H__
+
+/// @file Geometry2D.h
+/// @brief Declares packed 2D vector types for the XZ plane, and batch versions of common geometry functions.
+
+#include <stddef.h>
+#include <vector>
+#include "Globals.h"
+#include "util/Geometry.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace Util {
+
+	/**
+	 * @brief A packed 2D vector in the XZ plane.
+	 *
+	 * Almost all of the simulation happens on the ground plane, but Vector and Point always carry a y component that
+	 * is computed and then ignored.  Vector2D stores only x and z, so it is half the size of a Vector and has no
+	 * wasted arithmetic.  It converts to and from Vector and Point explicitly, dropping (or zeroing) the y component.
+	 *
+	 * The operators follow the same arithmetic as Vector, including the reciprocal in operator/(), so code that is
+	 * moved from Vector to Vector2D gives the same results as before, as long as y was zero.
+	 *
+	 * @see
+	 *  - Vector2DArray and the batch functions below, for processing many vectors at once.
+	 */
+	class UTIL_API Vector2D {
+	public:
+		float x, z;
+		Vector2D() : x(0.0f), z(0.0f) { }
+		Vector2D(float newx, float newz) : x(newx), z(newz) { }
+		explicit Vector2D(const Vector & vec) : x(vec.x), z(vec.z) { }
+		explicit Vector2D(const Point & pt) : x(pt.x), z(pt.z) { }
+
+		/// Returns the 3D vector with y set to zero.
+		Vector vector() const { return Vector(x, 0.0f, z); }
+		/// Returns the 3D point with y set to zero.
+		Point point() const { return Point(x, 0.0f, z); }
+
+		void zero() { x = 0.0f; z = 0.0f; }
+
+		float lengthSquared() const { return x*x + z*z; }
+		float length() const { return sqrtf(x*x + z*z); }
+		Vector2D operator-() const { return Vector2D(-x, -z); }
+
+		Vector2D operator+(const Vector2D &vec) const { return Vector2D(x + vec.x, z + vec.z); }
+		void operator+=(const Vector2D &vec) { x += vec.x; z += vec.z; }
+		Vector2D operator-(const Vector2D &vec) const { return Vector2D(x - vec.x, z - vec.z); }
+		void operator-=(const Vector2D &vec) { x -= vec.x; z -= vec.z; }
+		Vector2D operator*(float c) const { return Vector2D(c*x, c*z); }
+		void operator*=(float c) { x *= c; z *= c; }
+		Vector2D operator/(float c) const { float cInverse = 1.0f / c; return Vector2D(cInverse*x, cInverse*z); }
+		void operator/=(float c) { float cInverse = 1.0f / c; (*this) *= cInverse; }
+
+		bool operator==(const Vector2D &vec) const { return ((x == vec.x) && (z == vec.z)); }
+		bool operator!=(const Vector2D &vec) const { return ((x != vec.x) || (z != vec.z)); }
+	};
+
+	static inline std::ostream &operator<<(std::ostream &out, const Vector2D &vec) { out << "(" << vec.x << "," << vec.z << ")"; return out; }
+
+	static inline Vector2D operator*(float c, const Vector2D &vec) { return Vector2D(c*vec.x, c*vec.z); }
+
+	static inline float dot(const Vector2D &vec1, const Vector2D &vec2) { return vec1.x * vec2.x + vec1.z * vec2.z; }
+
+	static inline Vector2D normalize(const Vector2D &vec) { float lengthInv = 1.0f / sqrtf(vec.x*vec.x + vec.z*vec.z);  return Vector2D(lengthInv * vec.x, lengthInv * vec.z); }
+
+	/// Same as rightSideInXZPlane(const Vector &), for a Vector2D.
+	static inline Vector2D rightSideInXZPlane(const Vector2D & vec) { return Vector2D(-vec.z, vec.x); }
+
+	/// Returns true if the two 2D circles overlap, false if they do not.
+	static inline bool circleOverlapsCircle2D(const Vector2D & c1, float r1, const Vector2D & c2, float r2)
+	{
+		float distSquared = (c2-c1).lengthSquared();
+		float distThreshold = (r1+r2);
+		return (distSquared < distThreshold*distThreshold);
+	}
+
+
+	/**
+	 * @brief Many Vector2D values stored as a structure of arrays.
+	 *
+	 * The x and z components are kept in two separate contiguous arrays, which is the layout the batch functions
+	 * below work on; getX() and getZ() give direct access to the arrays.
+	 */
+	class UTIL_API Vector2DArray {
+	public:
+		void clear() { _x.clear(); _z.clear(); }
+		void resize(size_t n) { _x.resize(n); _z.resize(n); }
+		void reserve(size_t n) { _x.reserve(n); _z.reserve(n); }
+		size_t size() const { return _x.size(); }
+
+		void push_back(const Vector2D & vec) { _x.push_back(vec.x); _z.push_back(vec.z); }
+		Vector2D get(size_t i) const { return Vector2D(_x[i], _z[i]); }
+		void set(size_t i, const Vector2D & vec) { _x[i] = vec.x; _z[i] = vec.z; }
+
+		float * getX() { return _x.empty() ? NULL : &_x[0]; }
+		float * getZ() { return _z.empty() ? NULL : &_z[0]; }
+		const float * getX() const { return _x.empty() ? NULL : &_x[0]; }
+		const float * getZ() const { return _z.empty() ? NULL : &_z[0]; }
+
+	protected:
+		std::vector<float> _x;
+		std::vector<float> _z;
+	};
+
+
+	/// @name Batch geometry functions
+	/// These process n vectors given as separate x and z arrays.  They use SSE where it is available, and give exactly
+	/// the same results as the single-vector functions above either way.  Output arrays may be the same as input arrays.
+	//@{
+	/// Normalizes each vector; like normalize(), a zero-length vector does not give a meaningful result.
+	void UTIL_API normalize2D(const float * x, const float * z, float * outX, float * outZ, size_t n);
+	/// Computes the dot product of each pair of vectors.
+	void UTIL_API dot2D(const float * x1, const float * z1, const float * x2, const float * z2, float * out, size_t n);
+	/// Computes the length of each vector.
+	void UTIL_API length2D(const float * x, const float * z, float * out, size_t n);
+	/// Computes rightSideInXZPlane() of each vector.
+	void UTIL_API rightSideInXZPlane2D(const float * x, const float * z, float * outX, float * outZ, size_t n);
+	/// Tests one circle against n circles, setting overlaps[i] to 1 if circle i overlaps it and 0 otherwise; returns the number of overlapping circles.
+	size_t UTIL_API circleOverlapsCircle2D(const Vector2D & center, float radius, const float * x, const float * z, const float * radii, unsigned char * overlaps, size_t n);
+
+	static inline void normalize2D(Vector2DArray & vecs) { normalize2D(vecs.getX(), vecs.getZ(), vecs.getX(), vecs.getZ(), vecs.size()); }
+	static inline void length2D(const Vector2DArray & vecs, float * out) { length2D(vecs.getX(), vecs.getZ(), out, vecs.size()); }
+	//@}
+
+} // end namespace Util
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
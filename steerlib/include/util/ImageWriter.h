@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __UTIL_IMAGE_WRITER_H__
+#define __UTIL_IMAGE_WRITER_H__
+
+/// @file ImageWriter.h
+/// @brief Declares functions that write 8-bit RGB images to PNG and PPM files.
+
+#include <string>
+#include "Globals.h"
+
+namespace Util {
+
+	/**
+	 * @brief Writes an 8-bit RGB image to a PNG file, compressed with zlib if SteerLib was built with it.
+	 *
+	 * The pixels are tightly packed, 3 bytes per pixel.  If bottomRowFirst is true, the rows are stored from the bottom
+	 * of the image up, which is the order given by glReadPixels().  compressionLevel goes from 1 (fastest) to 9
+	 * (smallest files).  Without zlib (ENABLE_ZLIB not defined), the image data is stored uncompressed, which any PNG
+	 * reader accepts, and compressionLevel is ignored.  Throws a Util::GenericException if the file cannot be written.
+	 */
+	UTIL_API void writePNG(const std::string & filename, unsigned int width, unsigned int height, const unsigned char * rgbPixels, bool bottomRowFirst, int compressionLevel = 1);
+
+	/// Writes an 8-bit RGB image to a raw (P6) PPM file; the pixel layout is the same as writePNG().
+	UTIL_API void writePPM(const std::string & filename, unsigned int width, unsigned int height, const unsigned char * rgbPixels, bool bottomRowFirst);
+
+} // end namespace Util
+
+#endif
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __UTIL_PHASE_SCHEDULER_H__
+#define __UTIL_PHASE_SCHEDULER_H__
+
+/// @file PhaseScheduler.h
+/// @brief Declares the Util::PhaseScheduler class, which spreads periodic per-agent work evenly across frames.
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Globals.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+namespace Util {
+
+	/**
+	 * @brief Spreads the periodic phases of many clients (usually agents) evenly across frames.
+	 *
+	 * AI modules often run a phase (e.g. planning or perception) once every N frames for each agent.  If all agents
+	 * start at the same frame, they all run that phase in the same frames, and the frame time spikes every N frames.
+	 * This class removes those spikes in two ways:
+	 *   - getStaggerDelay() hands out a different delay (0 to N-1 frames) to each client, round-robin; a client delays
+	 *     the second run of the phase by that much, so that from then on the clients are spread evenly over the interval.
+	 *   - requestExecution() enforces a per-frame budget for each phase: once the budget is used up in a frame,
+	 *     further requests are deferred, and the client should try again in the next frame.
+	 *
+	 * The budget is counted in phase executions, not in time, so the schedule is deterministic.  The budget of a phase is
+	 * ceil(budgetFactor * numClients / interval), i.e. budgetFactor times the average number of executions per frame;
+	 * a budget factor of 0 disables the budget.  Phases with an interval of 1 frame are never deferred as long as the
+	 * budget factor is at least 1, and requests marked as mandatory (e.g. the very first run) are never deferred.
+	 *
+	 * Call beginFrame() once before the clients of each frame are updated; the per-frame counters can be read after
+	 * the frame, and displayStatistics() summarizes the counters of the whole simulation.
+	 */
+	class UTIL_API PhaseScheduler
+	{
+	public:
+		PhaseScheduler();
+		/// Removes all phases.
+		void clear();
+		/// Adds a phase that runs once every interval frames for each client, and returns the index of the phase.
+		unsigned int addPhase(const std::string & name, unsigned int interval);
+		/// Sets the budget factor; 0 disables the per-frame budget.
+		void setBudgetFactor(float budgetFactor);
+		/// Sets the number of clients that run the phases; the per-frame budgets are proportional to this number.
+		void setNumClients(unsigned int numClients);
+		/// Resets the per-frame counters; call once at the beginning of every frame.
+		void beginFrame();
+		/// Resets all counters and the round-robin stagger of every phase.
+		void resetStatistics();
+
+		/// Returns the number of frames (less than the phase's interval) that a new client should delay its second run of the phase.
+		unsigned int getStaggerDelay(unsigned int phase);
+		/// Returns true if the client may run the phase in this frame; if false, the client should try again next frame.
+		bool requestExecution(unsigned int phase, bool mandatory);
+		/**
+		 * @brief Returns true if a client may run a phase that is due in this frame, and updates the client's schedule of that phase.
+		 *
+		 * phaseHasRun and staggerDelay are the client's own state of the phase; initialize them to false and
+		 * getStaggerDelay(phase).  The first run is mandatory, because the client has no previous result to fall back on;
+		 * after the second run, staggerDelay is set to 0, so the client uses the usual interval from then on.
+		 */
+		bool beginScheduledPhase(unsigned int phase, bool & phaseHasRun, unsigned int & staggerDelay);
+
+		/// @name Counters
+		//@{
+		unsigned int getNumPhases() const { return (unsigned int)_phases.size(); }
+		const std::string & getPhaseName(unsigned int phase) const { return _phases[phase].name; }
+		unsigned int getPhaseInterval(unsigned int phase) const { return _phases[phase].interval; }
+		/// Returns the max number of executions of the phase per frame, or 0 if there is no budget.
+		unsigned int getPhaseBudget(unsigned int phase) const { return _phases[phase].budget; }
+		unsigned int getNumExecutedThisFrame(unsigned int phase) const { return _phases[phase].numExecutedThisFrame; }
+		unsigned int getNumDeferredThisFrame(unsigned int phase) const { return _phases[phase].numDeferredThisFrame; }
+		/// Returns the max number of executions of the phase in one frame, not counting mandatory executions.
+		unsigned int getMaxExecutedInOneFrame(unsigned int phase) const { return _phases[phase].maxExecutedInOneFrame; }
+		long long getTotalExecuted(unsigned int phase) const { return _phases[phase].totalExecuted; }
+		long long getTotalMandatory(unsigned int phase) const { return _phases[phase].totalMandatory; }
+		long long getTotalDeferred(unsigned int phase) const { return _phases[phase].totalDeferred; }
+		long long getNumFrames() const { return _numFrames; }
+		//@}
+
+		/// @name Stagger state, so that modules can save and restore the schedule with a simulation snapshot.
+		//@{
+		unsigned int getStaggerCounter(unsigned int phase) const { return _phases[phase].staggerCounter; }
+		void setStaggerCounter(unsigned int phase, unsigned int staggerCounter) { _phases[phase].staggerCounter = staggerCounter; }
+		//@}
+
+		/// Outputs a human-readable form of the counters.
+		void displayStatistics(std::ostream & out) const;
+
+	protected:
+		struct Phase {
+			std::string name;
+			unsigned int interval;
+			unsigned int budget;
+			unsigned int staggerCounter;
+			unsigned int numExecutedThisFrame;
+			unsigned int numDeferredThisFrame;
+			unsigned int numMandatoryThisFrame;
+			unsigned int maxExecutedInOneFrame;
+			long long totalExecuted;
+			long long totalMandatory;
+			long long totalDeferred;
+		};
+
+		void _updateBudgets();
+
+		std::vector<Phase> _phases;
+		float _budgetFactor;
+		unsigned int _numClients;
+		long long _numFrames;
+	};
+
+} // end namespace Util
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __UTIL_RASTER_IMAGE_H__
+#define __UTIL_RASTER_IMAGE_H__
+
+/// @file RasterImage.h
+/// @brief Declares Util::RasterImage, an RGB image that top-down views of the world can be drawn into without openGL.
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+#include <string>
+#include <vector>
+#include "Globals.h"
+#include "util/Geometry.h"
+#include "util/Color.h"
+
+namespace Util {
+
+	/**
+	 * @brief An 8-bit RGB image with a few anti-aliased drawing primitives in world coordinates, seen from above.
+	 *
+	 * The drawing functions take points on the ground plane; the y coordinate is ignored.  setWorldBounds() chooses
+	 * the part of the world that is shown: +x points to the right of the image and +z points down, which matches
+	 * the default camera of the GUI.  Shapes are blended with a coverage estimate at their edges, so that small
+	 * agents still look round in thumbnails.
+	 *
+	 * Nothing in this class uses openGL, so it works on machines without a display or GPU.  Each instance may be used
+	 * by one thread at a time.
+	 */
+	class UTIL_API RasterImage {
+	public:
+		RasterImage(unsigned int width, unsigned int height);
+
+		unsigned int getWidth() const { return _width; }
+		unsigned int getHeight() const { return _height; }
+		/// Returns the pixels, 3 bytes per pixel, top row first.
+		const unsigned char * getPixels() const { return &_pixels[0]; }
+
+		/// Shows the rectangle xmin..xmax, zmin..zmax centered in the image, as large as possible without changing its aspect ratio.
+		void setWorldBounds(float xmin, float xmax, float zmin, float zmax);
+		/// Returns the number of pixels per world unit chosen by setWorldBounds().
+		float getPixelsPerUnit() const { return _scale; }
+
+		void clear(const Color & color);
+		void fillBox(float xmin, float xmax, float zmin, float zmax, const Color & color);
+		void fillDisc(const Point & center, float radius, const Color & color);
+		/// Draws a line segment with round ends; the width is in pixels, so that lines stay visible at any scale.
+		void drawLine(const Point & a, const Point & b, float widthInPixels, const Color & color);
+
+		/// Writes the image to a PNG file; see Util::writePNG().
+		void writePNG(const std::string & filename, int compressionLevel = 6) const;
+
+	protected:
+		/// Blends the color into the pixel, with a coverage from 0 (no change) to 1 (replaced).
+		inline void _blend(unsigned int x, unsigned int y, const unsigned char rgb[3], float coverage);
+		/// Clips a pixel-space bounding box to the image; returns false if nothing is left.
+		bool _clip(float xmin, float xmax, float ymin, float ymax, int & x0, int & x1, int & y0, int & y1) const;
+
+		unsigned int _width, _height;
+		std::vector<unsigned char> _pixels;
+		/// Pixel coordinates are (x * _scale + _offsetX, z * _scale + _offsetY).
+		float _scale, _offsetX, _offsetY;
+	};
+
+} // end namespace Util
+
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -73,6 +73,16 @@ public:
       }
     }
 
+  // move constructor; q is left empty
+  inline Matrix(Matrix&& q) {
+    _numRows = q._numRows;
+    _numColumns = q._numColumns;
+    _elems = q._elems;
+    q._numRows = 0;
+    q._numColumns = 0;
+    q._elems = 0;
+  }
+
   // destructor
   inline ~Matrix() { 
     delete[] _elems;
@@ -92,6 +102,20 @@ public:
     return (*this);
   }
 
+  // move assignment; takes over the elements of q, which is left empty
+  Matrix& operator = (Matrix&& q) {
+    if (this != &q) {
+      delete[] _elems;
+      _numRows = q._numRows;
+      _numColumns = q._numColumns;
+      _elems = q._elems;
+      q._numRows = 0;
+      q._numColumns = 0;
+      q._elems = 0;
+    }
+    return (*this);
+  }
+
   // Retrieval
   inline size_t numRows() const { 
     return _numRows; 
@@ -423,6 +447,45 @@ inline Matrix zeros(size_t numRows) {
   return m;
 }
 
+// In-place operations. These write into a matrix of the right size instead of returning
+// a new one, so loops that use them do not allocate; they compute exactly the same values
+// as the corresponding operators.
+
+// result = a - b
+inline void subtract(const Matrix& a, const Matrix& b, Matrix& result) {
+  assert(a.numRows() == b.numRows() && a.numColumns() == b.numColumns());
+  assert(result.numRows() == a.numRows() && result.numColumns() == a.numColumns());
+  for (size_t i = 0; i < a.numRows() * a.numColumns(); ++i) {
+    result[i] = a[i] - b[i];
+  }
+}
+
+// m += a*~b, for column vectors a and b
+inline void addOuterProduct(Matrix& m, const Matrix& a, const Matrix& b) {
+  assert(a.numColumns() == 1 && b.numColumns() == 1);
+  assert(m.numRows() == a.numRows() && m.numColumns() == b.numRows());
+  for (size_t i = 0; i < a.numRows(); ++i) {
+    for (size_t j = 0; j < b.numRows(); ++j) {
+      m(i, j) += a[i] * b[j];
+    }
+  }
+}
+
+// m += a*b
+inline void multiplyAdd(Matrix& m, const Matrix& a, const Matrix& b) {
+  assert(a.numColumns() == b.numRows());
+  assert(m.numRows() == a.numRows() && m.numColumns() == b.numColumns());
+  for (size_t i = 0; i < a.numRows(); ++i) {
+    for (size_t j = 0; j < b.numColumns(); ++j) {
+      double temp = double(0);
+      for (size_t k = 0; k < a.numColumns(); ++k) {
+        temp += a(i, k) * b(k, j);
+      }
+      m(i, j) += temp;
+    }
+  }
+}
+
 // Matrix inverse
 inline Matrix operator!(const Matrix& q) {
   assert(q.numRows() == q.numColumns());
@@ -722,12 +785,11 @@ inline Matrix pseudoInverse(const Matrix& q) {
   return ~C*(((~B*B)*(C*~C))%~B);
 }
 
-inline void jacobi(const Matrix& q, Matrix& V, Matrix& D) {
-  assert(q.numRows() == q.numColumns());
-  size_t _size = q.numRows();
-  D = q;
-  V = m_identity(_size);
-  
+// Diagonalizes the symmetric matrix D in place with Jacobi rotations, accumulating the
+// rotations into V (which is usually the identity on entry). Works for any matrix type
+// with operator()(row, column), so that Matrix and FixedMatrix share the same code.
+template <class MatrixType>
+inline void jacobiRotate(MatrixType& V, MatrixType& D, size_t _size) {
   while (true) {
     double maximum = 0; size_t max_row = 0; size_t max_col = 0;
     for (size_t i = 0; i < _size; ++i) {
@@ -750,12 +812,6 @@ inline void jacobi(const Matrix& q, Matrix& V, Matrix& D) {
     double c = 1 / sqrt(t*t+1); 
     double s = c*t;
 
-    Matrix R(m_identity(_size));
-    R(max_row,max_row) = c;
-    R(max_col,max_col) = c;
-    R(max_row,max_col) = s;
-    R(max_col,max_row) = -s;
-
     // update D // 
     double temp1 = c*c*D(max_row, max_row) + s*s*D(max_col, max_col) - 2*c*s*D(max_row, max_col);
     double temp2 = s*s*D(max_row, max_row) + c*c*D(max_col, max_col) + 2*c*s*D(max_row, max_col);
@@ -773,11 +829,25 @@ inline void jacobi(const Matrix& q, Matrix& V, Matrix& D) {
     }
     //std::cout << D << std::endl << std::endl;
     
-
-    V = V * R;
+    // V = V * R, where R is the identity except for R(max_row,max_row) = R(max_col,max_col) = c,
+    // R(max_row,max_col) = s and R(max_col,max_row) = -s; only two columns of V change.
+    for (size_t i = 0; i < _size; ++i) {
+      double v_row = V(i, max_row);
+      double v_col = V(i, max_col);
+      V(i, max_row) = v_row * c + v_col * (-s);
+      V(i, max_col) = v_row * s + v_col * c;
+    }
   } 
 }
 
+inline void jacobi(const Matrix& q, Matrix& V, Matrix& D) {
+  assert(q.numRows() == q.numColumns());
+  size_t _size = q.numRows();
+  D = q;
+  V = m_identity(_size);
+  jacobiRotate(V, D, _size);
+}
+
 
 // Matrix exponentiation
 #define _B0 1729728e1
@@ -11,6 +11,7 @@
  */
 
 #include "interfaces/AgentInterface.h"
+#include "simulation/SimulationSnapshot.h"
 #include "SteerLib.h"
 
 using namespace Util;
@@ -342,3 +343,42 @@ void AgentInterface::draw()
 
 #endif
 }
+
+
+void AgentInterface::saveState(SteerLib::SimulationStateWriter & writer)
+{
+	writer.write(_enabled);
+	writer.write(_position);
+	writer.write(_velocity);
+	writer.write(_forward);
+	writer.write(_prefVelocity);
+	writer.write(_newVelocity);
+	writer.write(_color);
+	writer.write(_radius);
+	writer.writeDeque(_waypoints);
+	writer.writeDeque(_midTermPath);
+	writer.write(_currentLocalTarget);
+	writer.writeGoal(_currentGoal);
+	writer.writeGoalQueue(_goalQueue);
+}
+
+void AgentInterface::restoreState(SteerLib::SimulationStateReader & reader)
+{
+	reader.read(_enabled);
+	reader.read(_position);
+	reader.read(_velocity);
+	reader.read(_forward);
+	reader.read(_prefVelocity);
+	reader.read(_newVelocity);
+	reader.read(_color);
+	reader.read(_radius);
+	reader.readDeque(_waypoints);
+	reader.readDeque(_midTermPath);
+	reader.read(_currentLocalTarget);
+	reader.readGoal(_currentGoal);
+	reader.readGoalQueue(_goalQueue);
+
+	// neighbor lists hold pointers, and are recomputed every frame anyway.
+	agentNeighbors_.clear();
+	obstacleNeighbors_.clear();
+}
@@ -30,10 +30,23 @@ using namespace SteerLib;
 using namespace Util;
 
 // TODO this class should use the pointer it has to the agent. It will have the most up to date data
-AgentMetricsCollector::AgentMetricsCollector(SteerLib::AgentInterface * agent)
+AgentMetricsCollector::AgentMetricsCollector(SteerLib::AgentInterface * agent, const MetricsWindowSizes & windowSizes)
 {
 	_agentBeingAnalyzed = agent;
 
+	// the sign-change windows hold one value less than their window, so every window needs at least 2 frames.
+	if ((windowSizes.distanceWindowSize < 2) || (windowSizes.turningWindowSize < 2) || (windowSizes.changeInSpeedWindowSize < 2) || (windowSizes.accelerationWindowSize < 2)) {
+		throw GenericException("AgentMetricsCollector: every metrics window must be at least 2 frames long.");
+	}
+	_windowSizes = windowSizes;
+	_positionWindow.setCapacity(_windowSizes.distanceWindowSize);
+	_distanceWindow.setWindowSize(_windowSizes.distanceWindowSize);
+	_velocitySignChangeWindow.setWindowSize(_windowSizes.distanceWindowSize - 1);
+	_turnWindow.setWindowSize(_windowSizes.turningWindowSize);
+	_changeInSpeedWindow.setWindowSize(_windowSizes.changeInSpeedWindowSize);
+	_accelerationWindow.setWindowSize(_windowSizes.accelerationWindowSize);
+	_accelerationSignChangeWindow.setWindowSize(_windowSizes.accelerationWindowSize - 1);
+
 	reset();
 }
 
@@ -51,8 +64,28 @@ void AgentMetricsCollector::reset()
 
 	// initialize collision stats and metrics
 	_currentCollidingObjects.clear();
+	_numPastCollisions = 0;
 	_pastCollisions.clear();
+	for (unsigned int i=0; i<_thresholdedCollisionCounts.size(); i++) {
+		_thresholdedCollisionCounts[i].numPastCollisions = 0;
+	}
 	_metrics.reset();
+
+	_resetWindows();
+}
+
+
+void AgentMetricsCollector::_resetWindows()
+{
+	_positionWindow.clear();
+	_turnWindow.clear();
+	_distanceWindow.clear();
+	_changeInSpeedWindow.clear();
+	_accelerationWindow.clear();
+	_velocitySignChangeWindow.clear();
+	_accelerationSignChangeWindow.clear();
+	_previousVelocity = Vector(0.0f, 0.0f, 0.0f);
+	_previousInstantaneousAcceleration = Vector(0.0f, 0.0f, 0.0f);
 }
 
 /// @todo move this function to a better place.
@@ -131,28 +164,65 @@ void AgentMetrics::reset()
 
 unsigned int AgentMetricsCollector::getNumThresholdedCollisions(float penetrationThreshold, float timeDurationThreshold)
 {
-	assert(_metrics.numUniqueCollisions == _pastCollisions.size()+_currentCollidingObjects.size());
+	assert(_metrics.numUniqueCollisions == _numPastCollisions + _currentCollidingObjects.size());
 	unsigned int numThresholdedCollisions = 0;
 
 	// if there is no thresholding, its OK to just return the total number of unique collisions.
 	if (penetrationThreshold <= 0.0f && timeDurationThreshold <= 0.0f) {
-		assert(_metrics.numUniqueCollisions == _pastCollisions.size() + _currentCollidingObjects.size());
+		assert(_metrics.numUniqueCollisions == _numPastCollisions + _currentCollidingObjects.size());
 		return _metrics.numUniqueCollisions;
 	}
 
-	// otherwise, go through the entire history of collisions.
-	for (unsigned int i=0; i<_pastCollisions.size(); i++) {
-		if ((_pastCollisions[i].maxPenetration > penetrationThreshold) && (_pastCollisions[i].timeDuration > timeDurationThreshold)) {
+	// otherwise, past collisions of a registered threshold have been counted as they ended; for any other threshold
+	// they are counted now.  current collisions are always checked now.
+	unsigned int thresholdIndex = 0;
+	while ((thresholdIndex < _thresholdedCollisionCounts.size()) &&
+		((_thresholdedCollisionCounts[thresholdIndex].penetrationThreshold != penetrationThreshold) || (_thresholdedCollisionCounts[thresholdIndex].timeDurationThreshold != timeDurationThreshold))) {
+		thresholdIndex++;
+	}
+	if (thresholdIndex < _thresholdedCollisionCounts.size()) {
+		numThresholdedCollisions = _thresholdedCollisionCounts[thresholdIndex].numPastCollisions;
+	}
+	else {
+		numThresholdedCollisions = _countPastCollisions(penetrationThreshold, timeDurationThreshold);
+	}
+
+	for (size_t i=0; i<_currentCollidingObjects.getNumSlots(); i++) {
+		if (!_currentCollidingObjects.isOccupied(i)) continue;
+		const CollisionInfo & currentCollision = _currentCollidingObjects.getSlot(i);
+		if ((currentCollision.maxPenetration > penetrationThreshold) && (currentCollision.timeDuration > timeDurationThreshold)) {
 			numThresholdedCollisions++;
 		}
 	}
 
-	for (unsigned int i=0; i<_currentCollidingObjects.size(); i++) {
-		if ((_currentCollidingObjects[i].maxPenetration > penetrationThreshold) && (_currentCollidingObjects[i].timeDuration > timeDurationThreshold)) {
-			numThresholdedCollisions++;
+	return numThresholdedCollisions;
+}
+
+
+void AgentMetricsCollector::addCollisionThreshold(float penetrationThreshold, float timeDurationThreshold)
+{
+	for (unsigned int i=0; i<_thresholdedCollisionCounts.size(); i++) {
+		if ((_thresholdedCollisionCounts[i].penetrationThreshold == penetrationThreshold) && (_thresholdedCollisionCounts[i].timeDurationThreshold == timeDurationThreshold)) {
+			return;
 		}
 	}
 
+	ThresholdedCollisionCount count;
+	count.penetrationThreshold = penetrationThreshold;
+	count.timeDurationThreshold = timeDurationThreshold;
+	count.numPastCollisions = _countPastCollisions(penetrationThreshold, timeDurationThreshold);
+	_thresholdedCollisionCounts.push_back(count);
+}
+
+
+unsigned int AgentMetricsCollector::_countPastCollisions(float penetrationThreshold, float timeDurationThreshold)
+{
+	unsigned int numThresholdedCollisions = 0;
+	for (size_t i=0; i<_pastCollisions.size(); i++) {
+		if ((_pastCollisions[i].maxPenetration > penetrationThreshold) && (_pastCollisions[i].timeDuration > timeDurationThreshold)) {
+			numThresholdedCollisions++;
+		}
+	}
 	return numThresholdedCollisions;
 }
 
@@ -166,7 +236,8 @@ void AgentMetricsCollector::_checkAndUpdateOneCollision(uintptr_t collisionKey,
 #ifdef _DEBUG_1
 			std::cout << "Collision: " << std::endl;
 #endif
-		if (_currentCollidingObjects.find(collisionKey) == _currentCollidingObjects.end()){
+		CollisionInfo * existingCollision = _currentCollidingObjects.find(collisionKey);
+		if (existingCollision == NULL){
 			//
 			// existing collision with this object not found, so it is a new collision
 			//
@@ -176,17 +247,16 @@ void AgentMetricsCollector::_checkAndUpdateOneCollision(uintptr_t collisionKey,
 			newCollision.startTime = currentTimeStamp;
 			newCollision.endTime = currentTimeStamp;
 			newCollision.timeDuration = 0.0f;
-			// the [] operator actually inserts the new collisionInfo using key collisionKey, because it is not found.  (see STL map documentation)
-			_currentCollidingObjects[collisionKey] = newCollision;
+			_currentCollidingObjects.insert(newCollision);
 			_metrics.numUniqueCollisions++;
 		}
 		else {
 			//
 			// update the existing collision
 			//
-			_currentCollidingObjects[collisionKey].maxPenetration = max(_currentCollidingObjects[collisionKey].maxPenetration, penetration);
-			_currentCollidingObjects[collisionKey].endTime = currentTimeStamp;
-			_currentCollidingObjects[collisionKey].timeDuration = _currentCollidingObjects[collisionKey].endTime - _currentCollidingObjects[collisionKey].startTime;
+			existingCollision->maxPenetration = max(existingCollision->maxPenetration, penetration);
+			existingCollision->endTime = currentTimeStamp;
+			existingCollision->timeDuration = existingCollision->endTime - existingCollision->startTime;
 		}
 		float e_c = 10; // J / (Kg * m * s)
 		_metrics._totalPenetration += ( penetration * e_c );
@@ -198,12 +268,20 @@ void AgentMetricsCollector::_checkAndUpdateOneCollision(uintptr_t collisionKey,
 		// 
 		// at the same time, update the agent's stats on max penetration and max time duration
 		//
-		if (_currentCollidingObjects.find(collisionKey) != _currentCollidingObjects.end()){
-			CollisionInfo oldCollision = _currentCollidingObjects[collisionKey];
-			_currentCollidingObjects.erase(collisionKey);
+		CollisionInfo oldCollision;
+		if (_currentCollidingObjects.erase(collisionKey, oldCollision)){
 			oldCollision.endTime = currentTimeStamp;
 			oldCollision.timeDuration = oldCollision.endTime - oldCollision.startTime;
-			_pastCollisions.push_back(oldCollision);
+			_numPastCollisions++;
+			PastCollision pastCollision;
+			pastCollision.maxPenetration = oldCollision.maxPenetration;
+			pastCollision.timeDuration = oldCollision.timeDuration;
+			_pastCollisions.push_back(pastCollision);
+			for (unsigned int i=0; i<_thresholdedCollisionCounts.size(); i++) {
+				if ((oldCollision.maxPenetration > _thresholdedCollisionCounts[i].penetrationThreshold) && (oldCollision.timeDuration > _thresholdedCollisionCounts[i].timeDurationThreshold)) {
+					_thresholdedCollisionCounts[i].numPastCollisions++;
+				}
+			}
 
 			if (_metrics.maxCollisionPenetration < oldCollision.maxPenetration) _metrics.maxCollisionPenetration = oldCollision.maxPenetration;
 			if (_metrics.maxTimeSpentInCollision < oldCollision.timeDuration) _metrics.maxTimeSpentInCollision = oldCollision.timeDuration;
@@ -343,86 +421,61 @@ void AgentMetricsCollector::update(SpatialDataBaseInterface * gridDB, SteerLib::
 	_metrics.instantaneousAngularSpeed = angleTurnedSinceLastFrame / timePassedSinceLastFrame;
 
 
-	if (_numFramesMeasured < WINDOW_SIZE) {
-		// in this case, the history windows have not yet been filled
-		// simply update the Agent's windows, don't analyze them until we have a full window.
-		_positionWindow[_numFramesMeasured] = _currentPosition;
-		_distanceWindow[_numFramesMeasured] = distanceTraveledSinceLastFrame;
-		_turnWindow[_numFramesMeasured]     = angleTurnedSinceLastFrame;
-		_velocityWindow[_numFramesMeasured] = instantaneousVelocity;
-		if (_numFramesMeasured > 1) {
-			changeInSpeedSinceLastFrame = fabsf((_velocityWindow[_numFramesMeasured]).length() - (_velocityWindow[_numFramesMeasured-1]).length());
-			changeInVelocitySinceLastFrame = _velocityWindow[_numFramesMeasured] - _velocityWindow[_numFramesMeasured-1];
-		}
-	} else {
-		_positionWindow.advanceByOne(_currentPosition);
-		_distanceWindow.advanceByOne(distanceTraveledSinceLastFrame);
-		_turnWindow.advanceByOne(angleTurnedSinceLastFrame);
-		_velocityWindow.advanceByOne(instantaneousVelocity);
-
-		// analyze the window histories
-		_metrics.totalDistanceTraveledOverWindow = 0.0f;
-		_metrics.totalDegreesTurnedOverWindow = 0.0f;
-		_metrics.numTimesVelocityChangedSignOverWindow = 0;
-		for (int i=0; i<WINDOW_SIZE; i++) {
-			_metrics.totalDistanceTraveledOverWindow += _distanceWindow[i];
-			_metrics.totalDegreesTurnedOverWindow += _turnWindow[i];
-			if ( (i>0) && (dot(_velocityWindow[i-1],_velocityWindow[i]) < 0.0f) ) {
-				_metrics.numTimesVelocityChangedSignOverWindow++;
-			}
-		}
+	// update the sliding windows.  Each window is only analyzed once it is full, i.e. it covers as many frames as it was configured for.
+	_positionWindow.push(_currentPosition);
+	_distanceWindow.push(distanceTraveledSinceLastFrame);
+	_turnWindow.push(angleTurnedSinceLastFrame);
+	if (_numFramesMeasured > 1) {
+		changeInSpeedSinceLastFrame = fabsf(instantaneousVelocity.length() - _previousVelocity.length());
+		changeInVelocitySinceLastFrame = instantaneousVelocity - _previousVelocity;
+		_velocitySignChangeWindow.push((dot(_previousVelocity, instantaneousVelocity) < 0.0f) ? 1.0f : 0.0f);
+	}
+	_previousVelocity = instantaneousVelocity;
+
+	if (_distanceWindow.full()) {
+		_metrics.totalDistanceTraveledOverWindow = _distanceWindow.sum();
+		_metrics.numTimesVelocityChangedSignOverWindow = (unsigned int)_velocitySignChangeWindow.sum();
 		if (_metrics.maxDistanceTraveledOverWindow < _metrics.totalDistanceTraveledOverWindow) _metrics.maxDistanceTraveledOverWindow = _metrics.totalDistanceTraveledOverWindow;
 		if (_metrics.minDistanceTraveledOverWindow > _metrics.totalDistanceTraveledOverWindow) _metrics.minDistanceTraveledOverWindow = _metrics.totalDistanceTraveledOverWindow;
+		_metrics.displacementOverWindow = (_positionWindow.newest() - _positionWindow.oldest()).length();
+	}
+	if (_turnWindow.full()) {
+		_metrics.totalDegreesTurnedOverWindow = _turnWindow.sum();
 		if (_metrics.maxDegreesTurnedOverWindow  < _metrics.totalDegreesTurnedOverWindow) _metrics.maxDegreesTurnedOverWindow  = _metrics.totalDegreesTurnedOverWindow;
 		if (_metrics.minDegreesTurnedOverWindow  > _metrics.totalDegreesTurnedOverWindow) _metrics.minDegreesTurnedOverWindow  = _metrics.totalDegreesTurnedOverWindow;
-
-		changeInSpeedSinceLastFrame = fabsf((_velocityWindow[WINDOW_SIZE-1]).length() - (_velocityWindow[WINDOW_SIZE-2]).length());
-		changeInVelocitySinceLastFrame = _velocityWindow[WINDOW_SIZE-1] - _velocityWindow[WINDOW_SIZE-2];
 	}
+
 	_metrics.instantaneousChangeInSpeed = changeInSpeedSinceLastFrame / timePassedSinceLastFrame;
 	_metrics.instantaneousAcceleration = changeInVelocitySinceLastFrame / timePassedSinceLastFrame;
 
-	if (_numFramesMeasured < WINDOW_SIZE) {
-		// TIME DEPENDENT?  TODO: why did you use time-dependent here?  it should have been an integral?
-		//_changeInSpeedWindow[_numFramesMeasured] = _metrics.instantaneousChangeInSpeed;
-		//_accelerationWindow[_numFramesMeasured] = _metrics.instantaneousAcceleration.length();
-		_changeInSpeedWindow[_numFramesMeasured] = changeInSpeedSinceLastFrame;
-		_accelerationWindow[_numFramesMeasured] = changeInVelocitySinceLastFrame.length();
-		_instantaneousAccelerationWindow[_numFramesMeasured] = _metrics.instantaneousAcceleration;
-	} else {
-		// TIME DEPENDENT?  TODO: why did you use time-dependent here?  it should have been an integral?
-		//_changeInSpeedWindow.advanceByOne(_metrics.instantaneousChangeInSpeed);
-		//_accelerationWindow.advanceByOne(_metrics.instantaneousAcceleration.length());
-		_changeInSpeedWindow.advanceByOne(changeInSpeedSinceLastFrame);
-		_accelerationWindow.advanceByOne(changeInVelocitySinceLastFrame.length());
-		_instantaneousAccelerationWindow.advanceByOne(_metrics.instantaneousAcceleration);
-
-		// analyze the window histories
-		_metrics.totalChangeInSpeedOverWindow = 0.0f;
-		_metrics.totalAccelerationOverWindow = 0.0f;
-		_metrics.numTimesAccelerationChangedSignOverWindow = 0;
-		for (int i=0; i<WINDOW_SIZE; i++) {
-			_metrics.totalChangeInSpeedOverWindow += _changeInSpeedWindow[i];
-			_metrics.totalAccelerationOverWindow += _accelerationWindow[i];
-
-			if ( (i>0) && (dot(_instantaneousAccelerationWindow[i-1],_instantaneousAccelerationWindow[i]) < 0.0f) ) {
-				_metrics.numTimesAccelerationChangedSignOverWindow++;
-			}
-		}
+	// TIME DEPENDENT?  TODO: why did you use time-dependent here?  it should have been an integral?
+	//_changeInSpeedWindow.push(_metrics.instantaneousChangeInSpeed);
+	//_accelerationWindow.push(_metrics.instantaneousAcceleration.length());
+	_changeInSpeedWindow.push(changeInSpeedSinceLastFrame);
+	_accelerationWindow.push(changeInVelocitySinceLastFrame.length());
+	if (_numFramesMeasured > 1) {
+		_accelerationSignChangeWindow.push((dot(_previousInstantaneousAcceleration, _metrics.instantaneousAcceleration) < 0.0f) ? 1.0f : 0.0f);
+	}
+	_previousInstantaneousAcceleration = _metrics.instantaneousAcceleration;
+
+	if (_changeInSpeedWindow.full()) {
+		_metrics.totalChangeInSpeedOverWindow = _changeInSpeedWindow.sum();
 		if (_metrics.maxChangeInSpeedOverWindow < _metrics.totalChangeInSpeedOverWindow) _metrics.maxChangeInSpeedOverWindow = _metrics.totalChangeInSpeedOverWindow;
 		if (_metrics.minChangeInSpeedOverWindow > _metrics.totalChangeInSpeedOverWindow) _metrics.minChangeInSpeedOverWindow = _metrics.totalChangeInSpeedOverWindow;
+	}
+	if (_accelerationWindow.full()) {
+		_metrics.totalAccelerationOverWindow = _accelerationWindow.sum();
+		_metrics.numTimesAccelerationChangedSignOverWindow = (unsigned int)_accelerationSignChangeWindow.sum();
 		if (_metrics.maxAccelerationOverWindow  < _metrics.totalAccelerationOverWindow)  _metrics.maxAccelerationOverWindow  = _metrics.totalAccelerationOverWindow;
 		if (_metrics.minAccelerationOverWindow  > _metrics.totalAccelerationOverWindow)  _metrics.minAccelerationOverWindow  = _metrics.totalAccelerationOverWindow;
 	}
 
 
-
-	// WARNING!!! THESE ASSUME THAT WE HAVE A 60-FRAME WINDOW THAT IS 3 SECONDS INTERVAL (20 FPS).
-	_metrics.avgAngularSpeedOverWindow = _metrics.totalDegreesTurnedOverWindow / 3.0f;
-	_metrics.avgSpeedOverWindow = _metrics.totalDistanceTraveledOverWindow / 3.0f;
-	_metrics.avgChangeInSpeedOverWindow = _metrics.totalChangeInSpeedOverWindow / 3.0f;
-	_metrics.avgAccelerationOverWindow = _metrics.totalAccelerationOverWindow / 3.0f;
-	_metrics.displacementOverWindow = (_positionWindow[WINDOW_SIZE-1] - _positionWindow[0]).length();
+	// the averages convert each window into seconds assuming METRICS_WINDOW_FRAMES_PER_SECOND, e.g. 60 frames are 3 seconds.
+	_metrics.avgAngularSpeedOverWindow = _metrics.totalDegreesTurnedOverWindow / ((float)_windowSizes.turningWindowSize / METRICS_WINDOW_FRAMES_PER_SECOND);
+	_metrics.avgSpeedOverWindow = _metrics.totalDistanceTraveledOverWindow / ((float)_windowSizes.distanceWindowSize / METRICS_WINDOW_FRAMES_PER_SECOND);
+	_metrics.avgChangeInSpeedOverWindow = _metrics.totalChangeInSpeedOverWindow / ((float)_windowSizes.changeInSpeedWindowSize / METRICS_WINDOW_FRAMES_PER_SECOND);
+	_metrics.avgAccelerationOverWindow = _metrics.totalAccelerationOverWindow / ((float)_windowSizes.accelerationWindowSize / METRICS_WINDOW_FRAMES_PER_SECOND);
 
 
 
@@ -34,6 +34,8 @@ BenchmarkEngine::BenchmarkEngine(const std::string & recordingFilename, Benchmar
 
 	// allocate the rec file reader and open the rec file
 	_recFileReader = new RecFileReader(recordingFilename);
+	// the frames are benchmarked in order, so the next frames can be read in the background.
+	_recFileReader->setReadAhead(DEFAULT_REC_FILE_READ_AHEAD_FRAMES);
 
 	// allocate the spatial database
 	// @todo allocate the database according to the world bounds of the rec file instead of hard-coded
@@ -91,19 +93,21 @@ void BenchmarkEngine::stepOneFrame()
 	}
 
 	// 1. update all AgentInterface dummies and the spatial database based on the rec file
+	_recFileReader->getAgentStatesAtFrame(_currentFrameNumber, _agentStates);
 	for (unsigned int i=0; i < _recFileReader->getNumAgents(); i++) {
 		BenchmarkAgent * agent = dynamic_cast<BenchmarkAgent*>(_agents[i]);
+		const RecFileAgentState & state = _agentStates[i];
 
 		/// @todo
 		///   The next version of the RecFileReader should also return an AgentGoalInfo struct, and this indirection should be unnecessary.
 		AgentGoalInfo newGoal;
-		newGoal.targetLocation = _recFileReader->getAgentGoalAtFrame(i,_currentFrameNumber);
+		newGoal.targetLocation = state.goal;
 
 		AxisAlignedBox oldBounds = agent->getBounds();
-		agent->setEnabled(_recFileReader->isAgentEnabledAtFrame(i,_currentFrameNumber));
-		agent->setPosition(_recFileReader->getAgentLocationAtFrame(i,_currentFrameNumber));
-		agent->setForward(_recFileReader->getAgentOrientationAtFrame(i,_currentFrameNumber));
-		agent->setRadius(_recFileReader->getAgentRadiusAtFrame(i,_currentFrameNumber));
+		agent->setEnabled(state.enabled);
+		agent->setPosition(state.position);
+		agent->setForward(state.direction);
+		agent->setRadius(state.radius);
 		agent->setCurrentGoal(newGoal);
 		_spatialDatabase->updateObject(agent, oldBounds, agent->getBounds());
 	}
@@ -12,6 +12,10 @@
 ///   - fix coding style
 ///   - options are accessible now, is there anything to change because of this?
 
+#include <math.h>
+#ifndef _WIN32
+#include <time.h>
+#endif
 #include "util/GenericException.h"
 #include "util/HighResCounter.h"
 #include "util/Misc.h"
@@ -20,18 +24,23 @@
 using namespace SteerLib;
 using namespace Util;
 
+// long enough to cover how late a sleep usually wakes up on a desktop operating system.
+#define DEFAULT_FRAME_PACING_SPIN_TIME 0.002f
+
 
 
 Clock::Clock()
 {
 	// default to a fixed frame rate of 20 fps, running as fast as possible.
 	setClockMode(CLOCK_MODE_FIXED_AS_FAST_AS_POSSIBLE, 20.0f, 0.01f, 0.1f);
+	setFramePacing(FRAME_PACING_HYBRID, DEFAULT_FRAME_PACING_SPIN_TIME);
 	reset();
 }
 
 Clock::Clock(ClockModeEnum clockMode, float fixedFps, float minSimulationDt, float maxSimulationDt)
 {
 	setClockMode(clockMode, fixedFps, minSimulationDt, maxSimulationDt);
+	setFramePacing(FRAME_PACING_HYBRID, DEFAULT_FRAME_PACING_SPIN_TIME);
 	reset();
 }
 
@@ -50,6 +59,38 @@ void Clock::reset()
 	_simulationFrameNumber = 0; // frame 0 contains the initial conditions, so modules and agents will never see that.  The first number modules and agents will receive is 1.
 	_measuredFps = 0;
 	_inverseFrequency = 1.0f/((float)Util::getHighResCounterFrequency());
+	resetPacingStatistics();
+}
+
+
+void Clock::resetPacingStatistics()
+{
+	_numPacedFrames = 0;
+	_sumPacingLatenessTicks = 0.0;
+	_sumSquaredPacingLatenessTicks = 0.0;
+	_maxPacingLatenessTicks = 0;
+	_totalPacingSleepTicks = 0;
+	_totalPacingSpinTicks = 0;
+}
+
+
+float Clock::getMeanPacingLateness()
+{
+	if (_numPacedFrames == 0) {
+		return 0.0f;
+	}
+	return (float)(_sumPacingLatenessTicks / (double)_numPacedFrames) * _inverseFrequency;
+}
+
+
+float Clock::getPacingLatenessStandardDeviation()
+{
+	if (_numPacedFrames == 0) {
+		return 0.0f;
+	}
+	double mean = _sumPacingLatenessTicks / (double)_numPacedFrames;
+	double variance = _sumSquaredPacingLatenessTicks / (double)_numPacedFrames - mean * mean;
+	return (variance > 0.0) ? (float)sqrt(variance) * _inverseFrequency : 0.0f;
 }
 
 
@@ -125,6 +166,28 @@ void Clock::backupSimulationAndUpdateRealTime()
 
 }
 
+void Clock::getSimulationState(unsigned int & frameNumber, double & totalSimulationTime, double & simulationDt)
+{
+	// doubles keep the tick counts exact, and make snapshots portable across machines with different counter frequencies.
+	double frequency = (double)Util::getHighResCounterFrequency();
+	frameNumber = _simulationFrameNumber;
+	totalSimulationTime = (double)_totalSimulationTime / frequency;
+	simulationDt = (double)_simulationDt / frequency;
+}
+
+
+void Clock::setSimulationState(unsigned int frameNumber, double totalSimulationTime, double simulationDt)
+{
+	if ((totalSimulationTime < 0.0) || (simulationDt < 0.0)) {
+		throw Util::GenericException("Clock::setSimulationState(): simulation times must not be negative.");
+	}
+	double frequency = (double)Util::getHighResCounterFrequency();
+	_simulationFrameNumber = frameNumber;
+	_totalSimulationTime = (unsigned long long)(totalSimulationTime * frequency + 0.5);
+	_simulationDt = (unsigned long long)(simulationDt * frequency + 0.5);
+}
+
+
 void Clock::setClockMode(ClockModeEnum clockMode, float fixedFps, float minSimulationDt, float maxSimulationDt)
 {
 	_clockMode = clockMode;
@@ -140,6 +203,16 @@ void Clock::setClockMode(ClockModeEnum clockMode, float fixedFps, float minSimul
 }
 
 
+void Clock::setFramePacing(FramePacingEnum framePacing, float spinTime)
+{
+	if (spinTime < 0.0f) {
+		throw Util::GenericException("Invalid frame pacing spin time (" + Util::toString(spinTime) + " seconds) requested. The spin time must not be negative.");
+	}
+	_framePacing = framePacing;
+	_spinTicks = (unsigned long long)(((double)getHighResCounterFrequency()) * spinTime);
+}
+
+
 void Clock::_updateFpsMeasurement()
 {
 	if(_realDt > 0.f)
@@ -153,17 +226,54 @@ void Clock::_waitForFrameSync(const unsigned long long & minDesiredTicks)
 	// tempDt is the time since last update.
 	// we only insert a delay if that time was shorter than the desired fixed ticks per frame.
 	//
-	unsigned long long tempDt = _getTickCount() - _totalRealTime;
+	unsigned long long startTime = _getTickCount();
+	unsigned long long tempDt = startTime - _totalRealTime;
 	if (tempDt < minDesiredTicks) {
-		// figure out when to wake up
-		unsigned long long targetTime = _totalRealTime + minDesiredTicks - tempDt;
-
-		// TODO: set up a better non-busy wait, as long as it uses accurate timing.
-		// busy-wait
-		while(_getTickCount() < targetTime) {
-			// do nothing
+		// figure out when to wake up: one full frame after the previous frame started.
+		unsigned long long targetTime = _totalRealTime + minDesiredTicks;
+
+		unsigned long long sleepTicks = 0;
+		unsigned long long now = startTime;
+		while (now < targetTime) {
+			unsigned long long remaining = targetTime - now;
+			if ((_framePacing == FRAME_PACING_SLEEP) || ((_framePacing == FRAME_PACING_HYBRID) && (remaining > _spinTicks))) {
+				// sleeping may end late, so hybrid pacing wakes up early and spins until the deadline.
+				unsigned long long ticksToSleep = (_framePacing == FRAME_PACING_SLEEP) ? remaining : remaining - _spinTicks;
+				_sleepForTicks(ticksToSleep);
+				unsigned long long afterSleep = _getTickCount();
+				sleepTicks += afterSleep - now;
+				now = afterSleep;
+			}
+			else {
+				// busy-wait
+				now = _getTickCount();
+			}
 		}
+
+		unsigned long long lateness = now - targetTime;
+		_numPacedFrames++;
+		_sumPacingLatenessTicks += (double)lateness;
+		_sumSquaredPacingLatenessTicks += (double)lateness * (double)lateness;
+		_maxPacingLatenessTicks = (lateness > _maxPacingLatenessTicks) ? lateness : _maxPacingLatenessTicks;
+		_totalPacingSleepTicks += sleepTicks;
+		_totalPacingSpinTicks += (now - startTime) - sleepTicks;
 	}
 }
 
 
+void Clock::_sleepForTicks(unsigned long long ticks)
+{
+	double seconds = (double)ticks / (double)getHighResCounterFrequency();
+#ifdef _WIN32
+	// Sleep() rounds to the scheduler's tick; a short sleep is still better than spinning for it.
+	Sleep((DWORD)(seconds * 1000.0));
+#else
+	struct timespec t;
+	t.tv_sec = (time_t)seconds;
+	t.tv_nsec = (long)((seconds - (double)t.tv_sec) * 1.0e9);
+	// an interrupted sleep just returns early; the caller checks the time again.
+	nanosleep(&t, NULL);
+#endif
+}
+
+
@@ -20,6 +20,7 @@
 #include "interfaces/EngineInterface.h"
 #include "testcaseio/AgentInitialConditions.h"
 #include "benchmarking/BayesianFilter.h"
+#include "simulation/SimulationEngine.h"
 
 
 
@@ -31,13 +32,14 @@ using namespace SteerLib;
 
 CompositeTechniqueEntropy::CompositeTechniqueEntropy()
 {
-	// TODO Auto-generated constructor stub
-
+	_numThreads = DEFAULT_NUM_ENTROPY_THREADS;
+	_randomSeed = DEFAULT_ENTROPY_SEED;
+	_taskManager = NULL;
 }
 
 CompositeTechniqueEntropy::~CompositeTechniqueEntropy()
 {
-	// TODO Auto-generated destructor stub
+	_destroyWorkers();
 }
 
 /*
@@ -72,6 +74,9 @@ void CompositeTechniqueEntropy::init()
 	_perferedNumFrames=((1/_timeStep)*4);
 	_replay_data=0;
 
+	_numThreads = DEFAULT_NUM_ENTROPY_THREADS;
+	_randomSeed = DEFAULT_ENTROPY_SEED;
+
 }
 
 Matrix CompositeTechniqueEntropy::h(const Matrix & x, const Matrix & n)
@@ -138,6 +143,14 @@ void CompositeTechniqueEntropy::init( const SteerLib::OptionDictionary & options
 			_replay_data = true;
 			std::cout << "Replaying real world data" << std::endl;
 		}
+		else if ( (*optionIter).first == "numEntropyThreads")
+		{
+			_numThreads = atoi((*optionIter).second.c_str());
+		}
+		else if ( (*optionIter).first == "entropySeed")
+		{
+			_randomSeed = atoi((*optionIter).second.c_str());
+		}
 
 		else
 		{
@@ -487,6 +500,11 @@ void CompositeTechniqueEntropy::performEstimation()
 	 * 				.
 	 */
 
+	if (_numThreads > 0)
+	{
+		_createWorkers();
+	}
+
 	/*
 	 * Is really designed to perform a random sample of fHat
 	 */
@@ -495,7 +513,16 @@ void CompositeTechniqueEntropy::performEstimation()
 		X[i] = zeros(X_DIM);
 		for (int a = 0; a < _numAgt; a++) // for each agent
 		{
-			Matrix sampx  = Util::sampleGaussian(xHat.subMatrix(a*sx,0,sx,1), M);
+			Matrix sampx;
+			if (_workers.empty())
+			{
+				sampx = Util::sampleGaussian(xHat.subMatrix(a*sx,0,sx,1), M);
+			}
+			else
+			{
+				sampx = Util::sampleGaussian(FixedMatrix<4,1>::subMatrixOf(xHat,a*sx,0), FixedMatrix<4,4>(M),
+						*_sampleRandomNumberGenerators[i]).toMatrix();
+			}
 			// Matrix sampx  = sampleGaussian(xHat.subMatrix(a*sx,0,a*sx,1), M);
 			for (int z = 0; z < sx; z++)// for each data dimension p_x, p_z, v_x, v_z
 			{
@@ -529,7 +556,15 @@ void CompositeTechniqueEntropy::performEstimation()
 		 */
 		// std::cout << "number of agents in the simulation " << this->getEngineInterface()->getAgents().size() <<
 			//		" number of agents from the data " << _posData.size() << std::endl;
-		Util::ensembleKalmanFilter(X, u, z,  M_DIM, this, N_DIM, this); ////
+		if (_workers.empty())
+		{
+			Util::ensembleKalmanFilter(X, u, z,  M_DIM, this, N_DIM, this); ////
+		}
+		else
+		{
+			_propagateEnsemble(X);
+			Util::enkfMeasurementUpdate(X, z, N_DIM, this, _sampleRandomNumberGenerators);
+		}
 		// ensembleKalmanFilter(X, u, z,  M_DIM, [=](int v){return this->m_fHat;}, N_DIM, &CompositeTechniqueEntropy::h); ////
 		// this->getEngineInterface()->getSpatialDatabase()->getItemsInRange(neighborList, -30.0f, 30, -30, 30, NULL);
 		// std::cout << "agents left in database: " << neighborList.size() << std::endl;
@@ -630,13 +665,40 @@ void CompositeTechniqueEntropy::performEstimation()
 	Matrix zm = zeros(M_DIM);
 	Matrix diff;
 	M = zeros(M_DIM,M_DIM);
+
+	// Xs holds ses-1 states and each one is compared to its successor; ses is unsigned, so ses-2 must not be computed for ses < 2.
+	size_t numComparedSteps = (ses < 2) ? 0 : ses - 2;
+
+	// with worker engines, every sample is simulated through all time steps first; M is accumulated in the same order either way.
+	std::vector<PropagationTask> tasks;
+	if (!_workers.empty())
+	{
+		tasks.resize(_numSamples);
+		for (int e = 0; e < _numSamples; e++)
+		{
+			tasks[e].addNoise = false;
+			for (size_t s = 0; s < numComparedSteps; s++)
+			{
+				tasks[e].states.push_back(&Xs[s][e]);
+			}
+		}
+		_propagate(tasks);
+	}
+
 	for (int e = 0; e < _numSamples; e++)
 	{//for each sample in the ensemple
 		std::vector<Matrix> fxs;
 		// fxs.push_back(Xs[0][e]); // Not used bu one needs to be added into data
-		for (int s = 0; s < ses-2; s++)
+		for (size_t s = 0; s < numComparedSteps; s++)
 		{ //for each timestep
-			fxs.push_back(this->m_fHat(Xs[s][e],zu,zm));
+			if (_workers.empty())
+			{
+				fxs.push_back(this->m_fHat(Xs[s][e],zu,zm));
+			}
+			else
+			{
+				fxs.push_back(tasks[e].results[s]);
+			}
 			for (int a = 0; a < _numAgt; a++)
 			{ // for each agent in the timestep
 				// std::cout << "subMatrix s=" << s << " a=" << a << " : " << ~(fxs.back()) << std::endl;
@@ -645,7 +707,7 @@ void CompositeTechniqueEntropy::performEstimation()
 				 */
 				// diff = (fxs.back().subMatrix(a*sx,0,sx,1) - Xs[s+1][e].subMatrix(a*sx,0,sx,1));
 				diff = abs(fxs.back().subMatrix(a*sx,0,sx,1) - Xs[s+1][e].subMatrix(a*sx,0,sx,1));
-				M = M + diff*~diff;
+				addOuterProduct(M, diff, diff);
 				/*
 				for ( int m = 0; m < (M.numRows()*M.numColumns()); m++)
 				{
@@ -686,6 +748,8 @@ void CompositeTechniqueEntropy::performEstimation()
 	_entropyResult = result;
 
 	std::cout << "Entropy result: " << result << std::endl;
+
+	_destroyWorkers();
 }
 
 /*
@@ -768,6 +832,27 @@ SteerLib::AgentInitialConditions CompositeTechniqueEntropy::getAgentConditions(S
  * the additional information from the noisy data
  */
 Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const Matrix& m1)
+{
+	Matrix xNew = _propagateSample(x, m1, this->getEngineInterface(), this->_agentModule, NULL);
+
+	_f_hat_calls = _f_hat_calls + 1;
+	if ( _f_hat_calls > 25 )
+	{
+		// tempAgent = this->getEngineInterface()->getAgents().at(-1);
+	}
+#ifdef _DEBUG_ENTROPY
+	std::cout << "*****************************Calls thus far " << _f_hat_calls << std::endl;
+#endif
+
+	return xNew;
+}
+
+//
+// _propagateSample() - simulates one time step of the agents of the given engine, starting from state x.  The motion
+// noise is drawn from randomNumberGenerator, or with rand() if it is NULL.
+//
+Matrix CompositeTechniqueEntropy::_propagateSample(const Matrix& x, const Matrix& m1, SteerLib::EngineInterface * engine,
+		SteerLib::ModuleInterface * agentModule, MTRand * randomNumberGenerator)
 {
 	// std::cout << this->getEngineInterface() << std::endl;
 	// std::cout << "agents ready " << this->getEngineInterface()->getAgents().size() << std::endl;
@@ -786,7 +871,7 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 		x_v = x[4*a+2]*_inverseScale;
 		y_v = x[4*a+3]*_inverseScale;
 
-		tempAgent = this->getEngineInterface()->getAgents().at(a);
+		tempAgent = engine->getAgents().at(a);
 		SteerLib::AgentInitialConditions initialConditions; // = this->getAgentConditions(tempAgent);
 		initialConditions.radius = 0.50f;
 		// initialConditions.
@@ -835,7 +920,7 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 		// this->getEngineInterface()->addAgent(agent, agentModule);
 		// this->getEngineInterface()->getSpatialDatabase()->addObject()
 		// this->createAgent( initialConditions);
-		tempAgent->reset(initialConditions, this->getEngineInterface());
+		tempAgent->reset(initialConditions, engine);
 	}
 
 	// std::cout << "agents ready " << this->getEngineInterface()->getAgents().size() << std::endl;
@@ -851,16 +936,16 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 			//		std::endl;
 	// .......................................
 	int timeCut = 1;
-	this->_agentModule->preprocessFrame( 0 , _timeStep, 1);
+	agentModule->preprocessFrame( 0 , _timeStep, 1);
 	for (int i = 1; i <= timeCut; i++)
 	{
 		for (int i = 0; i < _numAgt; i++)
 		{
-			tempAgent = this->getEngineInterface()->getAgents().at(i);
+			tempAgent = engine->getAgents().at(i);
 			tempAgent->updateAI(i*(_timeStep/timeCut), _timeStep/timeCut, i );
 		}
 	}
-	this->_agentModule->postprocessFrame( _timeStep , _timeStep, 1);
+	agentModule->postprocessFrame( _timeStep , _timeStep, 1);
 
 	/*
 	for (int i = 0; i < _numAgt; i++)
@@ -883,13 +968,16 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 	Matrix xNew(4*_numAgt);
 	// double speedTrav = 0;
 	for (int a = 0; a < _numAgt; a++){
-		Matrix m = Util::sampleGaussian(zeros(4),m_identity(4));
+		// this runs for every agent of every ensemble member, so the noise is kept off the heap
+		FixedMatrix<4,1> m = (randomNumberGenerator == NULL) ?
+				Util::sampleGaussian(FixedMatrix<4,1>::zeros(), FixedMatrix<4,4>::identity()) :
+				Util::sampleGaussian(FixedMatrix<4,1>::zeros(), FixedMatrix<4,4>::identity(), *randomNumberGenerator);
 		if (m1[0] == m1[1] && m1[1] == 0){
-			m = zeros(4);
+			m.reset();
 		}
 
 
-		tempAgent = this->getEngineInterface()->getAgents().at(a);
+		tempAgent = engine->getAgents().at(a);
 
 		// std::cout << "Agent goal is " << tempAgent->currentGoal().targetLocation << std::endl;
 		// speedTrav = ((tempAgent->position()-Util::Point(x[4*a], 0.0f, x[4*a+1])).length()/_timeStep);
@@ -943,14 +1031,6 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 
 	}
 
-	_f_hat_calls = _f_hat_calls + 1;
-	if ( _f_hat_calls > 25 )
-	{
-		// tempAgent = this->getEngineInterface()->getAgents().at(-1);
-	}
-#ifdef _DEBUG_ENTROPY
-	std::cout << "*****************************Calls thus far " << _f_hat_calls << std::endl;
-#endif
 	/*
 	for (int i = this->getEngineInterface()->getAgents().size(); i > 0; i--)
 	{
@@ -962,6 +1042,195 @@ Matrix CompositeTechniqueEntropy::m_fHat(const Matrix& x, const Matrix& u, const
 	return xNew;
 }
 
+//
+// moduleKeepsGlobalState() - true for the agent modules that keep their engine, spatial database or agents in globals;
+// loading such a module into a worker engine would re-point those globals away from the simulation engine.
+//
+static bool moduleKeepsGlobalState(const std::string & moduleName)
+{
+	return (moduleName == "reactiveAI");
+}
+
+//
+// _createWorkers() - creates one engine per thread with the agent module, the obstacles and the agents of the
+// simulation, and one random number generator per ensemble member.
+//
+void CompositeTechniqueEntropy::_createWorkers()
+{
+	_destroyWorkers();
+
+	if (_agentModule == NULL) {
+		throw Util::GenericException("CompositeTechniqueEntropy: the agent module \"" + _agentModuleName + "\" given by the scenarioAI option is not loaded.");
+	}
+
+	if (moduleKeepsGlobalState(_agentModuleName)) {
+		std::cerr << "WARNING: CompositeTechniqueEntropy: the agent module \"" << _agentModuleName << "\" keeps its state in globals, so the ensemble is propagated on the simulation engine instead of " << _numThreads << " worker engines.\n";
+		return;
+	}
+
+	// the worker engines only load the agent module; the engine driver is shared, but worker engines never use it.
+	_workerOptions = this->getEngineInterface()->getOptions();
+	_workerOptions.engineOptions.startupModules.clear();
+	_workerOptions.engineOptions.startupModules.insert(_agentModuleName);
+
+	const std::set<SteerLib::ObstacleInterface*> & obstacles = this->getEngineInterface()->getObstacles();
+	for (unsigned int i = 0; i < _numThreads; i++)
+	{
+		Worker worker;
+		worker.engine = new SimulationEngine();
+		worker.agentModule = NULL;
+		_workers.push_back(worker);
+
+		SimulationEngine * engine = _workers.back().engine;
+		engine->init(&_workerOptions, this->getEngineInterface()->getEngineController());
+		_workers.back().agentModule = engine->getModule(_agentModuleName);
+
+		// obstacles are only read during the simulation, so the workers share the obstacles of the simulation.
+		std::set<SteerLib::ObstacleInterface*>::const_iterator obstacle;
+		for (obstacle = obstacles.begin(); obstacle != obstacles.end(); ++obstacle)
+		{
+			engine->addObstacle(*obstacle);
+			engine->getSpatialDatabase()->addObject(*obstacle, (*obstacle)->getBounds());
+		}
+
+		engine->initializeSimulation();
+		engine->preprocessSimulation();
+		for (int a = 0; a < _numAgt; a++)
+		{
+			engine->createAgent(SteerLib::AgentInitialConditions(), _workers.back().agentModule);
+		}
+	}
+
+	for (int i = 0; i < _numSamples; i++)
+	{
+		_sampleRandomNumberGenerators.push_back(new MTRand(_randomSeed + i));
+	}
+
+	if (_workers.size() > 1)
+	{
+		_taskManager = new Util::ThreadedTaskManager((unsigned int)_workers.size());
+	}
+}
+
+//
+// _destroyWorkers() - finishes and deletes the worker engines and the random number generators.
+//
+void CompositeTechniqueEntropy::_destroyWorkers()
+{
+	delete _taskManager;
+	_taskManager = NULL;
+
+	for (unsigned int i = 0; i < _workers.size(); i++)
+	{
+		SimulationEngine * engine = _workers[i].engine;
+		try {
+			if (engine->isSimulationRunning())
+			{
+				engine->postprocessSimulation();
+				engine->destroyAllAgentsFromModule(_workers[i].agentModule);
+				engine->cleanupSimulation();
+			}
+			// the obstacles belong to the simulation, not to the worker.
+			engine->removeAllObstacles();
+			engine->finish();
+		}
+		catch (std::exception & e) {
+			std::cerr << "WARNING: CompositeTechniqueEntropy could not finish a worker engine properly:\n" << e.what() << "\n";
+		}
+		delete engine;
+	}
+	_workers.clear();
+
+	for (unsigned int i = 0; i < _sampleRandomNumberGenerators.size(); i++)
+	{
+		delete _sampleRandomNumberGenerators[i];
+	}
+	_sampleRandomNumberGenerators.clear();
+}
+
+//
+// _propagate() - runs the given tasks on the worker engines, and throws the first error of any task.
+//
+void CompositeTechniqueEntropy::_propagate(std::vector<PropagationTask> & tasks)
+{
+	for (unsigned int i = 0; i < tasks.size(); i++)
+	{
+		tasks[i].technique = this;
+		tasks[i].sampleIndex = i;
+		tasks[i].results.clear();
+		tasks[i].errorMessage = "";
+	}
+
+	if (_taskManager == NULL)
+	{
+		for (unsigned int i = 0; i < tasks.size(); i++)
+		{
+			_runPropagationTask(0, &tasks[i]);
+		}
+	}
+	else
+	{
+		for (unsigned int i = 0; i < tasks.size(); i++)
+		{
+			Util::Task task;
+			task.function = &CompositeTechniqueEntropy::_runPropagationTask;
+			task.data = &tasks[i];
+			_taskManager->addTask(task, (i+1 == tasks.size()));
+		}
+		_taskManager->waitForAllTasksToComplete();
+	}
+
+	for (unsigned int i = 0; i < tasks.size(); i++)
+	{
+		if (tasks[i].errorMessage != "")
+		{
+			throw Util::GenericException("CompositeTechniqueEntropy: propagating ensemble member " + Util::toString(i) + " failed:\n" + tasks[i].errorMessage);
+		}
+	}
+}
+
+//
+// _propagateEnsemble() - the control update of the Ensemble Kalman Filter on the worker engines, one task per ensemble member.
+//
+void CompositeTechniqueEntropy::_propagateEnsemble(std::vector<Matrix> & X)
+{
+	std::vector<PropagationTask> tasks(X.size());
+	for (unsigned int i = 0; i < X.size(); i++)
+	{
+		tasks[i].addNoise = true;
+		tasks[i].states.push_back(&X[i]);
+	}
+	_propagate(tasks);
+
+	for (unsigned int i = 0; i < X.size(); i++)
+	{
+		X[i] = tasks[i].results[0];
+	}
+}
+
+//
+// _runPropagationTask() - the task executed by the worker threads; each worker thread only uses its own engine, and
+// each task only uses the random number generator of its ensemble member.
+//
+void CompositeTechniqueEntropy::_runPropagationTask(unsigned int threadIndex, void * data)
+{
+	PropagationTask * task = (PropagationTask*)data;
+	CompositeTechniqueEntropy * technique = task->technique;
+	Worker & worker = technique->_workers[threadIndex];
+	MTRand * randomNumberGenerator = technique->_sampleRandomNumberGenerators[task->sampleIndex];
+
+	try {
+		for (unsigned int i = 0; i < task->states.size(); i++)
+		{
+			Matrix m1 = task->addNoise ? Util::sampleGaussian(technique->M_DIM, *randomNumberGenerator) : zeros(technique->M_DIM);
+			task->results.push_back(technique->_propagateSample(*task->states[i], m1, worker.engine, worker.agentModule, randomNumberGenerator));
+		}
+	}
+	catch (std::exception & e) {
+		task->errorMessage = e.what();
+	}
+}
+
 //Matrix CompositeTechniqueEntropy::m_fHatData(const Matrix& x, const Matrix& u, const Matrix& m1)
 //{
 	// MUBBASIR TODO -- I COMMENTED OUT THIS FUNCTION 
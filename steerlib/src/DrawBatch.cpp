@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file DrawBatch.cpp
+/// @brief Implements Util::ViewFrustum and Util::DrawBatch.
+
+#ifdef ENABLE_GUI
+
+#include <math.h>
+#include "util/DrawBatch.h"
+
+using namespace Util;
+
+
+namespace {
+
+	/// A shape in its own coordinate system: +x is its forward direction, +y is up, and it is scaled by its radius.
+	struct Mesh {
+		std::vector<float> positions;
+		std::vector<float> normals;
+		/// For each vertex, true if it takes the color of the shape, or false if it is always colored fixedColors.
+		std::vector<bool> usesShapeColor;
+		std::vector<Color> fixedColors;
+		std::vector<GLuint> indices;
+
+		GLuint addVertex(float x, float y, float z, float nx, float ny, float nz, bool shapeColor, const Color & fixedColor = Color(0.0f, 0.0f, 0.0f)) {
+			positions.push_back(x);  positions.push_back(y);  positions.push_back(z);
+			normals.push_back(nx);  normals.push_back(ny);  normals.push_back(nz);
+			usesShapeColor.push_back(shapeColor);
+			fixedColors.push_back(fixedColor);
+			return (GLuint)(usesShapeColor.size() - 1);
+		}
+		void addTriangle(GLuint a, GLuint b, GLuint c) {
+			indices.push_back(a);  indices.push_back(b);  indices.push_back(c);
+		}
+		unsigned int getNumVertices() const { return (unsigned int)usesShapeColor.size(); }
+	};
+
+	/// Adds a vertical prism of the given radius and height, without caps; the side normals point outwards.
+	void addPrism(Mesh & mesh, unsigned int numSides, float radius, float ymin, float ymax, bool shapeColor, const Color & fixedColor)
+	{
+		GLuint first = mesh.getNumVertices();
+		for (unsigned int i = 0; i < numSides; i++) {
+			float angle = 2.0f * (float)M_PI * i / numSides;
+			float c = cosf(angle), s = sinf(angle);
+			mesh.addVertex(radius*c, ymin, radius*s, c, 0.0f, s, shapeColor, fixedColor);
+			mesh.addVertex(radius*c, ymax, radius*s, c, 0.0f, s, shapeColor, fixedColor);
+		}
+		for (unsigned int i = 0; i < numSides; i++) {
+			GLuint bottom = first + 2*i, top = bottom + 1;
+			GLuint nextBottom = first + 2*((i+1) % numSides), nextTop = nextBottom + 1;
+			mesh.addTriangle(bottom, top, nextTop);
+			mesh.addTriangle(bottom, nextTop, nextBottom);
+		}
+	}
+
+	//
+	// getAgentDiscMesh() - the shape of DrawLib's agent display list, with fewer sides: a cylinder of height 2 with an arrow on its top.
+	//
+	const Mesh & getAgentDiscMesh()
+	{
+		static Mesh mesh;
+		if (mesh.getNumVertices() == 0) {
+			const unsigned int numSides = 16;
+			const float height = 2.0f;
+			addPrism(mesh, numSides, 1.0f, 0.0f, height, true, Color(0.0f, 0.0f, 0.0f));
+
+			GLuint first = mesh.getNumVertices();
+			for (unsigned int i = 0; i < numSides; i++) {
+				float angle = 2.0f * (float)M_PI * i / numSides;
+				mesh.addVertex(cosf(angle), height, sinf(angle), 0.0f, 1.0f, 0.0f, true);
+			}
+			for (unsigned int i = 1; i + 1 < numSides; i++) {
+				mesh.addTriangle(first, first + i, first + i + 1);
+			}
+
+			const float arrowHeight = height + 0.04f;
+			GLuint tip = mesh.addVertex(1.0f, arrowHeight, 0.0f, 0.0f, 1.0f, 0.0f, false);
+			GLuint left = mesh.addVertex(-0.6f, arrowHeight, -0.5f, 0.0f, 1.0f, 0.0f, false);
+			GLuint back = mesh.addVertex(-0.62f, arrowHeight, 0.0f, 0.0f, 1.0f, 0.0f, false);
+			GLuint right = mesh.addVertex(-0.6f, arrowHeight, 0.5f, 0.0f, 1.0f, 0.0f, false);
+			mesh.addTriangle(tip, left, back);
+			mesh.addTriangle(tip, back, right);
+		}
+		return mesh;
+	}
+
+	//
+	// getFlagMesh() - the shape of DrawLib's flag display list, with a six-sided pole and a pyramid in place of the ball.
+	//
+	const Mesh & getFlagMesh()
+	{
+		static Mesh mesh;
+		if (mesh.getNumVertices() == 0) {
+			const Color poleColor(0.6f, 0.6f, 0.6f);
+
+			GLuint top = mesh.addVertex(0.0f, 1.05f, 0.0f, 0.0f, 0.0f, 1.0f, true);
+			GLuint tip = mesh.addVertex(0.5f, 0.9f, 0.0f, 0.0f, 0.0f, 1.0f, true);
+			GLuint bottom = mesh.addVertex(0.0f, 0.75f, 0.0f, 0.0f, 0.0f, 1.0f, true);
+			GLuint back = mesh.addVertex(-0.02f, 0.9f, 0.0f, 0.0f, 0.0f, 1.0f, true);
+			mesh.addTriangle(top, tip, bottom);
+			mesh.addTriangle(top, bottom, back);
+
+			addPrism(mesh, 6, 0.05f, 0.0f, 1.1f, false, poleColor);
+
+			GLuint apex = mesh.addVertex(0.0f, 1.17f, 0.0f, 0.0f, 1.0f, 0.0f, false, poleColor);
+			GLuint first = mesh.getNumVertices();
+			for (unsigned int i = 0; i < 4; i++) {
+				float angle = 0.5f * (float)M_PI * i;
+				mesh.addVertex(0.07f * cosf(angle), 1.1f, 0.07f * sinf(angle), cosf(angle), 0.0f, sinf(angle), false, poleColor);
+			}
+			for (unsigned int i = 0; i < 4; i++) {
+				mesh.addTriangle(apex, first + (i+1) % 4, first + i);
+			}
+		}
+		return mesh;
+	}
+
+	inline unsigned char toByte(float colorComponent)
+	{
+		if (colorComponent <= 0.0f) return 0;
+		if (colorComponent >= 1.0f) return 255;
+		return (unsigned char)(colorComponent * 255.0f + 0.5f);
+	}
+
+} // end anonymous namespace
+
+
+//
+// extractFromCurrentView() - the planes are the rows of (projection * modelview) added to or subtracted from its last row.
+//
+void ViewFrustum::extractFromCurrentView()
+{
+	GLfloat modelView[16], projection[16], m[16];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+
+	// openGL matrices are column-major: element (row, col) is at [col*4 + row].
+	for (int col = 0; col < 4; col++) {
+		for (int row = 0; row < 4; row++) {
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++) {
+				sum += projection[k*4 + row] * modelView[col*4 + k];
+			}
+			m[col*4 + row] = sum;
+		}
+	}
+
+	for (int i = 0; i < 3; i++) {
+		for (int col = 0; col < 4; col++) {
+			_planes[2*i][col] = m[col*4 + 3] + m[col*4 + i];
+			_planes[2*i+1][col] = m[col*4 + 3] - m[col*4 + i];
+		}
+	}
+
+	for (int i = 0; i < 6; i++) {
+		float length = sqrtf(_planes[i][0]*_planes[i][0] + _planes[i][1]*_planes[i][1] + _planes[i][2]*_planes[i][2]);
+		if (length > 0.0f) {
+			for (int col = 0; col < 4; col++) {
+				_planes[i][col] /= length;
+			}
+		}
+	}
+}
+
+bool ViewFrustum::intersectsSphere(const Point & center, float radius) const
+{
+	for (int i = 0; i < 6; i++) {
+		if (_planes[i][0]*center.x + _planes[i][1]*center.y + _planes[i][2]*center.z + _planes[i][3] < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ViewFrustum::intersectsBox(const AxisAlignedBox & box) const
+{
+	for (int i = 0; i < 6; i++) {
+		// the corner of the box that is farthest along the plane normal.
+		float x = (_planes[i][0] >= 0.0f) ? box.xmax : box.xmin;
+		float y = (_planes[i][1] >= 0.0f) ? box.ymax : box.ymin;
+		float z = (_planes[i][2] >= 0.0f) ? box.zmax : box.zmin;
+		if (_planes[i][0]*x + _planes[i][1]*y + _planes[i][2]*z + _planes[i][3] < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void DrawBatch::addAgentDisc(const Point & pos, const Vector & dir, float radius, const Color & color)
+{
+	Shape shape;
+	shape.position = pos;
+	float length = sqrtf(dir.x*dir.x + dir.z*dir.z);
+	shape.cosAngle = (length > 0.0f) ? dir.x / length : 1.0f;
+	shape.sinAngle = (length > 0.0f) ? dir.z / length : 0.0f;
+	shape.radius = radius;
+	shape.color = color;
+	_agentDiscs.push_back(shape);
+}
+
+void DrawBatch::addFlag(const Point & loc, const Color & color, float scale)
+{
+	Shape shape;
+	shape.position = loc;
+	shape.cosAngle = 1.0f;
+	shape.sinAngle = 0.0f;
+	shape.radius = scale;
+	shape.color = color;
+	_flags.push_back(shape);
+}
+
+
+void DrawBatch::draw(const ViewFrustum & frustum)
+{
+	_vertices.clear();
+	_normals.clear();
+	_colors.clear();
+	_indices.clear();
+	_numShapesDrawn = 0;
+
+	_addShapes(_agentDiscs, true, frustum);
+	_addShapes(_flags, false, frustum);
+
+	if (_indices.empty()) {
+		return;
+	}
+
+	// like the display lists of DrawLib, the shapes are not back-face culled.
+	glPushAttrib(GL_ENABLE_BIT);
+	glDisable(GL_CULL_FACE);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	{
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, &_vertices[0]);
+		glNormalPointer(GL_FLOAT, 0, &_normals[0]);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, &_colors[0]);
+		glDrawElements(GL_TRIANGLES, (GLsizei)_indices.size(), GL_UNSIGNED_INT, &_indices[0]);
+	}
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+
+//
+// _addShapes() - transforms the mesh of every visible shape into the vertex arrays.
+//
+void DrawBatch::_addShapes(const std::vector<Shape> & shapes, bool isAgentDisc, const ViewFrustum & frustum)
+{
+	const Mesh & mesh = isAgentDisc ? getAgentDiscMesh() : getFlagMesh();
+	const unsigned int numMeshVertices = mesh.getNumVertices();
+	// bounding spheres of the meshes, relative to the radius of the shape.
+	const float boundsCenterHeight = isAgentDisc ? 1.0f : 0.58f;
+	const float boundsRadius = isAgentDisc ? 1.42f : 0.65f;
+
+	for (unsigned int i = 0; i < shapes.size(); i++) {
+		const Shape & shape = shapes[i];
+		const float r = shape.radius;
+		if (!frustum.intersectsSphere(Point(shape.position.x, shape.position.y + r * boundsCenterHeight, shape.position.z), r * boundsRadius)) {
+			continue;
+		}
+		_numShapesDrawn++;
+
+		GLuint firstVertex = (GLuint)(_vertices.size() / 3);
+		for (unsigned int v = 0; v < numMeshVertices; v++) {
+			const float * p = &mesh.positions[3*v];
+			const float * n = &mesh.normals[3*v];
+			_vertices.push_back(shape.position.x + r * (p[0] * shape.cosAngle - p[2] * shape.sinAngle));
+			_vertices.push_back(shape.position.y + r * p[1]);
+			_vertices.push_back(shape.position.z + r * (p[0] * shape.sinAngle + p[2] * shape.cosAngle));
+			_normals.push_back(n[0] * shape.cosAngle - n[2] * shape.sinAngle);
+			_normals.push_back(n[1]);
+			_normals.push_back(n[0] * shape.sinAngle + n[2] * shape.cosAngle);
+			const Color & color = mesh.usesShapeColor[v] ? shape.color : mesh.fixedColors[v];
+			_colors.push_back(toByte(color.r));
+			_colors.push_back(toByte(color.g));
+			_colors.push_back(toByte(color.b));
+			_colors.push_back(255);
+		}
+		for (unsigned int j = 0; j < mesh.indices.size(); j++) {
+			_indices.push_back(firstVertex + mesh.indices[j]);
+		}
+	}
+}
+
+#endif // ifdef ENABLE_GUI
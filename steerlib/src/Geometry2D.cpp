@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file Geometry2D.cpp
+/// @brief Implements the batch geometry functions declared in Geometry2D.h.
+///
+/// Each function processes four vectors at a time with SSE, and the remaining vectors (or all of them, where SSE2
+/// is not available) one at a time.  Both paths use the same operations in the same order (sqrt and division are
+/// exactly rounded in SSE as well), so they give the same results as the inline functions in Geometry2D.h.
+
+#include "util/Geometry2D.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define UTIL_GEOMETRY_2D_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+using namespace Util;
+
+
+void Util::normalize2D(const float * x, const float * z, float * outX, float * outZ, size_t n)
+{
+	size_t i = 0;
+#ifdef UTIL_GEOMETRY_2D_USE_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= n; i += 4) {
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		__m128 lengthInv = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vz, vz))));
+		_mm_storeu_ps(outX + i, _mm_mul_ps(lengthInv, vx));
+		_mm_storeu_ps(outZ + i, _mm_mul_ps(lengthInv, vz));
+	}
+#endif
+	for (; i < n; i++) {
+		Vector2D vec = normalize(Vector2D(x[i], z[i]));
+		outX[i] = vec.x;
+		outZ[i] = vec.z;
+	}
+}
+
+void Util::dot2D(const float * x1, const float * z1, const float * x2, const float * z2, float * out, size_t n)
+{
+	size_t i = 0;
+#ifdef UTIL_GEOMETRY_2D_USE_SSE
+	for (; i + 4 <= n; i += 4) {
+		__m128 products = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x1 + i), _mm_loadu_ps(x2 + i)), _mm_mul_ps(_mm_loadu_ps(z1 + i), _mm_loadu_ps(z2 + i)));
+		_mm_storeu_ps(out + i, products);
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = dot(Vector2D(x1[i], z1[i]), Vector2D(x2[i], z2[i]));
+	}
+}
+
+void Util::length2D(const float * x, const float * z, float * out, size_t n)
+{
+	size_t i = 0;
+#ifdef UTIL_GEOMETRY_2D_USE_SSE
+	for (; i + 4 <= n; i += 4) {
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		_mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vz, vz))));
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = Vector2D(x[i], z[i]).length();
+	}
+}
+
+void Util::rightSideInXZPlane2D(const float * x, const float * z, float * outX, float * outZ, size_t n)
+{
+	size_t i = 0;
+#ifdef UTIL_GEOMETRY_2D_USE_SSE
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= n; i += 4) {
+		// load both inputs before storing, in case the outputs are the same arrays
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		_mm_storeu_ps(outX + i, _mm_xor_ps(vz, signMask));
+		_mm_storeu_ps(outZ + i, vx);
+	}
+#endif
+	for (; i < n; i++) {
+		Vector2D vec = rightSideInXZPlane(Vector2D(x[i], z[i]));
+		outX[i] = vec.x;
+		outZ[i] = vec.z;
+	}
+}
+
+size_t Util::circleOverlapsCircle2D(const Vector2D & center, float radius, const float * x, const float * z, const float * radii, unsigned char * overlaps, size_t n)
+{
+	size_t numOverlaps = 0;
+	size_t i = 0;
+#ifdef UTIL_GEOMETRY_2D_USE_SSE
+	const __m128 centerX = _mm_set1_ps(center.x);
+	const __m128 centerZ = _mm_set1_ps(center.z);
+	const __m128 r = _mm_set1_ps(radius);
+	for (; i + 4 <= n; i += 4) {
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), centerX);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), centerZ);
+		__m128 distSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+		__m128 distThreshold = _mm_add_ps(r, _mm_loadu_ps(radii + i));
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(distSquared, _mm_mul_ps(distThreshold, distThreshold)));
+		for (unsigned int lane = 0; lane < 4; lane++) {
+			overlaps[i + lane] = (unsigned char)((mask >> lane) & 1);
+			numOverlaps += overlaps[i + lane];
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		overlaps[i] = circleOverlapsCircle2D(center, radius, Vector2D(x[i], z[i]), radii[i]) ? 1 : 0;
+		numOverlaps += overlaps[i];
+	}
+	return numOverlaps;
+}
@@ -21,6 +21,8 @@
 #include "interfaces/AgentInterface.h"
 #include "griddatabase/GridDatabase2D.h"
 #include "griddatabase/GridDatabasePlanningDomain.h"
+#include "griddatabase/GridDatabaseRegionSampler.h"
+#include "obstacles/GridMapObstacle.h"
 
 using namespace std;
 using namespace SteerLib;
@@ -47,6 +49,7 @@ GridDatabase2D::GridDatabase2D(float xmin, float xmax, float zmin, float zmax, u
 	_zCellSize = _zGridSize / ((float)numZCells);
 	_maxItemsPerCell = maxItemsPerCell;
 	_drawGrid = drawGrid;
+	_randomNumberGenerator = new MTRand(2);
 	// std::cout << "Creating grid database: " << this << std::endl;
 
 	_allocateDatabase();
@@ -70,6 +73,7 @@ GridDatabase2D::GridDatabase2D(const Point & origin2D, float xExtent, float zExt
 	_zCellSize = _zGridSize / ((float)numZCells);
 	_maxItemsPerCell = maxItemsPerCell;
 	_drawGrid = drawGrid;
+	_randomNumberGenerator = new MTRand(2);
 
 	_allocateDatabase();
 }
@@ -82,6 +86,7 @@ GridDatabase2D::~GridDatabase2D()
 {
 	delete [] _basePtr;
 	delete [] _cells;
+	delete _randomNumberGenerator;
 }
 
 
@@ -119,6 +124,18 @@ void GridDatabase2D::clearDatabase()
 		// of astar lib...  is traversal cost a fixed cost to add, or is it a multiplicative factor?
 		_cells[i].clear();
 	}
+	_obstacleLayers.clear();
+}
+
+
+size_t GridDatabase2D::getMemoryUsage()
+{
+	size_t numTotalCells = (size_t)_xNumCells * (size_t)_zNumCells;
+	size_t numBytes = numTotalCells * (sizeof(GridCell) + _maxItemsPerCell * sizeof(SpatialDatabaseItemPtr));
+	for (unsigned int i = 0; i < _obstacleLayers.size(); i++) {
+		numBytes += _obstacleLayers[i]->getBitmapSizeInBytes();
+	}
+	return numBytes;
 }
 
 // Rounds the given float to the nearest integer if it is in the specified error range.
@@ -180,6 +197,50 @@ inline bool GridDatabase2DPrivate::_clampSpatialBoundsToIndexRange(float xmin, f
 }
 
 
+//
+// asObstacleLayer() - returns the item as a GridMapObstacle, or NULL if it is any other kind of item.
+//
+static inline GridMapObstacle * asObstacleLayer( SpatialDatabaseItemPtr item )
+{
+	if (item->getSpatialDatabaseItemType() != SPATIAL_DATABASE_ITEM_OBSTACLE) return NULL;
+	return dynamic_cast<GridMapObstacle*>(item->asObstacle());
+}
+
+
+//
+// _addObstacleLayerTraversalCost() - adds sign * the layer's traversal cost to each grid cell that contains a blocked map cell.
+//
+void GridDatabase2DPrivate::_addObstacleLayerTraversalCost(GridMapObstacle * layer, float sign)
+{
+	const AxisAlignedBox & bounds = layer->getBounds();
+	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
+	if (_clampSpatialBoundsToIndexRange(bounds.xmin, bounds.xmax, bounds.zmin, bounds.zmax, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex) == false) {
+		return;
+	}
+
+	float traversalCost = sign * layer->getTraversalCost();
+	for (unsigned int i=xMinIndex; i<=xMaxIndex; i++) {
+		unsigned int cellIndex = (i * _zNumCells) + zMinIndex;
+		for (unsigned int j=zMinIndex; j<=zMaxIndex; j++) {
+			if (_obstacleLayerIsInRange(layer, i, i, j, j)) {
+				_cells[cellIndex]._traversalCost += traversalCost;
+			}
+			cellIndex++;
+		}
+	}
+}
+
+
+//
+// _obstacleLayerIsInRange() - tests the spatial extent of the range of grid cells against the layer's bitmap.
+//
+bool GridDatabase2DPrivate::_obstacleLayerIsInRange(GridMapObstacle * layer, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex)
+{
+	return layer->isRegionBlocked(_xOrigin + xMinIndex * _xCellSize, _xOrigin + (xMaxIndex + 1) * _xCellSize,
+		_zOrigin + zMinIndex * _zCellSize, _zOrigin + (zMaxIndex + 1) * _zCellSize);
+}
+
+
 //
 // addObject() - adds the given item to the database.  Each grid cell that overlaps
 //               "newBounds" will then contain a reference to the item.
@@ -192,6 +253,15 @@ void GridDatabase2D::addObject( SpatialDatabaseItemPtr item, const AxisAlignedBo
 	{
 		throw GenericException("Invalid agent bounds. Bounds are NaN");
 	}
+
+	// a grid map is kept in a list of layers, and only its traversal cost goes into the cells.
+	GridMapObstacle * layer = asObstacleLayer(item);
+	if (layer != NULL) {
+		_obstacleLayers.push_back(layer);
+		_addObstacleLayerTraversalCost(layer, 1.0f);
+		return;
+	}
+
 	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
 	if (_clampSpatialBoundsToIndexRange(newBounds.xmin, newBounds.xmax, newBounds.zmin, newBounds.zmax, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex) == false) {
 		// if we get false here, the object's bounds are completely outside the database anyway.
@@ -221,6 +291,17 @@ void GridDatabase2D::addObject( SpatialDatabaseItemPtr item, const AxisAlignedBo
 //
 void GridDatabase2D::removeObject( SpatialDatabaseItemPtr item, const AxisAlignedBox &oldBounds )
 {
+	GridMapObstacle * layer = asObstacleLayer(item);
+	if (layer != NULL) {
+		std::vector<GridMapObstacle*>::iterator iter = std::find(_obstacleLayers.begin(), _obstacleLayers.end(), layer);
+		if (iter == _obstacleLayers.end()) {
+			throw GenericException("Tried to remove a grid map obstacle from the grid database, but it did not exist there in the first place.");
+		}
+		_obstacleLayers.erase(iter);
+		_addObstacleLayerTraversalCost(layer, -1.0f);
+		return;
+	}
+
 	// convert the spatial bounds of the object into index bounds
 	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
 	if (_clampSpatialBoundsToIndexRange(oldBounds.xmin, oldBounds.xmax, oldBounds.zmin, oldBounds.zmax, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex) == false) {
@@ -286,6 +367,96 @@ void GridDatabase2D::getItemsInRange(set<SpatialDatabaseItemPtr> & neighborList,
 			cellIndex++;
 		}
 	}
+
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+			neighborList.insert(_obstacleLayers[i]);
+		}
+	}
+}
+
+
+//
+// getAgentsAndObstaclesInRange() - splits the items by their type tag straight into the two output lists, then sorts
+//                                  each list by address so that duplicates (items that overlap several cells) can be
+//                                  removed and the order matches an STL set.  AgentInterface and ObstacleInterface
+//                                  only derive from SpatialDatabaseItem, so their addresses sort like the items do.
+//                                  The callers keep their lists from one query to the next, so a query does not
+//                                  allocate, and concurrent queries (e.g. the batch threads of rvo2AI) share nothing.
+//
+void GridDatabase2D::getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude)
+{
+	agents.clear();
+	obstacles.clear();
+
+	unsigned int xMinIndex=0, xMaxIndex=0, zMinIndex=0, zMaxIndex=0;
+	_clampSpatialBoundsToIndexRange(xmin, xmax, zmin, zmax, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex);
+
+	for (unsigned int i=xMinIndex; i<=xMaxIndex; i++) {
+		unsigned int cellIndex = getCellIndexFromGridCoords(i,zMinIndex);
+		for (unsigned int j=zMinIndex; j<=zMaxIndex; j++) {
+			GridCell & cell = _cells[cellIndex];
+			for (unsigned int k=0, numFound=0; (k < _maxItemsPerCell) && (numFound < cell._numItems); k++) {
+				SpatialDatabaseItemPtr item = cell._items[k];
+				if (item == NULL) continue;
+				numFound++;
+				if (item == exclude) continue;
+				switch (item->getSpatialDatabaseItemType()) {
+					case SPATIAL_DATABASE_ITEM_AGENT:
+						agents.push_back(item->asAgent());
+						break;
+					case SPATIAL_DATABASE_ITEM_OBSTACLE:
+						obstacles.push_back(item->asObstacle());
+						break;
+					default:
+						break;
+				}
+			}
+			cellIndex++;
+		}
+	}
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+			obstacles.push_back(_obstacleLayers[i]);
+		}
+	}
+
+	std::sort(agents.begin(), agents.end());
+	agents.erase(std::unique(agents.begin(), agents.end()), agents.end());
+	std::sort(obstacles.begin(), obstacles.end());
+	obstacles.erase(std::unique(obstacles.begin(), obstacles.end()), obstacles.end());
+}
+
+
+//
+// overlapsAnyItem() - tests the circle against every item in the overlapping grid cells, stopping at the first overlap.
+//                     items referenced by several cells may be tested more than once, which is cheaper than building a set.
+//
+bool GridDatabase2D::overlapsAnyItem(const Point & p, float radius, bool excludeAgents)
+{
+	unsigned int xMinIndex=0, xMaxIndex=0, zMinIndex=0, zMaxIndex=0;
+	if (_clampSpatialBoundsToIndexRange(p.x - radius, p.x + radius, p.z - radius, p.z + radius, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex) == false) {
+		return false;
+	}
+
+	for (unsigned int i=xMinIndex; i<=xMaxIndex; i++) {
+		unsigned int cellIndex = getCellIndexFromGridCoords(i,zMinIndex);
+		for (unsigned int j=zMinIndex; j<=zMaxIndex; j++) {
+			GridCell & cell = _cells[cellIndex];
+			for (unsigned int k=0, numFound=0; (k < _maxItemsPerCell) && (numFound < cell._numItems); k++) {
+				SpatialDatabaseItemPtr item = cell._items[k];
+				if (item == NULL) continue;
+				numFound++;
+				if (excludeAgents && item->isAgent()) continue;
+				if (item->overlaps(p, radius)) return true;
+			}
+			cellIndex++;
+		}
+	}
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if (_obstacleLayers[i]->overlaps(p, radius)) return true;
+	}
+	return false;
 }
 
 
@@ -328,7 +499,7 @@ void GridDatabase2D::getItemsInVisualField(set<SpatialDatabaseItemPtr> & neighbo
 					if (neighborList.find(possiblyVisibleObject) != neighborList.end()) continue;
 
 					// (1) if the agent is outside of the radius of the visual field, then forget it
-					Point hisPosition = (dynamic_cast<AgentInterface*>(possiblyVisibleObject))->position();
+					Point hisPosition = possiblyVisibleObject->asAgent()->position();
 					Vector directionToOtherAgent = hisPosition - position;
 					float distSquared = directionToOtherAgent.lengthSquared();
 					if (distSquared > radiusSquared) 
@@ -363,6 +534,13 @@ void GridDatabase2D::getItemsInVisualField(set<SpatialDatabaseItemPtr> & neighbo
 		}
 
 	}
+
+	// like other obstacles, the layers are always known to the agent.
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+			neighborList.insert(_obstacleLayers[i]);
+		}
+	}
 }
 
 void GridDatabase2D::draw()
@@ -412,22 +590,7 @@ void GridDatabase2D::draw()
 			Point c = p + Point(_xCellSize, 0, _zCellSize);
 			Point d = p + Point(_xCellSize, 0, 0);
 
-			// This is new and not documented yet.
-
-			Color color(0.4,0.4,0.4);
-
-
-			for (unsigned int item=0; item < _cells[cellIndex]._numItems; item++)
-			{
-				if ((_cells[cellIndex]._items[item] != NULL))
-				{
-					if (_cells[cellIndex]._items[item]->isAgent())
-						color = color + Color(0,0,0.9f / _maxItemsPerCell);
-					else
-						color = color + Color(0.8f / _maxItemsPerCell,0,0);
-				}
-			}
-			DrawLib::glColor(color);
+			DrawLib::glColor(_getCellColor(cellIndex));
 			DrawLib::drawQuad(a, b, c, d);
 		}
 	}
@@ -437,7 +600,70 @@ void GridDatabase2D::draw()
 #endif // ifdef ENABLE_GUI
 }
 
+bool GridDatabase2D::getCellsToDraw(std::vector<GridCellRenderState> & cells)
+{
+	cells.clear();
+	if (_drawGrid == false)
+		return false;
+
+	GridCellRenderState state;
+	state.bounds.ymin = 0.0f;
+	state.bounds.ymax = 0.0f;
+	for (unsigned int i=0; i < _xNumCells; i++) {
+		for (unsigned int j=0; j < _zNumCells; j++) {
+			state.bounds.xmin = _xOrigin + i * _xCellSize;
+			state.bounds.xmax = state.bounds.xmin + _xCellSize;
+			state.bounds.zmin = _zOrigin + j * _zCellSize;
+			state.bounds.zmax = state.bounds.zmin + _zCellSize;
+			state.color = _getCellColor(getCellIndexFromGridCoords(i, j));
+			cells.push_back(state);
+		}
+	}
+	return true;
+}
+
+Color GridDatabase2D::_getCellColor(unsigned int cellIndex)
+{
+	Color color(0.4f, 0.4f, 0.4f);
+	for (unsigned int item=0; item < _cells[cellIndex]._numItems; item++)
+	{
+		if ((_cells[cellIndex]._items[item] != NULL))
+		{
+			if (_cells[cellIndex]._items[item]->isAgent())
+				color = color + Color(0,0,0.9f / _maxItemsPerCell);
+			else
+				color = color + Color(0.8f / _maxItemsPerCell,0,0);
+		}
+	}
+	return color;
+}
+
 bool GridDatabase2D::trace(const Ray & r, float & t, SpatialDatabaseItemPtr &hitObject, SpatialDatabaseItemPtr exclude, bool excludeAgents)
+{
+	// the layers are traced first; then a hit on the items in the cells only counts if it is closer.
+	GridMapObstacle * layerHit = NULL;
+	float layerT = 0.0f;
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		float temp_t;
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayers[i]->intersects(r, temp_t) && ((layerHit == NULL) || (temp_t < layerT))) {
+			layerHit = _obstacleLayers[i];
+			layerT = temp_t;
+		}
+	}
+	if (layerHit == NULL) {
+		return _traceCells(r, t, hitObject, exclude, excludeAgents);
+	}
+
+	Ray shortenedRay = r;
+	shortenedRay.maxt = layerT;
+	if (!_traceCells(shortenedRay, t, hitObject, exclude, excludeAgents)) {
+		t = layerT;
+		hitObject = layerHit;
+	}
+	return true;
+}
+
+bool GridDatabase2D::_traceCells(const Ray & r, float & t, SpatialDatabaseItemPtr &hitObject, SpatialDatabaseItemPtr exclude, bool excludeAgents)
 {
 	// 1. march through grid cells
 	// 2. for each grid cell:
@@ -583,6 +809,17 @@ bool GridDatabase2D::trace(const Ray & r, float & t, SpatialDatabaseItemPtr &hit
 }
 
 bool GridDatabase2D::hasLineOfSight(const Ray & r, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2)
+{
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		float t;
+		if ((_obstacleLayers[i] != exclude1) && (_obstacleLayers[i] != exclude2) && _obstacleLayers[i]->intersects(r, t)) {
+			return false;
+		}
+	}
+	return _hasLineOfSightThroughCells(r, exclude1, exclude2);
+}
+
+bool GridDatabase2D::_hasLineOfSightThroughCells(const Ray & r, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2)
 {
 	// 1. march through grid cells
 	// 2. for each grid cell:
@@ -729,61 +966,17 @@ Point GridDatabase2D::randomPositionWithoutCollisions(float radius, bool exclude
 
 Point GridDatabase2D::randomPositionInRegionWithoutCollisions(const AxisAlignedBox & region, float radius, bool excludeAgents)
 {
-	static MTRand _randomNumberGenerator(2);
-	return randomPositionInRegionWithoutCollisions(region, radius, excludeAgents, _randomNumberGenerator);
+	return randomPositionInRegionWithoutCollisions(region, radius, excludeAgents, *_randomNumberGenerator);
 }
 
 Point GridDatabase2D::randomPositionInRegionWithoutCollisions(const AxisAlignedBox & region, float radius, bool excludeAgents,  MTRand & randomNumberGenerator)
 {
+	// a single position, so only uniform darts; rasterizing the region (up to MAX_NUM_RASTER_CELLS queries) would cost far more.
+	GridDatabaseRegionSampler sampler(this, region, radius, excludeAgents);
 	Point ret(0.0f, 0.0f, 0.0f);
-	bool notFoundYet;
-	unsigned int numTries = 0;
-	float xspan = region.xmax - region.xmin - 2*radius;
-	float zspan = region.zmax - region.zmin - 2*radius;
-
-	do {
-
-		ret.x = region.xmin + radius + ((float)randomNumberGenerator.rand(xspan));
-		ret.y = 0.0f;
-		ret.z = region.zmin + radius + ((float)randomNumberGenerator.rand(zspan));
-
-		// assume this new point has no collisions, until we find out below
-		notFoundYet = false;
-
-		// check if ret collides with anything
-		set<SpatialDatabaseItemPtr> neighbors;
-		neighbors.clear();
-		float _new_radius = radius;
-		getItemsInRange(neighbors, ret.x - _new_radius, ret.x + _new_radius, ret.z - _new_radius, ret.z + _new_radius, NULL);
-
-		set<SpatialDatabaseItemPtr>::iterator neighbor;
-		/*
-		 * increment must be after loop body or (*neighbor)->isAgent()) will be called on an
-		 * element that is beyond the set.
-		 */
-		for (neighbor = neighbors.begin(); neighbor != neighbors.end(); neighbor++)
-		{
-			if ((excludeAgents) && ((*neighbor)->isAgent()))
-			{
-				continue;
-			}
-			notFoundYet = (*neighbor)->overlaps(ret, radius);
-			if (notFoundYet)
-			{
-				break;
-			}
-		}
-		numTries++;
-		if (numTries > 1000)
-		{
-			cerr << "ERROR: trying too hard to find a random position in region.  The region is probably already too dense." << endl;
-			if (numTries > 10000)
-			{
-				throw GenericException("Gave up trying to find a random position in region.");
-			}
-		}
-	} while (notFoundYet);
-
+	if (!sampler.randomPositionFromDarts(randomNumberGenerator, ret, GridDatabaseRegionSampler::NUM_DARTS_AFTER_EXHAUSTED)) {
+		throw GenericException("Gave up trying to find a random position in region.  The region is probably already too dense.");
+	}
 	return ret;
 }
 
@@ -799,7 +992,7 @@ bool GridDatabase2D::randomPositionInRegionWithoutCollisions(const Util::AxisAli
 
 	if ( item->isAgent() )
 	{
-		ai = dynamic_cast<AgentInterface*>(item);
+		ai = item->asAgent();
 		radius = ai->radius();
 		aic = ai->getAgentConditions(ai);
 	}
@@ -29,7 +29,7 @@ bool GridDatabasePlanningDomain::refresh()
 
 bool GridDatabasePlanningDomain::planPath(unsigned int startLocation, unsigned int goalLocation, std::stack<unsigned int> & outputPlan) {
 	BestFirstSearchPlanner<GridDatabasePlanningDomain, unsigned int> gridAStarPlanner;
-
+	_numNodesExpanded = 0;
 
 	gridAStarPlanner.init(this, INT_MAX);
 
@@ -41,7 +41,7 @@ bool GridDatabasePlanningDomain::planPath(unsigned int startLocation, unsigned i
  */
 bool GridDatabasePlanningDomain::planPath(unsigned int startLocation, unsigned int goalLocation, std::stack<unsigned int> & outputPlan, unsigned int maxNodes) {
 	BestFirstSearchPlanner<GridDatabasePlanningDomain, unsigned int> gridAStarPlanner;
-
+	_numNodesExpanded = 0;
 
 	gridAStarPlanner.init(this, maxNodes);
 
@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file GridDatabaseRegionSampler.cpp
+/// @brief Implements the SteerLib::GridDatabaseRegionSampler class.
+
+#include <cmath>
+#include <algorithm>
+
+#include "griddatabase/GridDatabaseRegionSampler.h"
+#include "interfaces/SpatialDataBaseInterface.h"
+#include "mersenne/MersenneTwister.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+GridDatabaseRegionSampler::GridDatabaseRegionSampler(SpatialDataBaseInterface * spatialDatabase, const AxisAlignedBox & region, float radius, bool excludeAgents)
+{
+	_spatialDatabase = spatialDatabase;
+	_region = region;
+	_radius = radius;
+	_excludeAgents = excludeAgents;
+	_rasterized = false;
+
+	// same span that GridDatabase2D has always used for uniform darts.
+	_xmin = region.xmin + radius;
+	_zmin = region.zmin + radius;
+	_xspan = region.xmax - region.xmin - 2*radius;
+	_zspan = region.zmax - region.zmin - 2*radius;
+
+	_cellSize = 0.0f;
+	_cellHalfDiagonal = 0.0f;
+	_xNumCells = 0;
+	_zNumCells = 0;
+}
+
+
+bool GridDatabaseRegionSampler::matches(const AxisAlignedBox & region, float radius, bool excludeAgents) const
+{
+	return (_radius == radius) && (_excludeAgents == excludeAgents) &&
+		(_region.xmin == region.xmin) && (_region.xmax == region.xmax) &&
+		(_region.zmin == region.zmin) && (_region.zmax == region.zmax);
+}
+
+
+bool GridDatabaseRegionSampler::_throwDart(MTRand & randomNumberGenerator, Point & result)
+{
+	result.x = _xmin + ((float)randomNumberGenerator.rand(_xspan));
+	result.y = 0.0f;
+	result.z = _zmin + ((float)randomNumberGenerator.rand(_zspan));
+	return !_spatialDatabase->overlapsAnyItem(result, _radius, _excludeAgents);
+}
+
+
+bool GridDatabaseRegionSampler::randomPosition(MTRand & randomNumberGenerator, Point & result)
+{
+	if (!_rasterized) {
+		// cheap uniform darts first; in sparse regions this behaves exactly like the original rejection sampling.
+		if (randomPositionFromDarts(randomNumberGenerator, result, NUM_DARTS_BEFORE_RASTERIZING)) {
+			return true;
+		}
+		_rasterize();
+	}
+
+	if (!_freeCells.empty()) {
+		unsigned int cellIndex = _freeCells[randomNumberGenerator.randInt((MTRand::uint32)_freeCells.size() - 1)];
+		unsigned int ix = cellIndex / _zNumCells;
+		unsigned int iz = cellIndex - ix * _zNumCells;
+
+		// the cell may be clipped by the end of the valid span.
+		float cellXMin = _xmin + ix * _cellSize;
+		float cellZMin = _zmin + iz * _cellSize;
+		float cellXSize = min(_cellSize, _xmin + _xspan - cellXMin);
+		float cellZSize = min(_cellSize, _zmin + _zspan - cellZMin);
+
+		result.x = cellXMin + ((float)randomNumberGenerator.rand(max(cellXSize, 0.0f)));
+		result.y = 0.0f;
+		result.z = cellZMin + ((float)randomNumberGenerator.rand(max(cellZSize, 0.0f)));
+		return true;
+	}
+
+	// the conservative free cells are exhausted, but small slivers of free space may remain.
+	return randomPositionFromDarts(randomNumberGenerator, result, NUM_DARTS_AFTER_EXHAUSTED);
+}
+
+
+bool GridDatabaseRegionSampler::randomPositionFromDarts(MTRand & randomNumberGenerator, Point & result, unsigned int numDarts)
+{
+	for (unsigned int i=0; i < numDarts; i++) {
+		if (_throwDart(randomNumberGenerator, result)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void GridDatabaseRegionSampler::markOccupied(const Point & position, float radius)
+{
+	if (!_rasterized || _freeCells.empty()) {
+		// before rasterizing, the database itself is the only record of occupied space.
+		return;
+	}
+
+	// any cell whose center is closer than this may contain a position that would overlap the new circle.
+	float clearance = radius + _radius + _cellHalfDiagonal;
+	float clearanceSquared = clearance * clearance;
+
+	int ixMin = max(0, (int)floor((position.x - clearance - _xmin) / _cellSize));
+	int ixMax = min((int)_xNumCells - 1, (int)floor((position.x + clearance - _xmin) / _cellSize));
+	int izMin = max(0, (int)floor((position.z - clearance - _zmin) / _cellSize));
+	int izMax = min((int)_zNumCells - 1, (int)floor((position.z + clearance - _zmin) / _cellSize));
+
+	for (int ix = ixMin; ix <= ixMax; ix++) {
+		float dx = _xmin + (ix + 0.5f) * _cellSize - position.x;
+		for (int iz = izMin; iz <= izMax; iz++) {
+			float dz = _zmin + (iz + 0.5f) * _cellSize - position.z;
+			if (dx*dx + dz*dz < clearanceSquared) {
+				_removeFreeCell(ix * _zNumCells + iz);
+			}
+		}
+	}
+}
+
+
+void GridDatabaseRegionSampler::_rasterize()
+{
+	_rasterized = true;
+	_freeCells.clear();
+	_freeCellSlots.clear();
+
+	if ((_xspan < 0.0f) || (_zspan < 0.0f)) {
+		// the region is smaller than the object being placed.
+		return;
+	}
+
+	// cells of half the radius keep the conservative margin small; grow them if the region is huge.
+	_cellSize = max(_radius * 0.5f, 1e-3f);
+	while ((ceil(_xspan / _cellSize) + 1.0f) * (ceil(_zspan / _cellSize) + 1.0f) > (float)MAX_NUM_RASTER_CELLS) {
+		_cellSize *= 2.0f;
+	}
+	_cellHalfDiagonal = _cellSize * 0.70710678f;
+	_xNumCells = max(1u, (unsigned int)ceil(_xspan / _cellSize));
+	_zNumCells = max(1u, (unsigned int)ceil(_zspan / _cellSize));
+
+	_freeCellSlots.resize(_xNumCells * _zNumCells, -1);
+	_freeCells.reserve(_xNumCells * _zNumCells);
+
+	// a cell is free if a slightly larger circle at its center overlaps nothing; then every position in the cell is valid.
+	float inflatedRadius = _radius + _cellHalfDiagonal;
+	Point center(0.0f, 0.0f, 0.0f);
+	for (unsigned int ix = 0; ix < _xNumCells; ix++) {
+		center.x = _xmin + (ix + 0.5f) * _cellSize;
+		for (unsigned int iz = 0; iz < _zNumCells; iz++) {
+			center.z = _zmin + (iz + 0.5f) * _cellSize;
+			if (!_spatialDatabase->overlapsAnyItem(center, inflatedRadius, _excludeAgents)) {
+				unsigned int cellIndex = ix * _zNumCells + iz;
+				_freeCellSlots[cellIndex] = (int)_freeCells.size();
+				_freeCells.push_back(cellIndex);
+			}
+		}
+	}
+}
+
+
+void GridDatabaseRegionSampler::_removeFreeCell(unsigned int cellIndex)
+{
+	int slot = _freeCellSlots[cellIndex];
+	if (slot < 0) {
+		return;
+	}
+
+	// swap with the last free cell so removal is O(1).
+	unsigned int lastCell = _freeCells.back();
+	_freeCells[slot] = lastCell;
+	_freeCellSlots[lastCell] = slot;
+	_freeCells.pop_back();
+	_freeCellSlots[cellIndex] = -1;
+}
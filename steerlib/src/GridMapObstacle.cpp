@@ -0,0 +1,291 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file GridMapObstacle.cpp
+/// @brief Implements the GridMapObstacle class.
+
+#include <algorithm>
+#include <float.h>
+#include "obstacles/GridMapObstacle.h"
+#include "obstacles/BoxObstacle.h"
+#include "util/DrawLib.h"
+#include "util/GenericException.h"
+
+using namespace SteerLib;
+using namespace Util;
+
+
+GridMapObstacle::GridMapObstacle(float originX, float originZ, float cellSize, unsigned int numCellsX, unsigned int numCellsZ, float traversalCost)
+{
+	if ((numCellsX == 0) || (numCellsZ == 0) || !(cellSize > 0.0f)) {
+		throw GenericException("GridMapObstacle: the map must have at least one cell, and a positive cell size.");
+	}
+	_originX = originX;
+	_originZ = originZ;
+	_cellSize = cellSize;
+	_invCellSize = 1.0f / cellSize;
+	_numCellsX = numCellsX;
+	_numCellsZ = numCellsZ;
+	_wordsPerRow = (numCellsX + 31) / 32;
+	_bits.assign(_wordsPerRow * numCellsZ, 0);
+	_traversalCost = traversalCost;
+	_updateBounds();
+}
+
+void GridMapObstacle::setBlocked(unsigned int x, unsigned int z, bool blocked)
+{
+	unsigned int & word = _bits[z * _wordsPerRow + (x >> 5)];
+	if (blocked) {
+		word |= (1u << (x & 31));
+	}
+	else {
+		word &= ~(1u << (x & 31));
+	}
+}
+
+bool GridMapObstacle::isBlocked(const Util::Point & p) const
+{
+	if ((p.x < _bounds.xmin) || (p.x >= _bounds.xmax) || (p.z < _bounds.zmin) || (p.z >= _bounds.zmax)) {
+		return false;
+	}
+	unsigned int x = std::min((unsigned int)((p.x - _originX) * _invCellSize), _numCellsX - 1);
+	unsigned int z = std::min((unsigned int)((p.z - _originZ) * _invCellSize), _numCellsZ - 1);
+	return isBlocked(x, z);
+}
+
+bool GridMapObstacle::isRegionBlocked(float xmin, float xmax, float zmin, float zmax) const
+{
+	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
+	if (!_clampToCellRange(xmin, xmax, zmin, zmax, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+		return false;
+	}
+
+	// test whole words at a time, masking the cells outside the range in the first and last word of each row
+	unsigned int firstWord = xMinIndex >> 5;
+	unsigned int lastWord = xMaxIndex >> 5;
+	unsigned int firstMask = ~0u << (xMinIndex & 31);
+	unsigned int lastMask = ~0u >> (31 - (xMaxIndex & 31));
+	for (unsigned int z = zMinIndex; z <= zMaxIndex; z++) {
+		const unsigned int * row = &_bits[z * _wordsPerRow];
+		for (unsigned int w = firstWord; w <= lastWord; w++) {
+			unsigned int word = row[w];
+			if (w == firstWord) word &= firstMask;
+			if (w == lastWord) word &= lastMask;
+			if (word != 0) return true;
+		}
+	}
+	return false;
+}
+
+unsigned int GridMapObstacle::getNumBlockedCells() const
+{
+	unsigned int numBlocked = 0;
+	for (unsigned int i = 0; i < _bits.size(); i++) {
+		for (unsigned int word = _bits[i]; word != 0; word &= word - 1) {
+			numBlocked++;
+		}
+	}
+	return numBlocked;
+}
+
+void GridMapObstacle::getBlockedRectangles(std::vector<Util::AxisAlignedBox> & rectangles) const
+{
+	rectangles.clear();
+
+	// each open rectangle is a run [xStart,xEnd) that started in row zStart and continued in every row since.
+	struct Run { unsigned int xStart, xEnd, zStart; };
+	std::vector<Run> openRuns, rowRuns;
+	for (unsigned int z = 0; z <= _numCellsZ; z++) {
+		rowRuns.clear();
+		if (z < _numCellsZ) {
+			for (unsigned int x = 0; x < _numCellsX; ) {
+				if (!isBlocked(x, z)) { x++; continue; }
+				Run run;
+				run.xStart = x;
+				while ((x < _numCellsX) && isBlocked(x, z)) x++;
+				run.xEnd = x;
+				run.zStart = z;
+				rowRuns.push_back(run);
+			}
+		}
+
+		// runs are sorted by x in both lists, so matching runs are found in one pass.
+		unsigned int j = 0;
+		for (unsigned int i = 0; i < openRuns.size(); i++) {
+			while ((j < rowRuns.size()) && (rowRuns[j].xStart < openRuns[i].xStart)) j++;
+			if ((j < rowRuns.size()) && (rowRuns[j].xStart == openRuns[i].xStart) && (rowRuns[j].xEnd == openRuns[i].xEnd)) {
+				rowRuns[j].zStart = openRuns[i].zStart;
+			}
+			else {
+				const Run & run = openRuns[i];
+				rectangles.push_back(AxisAlignedBox(_originX + run.xStart * _cellSize, _originX + run.xEnd * _cellSize, _bounds.ymin, _bounds.ymax,
+					_originZ + run.zStart * _cellSize, _originZ + z * _cellSize));
+			}
+		}
+		openRuns.swap(rowRuns);
+	}
+}
+
+void GridMapObstacle::draw()
+{
+#ifdef ENABLE_GUI
+	std::vector<AxisAlignedBox> rectangles;
+	getBlockedRectangles(rectangles);
+	DrawLib::glColor(Color(0.178f, 0.2896f, 0.3339));
+	for (unsigned int i = 0; i < rectangles.size(); i++) {
+		const AxisAlignedBox & box = rectangles[i];
+		DrawLib::drawBox(box.xmin, box.xmax, box.ymin, box.ymax, box.zmin, box.zmax);
+	}
+#endif // ifdef ENABLE_GUI
+}
+
+void GridMapObstacle::setBounds(const Util::AxisAlignedBox & bounds)
+{
+	_originX = bounds.xmin;
+	_originZ = bounds.zmin;
+	_updateBounds();
+}
+
+bool GridMapObstacle::intersects(const Util::Ray &r, float &t)
+{
+	// clip the ray to the bounds of the map
+	float tEnter = r.mint;
+	float tExit = r.maxt;
+	if (r.dir.x != 0.0f) {
+		float t1 = (_bounds.xmin - r.pos.x) / r.dir.x;
+		float t2 = (_bounds.xmax - r.pos.x) / r.dir.x;
+		tEnter = std::max(tEnter, std::min(t1, t2));
+		tExit = std::min(tExit, std::max(t1, t2));
+	}
+	else if ((r.pos.x < _bounds.xmin) || (r.pos.x >= _bounds.xmax)) {
+		return false;
+	}
+	if (r.dir.z != 0.0f) {
+		float t1 = (_bounds.zmin - r.pos.z) / r.dir.z;
+		float t2 = (_bounds.zmax - r.pos.z) / r.dir.z;
+		tEnter = std::max(tEnter, std::min(t1, t2));
+		tExit = std::min(tExit, std::max(t1, t2));
+	}
+	else if ((r.pos.z < _bounds.zmin) || (r.pos.z >= _bounds.zmax)) {
+		return false;
+	}
+	if (tEnter > tExit) {
+		return false;
+	}
+
+	// walk through the cells along the ray, in order, until a blocked cell is entered
+	Point entry = r.eval(tEnter);
+	int x = std::max(0, std::min((int)floorf((entry.x - _originX) * _invCellSize), (int)_numCellsX - 1));
+	int z = std::max(0, std::min((int)floorf((entry.z - _originZ) * _invCellSize), (int)_numCellsZ - 1));
+	int stepX = (r.dir.x > 0.0f) ? 1 : -1;
+	int stepZ = (r.dir.z > 0.0f) ? 1 : -1;
+	float tNextX = (r.dir.x != 0.0f) ? (_originX + (float)(x + (stepX > 0 ? 1 : 0)) * _cellSize - r.pos.x) / r.dir.x : FLT_MAX;
+	float tNextZ = (r.dir.z != 0.0f) ? (_originZ + (float)(z + (stepZ > 0 ? 1 : 0)) * _cellSize - r.pos.z) / r.dir.z : FLT_MAX;
+	float tDeltaX = (r.dir.x != 0.0f) ? _cellSize / fabsf(r.dir.x) : FLT_MAX;
+	float tDeltaZ = (r.dir.z != 0.0f) ? _cellSize / fabsf(r.dir.z) : FLT_MAX;
+
+	while (true) {
+		if (isBlocked((unsigned int)x, (unsigned int)z)) {
+			t = tEnter;
+			return true;
+		}
+		if (tNextX < tNextZ) {
+			tEnter = tNextX;
+			tNextX += tDeltaX;
+			x += stepX;
+		}
+		else {
+			tEnter = tNextZ;
+			tNextZ += tDeltaZ;
+			z += stepZ;
+		}
+		if ((tEnter > tExit) || (x < 0) || (x >= (int)_numCellsX) || (z < 0) || (z >= (int)_numCellsZ)) {
+			return false;
+		}
+	}
+}
+
+bool GridMapObstacle::overlaps(const Util::Point & p, float radius)
+{
+	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
+	if (!_clampToCellRange(p.x - radius, p.x + radius, p.z - radius, p.z + radius, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+		return false;
+	}
+	for (unsigned int z = zMinIndex; z <= zMaxIndex; z++) {
+		for (unsigned int x = xMinIndex; x <= xMaxIndex; x++) {
+			if (!isBlocked(x, z)) continue;
+			float xmin = _originX + x * _cellSize;
+			float zmin = _originZ + z * _cellSize;
+			if (boxOverlapsCircle2D(xmin, xmin + _cellSize, zmin, zmin + _cellSize, p, radius)) return true;
+		}
+	}
+	return false;
+}
+
+float GridMapObstacle::computePenetration(const Util::Point & p, float radius)
+{
+	// the deepest penetration into any one blocked cell, as if each cell were a separate box
+	float penetration = 0.0f;
+	unsigned int xMinIndex, xMaxIndex, zMinIndex, zMaxIndex;
+	if (!_clampToCellRange(p.x - radius, p.x + radius, p.z - radius, p.z + radius, xMinIndex, xMaxIndex, zMinIndex, zMaxIndex)) {
+		return penetration;
+	}
+	for (unsigned int z = zMinIndex; z <= zMaxIndex; z++) {
+		for (unsigned int x = xMinIndex; x <= xMaxIndex; x++) {
+			if (!isBlocked(x, z)) continue;
+			float xmin = _originX + x * _cellSize;
+			float zmin = _originZ + z * _cellSize;
+			penetration = std::max(penetration, computeBoxCirclePenetration2D(xmin, xmin + _cellSize, zmin, zmin + _cellSize, p, radius));
+		}
+	}
+	return penetration;
+}
+
+std::pair<std::vector<Util::Point>,std::vector<size_t> > GridMapObstacle::getStaticGeometry()
+{
+	// the same geometry as one BoxObstacle per blocked rectangle
+	std::vector<Util::Point> vertices;
+	std::vector<size_t> triangles;
+	std::vector<AxisAlignedBox> rectangles;
+	getBlockedRectangles(rectangles);
+	for (unsigned int i = 0; i < rectangles.size(); i++) {
+		BoxObstacle box(rectangles[i], _traversalCost);
+		std::pair<std::vector<Util::Point>,std::vector<size_t> > boxGeometry = box.getStaticGeometry();
+		size_t firstVertex = vertices.size();
+		vertices.insert(vertices.end(), boxGeometry.first.begin(), boxGeometry.first.end());
+		for (unsigned int j = 0; j < boxGeometry.second.size(); j++) {
+			triangles.push_back(firstVertex + boxGeometry.second[j]);
+		}
+	}
+	return std::make_pair(vertices, triangles);
+}
+
+std::vector<Util::Point> GridMapObstacle::get2DStaticGeometry()
+{
+	// the blocked cells do not form a single outline; use getBlockedRectangles() instead.
+	return std::vector<Util::Point>();
+}
+
+
+//
+// _clampToCellRange() - converts a spatial range to the (inclusive) range of cells that overlap it, in the same way as the grid database.
+//
+bool GridMapObstacle::_clampToCellRange(float xmin, float xmax, float zmin, float zmax, unsigned int & xMinIndex, unsigned int & xMaxIndex, unsigned int & zMinIndex, unsigned int & zMaxIndex) const
+{
+	if ((xmax <= _bounds.xmin) || (xmin >= _bounds.xmax) || (zmax <= _bounds.zmin) || (zmin >= _bounds.zmax) || (xmin > xmax) || (zmin > zmax)) {
+		return false;
+	}
+	xMinIndex = (xmin <= _originX) ? 0 : std::min((unsigned int)floorf((xmin - _originX) * _invCellSize), _numCellsX - 1);
+	zMinIndex = (zmin <= _originZ) ? 0 : std::min((unsigned int)floorf((zmin - _originZ) * _invCellSize), _numCellsZ - 1);
+	xMaxIndex = (xmax >= _bounds.xmax) ? _numCellsX - 1 : std::max(xMinIndex, (unsigned int)ceilf((xmax - _originX) * _invCellSize) - 1);
+	zMaxIndex = (zmax >= _bounds.zmax) ? _numCellsZ - 1 : std::max(zMinIndex, (unsigned int)ceilf((zmax - _originZ) * _invCellSize) - 1);
+	return true;
+}
+
+void GridMapObstacle::_updateBounds()
+{
+	_bounds = AxisAlignedBox(_originX, _originX + _numCellsX * _cellSize, 0.0f, 1.0f, _originZ, _originZ + _numCellsZ * _cellSize);
+}
@@ -0,0 +1,896 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file HashedGridDatabase2D.cpp
+/// @brief Implements the SteerLib::HashedGridDatabase2D spatial database.
+
+#include <set>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "util/GenericException.h"
+#include "util/Geometry.h"
+#include "util/DrawLib.h"
+#include "util/Color.h"
+#include "mersenne/MersenneTwister.h"
+
+#include "interfaces/AgentInterface.h"
+#include "griddatabase/HashedGridDatabase2D.h"
+#include "griddatabase/GridDatabaseRegionSampler.h"
+#include "obstacles/GridMapObstacle.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+//
+// constructor - the bounds and number of cells of the nominal window set the cell size and the cell indices.
+//
+HashedGridDatabase2D::HashedGridDatabase2D(float xmin, float xmax, float zmin, float zmax, unsigned int numXCells, unsigned int numZCells, bool drawGrid)
+{
+	if (xmin > xmax) swap(xmin, xmax);
+	if (zmin > zmax) swap(zmin, zmax);
+	if ((numXCells == 0) || (numZCells == 0) || (xmax - xmin <= 0.0f) || (zmax - zmin <= 0.0f)) {
+		throw GenericException("HashedGridDatabase2D needs a window with a positive size and at least one cell along each axis.");
+	}
+
+	_xOrigin = xmin;
+	_zOrigin = zmin;
+	_xGridSize = xmax - xmin;
+	_zGridSize = zmax - zmin;
+	_xNumCells = numXCells;
+	_zNumCells = numZCells;
+	_xCellSize = _xGridSize / ((float)numXCells);
+	_zCellSize = _zGridSize / ((float)numZCells);
+	_xInvCellSize = 1.0f / _xCellSize;
+	_zInvCellSize = 1.0f / _zCellSize;
+	_drawGrid = drawGrid;
+	_randomNumberGenerator = new MTRand(2);
+
+	_numEmptyCells = 0;
+	_tableShift = 64;
+	_xMinAllocated = _xMaxAllocated = _zMinAllocated = _zMaxAllocated = 0;
+}
+
+
+//
+// destructor
+//
+HashedGridDatabase2D::~HashedGridDatabase2D()
+{
+	delete _randomNumberGenerator;
+}
+
+
+void HashedGridDatabase2D::clearDatabase()
+{
+	_cells.clear();
+	_tableKeys.clear();
+	_tableCells.clear();
+	_numEmptyCells = 0;
+	_obstacleLayers.clear();
+}
+
+
+size_t HashedGridDatabase2D::getMemoryUsage()
+{
+	size_t numBytes = _cells.capacity() * sizeof(HashedGridCell);
+	numBytes += _tableKeys.capacity() * sizeof(unsigned long long) + _tableCells.capacity() * sizeof(unsigned int);
+	for (unsigned int i = 0; i < _cells.size(); i++) {
+		numBytes += _cells[i].items.capacity() * sizeof(SpatialDatabaseItemPtr);
+	}
+	for (unsigned int i = 0; i < _obstacleLayers.size(); i++) {
+		numBytes += _obstacleLayers[i]->getBitmapSizeInBytes();
+	}
+	return numBytes;
+}
+
+
+//
+// spreadBits() - moves bit i of the 32-bit value to bit 2i of the result.
+//
+static inline unsigned long long spreadBits(unsigned int value)
+{
+	unsigned long long x = value;
+	x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+	x = (x | (x << 8))  & 0x00FF00FF00FF00FFULL;
+	x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+	x = (x | (x << 2))  & 0x3333333333333333ULL;
+	x = (x | (x << 1))  & 0x5555555555555555ULL;
+	return x;
+}
+
+
+//
+// _getCellKey() - flipping the sign bit maps the signed coordinates to unsigned ones in the same order, so that
+//                 the cells on either side of zero also get nearby Morton codes.
+//
+inline unsigned long long HashedGridDatabase2D::_getCellKey(int x, int z)
+{
+	return spreadBits((unsigned int)x ^ 0x80000000u) | (spreadBits((unsigned int)z ^ 0x80000000u) << 1);
+}
+
+
+//
+// _findSlot() - the Morton code of neighboring cells only differs in the low bits, so it is multiplied by the golden
+//               ratio first, and the slot is taken from the high bits of the product.
+//
+inline unsigned int HashedGridDatabase2D::_findSlot(unsigned long long key)
+{
+	unsigned int mask = (unsigned int)_tableKeys.size() - 1;
+	unsigned int slot = (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> _tableShift);
+	while ((_tableKeys[slot] != key) && (_tableKeys[slot] != 0)) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+
+inline HashedGridDatabase2D::HashedGridCell * HashedGridDatabase2D::_findCell(int x, int z)
+{
+	if (_tableKeys.empty()) {
+		return NULL;
+	}
+	unsigned long long key = _getCellKey(x, z);
+	unsigned int slot = _findSlot(key);
+	return (_tableKeys[slot] == key) ? &_cells[_tableCells[slot]] : NULL;
+}
+
+
+//
+// _findOrAllocateCell() - a new cell counts as an empty cell until the caller adds an item to it.
+//
+HashedGridDatabase2D::HashedGridCell & HashedGridDatabase2D::_findOrAllocateCell(int x, int z)
+{
+	// keep the table at most half full, so that the probe sequences stay short.
+	if (2 * (_cells.size() + 1) > _tableKeys.size()) {
+		_rebuildTable();
+	}
+
+	unsigned long long key = _getCellKey(x, z);
+	unsigned int slot = _findSlot(key);
+	if (_tableKeys[slot] == key) {
+		return _cells[_tableCells[slot]];
+	}
+
+	if (_cells.empty()) {
+		_xMinAllocated = _xMaxAllocated = x;
+		_zMinAllocated = _zMaxAllocated = z;
+	}
+	else {
+		_xMinAllocated = min(_xMinAllocated, x);
+		_xMaxAllocated = max(_xMaxAllocated, x);
+		_zMinAllocated = min(_zMinAllocated, z);
+		_zMaxAllocated = max(_zMaxAllocated, z);
+	}
+
+	_tableKeys[slot] = key;
+	_tableCells[slot] = (unsigned int)_cells.size();
+	_cells.push_back(HashedGridCell());
+	HashedGridCell & cell = _cells.back();
+	// TODO: same question as GridDatabase2D, whether the base traversal cost could be 0.0f instead.
+	cell.traversalCost = 1.0f;
+	cell.x = x;
+	cell.z = z;
+	_numEmptyCells++;
+	return cell;
+}
+
+
+//
+// _rebuildTable() - the new table is at most a quarter full, so it can take as many cells again before it grows.
+//
+void HashedGridDatabase2D::_rebuildTable()
+{
+	unsigned int numSlots = 64;
+	_tableShift = 58;
+	while (numSlots < 4 * (_cells.size() + 1)) {
+		numSlots *= 2;
+		_tableShift--;
+	}
+
+	// swapping with new vectors also gives memory back when the table shrinks.
+	std::vector<unsigned long long>(numSlots, 0).swap(_tableKeys);
+	std::vector<unsigned int>(numSlots, 0).swap(_tableCells);
+	for (unsigned int i=0; i < _cells.size(); i++) {
+		unsigned long long key = _getCellKey(_cells[i].x, _cells[i].z);
+		unsigned int slot = _findSlot(key);
+		_tableKeys[slot] = key;
+		_tableCells[slot] = i;
+	}
+}
+
+
+//
+// clampCellCoordinate() - converts a cell coordinate computed in floating point to an integer in the key space.
+//
+static inline int clampCellCoordinate(float c)
+{
+	if (!(c > (float)-HashedGridDatabase2D::MAX_CELL_COORDINATE)) return -HashedGridDatabase2D::MAX_CELL_COORDINATE;
+	if (c > (float)HashedGridDatabase2D::MAX_CELL_COORDINATE) return HashedGridDatabase2D::MAX_CELL_COORDINATE;
+	return (int)c;
+}
+
+
+//
+// _getCellRange() - like GridDatabase2D, a bound that lies exactly on the edge of a cell does not reach into the next cell.
+//
+void HashedGridDatabase2D::_getCellRange(float xmin, float xmax, float zmin, float zmax, int & xMin, int & xMax, int & zMin, int & zMax)
+{
+	xMin = clampCellCoordinate(floorf((xmin - _xOrigin) * _xInvCellSize));
+	zMin = clampCellCoordinate(floorf((zmin - _zOrigin) * _zInvCellSize));
+	xMax = max(xMin, clampCellCoordinate(ceilf((xmax - _xOrigin) * _xInvCellSize) - 1.0f));
+	zMax = max(zMin, clampCellCoordinate(ceilf((zmax - _zOrigin) * _zInvCellSize) - 1.0f));
+}
+
+
+//
+// _beginCellRange() - the walk probes the table for each cell of the range, or visits every allocated cell if that is fewer.
+//
+void HashedGridDatabase2D::_beginCellRange(int xMin, int xMax, int zMin, int zMax, CellRange & range)
+{
+	// nothing is allocated outside of these bounds
+	range.xMin = max(xMin, _xMinAllocated);
+	range.xMax = min(xMax, _xMaxAllocated);
+	range.zMin = max(zMin, _zMinAllocated);
+	range.zMax = min(zMax, _zMaxAllocated);
+	range.x = range.xMin;
+	range.z = range.zMin;
+	range.cellIndex = 0;
+	range.visitAllCells = false;
+	if (_cells.empty() || (range.xMin > range.xMax) || (range.zMin > range.zMax)) {
+		// an empty walk
+		range.x = range.xMax + 1;
+		return;
+	}
+
+	unsigned long long numCellsInRange = (unsigned long long)(range.xMax - range.xMin + 1) * (unsigned long long)(range.zMax - range.zMin + 1);
+	range.visitAllCells = (numCellsInRange > _cells.size());
+}
+
+
+inline HashedGridDatabase2D::HashedGridCell * HashedGridDatabase2D::_nextCellInRange(CellRange & range)
+{
+	if (range.visitAllCells) {
+		while (range.cellIndex < _cells.size()) {
+			HashedGridCell & cell = _cells[range.cellIndex++];
+			if ((cell.x >= range.xMin) && (cell.x <= range.xMax) && (cell.z >= range.zMin) && (cell.z <= range.zMax) && !cell.items.empty()) {
+				return &cell;
+			}
+		}
+		return NULL;
+	}
+
+	while (range.x <= range.xMax) {
+		HashedGridCell * cell = _findCell(range.x, range.z);
+		if (range.z < range.zMax) {
+			range.z++;
+		}
+		else {
+			range.z = range.zMin;
+			range.x++;
+		}
+		if ((cell != NULL) && !cell->items.empty()) {
+			return cell;
+		}
+	}
+	return NULL;
+}
+
+
+//
+// _releaseEmptyCells() - empty cells are kept for a while, because agents tend to come back to the cells they just left.
+//
+void HashedGridDatabase2D::_releaseEmptyCells()
+{
+	if ((_numEmptyCells < 64) || (2 * _numEmptyCells <= _cells.size() - _numEmptyCells)) {
+		return;
+	}
+
+	std::vector<HashedGridCell> occupiedCells;
+	occupiedCells.reserve(_cells.size() - _numEmptyCells);
+	for (unsigned int i=0; i < _cells.size(); i++) {
+		HashedGridCell & cell = _cells[i];
+		if (cell.items.empty()) {
+			continue;
+		}
+		if (occupiedCells.empty()) {
+			_xMinAllocated = _xMaxAllocated = cell.x;
+			_zMinAllocated = _zMaxAllocated = cell.z;
+		}
+		else {
+			_xMinAllocated = min(_xMinAllocated, cell.x);
+			_xMaxAllocated = max(_xMaxAllocated, cell.x);
+			_zMinAllocated = min(_zMinAllocated, cell.z);
+			_zMaxAllocated = max(_zMaxAllocated, cell.z);
+		}
+		occupiedCells.push_back(HashedGridCell());
+		HashedGridCell & occupiedCell = occupiedCells.back();
+		occupiedCell.items.swap(cell.items);
+		occupiedCell.traversalCost = cell.traversalCost;
+		occupiedCell.x = cell.x;
+		occupiedCell.z = cell.z;
+	}
+	_cells.swap(occupiedCells);
+	_numEmptyCells = 0;
+	_rebuildTable();
+}
+
+
+//
+// asObstacleLayer() - returns the item as a GridMapObstacle, or NULL if it is any other kind of item.
+//
+static inline GridMapObstacle * asObstacleLayer( SpatialDatabaseItemPtr item )
+{
+	if (item->getSpatialDatabaseItemType() != SPATIAL_DATABASE_ITEM_OBSTACLE) return NULL;
+	return dynamic_cast<GridMapObstacle*>(item->asObstacle());
+}
+
+
+//
+// _obstacleLayerIsInRange() - tests the spatial extent of the range of cells against the layer's bitmap.
+//
+bool HashedGridDatabase2D::_obstacleLayerIsInRange(GridMapObstacle * layer, int xMin, int xMax, int zMin, int zMax)
+{
+	return layer->isRegionBlocked(_xOrigin + xMin * _xCellSize, _xOrigin + (xMax + 1) * _xCellSize,
+		_zOrigin + zMin * _zCellSize, _zOrigin + (zMax + 1) * _zCellSize);
+}
+
+
+//
+// addObject() - adds the given item to the database, allocating the cells that overlap "newBounds" as needed.
+//
+void HashedGridDatabase2D::addObject( SpatialDatabaseItemPtr item, const AxisAlignedBox & newBounds )
+{
+	if ( ( newBounds.xmin != newBounds.xmin ) || (newBounds.xmax != newBounds.xmax) || (newBounds.zmin != newBounds.zmin) ||
+			(newBounds.zmax != newBounds.zmax))
+	{
+		throw GenericException("Invalid agent bounds. Bounds are NaN");
+	}
+
+	// a grid map is kept in a list of layers; its traversal cost is computed from the bitmap when asked for.
+	GridMapObstacle * layer = asObstacleLayer(item);
+	if (layer != NULL) {
+		_obstacleLayers.push_back(layer);
+		return;
+	}
+
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(newBounds.xmin, newBounds.xmax, newBounds.zmin, newBounds.zmax, xMin, xMax, zMin, zMax);
+
+	float traversalCost = item->getTraversalCost();
+	for (int i=xMin; i<=xMax; i++) {
+		for (int j=zMin; j<=zMax; j++) {
+			HashedGridCell & cell = _findOrAllocateCell(i, j);
+			if (cell.items.empty()) {
+				_numEmptyCells--;
+			}
+			cell.items.push_back(item);
+			cell.traversalCost += traversalCost;
+		}
+	}
+}
+
+
+//
+// removeObject() - removes an item from the cells that overlap with "oldBounds"
+//
+void HashedGridDatabase2D::removeObject( SpatialDatabaseItemPtr item, const AxisAlignedBox &oldBounds )
+{
+	GridMapObstacle * layer = asObstacleLayer(item);
+	if (layer != NULL) {
+		std::vector<GridMapObstacle*>::iterator iter = std::find(_obstacleLayers.begin(), _obstacleLayers.end(), layer);
+		if (iter == _obstacleLayers.end()) {
+			throw GenericException("Tried to remove a grid map obstacle from the hashed grid database, but it did not exist there in the first place.");
+		}
+		_obstacleLayers.erase(iter);
+		return;
+	}
+
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(oldBounds.xmin, oldBounds.xmax, oldBounds.zmin, oldBounds.zmax, xMin, xMax, zMin, zMax);
+
+	float traversalCost = item->getTraversalCost();
+	for (int i=xMin; i<=xMax; i++) {
+		for (int j=zMin; j<=zMax; j++) {
+			HashedGridCell * cell = _findCell(i, j);
+			std::vector<SpatialDatabaseItemPtr>::iterator iter;
+			if ((cell == NULL) || ((iter = std::find(cell->items.begin(), cell->items.end(), item)) == cell->items.end())) {
+				throw GenericException("Tried to remove an object from a cell of the hashed grid database, but it did not exist there in the first place.");
+			}
+			// the order of the items in a cell does not matter, so the last one fills the gap.
+			*iter = cell->items.back();
+			cell->items.pop_back();
+			if (cell->items.empty()) {
+				cell->traversalCost = 1.0f;
+				_numEmptyCells++;
+			}
+			else {
+				cell->traversalCost -= traversalCost;
+			}
+		}
+	}
+
+	_releaseEmptyCells();
+}
+
+
+//
+// updateObject() - like GridDatabase2D, removes the item and adds it again.
+//
+void HashedGridDatabase2D::updateObject( SpatialDatabaseItemPtr item, const AxisAlignedBox & oldBounds, const AxisAlignedBox & newBounds )
+{
+	removeObject(item, oldBounds);
+	addObject(item, newBounds);
+}
+
+
+bool HashedGridDatabase2D::hasAnyItems( unsigned int x, unsigned int z )
+{
+	HashedGridCell * cell = _findCell((int)x, (int)z);
+	return (cell != NULL) && !cell->items.empty();
+}
+
+
+float HashedGridDatabase2D::getTraversalCost( unsigned int x, unsigned int z )
+{
+	HashedGridCell * cell = _findCell((int)x, (int)z);
+	float traversalCost = (cell != NULL) ? cell->traversalCost : 1.0f;
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if (_obstacleLayerIsInRange(_obstacleLayers[i], (int)x, (int)x, (int)z, (int)z)) {
+			traversalCost += _obstacleLayers[i]->getTraversalCost();
+		}
+	}
+	return traversalCost;
+}
+
+
+//
+// getItemsInRange() - the index version works on the cells of the nominal window, whose coordinates are the same as the indices.
+//
+void HashedGridDatabase2D::getItemsInRange(set<SpatialDatabaseItemPtr> & neighborList, unsigned int xMinIndex, unsigned int xMaxIndex, unsigned int zMinIndex, unsigned int zMaxIndex, SpatialDatabaseItemPtr exclude)
+{
+	CellRange range;
+	_beginCellRange((int)xMinIndex, (int)xMaxIndex, (int)zMinIndex, (int)zMaxIndex, range);
+	for (HashedGridCell * cell = _nextCellInRange(range); cell != NULL; cell = _nextCellInRange(range)) {
+		std::vector<SpatialDatabaseItemPtr> & items = cell->items;
+		for (unsigned int k=0; k < items.size(); k++) {
+			if (items[k] != exclude) {
+				neighborList.insert(items[k]);
+			}
+		}
+	}
+
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], (int)xMinIndex, (int)xMaxIndex, (int)zMinIndex, (int)zMaxIndex)) {
+			neighborList.insert(_obstacleLayers[i]);
+		}
+	}
+}
+
+
+void HashedGridDatabase2D::getItemsInRange(set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude)
+{
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(xmin, xmax, zmin, zmax, xMin, xMax, zMin, zMax);
+
+	CellRange range;
+	_beginCellRange(xMin, xMax, zMin, zMax, range);
+	for (HashedGridCell * cell = _nextCellInRange(range); cell != NULL; cell = _nextCellInRange(range)) {
+		std::vector<SpatialDatabaseItemPtr> & items = cell->items;
+		for (unsigned int k=0; k < items.size(); k++) {
+			if (items[k] != exclude) {
+				neighborList.insert(items[k]);
+			}
+		}
+	}
+
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMin, xMax, zMin, zMax)) {
+			neighborList.insert(_obstacleLayers[i]);
+		}
+	}
+}
+
+
+//
+// getAgentsAndObstaclesInRange() - same as GridDatabase2D: the items are split straight into the caller's lists, which
+//                                  are then sorted by address to remove duplicates, so they come out in the same order
+//                                  as from an STL set.
+//
+void HashedGridDatabase2D::getAgentsAndObstaclesInRange(std::vector<AgentInterface*> & agents, std::vector<ObstacleInterface*> & obstacles, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude)
+{
+	agents.clear();
+	obstacles.clear();
+
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(xmin, xmax, zmin, zmax, xMin, xMax, zMin, zMax);
+
+	CellRange range;
+	_beginCellRange(xMin, xMax, zMin, zMax, range);
+	for (HashedGridCell * cell = _nextCellInRange(range); cell != NULL; cell = _nextCellInRange(range)) {
+		std::vector<SpatialDatabaseItemPtr> & items = cell->items;
+		for (unsigned int k=0; k < items.size(); k++) {
+			SpatialDatabaseItemPtr item = items[k];
+			if (item == exclude) continue;
+			switch (item->getSpatialDatabaseItemType()) {
+				case SPATIAL_DATABASE_ITEM_AGENT:
+					agents.push_back(item->asAgent());
+					break;
+				case SPATIAL_DATABASE_ITEM_OBSTACLE:
+					obstacles.push_back(item->asObstacle());
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMin, xMax, zMin, zMax)) {
+			obstacles.push_back(_obstacleLayers[i]);
+		}
+	}
+
+	std::sort(agents.begin(), agents.end());
+	agents.erase(std::unique(agents.begin(), agents.end()), agents.end());
+	std::sort(obstacles.begin(), obstacles.end());
+	obstacles.erase(std::unique(obstacles.begin(), obstacles.end()), obstacles.end());
+}
+
+
+bool HashedGridDatabase2D::overlapsAnyItem(const Point & p, float radius, bool excludeAgents)
+{
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(p.x - radius, p.x + radius, p.z - radius, p.z + radius, xMin, xMax, zMin, zMax);
+
+	CellRange range;
+	_beginCellRange(xMin, xMax, zMin, zMax, range);
+	for (HashedGridCell * cell = _nextCellInRange(range); cell != NULL; cell = _nextCellInRange(range)) {
+		std::vector<SpatialDatabaseItemPtr> & items = cell->items;
+		for (unsigned int k=0; k < items.size(); k++) {
+			if (excludeAgents && items[k]->isAgent()) continue;
+			if (items[k]->overlaps(p, radius)) return true;
+		}
+	}
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if (_obstacleLayers[i]->overlaps(p, radius)) return true;
+	}
+	return false;
+}
+
+
+//
+// getItemsInVisualField() - same culling as GridDatabase2D::getItemsInVisualField().
+//
+void HashedGridDatabase2D::getItemsInVisualField(set<SpatialDatabaseItemPtr> & neighborList, float xmin, float xmax, float zmin, float zmax, SpatialDatabaseItemPtr exclude, const Point & position, const Vector & facingDirection, float radiusSquared)
+{
+	int xMin, xMax, zMin, zMax;
+	_getCellRange(xmin, xmax, zmin, zmax, xMin, xMax, zMin, zMax);
+
+	CellRange range;
+	_beginCellRange(xMin, xMax, zMin, zMax, range);
+	for (HashedGridCell * cell = _nextCellInRange(range); cell != NULL; cell = _nextCellInRange(range)) {
+		std::vector<SpatialDatabaseItemPtr> & items = cell->items;
+		for (unsigned int k=0; k < items.size(); k++) {
+			SpatialDatabaseItemPtr possiblyVisibleObject = items[k];
+			if (possiblyVisibleObject == exclude)
+				continue;
+
+			if (possiblyVisibleObject->isAgent()) {
+				if (neighborList.find(possiblyVisibleObject) != neighborList.end()) continue;
+
+				// (1) the agent has to be within the radius of the visual field,
+				Point hisPosition = possiblyVisibleObject->asAgent()->position();
+				Vector directionToOtherAgent = hisPosition - position;
+				float distSquared = directionToOtherAgent.lengthSquared();
+				if (distSquared > radiusSquared)
+					continue;
+
+				// (2) in the hemisphere that we are facing,
+				float cosTheta = dot(directionToOtherAgent/sqrtf(distSquared),normalize(facingDirection));
+				if (cosTheta < 0.0f)
+					continue;
+
+				// (3) and in our line of sight.
+				if (!hasLineOfSight(position, hisPosition, possiblyVisibleObject, exclude))
+					continue;
+			}
+			// obstacles are always known to the agent, even if they are not in the visual field.
+			neighborList.insert(possiblyVisibleObject);
+		}
+	}
+
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayerIsInRange(_obstacleLayers[i], xMin, xMax, zMin, zMax)) {
+			neighborList.insert(_obstacleLayers[i]);
+		}
+	}
+}
+
+
+void HashedGridDatabase2D::computeAgentNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const
+{
+
+}
+
+
+void HashedGridDatabase2D::computeObstacleNeighbors(SpatialDatabaseItemPtr agent, float rangeSq) const
+{
+
+}
+
+
+bool HashedGridDatabase2D::trace(const Ray & r, float & t, SpatialDatabaseItemPtr &hitObject, SpatialDatabaseItemPtr exclude, bool excludeAgents)
+{
+	// the layers are traced first; then a hit on the items in the cells only counts if it is closer.
+	GridMapObstacle * layerHit = NULL;
+	float layerT = 0.0f;
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		float temp_t;
+		if ((_obstacleLayers[i] != exclude) && _obstacleLayers[i]->intersects(r, temp_t) && ((layerHit == NULL) || (temp_t < layerT))) {
+			layerHit = _obstacleLayers[i];
+			layerT = temp_t;
+		}
+	}
+	if (layerHit == NULL) {
+		return _traceCells(r, t, hitObject, exclude, NULL, excludeAgents, false);
+	}
+
+	Ray shortenedRay = r;
+	shortenedRay.maxt = layerT;
+	if (!_traceCells(shortenedRay, t, hitObject, exclude, NULL, excludeAgents, false)) {
+		t = layerT;
+		hitObject = layerHit;
+	}
+	return true;
+}
+
+
+bool HashedGridDatabase2D::hasLineOfSight(const Ray & r, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2)
+{
+	for (unsigned int i=0; i < _obstacleLayers.size(); i++) {
+		float t;
+		if ((_obstacleLayers[i] != exclude1) && (_obstacleLayers[i] != exclude2) && _obstacleLayers[i]->intersects(r, t)) {
+			return false;
+		}
+	}
+	float t;
+	SpatialDatabaseItemPtr hitObject;
+	return !_traceCells(r, t, hitObject, exclude1, exclude2, false, true);
+}
+
+
+bool HashedGridDatabase2D::hasLineOfSight(const Point & p1, const Point & p2, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2)
+{
+	Ray r;
+	r.initWithUnitInterval(p1, p2-p1);
+	return hasLineOfSight(r, exclude1, exclude2);
+}
+
+
+//
+// _traceCells() - clips the ray to the bounds of the allocated cells, and then walks through the cells along the ray
+//                 in order.  A hit only counts if it is inside the current cell; otherwise an item of a later cell
+//                 could still be closer.
+//
+bool HashedGridDatabase2D::_traceCells(const Ray & r, float & t, SpatialDatabaseItemPtr & hitObject, SpatialDatabaseItemPtr exclude1, SpatialDatabaseItemPtr exclude2, bool excludeAgents, bool onlyLineOfSightBlockers)
+{
+	hitObject = NULL;
+	if (_cells.empty()) {
+		return false;
+	}
+
+	float tEnter = r.mint;
+	float tExit = r.maxt;
+	float xmin = _xOrigin + _xMinAllocated * _xCellSize;
+	float xmax = _xOrigin + (_xMaxAllocated + 1) * _xCellSize;
+	float zmin = _zOrigin + _zMinAllocated * _zCellSize;
+	float zmax = _zOrigin + (_zMaxAllocated + 1) * _zCellSize;
+	if (r.dir.x != 0.0f) {
+		float t1 = (xmin - r.pos.x) / r.dir.x;
+		float t2 = (xmax - r.pos.x) / r.dir.x;
+		tEnter = std::max(tEnter, std::min(t1, t2));
+		tExit = std::min(tExit, std::max(t1, t2));
+	}
+	else if ((r.pos.x < xmin) || (r.pos.x >= xmax)) {
+		return false;
+	}
+	if (r.dir.z != 0.0f) {
+		float t1 = (zmin - r.pos.z) / r.dir.z;
+		float t2 = (zmax - r.pos.z) / r.dir.z;
+		tEnter = std::max(tEnter, std::min(t1, t2));
+		tExit = std::min(tExit, std::max(t1, t2));
+	}
+	else if ((r.pos.z < zmin) || (r.pos.z >= zmax)) {
+		return false;
+	}
+	if (tEnter > tExit) {
+		return false;
+	}
+
+	Point entry = r.eval(tEnter);
+	int x = std::max(_xMinAllocated, std::min(clampCellCoordinate(floorf((entry.x - _xOrigin) * _xInvCellSize)), _xMaxAllocated));
+	int z = std::max(_zMinAllocated, std::min(clampCellCoordinate(floorf((entry.z - _zOrigin) * _zInvCellSize)), _zMaxAllocated));
+	int stepX = (r.dir.x > 0.0f) ? 1 : -1;
+	int stepZ = (r.dir.z > 0.0f) ? 1 : -1;
+	float tNextX = (r.dir.x != 0.0f) ? (_xOrigin + (float)(x + (stepX > 0 ? 1 : 0)) * _xCellSize - r.pos.x) / r.dir.x : FLT_MAX;
+	float tNextZ = (r.dir.z != 0.0f) ? (_zOrigin + (float)(z + (stepZ > 0 ? 1 : 0)) * _zCellSize - r.pos.z) / r.dir.z : FLT_MAX;
+	float tDeltaX = (r.dir.x != 0.0f) ? _xCellSize / fabsf(r.dir.x) : FLT_MAX;
+	float tDeltaZ = (r.dir.z != 0.0f) ? _zCellSize / fabsf(r.dir.z) : FLT_MAX;
+
+	while (true) {
+		HashedGridCell * cell = _findCell(x, z);
+		if (cell != NULL) {
+			float mostRecent_maxt = std::min(tExit, std::min(tNextX, tNextZ));
+			for (unsigned int i=0; i < cell->items.size(); i++) {
+				SpatialDatabaseItemPtr item = cell->items[i];
+				if ((item == exclude1) || (item == exclude2)) continue;
+				if (excludeAgents && item->isAgent()) continue;
+				if (onlyLineOfSightBlockers && !item->blocksLineOfSight()) continue;
+
+				float temp_t;
+				Ray tempRay;
+				tempRay.initWithUnitInterval(r.pos, r.dir);
+				tempRay.mint = r.mint;
+				tempRay.maxt = mostRecent_maxt;
+				if (item->intersects(tempRay, temp_t) && (temp_t < mostRecent_maxt)) {
+					mostRecent_maxt = temp_t;
+					t = temp_t;
+					hitObject = item;
+				}
+			}
+			if (hitObject != NULL) {
+				return true;
+			}
+		}
+
+		if (tNextX < tNextZ) {
+			tEnter = tNextX;
+			tNextX += tDeltaX;
+			x += stepX;
+		}
+		else {
+			tEnter = tNextZ;
+			tNextZ += tDeltaZ;
+			z += stepZ;
+		}
+		if ((tEnter > tExit) || (x < _xMinAllocated) || (x > _xMaxAllocated) || (z < _zMinAllocated) || (z > _zMaxAllocated)) {
+			return false;
+		}
+	}
+}
+
+
+Point HashedGridDatabase2D::randomPositionWithoutCollisions(float radius, bool excludeAgents)
+{
+	AxisAlignedBox aab(_xOrigin, _xOrigin + _xGridSize, 0.0f, 0.0f, _zOrigin, _zOrigin + _zGridSize);
+	return randomPositionInRegionWithoutCollisions(aab, radius, excludeAgents);
+}
+
+
+Point HashedGridDatabase2D::randomPositionInRegionWithoutCollisions(const AxisAlignedBox & region, float radius, bool excludeAgents)
+{
+	return randomPositionInRegionWithoutCollisions(region, radius, excludeAgents, *_randomNumberGenerator);
+}
+
+
+Point HashedGridDatabase2D::randomPositionInRegionWithoutCollisions(const AxisAlignedBox & region, float radius, bool excludeAgents, MTRand & randomNumberGenerator)
+{
+	// a single position, so only uniform darts, as in GridDatabase2D.
+	GridDatabaseRegionSampler sampler(this, region, radius, excludeAgents);
+	Point ret(0.0f, 0.0f, 0.0f);
+	if (!sampler.randomPositionFromDarts(randomNumberGenerator, ret, GridDatabaseRegionSampler::NUM_DARTS_AFTER_EXHAUSTED)) {
+		throw GenericException("Gave up trying to find a random position in region.  The region is probably already too dense.");
+	}
+	return ret;
+}
+
+
+bool HashedGridDatabase2D::randomPositionInRegionWithoutCollisions(const Util::AxisAlignedBox & region, SpatialDatabaseItemPtr item, bool excludeAgents, MTRand & randomNumberGenerator)
+{
+	if (!item->isAgent()) {
+		return false;
+	}
+
+	AgentInterface * agent = item->asAgent();
+	AgentInitialConditions aic = agent->getAgentConditions(agent);
+	GridDatabaseRegionSampler sampler(this, region, agent->radius(), excludeAgents);
+	if (!sampler.randomPositionFromDarts(randomNumberGenerator, aic.position, GridDatabaseRegionSampler::NUM_DARTS_AFTER_EXHAUSTED)) {
+		return false;
+	}
+
+	float theta = (float)randomNumberGenerator.rand() * 2.0f * M_PI;
+	aic.direction = Util::Vector(cosf(theta), 0.0f, sinf(theta));
+	agent->reset(aic, agent->getSimulationEngine());
+	agent->disable();
+	return true;
+}
+
+
+Point HashedGridDatabase2D::randomPositionInRegion(const Util::AxisAlignedBox & region, float radius, MTRand & randomNumberGenerator)
+{
+	Point ret(0.0f, 0.0f, 0.0f);
+	float xspan = region.xmax - region.xmin - 2*radius;
+	float zspan = region.zmax - region.zmin - 2*radius;
+
+	ret.x = region.xmin + radius + ((float)randomNumberGenerator.rand(xspan));
+	ret.y = 0.0f;
+	ret.z = region.zmin + radius + ((float)randomNumberGenerator.rand(zspan));
+
+	return ret;
+}
+
+
+void HashedGridDatabase2D::draw()
+{
+#ifdef ENABLE_GUI
+	if (_drawGrid == false)
+		return;
+
+	// the nominal window, then one quad for each cell that has items
+	DrawLib::glColor(gGray90);
+	Point a(_xOrigin, -0.01f, _zOrigin);
+	Point b(_xOrigin, -0.01f, _zOrigin + _zGridSize);
+	Point c(_xOrigin + _xGridSize, -0.01f, _zOrigin + _zGridSize);
+	Point d(_xOrigin + _xGridSize, -0.01f, _zOrigin);
+	DrawLib::drawLine(a, b);
+	DrawLib::drawLine(b, c);
+	DrawLib::drawLine(c, d);
+	DrawLib::drawLine(d, a);
+
+	float gridQuadHeight = -0.1f;
+	for (unsigned int i=0; i < _cells.size(); i++) {
+		HashedGridCell & cell = _cells[i];
+		if (cell.items.empty()) continue;
+
+		Point p = Point(_xOrigin + cell.x * _xCellSize, gridQuadHeight, _zOrigin + cell.z * _zCellSize);
+		DrawLib::glColor(_getCellColor(cell));
+		DrawLib::drawQuad(p, p + Point(0, 0, _zCellSize), p + Point(_xCellSize, 0, _zCellSize), p + Point(_xCellSize, 0, 0));
+	}
+
+#else
+	throw GenericException("HashedGridDatabase2D::draw() cannot be called, this version of SteerLib compiled without GUI functionality.");
+#endif // ifdef ENABLE_GUI
+}
+
+
+bool HashedGridDatabase2D::getCellsToDraw(std::vector<GridCellRenderState> & cells)
+{
+	cells.clear();
+	if (_drawGrid == false)
+		return false;
+
+	GridCellRenderState state;
+	state.bounds.ymin = 0.0f;
+	state.bounds.ymax = 0.0f;
+	for (unsigned int i=0; i < _cells.size(); i++) {
+		const HashedGridCell & cell = _cells[i];
+		if (cell.items.empty()) continue;
+
+		state.bounds.xmin = _xOrigin + cell.x * _xCellSize;
+		state.bounds.xmax = state.bounds.xmin + _xCellSize;
+		state.bounds.zmin = _zOrigin + cell.z * _zCellSize;
+		state.bounds.zmax = state.bounds.zmin + _zCellSize;
+		state.color = _getCellColor(cell);
+		cells.push_back(state);
+	}
+	return true;
+}
+
+
+Color HashedGridDatabase2D::_getCellColor(const HashedGridCell & cell)
+{
+	Color color(0.4f, 0.4f, 0.4f);
+	for (unsigned int k=0; k < cell.items.size(); k++) {
+		if (cell.items[k]->isAgent())
+			color = color + Color(0.0f, 0.0f, 0.15f);
+		else
+			color = color + Color(0.15f, 0.0f, 0.0f);
+	}
+	return color;
+}
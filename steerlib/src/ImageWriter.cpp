@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file ImageWriter.cpp
+/// @brief Implements the PNG and PPM image writers.
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+#include "util/ImageWriter.h"
+#include "util/GenericException.h"
+
+using namespace std;
+using namespace Util;
+
+
+//
+// _appendUint32() - appends a big-endian 32-bit integer, as PNG requires.
+//
+static void _appendUint32(vector<unsigned char> & data, unsigned int value)
+{
+	data.push_back((unsigned char)(value >> 24));
+	data.push_back((unsigned char)(value >> 16));
+	data.push_back((unsigned char)(value >> 8));
+	data.push_back((unsigned char)(value));
+}
+
+
+// the crc of every byte value; built when the library is loaded, so that worker threads only read it.
+struct CrcTable {
+	unsigned int entries[256];
+	CrcTable()
+	{
+		for (unsigned int n = 0; n < 256; n++) {
+			unsigned int c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? (0xedb88320u ^ (c >> 1)) : (c >> 1);
+			}
+			entries[n] = c;
+		}
+	}
+};
+static const CrcTable _crcTable;
+
+
+//
+// _crc32() - the crc that PNG chunks end with.
+//
+static unsigned int _crc32(const unsigned char * data, size_t size)
+{
+	unsigned int crc = 0xffffffffu;
+	for (size_t i = 0; i < size; i++) {
+		crc = _crcTable.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return crc ^ 0xffffffffu;
+}
+
+
+//
+// _appendChunk() - appends a PNG chunk: length, type, data, and the crc of the type and data.
+//
+static void _appendChunk(vector<unsigned char> & file, const char * type, const unsigned char * data, unsigned int size)
+{
+	_appendUint32(file, size);
+	size_t typeStart = file.size();
+	file.insert(file.end(), type, type + 4);
+	if (size > 0) {
+		file.insert(file.end(), data, data + size);
+	}
+	_appendUint32(file, _crc32(&file[typeStart], 4 + size));
+}
+
+
+//
+// _filterRow() - prepends the filter type to a row; each row but the first is filtered with the "Up" filter, which costs
+// one subtraction per byte and lets zlib find the long runs of unchanged pixels that rendered frames are made of.
+//
+static void _filterRow(const unsigned char * row, const unsigned char * previousRow, size_t rowSize, vector<unsigned char> & filteredRow)
+{
+	if (previousRow == NULL) {
+		filteredRow[0] = 0;
+		memcpy(&filteredRow[1], row, rowSize);
+	}
+	else {
+		filteredRow[0] = 2;
+		for (size_t i = 0; i < rowSize; i++) {
+			filteredRow[i+1] = (unsigned char)(row[i] - previousRow[i]);
+		}
+	}
+}
+
+
+#ifndef ENABLE_ZLIB
+//
+// _storeUncompressed() - wraps data in a zlib stream of uncompressed ("stored") deflate blocks, for builds without zlib.
+//
+static void _storeUncompressed(const vector<unsigned char> & data, vector<unsigned char> & stream)
+{
+	const size_t MAX_BLOCK_SIZE = 65535;
+	stream.clear();
+	stream.reserve(data.size() + 5 * (data.size() / MAX_BLOCK_SIZE + 1) + 6);
+	stream.push_back(0x78);  // deflate with a 32K window
+	stream.push_back(0x01);  // no preset dictionary, fastest compression; makes the header a multiple of 31
+
+	size_t offset = 0;
+	do {
+		size_t blockSize = min(MAX_BLOCK_SIZE, data.size() - offset);
+		bool isLastBlock = (offset + blockSize == data.size());
+		stream.push_back(isLastBlock ? 1 : 0);
+		stream.push_back((unsigned char)(blockSize & 0xff));
+		stream.push_back((unsigned char)(blockSize >> 8));
+		stream.push_back((unsigned char)(~blockSize & 0xff));
+		stream.push_back((unsigned char)((~blockSize >> 8) & 0xff));
+		if (blockSize > 0) {
+			stream.insert(stream.end(), data.begin() + offset, data.begin() + offset + blockSize);
+		}
+		offset += blockSize;
+	} while (offset < data.size());
+
+	// the adler-32 checksum of the uncompressed data
+	unsigned int a = 1, b = 0;
+	for (size_t i = 0; i < data.size(); i++) {
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	_appendUint32(stream, (b << 16) | a);
+}
+#endif
+
+
+static void _writeFile(const string & filename, const unsigned char * data, size_t size)
+{
+	FILE * fp = fopen(filename.c_str(), "wb");
+	if (fp == NULL) {
+		throw GenericException("Could not open " + filename + " for writing.");
+	}
+	size_t numWritten = fwrite(data, 1, size, fp);
+	fclose(fp);
+	if (numWritten != size) {
+		throw GenericException("Could not write all of " + filename + ".");
+	}
+}
+
+
+void Util::writePNG(const string & filename, unsigned int width, unsigned int height, const unsigned char * rgbPixels, bool bottomRowFirst, int compressionLevel)
+{
+	const size_t rowSize = 3 * (size_t)width;
+	vector<unsigned char> filteredRow(rowSize + 1);
+	const unsigned char * previousRow = NULL;
+
+#ifdef ENABLE_ZLIB
+	z_stream stream;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	stream.opaque = Z_NULL;
+	if (deflateInit(&stream, compressionLevel) != Z_OK) {
+		throw GenericException("writePNG(): could not initialize zlib.");
+	}
+
+	vector<unsigned char> compressed(deflateBound(&stream, (uLong)((rowSize + 1) * height)));
+	stream.next_out = &compressed[0];
+	stream.avail_out = (uInt)compressed.size();
+
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char * row = rgbPixels + rowSize * (bottomRowFirst ? (height - 1 - y) : y);
+		_filterRow(row, previousRow, rowSize, filteredRow);
+		previousRow = row;
+
+		stream.next_in = &filteredRow[0];
+		stream.avail_in = (uInt)filteredRow.size();
+		if (deflate(&stream, (y + 1 == height) ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+			deflateEnd(&stream);
+			throw GenericException("writePNG(): zlib failed to compress " + filename + ".");
+		}
+	}
+	if (height == 0) {
+		deflate(&stream, Z_FINISH);
+	}
+	size_t compressedSize = compressed.size() - stream.avail_out;
+	deflateEnd(&stream);
+#else
+	vector<unsigned char> filteredImage;
+	filteredImage.reserve((rowSize + 1) * height);
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char * row = rgbPixels + rowSize * (bottomRowFirst ? (height - 1 - y) : y);
+		_filterRow(row, previousRow, rowSize, filteredRow);
+		previousRow = row;
+		filteredImage.insert(filteredImage.end(), filteredRow.begin(), filteredRow.end());
+	}
+	vector<unsigned char> compressed;
+	_storeUncompressed(filteredImage, compressed);
+	size_t compressedSize = compressed.size();
+#endif
+
+	vector<unsigned char> file;
+	file.reserve(compressedSize + 64);
+	static const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+	file.insert(file.end(), signature, signature + 8);
+
+	vector<unsigned char> header;
+	_appendUint32(header, width);
+	_appendUint32(header, height);
+	header.push_back(8);  // bit depth
+	header.push_back(2);  // color type: RGB
+	header.push_back(0);  // compression method
+	header.push_back(0);  // filter method
+	header.push_back(0);  // no interlacing
+	_appendChunk(file, "IHDR", &header[0], (unsigned int)header.size());
+	_appendChunk(file, "IDAT", compressedSize > 0 ? &compressed[0] : NULL, (unsigned int)compressedSize);
+	_appendChunk(file, "IEND", NULL, 0);
+
+	_writeFile(filename, &file[0], file.size());
+}
+
+
+void Util::writePPM(const string & filename, unsigned int width, unsigned int height, const unsigned char * rgbPixels, bool bottomRowFirst)
+{
+	const size_t rowSize = 3 * (size_t)width;
+
+	FILE * fp = fopen(filename.c_str(), "wb");
+	if (fp == NULL) {
+		throw GenericException("Could not open " + filename + " for writing.");
+	}
+	fprintf(fp, "P6 %u %u 255\n", width, height);
+
+	bool writeFailed = false;
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char * row = rgbPixels + rowSize * (bottomRowFirst ? (height - 1 - y) : y);
+		if (fwrite(row, 1, rowSize, fp) != rowSize) {
+			writeFailed = true;
+			break;
+		}
+	}
+	fclose(fp);
+
+	if (writeFailed) {
+		throw GenericException("Could not write all of " + filename + ".");
+	}
+}
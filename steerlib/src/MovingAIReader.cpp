@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file MovingAIReader.cpp
+/// @brief Implements the SteerLib::MovingAIReader class.
+
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include "testcaseio/MovingAIIO.h"
+#include "util/GenericException.h"
+#include "util/MemoryMapper.h"
+#include "util/Misc.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+namespace {
+
+	/// Reads one line of the mapped file, without the line ending; returns false at the end of the file.
+	inline bool nextLine(const char * & p, const char * end, const char * & lineBegin, const char * & lineEnd)
+	{
+		if (p >= end) return false;
+		lineBegin = p;
+		const char * newline = (const char*)memchr(p, '\n', end - p);
+		lineEnd = (newline == NULL) ? end : newline;
+		p = (newline == NULL) ? end : newline + 1;
+		if ((lineEnd > lineBegin) && (lineEnd[-1] == '\r')) lineEnd--;
+		return true;
+	}
+
+	inline bool isPassable(char c)
+	{
+		return (c == '.') || (c == 'G') || (c == 'S');
+	}
+
+} // end anonymous namespace
+
+
+bool MovingAIReader::isAMovingAIMap( const std::string & filename )
+{
+	ifstream mapFile(filename.c_str());
+	if (!mapFile.is_open()) {
+		return false;
+	}
+	std::string keyword;
+	mapFile >> keyword;
+	return (keyword == "type");
+}
+
+GridMapObstacle * MovingAIReader::readMap( const std::string & filename, float cellSize )
+{
+	MemoryMapper fileMap;
+	fileMap.open(filename);
+	const char * p = (const char*)fileMap.getBasePointer();
+	const char * end = p + fileMap.getFileSize();
+
+	// the header is a list of "keyword value" lines, ending with the line "map".
+	unsigned int width = 0, height = 0;
+	const char * lineBegin, * lineEnd;
+	bool foundMapKeyword = false;
+	while (!foundMapKeyword && nextLine(p, end, lineBegin, lineEnd)) {
+		std::istringstream line(std::string(lineBegin, lineEnd));
+		std::string keyword;
+		line >> keyword;
+		if (keyword == "type") {
+			std::string type;
+			line >> type;
+			if (type != "octile") {
+				throw GenericException("MovingAIReader::readMap(): " + filename + " has map type \"" + type + "\", only octile maps are supported.");
+			}
+		}
+		else if (keyword == "height") {
+			line >> height;
+		}
+		else if (keyword == "width") {
+			line >> width;
+		}
+		else if (keyword == "map") {
+			foundMapKeyword = true;
+		}
+		else if (keyword != "") {
+			throw GenericException("MovingAIReader::readMap(): unexpected keyword \"" + keyword + "\" in the header of " + filename + ".");
+		}
+	}
+	if (!foundMapKeyword || (width == 0) || (height == 0)) {
+		throw GenericException("MovingAIReader::readMap(): " + filename + " does not seem to be a valid MovingAI map.");
+	}
+
+	GridMapObstacle * map = new GridMapObstacle(-0.5f * width * cellSize, -0.5f * height * cellSize, cellSize, width, height);
+	for (unsigned int z = 0; z < height; z++) {
+		if (!nextLine(p, end, lineBegin, lineEnd) || ((unsigned int)(lineEnd - lineBegin) < width)) {
+			delete map;
+			throw GenericException("MovingAIReader::readMap(): row " + toString(z) + " of " + filename + " is missing or too short.");
+		}
+		for (unsigned int x = 0; x < width; x++) {
+			if (!isPassable(lineBegin[x])) {
+				map->setBlocked(x, z, true);
+			}
+		}
+	}
+
+	fileMap.close();
+	return map;
+}
+
+void MovingAIReader::readScenario( const std::string & filename, std::vector<MovingAIScenarioEntry> & entries )
+{
+	entries.clear();
+
+	ifstream scenarioFile(filename.c_str());
+	if (!scenarioFile.is_open()) {
+		throw GenericException("MovingAIReader::readScenario(): could not open " + filename + ".");
+	}
+
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (getline(scenarioFile, line)) {
+		lineNumber++;
+		if ((line.size() > 0) && (line[line.size()-1] == '\r')) {
+			line.erase(line.size()-1);
+		}
+		if ((line.find_first_not_of(" \t") == std::string::npos) || (line.compare(0, 7, "version") == 0)) {
+			continue;
+		}
+
+		// bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length; separated by tabs
+		std::istringstream fields(line);
+		MovingAIScenarioEntry entry;
+		std::string bucketField;
+		getline(fields, bucketField, '\t');
+		getline(fields, entry.mapName, '\t');
+		entry.bucket = (unsigned int)atoi(bucketField.c_str());
+		fields >> entry.mapWidth >> entry.mapHeight >> entry.startX >> entry.startY >> entry.goalX >> entry.goalY >> entry.optimalLength;
+		if (fields.fail()) {
+			throw GenericException("MovingAIReader::readScenario(): line " + toString(lineNumber) + " of " + filename + " is not a valid scenario entry.");
+		}
+		entries.push_back(entry);
+	}
+}
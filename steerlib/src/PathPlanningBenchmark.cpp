@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file PathPlanningBenchmark.cpp
+/// @brief Implements the SteerLib::PathPlanningBenchmark class.
+
+#include <math.h>
+#include "benchmarking/PathPlanningBenchmark.h"
+#include "griddatabase/GridDatabase2D.h"
+#include "util/GenericException.h"
+#include "util/HighResCounter.h"
+#include "util/Misc.h"
+
+using namespace SteerLib;
+using namespace Util;
+
+
+PathPlanningBenchmark::PathPlanningBenchmark(GridMapObstacle * map, const std::vector<MovingAIScenarioEntry> & entries)
+	: _map(map), _entries(entries)
+{
+}
+
+
+void PathPlanningBenchmark::run(const std::string & plannerName, PlanningDomainInterface * planner, unsigned int maxNodesToExpand, PathPlanningBenchmarkResults & results)
+{
+	results.plannerName = plannerName;
+	results.numQueries = (unsigned int)_entries.size();
+	results.numPathsFound = 0;
+	results.totalTime = 0.0;
+	results.queriesPerSecond = 0.0;
+	results.totalNodesExpanded = 0;
+	results.meanNodesExpanded = 0.0;
+	results.memoryUsage = 0;
+	results.meanSuboptimality = 0.0;
+	results.maxSuboptimality = 0.0;
+
+	// a path reaches the goal if it ends inside the goal cell.
+	const float goalTolerance = 0.5f * _map->getCellSize();
+
+	unsigned long long totalTicks = 0;
+	double sumSuboptimality = 0.0;
+	std::vector<Util::Point> path;
+
+	for (unsigned int i = 0; i < _entries.size(); i++) {
+		const MovingAIScenarioEntry & entry = _entries[i];
+		if ((entry.startX >= _map->getNumCellsX()) || (entry.goalX >= _map->getNumCellsX()) || (entry.startY >= _map->getNumCellsZ()) || (entry.goalY >= _map->getNumCellsZ())) {
+			throw GenericException("PathPlanningBenchmark::run(): query " + toString(i) + " of map " + entry.mapName + " is outside the " + toString(_map->getNumCellsX()) + "x" + toString(_map->getNumCellsZ()) + " map.");
+		}
+
+		Util::Point start = _map->getCellCenter(entry.startX, entry.startY);
+		Util::Point goal = _map->getCellCenter(entry.goalX, entry.goalY);
+
+		path.clear();
+		unsigned long long startTicks = getHighResCounterValue();
+		bool pathComplete = planner->findPath(start, goal, path, maxNodesToExpand);
+		totalTicks += getHighResCounterValue() - startTicks;
+
+		results.totalNodesExpanded += planner->getNumNodesExpandedInLastSearch();
+
+		if (!pathComplete || path.empty()) {
+			continue;
+		}
+		Util::Point end = path.back();
+		if ((fabsf(end.x - goal.x) > goalTolerance) || (fabsf(end.z - goal.z) > goalTolerance)) {
+			continue;
+		}
+
+		results.numPathsFound++;
+		double suboptimality = 1.0;
+		if (entry.optimalLength > 0.0) {
+			suboptimality = _computePathLength(path) / entry.optimalLength;
+		}
+		sumSuboptimality += suboptimality;
+		if (suboptimality > results.maxSuboptimality) {
+			results.maxSuboptimality = suboptimality;
+		}
+	}
+
+	results.totalTime = (double)totalTicks / (double)getHighResCounterFrequency();
+	if (results.totalTime > 0.0) {
+		results.queriesPerSecond = (double)results.numQueries / results.totalTime;
+	}
+	if (results.numQueries > 0) {
+		results.meanNodesExpanded = (double)results.totalNodesExpanded / (double)results.numQueries;
+	}
+	if (results.numPathsFound > 0) {
+		results.meanSuboptimality = sumSuboptimality / (double)results.numPathsFound;
+	}
+	results.memoryUsage = planner->getMemoryUsage();
+}
+
+
+void PathPlanningBenchmark::printResults(std::ostream & out, const PathPlanningBenchmarkResults & results)
+{
+	out << "             planner: " << results.plannerName << "\n";
+	out << "             queries: " << results.numQueries << "\n";
+	out << "         paths found: " << results.numPathsFound << " (" << (results.numQueries - results.numPathsFound) << " failed)\n";
+	out << "          total time: " << results.totalTime << " seconds\n";
+	out << "         queries/sec: " << results.queriesPerSecond << "\n";
+	out << "      nodes expanded: " << results.totalNodesExpanded << " (" << results.meanNodesExpanded << " per query)\n";
+	out << "        memory usage: " << results.memoryUsage << " bytes\n";
+	out << "  mean suboptimality: " << results.meanSuboptimality << "\n";
+	out << "   max suboptimality: " << results.maxSuboptimality << "\n";
+}
+
+
+GridDatabase2D * PathPlanningBenchmark::createGridDatabaseForMap(GridMapObstacle * map)
+{
+	const Util::AxisAlignedBox & bounds = map->getBounds();
+	// the map is kept as an obstacle layer of the database, not in its cells, so the cells need room for only one item.
+	GridDatabase2D * grid = new GridDatabase2D(Util::Point(bounds.xmin, 0.0f, bounds.zmin), bounds.xmax - bounds.xmin, bounds.zmax - bounds.zmin, map->getNumCellsX(), map->getNumCellsZ(), 1, false);
+	grid->addObject(map, bounds);
+	return grid;
+}
+
+
+//
+// _computePathLength() - sums the lengths of the segments of the path, and converts the sum into map cells.
+//
+float PathPlanningBenchmark::_computePathLength(const std::vector<Util::Point> & path)
+{
+	float length = 0.0f;
+	for (unsigned int i = 1; i < path.size(); i++) {
+		length += (path[i] - path[i-1]).length();
+	}
+	return length / _map->getCellSize();
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file PathPlanningBenchmarkModule.cpp
+/// @brief Implements the PathPlanningBenchmarkModule built-in module.
+
+#include <fstream>
+#include <sstream>
+#include "modules/PathPlanningBenchmarkModule.h"
+#include "benchmarking/PathPlanningBenchmark.h"
+#include "simulation/SimulationOptions.h"
+#include "util/GenericException.h"
+#include "util/Misc.h"
+
+using namespace SteerLib;
+
+void PathPlanningBenchmarkModule::init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo ) {
+	_engine = engineInfo;
+	_scenarioFilename = "";
+	_logFilename = "";
+	_maxNodesToExpand = DEFAULT_PATH_BENCHMARK_MAX_NODES;
+
+	// parse the options
+	SteerLib::OptionDictionary::const_iterator optionIter;
+	for (optionIter = options.begin(); optionIter != options.end(); ++optionIter) {
+		if ((*optionIter).first == "scenario") {
+			_scenarioFilename = (*optionIter).second;
+		}
+		else if ((*optionIter).first == "maxNodes") {
+			std::istringstream((*optionIter).second) >> _maxNodesToExpand;
+		}
+		else if ((*optionIter).first == "logfile") {
+			_logFilename = (*optionIter).second;
+		}
+		else {
+			throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to pathPlanningBenchmark module.");
+		}
+	}
+
+	if (_scenarioFilename == "") {
+		throw Util::GenericException("No scenario file specified for the pathPlanningBenchmark module; use the option scenario=<filename.scen>.");
+	}
+}
+
+void PathPlanningBenchmarkModule::postprocessSimulation() {
+
+	// the map is the only GridMapObstacle of the test case.
+	GridMapObstacle * map = NULL;
+	std::set<SteerLib::ObstacleInterface*>::const_iterator obstacleIter;
+	for (obstacleIter = _engine->getObstacles().begin(); obstacleIter != _engine->getObstacles().end(); ++obstacleIter) {
+		map = dynamic_cast<GridMapObstacle*>(*obstacleIter);
+		if (map != NULL) break;
+	}
+	if (map == NULL) {
+		throw Util::GenericException("The pathPlanningBenchmark module needs a MovingAI .map file as the test case.");
+	}
+
+	std::vector<MovingAIScenarioEntry> entries;
+	MovingAIReader::readScenario(_scenarioFilename, entries);
+
+	PathPlanningBenchmark benchmark(map, entries);
+	PathPlanningBenchmarkResults results;
+	benchmark.run(_engine->getOptions().planningDomainOptions.name, _engine->getPathPlanner(), _maxNodesToExpand, results);
+
+	if (_logFilename == "") {
+		PathPlanningBenchmark::printResults(std::cout, results);
+	}
+	else {
+		std::ofstream logFile(_logFilename.c_str());
+		if (!logFile.is_open()) {
+			throw Util::GenericException("Could not open " + _logFilename + " to write the path planning benchmark results.");
+		}
+		PathPlanningBenchmark::printResults(logFile, results);
+	}
+}
@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file PhaseScheduler.cpp
+/// @brief Implements the Util::PhaseScheduler class.
+
+#include "util/PhaseScheduler.h"
+#include "util/GenericException.h"
+#include <iostream>
+#include <math.h>
+
+using namespace Util;
+
+PhaseScheduler::PhaseScheduler()
+{
+	_budgetFactor = 0.0f;
+	_numClients = 0;
+	clear();
+}
+
+void PhaseScheduler::clear()
+{
+	_phases.clear();
+	_numFrames = 0;
+}
+
+unsigned int PhaseScheduler::addPhase(const std::string & name, unsigned int interval)
+{
+	if (interval == 0) {
+		throw GenericException("PhaseScheduler::addPhase(): phase \"" + name + "\" must have an interval of at least 1 frame.");
+	}
+
+	Phase phase;
+	phase.name = name;
+	phase.interval = interval;
+	phase.budget = 0;
+	phase.staggerCounter = 0;
+	phase.numExecutedThisFrame = 0;
+	phase.numDeferredThisFrame = 0;
+	phase.numMandatoryThisFrame = 0;
+	phase.maxExecutedInOneFrame = 0;
+	phase.totalExecuted = 0;
+	phase.totalMandatory = 0;
+	phase.totalDeferred = 0;
+	_phases.push_back(phase);
+
+	_updateBudgets();
+	return (unsigned int)_phases.size() - 1;
+}
+
+void PhaseScheduler::setBudgetFactor(float budgetFactor)
+{
+	_budgetFactor = (budgetFactor > 0.0f) ? budgetFactor : 0.0f;
+	_updateBudgets();
+}
+
+void PhaseScheduler::setNumClients(unsigned int numClients)
+{
+	if (numClients != _numClients) {
+		_numClients = numClients;
+		_updateBudgets();
+	}
+}
+
+void PhaseScheduler::beginFrame()
+{
+	for (unsigned int i=0; i < _phases.size(); i++) {
+		_phases[i].numExecutedThisFrame = 0;
+		_phases[i].numDeferredThisFrame = 0;
+		_phases[i].numMandatoryThisFrame = 0;
+	}
+	_numFrames++;
+}
+
+void PhaseScheduler::resetStatistics()
+{
+	for (unsigned int i=0; i < _phases.size(); i++) {
+		_phases[i].staggerCounter = 0;
+		_phases[i].numExecutedThisFrame = 0;
+		_phases[i].numDeferredThisFrame = 0;
+		_phases[i].numMandatoryThisFrame = 0;
+		_phases[i].maxExecutedInOneFrame = 0;
+		_phases[i].totalExecuted = 0;
+		_phases[i].totalMandatory = 0;
+		_phases[i].totalDeferred = 0;
+	}
+	_numFrames = 0;
+}
+
+unsigned int PhaseScheduler::getStaggerDelay(unsigned int phase)
+{
+	Phase & p = _phases[phase];
+	unsigned int staggerDelay = p.staggerCounter % p.interval;
+	p.staggerCounter = (p.staggerCounter + 1) % p.interval;
+	return staggerDelay;
+}
+
+bool PhaseScheduler::requestExecution(unsigned int phase, bool mandatory)
+{
+	Phase & p = _phases[phase];
+	if (!mandatory && (p.budget != 0) && (p.numExecutedThisFrame >= p.budget)) {
+		p.numDeferredThisFrame++;
+		p.totalDeferred++;
+		return false;
+	}
+
+	p.numExecutedThisFrame++;
+	p.totalExecuted++;
+	if (mandatory) {
+		p.numMandatoryThisFrame++;
+		p.totalMandatory++;
+	}
+	else if (p.numExecutedThisFrame - p.numMandatoryThisFrame > p.maxExecutedInOneFrame) {
+		p.maxExecutedInOneFrame = p.numExecutedThisFrame - p.numMandatoryThisFrame;
+	}
+	return true;
+}
+
+bool PhaseScheduler::beginScheduledPhase(unsigned int phase, bool & phaseHasRun, unsigned int & staggerDelay)
+{
+	if (!requestExecution(phase, !phaseHasRun)) {
+		return false;
+	}
+
+	if (phaseHasRun) {
+		// the delay was only for the second run.
+		staggerDelay = 0;
+	}
+	phaseHasRun = true;
+	return true;
+}
+
+void PhaseScheduler::displayStatistics(std::ostream & out) const
+{
+	out << "   Frames scheduled: " << _numFrames << std::endl;
+	for (unsigned int i=0; i < _phases.size(); i++) {
+		const Phase & p = _phases[i];
+		out << "   " << p.name << " (every " << p.interval << " frames, budget ";
+		if (p.budget == 0) {
+			out << "unlimited";
+		}
+		else {
+			out << p.budget << " per frame";
+		}
+		out << "): executed " << p.totalExecuted << " (" << p.totalMandatory << " mandatory), deferred " << p.totalDeferred;
+		out << ", average " << ((_numFrames == 0) ? 0.0f : (float)p.totalExecuted / (float)_numFrames) << " per frame";
+		out << ", max " << p.maxExecutedInOneFrame << " per frame excluding mandatory runs" << std::endl;
+	}
+}
+
+void PhaseScheduler::_updateBudgets()
+{
+	for (unsigned int i=0; i < _phases.size(); i++) {
+		if (_budgetFactor == 0.0f) {
+			_phases[i].budget = 0;
+		}
+		else {
+			float budget = ceilf(_budgetFactor * (float)_numClients / (float)_phases[i].interval);
+			_phases[i].budget = (budget < 1.0f) ? 1 : (unsigned int)budget;
+		}
+	}
+}
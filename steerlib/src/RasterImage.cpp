@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file RasterImage.cpp
+/// @brief Implements Util::RasterImage.
+
+#include <math.h>
+#include <algorithm>
+#include "util/RasterImage.h"
+#include "util/ImageWriter.h"
+#include "util/GenericException.h"
+
+using namespace Util;
+
+
+//
+// _toByte() - converts a color component from 0..1 to 0..255.
+//
+static inline unsigned char _toByte(float c)
+{
+	if (c <= 0.0f) return 0;
+	if (c >= 1.0f) return 255;
+	return (unsigned char)(c * 255.0f + 0.5f);
+}
+
+
+static inline float _clampCoverage(float coverage)
+{
+	return (coverage < 0.0f) ? 0.0f : ((coverage > 1.0f) ? 1.0f : coverage);
+}
+
+
+RasterImage::RasterImage(unsigned int width, unsigned int height)
+{
+	if ((width == 0) || (height == 0)) {
+		throw GenericException("RasterImage: the width and height must be at least 1 pixel.");
+	}
+	_width = width;
+	_height = height;
+	_pixels.resize(3 * (size_t)width * height);
+	setWorldBounds(-1.0f, 1.0f, -1.0f, 1.0f);
+}
+
+
+void RasterImage::setWorldBounds(float xmin, float xmax, float zmin, float zmax)
+{
+	float worldWidth = std::max(xmax - xmin, 1e-6f);
+	float worldHeight = std::max(zmax - zmin, 1e-6f);
+	_scale = std::min((float)_width / worldWidth, (float)_height / worldHeight);
+	_offsetX = 0.5f * (float)_width - 0.5f * (xmin + xmax) * _scale;
+	_offsetY = 0.5f * (float)_height - 0.5f * (zmin + zmax) * _scale;
+}
+
+
+void RasterImage::clear(const Color & color)
+{
+	unsigned char rgb[3] = { _toByte(color.r), _toByte(color.g), _toByte(color.b) };
+	for (size_t i = 0; i < _pixels.size(); i += 3) {
+		_pixels[i] = rgb[0];
+		_pixels[i+1] = rgb[1];
+		_pixels[i+2] = rgb[2];
+	}
+}
+
+
+inline void RasterImage::_blend(unsigned int x, unsigned int y, const unsigned char rgb[3], float coverage)
+{
+	unsigned char * p = &_pixels[3 * ((size_t)y * _width + x)];
+	if (coverage >= 1.0f) {
+		p[0] = rgb[0];
+		p[1] = rgb[1];
+		p[2] = rgb[2];
+	}
+	else {
+		p[0] = (unsigned char)(p[0] + ((float)rgb[0] - (float)p[0]) * coverage + 0.5f);
+		p[1] = (unsigned char)(p[1] + ((float)rgb[1] - (float)p[1]) * coverage + 0.5f);
+		p[2] = (unsigned char)(p[2] + ((float)rgb[2] - (float)p[2]) * coverage + 0.5f);
+	}
+}
+
+
+bool RasterImage::_clip(float xmin, float xmax, float ymin, float ymax, int & x0, int & x1, int & y0, int & y1) const
+{
+	if ((xmax < 0.0f) || (ymax < 0.0f) || (xmin >= (float)_width) || (ymin >= (float)_height)) {
+		return false;
+	}
+	x0 = std::max(0, (int)floorf(xmin));
+	y0 = std::max(0, (int)floorf(ymin));
+	x1 = std::min((int)_width - 1, (int)floorf(xmax));
+	y1 = std::min((int)_height - 1, (int)floorf(ymax));
+	return (x0 <= x1) && (y0 <= y1);
+}
+
+
+void RasterImage::fillBox(float xmin, float xmax, float zmin, float zmax, const Color & color)
+{
+	unsigned char rgb[3] = { _toByte(color.r), _toByte(color.g), _toByte(color.b) };
+	float left = xmin * _scale + _offsetX;
+	float right = xmax * _scale + _offsetX;
+	float top = zmin * _scale + _offsetY;
+	float bottom = zmax * _scale + _offsetY;
+
+	int x0, x1, y0, y1;
+	if (!_clip(left, right, top, bottom, x0, x1, y0, y1)) {
+		return;
+	}
+
+	// the coverage of a pixel by an axis-aligned box is the product of its coverage along each axis.
+	for (int y = y0; y <= y1; y++) {
+		float coverageY = _clampCoverage(std::min((float)y + 1.0f, bottom) - std::max((float)y, top));
+		for (int x = x0; x <= x1; x++) {
+			float coverageX = _clampCoverage(std::min((float)x + 1.0f, right) - std::max((float)x, left));
+			float coverage = coverageX * coverageY;
+			if (coverage > 0.0f) {
+				_blend(x, y, rgb, coverage);
+			}
+		}
+	}
+}
+
+
+void RasterImage::fillDisc(const Point & center, float radius, const Color & color)
+{
+	unsigned char rgb[3] = { _toByte(color.r), _toByte(color.g), _toByte(color.b) };
+	float cx = center.x * _scale + _offsetX;
+	float cy = center.z * _scale + _offsetY;
+	float r = radius * _scale;
+
+	int x0, x1, y0, y1;
+	if (!_clip(cx - r - 1.0f, cx + r + 1.0f, cy - r - 1.0f, cy + r + 1.0f, x0, x1, y0, y1)) {
+		return;
+	}
+
+	for (int y = y0; y <= y1; y++) {
+		float dy = (float)y + 0.5f - cy;
+		for (int x = x0; x <= x1; x++) {
+			float dx = (float)x + 0.5f - cx;
+			float coverage = _clampCoverage(r + 0.5f - sqrtf(dx*dx + dy*dy));
+			if (coverage > 0.0f) {
+				_blend(x, y, rgb, coverage);
+			}
+		}
+	}
+}
+
+
+void RasterImage::drawLine(const Point & a, const Point & b, float widthInPixels, const Color & color)
+{
+	unsigned char rgb[3] = { _toByte(color.r), _toByte(color.g), _toByte(color.b) };
+	float ax = a.x * _scale + _offsetX;
+	float ay = a.z * _scale + _offsetY;
+	float bx = b.x * _scale + _offsetX;
+	float by = b.z * _scale + _offsetY;
+	float halfWidth = 0.5f * widthInPixels;
+
+	int x0, x1, y0, y1;
+	float margin = halfWidth + 1.0f;
+	if (!_clip(std::min(ax, bx) - margin, std::max(ax, bx) + margin, std::min(ay, by) - margin, std::max(ay, by) + margin, x0, x1, y0, y1)) {
+		return;
+	}
+
+	float abx = bx - ax;
+	float aby = by - ay;
+	float lengthSquared = abx*abx + aby*aby;
+	float inverseLengthSquared = (lengthSquared > 0.0f) ? 1.0f / lengthSquared : 0.0f;
+
+	for (int y = y0; y <= y1; y++) {
+		float py = (float)y + 0.5f - ay;
+		for (int x = x0; x <= x1; x++) {
+			float px = (float)x + 0.5f - ax;
+			// distance from the pixel center to the closest point of the segment.
+			float t = (px*abx + py*aby) * inverseLengthSquared;
+			t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+			float dx = px - t*abx;
+			float dy = py - t*aby;
+			float coverage = _clampCoverage(halfWidth + 0.5f - sqrtf(dx*dx + dy*dy));
+			if (coverage > 0.0f) {
+				_blend(x, y, rgb, coverage);
+			}
+		}
+	}
+}
+
+
+void RasterImage::writePNG(const std::string & filename, int compressionLevel) const
+{
+	Util::writePNG(filename, _width, _height, &_pixels[0], false, compressionLevel);
+}
@@ -23,6 +23,8 @@ void RecFilePlayerModule::init( const SteerLib::OptionDictionary & options, Stee
 {
 	_recFilename = "";
 	_playbackSpeed = 1.0;
+	_numReadAheadFrames = DEFAULT_REC_FILE_READ_AHEAD_FRAMES;
+	_simulationReader = NULL;
 	_engine = engineInfo;
 
 	// parse the options
@@ -37,6 +39,9 @@ void RecFilePlayerModule::init( const SteerLib::OptionDictionary & options, Stee
 		else if ((*optionIter).first == "recfile") {
 			_recFilename = (*optionIter).second;
 		}
+		else if ((*optionIter).first == "readAhead") {
+			std::istringstream((*optionIter).second) >> _numReadAheadFrames;
+		}
 		else {
 			throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to recFilePlayer module.");
 		}
@@ -99,6 +104,7 @@ void RecFilePlayerModule::initializeSimulation()
 	if (_recFilename == "") {
 		throw Util::GenericException("No rec file specified for playback.");
 	}
+	delete _simulationReader;
 	_simulationReader = new SteerLib::RecFileReader( _recFilename );
 	if (_simulationReader->getNumFrames() == 0) {
 		throw GenericException("ReplayAIModule::init() - playback file " + _simulationReader->getFilename() + " has no frames, cannot replay.");
@@ -112,6 +118,8 @@ void RecFilePlayerModule::initializeSimulation()
 	_simulationStopTime = _simulationReader->getTimeStampForFrame(_simulationReader->getNumFrames()-1);
 	_currentTimeToPlayback = _simulationReader->getTimeStampForFrame(0);
 
+	_simulationReader->setReadAhead(_numReadAheadFrames);
+
 	// for a fixed frame rate, the following default for is effectively 1 frame per step.
 	_fixedTimeStep = _simulationReader->getTotalElapsedTime() / ((double)(_simulationReader->getNumFrames()-1));
 
@@ -165,6 +173,9 @@ void RecFilePlayerModule::cleanupSimulation()
 	_obstacles.clear();
 
 	_engine->destroyAllAgentsFromModule(this);
+
+	delete _simulationReader;
+	_simulationReader = NULL;
 }
 
 
@@ -175,34 +186,38 @@ void RecFilePlayerModule::preprocessFrame(float timeStamp, float dt, unsigned in
 	const std::vector< SteerLib::AgentInterface * > & agents = _engine->getAgents();
 
 	// for HybridAI
-	std::vector< SteerLib::AgentInterface * > * tmp_agents = new std::vector< SteerLib::AgentInterface * >();
+	std::vector< SteerLib::AgentInterface * > tmp_agents;
 	for (int a=0; a < agents.size(); a++)
 	{
 		SteerLib::AgentInterface * tmp_agent = dynamic_cast<ReplayAgent *>(agents.at(a));
 		if ( tmp_agent != NULL )
 		{
-			tmp_agents->push_back(tmp_agent);
+			tmp_agents.push_back(tmp_agent);
 		}
 	}
 
+	// all agents are read at once, so the frames for this time are only looked up once.
+	_simulationReader->getAgentStatesAtTime((float)_currentTimeToPlayback, _agentStates);
 
-	for (unsigned int i=0;  i < tmp_agents->size(); i++)
+	for (unsigned int i=0;  (i < tmp_agents.size()) && (i < _agentStates.size()); i++)
 	{
+		const RecFileAgentState & state = _agentStates[i];
+
 		/// @todo
 		///   The next version of the RecFileReader should also return an AgentGoalInfo struct, and this indirection should be unnecessary.
 		AgentGoalInfo newGoal;
-		newGoal.targetLocation = _simulationReader->getAgentGoalAtTime(i,(float)_currentTimeToPlayback);
+		newGoal.targetLocation = state.goal;
 		ReplayAgent * agent;
-		agent = dynamic_cast<ReplayAgent*>(tmp_agents->at(i));
+		agent = dynamic_cast<ReplayAgent*>(tmp_agents.at(i));
 		Util::AxisAlignedBox oldBounds(agent->position().x-agent->radius(),
 								agent->position().x+agent->radius(), 0.0f, 0.5f,
 								agent->position().z-agent->radius(), agent->position().z+agent->radius());
 		Util::Point oldLoc = agent->position();
 
-	    agent->setPosition(_simulationReader->getAgentLocationAtTime(i,(float)_currentTimeToPlayback));
-		agent->setForward(_simulationReader->getAgentOrientationAtTime(i,(float)_currentTimeToPlayback));
-		agent->setEnabled(_simulationReader->isAgentEnabledAtTime(i,(float)_currentTimeToPlayback));
-		agent->setRadius(_simulationReader->getAgentRadiusAtTime(i,(float)_currentTimeToPlayback));
+	    agent->setPosition(state.position);
+		agent->setForward(state.direction);
+		agent->setEnabled(state.enabled);
+		agent->setRadius(state.radius);
 		agent->setCurrentGoal(newGoal);
 		// Somewhat good approximation of
 		agent->setVelocity((oldLoc-(agent->position())).length()/dt * agent->forward());
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include <math.h>
 
 #include "util/GenericException.h"
@@ -41,6 +42,70 @@ using namespace Util;
 	} \
 
 
+//
+// interpolation between two frames, shared by the per-agent and the all-agent queries so that both give the same values.
+// beta is the fraction of the time between the first and second frame.
+//
+static inline void interpolateLocation(const RecFilePointData & p1, const RecFilePointData & p2, float beta, float &posx, float &posy, float &posz)
+{
+	float alpha = 1.0f - beta;
+
+	posx = alpha*p1.x + beta*p2.x;
+	posy = alpha*p1.y + beta*p2.y;
+	posz = alpha*p1.z + beta*p2.z;
+}
+
+static inline void interpolateOrientation(const RecFileVectorData & v1, const RecFileVectorData & v2, float beta, float &dirx, float &diry, float &dirz)
+{
+	RecFileVectorData r1;
+
+	// WARNING: assuming 2-d x-z plane only right now.  eventually NEED to fix this to be generally 3D.
+	if ((v1.y != 0.0f) && (v2.y != 0.0f)) {
+		throw GenericException("currently assuming that orientation is 2D in the x-z plane - cannot interpolate if y component is non-zero.");
+	}
+
+	r1.x = -v1.z;
+	r1.y = v1.y;
+	r1.z = v1.x;
+
+	double invNorm1 = 1.0f / sqrtf(v1.x*v1.x + v1.y*v1.y + v1.z*v1.z);
+	double invNorm2 = 1.0f / sqrtf(v2.x*v2.x + v2.y*v2.y + v2.z*v2.z);
+
+	double alpha = beta;
+	double cosRatio = ((double)(v1.x*v2.x + v1.y*v2.y + v1.z*v2.z)) * invNorm1 * invNorm2;  // cos x = v1 dot v2 / (|v1| |v2|)
+
+	if (cosRatio > 1.0) cosRatio = 1.0;
+	if (cosRatio < -1.0) cosRatio = -1.0;
+
+	if ( (r1.x*v2.x + r1.y*v2.y + r1.z*v2.z) < 0)
+		alpha = -alpha;
+		
+
+	double angle;
+	if (cosRatio >= 1.0f)
+		angle = alpha * acos( cosRatio );
+	else
+		angle = alpha * acos( cosRatio );
+
+
+	dirx = (float)(cos(angle) * v1.x - sin(angle) * v1.z);
+	diry = v1.y;
+	dirz = (float)(sin(angle) * v1.x + cos(angle) * v1.z);
+
+	// for debugging - return non-interpolated vectors
+	//dirx = v1.x;
+	//diry = v1.y;
+	//dirz = v1.z;
+}
+
+static inline float interpolateRadius(float radius1, float radius2, float beta)
+{
+	// TODO: should we interpolate the radius? 
+	float alpha = 1.0f - beta;
+	return alpha * radius1 + beta * radius2;
+}
+
+
 void RecFileReaderPrivate::_getFramesForTime(float time, unsigned int &frameIndex1, unsigned int &frameIndex2)
 {
 	// the previous values of f1 and f2 are saved in the class, so we can just quickly test if the requested time
@@ -56,11 +121,16 @@ void RecFileReaderPrivate::_getFramesForTime(float time, unsigned int &frameInde
 	if ((time >= _frameTable[f1].timeStamp) && (time <= _frameTable[f2].timeStamp)) {
 		// nothing to do, f1 and f2 are still the correct answer.
 	}
-	else if ((time >= _frameTable[f2].timeStamp) && (time <= _frameTable[f2+1].timeStamp)) {
+	else if ((f2+1 < _header->numFrames) && (time >= _frameTable[f2].timeStamp) && (time <= _frameTable[f2+1].timeStamp)) {
 		// f1 and f2 are just the next interval of frames.
 		f1 = f2;
 		f2 = f2+1;
 	}
+	else if ((f1 > 0) && (time >= _frameTable[f1-1].timeStamp) && (time <= _frameTable[f1].timeStamp)) {
+		// f1 and f2 are just the previous interval of frames, when playing backwards.
+		f2 = f1;
+		f1 = f1-1;
+	}
 	else {
 		// we coulnd't find the right one by guessing, so actually perform the binary search.
 		f1 = 0;
@@ -88,6 +158,8 @@ void RecFileReaderPrivate::_getFramesForTime(float time, unsigned int &frameInde
 	frameIndex2 = f2;
 	prevTime = time;
 
+	_readAhead(frameIndex2);
+
 	if ((frameIndex1 > frameIndex2) || (time < _frameTable[frameIndex1].timeStamp) || (time > _frameTable[frameIndex2].timeStamp)) {
 		cerr << "INTERNAL ERROR in RecFileReaderPrivate::_getFramesForTime(), invalid args specified.\n";
 		assert(false);
@@ -97,6 +169,78 @@ void RecFileReaderPrivate::_getFramesForTime(float time, unsigned int &frameInde
 }
 
 
+//
+// _readAhead() - while frames are read in order, keeps the read-ahead thread up to _numReadAheadFrames ahead of frameIndex.
+//
+void RecFileReaderPrivate::_readAhead(unsigned int frameIndex)
+{
+	if (_readAheadTaskManager == NULL) {
+		return;
+	}
+
+	// playback is sequential if it moves forward without skipping past the frames already read ahead.
+	bool sequential = (frameIndex >= _lastFrameRead) && (frameIndex <= _readAheadEndFrame);
+	_lastFrameRead = frameIndex;
+	if (!sequential) {
+		// a jump, for example scrubbing or playing backwards; start over after this frame.
+		_readAheadEndFrame = frameIndex + 1;
+		return;
+	}
+
+	// read ahead in batches of half the window, so that each task covers many frames.
+	if (_readAheadEndFrame <= frameIndex) {
+		_readAheadEndFrame = frameIndex + 1;
+	}
+	if (_readAheadEndFrame >= _header->numFrames || _readAheadEndFrame > frameIndex + _numReadAheadFrames / 2) {
+		return;
+	}
+	unsigned int endFrame = std::min(frameIndex + 1 + _numReadAheadFrames, _header->numFrames);
+
+	ReadAheadRange * range = new ReadAheadRange;
+	range->firstByte = (const char*)_frames[_readAheadEndFrame];
+	range->numBytes = ((const char*)_frames[endFrame-1] - range->firstByte) + _header->frameSize;
+	_readAheadEndFrame = endFrame;
+
+	Util::Task task;
+	task.function = &RecFileReaderPrivate::_readAheadTask;
+	task.data = range;
+	_readAheadTaskManager->addTask(task, true);
+}
+
+
+//
+// _stopReadAhead() - waits for the read-ahead thread to finish its tasks, and then stops it; must be called before the file is unmapped.
+//
+void RecFileReaderPrivate::_stopReadAhead()
+{
+	if (_readAheadTaskManager != NULL) {
+		_readAheadTaskManager->waitForAllTasksToComplete();
+		delete _readAheadTaskManager;
+		_readAheadTaskManager = NULL;
+	}
+}
+
+
+//
+// _readAheadTask() - reads one byte of every page in the range, so the OS loads the memory mapped pages.
+//
+void RecFileReaderPrivate::_readAheadTask(unsigned int threadIndex, void * data)
+{
+	ReadAheadRange * range = (ReadAheadRange*)data;
+
+	const size_t pageSize = 4096;
+	volatile char sum = 0;
+	for (size_t offset = 0; offset < range->numBytes; offset += pageSize) {
+		sum += range->firstByte[offset];
+	}
+	if (range->numBytes > 0) {
+		sum += range->firstByte[range->numBytes-1];
+	}
+
+	delete range;
+}
+
+
 
 //===========================================================================
 //===========================================================================
@@ -119,6 +263,11 @@ RecFileReader::RecFileReader()
 	f1_used_in_getFramesForTimeFunction = 0;
 	f2_used_in_getFramesForTimeFunction = 0;
 	prevTime_used_in_getFramesForTimeFunction = 0.0f;
+
+	_readAheadTaskManager = NULL;
+	_numReadAheadFrames = 0;
+	_lastFrameRead = 0;
+	_readAheadEndFrame = 0;
 }
 
 //
@@ -139,6 +288,11 @@ RecFileReader::RecFileReader(const std::string & filename)
 	f1_used_in_getFramesForTimeFunction = 0;
 	f2_used_in_getFramesForTimeFunction = 0;
 	prevTime_used_in_getFramesForTimeFunction = 0.0f;
+
+	_readAheadTaskManager = NULL;
+	_numReadAheadFrames = 0;
+	_lastFrameRead = 0;
+	_readAheadEndFrame = 0;
 	open(filename);
 }
 
@@ -148,6 +302,7 @@ RecFileReader::RecFileReader(const std::string & filename)
 //
 RecFileReader::~RecFileReader()
 {
+	_stopReadAhead();
 	if (_fileMap.isOpen()) _fileMap.close();
 	if (_frames != NULL) delete [] _frames;
 }
@@ -246,6 +401,7 @@ void RecFileReader::open(const std::string & filename)
 //
 void RecFileReader::close()
 {
+	_stopReadAhead();
 	if (_fileMap.isOpen()) _fileMap.close();
 	if (_frames != NULL) delete [] _frames;
 
@@ -258,6 +414,31 @@ void RecFileReader::close()
 	_cameraList = NULL;
 	_frameTable = NULL;
 	_frames = NULL;
+	_numReadAheadFrames = 0;
+}
+
+
+//
+// setReadAhead()
+//
+void RecFileReader::setReadAhead( unsigned int numFrames )
+{
+	_stopReadAhead();
+	_numReadAheadFrames = numFrames;
+	_lastFrameRead = 0;
+	_readAheadEndFrame = 0;
+	if (numFrames == 0) {
+		return;
+	}
+
+	try {
+		_readAheadTaskManager = new ThreadedTaskManager(1);
+	}
+	catch (std::exception & e) {
+		// reading ahead is only an optimization; without threads, frames are simply read when they are needed.
+		cerr << "WARNING: RecFileReader cannot read ahead without threads:\n" << e.what() << "\n";
+		_numReadAheadFrames = 0;
+	}
 }
 
 
@@ -445,15 +626,8 @@ void RecFileReader::getAgentLocationAtTime( unsigned int agentIndex, float time,
 	unsigned int frameIndex1, frameIndex2;
 	_getFramesForTime(time, frameIndex1, frameIndex2);
 	
-	RecFilePointData p1 = _frames[frameIndex1][agentIndex].pos;
-	RecFilePointData p2 = _frames[frameIndex2][agentIndex].pos;
-
 	float beta = (time-_frameTable[frameIndex1].timeStamp) / _frameTable[frameIndex1].dtToNextFrame;
-	float alpha = 1.0f - beta;
-
-	posx = alpha*p1.x + beta*p2.x;
-	posy = alpha*p1.y + beta*p2.y;
-	posz = alpha*p1.z + beta*p2.z;
+	interpolateLocation(_frames[frameIndex1][agentIndex].pos, _frames[frameIndex2][agentIndex].pos, beta, posx, posy, posz);
 }
 
 
@@ -468,47 +642,8 @@ void RecFileReader::getAgentOrientationAtTime( unsigned int agentIndex, float ti
 	unsigned int frameIndex1, frameIndex2;
 	_getFramesForTime(time, frameIndex1, frameIndex2);
 	
-	RecFileVectorData v1 = _frames[frameIndex1][agentIndex].dir;
-	RecFileVectorData v2 = _frames[frameIndex2][agentIndex].dir;
-	RecFileVectorData r1;
-
-	// WARNING: assuming 2-d x-z plane only right now.  eventually NEED to fix this to be generally 3D.
-	if ((v1.y != 0.0f) && (v2.y != 0.0f)) {
-		throw GenericException("currently assuming that orientation is 2D in the x-z plane - cannot interpolate if y component is non-zero.");
-	}
-
-	r1.x = -v1.z;
-	r1.y = v1.y;
-	r1.z = v1.x;
-
-	double invNorm1 = 1.0f / sqrtf(v1.x*v1.x + v1.y*v1.y + v1.z*v1.z);
-	double invNorm2 = 1.0f / sqrtf(v2.x*v2.x + v2.y*v2.y + v2.z*v2.z);
-
-	double alpha = (time-_frameTable[frameIndex1].timeStamp) / _frameTable[frameIndex1].dtToNextFrame;
-	double cosRatio = ((double)(v1.x*v2.x + v1.y*v2.y + v1.z*v2.z)) * invNorm1 * invNorm2;  // cos x = v1 dot v2 / (|v1| |v2|)
-
-	if (cosRatio > 1.0) cosRatio = 1.0;
-	if (cosRatio < -1.0) cosRatio = -1.0;
-
-	if ( (r1.x*v2.x + r1.y*v2.y + r1.z*v2.z) < 0)
-		alpha = -alpha;
-		
-
-	double angle;
-	if (cosRatio >= 1.0f)
-		angle = alpha * acos( cosRatio );
-	else
-		angle = alpha * acos( cosRatio );
-
-
-	dirx = (float)(cos(angle) * _frames[frameIndex1][agentIndex].dir.x - sin(angle) * _frames[frameIndex1][agentIndex].dir.z);
-	diry = _frames[frameIndex1][agentIndex].dir.y;
-	dirz = (float)(sin(angle) * _frames[frameIndex1][agentIndex].dir.x + cos(angle) * _frames[frameIndex1][agentIndex].dir.z);
-
-	// for debugging - return non-interpolated vectors
-	//dirx = _frames[frameIndex1][agentIndex].dir.x;
-	//diry = _frames[frameIndex1][agentIndex].dir.y;
-	//dirz = _frames[frameIndex1][agentIndex].dir.z;
+	float beta = (time-_frameTable[frameIndex1].timeStamp) / _frameTable[frameIndex1].dtToNextFrame;
+	interpolateOrientation(_frames[frameIndex1][agentIndex].dir, _frames[frameIndex2][agentIndex].dir, beta, dirx, diry, dirz);
 }
 
 
@@ -541,11 +676,8 @@ float RecFileReader::getAgentRadiusAtTime( unsigned int agentIndex, float time)
 	unsigned int frameIndex1, frameIndex2;
 	_getFramesForTime(time, frameIndex1, frameIndex2);
 
-	// TODO: should we interpolate the radius? 
 	float beta = (time-_frameTable[frameIndex1].timeStamp) / _frameTable[frameIndex1].dtToNextFrame;
-	float alpha = 1.0f - beta;
-	float radius = alpha * _frames[frameIndex1][agentIndex].radius + beta * _frames[frameIndex2][agentIndex].radius;
-	return radius;
+	return interpolateRadius(_frames[frameIndex1][agentIndex].radius, _frames[frameIndex2][agentIndex].radius, beta);
 }
 
 
@@ -587,4 +719,47 @@ bool RecFileReader::isAgentEnabledAtTime( unsigned int agentIndex, float time )
 }
 
 
+//
+// getAgentStatesAtFrame()
+//
+void RecFileReader::getAgentStatesAtFrame( unsigned int frameNumber, RecFileAgentState * agentStates )
+{
+	CHECK_MAX_INDEX(frameNumber, _header->numFrames, "frameNumber", "getAgentStatesAtFrame()");
+
+	_readAhead(frameNumber);
+
+	const RecFileAgentInfo * frame = _frames[frameNumber];
+	for (unsigned int i=0; i < _header->numAgents; i++) {
+		RecFileAgentState & state = agentStates[i];
+		state.position = Point(frame[i].pos.x, frame[i].pos.y, frame[i].pos.z);
+		state.direction = Vector(frame[i].dir.x, frame[i].dir.y, frame[i].dir.z);
+		state.goal = Point(frame[i].goal.x, frame[i].goal.y, frame[i].goal.z);
+		state.radius = frame[i].radius;
+		state.enabled = frame[i].enabled;
+	}
+}
+
 
+//
+// getAgentStatesAtTime()
+//
+void RecFileReader::getAgentStatesAtTime( float time, RecFileAgentState * agentStates )
+{
+	CHECK_BOUNDS(time,_frameTable[0].timeStamp,_frameTable[_header->numFrames-1].timeStamp, "time", "getAgentStatesAtTime()");
+
+	unsigned int frameIndex1, frameIndex2;
+	_getFramesForTime(time, frameIndex1, frameIndex2);
+
+	float beta = (time-_frameTable[frameIndex1].timeStamp) / _frameTable[frameIndex1].dtToNextFrame;
+	const RecFileAgentInfo * frame1 = _frames[frameIndex1];
+	const RecFileAgentInfo * frame2 = _frames[frameIndex2];
+	for (unsigned int i=0; i < _header->numAgents; i++) {
+		RecFileAgentState & state = agentStates[i];
+		interpolateLocation(frame1[i].pos, frame2[i].pos, beta, state.position.x, state.position.y, state.position.z);
+		interpolateOrientation(frame1[i].dir, frame2[i].dir, beta, state.direction.x, state.direction.y, state.direction.z);
+		// same as the per-agent queries: the goal does not interpolate, and the agent must be enabled on both frames.
+		state.goal = Point(frame2[i].goal.x, frame2[i].goal.y, frame2[i].goal.z);
+		state.radius = interpolateRadius(frame1[i].radius, frame2[i].radius, beta);
+		state.enabled = (frame1[i].enabled && frame2[i].enabled);
+	}
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file RenderSnapshot.cpp
+/// @brief Implements the SteerLib::RenderSnapshotBuffer class.
+
+#include <algorithm>
+#include "simulation/RenderSnapshot.h"
+
+using namespace SteerLib;
+
+
+RenderSnapshotBuffer::RenderSnapshotBuffer()
+{
+	clear();
+}
+
+
+void RenderSnapshotBuffer::clear()
+{
+	_writeIndex = 0;
+	_readyIndex = 1;
+	_readIndex = 2;
+	_hasNewSnapshot = false;
+	_hasReadSnapshot = false;
+}
+
+
+void RenderSnapshotBuffer::publish()
+{
+	_lock.lock();
+	std::swap(_writeIndex, _readyIndex);
+	_hasNewSnapshot = true;
+	_lock.unlock();
+}
+
+
+const RenderSnapshot * RenderSnapshotBuffer::acquireLatest()
+{
+	_lock.lock();
+	if (_hasNewSnapshot) {
+		std::swap(_readIndex, _readyIndex);
+		_hasNewSnapshot = false;
+		_hasReadSnapshot = true;
+	}
+	_lock.unlock();
+
+	return _hasReadSnapshot ? &_snapshots[_readIndex] : NULL;
+}
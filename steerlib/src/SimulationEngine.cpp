@@ -24,8 +24,11 @@
 #include "modules/SteerBenchModule.h"
 #include "modules/MetricsCollectorModule.h"
 #include "modules/SimulationRecorderModule.h"
+#include "modules/PathPlanningBenchmarkModule.h"
+#include "modules/TopDownRendererModule.h"
 // #include "modules/SpatialDatabaseModule.h"
 #include "griddatabase/GridDatabase2D.h"
+#include "griddatabase/HashedGridDatabase2D.h"
 #include "griddatabase/GridDatabasePlanningDomain.h"
 // #include "kdtree/KdTreeDataBase.h"
 #include "interfaces/SpatialDataBaseModuleInterface.h"
@@ -34,6 +37,9 @@
 
 // to handle user input properly with GLFW_PRESS and GLFW_RELEASE macros
 #include "glfw/include/GL/glfw.h"
+#ifdef ENABLE_GUI
+#include "util/DrawBatch.h"
+#endif
 
 using namespace std;
 using namespace SteerLib;
@@ -41,6 +47,9 @@ using namespace Util;
 
 // #define _DEBUG 1
 
+/// The scene is divided into this many tiles along x and z when obstacles are compiled for batched drawing.
+#define NUM_OBSTACLE_DRAW_TILES_PER_SIDE 16
+
 
 SimulationEngine::SimulationEngine()
 {
@@ -59,11 +68,18 @@ void SimulationEngine::_reset()
 	_agentOwners.clear();
 	_commands.clear();
 	_obstacles.clear();
+	_staticObstacleGeometry.clear();
+	_staticObstacleGeometryIsCurrent = false;
 	//_clock reset ???;
 	//_camera reset ???;
 	_spatialDatabase = NULL;
 	_engineController = NULL;
 	_numFramesSimulated = 0;
+	_renderSnapshotsEnabled = false;
+	_renderSnapshots.clear();
+	_obstacleDrawTiles.clear();
+	_obstacleDrawTilesAreCurrent = false;
+	_drawBatch = NULL;
 	_simulationLoaded = false;
 	_simulationRunning = false;
 	_simulationDone = false;
@@ -108,6 +124,18 @@ void SimulationEngine::init(SimulationOptions * options, SteerLib::EngineControl
 	}
 	_clock.setClockMode(clockMode, _options->engineOptions.fixedFPS, _options->engineOptions.minVariableDt, _options->engineOptions.maxVariableDt);
 
+	Clock::FramePacingEnum framePacing;
+	if (_options->engineOptions.framePacing == "busy-wait") {
+		framePacing = Clock::FRAME_PACING_BUSY_WAIT;
+	}
+	else if (_options->engineOptions.framePacing == "sleep") {
+		framePacing = Clock::FRAME_PACING_SLEEP;
+	}
+	else {
+		framePacing = Clock::FRAME_PACING_HYBRID;
+	}
+	_clock.setFramePacing(framePacing, _options->engineOptions.framePacingSpinTime);
+
 	if(!_testcaseCameraView)
 	{
 		_camera.reset();
@@ -133,6 +161,11 @@ void SimulationEngine::init(SimulationOptions * options, SteerLib::EngineControl
 		// _pathPlanner = new GridDatabasePlanningDomain(grid);
 
 	}
+	else if ( _options->spatialDatabaseOptions.name == "hashedGridDatabase")
+	{// the grid size and number of cells only set the size of a cell and the cell indices; objects outside of them are kept too.
+		std::cout << "Creating spatialdatabase: " << _options->spatialDatabaseOptions.name << std::endl;
+		_spatialDatabase = new HashedGridDatabase2D(xmin, xmax, zmin, zmax, _options->gridDatabaseOptions.numGridCellsX, _options->gridDatabaseOptions.numGridCellsZ, _options->gridDatabaseOptions.drawGrid);
+	}
 	else if ( _options->spatialDatabaseOptions.name == "kdTreeDatabase")
 	{// This might still be done better
 		// _spatialDatabase = new KdTreeDataBase(this);
@@ -351,11 +384,15 @@ void SimulationEngine::finish()
 
 	// should make griddatabase a module
 
-	if ( (_options->spatialDatabaseOptions.name == "gridDatabase") && _spatialDatabase != NULL)
+	if ( ((_options->spatialDatabaseOptions.name == "gridDatabase") || (_options->spatialDatabaseOptions.name == "hashedGridDatabase")) && _spatialDatabase != NULL)
 	{
 		delete _spatialDatabase;
 	}
 	_commands.clear();
+#ifdef ENABLE_GUI
+	delete _drawBatch;
+	_drawBatch = NULL;
+#endif
 	// this->_pathPlanner cleanup??
 	//_clock cleanup??
 	//_camera cleanup??
@@ -377,6 +414,8 @@ void SimulationEngine::initializeSimulation()
 	_engineState.transitionToState(ENGINE_STATE_LOADING_SIMULATION);
 
 	_clock.reset();
+	_numFramesSimulated = 0;
+	_stop = false;
 
 	// iterate over all modules asking them to initialize.
 	std::vector<SteerLib::ModuleInterface*>::iterator iter;
@@ -398,6 +437,14 @@ void SimulationEngine::cleanupSimulation()
 		(*iter)->cleanupSimulation();
 	}
 
+	// forget the per-simulation bookkeeping, so that the engine can load another simulation.
+	_init_agents.clear();
+	_agents_ai.clear();
+	if (_agents.empty()) {
+		_agentInitialConditions.clear();
+		_spawned_agent_emitter_num.clear();
+	}
+
 	_clock.reset();
 
 	_engineState.transitionToState(ENGINE_STATE_READY);
@@ -409,6 +456,9 @@ void SimulationEngine::preprocessSimulation()
 {
 	_engineState.transitionToState(ENGINE_STATE_PREPROCESSING_SIMULATION);
 
+	// all static obstacles exist by now; compile them once, before any module or agent needs them.
+	getStaticObstacleGeometry();
+
 	std::vector<SteerLib::ModuleInterface*>::iterator iter;
 
 	for ( iter = _modulesInExecutionOrder.begin(); iter != _modulesInExecutionOrder.end();  ++iter ) {
@@ -426,6 +476,10 @@ void SimulationEngine::preprocessSimulation()
 	}
 	// _agentInitialConditions.clear();
 
+	if (_renderSnapshotsEnabled) {
+		_publishRenderSnapshot();
+	}
+
 	_engineState.transitionToState(ENGINE_STATE_SIMULATION_READY_FOR_UPDATE);
 }
 
@@ -460,10 +514,17 @@ bool SimulationEngine::update( bool advanceRealTimeOnly )
 	if (!advanceRealTimeOnly) {
 		// update real-time aspects of the simulation
 		_clock.advanceSimulationAndUpdateRealTime();
-		_camera.update(_clock.getCurrentRealTime(), _clock.getRealDt());
+		if (!_renderSnapshotsEnabled) {
+			_camera.update(_clock.getCurrentRealTime(), _clock.getRealDt());
+		}
 
 		// Run the actual simulation step, taking the appropriate action based on its return value.
-		if (_simulateOneStep() == true) {
+		bool simulationContinues = _simulateOneStep();
+		if (_renderSnapshotsEnabled) {
+			_publishRenderSnapshot();
+		}
+
+		if (simulationContinues) {
 			return true;
 		} else {
 			_engineState.transitionToState(ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED);
@@ -473,7 +534,9 @@ bool SimulationEngine::update( bool advanceRealTimeOnly )
 	else {
 		// when paused, update only the real-time aspects of the simulation.
 		_clock.updateRealTime();
-		_camera.update(_clock.getCurrentRealTime(), _clock.getRealDt());
+		if (!_renderSnapshotsEnabled) {
+			_camera.update(_clock.getCurrentRealTime(), _clock.getRealDt());
+		}
 		return true;
 	}
 
@@ -491,6 +554,8 @@ bool SimulationEngine::_simulateOneStep()
 	float simulatonDt = _clock.getSimulationDt();
 	unsigned int currentFrameNumber = _clock.getCurrentFrameNumber();
 
+	// re-compile obstacles that changed during the last frame here, so that agents never trigger it while they update.
+	getStaticObstacleGeometry();
 
 	// call preprocess for all modules
 	std::vector<SteerLib::ModuleInterface*>::iterator moduleIterator;
@@ -554,6 +619,227 @@ bool SimulationEngine::_simulateOneStep()
 }
 
 
+//========================================
+
+void SimulationEngine::_publishRenderSnapshot()
+{
+	RenderSnapshot & snapshot = _renderSnapshots.beginWrite();
+	snapshot.frameNumber = _clock.getCurrentFrameNumber();
+	snapshot.simulationTime = _clock.getCurrentSimulationTime();
+
+	// clear() keeps the capacity of the vectors, so once they have grown to the size of the crowd this does not allocate.
+	snapshot.agents.clear();
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		AgentInterface * agent = _agents[i];
+		if (!agent->enabled()) {
+			continue;
+		}
+		AgentRenderState state;
+		state.agent = agent;
+		state.position = agent->position();
+		state.forward = agent->forward();
+		state.radius = agent->radius();
+		state.selected = isAgentSelected(agent);
+		state.hasStaticGoal = false;
+		if (!agent->agentGoals().empty()) {
+			const AgentGoalInfo & goal = agent->currentGoal();
+			state.hasStaticGoal = (goal.goalType == GOAL_TYPE_SEEK_STATIC_TARGET);
+			state.goalLocation = goal.targetLocation;
+		}
+		snapshot.agents.push_back(state);
+	}
+
+	snapshot.obstacles.assign(_obstacles.begin(), _obstacles.end());
+
+	// the spatial database changes while the render thread draws, so the cells it would shade are copied as well.
+	snapshot.drawGrid = _spatialDatabase->getCellsToDraw(snapshot.gridCells);
+	if (snapshot.drawGrid) {
+		float xmin = _spatialDatabase->getOriginX();
+		float zmin = _spatialDatabase->getOriginZ();
+		snapshot.gridBounds = AxisAlignedBox(xmin, xmin + _spatialDatabase->getGridSizeX(), 0.0f, 0.0f, zmin, zmin + _spatialDatabase->getGridSizeZ());
+	}
+
+	_renderSnapshots.publish();
+}
+
+
+//========================================
+
+Util::AxisAlignedBox SimulationEngine::_getAgentDatabaseBounds(SteerLib::AgentInterface * agent)
+{
+	Util::Point p = agent->position();
+	float r = agent->radius();
+	return Util::AxisAlignedBox(p.x - r, p.x + r, 0.0f, 0.0f, p.z - r, p.z + r);
+}
+
+//========================================
+
+void SimulationEngine::_getSnapshotItems(std::vector<SteerLib::SpatialDatabaseItemPtr> & items)
+{
+	// agents first, in engine order, followed by obstacles.
+	items.clear();
+	items.reserve(_agents.size() + _obstacles.size());
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		items.push_back(_agents[i]);
+	}
+	std::set<SteerLib::ObstacleInterface*>::iterator obstacleIter;
+	for (obstacleIter = _obstacles.begin(); obstacleIter != _obstacles.end(); ++obstacleIter) {
+		items.push_back(*obstacleIter);
+	}
+}
+
+//========================================
+
+void SimulationEngine::saveSnapshot(SteerLib::SimulationSnapshot & snapshot)
+{
+	unsigned int currentState = _engineState.getCurrentState();
+	if ((currentState != ENGINE_STATE_SIMULATION_READY_FOR_UPDATE) && (currentState != ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED)) {
+		throw GenericException("Cannot save a snapshot, the simulation is not running.");
+	}
+
+	snapshot.clear();
+	_clock.getSimulationState(snapshot.frameNumber, snapshot.totalSimulationTime, snapshot.simulationDt);
+	snapshot.numFramesSimulated = _numFramesSimulated;
+
+	std::vector<SpatialDatabaseItemPtr> items;
+	_getSnapshotItems(items);
+	std::map<const SpatialDatabaseItem*, int> itemIndices;
+	for (unsigned int i = 0; i < items.size(); i++) {
+		itemIndices[items[i]] = (int)i;
+	}
+
+	snapshot.agents.resize(_agents.size());
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		SteerLib::AgentInterface * agent = _agents[i];
+		SimulationSnapshot::AgentRecord & record = snapshot.agents[i];
+		record.ownerModuleName = _moduleMetaInfoByReference[_agentOwners[agent]]->moduleName;
+		record.emitterNum = (i < _spawned_agent_emitter_num.size()) ? _spawned_agent_emitter_num[i] : -1;
+
+		// enough to re-create the agent when restoring into an engine that has fewer agents (e.g. emitters spawned more later in this run).
+		SteerLib::AgentInitialConditions initialConditions;
+		initialConditions.name = "agent" + toString(i);
+		initialConditions.position = agent->position();
+		initialConditions.direction = agent->forward();
+		initialConditions.radius = agent->radius();
+		initialConditions.speed = agent->velocity().length();
+		std::queue<SteerLib::AgentGoalInfo> goals(agent->agentGoals());
+		while (!goals.empty()) {
+			initialConditions.goals.push_back(goals.front());
+			goals.pop();
+		}
+		initialConditions.colorSet = false;
+		SimulationStateWriter conditionsWriter;
+		conditionsWriter.writeInitialConditions(initialConditions);
+		record.initialConditions = conditionsWriter.getData();
+
+		SimulationStateWriter stateWriter;
+		stateWriter.setItemIndices(&itemIndices);
+		agent->saveState(stateWriter);
+		record.state = stateWriter.getData();
+	}
+
+	std::vector<SteerLib::ModuleInterface*>::iterator iter;
+	for ( iter = _modulesInExecutionOrder.begin(); iter != _modulesInExecutionOrder.end();  ++iter ) {
+		SimulationStateWriter moduleWriter;
+		moduleWriter.setItemIndices(&itemIndices);
+		(*iter)->saveSimulationState(moduleWriter);
+		snapshot.modules.push_back(std::make_pair(_moduleMetaInfoByReference[(*iter)]->moduleName, moduleWriter.getData()));
+	}
+}
+
+//========================================
+
+void SimulationEngine::restoreSnapshot(const SteerLib::SimulationSnapshot & snapshot)
+{
+	unsigned int currentState = _engineState.getCurrentState();
+	if ((currentState != ENGINE_STATE_SIMULATION_READY_FOR_UPDATE) && (currentState != ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED)) {
+		throw GenericException("Cannot restore a snapshot, the simulation is not running.  Call preprocessSimulation() first.");
+	}
+
+	// validate everything that can be checked up front, so that a mismatched snapshot does not leave the engine half-restored.
+	for (unsigned int i = 0; i < snapshot.modules.size(); i++) {
+		if (!isModuleLoaded(snapshot.modules[i].first)) {
+			throw GenericException("Cannot restore snapshot, module \"" + snapshot.modules[i].first + "\" is not loaded.");
+		}
+	}
+	for (unsigned int i = 0; i < snapshot.agents.size(); i++) {
+		const std::string & ownerName = snapshot.agents[i].ownerModuleName;
+		if (!isModuleLoaded(ownerName)) {
+			throw GenericException("Cannot restore snapshot, agent " + toString(i) + " belongs to module \"" + ownerName + "\" which is not loaded.");
+		}
+		if ((i < _agents.size()) && (_moduleMetaInfoByReference[_agentOwners[_agents[i]]]->moduleName != ownerName)) {
+			throw GenericException("Cannot restore snapshot, agent " + toString(i) + " belongs to a different module; the snapshot was taken from a different scenario.");
+		}
+	}
+
+	// agents that did not exist yet when the snapshot was taken were appended at the end by emitters.
+	while (_agents.size() > snapshot.agents.size()) {
+		SteerLib::AgentInterface * extraAgent = _agents.back();
+		if (extraAgent->enabled()) {
+			extraAgent->disable();
+		}
+		_selectedAgents.erase(extraAgent);
+		destroyAgent(extraAgent);
+	}
+	_spawned_agent_emitter_num.resize(_agents.size(), -1);
+
+	// agents that existed in the snapshot but not in this engine.
+	while (_agents.size() < snapshot.agents.size()) {
+		const SimulationSnapshot::AgentRecord & record = snapshot.agents[_agents.size()];
+		SteerLib::ModuleInterface * owner = getModule(record.ownerModuleName);
+		SteerLib::AgentInterface * newAgent = owner->createAgent();
+		if (newAgent == NULL) {
+			throw GenericException("Cannot restore snapshot, module \"" + record.ownerModuleName + "\" could not create an agent.");
+		}
+		SteerLib::AgentInitialConditions initialConditions;
+		SimulationStateReader conditionsReader(record.initialConditions);
+		conditionsReader.readInitialConditions(initialConditions);
+		newAgent->reset(initialConditions, this);
+		_agents.push_back(newAgent);
+		_agentOwners[newAgent] = owner;
+		_spawned_agent_emitter_num.push_back(record.emitterNum);
+	}
+
+	// agents are taken out of the spatial database all at once and re-inserted afterwards,
+	// so that cells never temporarily hold agents from both the old and the restored state.
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		if (_agents[i]->enabled() && (_agents[i]->getSimulationEngine() == this)) {
+			_spatialDatabase->removeObject(dynamic_cast<SpatialDatabaseItemPtr>(_agents[i]), _getAgentDatabaseBounds(_agents[i]));
+		}
+	}
+	std::vector<SpatialDatabaseItemPtr> items;
+	_getSnapshotItems(items);
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		SimulationStateReader reader(snapshot.agents[i].state);
+		reader.setItems(&items);
+		_agents[i]->restoreState(reader);
+		if (!reader.atEnd()) {
+			throw GenericException("Cannot restore snapshot, the state of agent " + toString(i) + " was not completely read; the agent's saveState() and restoreState() do not match.");
+		}
+		_spawned_agent_emitter_num[i] = snapshot.agents[i].emitterNum;
+	}
+	for (unsigned int i = 0; i < _agents.size(); i++) {
+		if (_agents[i]->enabled() && (_agents[i]->getSimulationEngine() == this)) {
+			_spatialDatabase->addObject(dynamic_cast<SpatialDatabaseItemPtr>(_agents[i]), _getAgentDatabaseBounds(_agents[i]));
+		}
+	}
+
+	for (unsigned int i = 0; i < snapshot.modules.size(); i++) {
+		SimulationStateReader reader(snapshot.modules[i].second);
+		reader.setItems(&items);
+		getModule(snapshot.modules[i].first)->restoreSimulationState(reader);
+	}
+
+	_clock.setSimulationState(snapshot.frameNumber, snapshot.totalSimulationTime, snapshot.simulationDt);
+	_numFramesSimulated = snapshot.numFramesSimulated;
+	_stop = false;
+
+	if (currentState == ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED) {
+		_engineState.transitionToState(ENGINE_STATE_SIMULATION_READY_FOR_UPDATE);
+	}
+}
+
+
 //========================================
 
 #ifdef ENABLE_GUI
@@ -638,6 +924,10 @@ void SimulationEngine::initGL()
 	//glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
 
 	glLineWidth(_options->guiOptions.lineWidth);
+
+	if (_drawBatch == NULL) {
+		_drawBatch = new DrawBatch();
+	}
 }
 #endif // ifdef ENABLE_GUI
 
@@ -699,6 +989,13 @@ void SimulationEngine::_drawModules()
 #ifdef ENABLE_GUI
 void SimulationEngine::_drawObstacles()
 {
+	if (_options->guiOptions.useBatchedDrawing) {
+		ViewFrustum frustum;
+		frustum.extractFromCurrentView();
+		_drawObstacleTiles(frustum);
+		return;
+	}
+
 	std::set<SteerLib::ObstacleInterface *>::iterator obstacleIter;
 	for (obstacleIter = _obstacles.begin(); obstacleIter!=_obstacles.end(); ++obstacleIter) {
 		(*obstacleIter)->draw();
@@ -711,6 +1008,29 @@ void SimulationEngine::_drawObstacles()
 #ifdef ENABLE_GUI
 void SimulationEngine::_drawAgents()
 {
+	if (_options->guiOptions.useBatchedDrawing) {
+		// selected agents still draw themselves, with their annotations; all others become plain discs in one batch.
+		_drawBatch->clear();
+		for (unsigned int i = 0; i < _agents.size(); i++) {
+			AgentInterface * agent = _agents[i];
+			if (!agent->enabled()) {
+				continue;
+			}
+			if (isAgentSelected(agent)) {
+				agent->draw();
+				continue;
+			}
+			_drawBatch->addAgentDisc(agent->position(), agent->forward(), agent->radius(), gGray40);
+			if (!agent->agentGoals().empty() && (agent->currentGoal().goalType == GOAL_TYPE_SEEK_STATIC_TARGET)) {
+				_drawBatch->addFlag(agent->currentGoal().targetLocation, Color(0.9f, 0.0f, 0.0f));
+			}
+		}
+		ViewFrustum frustum;
+		frustum.extractFromCurrentView();
+		_drawBatch->draw(frustum);
+		return;
+	}
+
 	std::vector<SteerLib::AgentInterface*>::iterator agentIterator;
 	for ( agentIterator = _agents.begin(); agentIterator != _agents.end(); ++agentIterator ) {
 		if ((*agentIterator)->enabled()){
@@ -734,6 +1054,133 @@ void SimulationEngine::draw()
 #endif  // ifdef ENABLE_GUI
 
 
+//========================================
+#ifdef ENABLE_GUI
+void SimulationEngine::drawRenderSnapshot(const SteerLib::RenderSnapshot & snapshot)
+{
+	// the spatial database and the path planner are never touched here, because the simulation thread changes them while
+	// this runs; the grid is drawn from the cells copied into the snapshot, and the path planner is only drawn by draw().
+	if (snapshot.drawGrid) {
+		const AxisAlignedBox & bounds = snapshot.gridBounds;
+		DrawLib::glColor(gGray90);
+		Point a(bounds.xmin, -0.01f, bounds.zmin);
+		Point b(bounds.xmin, -0.01f, bounds.zmax);
+		Point c(bounds.xmax, -0.01f, bounds.zmax);
+		Point d(bounds.xmax, -0.01f, bounds.zmin);
+		DrawLib::drawLine(a, b);
+		DrawLib::drawLine(b, c);
+		DrawLib::drawLine(c, d);
+		DrawLib::drawLine(d, a);
+
+		float gridQuadHeight = -0.1f;
+		for (unsigned int i = 0; i < snapshot.gridCells.size(); i++) {
+			const AxisAlignedBox & cell = snapshot.gridCells[i].bounds;
+			DrawLib::glColor(snapshot.gridCells[i].color);
+			DrawLib::drawQuad(Point(cell.xmin, gridQuadHeight, cell.zmin), Point(cell.xmin, gridQuadHeight, cell.zmax),
+				Point(cell.xmax, gridQuadHeight, cell.zmax), Point(cell.xmax, gridQuadHeight, cell.zmin));
+		}
+	}
+
+	ViewFrustum frustum;
+	frustum.extractFromCurrentView();
+
+	// the obstacles of a running simulation are the engine's obstacles, so the batched mode can use the compiled tiles.
+	if (_options->guiOptions.useBatchedDrawing) {
+		_drawObstacleTiles(frustum);
+	}
+	else {
+		for (unsigned int i = 0; i < snapshot.obstacles.size(); i++) {
+			snapshot.obstacles[i]->draw();
+		}
+	}
+
+	// agents are drawn as plain discs anyway, so they are always batched.
+	_drawBatch->clear();
+	for (unsigned int i = 0; i < snapshot.agents.size(); i++) {
+		const AgentRenderState & agent = snapshot.agents[i];
+		_drawBatch->addAgentDisc(agent.position, agent.forward, agent.radius, agent.selected ? gBlue : gGray40);
+		if (agent.hasStaticGoal) {
+			_drawBatch->addFlag(agent.goalLocation, Color(0.9f, 0.0f, 0.0f));
+		}
+	}
+	_drawBatch->draw(frustum);
+}
+#endif  // ifdef ENABLE_GUI
+
+
+//========================================
+#ifdef ENABLE_GUI
+void SimulationEngine::_buildObstacleDrawTiles()
+{
+	for (unsigned int i = 0; i < _obstacleDrawTiles.size(); i++) {
+		glDeleteLists(_obstacleDrawTiles[i].displayList, 1);
+	}
+	_obstacleDrawTiles.clear();
+	_obstacleDrawTilesAreCurrent = true;
+
+	if (_obstacles.empty()) {
+		return;
+	}
+
+	// obstacles are grouped by the tile that contains the center of their bounds; a tile's bounds grow to contain all of its obstacles.
+	AxisAlignedBox sceneBounds = (*_obstacles.begin())->getBounds();
+	std::set<SteerLib::ObstacleInterface *>::iterator obstacleIter;
+	for (obstacleIter = _obstacles.begin(); obstacleIter != _obstacles.end(); ++obstacleIter) {
+		const AxisAlignedBox & bounds = (*obstacleIter)->getBounds();
+		sceneBounds.xmin = std::min(sceneBounds.xmin, bounds.xmin);  sceneBounds.xmax = std::max(sceneBounds.xmax, bounds.xmax);
+		sceneBounds.zmin = std::min(sceneBounds.zmin, bounds.zmin);  sceneBounds.zmax = std::max(sceneBounds.zmax, bounds.zmax);
+	}
+	float tileSizeX = std::max((sceneBounds.xmax - sceneBounds.xmin) / NUM_OBSTACLE_DRAW_TILES_PER_SIDE, 1.0f);
+	float tileSizeZ = std::max((sceneBounds.zmax - sceneBounds.zmin) / NUM_OBSTACLE_DRAW_TILES_PER_SIDE, 1.0f);
+
+	std::vector<std::vector<SteerLib::ObstacleInterface*> > obstaclesInTile(NUM_OBSTACLE_DRAW_TILES_PER_SIDE * NUM_OBSTACLE_DRAW_TILES_PER_SIDE);
+	for (obstacleIter = _obstacles.begin(); obstacleIter != _obstacles.end(); ++obstacleIter) {
+		const AxisAlignedBox & bounds = (*obstacleIter)->getBounds();
+		int x = (int)((0.5f * (bounds.xmin + bounds.xmax) - sceneBounds.xmin) / tileSizeX);
+		int z = (int)((0.5f * (bounds.zmin + bounds.zmax) - sceneBounds.zmin) / tileSizeZ);
+		x = std::min(std::max(x, 0), NUM_OBSTACLE_DRAW_TILES_PER_SIDE - 1);
+		z = std::min(std::max(z, 0), NUM_OBSTACLE_DRAW_TILES_PER_SIDE - 1);
+		obstaclesInTile[z * NUM_OBSTACLE_DRAW_TILES_PER_SIDE + x].push_back(*obstacleIter);
+	}
+
+	for (unsigned int i = 0; i < obstaclesInTile.size(); i++) {
+		if (obstaclesInTile[i].empty()) {
+			continue;
+		}
+		ObstacleDrawTile tile;
+		tile.bounds = obstaclesInTile[i][0]->getBounds();
+		tile.displayList = glGenLists(1);
+		glNewList(tile.displayList, GL_COMPILE);
+		for (unsigned int j = 0; j < obstaclesInTile[i].size(); j++) {
+			const AxisAlignedBox & bounds = obstaclesInTile[i][j]->getBounds();
+			tile.bounds.xmin = std::min(tile.bounds.xmin, bounds.xmin);  tile.bounds.xmax = std::max(tile.bounds.xmax, bounds.xmax);
+			tile.bounds.ymin = std::min(tile.bounds.ymin, bounds.ymin);  tile.bounds.ymax = std::max(tile.bounds.ymax, bounds.ymax);
+			tile.bounds.zmin = std::min(tile.bounds.zmin, bounds.zmin);  tile.bounds.zmax = std::max(tile.bounds.zmax, bounds.zmax);
+			obstaclesInTile[i][j]->draw();
+		}
+		glEndList();
+		_obstacleDrawTiles.push_back(tile);
+	}
+}
+#endif  // ifdef ENABLE_GUI
+
+
+//========================================
+#ifdef ENABLE_GUI
+void SimulationEngine::_drawObstacleTiles(const Util::ViewFrustum & frustum)
+{
+	if (!_obstacleDrawTilesAreCurrent) {
+		_buildObstacleDrawTiles();
+	}
+	for (unsigned int i = 0; i < _obstacleDrawTiles.size(); i++) {
+		if (frustum.intersectsBox(_obstacleDrawTiles[i].bounds)) {
+			glCallList(_obstacleDrawTiles[i].displayList);
+		}
+	}
+}
+#endif  // ifdef ENABLE_GUI
+
+
 //========================================
 
 SteerLib::ModuleInterface * SimulationEngine::getModule(const std::string & moduleName)
@@ -1128,6 +1575,8 @@ void SimulationEngine::getListOfKnownBuiltInModules(std::vector<std::string> & m
 	moduleNames.push_back("metricsCollector");
 	moduleNames.push_back("steerBench");
 	moduleNames.push_back("steerBug");
+	moduleNames.push_back("pathPlanningBenchmark");
+	moduleNames.push_back("topDownRenderer");
 	// moduleNames.push_back("spatialDatabase");
 }
 
@@ -1200,6 +1649,12 @@ SteerLib::ModuleInterface * SimulationEngine::_createBuiltInModule(const std::st
 	else if (moduleName == "steerBug" ) {
 		return new SteerBugModule();
 	}
+	else if (moduleName == "pathPlanningBenchmark" ) {
+		return new PathPlanningBenchmarkModule();
+	}
+	else if (moduleName == "topDownRenderer" ) {
+		return new TopDownRendererModule();
+	}
 	// else if (moduleName == "spatialDatabase" ) {
 	// 	return new SpatialDatabaseModule();
 	// }
@@ -1396,6 +1851,8 @@ void SimulationEngine::destroyAllObstaclesFromModule(SteerLib::ModuleInterface *
 void SimulationEngine::addObstacle(SteerLib::ObstacleInterface * newObstacle)
 {
 	_obstacles.insert(newObstacle);
+	_staticObstacleGeometryIsCurrent = false;
+	_obstacleDrawTilesAreCurrent = false;
 }
 
 
@@ -1404,6 +1861,8 @@ void SimulationEngine::addObstacle(SteerLib::ObstacleInterface * newObstacle)
 void SimulationEngine::removeObstacle(SteerLib::ObstacleInterface * obstacleToRemove)
 {
 	_obstacles.erase(obstacleToRemove);
+	_staticObstacleGeometryIsCurrent = false;
+	_obstacleDrawTilesAreCurrent = false;
 }
 
 /**
@@ -1412,6 +1871,20 @@ void SimulationEngine::removeObstacle(SteerLib::ObstacleInterface * obstacleToRe
 void SimulationEngine::removeAllObstacles()
 {
 	_obstacles.clear();
+	_staticObstacleGeometryIsCurrent = false;
+	_obstacleDrawTilesAreCurrent = false;
+}
+
+
+//========================================
+
+const SteerLib::StaticObstacleGeometry & SimulationEngine::getStaticObstacleGeometry()
+{
+	if (!_staticObstacleGeometryIsCurrent) {
+		_staticObstacleGeometry.compile(_obstacles);
+		_staticObstacleGeometryIsCurrent = true;
+	}
+	return _staticObstacleGeometry;
 }
 
 
@@ -1504,6 +1977,9 @@ void SimulationEngine::_setupStateMachine()
 	_engineState.addTransition( SimulationEngine::ENGINE_STATE_UPDATING_SIMULATION, SimulationEngine::ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED );
 	_engineState.addTransition( SimulationEngine::ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED, SimulationEngine::ENGINE_STATE_POSTPROCESSING_SIMULATION );
 
+	// Restoring a snapshot into a simulation that has already stopped allows it to be updated again.
+	_engineState.addTransition( SimulationEngine::ENGINE_STATE_SIMULATION_NO_MORE_UPDATES_ALLOWED, SimulationEngine::ENGINE_STATE_SIMULATION_READY_FOR_UPDATE );
+
 	// After the user initiates a postprocess, the simulation becomes finished, and then the user
 	// must unload the simulation, after which the engine is ready to load another simulation or to finish.
 	_engineState.addTransition( SimulationEngine::ENGINE_STATE_POSTPROCESSING_SIMULATION, SimulationEngine::ENGINE_STATE_SIMULATION_FINISHED );
@@ -8,21 +8,49 @@
 /// @brief implements the SteerLib::SimulationMetricsCollector class
 
 #include "benchmarking/SimulationMetricsCollector.h"
+#include "util/GenericException.h"
+
+// the agents are split into this many ranges per thread, so that a few crowded ranges do not leave other threads idle.
+#define UPDATE_TASKS_PER_THREAD 4
 
 using namespace std;
 using namespace SteerLib;
 using namespace Util;
 
 
-SimulationMetricsCollector::SimulationMetricsCollector( const std::vector<SteerLib::AgentInterface*> & agents )
+SimulationMetricsCollector::SimulationMetricsCollector( const std::vector<SteerLib::AgentInterface*> & agents, unsigned int numThreads, const MetricsWindowSizes & windowSizes )
 {
+	if (numThreads == 0) {
+		throw GenericException("SimulationMetricsCollector needs at least one thread.");
+	}
+
 	// allocate and organize the agent metrics collectors
 	_agentCollectors.clear();
 	for (unsigned int i=0; i<agents.size(); i++) {
-		AgentMetricsCollector * collector = new AgentMetricsCollector( agents[i] );
+		AgentMetricsCollector * collector = new AgentMetricsCollector( agents[i], windowSizes );
 		_agentCollectors.push_back(collector);
 	}
-	
+
+	// split the agents into ranges for parallel updates
+	_taskManager = NULL;
+	if ((numThreads > 1) && (agents.size() > 1)) {
+		unsigned int numAgents = (unsigned int)agents.size();
+		unsigned int numTasks = min(numThreads * UPDATE_TASKS_PER_THREAD, numAgents);
+		for (unsigned int i=0; i < numTasks; i++) {
+			UpdateTask task;
+			task.collector = this;
+			task.firstAgent = (unsigned int)(((unsigned long long)numAgents * i) / numTasks);
+			task.endAgent = (unsigned int)(((unsigned long long)numAgents * (i+1)) / numTasks);
+			_updateTasks.push_back(task);
+		}
+		_taskManager = new ThreadedTaskManager(numThreads);
+	}
+
+	_currentGridDB = NULL;
+	_currentAgents = NULL;
+	_currentTimeStamp = 0.0f;
+	_currentTimePassed = 0.0f;
+
 	_resetEnvironmentMetrics();
 }
 
@@ -31,6 +59,7 @@ SimulationMetricsCollector::SimulationMetricsCollector( const std::vector<SteerL
 SimulationMetricsCollector::~SimulationMetricsCollector()
 {
 	// std::cout << "The simulation metrics are being updated" << std::endl;
+	delete _taskManager;
 	for (unsigned int i=0; i<_agentCollectors.size(); i++) {
 		if (_agentCollectors[i] != NULL) delete _agentCollectors[i];
 	}
@@ -56,14 +85,49 @@ void SimulationMetricsCollector::_resetEnvironmentMetrics()
 
 void SimulationMetricsCollector::_updateAgentMetrics(SteerLib::SpatialDataBaseInterface * gridDB, const std::vector<SteerLib::AgentInterface*> & updatedAgents, float currentTimeStamp, float timePassedSinceLastFrame)
 {
-	for (unsigned int i=0; i < getNumAgents(); i++) {
+	_currentGridDB = gridDB;
+	_currentAgents = &updatedAgents;
+	_currentTimeStamp = currentTimeStamp;
+	_currentTimePassed = timePassedSinceLastFrame;
+
+	if (_taskManager == NULL) {
+		_updateAgentMetricsRange(0, (unsigned int)getNumAgents());
+		return;
+	}
+
+	// the worker threads cannot propagate exceptions, so check here what AgentMetricsCollector::update() would throw.
+	if (timePassedSinceLastFrame == 0.0f) {
+		throw GenericException("timePassedSinceLastFrame should not be 0.");
+	}
+
+	for (unsigned int i=0; i < _updateTasks.size(); i++) {
+		Util::Task task;
+		task.function = &SimulationMetricsCollector::_runUpdateTask;
+		task.data = &_updateTasks[i];
+		_taskManager->addTask(task, (i+1 == _updateTasks.size()));
+	}
+	_taskManager->waitForAllTasksToComplete();
+}
+
+
+void SimulationMetricsCollector::_updateAgentMetricsRange(unsigned int firstAgent, unsigned int endAgent)
+{
+	const std::vector<SteerLib::AgentInterface*> & updatedAgents = *_currentAgents;
+	for (unsigned int i=firstAgent; i < endAgent; i++) {
 		/// @todo do we need this enabled() check here?  It may even be undesirable to keep it here.
 		// std::cout << "Updating agent " << i << " metrics" << std::endl;
-		if (updatedAgents[i]->enabled()) _agentCollectors[i]->update(gridDB, updatedAgents[i], currentTimeStamp, timePassedSinceLastFrame);
+		if (updatedAgents[i]->enabled()) _agentCollectors[i]->update(_currentGridDB, updatedAgents[i], _currentTimeStamp, _currentTimePassed);
 	}
 }
 
 
+void SimulationMetricsCollector::_runUpdateTask(unsigned int threadIndex, void * data)
+{
+	UpdateTask * task = (UpdateTask*)data;
+	task->collector->_updateAgentMetricsRange(task->firstAgent, task->endAgent);
+}
+
+
 void SimulationMetricsCollector::_updateEnvironmentMetrics(SpatialDataBaseInterface * gridDB, float currentTimeStamp, float timePassedSinceLastFrame)
 {
 	// no environment metrics implemented yet
@@ -85,3 +149,11 @@ void SimulationMetricsCollector::printCurrentMetrics(unsigned int agentIndex, st
 	_agentCollectors[agentIndex]->printFormattedOverallStatistics(out);
 	_agentCollectors[agentIndex]->printFormattedCurrentStatistics(out);
 }
+
+
+void SimulationMetricsCollector::addCollisionThreshold(float penetrationThreshold, float timeDurationThreshold)
+{
+	for (unsigned int i=0; i<_agentCollectors.size(); i++) {
+		_agentCollectors[i]->addCollisionThreshold(penetrationThreshold, timeDurationThreshold);
+	}
+}
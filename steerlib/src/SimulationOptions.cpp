@@ -88,6 +88,11 @@ using namespace Util;
 #define DEFAULT_MOUSE_MOVE_FACTOR .001f
 #define DEFAULT_BACKGROUND_COLOR  Color(0.5f, 0.5f, 0.28f) // seems useless right now
 #define DEFAULT_LINE_WIDTH 3.0f
+#define DEFAULT_USE_SIMULATION_THREAD false
+#define DEFAULT_USE_BATCHED_DRAWING false
+#define DEFAULT_FRAME_DUMP_FORMAT "png"
+#define DEFAULT_NUM_FRAME_DUMP_THREADS 2
+#define DEFAULT_MAX_QUEUED_FRAME_DUMPS 8
 #define DEFAULT_CAMERA_POSITION   Point(0.0f, 37.0f, 40)
 #define DEFAULT_CAMERA_LOOKAT     Point(0.0f, 0.0f,  -5)
 #define DEFAULT_CAMERA_UP         Vector(0.0f, 1.0f, 0.0f)
@@ -149,6 +154,8 @@ using namespace Util;
 #define DEFAULT_MIN_VARIABLE_DT 0.001f
 #define DEFAULT_MAX_VARIABLE_DT 0.2f
 #define DEFAULT_CLOCK_MODE "fixed-fast"
+#define DEFAULT_FRAME_PACING "hybrid"
+#define DEFAULT_FRAME_PACING_SPIN_TIME 0.002f
 
 //====================================
 // SPATIAL DATABASE DEFAULTS
@@ -184,6 +191,19 @@ using namespace Util;
 #define DEFAULT_FULLSCREEN false
 #define DEFAULT_STEREO_MODE "off"
 
+//====================================
+// ENSEMBLE ENGINE DRIVER DEFAULTS
+//====================================
+#define DEFAULT_ENSEMBLE_RUN_LIST_FILENAME ""
+#define DEFAULT_ENSEMBLE_NUM_RUNS 1
+#define DEFAULT_ENSEMBLE_FIRST_SEED 1
+#define DEFAULT_ENSEMBLE_NUM_THREADS 1
+#define DEFAULT_ENSEMBLE_OUTPUT_FILENAME ""
+#define DEFAULT_SERVER_SOCKET_PATH "/tmp/steersim.sock"
+#define DEFAULT_SERVER_SHARED_MEMORY_NAME "/steersim_state"
+#define DEFAULT_SERVER_NUM_STATE_SLOTS 16
+#define DEFAULT_SERVER_MAX_AGENTS 4096
+
 //====================================
 // BUILT-IN MODULES DEFAULTS
 //====================================
@@ -246,6 +266,8 @@ SimulationOptions::SimulationOptions()
 	engineOptions.minVariableDt = DEFAULT_MIN_VARIABLE_DT;
 	engineOptions.maxVariableDt = DEFAULT_MAX_VARIABLE_DT;
 	engineOptions.clockMode = DEFAULT_CLOCK_MODE;
+	engineOptions.framePacing = DEFAULT_FRAME_PACING;
+	engineOptions.framePacingSpinTime = DEFAULT_FRAME_PACING_SPIN_TIME;
 
 	spatialDatabaseOptions.name = DEFAULT_USE_DATABASE;
 
@@ -275,6 +297,11 @@ SimulationOptions::SimulationOptions()
 	guiOptions.cameraFovy = DEFAULT_CAMERA_FOVY;
 	guiOptions.backgroundColor = DEFAULT_BACKGROUND_COLOR;
 	guiOptions.lineWidth = DEFAULT_LINE_WIDTH;
+	guiOptions.useSimulationThread = DEFAULT_USE_SIMULATION_THREAD;
+	guiOptions.useBatchedDrawing = DEFAULT_USE_BATCHED_DRAWING;
+	guiOptions.frameDumpFormat = DEFAULT_FRAME_DUMP_FORMAT;
+	guiOptions.numFrameDumpThreads = DEFAULT_NUM_FRAME_DUMP_THREADS;
+	guiOptions.maxQueuedFrameDumps = DEFAULT_MAX_QUEUED_FRAME_DUMPS;
 
 	// glfw engine driver options
 	glfwEngineDriverOptions.pausedOnStart = DEFAULT_CLOCK_PAUSED_ON_START;
@@ -286,6 +313,19 @@ SimulationOptions::SimulationOptions()
 	glfwEngineDriverOptions.fullscreen = DEFAULT_FULLSCREEN;
 	glfwEngineDriverOptions.stereoMode = DEFAULT_STEREO_MODE;
 
+	// ensemble engine driver options
+	ensembleEngineDriverOptions.runListFilename = DEFAULT_ENSEMBLE_RUN_LIST_FILENAME;
+	ensembleEngineDriverOptions.numRuns = DEFAULT_ENSEMBLE_NUM_RUNS;
+	ensembleEngineDriverOptions.firstSeed = DEFAULT_ENSEMBLE_FIRST_SEED;
+	ensembleEngineDriverOptions.numThreads = DEFAULT_ENSEMBLE_NUM_THREADS;
+	ensembleEngineDriverOptions.outputFilename = DEFAULT_ENSEMBLE_OUTPUT_FILENAME;
+
+	// server engine driver options
+	serverEngineDriverOptions.socketPath = DEFAULT_SERVER_SOCKET_PATH;
+	serverEngineDriverOptions.sharedMemoryName = DEFAULT_SERVER_SHARED_MEMORY_NAME;
+	serverEngineDriverOptions.numStateSlots = DEFAULT_SERVER_NUM_STATE_SLOTS;
+	serverEngineDriverOptions.maxAgents = DEFAULT_SERVER_MAX_AGENTS;
+
 	//
 	// module options
 	// for each module, initialize its module options, and insert that into the module options database.
@@ -380,6 +420,12 @@ void SimulationOptions::loadOptionsFromConfigFile( const std::string & filename
 		engineOptions.clockMode = "fixed-fast";
 	}
 
+	engineOptions.framePacing = Util::toLower(engineOptions.framePacing);
+	if ((engineOptions.framePacing != "hybrid") && (engineOptions.framePacing != "sleep") && (engineOptions.framePacing != "busy-wait")) {
+		std::cerr << "WARNING: Bad option value for framePacing in configuration file.\n         Valid options are: \"hybrid\", \"sleep\" or \"busy-wait\".\n         For now, setting default to \"hybrid\".";
+		engineOptions.framePacing = "hybrid";
+	}
+
 	glfwEngineDriverOptions.stereoMode = Util::toLower(glfwEngineDriverOptions.stereoMode);
 	if ((glfwEngineDriverOptions.stereoMode != "off") &&
 		(glfwEngineDriverOptions.stereoMode != "side-by-side") &&
@@ -431,6 +477,8 @@ void SimulationOptions::_setupXMLStructure( Util::XMLParser & xmlOpts )
 	engineDriversTag->createChildTag("commandLine", "Options for the command-line engine driver (currently there are no options for the command-line)");
 	XMLTag * glfwEngineDriverTag = engineDriversTag->createChildTag("glfw", "Options for the GLFW engine driver");
 	engineDriversTag->createChildTag("qt", "Options for the Qt engine driver (config for qt not implemented yet!)");
+	XMLTag * ensembleEngineDriverTag = engineDriversTag->createChildTag("ensemble", "Options for the ensemble engine driver, which runs many simulations in one process");
+	XMLTag * serverEngineDriverTag = engineDriversTag->createChildTag("server", "Options for the server engine driver, which keeps a simulation loaded and steps it on request of an external controller");
 
 	// GUI options
 	guiTag->createChildTag("useAntialiasing", "Set to \"true\" to remove jaggies, for smoother-looking visuals, but lower performance", XML_DATA_TYPE_BOOLEAN, &guiOptions.useAntialiasing);
@@ -447,6 +495,11 @@ void SimulationOptions::_setupXMLStructure( Util::XMLParser & xmlOpts )
 	guiTag->createChildTag("cameraVerticalFieldOfView", "The vertical field of view of the camera, in degrees", XML_DATA_TYPE_FLOAT, &guiOptions.cameraFovy);
 	guiTag->createChildTag("backgroundColor", "The background color of the openGL visualization", XML_DATA_TYPE_RGB, &guiOptions.backgroundColor);
 	guiTag->createChildTag("lineWidth", "width of lines drawn in the GUI", XML_DATA_TYPE_FLOAT, &guiOptions.lineWidth);
+	guiTag->createChildTag("useSimulationThread", "Set to \"true\" to simulate on a separate thread, so that drawing never slows down the simulation; module annotations are not drawn in this mode", XML_DATA_TYPE_BOOLEAN, &guiOptions.useSimulationThread);
+	guiTag->createChildTag("useBatchedDrawing", "Set to \"true\" to draw agents and obstacles with a few openGL calls, skipping what is out of view; recommended for very large crowds, but only selected agents draw their own annotations", XML_DATA_TYPE_BOOLEAN, &guiOptions.useBatchedDrawing);
+	guiTag->createChildTag("frameDumpFormat", "The format of dumped frames: \"png\", \"ppm\", or \"raw\" (a single file of RGB frames that a video encoder can read)", XML_DATA_TYPE_STRING, &guiOptions.frameDumpFormat);
+	guiTag->createChildTag("numFrameDumpThreads", "The number of threads that encode and write dumped frames, so that recording does not slow down drawing", XML_DATA_TYPE_UNSIGNED_INT, &guiOptions.numFrameDumpThreads);
+	guiTag->createChildTag("maxQueuedFrameDumps", "The maximum number of dumped frames waiting to be written; drawing waits when the queue is full", XML_DATA_TYPE_UNSIGNED_INT, &guiOptions.maxQueuedFrameDumps);
 
 	// global options
 	globalTag->createChildTag("engineDriver", "The name of the engine driver to use, if not specified from command line", XML_DATA_TYPE_STRING, &globalOptions.engineDriver);
@@ -464,9 +517,11 @@ void SimulationOptions::_setupXMLStructure( Util::XMLParser & xmlOpts )
 	engineTag->createChildTag("minVariableDt", "The minimum time-step allowed when the clock is in \"variable-real-time\" mode.  If the proposed time-step is smaller, this value will be used instead, effectively limiting the max frame rate.", XML_DATA_TYPE_FLOAT, &engineOptions.minVariableDt);
 	engineTag->createChildTag("maxVariableDt", "The maximum time-step allowed when the clock is in \"variable-real-time\" mode.  If the proposed time-step is larger, this value will be used instead, at the expense of breaking synchronization between simulation time and real-time.", XML_DATA_TYPE_FLOAT, &engineOptions.maxVariableDt);
 	engineTag->createChildTag("clockMode", "can be either \"fixed-fast\" (fixed simulation frame rate, running as fast as possible), \"fixed-real-time\" (fixed simulation frame rate, running in real-time), or \"variable-real-time\" (variable simulation frame rate in real-time).", XML_DATA_TYPE_STRING, &engineOptions.clockMode);
+	engineTag->createChildTag("framePacing", "How the real-time clock modes wait for the next frame: \"hybrid\" (sleep, then spin for the last framePacingSpinTime seconds), \"sleep\" (lowest CPU use, least accurate), or \"busy-wait\" (spin the whole time, uses a full core).", XML_DATA_TYPE_STRING, &engineOptions.framePacing);
+	engineTag->createChildTag("framePacingSpinTime", "The time in seconds that \"hybrid\" frame pacing spins before each frame's deadline; it should be longer than the operating system usually oversleeps.", XML_DATA_TYPE_FLOAT, &engineOptions.framePacingSpinTime);
 
 	// spatial database stuff
-	spatialDatabaseTag->createChildTag("useDatabase", "Option to select the database type to use , ", XML_DATA_TYPE_STRING, &spatialDatabaseOptions.name);
+	spatialDatabaseTag->createChildTag("useDatabase", "Option to select the database type to use: \"gridDatabase\" (fixed-size grid), \"hashedGridDatabase\" (unbounded grid that only allocates occupied cells; uses the gridDatabase size and cells only for the cell size), \"kdTreeDatabase\" or \"meshDatabase\" (loaded from modules).", XML_DATA_TYPE_STRING, &spatialDatabaseOptions.name);
 	XMLTag * gridDatabaseTag = spatialDatabaseTag->createChildTag("gridDatabase", "Options related to the grid database");
 	spatialDatabaseTag->createChildTag("navmeshDatabase", "Options related to the navmesh database");
 
@@ -492,6 +547,19 @@ void SimulationOptions::_setupXMLStructure( Util::XMLParser & xmlOpts )
 	glfwEngineDriverTag->createChildTag("windowTitle", "Title of the openGL window", XML_DATA_TYPE_STRING, &glfwEngineDriverOptions.windowTitle);
 	glfwEngineDriverTag->createChildTag("fullscreen", "Uses fullscreen (rather than windowed) mode if \"true\".", XML_DATA_TYPE_BOOLEAN, &glfwEngineDriverOptions.fullscreen);
 	glfwEngineDriverTag->createChildTag("stereoMode", "The stereoscopic mode. Can be one of \"off\", \"side-by-side\", \"top-and-bottom\", or \"quadbuffer\".", XML_DATA_TYPE_STRING, &glfwEngineDriverOptions.stereoMode);
+
+	// ensemble engine driver options
+	ensembleEngineDriverTag->createChildTag("runList", "A text file listing one run per line, as a test case name optionally followed by a random seed.  If not specified, the test case given to the testCasePlayer is run numRuns times.", XML_DATA_TYPE_STRING, &ensembleEngineDriverOptions.runListFilename);
+	ensembleEngineDriverTag->createChildTag("numRuns", "The number of runs of the testCasePlayer's test case when no run list is specified.", XML_DATA_TYPE_UNSIGNED_INT, &ensembleEngineDriverOptions.numRuns);
+	ensembleEngineDriverTag->createChildTag("firstSeed", "The random seed of the first run when no run list is specified; each following run uses the next seed.", XML_DATA_TYPE_UNSIGNED_INT, &ensembleEngineDriverOptions.firstSeed);
+	ensembleEngineDriverTag->createChildTag("numThreads", "The number of runs simulated at the same time; each thread has its own simulation engine.", XML_DATA_TYPE_UNSIGNED_INT, &ensembleEngineDriverOptions.numThreads);
+	ensembleEngineDriverTag->createChildTag("outputFile", "The file that receives the log data of all runs.  If not specified, the log data is written to std::cout.", XML_DATA_TYPE_STRING, &ensembleEngineDriverOptions.outputFilename);
+
+	// server engine driver options
+	serverEngineDriverTag->createChildTag("socketPath", "The Unix domain socket on which the server accepts commands.", XML_DATA_TYPE_STRING, &serverEngineDriverOptions.socketPath);
+	serverEngineDriverTag->createChildTag("sharedMemoryName", "The POSIX shared memory object that receives the agent states; the name must start with a slash.", XML_DATA_TYPE_STRING, &serverEngineDriverOptions.sharedMemoryName);
+	serverEngineDriverTag->createChildTag("numStateSlots", "The number of frames kept in the shared memory ring buffer.", XML_DATA_TYPE_UNSIGNED_INT, &serverEngineDriverOptions.numStateSlots);
+	serverEngineDriverTag->createChildTag("maxAgents", "The maximum number of agents per frame in the shared memory ring buffer.", XML_DATA_TYPE_UNSIGNED_INT, &serverEngineDriverOptions.maxAgents);
 }
 
 
@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file SimulationSnapshot.cpp
+/// @brief Implements SteerLib::SimulationSnapshot, SteerLib::SimulationStateWriter and SteerLib::SimulationStateReader.
+
+#include <fstream>
+#include <sstream>
+
+#include "simulation/SimulationSnapshot.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+//====================================================
+// SimulationStateWriter
+//====================================================
+
+void SimulationStateWriter::writeString(const std::string & value)
+{
+	write((unsigned int)value.size());
+	_data.append(value);
+}
+
+void SimulationStateWriter::writeGoal(const AgentGoalInfo & goal)
+{
+	write(goal.goalType);
+	write(goal.targetIsRandom);
+	write(goal.timeDuration);
+	write(goal.desiredSpeed);
+	write(goal.targetLocation);
+	writeString(goal.targetName);
+	write(goal.targetDirection);
+	writeString(goal.flowType);
+	write(goal.targetRegion);
+
+	writeString(goal.targetBehaviour.getSteeringAlg());
+	std::vector<BehaviourParameter> parameters = goal.targetBehaviour.getParameters();
+	write((unsigned int)parameters.size());
+	for (unsigned int i=0; i < parameters.size(); i++) {
+		writeString(parameters[i].key);
+		writeString(parameters[i].value);
+	}
+}
+
+void SimulationStateWriter::writeGoalQueue(const std::queue<AgentGoalInfo> & goals)
+{
+	// std::queue does not allow iteration, so walk over a copy.
+	std::queue<AgentGoalInfo> goalsCopy(goals);
+	write((unsigned int)goalsCopy.size());
+	while (!goalsCopy.empty()) {
+		writeGoal(goalsCopy.front());
+		goalsCopy.pop();
+	}
+}
+
+void SimulationStateWriter::writeInitialConditions(const AgentInitialConditions & initialConditions)
+{
+	writeString(initialConditions.name);
+	write(initialConditions.position);
+	write(initialConditions.direction);
+	write(initialConditions.radius);
+	write(initialConditions.speed);
+	write((unsigned int)initialConditions.goals.size());
+	for (unsigned int i=0; i < initialConditions.goals.size(); i++) {
+		writeGoal(initialConditions.goals[i]);
+	}
+	write(initialConditions.color);
+	write(initialConditions.colorSet);
+}
+
+
+void SimulationStateWriter::writeItemReference(const SpatialDatabaseItem * item)
+{
+	int index = -1;
+	if ((item != NULL) && (_itemIndices != NULL)) {
+		std::map<const SpatialDatabaseItem*, int>::const_iterator iter = _itemIndices->find(item);
+		if (iter != _itemIndices->end()) {
+			index = iter->second;
+		}
+	}
+	write(index);
+}
+
+
+//====================================================
+// SimulationStateReader
+//====================================================
+
+void SimulationStateReader::readString(std::string & value)
+{
+	unsigned int length;
+	read(length);
+	_checkAvailable(length);
+	value.assign(_data, _cursor, length);
+	_cursor += length;
+}
+
+void SimulationStateReader::readGoal(AgentGoalInfo & goal)
+{
+	read(goal.goalType);
+	read(goal.targetIsRandom);
+	read(goal.timeDuration);
+	read(goal.desiredSpeed);
+	read(goal.targetLocation);
+	readString(goal.targetName);
+	read(goal.targetDirection);
+	readString(goal.flowType);
+	read(goal.targetRegion);
+
+	std::string steeringAlg;
+	readString(steeringAlg);
+	unsigned int numParameters;
+	read(numParameters);
+	std::vector<BehaviourParameter> parameters(numParameters);
+	for (unsigned int i=0; i < numParameters; i++) {
+		readString(parameters[i].key);
+		readString(parameters[i].value);
+	}
+	goal.targetBehaviour = Behaviour(steeringAlg, parameters);
+}
+
+void SimulationStateReader::readGoalQueue(std::queue<AgentGoalInfo> & goals)
+{
+	goals = std::queue<AgentGoalInfo>();
+	unsigned int numGoals;
+	read(numGoals);
+	for (unsigned int i=0; i < numGoals; i++) {
+		AgentGoalInfo goal;
+		readGoal(goal);
+		goals.push(goal);
+	}
+}
+
+void SimulationStateReader::readInitialConditions(AgentInitialConditions & initialConditions)
+{
+	readString(initialConditions.name);
+	read(initialConditions.position);
+	read(initialConditions.direction);
+	read(initialConditions.radius);
+	read(initialConditions.speed);
+	unsigned int numGoals;
+	read(numGoals);
+	initialConditions.goals.clear();
+	for (unsigned int i=0; i < numGoals; i++) {
+		AgentGoalInfo goal;
+		readGoal(goal);
+		initialConditions.goals.push_back(goal);
+	}
+	read(initialConditions.color);
+	read(initialConditions.colorSet);
+	initialConditions.fromRandom = false;
+}
+
+
+SpatialDatabaseItemPtr SimulationStateReader::readItemReference()
+{
+	int index;
+	read(index);
+	if ((index < 0) || (_items == NULL)) {
+		return NULL;
+	}
+	if ((size_t)index >= _items->size()) {
+		throw GenericException("Simulation snapshot refers to an agent or obstacle that does not exist in this engine.");
+	}
+	return (*_items)[index];
+}
+
+
+//====================================================
+// SimulationSnapshot
+//====================================================
+
+void SimulationSnapshot::clear()
+{
+	frameNumber = 0;
+	totalSimulationTime = 0.0;
+	simulationDt = 0.0;
+	numFramesSimulated = 0;
+	agents.clear();
+	modules.clear();
+}
+
+
+void SimulationSnapshot::writeToFile(const std::string & filename) const
+{
+	// the file is simply the whole snapshot serialized with the same writer that agents and modules use.
+	SimulationStateWriter writer;
+	writer.write(SIMULATION_SNAPSHOT_MAGIC_NUMBER);
+	writer.write(SIMULATION_SNAPSHOT_VERSION);
+	writer.write(frameNumber);
+	writer.write(totalSimulationTime);
+	writer.write(simulationDt);
+	writer.write(numFramesSimulated);
+
+	writer.write((unsigned int)agents.size());
+	for (unsigned int i=0; i < agents.size(); i++) {
+		writer.writeString(agents[i].ownerModuleName);
+		writer.write(agents[i].emitterNum);
+		writer.writeString(agents[i].initialConditions);
+		writer.writeString(agents[i].state);
+	}
+
+	writer.write((unsigned int)modules.size());
+	for (unsigned int i=0; i < modules.size(); i++) {
+		writer.writeString(modules[i].first);
+		writer.writeString(modules[i].second);
+	}
+
+	std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!out.is_open()) {
+		throw GenericException("SimulationSnapshot::writeToFile(): could not open file \"" + filename + "\".");
+	}
+	out.write(writer.getData().data(), writer.getData().size());
+	if (!out.good()) {
+		throw GenericException("SimulationSnapshot::writeToFile(): could not write file \"" + filename + "\".");
+	}
+}
+
+
+void SimulationSnapshot::readFromFile(const std::string & filename)
+{
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!in.is_open()) {
+		throw GenericException("SimulationSnapshot::readFromFile(): could not open file \"" + filename + "\".");
+	}
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	std::string data = contents.str();
+
+	SimulationStateReader reader(data);
+	unsigned int magic, version;
+	reader.read(magic);
+	reader.read(version);
+	if (magic != SIMULATION_SNAPSHOT_MAGIC_NUMBER) {
+		throw GenericException("SimulationSnapshot::readFromFile(): \"" + filename + "\" is not a simulation snapshot.");
+	}
+	if (version != SIMULATION_SNAPSHOT_VERSION) {
+		throw GenericException("SimulationSnapshot::readFromFile(): \"" + filename + "\" has an unsupported snapshot version.");
+	}
+
+	clear();
+	reader.read(frameNumber);
+	reader.read(totalSimulationTime);
+	reader.read(simulationDt);
+	reader.read(numFramesSimulated);
+
+	unsigned int numAgents;
+	reader.read(numAgents);
+	for (unsigned int i=0; i < numAgents; i++) {
+		AgentRecord record;
+		reader.readString(record.ownerModuleName);
+		reader.read(record.emitterNum);
+		reader.readString(record.initialConditions);
+		reader.readString(record.state);
+		agents.push_back(record);
+	}
+
+	unsigned int numModules;
+	reader.read(numModules);
+	for (unsigned int i=0; i < numModules; i++) {
+		std::pair<std::string, std::string> moduleState;
+		reader.readString(moduleState.first);
+		reader.readString(moduleState.second);
+		modules.push_back(moduleState);
+	}
+}
@@ -0,0 +1,383 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file StaticObstacleGeometry.cpp
+/// @brief Implements the SteerLib::StaticObstacleGeometry class.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "obstacles/StaticObstacleGeometry.h"
+#include "obstacles/CircleObstacle.h"
+#include "obstacles/OrientedWallObstacle.h"
+#include "obstacles/GridMapObstacle.h"
+
+using namespace SteerLib;
+using namespace Util;
+
+
+void StaticObstacleGeometry::clear()
+{
+	_segments.clear();
+	_loops.clear();
+	_loopGrids.clear();
+	_circles.clear();
+	_compiledObstacles.clear();
+}
+
+void StaticObstacleGeometry::compile(const std::set<SteerLib::ObstacleInterface*> & obstacles)
+{
+	clear();
+	for (std::set<SteerLib::ObstacleInterface*>::const_iterator obstacle = obstacles.begin(); obstacle != obstacles.end(); ++obstacle) {
+		addObstacle(*obstacle);
+	}
+}
+
+void StaticObstacleGeometry::addObstacle(SteerLib::ObstacleInterface * obstacle)
+{
+	CompiledObstacle compiled;
+	compiled.firstSegment = (unsigned int)_segments.size();
+	compiled.firstLoop = (unsigned int)_loops.size();
+	compiled.firstCircle = (unsigned int)_circles.size();
+
+	CircleObstacle * circleObstacle = dynamic_cast<CircleObstacle*>(obstacle);
+	OrientedWallObstacle * wallObstacle = dynamic_cast<OrientedWallObstacle*>(obstacle);
+	GridMapObstacle * mapObstacle = dynamic_cast<GridMapObstacle*>(obstacle);
+	if (circleObstacle != NULL) {
+		Circle circle;
+		circle.center = circleObstacle->position();
+		circle.center.y = 0.0f;
+		circle.radius = circleObstacle->radius();
+		circle.obstacle = obstacle;
+		_circles.push_back(circle);
+		_addLoop(obstacle, circleObstacle->getCirclePoints());
+	}
+	else if (wallObstacle != NULL) {
+		// the wall is made of separate sections on both sides of the door
+		const std::vector<OrientedBoxObstacle*> & sections = wallObstacle->getWallSections();
+		for (unsigned int i = 0; i < sections.size(); i++) {
+			_addLoop(obstacle, sections[i]->get2DStaticGeometry());
+		}
+	}
+	else if (mapObstacle != NULL) {
+		// a grid map has no single outline; each rectangle of blocked cells is a separate loop
+		std::vector<Util::AxisAlignedBox> rectangles;
+		mapObstacle->getBlockedRectangles(rectangles);
+		for (unsigned int i = 0; i < rectangles.size(); i++) {
+			std::vector<Util::Point> vertices;
+			vertices.push_back(Util::Point(rectangles[i].xmin, 0.0f, rectangles[i].zmin));
+			vertices.push_back(Util::Point(rectangles[i].xmax, 0.0f, rectangles[i].zmin));
+			vertices.push_back(Util::Point(rectangles[i].xmax, 0.0f, rectangles[i].zmax));
+			vertices.push_back(Util::Point(rectangles[i].xmin, 0.0f, rectangles[i].zmax));
+			_addLoop(obstacle, vertices);
+		}
+	}
+	else {
+		std::vector<Util::Point> vertices = obstacle->get2DStaticGeometry();
+		if (vertices.size() < 2) {
+			// no outline available; use the bounding box
+			const Util::AxisAlignedBox & bounds = obstacle->getBounds();
+			vertices.clear();
+			vertices.push_back(Util::Point(bounds.xmin, 0.0f, bounds.zmin));
+			vertices.push_back(Util::Point(bounds.xmax, 0.0f, bounds.zmin));
+			vertices.push_back(Util::Point(bounds.xmax, 0.0f, bounds.zmax));
+			vertices.push_back(Util::Point(bounds.xmin, 0.0f, bounds.zmax));
+		}
+		_addLoop(obstacle, vertices);
+	}
+
+	compiled.numSegments = (unsigned int)_segments.size() - compiled.firstSegment;
+	compiled.numLoops = (unsigned int)_loops.size() - compiled.firstLoop;
+	compiled.numCircles = (unsigned int)_circles.size() - compiled.firstCircle;
+	compiled.loopGrid = -1;
+	if (compiled.numLoops > MIN_LOOPS_FOR_LOOP_GRID) {
+		_buildLoopGrid(compiled);
+	}
+	_compiledObstacles[obstacle] = compiled;
+}
+
+const StaticObstacleGeometry::CompiledObstacle * StaticObstacleGeometry::getCompiledObstacle(const SteerLib::ObstacleInterface * obstacle) const
+{
+	std::map<const SteerLib::ObstacleInterface*, CompiledObstacle>::const_iterator iter = _compiledObstacles.find(obstacle);
+	return (iter == _compiledObstacles.end()) ? NULL : &(iter->second);
+}
+
+const StaticObstacleGeometry::Segment * StaticObstacleGeometry::findFacingSegment(const SteerLib::ObstacleInterface * obstacle, const Util::Point & p) const
+{
+	const CompiledObstacle * compiled = getCompiledObstacle(obstacle);
+	if (compiled == NULL || compiled->numSegments == 0) {
+		return NULL;
+	}
+
+	// the largest signed distance only identifies the facing edge within one convex loop, so first find the loop next to the point.
+	const Loop & loop = _loops[_findNearestLoop(*compiled, p)];
+	const Segment * facingSegment = &_segments[loop.firstSegment];
+	float maxDistance = signedDistance(*facingSegment, p);
+	for (unsigned int i = loop.firstSegment + 1; i < loop.firstSegment + loop.numSegments; i++) {
+		float distance = signedDistance(_segments[i], p);
+		if (distance > maxDistance) {
+			maxDistance = distance;
+			facingSegment = &_segments[i];
+		}
+	}
+	return facingSegment;
+}
+
+void StaticObstacleGeometry::getLoopsInRange(const SteerLib::ObstacleInterface * obstacle, float xmin, float xmax, float zmin, float zmax, std::vector<unsigned int> & loops) const
+{
+	const CompiledObstacle * compiled = getCompiledObstacle(obstacle);
+	if (compiled == NULL) {
+		return;
+	}
+
+	if (compiled->loopGrid < 0) {
+		for (unsigned int i = compiled->firstLoop; i < compiled->firstLoop + compiled->numLoops; i++) {
+			const Util::AxisAlignedBox & bounds = _loops[i].bounds;
+			if ((bounds.xmin <= xmax) && (bounds.xmax >= xmin) && (bounds.zmin <= zmax) && (bounds.zmax >= zmin)) {
+				loops.push_back(i);
+			}
+		}
+		return;
+	}
+
+	const LoopGrid & grid = _loopGrids[compiled->loopGrid];
+	int xMinIndex = std::max(0, (int)floorf((xmin - grid.xmin) / grid.cellSize));
+	int xMaxIndex = std::min((int)grid.numCellsX - 1, (int)floorf((xmax - grid.xmin) / grid.cellSize));
+	int zMinIndex = std::max(0, (int)floorf((zmin - grid.zmin) / grid.cellSize));
+	int zMaxIndex = std::min((int)grid.numCellsZ - 1, (int)floorf((zmax - grid.zmin) / grid.cellSize));
+
+	// a loop that spans several buckets is found more than once.
+	size_t firstAppended = loops.size();
+	for (int x = xMinIndex; x <= xMaxIndex; x++) {
+		for (int z = zMinIndex; z <= zMaxIndex; z++) {
+			unsigned int cell = (unsigned int)x * grid.numCellsZ + (unsigned int)z;
+			for (unsigned int i = grid.cellStarts[cell]; i < grid.cellStarts[cell + 1]; i++) {
+				const Util::AxisAlignedBox & bounds = _loops[grid.loopIndices[i]].bounds;
+				if ((bounds.xmin <= xmax) && (bounds.xmax >= xmin) && (bounds.zmin <= zmax) && (bounds.zmax >= zmin)) {
+					loops.push_back(grid.loopIndices[i]);
+				}
+			}
+		}
+	}
+	std::sort(loops.begin() + firstAppended, loops.end());
+	loops.erase(std::unique(loops.begin() + firstAppended, loops.end()), loops.end());
+}
+
+Util::Point StaticObstacleGeometry::closestPointOnSegment(const Segment & segment, const Util::Point & p)
+{
+	float t = Util::dot(p - segment.start, segment.direction);
+	t = std::max(0.0f, std::min(t, segment.length));
+	return segment.start + t * segment.direction;
+}
+
+
+//
+// _addLoop() - adds the segments of one closed outline, after putting the vertices in counter-clockwise order.
+//
+void StaticObstacleGeometry::_addLoop(SteerLib::ObstacleInterface * obstacle, std::vector<Util::Point> vertices)
+{
+	// flatten to the XZ plane, and remove repeated vertices (including a repeated first vertex at the end)
+	std::vector<Util::Point> loop;
+	for (unsigned int i = 0; i < vertices.size(); i++) {
+		Util::Point vertex(vertices[i].x, 0.0f, vertices[i].z);
+		if (loop.empty() || loop.back() != vertex) {
+			loop.push_back(vertex);
+		}
+	}
+	if (loop.size() > 1 && loop.front() == loop.back()) {
+		loop.pop_back();
+	}
+	if (loop.size() < 2) {
+		return;
+	}
+
+	float doubleArea = 0.0f;
+	for (unsigned int i = 0; i < loop.size(); i++) {
+		const Util::Point & a = loop[i];
+		const Util::Point & b = loop[(i + 1) % loop.size()];
+		doubleArea += a.x * b.z - a.z * b.x;
+	}
+	if (doubleArea < 0.0f) {
+		std::reverse(loop.begin(), loop.end());
+	}
+
+	const unsigned int n = (unsigned int)loop.size();
+	const unsigned int first = (unsigned int)_segments.size();
+
+	Loop compiledLoop;
+	compiledLoop.firstSegment = first;
+	compiledLoop.numSegments = n;
+	compiledLoop.bounds = Util::AxisAlignedBox(FLT_MAX, -FLT_MAX, 0.0f, 0.0f, FLT_MAX, -FLT_MAX);
+	for (unsigned int i = 0; i < n; i++) {
+		compiledLoop.bounds.xmin = std::min(compiledLoop.bounds.xmin, loop[i].x);
+		compiledLoop.bounds.xmax = std::max(compiledLoop.bounds.xmax, loop[i].x);
+		compiledLoop.bounds.zmin = std::min(compiledLoop.bounds.zmin, loop[i].z);
+		compiledLoop.bounds.zmax = std::max(compiledLoop.bounds.zmax, loop[i].z);
+	}
+	_loops.push_back(compiledLoop);
+
+	for (unsigned int i = 0; i < n; i++) {
+		const Util::Point & previousVertex = loop[(i + n - 1) % n];
+		const Util::Point & vertex = loop[i];
+		const Util::Point & nextVertex = loop[(i + 1) % n];
+
+		Segment segment;
+		segment.start = vertex;
+		segment.end = nextVertex;
+		segment.length = (nextVertex - vertex).length();
+		segment.direction = (nextVertex - vertex) / segment.length;
+		segment.normal = Util::Vector(segment.direction.z, 0.0f, -segment.direction.x);
+		if (n == 2) {
+			segment.startIsConvex = true;
+		}
+		else {
+			// same test as leftOf() in the RVO2 obstacle code
+			Util::Vector a = previousVertex - nextVertex;
+			Util::Vector b = vertex - previousVertex;
+			segment.startIsConvex = (a.x * b.z - a.z * b.x >= 0.0f);
+		}
+		segment.previous = first + (i + n - 1) % n;
+		segment.next = first + (i + 1) % n;
+		segment.obstacle = obstacle;
+		_segments.push_back(segment);
+	}
+}
+
+
+//
+// _buildLoopGrid() - sorts the loops of an obstacle into buckets of a uniform grid, with about one bucket per loop.
+//
+void StaticObstacleGeometry::_buildLoopGrid(CompiledObstacle & compiled)
+{
+	Util::AxisAlignedBox bounds(FLT_MAX, -FLT_MAX, 0.0f, 0.0f, FLT_MAX, -FLT_MAX);
+	for (unsigned int i = compiled.firstLoop; i < compiled.firstLoop + compiled.numLoops; i++) {
+		bounds.xmin = std::min(bounds.xmin, _loops[i].bounds.xmin);
+		bounds.xmax = std::max(bounds.xmax, _loops[i].bounds.xmax);
+		bounds.zmin = std::min(bounds.zmin, _loops[i].bounds.zmin);
+		bounds.zmax = std::max(bounds.zmax, _loops[i].bounds.zmax);
+	}
+
+	LoopGrid grid;
+	grid.xmin = bounds.xmin;
+	grid.zmin = bounds.zmin;
+	grid.cellSize = std::max(bounds.xmax - bounds.xmin, bounds.zmax - bounds.zmin) / ceilf(sqrtf((float)compiled.numLoops));
+	if (grid.cellSize <= 0.0f) {
+		return;
+	}
+	grid.numCellsX = std::max(1u, (unsigned int)ceilf((bounds.xmax - bounds.xmin) / grid.cellSize));
+	grid.numCellsZ = std::max(1u, (unsigned int)ceilf((bounds.zmax - bounds.zmin) / grid.cellSize));
+
+	// count the loops of each bucket, then fill the buckets.
+	std::vector<unsigned int> cellCounts(grid.numCellsX * grid.numCellsZ + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		for (unsigned int i = compiled.firstLoop; i < compiled.firstLoop + compiled.numLoops; i++) {
+			const Util::AxisAlignedBox & loopBounds = _loops[i].bounds;
+			unsigned int xMinIndex = std::min(grid.numCellsX - 1, (unsigned int)((loopBounds.xmin - grid.xmin) / grid.cellSize));
+			unsigned int xMaxIndex = std::min(grid.numCellsX - 1, (unsigned int)((loopBounds.xmax - grid.xmin) / grid.cellSize));
+			unsigned int zMinIndex = std::min(grid.numCellsZ - 1, (unsigned int)((loopBounds.zmin - grid.zmin) / grid.cellSize));
+			unsigned int zMaxIndex = std::min(grid.numCellsZ - 1, (unsigned int)((loopBounds.zmax - grid.zmin) / grid.cellSize));
+			for (unsigned int x = xMinIndex; x <= xMaxIndex; x++) {
+				for (unsigned int z = zMinIndex; z <= zMaxIndex; z++) {
+					unsigned int cell = x * grid.numCellsZ + z;
+					if (pass == 0) {
+						cellCounts[cell]++;
+					}
+					else {
+						grid.loopIndices[cellCounts[cell]++] = i;
+					}
+				}
+			}
+		}
+		if (pass == 0) {
+			grid.cellStarts.resize(cellCounts.size());
+			unsigned int start = 0;
+			for (unsigned int cell = 0; cell < cellCounts.size(); cell++) {
+				grid.cellStarts[cell] = start;
+				start += cellCounts[cell];
+				cellCounts[cell] = grid.cellStarts[cell];
+			}
+			grid.loopIndices.resize(start);
+		}
+	}
+
+	compiled.loopGrid = (int)_loopGrids.size();
+	_loopGrids.push_back(grid);
+}
+
+
+//
+// _findNearestLoop() - returns the loop of the obstacle that is closest to the point.
+//
+unsigned int StaticObstacleGeometry::_findNearestLoop(const CompiledObstacle & compiled, const Util::Point & p) const
+{
+	unsigned int nearestLoop = compiled.firstLoop;
+	if (compiled.numLoops == 1) {
+		return nearestLoop;
+	}
+
+	float nearestDistance = FLT_MAX;
+	if (compiled.loopGrid < 0) {
+		for (unsigned int i = compiled.firstLoop; i < compiled.firstLoop + compiled.numLoops; i++) {
+			float distance = _distanceToLoop(_loops[i], p);
+			if (distance < nearestDistance) {
+				nearestDistance = distance;
+				nearestLoop = i;
+			}
+		}
+		return nearestLoop;
+	}
+
+	// search rings of buckets around the bucket nearest to the point; every loop that is first found in ring r is at least (r-1) buckets away.
+	const LoopGrid & grid = _loopGrids[compiled.loopGrid];
+	int px = std::max(0, std::min((int)grid.numCellsX - 1, (int)floorf((p.x - grid.xmin) / grid.cellSize)));
+	int pz = std::max(0, std::min((int)grid.numCellsZ - 1, (int)floorf((p.z - grid.zmin) / grid.cellSize)));
+	int maxRing = std::max(std::max(px, (int)grid.numCellsX - 1 - px), std::max(pz, (int)grid.numCellsZ - 1 - pz));
+	for (int ring = 0; ring <= maxRing; ring++) {
+		if (nearestDistance <= (float)(ring - 1) * grid.cellSize) {
+			break;
+		}
+		for (int x = std::max(0, px - ring); x <= std::min((int)grid.numCellsX - 1, px + ring); x++) {
+			// only the first and last rows of the ring, except for its left and right columns.
+			int zStep = ((x == px - ring) || (x == px + ring)) ? 1 : std::max(1, 2 * ring);
+			for (int z = pz - ring; z <= pz + ring; z += zStep) {
+				if ((z < 0) || (z >= (int)grid.numCellsZ)) {
+					continue;
+				}
+				unsigned int cell = (unsigned int)x * grid.numCellsZ + (unsigned int)z;
+				for (unsigned int i = grid.cellStarts[cell]; i < grid.cellStarts[cell + 1]; i++) {
+					unsigned int loopIndex = grid.loopIndices[i];
+					const Util::AxisAlignedBox & bounds = _loops[loopIndex].bounds;
+					float dx = std::max(0.0f, std::max(bounds.xmin - p.x, p.x - bounds.xmax));
+					float dz = std::max(0.0f, std::max(bounds.zmin - p.z, p.z - bounds.zmax));
+					if (dx * dx + dz * dz >= nearestDistance * nearestDistance) {
+						continue;
+					}
+					float distance = _distanceToLoop(_loops[loopIndex], p);
+					if ((distance < nearestDistance) || ((distance == nearestDistance) && (loopIndex < nearestLoop))) {
+						nearestDistance = distance;
+						nearestLoop = loopIndex;
+					}
+				}
+			}
+		}
+	}
+	return nearestLoop;
+}
+
+
+//
+// _distanceToLoop() - returns the distance from the point to the outline of the loop, or 0 if the point is inside a convex loop.
+//
+float StaticObstacleGeometry::_distanceToLoop(const Loop & loop, const Util::Point & p) const
+{
+	float maxSignedDistance = -FLT_MAX;
+	float minDistance = FLT_MAX;
+	for (unsigned int i = loop.firstSegment; i < loop.firstSegment + loop.numSegments; i++) {
+		maxSignedDistance = std::max(maxSignedDistance, signedDistance(_segments[i], p));
+		minDistance = std::min(minDistance, (p - closestPointOnSegment(_segments[i], p)).length());
+	}
+	return (maxSignedDistance <= 0.0f) ? 0.0f : minDistance;
+}
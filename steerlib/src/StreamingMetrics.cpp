@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file StreamingMetrics.cpp
+/// @brief Implements the SteerLib::WindowedMetric class.
+
+#include "benchmarking/StreamingMetrics.h"
+
+using namespace SteerLib;
+using namespace Util;
+
+
+WindowedMetric::WindowedMetric()
+{
+	setWindowSize(DEFAULT_METRICS_WINDOW_SIZE);
+}
+
+WindowedMetric::WindowedMetric(unsigned int windowSize)
+{
+	setWindowSize(windowSize);
+}
+
+void WindowedMetric::setWindowSize(unsigned int windowSize)
+{
+	if (windowSize == 0) {
+		throw GenericException("WindowedMetric: the window must hold at least one sample.");
+	}
+	_samples.setCapacity(windowSize);
+	_minQueue.setCapacity(windowSize);
+	_maxQueue.setCapacity(windowSize);
+	clear();
+}
+
+void WindowedMetric::clear()
+{
+	_samples.clear();
+	_minQueue.clear();
+	_maxQueue.clear();
+	_numSamplesPushed = 0;
+	_numPushedSinceRecompute = 0;
+	_sum = 0.0;
+	_mean = 0.0;
+	_m2 = 0.0;
+}
+
+void WindowedMetric::push(float value)
+{
+	double x = (double)value;
+	if (_samples.full()) {
+		// replace the oldest sample: remove it from the running mean and variance while adding the new one
+		double oldX = (double)_samples.oldest();
+		double oldMean = _mean;
+		_sum += x - oldX;
+		_mean += (x - oldX) / (double)_samples.size();
+		_m2 += (x - oldX) * ((x - _mean) + (oldX - oldMean));
+		_samples.push(value);
+	}
+	else {
+		_samples.push(value);
+		double delta = x - _mean;
+		_sum += x;
+		_mean += delta / (double)_samples.size();
+		_m2 += delta * (x - _mean);
+	}
+
+	_pushToQueue(_minQueue, value, false);
+	_pushToQueue(_maxQueue, value, true);
+	_numSamplesPushed++;
+
+	_numPushedSinceRecompute++;
+	if (_numPushedSinceRecompute >= _samples.capacity()) {
+		_recomputeAggregates();
+	}
+}
+
+
+//
+// _recomputeAggregates() - recomputes the sum, mean and variance from the samples, discarding accumulated rounding errors.
+//
+void WindowedMetric::_recomputeAggregates()
+{
+	_numPushedSinceRecompute = 0;
+	_sum = 0.0;
+	for (unsigned int i=0; i < _samples.size(); i++) {
+		_sum += (double)_samples[i];
+	}
+	_mean = (_samples.size() == 0) ? 0.0 : _sum / (double)_samples.size();
+	_m2 = 0.0;
+	for (unsigned int i=0; i < _samples.size(); i++) {
+		double delta = (double)_samples[i] - _mean;
+		_m2 += delta * delta;
+	}
+}
+
+
+//
+// _pushToQueue() - updates a monotonic queue, whose oldest entry is always the minimum (or maximum) of the window.
+//
+void WindowedMetric::_pushToQueue(MetricRingBuffer<QueueEntry> & queue, float value, bool keepLarger)
+{
+	// entries that can never be the extreme again, because the new sample is better and stays in the window longer
+	while (queue.size() > 0 && (keepLarger ? (queue.newest().value <= value) : (queue.newest().value >= value))) {
+		queue.popNewest();
+	}
+	// entries that have left the window
+	while (queue.size() > 0 && (queue.oldest().sampleNumber + _samples.capacity() <= _numSamplesPushed)) {
+		queue.popOldest();
+	}
+
+	QueueEntry entry;
+	entry.sampleNumber = _numSamplesPushed;
+	entry.value = value;
+	queue.push(entry);
+}
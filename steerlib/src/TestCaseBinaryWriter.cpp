@@ -0,0 +1,288 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file TestCaseBinaryWriter.cpp
+/// @brief Implements the SteerLib::TestCaseBinaryWriter class.
+
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+#include "testcaseio/TestCaseIO.h"
+#include "util/GenericException.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+namespace {
+
+	/// Collects all strings of a compiled test case; identical strings are stored only once.
+	class StringTable {
+	public:
+		StringTable() { _data.push_back('\0'); _offsets[""] = 0; }
+
+		unsigned int add(const std::string & str) {
+			std::map<std::string, unsigned int>::iterator iter = _offsets.find(str);
+			if (iter != _offsets.end()) {
+				return iter->second;
+			}
+			unsigned int offset = (unsigned int)_data.size();
+			_data.insert(_data.end(), str.begin(), str.end());
+			_data.push_back('\0');
+			_offsets[str] = offset;
+			return offset;
+		}
+
+		const std::vector<char> & data() const { return _data; }
+
+	protected:
+		std::vector<char> _data;
+		std::map<std::string, unsigned int> _offsets;
+	};
+
+	inline void copyPoint(float * dest, const Util::Point & p) { dest[0] = p.x; dest[1] = p.y; dest[2] = p.z; }
+	inline void copyVector(float * dest, const Util::Vector & v) { dest[0] = v.x; dest[1] = v.y; dest[2] = v.z; }
+	inline void copyBox(float * dest, const Util::AxisAlignedBox & b) { dest[0] = b.xmin; dest[1] = b.xmax; dest[2] = b.ymin; dest[3] = b.ymax; dest[4] = b.zmin; dest[5] = b.zmax; }
+
+	/// Rounds offset up to the next multiple of 8 bytes, so that every section is safely aligned when memory mapped.
+	inline unsigned int alignOffset(unsigned int offset) { return (offset + 7u) & ~7u; }
+
+	void compileAgent(const AgentInitialConditions & ic, TestCaseBinaryAgentInfo & agent,
+		std::vector<TestCaseBinaryGoalInfo> & goals, std::vector<TestCaseBinaryBehaviourParameter> & parameters, StringTable & strings)
+	{
+		agent.nameString = strings.add(ic.name);
+		copyPoint(agent.position, ic.position);
+		copyVector(agent.direction, ic.direction);
+		agent.radius = ic.radius;
+		agent.speed = ic.speed;
+		agent.color[0] = ic.color.r;
+		agent.color[1] = ic.color.g;
+		agent.color[2] = ic.color.b;
+		agent.colorSet = ic.colorSet ? 1 : 0;
+		agent.fromRandom = ic.fromRandom ? 1 : 0;
+		copyBox(agent.randBox, ic.randBox);
+		agent.firstGoal = (unsigned int)goals.size();
+		agent.numGoals = (unsigned int)ic.goals.size();
+
+		for (unsigned int i=0; i < ic.goals.size(); i++) {
+			const AgentGoalInfo & goalInfo = ic.goals[i];
+			TestCaseBinaryGoalInfo goal;
+			goal.goalType = (unsigned int)goalInfo.goalType;
+			goal.targetIsRandom = goalInfo.targetIsRandom ? 1 : 0;
+			goal.timeDuration = goalInfo.timeDuration;
+			goal.desiredSpeed = goalInfo.desiredSpeed;
+			copyPoint(goal.targetLocation, goalInfo.targetLocation);
+			copyVector(goal.targetDirection, goalInfo.targetDirection);
+			copyBox(goal.targetRegion, goalInfo.targetRegion);
+			goal.targetNameString = strings.add(goalInfo.targetName);
+			goal.flowTypeString = strings.add(goalInfo.flowType);
+			goal.steeringAlgString = strings.add(goalInfo.targetBehaviour.getSteeringAlg());
+
+			std::vector<BehaviourParameter> behaviourParameters = goalInfo.targetBehaviour.getParameters();
+			goal.firstBehaviourParameter = (unsigned int)parameters.size();
+			goal.numBehaviourParameters = (unsigned int)behaviourParameters.size();
+			for (unsigned int p=0; p < behaviourParameters.size(); p++) {
+				TestCaseBinaryBehaviourParameter parameter;
+				parameter.keyString = strings.add(behaviourParameters[p].key);
+				parameter.valueString = strings.add(behaviourParameters[p].value);
+				parameters.push_back(parameter);
+			}
+			goals.push_back(goal);
+		}
+	}
+
+	void compileObstacle(const ObstacleInitialConditions * ic, TestCaseBinaryObstacleInfo & obstacle, std::vector<TestCaseBinaryVertexData> & vertices, std::vector<unsigned int> & gridMapWords)
+	{
+		memset(&obstacle, 0, sizeof(TestCaseBinaryObstacleInfo));
+
+		// test the derived wall type before its oriented box base class.
+		if (const OrientedWallObstacleInitialConditions * wall = dynamic_cast<const OrientedWallObstacleInitialConditions*>(ic)) {
+			obstacle.obstacleType = TESTCASE_BINARY_ORIENTED_WALL_OBSTACLE;
+			copyPoint(obstacle.position, wall->position);
+			obstacle.lengthX = wall->lengthX;
+			obstacle.lengthZ = wall->lengthZ;
+			obstacle.height = wall->height;
+			obstacle.thetaY = wall->thetaY;
+			obstacle.doorLocation = wall->doorLocation;
+			obstacle.doorRadius = wall->doorRadius;
+		}
+		else if (const OrientedBoxObstacleInitialConditions * obox = dynamic_cast<const OrientedBoxObstacleInitialConditions*>(ic)) {
+			obstacle.obstacleType = TESTCASE_BINARY_ORIENTED_BOX_OBSTACLE;
+			copyPoint(obstacle.position, obox->position);
+			obstacle.lengthX = obox->lengthX;
+			obstacle.lengthZ = obox->lengthZ;
+			obstacle.height = obox->height;
+			obstacle.thetaY = obox->thetaY;
+		}
+		else if (const BoxObstacleInitialConditions * box = dynamic_cast<const BoxObstacleInitialConditions*>(ic)) {
+			obstacle.obstacleType = TESTCASE_BINARY_BOX_OBSTACLE;
+			obstacle.bounds[0] = box->xmin;
+			obstacle.bounds[1] = box->xmax;
+			obstacle.bounds[2] = box->ymin;
+			obstacle.bounds[3] = box->ymax;
+			obstacle.bounds[4] = box->zmin;
+			obstacle.bounds[5] = box->zmax;
+		}
+		else if (const CircleObstacleInitialConditions * circle = dynamic_cast<const CircleObstacleInitialConditions*>(ic)) {
+			obstacle.obstacleType = TESTCASE_BINARY_CIRCLE_OBSTACLE;
+			copyPoint(obstacle.position, circle->position);
+			obstacle.radius = circle->radius;
+			obstacle.height = circle->height;
+		}
+		else if (const PolygonObstacleInitialConditions * polygon = dynamic_cast<const PolygonObstacleInitialConditions*>(ic)) {
+			obstacle.obstacleType = TESTCASE_BINARY_POLYGON_OBSTACLE;
+			obstacle.firstVertex = (unsigned int)vertices.size();
+			obstacle.numVertices = (unsigned int)polygon->_vertices.size();
+			for (unsigned int i=0; i < polygon->_vertices.size(); i++) {
+				TestCaseBinaryVertexData v;
+				v.x = polygon->_vertices[i].x;
+				v.y = polygon->_vertices[i].y;
+				v.z = polygon->_vertices[i].z;
+				vertices.push_back(v);
+			}
+		}
+		else if (const GridMapObstacleInitialConditions * gridMap = dynamic_cast<const GridMapObstacleInitialConditions*>(ic)) {
+			const GridMapObstacle & map = gridMap->map;
+			obstacle.obstacleType = TESTCASE_BINARY_GRID_MAP_OBSTACLE;
+			obstacle.position[0] = map.getOriginX();
+			obstacle.position[2] = map.getOriginZ();
+			obstacle.cellSize = map.getCellSize();
+			obstacle.numCellsX = map.getNumCellsX();
+			obstacle.numCellsZ = map.getNumCellsZ();
+			// the SpatialDatabaseItem accessor is not const.
+			obstacle.traversalCost = const_cast<GridMapObstacle&>(map).getTraversalCost();
+			obstacle.firstGridMapWord = (unsigned int)gridMapWords.size();
+
+			unsigned int wordsPerRow = (map.getNumCellsX() + 31) / 32;
+			gridMapWords.resize(gridMapWords.size() + wordsPerRow * map.getNumCellsZ(), 0);
+			for (unsigned int z=0; z < map.getNumCellsZ(); z++) {
+				unsigned int * row = &gridMapWords[obstacle.firstGridMapWord + z * wordsPerRow];
+				for (unsigned int x=0; x < map.getNumCellsX(); x++) {
+					if (map.isBlocked(x, z)) {
+						row[x >> 5] |= (1u << (x & 31));
+					}
+				}
+			}
+		}
+		else {
+			throw GenericException("TestCaseBinaryWriter::writeBinaryTestCase(): unsupported obstacle type, cannot compile this test case.");
+		}
+	}
+
+	template <class T>
+	void writeSection(std::ofstream & out, const std::vector<T> & items, unsigned int offset)
+	{
+		static const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		unsigned int position = (unsigned int)out.tellp();
+		assert(position <= offset && offset - position < 8);
+		out.write(padding, offset - position);
+		if (!items.empty()) {
+			out.write((const char*)&items[0], sizeof(T) * items.size());
+		}
+	}
+
+} // end anonymous namespace
+
+
+void TestCaseBinaryWriter::writeBinaryTestCase( const std::string & filename, TestCaseReader & testCase, const std::string & sourceFilename )
+{
+	StringTable strings;
+	TestCaseBinaryHeader header;
+	memset(&header, 0, sizeof(TestCaseBinaryHeader));
+
+	std::vector<TestCaseBinaryCameraInfo> cameras;
+	std::vector<TestCaseBinaryAgentInfo> agents;
+	std::vector<TestCaseBinaryGoalInfo> goals;
+	std::vector<TestCaseBinaryBehaviourParameter> parameters;
+	std::vector<TestCaseBinaryObstacleInfo> obstacles;
+	std::vector<TestCaseBinaryVertexData> vertices;
+	std::vector<unsigned int> gridMapWords;
+
+	//
+	// flatten all initial conditions into fixed-size records
+	//
+	for (unsigned int i=0; i < testCase.getNumCameraViews(); i++) {
+		const CameraView & view = testCase.getCameraView(i);
+		TestCaseBinaryCameraInfo camera;
+		copyPoint(camera.position, view.position);
+		copyPoint(camera.lookat, view.lookat);
+		copyVector(camera.up, view.up);
+		camera.fovy = view.fovy;
+		cameras.push_back(camera);
+	}
+
+	agents.resize(testCase.getNumAgents() + testCase.getNumAgentEmitters());
+	for (unsigned int i=0; i < testCase.getNumAgents(); i++) {
+		compileAgent(testCase.getAgentInitialConditions(i), agents[i], goals, parameters, strings);
+	}
+	for (unsigned int i=0; i < testCase.getNumAgentEmitters(); i++) {
+		compileAgent(testCase.getAgentEmitterInitialConditions(i), agents[testCase.getNumAgents() + i], goals, parameters, strings);
+	}
+
+	obstacles.resize(testCase.getNumObstacles());
+	for (unsigned int i=0; i < testCase.getNumObstacles(); i++) {
+		compileObstacle(testCase.getObstacleInitialConditions(i), obstacles[i], vertices, gridMapWords);
+	}
+
+	header.nameString = strings.add(testCase.getTestCaseName());
+	header.descriptionString = strings.add(testCase.getDescription());
+	header.versionString = strings.add(testCase.getVersion());
+	header.passingCriteriaString = strings.add(testCase.getPassingCriteria());
+	header.sourceFilenameString = strings.add(sourceFilename);
+	copyBox(header.worldBounds, testCase.getWorldBounds());
+
+	//
+	// lay out the sections
+	//
+	header.magic = TESTCASE_BINARY_MAGIC_NUMBER;
+	header.version = TESTCASE_BINARY_VERSION;
+	header.headerSize = sizeof(TestCaseBinaryHeader);
+	header.numCameraViews = (unsigned int)cameras.size();
+	header.numAgents = (unsigned int)testCase.getNumAgents();
+	header.numAgentEmitters = (unsigned int)testCase.getNumAgentEmitters();
+	header.numGoals = (unsigned int)goals.size();
+	header.numBehaviourParameters = (unsigned int)parameters.size();
+	header.numObstacles = (unsigned int)obstacles.size();
+	header.numVertices = (unsigned int)vertices.size();
+	header.numGridMapWords = (unsigned int)gridMapWords.size();
+	header.stringTableSize = (unsigned int)strings.data().size();
+
+	header.cameraListOffset = alignOffset(header.headerSize);
+	header.agentListOffset = alignOffset(header.cameraListOffset + sizeof(TestCaseBinaryCameraInfo) * header.numCameraViews);
+	header.agentEmitterListOffset = header.agentListOffset + sizeof(TestCaseBinaryAgentInfo) * header.numAgents;
+	header.goalListOffset = alignOffset(header.agentEmitterListOffset + sizeof(TestCaseBinaryAgentInfo) * header.numAgentEmitters);
+	header.behaviourParameterListOffset = alignOffset(header.goalListOffset + sizeof(TestCaseBinaryGoalInfo) * header.numGoals);
+	header.obstacleListOffset = alignOffset(header.behaviourParameterListOffset + sizeof(TestCaseBinaryBehaviourParameter) * header.numBehaviourParameters);
+	header.vertexListOffset = alignOffset(header.obstacleListOffset + sizeof(TestCaseBinaryObstacleInfo) * header.numObstacles);
+	header.gridMapWordListOffset = alignOffset(header.vertexListOffset + sizeof(TestCaseBinaryVertexData) * header.numVertices);
+	header.stringTableOffset = alignOffset(header.gridMapWordListOffset + sizeof(unsigned int) * header.numGridMapWords);
+	header.fileSize = header.stringTableOffset + header.stringTableSize;
+
+	//
+	// write the file
+	//
+	std::ofstream out(filename.c_str(), ios::binary);
+	if (!out.is_open()) {
+		throw GenericException("TestCaseBinaryWriter::writeBinaryTestCase(): could not open file \"" + filename + "\".");
+	}
+
+	out.write((const char*)&header, sizeof(TestCaseBinaryHeader));
+	writeSection(out, cameras, header.cameraListOffset);
+	writeSection(out, agents, header.agentListOffset);
+	writeSection(out, goals, header.goalListOffset);
+	writeSection(out, parameters, header.behaviourParameterListOffset);
+	writeSection(out, obstacles, header.obstacleListOffset);
+	writeSection(out, vertices, header.vertexListOffset);
+	writeSection(out, gridMapWords, header.gridMapWordListOffset);
+	writeSection(out, strings.data(), header.stringTableOffset);
+
+	if (!out.good() || (unsigned int)out.tellp() != header.fileSize) {
+		throw GenericException("TestCaseBinaryWriter::writeBinaryTestCase(): failed while writing \"" + filename + "\".");
+	}
+	out.close();
+}
@@ -7,6 +7,7 @@
 /// @file TestCasePlayerModule.cpp
 /// @brief Implements the TestCasePlayerModule built-in module.
 
+#include <sstream>
 #include "modules/TestCasePlayerModule.h"
 #include "testcaseio/TestCaseIO.h"
 #include "util/Misc.h"
@@ -14,11 +15,15 @@
 
 using namespace SteerLib;
 
+/// The seed that TestCaseReader always used, so that test cases without a "seed" option resolve the same random initial conditions as before.
+#define DEFAULT_TEST_CASE_RANDOM_SEED 2
+
 // #define _DEBUG 1
 
 void TestCasePlayerModule::init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo ) {
 	_engine = engineInfo;
 	_testCaseFilename = "";
+	_randomSeed = DEFAULT_TEST_CASE_RANDOM_SEED;
 	_aiModuleName = "";
 	_aiModuleSearchPath = "";
 	_aiModule = NULL;
@@ -33,6 +38,9 @@ void TestCasePlayerModule::init( const SteerLib::OptionDictionary & options, Ste
 		else if ((*optionIter).first == "ai") {
 			_aiModuleName = (*optionIter).second;
 		}
+		else if ((*optionIter).first == "seed") {
+			std::istringstream((*optionIter).second) >> _randomSeed;
+		}
 		else {
 			throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to testCasePlayer module.");
 		}
@@ -90,12 +98,19 @@ void TestCasePlayerModule::initializeSimulation() {
 	else if (Util::fileCanBeOpened( _engine->getTestCaseSearchPath() + _testCaseFilename + ".xml" )) {
 		testCasePath = _engine->getTestCaseSearchPath() + _testCaseFilename + ".xml";
 	}
+	else if (Util::fileCanBeOpened(_testCaseFilename + SteerLib::TESTCASE_BINARY_EXTENSION)) {
+		testCasePath = _testCaseFilename + SteerLib::TESTCASE_BINARY_EXTENSION;
+	}
+	else if (Util::fileCanBeOpened( _engine->getTestCaseSearchPath() + _testCaseFilename + SteerLib::TESTCASE_BINARY_EXTENSION )) {
+		testCasePath = _engine->getTestCaseSearchPath() + _testCaseFilename + SteerLib::TESTCASE_BINARY_EXTENSION;
+	}
 	else {
 		throw Util::GenericException("Could not find test case " + _testCaseFilename + ".");
 	}
 
-	// open the test case
+	// open the test case; compiled test cases are memory mapped instead of parsed.
 	testCaseReader = new SteerLib::TestCaseReader();
+	testCaseReader->setRandomSeed(_randomSeed);
 	testCaseReader->readTestCaseFromFile(testCasePath);
 
 	//Create the obstacles
@@ -141,6 +156,11 @@ void TestCasePlayerModule::initializeSimulation() {
 
 }
 
+void TestCasePlayerModule::setTestCase( const std::string & testCaseFilename, unsigned int randomSeed ) {
+	_testCaseFilename = testCaseFilename;
+	_randomSeed = randomSeed;
+}
+
 void TestCasePlayerModule::postprocessFrame(float timeStamp, float dt, unsigned int frameNumber) {
 #ifdef ENABLE_GUI
 #ifdef ENABLE_QT
@@ -7,11 +7,15 @@
 /// @file TestCaseReader.cpp
 /// @brief Implements the SteerLib::TestCaseReader class.
 
+#include <fstream>
 #include "testcaseio/TestCaseIO.h"
+#include "testcaseio/MovingAIIO.h"
 #include "util/GenericException.h"
+#include "util/MemoryMapper.h"
 #include "util/Misc.h"
 #include "mersenne/MersenneTwister.h"
 #include "griddatabase/GridDatabase2D.h"
+#include "griddatabase/GridDatabaseRegionSampler.h"
 #include "interfaces/SpatialDataBaseInterface.h"
 
 using namespace std;
@@ -26,6 +30,16 @@ TestCaseReader::TestCaseReader()
 
 void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename )
 {
+	// compiled test cases already contain resolved initial conditions.
+	if (isAValidBinaryTestCase(testCaseFilename)) {
+		readTestCaseFromBinaryFile(testCaseFilename);
+		return;
+	}
+	if (MovingAIReader::isAMovingAIMap(testCaseFilename)) {
+		readTestCaseFromMovingAIMap(testCaseFilename);
+		return;
+	}
+
 	_header.description = "";
 	_header.name = "";
 	_header.passingCriteria = "";
@@ -56,8 +70,8 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 	// then, initialize agents and obstacles based on the test case specs.
 	//
 
-	// create a temporary grid database used for randomly placing agents
-	SpatialDataBaseInterface * testCaseDB = new GridDatabase2D(_header.worldBounds.xmin, _header.worldBounds.xmax, _header.worldBounds.zmin, _header.worldBounds.zmax, 200, 200, 10, true);
+	// create a temporary grid database used for randomly placing agents; it is freed when this function returns or throws.
+	GridDatabase2D testCaseDB(_header.worldBounds.xmin, _header.worldBounds.xmax, _header.worldBounds.zmin, _header.worldBounds.zmax, 200, 200, 10, true);
 #ifdef _DEBUG
 	std::cout << "num raw obstacles: " << _rawObstacles.size() << std::endl;
 #endif
@@ -77,7 +91,7 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 		_initObstacleInitialConditions(newObstacle, _rawObstacles[i].obstacleBounds);*/
 		ObstacleInitialConditions *newObstacle = _rawObstacles[i]->getObstacleInitialConditions();
 		_initializedObstacles.push_back(newObstacle);
-		testCaseDB->addObject(_rawObstacles[i], _rawObstacles[i]->obstacleBounds);
+		testCaseDB.addObject(_rawObstacles[i], _rawObstacles[i]->obstacleBounds);
 	}
 
 
@@ -144,7 +158,7 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 			continue;  // don't process non-random obstacles on the second round
 		}
 
-		Point newPosition = testCaseDB->randomPositionInRegionWithoutCollisions( box->regionBounds,box->size, false, _randomNumberGenerator);
+		Point newPosition = testCaseDB.randomPositionInRegionWithoutCollisions( box->regionBounds,box->size, false, _randomNumberGenerator);
 		float offset = box->size * 0.5f;
 		_rawObstacles[i]->obstacleBounds = AxisAlignedBox(newPosition.x-offset, newPosition.x+offset, 0.0f, box->height, newPosition.z-offset, newPosition.z+offset);
 
@@ -152,12 +166,16 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 		BoxObstacleInitialConditions * newObstacle = new BoxObstacleInitialConditions();
 		_initObstacleInitialConditions(*newObstacle, _rawObstacles[i]->obstacleBounds);
 		_initializedObstacles.push_back(newObstacle);
-		testCaseDB->addObject((_rawObstacles[i]), _rawObstacles[i]->obstacleBounds);
+		testCaseDB.addObject((_rawObstacles[i]), _rawObstacles[i]->obstacleBounds);
 
 	}
 
 
 	// Finally, add all random agents.
+	// Agents of the same region share one sampler, which keeps track of the free space left in that region,
+	// so that densely packed regions do not degrade into endless rejection sampling.
+	// The samplers are held by value, so they are freed even if placing an agent throws.
+	std::vector<GridDatabaseRegionSampler> samplers;
 	for (unsigned int i=0; i<_rawAgents.size(); i++)
 	{
 
@@ -167,7 +185,21 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 		}
 		AgentInitialConditions newAgent;
 		newAgent.fromRandom = true;
-		_rawAgents[i].position = testCaseDB->randomPositionInRegionWithoutCollisions( _rawAgents[i].regionBounds, _rawAgents[i].radius, false, _randomNumberGenerator);
+
+		GridDatabaseRegionSampler * sampler = NULL;
+		for (unsigned int s=0; s<samplers.size(); s++) {
+			if (samplers[s].matches(_rawAgents[i].regionBounds, _rawAgents[i].radius, false)) {
+				sampler = &samplers[s];
+				break;
+			}
+		}
+		if (sampler == NULL) {
+			samplers.push_back(GridDatabaseRegionSampler(&testCaseDB, _rawAgents[i].regionBounds, _rawAgents[i].radius, false));
+			sampler = &samplers.back();
+		}
+		if (!sampler->randomPosition(_randomNumberGenerator, _rawAgents[i].position)) {
+			throw GenericException("Could not place agent \"" + _rawAgents[i].name + "\" randomly, its region is already too dense.  Probably need to fix the test case.");
+		}
 		_rawAgents[i].isPositionRandom = false;
 
 		float xpos = _rawAgents[i].position.x;
@@ -179,10 +211,261 @@ void TestCaseReader::readTestCaseFromFile( const std::string & testCaseFilename
 		// if it doesnt overlap, then add it to the database
 		_initAgentInitialConditions(newAgent, _rawAgents[i]);
 		_initializedAgents.push_back(newAgent);
-		testCaseDB->addObject(&(_rawAgents[i]), agentBounds);
+		testCaseDB.addObject(&(_rawAgents[i]), agentBounds);
+		for (unsigned int s=0; s<samplers.size(); s++) {
+			samplers[s].markOccupied(_rawAgents[i].position, radius);
+		}
+	}
+}
+
+
+
+bool TestCaseReader::isAValidBinaryTestCase( const std::string & testCaseFilename )
+{
+	ifstream testCaseFile;
+	testCaseFile.open( testCaseFilename.c_str(), ios::binary );
+
+	if (!testCaseFile.is_open()) {
+		return false;
+	}
+
+	unsigned int magic = 0;
+
+	testCaseFile.read((char*)&magic, sizeof(unsigned int));
+	testCaseFile.close();
+
+	return (magic == TESTCASE_BINARY_MAGIC_NUMBER);
+}
+
+
+namespace {
+
+	inline Point pointFromBinary(const float * p) { return Point(p[0], p[1], p[2]); }
+	inline Vector vectorFromBinary(const float * v) { return Vector(v[0], v[1], v[2]); }
+	inline AxisAlignedBox boxFromBinary(const float * b) { return AxisAlignedBox(b[0], b[1], b[2], b[3], b[4], b[5]); }
+
+	/// Helper that validates a compiled test case and resolves its sections while the file is memory mapped.
+	class BinaryTestCaseView {
+	public:
+		BinaryTestCaseView(MemoryMapper & fileMap, const std::string & filename) {
+			_fileSize = fileMap.getFileSize();
+			_base = (const char*)fileMap.getBasePointer();
+			if (_fileSize < sizeof(TestCaseBinaryHeader)) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): " + filename + " is too small to be a compiled test case.");
+			}
+			header = (const TestCaseBinaryHeader*)_base;
+			if (header->magic != TESTCASE_BINARY_MAGIC_NUMBER) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): invalid magic number at beginning of " + filename + ".\nIt may be a big-endian/little-endian incompatibility.");
+			}
+			if ((header->version != TESTCASE_BINARY_VERSION) || (header->headerSize != sizeof(TestCaseBinaryHeader))) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): " + filename + " was compiled with an unsupported version, please recompile it from the XML test case.");
+			}
+			if (header->fileSize != _fileSize) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): " + filename + " is truncated or corrupt.");
+			}
+			cameras = _section<TestCaseBinaryCameraInfo>(header->cameraListOffset, header->numCameraViews);
+			agents = _section<TestCaseBinaryAgentInfo>(header->agentListOffset, header->numAgents);
+			agentEmitters = _section<TestCaseBinaryAgentInfo>(header->agentEmitterListOffset, header->numAgentEmitters);
+			goals = _section<TestCaseBinaryGoalInfo>(header->goalListOffset, header->numGoals);
+			parameters = _section<TestCaseBinaryBehaviourParameter>(header->behaviourParameterListOffset, header->numBehaviourParameters);
+			obstacles = _section<TestCaseBinaryObstacleInfo>(header->obstacleListOffset, header->numObstacles);
+			vertices = _section<TestCaseBinaryVertexData>(header->vertexListOffset, header->numVertices);
+			gridMapWords = _section<unsigned int>(header->gridMapWordListOffset, header->numGridMapWords);
+			_strings = _section<char>(header->stringTableOffset, header->stringTableSize);
+			if ((header->stringTableSize == 0) || (_strings[header->stringTableSize-1] != '\0')) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): " + filename + " has a corrupt string table.");
+			}
+		}
+
+		std::string getString(unsigned int offset) const {
+			if (offset >= header->stringTableSize) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): string offset out of bounds.");
+			}
+			return std::string(_strings + offset);
+		}
+
+		void getAgent(const TestCaseBinaryAgentInfo & agent, AgentInitialConditions & ic) const {
+			ic.name = getString(agent.nameString);
+			ic.position = pointFromBinary(agent.position);
+			ic.direction = vectorFromBinary(agent.direction);
+			ic.radius = agent.radius;
+			ic.speed = agent.speed;
+			ic.color = Color(agent.color[0], agent.color[1], agent.color[2]);
+			ic.colorSet = (agent.colorSet != 0);
+			ic.fromRandom = (agent.fromRandom != 0);
+			ic.randBox = boxFromBinary(agent.randBox);
+
+			if ((agent.firstGoal > header->numGoals) || (agent.numGoals > header->numGoals - agent.firstGoal)) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): goal index out of bounds.");
+			}
+			ic.goals.resize(agent.numGoals);
+			for (unsigned int i=0; i < agent.numGoals; i++) {
+				const TestCaseBinaryGoalInfo & goal = goals[agent.firstGoal + i];
+				AgentGoalInfo & goalInfo = ic.goals[i];
+				goalInfo.goalType = (AgentGoalTypeEnum)goal.goalType;
+				goalInfo.targetIsRandom = (goal.targetIsRandom != 0);
+				goalInfo.timeDuration = goal.timeDuration;
+				goalInfo.desiredSpeed = goal.desiredSpeed;
+				goalInfo.targetLocation = pointFromBinary(goal.targetLocation);
+				goalInfo.targetDirection = vectorFromBinary(goal.targetDirection);
+				goalInfo.targetRegion = boxFromBinary(goal.targetRegion);
+				goalInfo.targetName = getString(goal.targetNameString);
+				goalInfo.flowType = getString(goal.flowTypeString);
+				goalInfo.targetBehaviour.setSteeringAlg(getString(goal.steeringAlgString));
+
+				if ((goal.firstBehaviourParameter > header->numBehaviourParameters) || (goal.numBehaviourParameters > header->numBehaviourParameters - goal.firstBehaviourParameter)) {
+					throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): behaviour parameter index out of bounds.");
+				}
+				for (unsigned int p=0; p < goal.numBehaviourParameters; p++) {
+					const TestCaseBinaryBehaviourParameter & parameter = parameters[goal.firstBehaviourParameter + p];
+					goalInfo.targetBehaviour.addParameter(BehaviourParameter(getString(parameter.keyString), getString(parameter.valueString)));
+				}
+			}
+		}
+
+		ObstacleInitialConditions * getObstacle(const TestCaseBinaryObstacleInfo & obstacle) const {
+			switch (obstacle.obstacleType) {
+				case TESTCASE_BINARY_BOX_OBSTACLE:
+					return new BoxObstacleInitialConditions(obstacle.bounds[0], obstacle.bounds[1], obstacle.bounds[2], obstacle.bounds[3], obstacle.bounds[4], obstacle.bounds[5]);
+				case TESTCASE_BINARY_CIRCLE_OBSTACLE: {
+					CircleObstacleInitialConditions * o = new CircleObstacleInitialConditions();
+					o->position = pointFromBinary(obstacle.position);
+					o->radius = obstacle.radius;
+					o->height = obstacle.height;
+					return o;
+				}
+				case TESTCASE_BINARY_ORIENTED_BOX_OBSTACLE: {
+					OrientedBoxObstacleInitialConditions * o = new OrientedBoxObstacleInitialConditions();
+					o->position = pointFromBinary(obstacle.position);
+					o->lengthX = obstacle.lengthX;
+					o->lengthZ = obstacle.lengthZ;
+					o->height = obstacle.height;
+					o->thetaY = obstacle.thetaY;
+					return o;
+				}
+				case TESTCASE_BINARY_ORIENTED_WALL_OBSTACLE: {
+					OrientedWallObstacleInitialConditions * o = new OrientedWallObstacleInitialConditions();
+					o->position = pointFromBinary(obstacle.position);
+					o->lengthX = obstacle.lengthX;
+					o->lengthZ = obstacle.lengthZ;
+					o->height = obstacle.height;
+					o->thetaY = obstacle.thetaY;
+					o->doorLocation = obstacle.doorLocation;
+					o->doorRadius = obstacle.doorRadius;
+					return o;
+				}
+				case TESTCASE_BINARY_POLYGON_OBSTACLE: {
+					if ((obstacle.firstVertex > header->numVertices) || (obstacle.numVertices > header->numVertices - obstacle.firstVertex)) {
+						throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): polygon vertex index out of bounds.");
+					}
+					PolygonObstacleInitialConditions * o = new PolygonObstacleInitialConditions();
+					o->_vertices.reserve(obstacle.numVertices);
+					for (unsigned int i=0; i < obstacle.numVertices; i++) {
+						const TestCaseBinaryVertexData & v = vertices[obstacle.firstVertex + i];
+						o->_vertices.push_back(Point(v.x, v.y, v.z));
+					}
+					return o;
+				}
+				case TESTCASE_BINARY_GRID_MAP_OBSTACLE: {
+					unsigned int wordsPerRow = (obstacle.numCellsX + 31) / 32;
+					if ((obstacle.numCellsX == 0) || (obstacle.numCellsZ == 0) || (obstacle.firstGridMapWord > header->numGridMapWords) ||
+						((unsigned long long)wordsPerRow * obstacle.numCellsZ > header->numGridMapWords - obstacle.firstGridMapWord)) {
+						throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): grid map cells out of bounds.");
+					}
+					GridMapObstacle map(obstacle.position[0], obstacle.position[2], obstacle.cellSize, obstacle.numCellsX, obstacle.numCellsZ, obstacle.traversalCost);
+					for (unsigned int z=0; z < obstacle.numCellsZ; z++) {
+						const unsigned int * row = gridMapWords + obstacle.firstGridMapWord + z * wordsPerRow;
+						for (unsigned int x=0; x < obstacle.numCellsX; x++) {
+							if (row[x >> 5] & (1u << (x & 31))) {
+								map.setBlocked(x, z, true);
+							}
+						}
+					}
+					return new GridMapObstacleInitialConditions(map);
+				}
+				default:
+					throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): unknown obstacle type " + toString(obstacle.obstacleType) + ".");
+			}
+		}
+
+		const TestCaseBinaryHeader * header;
+		const TestCaseBinaryCameraInfo * cameras;
+		const TestCaseBinaryAgentInfo * agents;
+		const TestCaseBinaryAgentInfo * agentEmitters;
+		const TestCaseBinaryGoalInfo * goals;
+		const TestCaseBinaryBehaviourParameter * parameters;
+		const TestCaseBinaryObstacleInfo * obstacles;
+		const TestCaseBinaryVertexData * vertices;
+		const unsigned int * gridMapWords;
+
+	protected:
+		template <class T>
+		const T * _section(unsigned int offset, unsigned int count) const {
+			if ((offset > _fileSize) || (count > (_fileSize - offset) / sizeof(T))) {
+				throw GenericException("TestCaseReader::readTestCaseFromBinaryFile(): section out of bounds, the compiled test case is corrupt.");
+			}
+			return (const T*)(_base + offset);
+		}
+
+		const char * _base;
+		const char * _strings;
+		unsigned int _fileSize;
+	};
+
+} // end anonymous namespace
+
+
+void TestCaseReader::readTestCaseFromBinaryFile( const std::string & testCaseFilename )
+{
+	MemoryMapper fileMap;
+	fileMap.open(testCaseFilename);
+
+	BinaryTestCaseView testCase(fileMap, testCaseFilename);
+
+	_header.name = testCase.getString(testCase.header->nameString);
+	_header.description = testCase.getString(testCase.header->descriptionString);
+	_header.version = testCase.getString(testCase.header->versionString);
+	_header.passingCriteria = testCase.getString(testCase.header->passingCriteriaString);
+	_header.worldBounds = boxFromBinary(testCase.header->worldBounds);
+
+	for (unsigned int i=0; i < testCase.header->numCameraViews; i++) {
+		const TestCaseBinaryCameraInfo & camera = testCase.cameras[i];
+		_cameraViews.push_back(CameraView(pointFromBinary(camera.position), pointFromBinary(camera.lookat), vectorFromBinary(camera.up), camera.fovy));
+	}
+
+	size_t firstAgent = _initializedAgents.size();
+	_initializedAgents.resize(firstAgent + testCase.header->numAgents);
+	for (unsigned int i=0; i < testCase.header->numAgents; i++) {
+		testCase.getAgent(testCase.agents[i], _initializedAgents[firstAgent + i]);
+	}
+
+	size_t firstAgentEmitter = _initializedAgentEmitters.size();
+	_initializedAgentEmitters.resize(firstAgentEmitter + testCase.header->numAgentEmitters);
+	for (unsigned int i=0; i < testCase.header->numAgentEmitters; i++) {
+		testCase.getAgent(testCase.agentEmitters[i], _initializedAgentEmitters[firstAgentEmitter + i]);
 	}
 
-	// initial conditions are established, so the local instance of the spatial database is no longer needed after this function returns.
-	delete testCaseDB;
+	_initializedObstacles.reserve(_initializedObstacles.size() + testCase.header->numObstacles);
+	for (unsigned int i=0; i < testCase.header->numObstacles; i++) {
+		_initializedObstacles.push_back(testCase.getObstacle(testCase.obstacles[i]));
+	}
+
+	fileMap.close();
 }
 
+
+void TestCaseReader::readTestCaseFromMovingAIMap( const std::string & mapFilename )
+{
+	GridMapObstacle * map = MovingAIReader::readMap(mapFilename);
+
+	size_t nameStart = mapFilename.find_last_of("/\\");
+	_header.name = (nameStart == std::string::npos) ? mapFilename : mapFilename.substr(nameStart + 1);
+	_header.description = "MovingAI map " + _header.name;
+	_header.version = "1.0";
+	_header.passingCriteria = "";
+	_header.worldBounds = map->getBounds();
+	_header.worldBounds.ymax = 0.0f;
+
+	_initializedObstacles.push_back(new GridMapObstacleInitialConditions(*map));
+	delete map;
+}
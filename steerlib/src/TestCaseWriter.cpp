@@ -488,6 +488,24 @@ void TestCaseWriter::writeTestCaseToFile(FILE *fp,
 			}			
 			fprintf(fp,"\t</polygonObstacle>\n") ;			
 		}
+		else if (typeid(*obs) == typeid(GridMapObstacle))
+		{
+			// one box for each rectangle of blocked cells
+			std::vector<Util::AxisAlignedBox> rectangles;
+			static_cast<GridMapObstacle*>(obs)->getBlockedRectangles(rectangles);
+			for (unsigned int k = 0; k < rectangles.size(); k++)
+			{
+				const Util::AxisAlignedBox & box = rectangles[k];
+				fprintf(fp,"\t<obstacle>\n") ;
+				fprintf(fp,"\t\t<xmin>%f</xmin>\n", box.xmin) ;
+				fprintf(fp,"\t\t<xmax>%f</xmax>\n", box.xmax) ;
+				fprintf(fp,"\t\t<ymin>%f</ymin>\n", box.ymin) ;
+				fprintf(fp,"\t\t<ymax>%f</ymax>\n", box.ymax) ;
+				fprintf(fp,"\t\t<zmin>%f</zmin>\n", box.zmin) ;
+				fprintf(fp,"\t\t<zmax>%f</zmax>\n", box.zmax) ;
+				fprintf(fp,"\t</obstacle>\n") ;
+			}
+		}
 		else	//for SteerLib::BoxObstacle and other obstacles
 		{
 			const Util::AxisAlignedBox & box = obs->getBounds() ;
@@ -130,7 +130,10 @@ void ThreadedTaskManager::waitForAllTasksToComplete()
 
 void ThreadedTaskManager::_runWorkerThread() throw()
 {
+	// the constructor holds the lock until every thread has been added to _threads.
+	_lock();
 	unsigned int threadIndex = _getIndexOfCurrentWorkerThread();
+	_unlock();
 	while(true) {
 
 		// acquire the lock
@@ -0,0 +1,315 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file TopDownRenderer.cpp
+/// @brief Implements SteerLib::TopDownRenderer.
+
+#include <exception>
+#include <stdio.h>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "simulation/TopDownRenderer.h"
+#include "util/GenericException.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+#define DEFAULT_TOP_DOWN_IMAGE_WIDTH 640
+#define DEFAULT_TOP_DOWN_IMAGE_HEIGHT 640
+#define DEFAULT_TOP_DOWN_NUM_THREADS 4
+#define DEFAULT_TOP_DOWN_MAX_QUEUED_FRAMES 16
+#define DEFAULT_TOP_DOWN_TRAIL_LENGTH 0
+#define DEFAULT_TOP_DOWN_DRAW_HEADINGS true
+#define DEFAULT_TOP_DOWN_COMPRESSION_LEVEL 6
+
+// the margin around the automatic world bounds, in world units.
+#define TOP_DOWN_WORLD_BOUNDS_MARGIN 1.0f
+
+static const Color gTopDownBackgroundColor(0.9f, 0.9f, 0.87f);
+static const Color gTopDownObstacleColor(0.4f, 0.4f, 0.4f);
+static const Color gTopDownTrailColor(0.6f, 0.72f, 0.92f);
+static const Color gTopDownAgentColor(0.15f, 0.35f, 0.75f);
+static const Color gTopDownHeadingColor(1.0f, 1.0f, 1.0f);
+
+
+//
+// _sleepWhileWaiting() - gives up the processor for about a millisecond while the worker threads catch up.
+//
+static void _sleepWhileWaiting()
+{
+#ifdef _WIN32
+	Sleep(1);
+#else
+	struct timespec t;
+	t.tv_sec = 0;
+	t.tv_nsec = 1000000;
+	nanosleep(&t, NULL);
+#endif
+}
+
+
+TopDownRendererOptions::TopDownRendererOptions()
+{
+	imageWidth = DEFAULT_TOP_DOWN_IMAGE_WIDTH;
+	imageHeight = DEFAULT_TOP_DOWN_IMAGE_HEIGHT;
+	numThreads = DEFAULT_TOP_DOWN_NUM_THREADS;
+	maxQueuedFrames = DEFAULT_TOP_DOWN_MAX_QUEUED_FRAMES;
+	trailLength = DEFAULT_TOP_DOWN_TRAIL_LENGTH;
+	drawHeadings = DEFAULT_TOP_DOWN_DRAW_HEADINGS;
+	compressionLevel = DEFAULT_TOP_DOWN_COMPRESSION_LEVEL;
+}
+
+
+TopDownRenderer::TopDownRenderer(const TopDownRendererOptions & options)
+{
+	if (options.numThreads == 0) {
+		throw GenericException("TopDownRenderer: numThreads must be at least 1.");
+	}
+	if (options.maxQueuedFrames == 0) {
+		throw GenericException("TopDownRenderer: maxQueuedFrames must be at least 1.");
+	}
+
+	_options = options;
+	for (unsigned int i = 0; i < _options.numThreads; i++) {
+		_images.push_back(new RasterImage(_options.imageWidth, _options.imageHeight));
+	}
+	_taskManager = new ThreadedTaskManager(_options.numThreads);
+	_worldBoundsAreSet = false;
+	_numFramesAdded = 0;
+}
+
+
+TopDownRenderer::~TopDownRenderer()
+{
+	_taskManager->waitForAllTasksToComplete();
+	delete _taskManager;
+
+	for (unsigned int i = 0; i < _images.size(); i++) {
+		delete _images[i];
+	}
+	for (unsigned int i = 0; i < _allFrames.size(); i++) {
+		delete _allFrames[i];
+	}
+}
+
+
+void TopDownRenderer::setObstacles(const std::vector<Util::AxisAlignedBox> & obstacles)
+{
+	_obstacles = obstacles;
+}
+
+
+void TopDownRenderer::setWorldBounds(const Util::AxisAlignedBox & bounds)
+{
+	_worldBounds = bounds;
+	_worldBoundsAreSet = true;
+	for (unsigned int i = 0; i < _images.size(); i++) {
+		_images[i]->setWorldBounds(bounds.xmin, bounds.xmax, bounds.zmin, bounds.zmax);
+	}
+}
+
+
+void TopDownRenderer::addFrame(const std::vector<RecFileAgentState> & agents, const std::string & filename)
+{
+	_throwWorkerError();
+
+	if (!_worldBoundsAreSet) {
+		AxisAlignedBox bounds;
+		for (unsigned int i = 0; i < _obstacles.size(); i++) {
+			bounds.xmin = std::min(bounds.xmin, _obstacles[i].xmin);
+			bounds.xmax = std::max(bounds.xmax, _obstacles[i].xmax);
+			bounds.zmin = std::min(bounds.zmin, _obstacles[i].zmin);
+			bounds.zmax = std::max(bounds.zmax, _obstacles[i].zmax);
+		}
+		for (unsigned int i = 0; i < agents.size(); i++) {
+			if (agents[i].enabled) {
+				bounds.xmin = std::min(bounds.xmin, agents[i].position.x - agents[i].radius);
+				bounds.xmax = std::max(bounds.xmax, agents[i].position.x + agents[i].radius);
+				bounds.zmin = std::min(bounds.zmin, agents[i].position.z - agents[i].radius);
+				bounds.zmax = std::max(bounds.zmax, agents[i].position.z + agents[i].radius);
+			}
+		}
+		if (bounds.xmin > bounds.xmax) {
+			bounds = AxisAlignedBox(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+		}
+		bounds.xmin -= TOP_DOWN_WORLD_BOUNDS_MARGIN;
+		bounds.xmax += TOP_DOWN_WORLD_BOUNDS_MARGIN;
+		bounds.zmin -= TOP_DOWN_WORLD_BOUNDS_MARGIN;
+		bounds.zmax += TOP_DOWN_WORLD_BOUNDS_MARGIN;
+		setWorldBounds(bounds);
+	}
+
+	Frame * frame = _acquireFreeFrame();
+	frame->filename = filename;
+	frame->agents = agents;
+	frame->trailPoints.clear();
+	frame->trailStarts.clear();
+
+	if (_options.trailLength > 0) {
+		_trails.resize(std::max(_trails.size(), agents.size()));
+		for (unsigned int i = 0; i < agents.size(); i++) {
+			frame->trailStarts.push_back((unsigned int)frame->trailPoints.size());
+			if (agents[i].enabled) {
+				_trails[i].push_back(agents[i].position);
+				if (_trails[i].size() > _options.trailLength + 1) {
+					_trails[i].pop_front();
+				}
+				frame->trailPoints.insert(frame->trailPoints.end(), _trails[i].begin(), _trails[i].end());
+			}
+			else {
+				_trails[i].clear();
+			}
+		}
+		frame->trailStarts.push_back((unsigned int)frame->trailPoints.size());
+	}
+
+	_numFramesAdded++;
+
+	Task task;
+	task.function = &TopDownRenderer::_renderFrameTask;
+	task.data = frame;
+	_taskManager->addTask(task, true);
+}
+
+
+void TopDownRenderer::finish()
+{
+	_taskManager->waitForAllTasksToComplete();
+	_throwWorkerError();
+}
+
+
+unsigned int TopDownRenderer::renderRecFile(RecFileReader & recFile, const std::string & filePrefix, unsigned int frameStep)
+{
+	if (frameStep == 0) {
+		frameStep = 1;
+	}
+
+	std::vector<AxisAlignedBox> obstacles(recFile.getNumObstacles());
+	for (unsigned int i = 0; i < obstacles.size(); i++) {
+		obstacles[i] = recFile.getObstacleBoundsAtFrame(i, 0);
+	}
+	setObstacles(obstacles);
+
+	// reading ahead keeps the disk busy while the calling thread waits for the workers.
+	recFile.setReadAhead(frameStep * _options.maxQueuedFrames);
+
+	std::vector<RecFileAgentState> agents;
+	unsigned int numFramesWritten = 0;
+	for (unsigned int frameNumber = 0; frameNumber < recFile.getNumFrames(); frameNumber += frameStep) {
+		recFile.getAgentStatesAtFrame(frameNumber, agents);
+		char number[16];
+		sprintf(number, "%05u", numFramesWritten);
+		addFrame(agents, filePrefix + number + ".png");
+		numFramesWritten++;
+	}
+
+	finish();
+	return numFramesWritten;
+}
+
+
+TopDownRenderer::Frame * TopDownRenderer::_acquireFreeFrame()
+{
+	Frame * frame = NULL;
+	while (frame == NULL) {
+		_lock.lock();
+		if (!_freeFrames.empty()) {
+			frame = _freeFrames.back();
+			_freeFrames.pop_back();
+		}
+		else if (_allFrames.size() < _options.maxQueuedFrames) {
+			frame = new Frame();
+			frame->owner = this;
+			_allFrames.push_back(frame);
+		}
+		_lock.unlock();
+
+		if (frame == NULL) {
+			_sleepWhileWaiting();
+		}
+	}
+	return frame;
+}
+
+
+void TopDownRenderer::_throwWorkerError()
+{
+	_lock.lock();
+	std::string errorMessage = _errorMessage;
+	_errorMessage = "";
+	_lock.unlock();
+
+	if (errorMessage != "") {
+		throw GenericException("TopDownRenderer: " + errorMessage);
+	}
+}
+
+
+//
+// _renderFrameTask() - the task given to the Util::ThreadedTaskManager for each frame.
+//
+void TopDownRenderer::_renderFrameTask(unsigned int threadIndex, void * data)
+{
+	Frame * frame = (Frame*)data;
+	TopDownRenderer * renderer = frame->owner;
+	std::string errorMessage;
+
+	try {
+		renderer->_renderFrame(frame, *renderer->_images[threadIndex]);
+	}
+	catch (std::exception & e) {
+		errorMessage = e.what();
+	}
+
+	renderer->_lock.lock();
+	if ((errorMessage != "") && (renderer->_errorMessage == "")) {
+		renderer->_errorMessage = errorMessage;
+	}
+	renderer->_freeFrames.push_back(frame);
+	renderer->_lock.unlock();
+}
+
+
+void TopDownRenderer::_renderFrame(Frame * frame, RasterImage & image)
+{
+	image.clear(gTopDownBackgroundColor);
+
+	for (unsigned int i = 0; i < _obstacles.size(); i++) {
+		image.fillBox(_obstacles[i].xmin, _obstacles[i].xmax, _obstacles[i].zmin, _obstacles[i].zmax, gTopDownObstacleColor);
+	}
+
+	if (!frame->trailStarts.empty()) {
+		for (unsigned int i = 0; i + 1 < frame->trailStarts.size(); i++) {
+			for (unsigned int j = frame->trailStarts[i] + 1; j < frame->trailStarts[i+1]; j++) {
+				image.drawLine(frame->trailPoints[j-1], frame->trailPoints[j], 1.5f, gTopDownTrailColor);
+			}
+		}
+	}
+
+	const std::vector<RecFileAgentState> & agents = frame->agents;
+	for (unsigned int i = 0; i < agents.size(); i++) {
+		if (agents[i].enabled) {
+			image.fillDisc(agents[i].position, agents[i].radius, gTopDownAgentColor);
+		}
+	}
+
+	if (_options.drawHeadings) {
+		for (unsigned int i = 0; i < agents.size(); i++) {
+			if (agents[i].enabled) {
+				float width = std::max(1.0f, 0.3f * agents[i].radius * image.getPixelsPerUnit());
+				image.drawLine(agents[i].position, agents[i].position + agents[i].radius * agents[i].direction, width, gTopDownHeadingColor);
+			}
+		}
+	}
+
+	image.writePNG(frame->filename, _options.compressionLevel);
+}
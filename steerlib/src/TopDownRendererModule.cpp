@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file TopDownRendererModule.cpp
+/// @brief Implements the TopDownRendererModule built-in module.
+
+#include <iostream>
+#include <sstream>
+#include "modules/TopDownRendererModule.h"
+#include "util/GenericException.h"
+#include "util/Misc.h"
+
+using namespace SteerLib;
+
+void TopDownRendererModule::init( const SteerLib::OptionDictionary & options, SteerLib::EngineInterface * engineInfo ) {
+	_engine = engineInfo;
+	_renderer = NULL;
+	_filePrefix = "topdown";
+	_frameStep = 1;
+
+	// parse the options
+	SteerLib::OptionDictionary::const_iterator optionIter;
+	for (optionIter = options.begin(); optionIter != options.end(); ++optionIter) {
+		if ((*optionIter).first == "prefix") {
+			_filePrefix = (*optionIter).second;
+		}
+		else if ((*optionIter).first == "width") {
+			std::istringstream((*optionIter).second) >> _options.imageWidth;
+		}
+		else if ((*optionIter).first == "height") {
+			std::istringstream((*optionIter).second) >> _options.imageHeight;
+		}
+		else if ((*optionIter).first == "frameStep") {
+			std::istringstream((*optionIter).second) >> _frameStep;
+		}
+		else if ((*optionIter).first == "threads") {
+			std::istringstream((*optionIter).second) >> _options.numThreads;
+		}
+		else if ((*optionIter).first == "trail") {
+			std::istringstream((*optionIter).second) >> _options.trailLength;
+		}
+		else if ((*optionIter).first == "headings") {
+			_options.drawHeadings = Util::getBoolFromString((*optionIter).second);
+		}
+		else {
+			throw Util::GenericException("unrecognized option \"" + Util::toString((*optionIter).first) + "\" given to topDownRenderer module.");
+		}
+	}
+
+	if (_frameStep == 0) {
+		throw Util::GenericException("The frameStep option of the topDownRenderer module must be at least 1.");
+	}
+}
+
+void TopDownRendererModule::finish() {
+	delete _renderer;
+	_renderer = NULL;
+}
+
+void TopDownRendererModule::preprocessSimulation() {
+	_renderer = new TopDownRenderer(_options);
+
+	std::vector<Util::AxisAlignedBox> obstacles;
+	std::set<SteerLib::ObstacleInterface*>::const_iterator obstacleIter;
+	for (obstacleIter = _engine->getObstacles().begin(); obstacleIter != _engine->getObstacles().end(); ++obstacleIter) {
+		obstacles.push_back((*obstacleIter)->getBounds());
+	}
+	_renderer->setObstacles(obstacles);
+
+	// frame 0 shows the initial conditions, like the zero-th frame of a rec file.
+	_addFrame();
+}
+
+void TopDownRendererModule::postprocessFrame(float timeStamp, float dt, unsigned int frameNumber) {
+	if (frameNumber % _frameStep == 0) {
+		_addFrame();
+	}
+}
+
+void TopDownRendererModule::postprocessSimulation() {
+	_renderer->finish();
+	std::cout << "topDownRenderer: wrote " << _renderer->getNumFramesAdded() << " images named " << _filePrefix << "NNNNN.png" << std::endl;
+	delete _renderer;
+	_renderer = NULL;
+}
+
+void TopDownRendererModule::_addFrame() {
+	const std::vector<SteerLib::AgentInterface*> & agents = _engine->getAgents();
+	_agentStates.resize(agents.size());
+	for (unsigned int i = 0; i < agents.size(); i++) {
+		RecFileAgentState & state = _agentStates[i];
+		state.enabled = agents[i]->enabled();
+		if (state.enabled) {
+			state.position = agents[i]->position();
+			state.direction = agents[i]->forward();
+			state.goal = state.position;
+			state.radius = agents[i]->radius();
+		}
+	}
+
+	std::ostringstream filename;
+	filename << _filePrefix;
+	filename.width(5);
+	filename.fill('0');
+	filename << _renderer->getNumFramesAdded() << ".png";
+	_renderer->addFrame(_agentStates, filename.str());
+}
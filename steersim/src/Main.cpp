@@ -10,6 +10,8 @@
 #include <exception>
 #include "SteerLib.h"
 #include "core/CommandLineEngineDriver.h"
+#include "core/EnsembleEngineDriver.h"
+#include "core/ServerEngineDriver.h"
 #include "core/GLFWEngineDriver.h"
 #include "core/QtEngineDriver.h"
 #include "SimulationPlugin.h"
@@ -70,6 +72,20 @@ int main(int argc, char **argv)
 			cmd->run();
 			cmd->finish();
 		}
+		else if (simulationOptions.globalOptions.engineDriver == "ensemble") {
+			EnsembleEngineDriver * driver = new EnsembleEngineDriver();
+			driver->init(&simulationOptions);
+			driver->run();
+			driver->finish();
+			delete driver;
+		}
+		else if (simulationOptions.globalOptions.engineDriver == "server") {
+			ServerEngineDriver * driver = new ServerEngineDriver();
+			driver->init(&simulationOptions);
+			driver->run();
+			driver->finish();
+			delete driver;
+		}
 		else if (simulationOptions.globalOptions.engineDriver == "glfw") {
 #ifdef ENABLE_GUI
 #ifdef ENABLE_GLFW
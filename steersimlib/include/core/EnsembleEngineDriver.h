@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __ENSEMBLE_ENGINE_DRIVER_H__
+#define __ENSEMBLE_ENGINE_DRIVER_H__
+
+/// @file EnsembleEngineDriver.h
+/// @brief Declares the EnsembleEngineDriver class
+
+#include <iostream>
+#include "SteerLib.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+
+/**
+ * @brief An engine driver that simulates many independent runs of a scenario in one process.
+ *
+ * Each worker thread owns one SimulationEngine that is initialized once, so modules are loaded and initialized
+ * once per thread instead of once per run.  For every run, the testCasePlayer module is given the run's test case
+ * and random seed (see SteerLib::TestCasePlayerModule::setTestCase()), and the engine goes through
+ * initializeSimulation(), preprocessSimulation(), update() until the simulation is done, postprocessSimulation()
+ * and cleanupSimulation().  Runs are scheduled on a Util::ThreadedTaskManager.
+ *
+ * The runs are either listed in a text file (one run per line: a test case name, optionally followed by a random seed;
+ * lines starting with '#' are ignored), or the testCasePlayer's test case is run numRuns times with consecutive seeds.
+ *
+ * When a run completes, the LogData that each module added during that run is converted to text.  After all runs
+ * complete, the results are written to a single stream in run order, so the output does not depend on the number
+ * of threads.  A run that throws an exception is reported as failed, and the worker gets a fresh engine.
+ *
+ * Engines on different threads simulate at the same time.  The spatial databases (including the generator used
+ * for random positions) and the agents of the simpleAI, sfAI, rvo2AI and pprAI plugins keep their state per engine,
+ * so these can run with several threads; those plugins still parse their options into globals in init(), which is
+ * safe here only because every engine of the ensemble is given the same options.
+ */
+class STEERLIB_API EnsembleEngineDriver : public SteerLib::EngineControllerInterface
+{
+public:
+	/// Describes one run of the ensemble.
+	struct Run {
+		std::string testCase;
+		unsigned int seed;
+	};
+
+	EnsembleEngineDriver();
+	~EnsembleEngineDriver() {}
+	void init(SteerLib::SimulationOptions * options);
+	void finish();
+	/// Simulates all runs, and writes the results to the output file given in the options, or to std::cout.
+	void run();
+	/// Simulates all runs, and writes the results to the given stream.
+	void run(std::ostream & out);
+	/// Returns the list of runs simulated by run().
+	const std::vector<Run> & getRuns() const { return _runs; }
+
+	/// @name The EngineControllerInterface
+	/// @brief The EnsembleEngineDriver does not support any of the engine controls.
+	//@{
+	virtual bool isStartupControlSupported() { return false; }
+	virtual bool isPausingControlSupported() { return false; }
+	virtual bool isPaused() { return false; }
+	virtual void loadSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support loadSimulation()."); }
+	virtual void unloadSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support unloadSimulation()."); }
+	virtual void startSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support startSimulation()."); }
+	virtual void stopSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support stopSimulation()."); }
+	virtual void pauseSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support pauseSimulation()."); }
+	virtual void unpauseSimulation() { throw Util::GenericException("EnsembleEngineDriver does not support unpauseSimulation()."); }
+	virtual void togglePausedState() { throw Util::GenericException("EnsembleEngineDriver does not support togglePausedState()."); }
+	virtual void pauseAndStepOneFrame() { throw Util::GenericException("EnsembleEngineDriver does not support pauseAndStepOneFrame()."); }
+	//@}
+
+protected:
+	/// One log record that a module produced during a run.
+	struct ModuleLogRecord {
+		std::string moduleName;
+		std::string fieldNames;
+		std::string values;
+	};
+
+	/// The outcome of one run.
+	struct RunResult {
+		bool succeeded;
+		std::string errorMessage;
+		unsigned int numFramesSimulated;
+		std::vector<ModuleLogRecord> logRecords;
+	};
+
+	/// The engine owned by one worker thread.
+	struct Worker {
+		SteerLib::SimulationEngine * engine;
+		/// Modules keep their LogData across runs, so this remembers how many log records of each module were already collected.
+		std::map<std::string, size_t> numLogRecordsCollected;
+	};
+
+	/// The data given to each task of the Util::ThreadedTaskManager.
+	struct RunTask {
+		EnsembleEngineDriver * driver;
+		unsigned int runIndex;
+	};
+
+	static void _runTask(unsigned int threadIndex, void * data);
+	void _simulateRun(unsigned int workerIndex, unsigned int runIndex);
+	void _collectLogRecords(Worker & worker, RunResult & result);
+	void _createWorkerEngine(Worker & worker);
+	void _destroyWorkerEngine(Worker & worker);
+	void _readRunList(const std::string & filename);
+	void _writeResults(std::ostream & out);
+
+	bool _alreadyInitialized;
+	SteerLib::SimulationOptions * _options;
+	std::vector<Run> _runs;
+	std::vector<RunResult> _results;
+	std::vector<Worker> _workers;
+
+private:
+	// These functions are kept here to protect us from mangling the instance.
+	EnsembleEngineDriver(const EnsembleEngineDriver & );  // not implemented, not copyable
+	EnsembleEngineDriver& operator= (const EnsembleEngineDriver & );  // not implemented, not assignable
+};
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __FRAME_CAPTURE_H__
+#define __FRAME_CAPTURE_H__
+
+/// @file FrameCapture.h
+/// @brief Declares FrameCapture, which records the openGL frame buffer to files without stalling the renderer.
+
+#ifdef ENABLE_GUI
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include "util/DrawLib.h"
+#include "util/Mutex.h"
+#include "util/ThreadedTaskManager.h"
+
+/// The file formats that FrameCapture can write.
+enum FrameCaptureFormat {
+	/// One PNG file per frame, see Util::writePNG().
+	FRAME_CAPTURE_PNG,
+	/// One uncompressed PPM file per frame.
+	FRAME_CAPTURE_PPM,
+	/// All frames appended to a single file of raw RGB bytes, top row first, that video encoders can read directly.
+	FRAME_CAPTURE_RAW_VIDEO
+};
+
+/**
+ * @brief Reads back every frame that is drawn, and encodes and writes the frames on a pool of worker threads.
+ *
+ * Call captureFrame() after the scene is drawn and before the buffers are swapped.  When the openGL context supports
+ * pixel buffer objects (openGL 2.1), the read-back is double-buffered: glReadPixels() only starts copying the
+ * frame into one buffer object, and the pixels of the previous frame are taken from the other one, which the driver
+ * has finished copying by then.  The pixels are then handed to the worker threads, which flip, encode and write
+ * them.  Without pixel buffer objects, the read-back is synchronous but the encoding is still done by the workers.
+ *
+ * At most maxQueuedFrames frames are waiting to be written at any time; when the workers fall behind,
+ * captureFrame() waits for one of them instead of dropping the frame or using more memory.  Frames are numbered
+ * in the order they were captured: PNG and PPM files are named <filePrefix>NNNNN.png (or .ppm), and the raw video
+ * stream is <filePrefix>.rgb, written in order.
+ *
+ * finish() must be called, with the same openGL context current, before the context is destroyed.
+ */
+class STEERLIB_API FrameCapture {
+public:
+	FrameCapture(const std::string & filePrefix, FrameCaptureFormat format, unsigned int numWorkerThreads, unsigned int maxQueuedFrames);
+	/// Waits for the queued frames to be written; does not touch openGL, so finish() should be called first.
+	~FrameCapture();
+
+	/// Reads back the current read buffer (the back buffer, unless changed); all frames of a raw video must have the same size.
+	void captureFrame(unsigned int width, unsigned int height);
+	/// Reads back the last pending frame, waits for all frames to be written, and releases the openGL buffers; throws the first error of the workers, if any.
+	void finish();
+
+	/// Returns the number of frames given to captureFrame() so far.
+	unsigned int getNumFramesCaptured() const { return _numFramesCaptured; }
+	/// Returns the number of times captureFrame() had to wait because maxQueuedFrames frames were queued.
+	unsigned int getNumStalls() const { return _numStalls; }
+	/// Returns the name of the raw video file, or the name that the next PNG or PPM file would have.
+	std::string getFileName(unsigned int frameNumber) const;
+
+protected:
+	struct Frame {
+		FrameCapture * owner;
+		unsigned int frameNumber;
+		unsigned int width, height;
+		std::vector<unsigned char> pixels;
+	};
+
+	static void _encodeFrameTask(unsigned int threadIndex, void * data);
+	void _encodeFrame(Frame * frame);
+	/// Takes a frame from the pool, waiting for a worker to release one if the queue is full.
+	Frame * _acquireFreeFrame(unsigned int width, unsigned int height);
+	void _queueFrame(Frame * frame);
+	/// Copies the pixels of the pending buffer object, if any, into a frame and queues it.
+	void _queuePendingReadback();
+	void _waitForQueuedFrames();
+	void _throwWorkerError();
+
+	std::string _filePrefix;
+	FrameCaptureFormat _format;
+	unsigned int _maxQueuedFrames;
+	Util::ThreadedTaskManager * _taskManager;
+
+	/// Protects the frame pool, the raw video file, and the error message.
+	Util::Mutex _lock;
+	std::vector<Frame*> _allFrames;
+	std::vector<Frame*> _freeFrames;
+	FILE * _rawVideoFile;
+	unsigned int _nextFrameToWrite;
+	std::string _errorMessage;
+
+	unsigned int _numFramesCaptured;
+	unsigned int _numStalls;
+	unsigned int _rawVideoWidth, _rawVideoHeight;
+
+	/// Double-buffered read-back, see the class description.
+	bool _pixelBuffersInitialized;
+	bool _usePixelBuffers;
+	GLuint _pixelBuffers[2];
+	unsigned int _currentPixelBuffer;
+	bool _hasPendingReadback;
+	unsigned int _pendingFrameNumber, _pendingWidth, _pendingHeight;
+
+private:
+	FrameCapture(const FrameCapture & );  // not implemented, not copyable
+	FrameCapture& operator= (const FrameCapture & );  // not implemented, not assignable
+};
+
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif // ifdef ENABLE_GUI
+
+#endif
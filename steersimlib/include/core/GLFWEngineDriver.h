@@ -21,6 +21,8 @@
 #include "SteerLib.h"
 #include "glfw/include/GL/glfw.h"
 #include "util/FrameSaver.h"
+#include "core/FrameCapture.h"
+#include "core/SimulationThread.h"
 
 /**
  * @brief A GUI back-end that controls a SteerLib::SimulationEngine.
@@ -31,6 +33,10 @@
  * GLFW is pure C, so it can only invoke callbacks trhough static non-member wrappers.
  * Because of this, this class uses a singleton design pattern.
  *
+ * If the GUI option useSimulationThread is set, the simulation runs on a SimulationThread, and this driver's loop
+ * only handles events and draws the latest SteerLib::RenderSnapshot, so the frame rate of the window never limits
+ * the simulation.  In that mode, module annotations are not drawn.
+ *
  * @see
  *   - CommandLineEngineDriver to control a SimulationEngine without a GUI.
  */
@@ -65,10 +71,10 @@ public:
 	virtual void unloadSimulation() { throw Util::GenericException("GLFWEngineDriver does not support unloadSimulation()."); }
 	virtual void startSimulation() { throw Util::GenericException("GLFWEngineDriver does not support startSimulation()."); }
 	virtual void stopSimulation() { throw Util::GenericException("GLFWEngineDriver does not support stopSimulation()."); }
-	virtual void pauseSimulation() { _paused = true; }
-	virtual void unpauseSimulation() { _paused = false; }
-	virtual void togglePausedState() { _paused = !_paused; }
-	virtual void pauseAndStepOneFrame() { _paused = true;  _engine->update(false); }
+	virtual void pauseSimulation() { _setPaused(true); }
+	virtual void unpauseSimulation() { _setPaused(false); }
+	virtual void togglePausedState() { _setPaused(!_paused); }
+	virtual void pauseAndStepOneFrame();
 	//@}
 
 protected:
@@ -79,9 +85,18 @@ protected:
 	void _initGLFW();
 	void _checkGLCapabilities();
 	void _initGL();
+	void _runWithSimulationThread();
+	void _setPaused(bool paused);
+	/// Returns the point on the y=0 plane under the mouse cursor.
+	Util::Point _getMouseLocationOnGroundPlane();
 	void _findClosestAgentToMouse();
-	void _drawScene();
+	void _findClosestAgentToMouse(const SteerLib::RenderSnapshot & snapshot);
+	/// Draws the live simulation if snapshot is NULL, or else the given snapshot.
+	void _drawScene(const SteerLib::RenderSnapshot * snapshot = NULL);
+	void _drawSimulation(const SteerLib::RenderSnapshot * snapshot);
 	void _drawGUI();
+	/// Stops dumping frames, and waits until the dumped frames are written.
+	void _stopDumpingFrames();
 
 	bool _alreadyInitialized;
 	bool _paused;
@@ -102,10 +117,15 @@ protected:
 	unsigned int _nextScreenshotNumber;
 	bool _dumpFrames;
 	bool _done;
+	bool _useSimulationThread;
+	/// The thread that runs the simulation, or NULL if it runs on the GUI thread.
+	SimulationThread * _simulationThread;
 
 	SteerLib::SimulationOptions * _options;
 
 	Util::FrameSaver * _frameSaver;
+	/// Records the frames drawn while _dumpFrames is true.
+	FrameCapture * _frameCapture;
 
 
 private:
@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __SERVER_ENGINE_DRIVER_H__
+#define __SERVER_ENGINE_DRIVER_H__
+
+/// @file ServerEngineDriver.h
+/// @brief Declares the ServerEngineDriver class, and the layout of the shared memory it writes agent states into.
+
+#include <stdint.h>
+#include <string>
+#include "SteerLib.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+
+/// @name Shared memory layout of the ServerEngineDriver
+/// @brief The shared memory object starts with a ServerStateHeader, followed by numSlots slots of slotSize bytes each.
+///
+/// Each slot is a ServerStateSlotHeader followed by numAgents ServerAgentState records, in the order of
+/// SimulationEngine::getAgents(), so the index of a record is the agent id used by the socket commands.
+/// Every published frame gets the next sequence number, starting at 1, and goes into slot (sequence % numSlots);
+/// the last numSlots frames can be read until they are overwritten.  A slot's sequence is 0 while it is written,
+/// so a reader that does not wait for the reply of a command can check that the sequence is the same before and
+/// after copying a slot.  All fields are in the byte order of the host.
+//@{
+#define SERVER_STATE_MAGIC 0x53545353u  // "SSTS"
+#define SERVER_STATE_VERSION 1u
+
+struct ServerStateHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numSlots;
+	uint32_t maxAgents;
+	uint32_t slotSize;
+	uint32_t reserved;
+	/// The sequence number of the most recently published frame, or 0 if no frame was published yet.
+	volatile uint64_t latestSequence;
+};
+
+struct ServerStateSlotHeader {
+	volatile uint64_t sequence;
+	uint32_t frameNumber;
+	uint32_t numAgents;
+	float simulationTime;
+	uint32_t reserved;
+};
+
+#define SERVER_AGENT_STATE_ENABLED 1u
+
+struct ServerAgentState {
+	float positionX, positionZ;
+	float velocityX, velocityZ;
+	float forwardX, forwardZ;
+	float radius;
+	uint32_t flags;
+};
+//@}
+
+
+/**
+ * @brief An engine driver that keeps one simulation loaded and steps it on request of an external controller.
+ *
+ * Running steersim once per episode pays for process startup, option parsing and module loading every time, and
+ * the results come back as text.  This driver loads the modules and the test case once, then waits for commands
+ * on a Unix domain socket, one command per line, answering each with one line that starts with "ok" or "error":
+ *
+ *   - step [n]                       simulates n frames (default 1), publishing each one: "ok <sequence> <frame> running|done"
+ *   - state                          publishes the current frame again without simulating: "ok <sequence> <frame> running|done"
+ *   - reset                          restores the simulation as it was after loading, removing added agents: "ok <sequence> <numAgents>"
+ *   - reset <testcase> [seed]        loads another test case with the testCasePlayer: "ok <sequence> <numAgents>"
+ *   - setGoal <id> <x> <z> [speed]   replaces the goals of an agent by a static target, re-enabling it if it arrived: "ok"
+ *   - addAgent <x> <z> <goalX> <goalZ> [radius] [speed]   creates an agent with the testCasePlayer's AI: "ok <id>"
+ *   - info                           "ok <sharedMemoryName> <numSlots> <maxAgents> <numAgents> <frame>"
+ *   - close                          closes the connection; the server waits for the next controller.
+ *   - shutdown                       closes the connection and makes run() return.
+ *
+ * Agent positions and velocities are not sent over the socket; they are written into a POSIX shared memory ring
+ * buffer (see ServerStateHeader), and the sequence number in a reply tells the controller which slot to read.
+ *
+ * The simulation ends as usual when all agents are disabled or numFrames frames were simulated; after that, step
+ * answers "done" without simulating until the next reset.  One controller is served at a time.  This driver is
+ * only available on POSIX systems.
+ */
+class STEERLIB_API ServerEngineDriver : public SteerLib::EngineControllerInterface
+{
+public:
+	ServerEngineDriver();
+	~ServerEngineDriver();
+	void init(SteerLib::SimulationOptions * options);
+	void finish();
+	/// Serves controllers until one of them sends "shutdown".
+	void run();
+	/// Executes one command line and returns the reply, without the newline; also used by run() for every line it receives.
+	std::string executeCommand(const std::string & commandLine);
+	/// Returns true after a "shutdown" command.
+	bool isShutdownRequested() const { return _shutdownRequested; }
+	SteerLib::SimulationEngine * getEngine() { return _engine; }
+
+	/// @name The EngineControllerInterface
+	/// @brief The ServerEngineDriver does not support any of the engine controls; the controller drives the simulation instead.
+	//@{
+	virtual bool isStartupControlSupported() { return false; }
+	virtual bool isPausingControlSupported() { return false; }
+	virtual bool isPaused() { return false; }
+	virtual void loadSimulation() { throw Util::GenericException("ServerEngineDriver does not support loadSimulation()."); }
+	virtual void unloadSimulation() { throw Util::GenericException("ServerEngineDriver does not support unloadSimulation()."); }
+	virtual void startSimulation() { throw Util::GenericException("ServerEngineDriver does not support startSimulation()."); }
+	virtual void stopSimulation() { throw Util::GenericException("ServerEngineDriver does not support stopSimulation()."); }
+	virtual void pauseSimulation() { throw Util::GenericException("ServerEngineDriver does not support pauseSimulation()."); }
+	virtual void unpauseSimulation() { throw Util::GenericException("ServerEngineDriver does not support unpauseSimulation()."); }
+	virtual void togglePausedState() { throw Util::GenericException("ServerEngineDriver does not support togglePausedState()."); }
+	virtual void pauseAndStepOneFrame() { throw Util::GenericException("ServerEngineDriver does not support pauseAndStepOneFrame()."); }
+	//@}
+
+protected:
+	void _loadSimulation();
+	void _unloadSimulation();
+	void _resetSimulation();
+	void _publishState();
+	std::string _getFrameReply();
+	SteerLib::AgentInterface * _getAgent(unsigned int id);
+	SteerLib::ModuleInterface * _getAIModule();
+
+	void _createSharedMemory();
+	void _destroySharedMemory();
+	void _createSocket();
+	void _destroySocket();
+	/// Reads commands from one controller until it closes the connection, or sends "close" or "shutdown".
+	void _serveConnection(int connection);
+
+	bool _alreadyInitialized;
+	SteerLib::SimulationOptions * _options;
+	SteerLib::SimulationEngine * _engine;
+	/// The simulation right after loading, which "reset" restores without reading the test case again.
+	SteerLib::SimulationSnapshot _initialSnapshot;
+	bool _simulationLoaded;
+	bool _simulationRunning;
+	bool _shutdownRequested;
+	bool _closeRequested;
+
+	int _listenSocket;
+	int _sharedMemoryFile;
+	size_t _sharedMemorySize;
+	unsigned char * _sharedMemory;
+	uint64_t _sequence;
+
+private:
+	// These functions are kept here to protect us from mangling the instance.
+	ServerEngineDriver(const ServerEngineDriver & );  // not implemented, not copyable
+	ServerEngineDriver& operator= (const ServerEngineDriver & );  // not implemented, not assignable
+};
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+#ifndef __SIMULATION_THREAD_H__
+#define __SIMULATION_THREAD_H__
+
+/// @file SimulationThread.h
+/// @brief Declares the SimulationThread class, which lets a GUI engine driver simulate on its own thread.
+
+#include <string>
+#include "SteerLib.h"
+
+#ifdef _WIN32
+// see steerlib/util/DrawLib.h for explanation
+#pragma warning( push )
+#pragma warning( disable : 4251 )
+#endif
+
+
+/**
+ * @brief Runs SimulationEngine::update() in a loop on its own thread, so that drawing never slows down the simulation.
+ *
+ * The engine must have render snapshots enabled (see SteerLib::SimulationEngine::setRenderSnapshotsEnabled()) and be
+ * preprocessed before start() is called.  While the thread runs, the GUI thread draws the latest
+ * SteerLib::RenderSnapshot and owns the camera; any other access to the engine (input events that select agents or
+ * are forwarded to modules, GUI widgets that read the clock, ...) must be done between lock() and unlock().  The
+ * simulation thread holds the same lock for each frame it simulates.
+ *
+ * When the engine reports that the simulation is done, the thread stops by itself and isFinished() becomes true;
+ * postprocessSimulation() and cleanupSimulation() must then be called by the GUI thread after stop().
+ */
+class STEERLIB_API SimulationThread
+{
+public:
+	SimulationThread(SteerLib::SimulationEngine * engine);
+	/// Stops the thread if it is still running.
+	~SimulationThread();
+
+	/// Starts simulating; if paused is true, the thread only updates the real-time clock until setPaused(false) or stepOneFrame().
+	void start(bool paused);
+	/// Asks the thread to stop after the current frame and waits for it; rethrows (as a Util::GenericException) any exception thrown by the engine on the simulation thread.
+	void stop();
+	/// Returns true once the engine indicated that the simulation is done, or an exception stopped the thread.
+	bool isFinished();
+
+	void setPaused(bool paused);
+	bool isPaused();
+	/// Pauses the simulation, and simulates exactly one more frame.
+	void stepOneFrame();
+
+	/// Waits until the current frame is simulated, and keeps the simulation thread from starting another one until unlock().
+	void lock() { _engineLock.lock(); }
+	void unlock() { _engineLock.unlock(); }
+
+protected:
+	static void _runTask(unsigned int threadIndex, void * data);
+	/// The loop executed on the simulation thread.
+	void _run();
+
+	SteerLib::SimulationEngine * _engine;
+	Util::ThreadedTaskManager * _taskManager;
+	/// Held while the engine is updated; see lock().
+	Util::Mutex _engineLock;
+	/// Protects the flags below, so that pausing and stopping never wait for a frame to finish.
+	Util::Mutex _stateLock;
+	bool _paused;
+	bool _stopRequested;
+	bool _finished;
+	unsigned int _numFramesToStep;
+	std::string _errorMessage;
+
+private:
+	SimulationThread(const SimulationThread & );  // not implemented, not copyable
+	SimulationThread& operator= (const SimulationThread & );  // not implemented, not assignable
+};
+
+
+#ifdef _WIN32
+#pragma warning( pop )
+#endif
+
+#endif
@@ -10,6 +10,8 @@
 #include <exception>
 #include "SteerLib.h"
 #include "core/CommandLineEngineDriver.h"
+#include "core/EnsembleEngineDriver.h"
+#include "core/ServerEngineDriver.h"
 #include "core/GLFWEngineDriver.h"
 #include "core/QtEngineDriver.h"
 #include "SimulationPlugin.h"
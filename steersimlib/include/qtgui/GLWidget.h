@@ -16,6 +16,7 @@
 #include <QtOpenGL/QGLWidget>
 #include "SteerLib.h"
 #include "core/QtEngineDriver.h"
+#include "core/FrameCapture.h"
 #include "qtgui/QtEngineController.h"
 
 namespace SteerSimQt {
@@ -28,6 +29,8 @@ namespace SteerSimQt {
 		GLWidget(SteerLib::SimulationEngine * newEngine, const QGLFormat & format, bool dumpFrames);
 		~GLWidget();
 		void setControlKey(bool value);
+		/// While a simulation thread is set, the widget draws render snapshots, and locks the thread before it touches the engine.
+		void setSimulationThread(SimulationThread * simulationThread) { _simulationThread = simulationThread; }
 
 
 	protected:
@@ -56,6 +59,7 @@ namespace SteerSimQt {
 
 		SteerLib::SimulationEngine * _engine;
 		SteerLib::EngineControllerInterface * _controller;
+		SimulationThread * _simulationThread;
 
 		int _mouseX;
 		int _mouseY;
@@ -68,6 +72,8 @@ namespace SteerSimQt {
 		bool _useAntialiasing;
 
 		bool _dumpFrames;
+		/// Records the frames drawn while _dumpFrames is true; F12 screenshots are still written directly.
+		FrameCapture * _frameCapture;
 		unsigned int _nextScreenshotNumber;
 		GLvoid * _screenshotData;
 
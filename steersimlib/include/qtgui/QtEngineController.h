@@ -20,6 +20,7 @@
 #include <QtGui/QApplication>
 
 #include "SteerLib.h"
+#include "core/SimulationThread.h"
 
 namespace SteerSimQt {
 
@@ -81,10 +82,17 @@ namespace SteerSimQt {
 		void _unloadSimulation();
 		//@}
 
+		/// Updates the camera on the GUI thread, which owns it while the simulation thread runs.
+		void _updateCamera();
+
 
 		SteerLib::SimulationEngine * _engine;
 		GLWidget * _glWidget;
 		QTimer * _timer;
+		/// Runs the simulation if the GUI option useSimulationThread is set; otherwise NULL, and the simulation is updated by the timer.
+		SimulationThread * _simulationThread;
+		unsigned long long _startTicks;
+		unsigned long long _previousTicks;
 
 		bool _paused;
 	};
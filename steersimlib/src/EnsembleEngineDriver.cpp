@@ -0,0 +1,318 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file EnsembleEngineDriver.cpp
+/// @brief Implements the EnsembleEngineDriver functionality.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "core/EnsembleEngineDriver.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+//
+// constructor
+//
+EnsembleEngineDriver::EnsembleEngineDriver()
+{
+	_alreadyInitialized = false;
+	_options = NULL;
+}
+
+
+//
+// init() - decides the list of runs, and initializes one engine per worker thread.
+//
+void EnsembleEngineDriver::init(SteerLib::SimulationOptions * options)
+{
+	if (_alreadyInitialized) {
+		throw GenericException("EnsembleEngineDriver::init() - should not call this function twice.\n");
+	}
+
+	_alreadyInitialized = true;
+	_options = options;
+
+	const SimulationOptions::EnsembleEngineDriverOptions & ensembleOptions = _options->ensembleEngineDriverOptions;
+
+	_runs.clear();
+	if (ensembleOptions.runListFilename != "") {
+		_readRunList(ensembleOptions.runListFilename);
+	}
+	else {
+		if (_options->engineOptions.startupModules.count("testCasePlayer") == 0) {
+			throw GenericException("EnsembleEngineDriver needs either a run list or a test case to run; use the -ensembleRuns or -testcase options.");
+		}
+		std::string testCase = _options->moduleOptionsDatabase["testCasePlayer"]["testcase"];
+		for (unsigned int i=0; i < ensembleOptions.numRuns; i++) {
+			Run run;
+			run.testCase = testCase;
+			run.seed = ensembleOptions.firstSeed + i;
+			_runs.push_back(run);
+		}
+	}
+
+	if (_runs.empty()) {
+		throw GenericException("EnsembleEngineDriver has no runs to simulate.");
+	}
+	if (ensembleOptions.numThreads == 0) {
+		throw GenericException("EnsembleEngineDriver needs at least one thread.");
+	}
+
+	// every run is loaded by the testCasePlayer, even if the test cases only came from the run list.
+	_options->engineOptions.startupModules.insert("testCasePlayer");
+	_options->engineOptions.startupModules.erase("recFilePlayer");
+
+	// engines are initialized one at a time, before any thread starts simulating.
+	_workers.resize(std::min(ensembleOptions.numThreads, (unsigned int)_runs.size()));
+	for (unsigned int i=0; i < _workers.size(); i++) {
+		_workers[i].engine = NULL;
+		_createWorkerEngine(_workers[i]);
+	}
+}
+
+
+//
+// run() - simulates all runs, writing the results to the output file, or to std::cout if there is no output file.
+//
+void EnsembleEngineDriver::run()
+{
+	const std::string & outputFilename = _options->ensembleEngineDriverOptions.outputFilename;
+	if (outputFilename == "") {
+		run(std::cout);
+		return;
+	}
+
+	std::ofstream out(outputFilename.c_str());
+	if (!out.is_open()) {
+		throw GenericException("EnsembleEngineDriver could not open output file \"" + outputFilename + "\".");
+	}
+	run(out);
+}
+
+
+//
+// run() - simulates all runs, writing the results to the given stream.
+//
+void EnsembleEngineDriver::run(std::ostream & out)
+{
+	_results.clear();
+	_results.resize(_runs.size());
+
+	if (_workers.size() == 1) {
+		// no need for a thread pool; this also works where Util::ThreadedTaskManager is not supported.
+		for (unsigned int i=0; i < _runs.size(); i++) {
+			_simulateRun(0, i);
+		}
+	}
+	else {
+		std::vector<RunTask> runTasks(_runs.size());
+		ThreadedTaskManager taskManager((unsigned int)_workers.size());
+		for (unsigned int i=0; i < _runs.size(); i++) {
+			runTasks[i].driver = this;
+			runTasks[i].runIndex = i;
+			Task task;
+			task.function = &EnsembleEngineDriver::_runTask;
+			task.data = &runTasks[i];
+			taskManager.addTask(task, (i == _runs.size()-1));
+		}
+		taskManager.waitForAllTasksToComplete();
+	}
+
+	_writeResults(out);
+}
+
+
+//
+// finish() - cleans up.
+//
+void EnsembleEngineDriver::finish()
+{
+	for (unsigned int i=0; i < _workers.size(); i++) {
+		_destroyWorkerEngine(_workers[i]);
+	}
+	_workers.clear();
+	_alreadyInitialized = false;
+}
+
+
+//
+// _runTask() - the task executed by the worker threads; each worker thread only uses its own engine.
+//
+void EnsembleEngineDriver::_runTask(unsigned int threadIndex, void * data)
+{
+	RunTask * runTask = (RunTask*)data;
+	runTask->driver->_simulateRun(threadIndex, runTask->runIndex);
+}
+
+
+//
+// _simulateRun() - simulates one run from start to finish with the worker's engine.
+//
+void EnsembleEngineDriver::_simulateRun(unsigned int workerIndex, unsigned int runIndex)
+{
+	Worker & worker = _workers[workerIndex];
+	RunResult & result = _results[runIndex];
+	result.succeeded = false;
+	result.numFramesSimulated = 0;
+
+	try {
+		if (worker.engine == NULL) {
+			_createWorkerEngine(worker);
+		}
+
+		SimulationEngine * engine = worker.engine;
+		TestCasePlayerModule * testCasePlayer = dynamic_cast<TestCasePlayerModule*>(engine->getModule("testCasePlayer"));
+		testCasePlayer->setTestCase(_runs[runIndex].testCase, _runs[runIndex].seed);
+
+		engine->initializeSimulation();
+		engine->preprocessSimulation();
+		while (engine->update(false)) {
+		}
+		result.numFramesSimulated = engine->getClock().getCurrentFrameNumber();
+		engine->postprocessSimulation();
+		engine->cleanupSimulation();
+
+		_collectLogRecords(worker, result);
+		result.succeeded = true;
+	}
+	catch (std::exception & e) {
+		result.errorMessage = e.what();
+		// the engine may have been left in the middle of a simulation; the next run on this worker gets a new engine.
+		_destroyWorkerEngine(worker);
+	}
+}
+
+
+//
+// _collectLogRecords() - converts the log records that modules added during the last run into text.
+//
+void EnsembleEngineDriver::_collectLogRecords(Worker & worker, RunResult & result)
+{
+	const std::vector<ModuleInterface*> & modules = worker.engine->getAllModules();
+	for (unsigned int i=0; i < modules.size(); i++) {
+		std::string moduleName = worker.engine->getModuleMetaInfo(modules[i])->moduleName;
+		size_t & numCollected = worker.numLogRecordsCollected[moduleName];
+
+		LogData * logData = modules[i]->getLogData();
+		for (size_t j = numCollected; j < logData->size(); j++) {
+			Logger * logger = logData->getLogger();
+			ModuleLogRecord record;
+			record.moduleName = moduleName;
+			for (unsigned int f=0; f < logger->getNumberOfFields(); f++) {
+				record.fieldNames += ((f > 0) ? " " : "") + logger->getFieldName(f);
+			}
+			record.values = logger->logObjectToString(*logData->getLogDataAt(j));
+			record.values.erase(record.values.find_last_not_of(" \n") + 1);
+			result.logRecords.push_back(record);
+		}
+		numCollected = logData->size();
+
+		// LogData deletes its logger and records, but modules hand out their own; detach them before deleting.
+		logData->setLogger(NULL);
+		logData->setLogData(std::vector<LogObject*>());
+		delete logData;
+	}
+}
+
+
+//
+// _createWorkerEngine() - creates and initializes the engine of one worker; this loads all the modules.
+//
+void EnsembleEngineDriver::_createWorkerEngine(Worker & worker)
+{
+	worker.engine = new SimulationEngine();
+	worker.numLogRecordsCollected.clear();
+	worker.engine->init(_options, this);
+
+	if (dynamic_cast<TestCasePlayerModule*>(worker.engine->getModule("testCasePlayer")) == NULL) {
+		throw GenericException("EnsembleEngineDriver requires the testCasePlayer module.");
+	}
+}
+
+
+//
+// _destroyWorkerEngine() - finishes and deletes the engine of one worker.
+//
+void EnsembleEngineDriver::_destroyWorkerEngine(Worker & worker)
+{
+	if (worker.engine == NULL) {
+		return;
+	}
+
+	try {
+		worker.engine->finish();
+	}
+	catch (std::exception & e) {
+		std::cerr << "WARNING: EnsembleEngineDriver could not finish an engine properly:\n" << e.what() << "\n";
+	}
+	delete worker.engine;
+	worker.engine = NULL;
+}
+
+
+//
+// _readRunList() - reads a list of runs, one test case and an optional seed per line.
+//
+void EnsembleEngineDriver::_readRunList(const std::string & filename)
+{
+	std::ifstream in(filename.c_str());
+	if (!in.is_open()) {
+		throw GenericException("EnsembleEngineDriver could not open run list \"" + filename + "\".");
+	}
+
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream lineStream(line);
+		Run run;
+		if (!(lineStream >> run.testCase) || (run.testCase[0] == '#')) {
+			continue;
+		}
+		if (!(lineStream >> run.seed)) {
+			run.seed = _options->ensembleEngineDriverOptions.firstSeed + (unsigned int)_runs.size();
+		}
+		_runs.push_back(run);
+	}
+}
+
+
+//
+// _writeResults() - writes the results of all runs in run order.
+//
+void EnsembleEngineDriver::_writeResults(std::ostream & out)
+{
+	std::set<std::string> modulesDescribed;
+
+	out << "# ensemble of " << _runs.size() << " runs\n";
+	out << "# run <run index> <test case> <seed> <frames simulated> <ok | failed: reason>\n";
+	out << "# data <run index> <module> <log fields of the module>\n";
+
+	for (unsigned int i=0; i < _runs.size(); i++) {
+		const RunResult & result = _results[i];
+		out << "run " << i << " " << _runs[i].testCase << " " << _runs[i].seed << " " << result.numFramesSimulated << " ";
+		if (result.succeeded) {
+			out << "ok\n";
+		}
+		else {
+			std::string reason = result.errorMessage;
+			std::replace(reason.begin(), reason.end(), '\n', ' ');
+			out << "failed: " << reason << "\n";
+		}
+
+		for (unsigned int j=0; j < result.logRecords.size(); j++) {
+			const ModuleLogRecord & record = result.logRecords[j];
+			if (modulesDescribed.insert(record.moduleName).second) {
+				out << "# data <run index> " << record.moduleName << " " << record.fieldNames << "\n";
+			}
+			out << "data " << i << " " << record.moduleName << " " << record.values << "\n";
+		}
+	}
+
+	out.flush();
+}
@@ -0,0 +1,338 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file FrameCapture.cpp
+/// @brief Implements FrameCapture.
+
+#ifdef ENABLE_GUI
+
+#include <exception>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "core/FrameCapture.h"
+#include "util/ImageWriter.h"
+#include "util/GenericException.h"
+
+using namespace std;
+using namespace Util;
+
+
+//
+// _sleepWhileWaiting() - gives up the processor for about a millisecond while the worker threads catch up.
+//
+static void _sleepWhileWaiting()
+{
+#ifdef _WIN32
+	Sleep(1);
+#else
+	struct timespec t;
+	t.tv_sec = 0;
+	t.tv_nsec = 1000000;
+	nanosleep(&t, NULL);
+#endif
+}
+
+
+FrameCapture::FrameCapture(const std::string & filePrefix, FrameCaptureFormat format, unsigned int numWorkerThreads, unsigned int maxQueuedFrames)
+{
+	if (numWorkerThreads == 0) {
+		throw GenericException("FrameCapture: numWorkerThreads must be at least 1.");
+	}
+	if (maxQueuedFrames == 0) {
+		throw GenericException("FrameCapture: maxQueuedFrames must be at least 1.");
+	}
+
+	_filePrefix = filePrefix;
+	_format = format;
+	_maxQueuedFrames = maxQueuedFrames;
+	_taskManager = new ThreadedTaskManager(numWorkerThreads);
+
+	_rawVideoFile = NULL;
+	_nextFrameToWrite = 0;
+	_numFramesCaptured = 0;
+	_numStalls = 0;
+	_rawVideoWidth = 0;
+	_rawVideoHeight = 0;
+
+	_pixelBuffersInitialized = false;
+	_usePixelBuffers = false;
+	_pixelBuffers[0] = 0;
+	_pixelBuffers[1] = 0;
+	_currentPixelBuffer = 0;
+	_hasPendingReadback = false;
+	_pendingFrameNumber = 0;
+	_pendingWidth = 0;
+	_pendingHeight = 0;
+}
+
+
+FrameCapture::~FrameCapture()
+{
+	_taskManager->waitForAllTasksToComplete();
+	delete _taskManager;
+
+	if (_rawVideoFile != NULL) {
+		fclose(_rawVideoFile);
+	}
+	for (unsigned int i = 0; i < _allFrames.size(); i++) {
+		delete _allFrames[i];
+	}
+}
+
+
+std::string FrameCapture::getFileName(unsigned int frameNumber) const
+{
+	if (_format == FRAME_CAPTURE_RAW_VIDEO) {
+		return _filePrefix + ".rgb";
+	}
+
+	char number[16];
+	sprintf(number, "%05u", frameNumber);
+	return _filePrefix + number + ((_format == FRAME_CAPTURE_PNG) ? ".png" : ".ppm");
+}
+
+
+void FrameCapture::captureFrame(unsigned int width, unsigned int height)
+{
+	_throwWorkerError();
+
+	if (_format == FRAME_CAPTURE_RAW_VIDEO) {
+		if (_rawVideoWidth == 0) {
+			_rawVideoWidth = width;
+			_rawVideoHeight = height;
+		}
+		else if ((width != _rawVideoWidth) || (height != _rawVideoHeight)) {
+			throw GenericException("FrameCapture: the window size cannot change while a raw video is recorded.");
+		}
+	}
+
+	if (!_pixelBuffersInitialized) {
+#ifdef __APPLE__
+		// every openGL implementation on Mac OS X supports at least openGL 2.1.
+		_usePixelBuffers = true;
+#else
+		// glewInit() only loads function pointers; it is safe to call again if the application already did.
+		_usePixelBuffers = (glewInit() == GLEW_OK) && GLEW_VERSION_2_1;
+#endif
+		if (_usePixelBuffers) {
+			glGenBuffers(2, _pixelBuffers);
+		}
+		_pixelBuffersInitialized = true;
+	}
+
+	GLint previousPackAlignment;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	unsigned int frameNumber = _numFramesCaptured++;
+	if (_usePixelBuffers) {
+		// start copying this frame, then take the previous one, which the driver had a whole frame to finish.
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, _pixelBuffers[_currentPixelBuffer]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 3 * (GLsizeiptr)width * height, NULL, GL_STREAM_READ);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		_queuePendingReadback();
+
+		_hasPendingReadback = true;
+		_pendingFrameNumber = frameNumber;
+		_pendingWidth = width;
+		_pendingHeight = height;
+		_currentPixelBuffer = 1 - _currentPixelBuffer;
+	}
+	else {
+		Frame * frame = _acquireFreeFrame(width, height);
+		frame->frameNumber = frameNumber;
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &frame->pixels[0]);
+		_queueFrame(frame);
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+}
+
+
+void FrameCapture::finish()
+{
+	if (_pixelBuffersInitialized) {
+		if (_usePixelBuffers) {
+			_queuePendingReadback();
+			glDeleteBuffers(2, _pixelBuffers);
+		}
+		_pixelBuffersInitialized = false;
+	}
+
+	_waitForQueuedFrames();
+	_throwWorkerError();
+}
+
+
+void FrameCapture::_queuePendingReadback()
+{
+	if (!_hasPendingReadback) {
+		return;
+	}
+	_hasPendingReadback = false;
+
+	Frame * frame = _acquireFreeFrame(_pendingWidth, _pendingHeight);
+	frame->frameNumber = _pendingFrameNumber;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, _pixelBuffers[1 - _currentPixelBuffer]);
+	const void * pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (pixels != NULL) {
+		memcpy(&frame->pixels[0], pixels, frame->pixels.size());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	else {
+		memset(&frame->pixels[0], 0, frame->pixels.size());
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	_queueFrame(frame);
+}
+
+
+FrameCapture::Frame * FrameCapture::_acquireFreeFrame(unsigned int width, unsigned int height)
+{
+	Frame * frame = NULL;
+	bool stalled = false;
+	while (frame == NULL) {
+		_lock.lock();
+		if (!_freeFrames.empty()) {
+			frame = _freeFrames.back();
+			_freeFrames.pop_back();
+		}
+		else if (_allFrames.size() < _maxQueuedFrames) {
+			frame = new Frame();
+			frame->owner = this;
+			_allFrames.push_back(frame);
+		}
+		_lock.unlock();
+
+		if (frame == NULL) {
+			stalled = true;
+			_sleepWhileWaiting();
+		}
+	}
+
+	if (stalled) {
+		_numStalls++;
+	}
+	frame->width = width;
+	frame->height = height;
+	frame->pixels.resize(3 * (size_t)width * height);
+	return frame;
+}
+
+
+void FrameCapture::_queueFrame(Frame * frame)
+{
+	Task task;
+	task.function = &FrameCapture::_encodeFrameTask;
+	task.data = frame;
+	_taskManager->addTask(task, true);
+}
+
+
+void FrameCapture::_waitForQueuedFrames()
+{
+	_taskManager->waitForAllTasksToComplete();
+
+	_lock.lock();
+	if (_rawVideoFile != NULL) {
+		fflush(_rawVideoFile);
+	}
+	_lock.unlock();
+}
+
+
+void FrameCapture::_throwWorkerError()
+{
+	_lock.lock();
+	std::string errorMessage = _errorMessage;
+	_errorMessage = "";
+	_lock.unlock();
+
+	if (errorMessage != "") {
+		throw GenericException("FrameCapture: " + errorMessage);
+	}
+}
+
+
+//
+// _encodeFrameTask() - the task given to the Util::ThreadedTaskManager for each captured frame.
+//
+void FrameCapture::_encodeFrameTask(unsigned int threadIndex, void * data)
+{
+	Frame * frame = (Frame*)data;
+	frame->owner->_encodeFrame(frame);
+}
+
+
+void FrameCapture::_encodeFrame(Frame * frame)
+{
+	std::string errorMessage;
+
+	try {
+		if (_format == FRAME_CAPTURE_PNG) {
+			writePNG(getFileName(frame->frameNumber), frame->width, frame->height, &frame->pixels[0], true);
+		}
+		else if (_format == FRAME_CAPTURE_PPM) {
+			writePPM(getFileName(frame->frameNumber), frame->width, frame->height, &frame->pixels[0], true);
+		}
+		else {
+			// flip the rows here, so that only the ordered write below is serialized.
+			const size_t rowSize = 3 * (size_t)frame->width;
+			std::vector<unsigned char> row(rowSize);
+			for (unsigned int y = 0; y < frame->height / 2; y++) {
+				unsigned char * top = &frame->pixels[rowSize * y];
+				unsigned char * bottom = &frame->pixels[rowSize * (frame->height - 1 - y)];
+				memcpy(&row[0], top, rowSize);
+				memcpy(top, bottom, rowSize);
+				memcpy(bottom, &row[0], rowSize);
+			}
+
+			// frames are queued in order, so the frame that is next to be written is always being encoded already.
+			bool written = false;
+			while (!written) {
+				_lock.lock();
+				if (_nextFrameToWrite == frame->frameNumber) {
+					if (_rawVideoFile == NULL) {
+						_rawVideoFile = fopen(getFileName(0).c_str(), "wb");
+					}
+					if (_rawVideoFile == NULL) {
+						errorMessage = "could not open " + getFileName(0) + " for writing.";
+					}
+					else if (fwrite(&frame->pixels[0], 1, frame->pixels.size(), _rawVideoFile) != frame->pixels.size()) {
+						errorMessage = "could not write to " + getFileName(0) + ".";
+					}
+					_nextFrameToWrite++;
+					written = true;
+				}
+				_lock.unlock();
+
+				if (!written) {
+					_sleepWhileWaiting();
+				}
+			}
+		}
+	}
+	catch (std::exception & e) {
+		errorMessage = e.what();
+	}
+
+	_lock.lock();
+	if ((errorMessage != "") && (_errorMessage == "")) {
+		_errorMessage = errorMessage;
+	}
+	_freeFrames.push_back(frame);
+	_lock.unlock();
+}
+
+#endif // ifdef ENABLE_GUI
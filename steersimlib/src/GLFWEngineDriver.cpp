@@ -76,6 +76,10 @@ GLFWEngineDriver::GLFWEngineDriver()
 	_nextScreenshotNumber = 0;
 	_dumpFrames = false;
 	_done = false;
+	_useSimulationThread = false;
+	_simulationThread = NULL;
+	_frameSaver = NULL;
+	_frameCapture = NULL;
 
 	_useAntialiasing = true;
 	_canUseMouseToSelectAgents = true;
@@ -114,9 +118,26 @@ void GLFWEngineDriver::init(SimulationOptions * options)
 		_frameSaver->filePath = options->engineOptions.frameDumpDirectory;
 	}
 
+	FrameCaptureFormat frameDumpFormat;
+	if (_options->guiOptions.frameDumpFormat == "png") {
+		frameDumpFormat = FRAME_CAPTURE_PNG;
+	}
+	else if (_options->guiOptions.frameDumpFormat == "ppm") {
+		frameDumpFormat = FRAME_CAPTURE_PPM;
+	}
+	else if (_options->guiOptions.frameDumpFormat == "raw") {
+		frameDumpFormat = FRAME_CAPTURE_RAW_VIDEO;
+	}
+	else {
+		throw GenericException("Unknown frame dump format \"" + _options->guiOptions.frameDumpFormat + "\", expected \"png\", \"ppm\", or \"raw\".");
+	}
+	_frameCapture = new FrameCapture(_options->engineOptions.frameDumpDirectory + "frame", frameDumpFormat,
+		_options->guiOptions.numFrameDumpThreads, _options->guiOptions.maxQueuedFrameDumps);
+
 	_useAntialiasing = _options->guiOptions.useAntialiasing;
 	_canUseMouseToSelectAgents = _options->guiOptions.canUseMouseSelection;
 	_canUseMouseWheelZoom = _options->guiOptions.canUseMouseWheelZoom;
+	_useSimulationThread = _options->guiOptions.useSimulationThread;
 	_paused = _options->glfwEngineDriverOptions.pausedOnStart;
 
 	_initGLFW();
@@ -128,6 +149,11 @@ void GLFWEngineDriver::init(SimulationOptions * options)
 
 void GLFWEngineDriver::finish()
 {
+	// the frame capture needs the openGL context to read back its last frame.
+	_stopDumpingFrames();
+	delete _frameCapture;
+	_frameCapture = NULL;
+
 	_engine->finish();
 
 	delete _engine;
@@ -257,6 +283,9 @@ void GLFWEngineDriver::run()
 {
 	bool verbose = true;  // TODO: make this a user option ??.
 
+	// must be enabled before preprocessing, so that the first frame is published before the simulation starts.
+	_engine->setRenderSnapshotsEnabled(_useSimulationThread);
+
 	if (verbose) std::cout << "\rInitializing...\n";
 	_engine->initializeSimulation();
 
@@ -264,6 +293,9 @@ void GLFWEngineDriver::run()
 	_engine->preprocessSimulation();
 
 	if (verbose) std::cout << "\rSimulation is running...\n";
+	if (_useSimulationThread) {
+		_runWithSimulationThread();
+	}
 	while (!_done) {
 
 		// Finding the agent closest to mouse uses an exhaustive search across all agents.
@@ -305,7 +337,94 @@ void GLFWEngineDriver::run()
 	if (verbose) std::cout << "\rDone.\n";
 }
 
-void GLFWEngineDriver::_drawScene()
+
+//
+// _runWithSimulationThread() - the loop of run() when the simulation has its own thread; returns when the simulation is done or the user quits.
+//
+void GLFWEngineDriver::_runWithSimulationThread()
+{
+	SimulationThread simulationThread(_engine);
+	_simulationThread = &simulationThread;
+
+	// events are polled explicitly, under the engine lock, because the callbacks may select agents or forward input to modules.
+	glfwDisable(GLFW_AUTO_POLL_EVENTS);
+
+	unsigned long long counterFrequency = getHighResCounterFrequency();
+	unsigned long long startTicks = getHighResCounterValue();
+	unsigned long long previousTicks = startTicks;
+	unsigned long long fpsTicks = startTicks;
+	unsigned int numFramesDrawn = 0;
+	unsigned int lastFrameDrawn = 0;
+
+	simulationThread.start(_paused);
+
+	while (!_done) {
+		simulationThread.lock();
+		glfwPollEvents();
+		simulationThread.unlock();
+
+		if (simulationThread.isFinished()) {
+			_done = true;
+			break;
+		}
+
+		// the camera belongs to this thread while the simulation runs on the other one.
+		unsigned long long ticks = getHighResCounterValue();
+		_engine->getCamera().update((float)(ticks - startTicks) / (float)counterFrequency, (float)(ticks - previousTicks) / (float)counterFrequency);
+		previousTicks = ticks;
+
+		const RenderSnapshot * snapshot = _engine->getRenderSnapshotBuffer().acquireLatest();
+		if (snapshot == NULL) {
+			continue;
+		}
+
+		if (_canUseMouseToSelectAgents) {
+			_findClosestAgentToMouse(*snapshot);
+		}
+
+		// frames are dumped one-to-one with simulated frames, not with redraws.
+		bool dumpFrames = _dumpFrames;
+		_dumpFrames = dumpFrames && (snapshot->frameNumber != lastFrameDrawn);
+		_drawScene(snapshot);
+		_dumpFrames = dumpFrames;
+		lastFrameDrawn = snapshot->frameNumber;
+
+		numFramesDrawn++;
+		if (ticks - fpsTicks >= counterFrequency) {
+			std::ostringstream stream;
+			stream << "SteerSuite: " << (float)numFramesDrawn * counterFrequency / (float)(ticks - fpsTicks) << " fps, frame " << snapshot->frameNumber;
+			glfwSetWindowTitle(stream.str().c_str());
+			numFramesDrawn = 0;
+			fpsTicks = ticks;
+		}
+	}
+
+	_simulationThread = NULL;
+	simulationThread.stop();
+}
+
+
+void GLFWEngineDriver::_setPaused(bool paused)
+{
+	_paused = paused;
+	if (_simulationThread != NULL) {
+		_simulationThread->setPaused(paused);
+	}
+}
+
+
+void GLFWEngineDriver::pauseAndStepOneFrame()
+{
+	_paused = true;
+	if (_simulationThread != NULL) {
+		_simulationThread->stepOneFrame();
+	}
+	else {
+		_engine->update(false);
+	}
+}
+
+void GLFWEngineDriver::_drawScene(const RenderSnapshot * snapshot)
 {
 	// get the camera from the engine
 	Camera & cam = _engine->getCamera();
@@ -318,7 +437,7 @@ void GLFWEngineDriver::_drawScene()
 	{
 		cam.apply();
 		DrawLib::positionLights();
-		_engine->draw();
+		_drawSimulation(snapshot);
 	}
 	else
 	{
@@ -367,7 +486,7 @@ void GLFWEngineDriver::_drawScene()
 
 		cam.apply_stereo(false);
 		DrawLib::positionLights();
-		_engine->draw();
+		_drawSimulation(snapshot);
 
 		if (_options->glfwEngineDriverOptions.stereoMode == "side-by-side")
 			glViewport(_options->glfwEngineDriverOptions.windowSizeX/2, 0, _options->glfwEngineDriverOptions.windowSizeX/2, _options->glfwEngineDriverOptions.windowSizeY);
@@ -387,7 +506,7 @@ void GLFWEngineDriver::_drawScene()
 
 		cam.apply_stereo(true);
 		DrawLib::positionLights();
-		_engine->draw();
+		_drawSimulation(snapshot);
 	}
 
 	// check for errors
@@ -398,13 +517,27 @@ void GLFWEngineDriver::_drawScene()
 		throw GenericException("OpenGL error occurred in GLFWEngineDriver::_drawScene().");
 	}
 
-	if (_dumpFrames)
-		writeScreenCapture();
+	if (_dumpFrames) {
+		int width, height;
+		glfwGetWindowSize(&width, &height);
+		glReadBuffer(GL_BACK);
+		_frameCapture->captureFrame(width, height);
+	}
 
 	// double buffering, swap back and front buffers
 	glfwSwapBuffers();
 }
 
+void GLFWEngineDriver::_drawSimulation(const RenderSnapshot * snapshot)
+{
+	if (snapshot != NULL) {
+		_engine->drawRenderSnapshot(*snapshot);
+	}
+	else {
+		_engine->draw();
+	}
+}
+
 
 //
 // drawGUI() - draw any GUI elements or global GUI annotations that have nothing to do with the simulation.
@@ -416,6 +549,25 @@ void GLFWEngineDriver::_drawGUI()
 
 
 
+void GLFWEngineDriver::_stopDumpingFrames()
+{
+	bool wasDumpingFrames = _dumpFrames;
+	_dumpFrames = false;
+	if (!wasDumpingFrames || (_frameCapture == NULL) || (_frameCapture->getNumFramesCaptured() == 0)) {
+		return;
+	}
+
+	_frameCapture->finish();
+	if (_options->guiOptions.frameDumpFormat == "raw") {
+		std::cout << _frameCapture->getNumFramesCaptured() << " frames written to " << _frameCapture->getFileName(0) << " (raw rgb24)";
+	}
+	else {
+		std::cout << _frameCapture->getNumFramesCaptured() << " frames written up to " << _frameCapture->getFileName(_frameCapture->getNumFramesCaptured() - 1);
+	}
+	std::cout << ", drawing waited for the writers " << _frameCapture->getNumStalls() << " times." << std::endl;
+}
+
+
 void GLFWEngineDriver::writeScreenCapture()
 {
 	// cerr << "WARNING: no screenshot taken, feature not implemented for GLFW yet.\n";
@@ -451,7 +603,7 @@ void GLFWEngineDriver::dumpTestCase()
 
 
 
-void GLFWEngineDriver::_findClosestAgentToMouse()
+Point GLFWEngineDriver::_getMouseLocationOnGroundPlane()
 {
 	// gotta find mouse/screen position in world coords
 
@@ -485,7 +637,13 @@ void GLFWEngineDriver::_findClosestAgentToMouse()
 	// agents are closest to the ray
 	// NOTE: assuming that agents are all at the y=0 plane.
 	float t = -cameraPos.y / cameraRay.y;  // this gives us the t value for where the point along the ray would be on the y=0 plane.
-	Point locationOfMouseOnYPlane = cameraPos + t*cameraRay;
+	return cameraPos + t*cameraRay;
+}
+
+
+void GLFWEngineDriver::_findClosestAgentToMouse()
+{
+	Point locationOfMouseOnYPlane = _getMouseLocationOnGroundPlane();
 
 	// nearest: nearest agent to mouse pos
 	// nearestAndContained: nearest agent to mouse pos and the point mouse is within radius
@@ -509,6 +667,25 @@ void GLFWEngineDriver::_findClosestAgentToMouse()
 }
 
 
+void GLFWEngineDriver::_findClosestAgentToMouse(const RenderSnapshot & snapshot)
+{
+	Point locationOfMouseOnYPlane = _getMouseLocationOnGroundPlane();
+
+	AgentInterface* nearest = NULL;
+	float distanceToNearest = FLT_MAX;
+
+	for (unsigned int i = 0; i < snapshot.agents.size(); i++) {
+		const AgentRenderState & agent = snapshot.agents[i];
+		float dist = distanceBetween(agent.position, locationOfMouseOnYPlane);
+		if ((dist < agent.radius+0.5f) && (dist < distanceToNearest)) {
+			nearest = agent.agent;
+			distanceToNearest = dist;
+		}
+	}
+	_agentNearestToMouse = nearest;
+}
+
+
 //=====================================================
 // GLUT callback functions
 //=====================================================
@@ -571,7 +748,7 @@ void GLFWEngineDriver::processKeyPressEvent(int key, int action)
 	{
 		// end button
 		std::cout << "Ending frame saving" << std::endl;
-		_dumpFrames = false;
+		_stopDumpingFrames();
 	}
 	else {
 		if (_engine) _engine->processKeyboardInput( key, action);
@@ -33,6 +33,7 @@ GLWidget::GLWidget(SimulationEngine * newEngine, const QGLFormat & format, bool
 {
 	_engine = newEngine;
 	_controller = _engine->getEngineController();
+	_simulationThread = NULL;
 	_mouseX = 0;
 	_mouseY = 0;
 	_moveCameraOnMouseMotion = false;
@@ -44,6 +45,7 @@ GLWidget::GLWidget(SimulationEngine * newEngine, const QGLFormat & format, bool
 	_canUseMouseToSelectAgents = gSteerSimConfig.defaultCanUseMouseSelection();
 	_nextScreenshotNumber = 0;
 	_dumpFrames = dumpFrames;
+	_frameCapture = new FrameCapture("image", FRAME_CAPTURE_PNG, _engine->getOptions().guiOptions.numFrameDumpThreads, _engine->getOptions().guiOptions.maxQueuedFrameDumps);
 	_screenshotData = NULL;
 
 	_controlKeyPressed = false;
@@ -55,6 +57,13 @@ GLWidget::GLWidget(SimulationEngine * newEngine, const QGLFormat & format, bool
 GLWidget::~GLWidget()
 {
     makeCurrent();
+	try {
+		_frameCapture->finish();
+	}
+	catch (std::exception & e) {
+		cerr << e.what() << "\n";
+	}
+	delete _frameCapture;
 }
 
 
@@ -93,7 +102,13 @@ void GLWidget::paintGL()
 
 	cam.apply();
 	DrawLib::positionLights();
-	_engine->draw();
+	if (_simulationThread != NULL) {
+		const RenderSnapshot * snapshot = _engine->getRenderSnapshotBuffer().acquireLatest();
+		if (snapshot != NULL) _engine->drawRenderSnapshot(*snapshot);
+	}
+	else {
+		_engine->draw();
+	}
 
 
 	// check for errors
@@ -104,7 +119,10 @@ void GLWidget::paintGL()
 	}
 
 	// TODO: is this in the right place, before swapping buffers?!?  maybe its different for Qt because of timing?
-	if (_dumpFrames && _engine->isSimulationRunning()) _saveOpenGLBufferToPng();
+	if (_dumpFrames && _engine->isSimulationRunning()) {
+		glReadBuffer(GL_BACK);
+		_frameCapture->captureFrame(width(), height());
+	}
 
 	// double buffering, swap back and front buffers
 	glFlush();
@@ -212,6 +230,8 @@ void GLWidget::keyPressEvent(QKeyEvent *event)
 	}
 	else if (event->key() == Qt::Key_End) {
 		_dumpFrames = false;
+		makeCurrent();
+		_frameCapture->finish();
 	}
 	else if (event->key() == Qt::Key_Right) {
 		_controller->pauseAndStepOneFrame();
@@ -262,7 +282,9 @@ void GLWidget::keyPressEvent(QKeyEvent *event)
 			default:
 				return;
 		}
+		if (_simulationThread != NULL) _simulationThread->lock();
 		if (_engine) _engine->processKeyboardInput( glfwButtonCode , glfwActionCode );
+		if (_simulationThread != NULL) _simulationThread->unlock();
 	}
 }
 
@@ -277,6 +299,7 @@ void GLWidget::mousePressEvent(QMouseEvent *event)
 {
 	if (event->button() ==  Qt::LeftButton) {
 		if(!_controlKeyPressed) {
+			if (_simulationThread != NULL) _simulationThread->lock();
 			_findClosestAgentToMouse();
 			if (_agentNearestToMouse != NULL) {
 				if (!_engine->isAgentSelected(_agentNearestToMouse)) {
@@ -303,6 +326,7 @@ void GLWidget::mousePressEvent(QMouseEvent *event)
 			else {
 				_engine->unselectAllAgents();
 			}
+			if (_simulationThread != NULL) _simulationThread->unlock();
 
 			//if (_agentNearestToMouse != NULL) {
 			//	if (_engine->isAgentSelected(_agentNearestToMouse)) {
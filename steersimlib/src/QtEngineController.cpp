@@ -20,6 +20,10 @@ void QtEngineController::init(SimulationEngine * engine, GLWidget * glWidget)
 	_paused = false;
 	_engine = engine;
 	_glWidget = glWidget;
+	_simulationThread = NULL;
+	_startTicks = getHighResCounterValue();
+	_previousTicks = _startTicks;
+	_engine->setRenderSnapshotsEnabled(_engine->getOptions().guiOptions.useSimulationThread);
 	_timer = new QTimer(this);
 	connect( _timer, SIGNAL(timeout()), this, SLOT(updateGUIAndEngine()) );
 
@@ -31,6 +35,7 @@ void QtEngineController::init(SimulationEngine * engine, GLWidget * glWidget)
 
 QtEngineController::~QtEngineController()
 {
+	delete _simulationThread;
 	delete _timer;
 }
 
@@ -39,7 +44,21 @@ void QtEngineController::updateGUIAndEngine()
 {
 	bool stillRunning = true;
 
-	if (_engine->getCurrentState() == SimulationEngine::ENGINE_STATE_SIMULATION_READY_FOR_UPDATE) {
+	if (_simulationThread != NULL) {
+		// the simulation advances on its own thread; here, only draw the latest frame.
+		if (_simulationThread->isFinished()) {
+			_stopSimulation();
+			return;
+		}
+		_updateCamera();
+		_glWidget->updateGL();
+		// widgets that receive these signals read the engine directly.
+		_simulationThread->lock();
+		emit realTimeUpdatedSignal();
+		if (!_paused) emit simulationAdvancedOneFrameSignal();
+		_simulationThread->unlock();
+	}
+	else if (_engine->getCurrentState() == SimulationEngine::ENGINE_STATE_SIMULATION_READY_FOR_UPDATE) {
 		stillRunning = _engine->update(_paused);
 		_glWidget->updateGL();  // make sure things get rendered one-to-one with engine updates, which is important for dumping frames to file.
 		if (stillRunning == false) {
@@ -67,10 +86,23 @@ void QtEngineController::_startSimulation()
 	std::cout << "Simulation started.\n";
 	emit simulationStartedSignal();
 	_engine->preprocessSimulation();
+
+	if (_engine->getRenderSnapshotsEnabled()) {
+		_simulationThread = new SimulationThread(_engine);
+		_simulationThread->start(_paused);
+		_glWidget->setSimulationThread(_simulationThread);
+	}
 }
 
 void QtEngineController::_stopSimulation()
 {
+	if (_simulationThread != NULL) {
+		_glWidget->setSimulationThread(NULL);
+		SimulationThread * simulationThread = _simulationThread;
+		_simulationThread = NULL;
+		simulationThread->stop();
+		delete simulationThread;
+	}
 	_engine->postprocessSimulation();
 	std::cout << "Simulation stopped.\n";
 	emit simulationStoppedSignal();
@@ -81,6 +113,7 @@ void QtEngineController::_pauseSimulation()
 	// eventually delete this line after new clock/pausing mechanism is stablized
 	//_engine->getClock().setPausedState(true);
 	_paused = true;
+	if (_simulationThread != NULL) _simulationThread->setPaused(true);
 	std::cout << "Simulation paused.\n";
 	emit simulationPausedSignal();
 }
@@ -90,6 +123,7 @@ void QtEngineController::_unpauseSimulation()
 	// eventually delete this line after new clock/pausing mechanism is stablized
 	//_engine->getClock().setPausedState(false);
 	_paused = false;
+	if (_simulationThread != NULL) _simulationThread->setPaused(false);
 	std::cout << "Simulation unpaused.\n";
 	emit simulationUnpausedSignal();
 }
@@ -108,12 +142,26 @@ void QtEngineController::_pauseAndStepOneFrame()
 {
 	std::cout << "Simulation stepping forward one frame.\n";
 	bool wasAlreadyPaused = _paused;
-	_engine->update(false);
+	if (_simulationThread != NULL) {
+		_paused = true;
+		_simulationThread->stepOneFrame();
+	}
+	else {
+		_engine->update(false);
+	}
 	if (!wasAlreadyPaused) emit simulationPausedSignal();
 	emit realTimeUpdatedSignal();
 	emit simulationAdvancedOneFrameSignal();
 }
 
+void QtEngineController::_updateCamera()
+{
+	unsigned long long ticks = getHighResCounterValue();
+	float frequency = (float)getHighResCounterFrequency();
+	_engine->getCamera().update((float)(ticks - _startTicks) / frequency, (float)(ticks - _previousTicks) / frequency);
+	_previousTicks = ticks;
+}
+
 void QtEngineController::_unloadSimulation()
 {
 	_engine->cleanupSimulation();
@@ -0,0 +1,589 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file ServerEngineDriver.cpp
+/// @brief Implements the ServerEngineDriver functionality.
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include "core/ServerEngineDriver.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+#define DEFAULT_SERVER_AGENT_RADIUS 0.5f
+#define DEFAULT_SERVER_AGENT_DESIRED_SPEED 1.33f
+#define DEFAULT_SERVER_GOAL_TIME_DURATION 100000.0f
+// the same default as the testCasePlayer module.
+#define DEFAULT_SERVER_RANDOM_SEED 2
+
+#define SERVER_MAX_COMMAND_LENGTH 4096
+
+
+//
+// _errnoMessage() - describes the error of the last failed system call.
+//
+static std::string _errnoMessage()
+{
+	return std::string(strerror(errno));
+}
+
+
+//
+// constructor
+//
+ServerEngineDriver::ServerEngineDriver()
+{
+	_alreadyInitialized = false;
+	_options = NULL;
+	_engine = NULL;
+	_simulationLoaded = false;
+	_simulationRunning = false;
+	_shutdownRequested = false;
+	_closeRequested = false;
+	_listenSocket = -1;
+	_sharedMemoryFile = -1;
+	_sharedMemorySize = 0;
+	_sharedMemory = NULL;
+	_sequence = 0;
+}
+
+
+//
+// destructor - releases the socket and shared memory even if finish() was not called.
+//
+ServerEngineDriver::~ServerEngineDriver()
+{
+	_destroySocket();
+	_destroySharedMemory();
+}
+
+
+//
+// init() - loads the modules and the simulation, and creates the shared memory and the socket.
+//
+void ServerEngineDriver::init(SteerLib::SimulationOptions * options)
+{
+	if (_alreadyInitialized) {
+		throw GenericException("ServerEngineDriver::init() - should not call this function twice.\n");
+	}
+
+#ifdef _WIN32
+	throw GenericException("ServerEngineDriver is only supported on POSIX systems.");
+#else
+	_alreadyInitialized = true;
+	_options = options;
+
+	const SimulationOptions::ServerEngineDriverOptions & serverOptions = _options->serverEngineDriverOptions;
+	if (serverOptions.numStateSlots == 0) {
+		throw GenericException("ServerEngineDriver needs at least one state slot.");
+	}
+	if (_options->engineOptions.startupModules.count("testCasePlayer") == 0) {
+		throw GenericException("ServerEngineDriver needs a test case to load; use the -testcase option.");
+	}
+	_options->engineOptions.startupModules.erase("recFilePlayer");
+
+	// a controller that disconnects while a reply is sent should not terminate the server.
+	signal(SIGPIPE, SIG_IGN);
+
+	_engine = new SimulationEngine();
+	_engine->init(_options, this);
+	if (dynamic_cast<TestCasePlayerModule*>(_engine->getModule("testCasePlayer")) == NULL) {
+		throw GenericException("ServerEngineDriver requires the testCasePlayer module.");
+	}
+
+	// the shared memory and socket outlive the process unless they are removed, so clean up if anything fails.
+	try {
+		_createSharedMemory();
+		_loadSimulation();
+		_createSocket();
+	}
+	catch (...) {
+		_destroySocket();
+		_destroySharedMemory();
+		throw;
+	}
+#endif
+}
+
+
+//
+// run() - serves one controller at a time, until a controller sends "shutdown".
+//
+void ServerEngineDriver::run()
+{
+#ifndef _WIN32
+	std::cout << "ServerEngineDriver: waiting for controllers on " << _options->serverEngineDriverOptions.socketPath
+		<< ", agent states are in shared memory " << _options->serverEngineDriverOptions.sharedMemoryName << std::endl;
+
+	while (!_shutdownRequested) {
+		int connection = accept(_listenSocket, NULL, NULL);
+		if (connection < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw GenericException("ServerEngineDriver could not accept a connection: " + _errnoMessage());
+		}
+		_serveConnection(connection);
+		close(connection);
+	}
+#endif
+}
+
+
+//
+// finish() - unloads the simulation and releases everything created by init().
+//
+void ServerEngineDriver::finish()
+{
+	_destroySocket();
+	if (_engine != NULL) {
+		_unloadSimulation();
+		_engine->finish();
+		delete _engine;
+		_engine = NULL;
+	}
+	_destroySharedMemory();
+	_alreadyInitialized = false;
+}
+
+
+//
+// executeCommand() - parses and executes one command; errors become "error ..." replies instead of exceptions.
+//
+std::string ServerEngineDriver::executeCommand(const std::string & commandLine)
+{
+	std::istringstream in(commandLine);
+	std::string command;
+	in >> command;
+
+	try {
+		if (command == "step") {
+			unsigned int numFrames = 1;
+			if (!(in >> numFrames)) {
+				numFrames = 1;
+			}
+			for (unsigned int i = 0; (i < numFrames) && _simulationRunning; i++) {
+				_simulationRunning = _engine->update(false);
+				_publishState();
+			}
+			return _getFrameReply();
+		}
+		else if (command == "state") {
+			_publishState();
+			return _getFrameReply();
+		}
+		else if (command == "reset") {
+			std::string testCase;
+			if (in >> testCase) {
+				unsigned int seed = DEFAULT_SERVER_RANDOM_SEED;
+				in >> seed;
+				_unloadSimulation();
+				dynamic_cast<TestCasePlayerModule*>(_engine->getModule("testCasePlayer"))->setTestCase(testCase, seed);
+				_loadSimulation();
+			}
+			else {
+				_resetSimulation();
+			}
+			return "ok " + toString(_sequence) + " " + toString(_engine->getAgents().size());
+		}
+		else if (command == "setGoal") {
+			unsigned int id;
+			float x, z;
+			float desiredSpeed = DEFAULT_SERVER_AGENT_DESIRED_SPEED;
+			if (!(in >> id >> x >> z)) {
+				return "error usage: setGoal <id> <x> <z> [speed]";
+			}
+			in >> desiredSpeed;
+			if (!_simulationRunning) {
+				return "error the simulation is done; reset it first";
+			}
+			AgentInterface * agent = _getAgent(id);
+
+			AgentGoalInfo goal;
+			goal.goalType = GOAL_TYPE_SEEK_STATIC_TARGET;
+			goal.targetIsRandom = false;
+			goal.timeDuration = DEFAULT_SERVER_GOAL_TIME_DURATION;
+			goal.desiredSpeed = desiredSpeed;
+			goal.targetLocation = Point(x, 0.0f, z);
+
+			// resetting the agent where it stands replaces its goals and plans its path again; agents that already
+			// arrived (and were disabled) come back into the simulation.
+			AgentInitialConditions initialConditions;
+			initialConditions.name = "agent" + toString(id);
+			initialConditions.position = agent->position();
+			initialConditions.direction = agent->forward();
+			initialConditions.radius = agent->radius();
+			initialConditions.speed = agent->velocity().length();
+			initialConditions.goals.push_back(goal);
+			initialConditions.colorSet = false;
+			agent->reset(initialConditions, _engine);
+			return "ok";
+		}
+		else if (command == "addAgent") {
+			float x, z, goalX, goalZ;
+			float radius = DEFAULT_SERVER_AGENT_RADIUS;
+			float desiredSpeed = DEFAULT_SERVER_AGENT_DESIRED_SPEED;
+			if (!(in >> x >> z >> goalX >> goalZ)) {
+				return "error usage: addAgent <x> <z> <goalX> <goalZ> [radius] [speed]";
+			}
+			if (in >> radius) {
+				in >> desiredSpeed;
+			}
+			if (!_simulationRunning) {
+				return "error the simulation is done; reset it first";
+			}
+			if (_engine->getAgents().size() >= _options->serverEngineDriverOptions.maxAgents) {
+				return "error the shared memory holds at most " + toString(_options->serverEngineDriverOptions.maxAgents) + " agents";
+			}
+
+			AgentGoalInfo goal;
+			goal.goalType = GOAL_TYPE_SEEK_STATIC_TARGET;
+			goal.targetIsRandom = false;
+			goal.timeDuration = DEFAULT_SERVER_GOAL_TIME_DURATION;
+			goal.desiredSpeed = desiredSpeed;
+			goal.targetLocation = Point(goalX, 0.0f, goalZ);
+
+			AgentInitialConditions initialConditions;
+			initialConditions.name = "agent" + toString(_engine->getAgents().size());
+			initialConditions.position = Point(x, 0.0f, z);
+			Vector toGoal(goalX - x, 0.0f, goalZ - z);
+			initialConditions.direction = (toGoal.lengthSquared() > 0.0f) ? normalize(toGoal) : Vector(1.0f, 0.0f, 0.0f);
+			initialConditions.radius = radius;
+			initialConditions.speed = 0.0f;
+			initialConditions.goals.push_back(goal);
+			initialConditions.colorSet = false;
+
+			AgentInterface * agent = _engine->createAgent(initialConditions, _getAIModule());
+			if (agent == NULL) {
+				return "error the AI module could not create an agent";
+			}
+			// the engine only resets the agents it creates itself during preprocessSimulation().
+			agent->reset(initialConditions, _engine);
+			return "ok " + toString(_engine->getAgents().size() - 1);
+		}
+		else if (command == "info") {
+			const SimulationOptions::ServerEngineDriverOptions & serverOptions = _options->serverEngineDriverOptions;
+			return "ok " + serverOptions.sharedMemoryName + " " + toString(serverOptions.numStateSlots) + " " + toString(serverOptions.maxAgents)
+				+ " " + toString(_engine->getAgents().size()) + " " + toString(_engine->getClock().getCurrentFrameNumber());
+		}
+		else if (command == "close") {
+			_closeRequested = true;
+			return "ok";
+		}
+		else if (command == "shutdown") {
+			_closeRequested = true;
+			_shutdownRequested = true;
+			return "ok";
+		}
+		else {
+			return "error unknown command \"" + command + "\"";
+		}
+	}
+	catch (std::exception & e) {
+		// exceptions never cross the socket; the message must stay on one line.
+		std::string message = e.what();
+		std::replace(message.begin(), message.end(), '\n', ' ');
+		return "error " + message;
+	}
+}
+
+
+//
+// _loadSimulation() - loads the testCasePlayer's test case, and remembers the initial state for "reset".
+//
+void ServerEngineDriver::_loadSimulation()
+{
+	_engine->initializeSimulation();
+	_simulationLoaded = true;
+	_engine->preprocessSimulation();
+	_simulationRunning = true;
+	_engine->saveSnapshot(_initialSnapshot);
+
+	if (_engine->getAgents().size() > _options->serverEngineDriverOptions.maxAgents) {
+		std::cerr << "WARNING: ServerEngineDriver: the test case has " << _engine->getAgents().size() << " agents, but the shared memory only holds the first "
+			<< _options->serverEngineDriverOptions.maxAgents << "; use a larger maxAgents option.\n";
+	}
+	_publishState();
+}
+
+
+//
+// _unloadSimulation() - ends and cleans up the loaded simulation, if any.
+//
+void ServerEngineDriver::_unloadSimulation()
+{
+	if (!_simulationLoaded) {
+		return;
+	}
+	_simulationLoaded = false;
+	_simulationRunning = false;
+	_engine->postprocessSimulation();
+
+	// agents are destroyed without being taken out of the spatial database, which would leave dangling items
+	// behind for the next test case; agents that arrived were already taken out when they were disabled.
+	const std::vector<AgentInterface*> & agents = _engine->getAgents();
+	for (unsigned int i = 0; i < agents.size(); i++) {
+		if (agents[i]->enabled()) {
+			agents[i]->disable();
+		}
+	}
+	_engine->cleanupSimulation();
+}
+
+
+//
+// _resetSimulation() - restores the initial snapshot; much faster than reading and loading the test case again.
+//
+void ServerEngineDriver::_resetSimulation()
+{
+	if (!_simulationLoaded) {
+		throw GenericException("there is no simulation loaded.");
+	}
+	_engine->restoreSnapshot(_initialSnapshot);
+	_simulationRunning = true;
+	_publishState();
+}
+
+
+//
+// _publishState() - writes the current agent states into the next slot of the shared memory ring buffer.
+//
+void ServerEngineDriver::_publishState()
+{
+#ifndef _WIN32
+	ServerStateHeader * header = (ServerStateHeader*)_sharedMemory;
+	uint64_t sequence = _sequence + 1;
+	ServerStateSlotHeader * slot = (ServerStateSlotHeader*)(_sharedMemory + sizeof(ServerStateHeader) + (size_t)(sequence % header->numSlots) * header->slotSize);
+	ServerAgentState * records = (ServerAgentState*)(slot + 1);
+
+	slot->sequence = 0;
+	__sync_synchronize();
+
+	const std::vector<AgentInterface*> & agents = _engine->getAgents();
+	unsigned int numAgents = std::min((unsigned int)agents.size(), header->maxAgents);
+	for (unsigned int i = 0; i < numAgents; i++) {
+		AgentInterface * agent = agents[i];
+		ServerAgentState & record = records[i];
+		bool enabled = agent->enabled();
+		record.flags = enabled ? SERVER_AGENT_STATE_ENABLED : 0;
+		record.radius = agent->radius();
+		Point position = agent->position();
+		Vector velocity = enabled ? agent->velocity() : Vector(0.0f, 0.0f, 0.0f);
+		Vector forward = agent->forward();
+		record.positionX = position.x;
+		record.positionZ = position.z;
+		record.velocityX = velocity.x;
+		record.velocityZ = velocity.z;
+		record.forwardX = forward.x;
+		record.forwardZ = forward.z;
+	}
+	slot->frameNumber = _engine->getClock().getCurrentFrameNumber();
+	slot->numAgents = numAgents;
+	slot->simulationTime = _engine->getClock().getCurrentSimulationTime();
+
+	__sync_synchronize();
+	slot->sequence = sequence;
+	header->latestSequence = sequence;
+	_sequence = sequence;
+#endif
+}
+
+
+std::string ServerEngineDriver::_getFrameReply()
+{
+	return "ok " + toString(_sequence) + " " + toString(_engine->getClock().getCurrentFrameNumber()) + (_simulationRunning ? " running" : " done");
+}
+
+
+AgentInterface * ServerEngineDriver::_getAgent(unsigned int id)
+{
+	const std::vector<AgentInterface*> & agents = _engine->getAgents();
+	if (id >= agents.size()) {
+		throw GenericException("there is no agent " + toString(id) + "; there are " + toString(agents.size()) + " agents.");
+	}
+	return agents[id];
+}
+
+
+//
+// _getAIModule() - returns the module that creates the testCasePlayer's agents.
+//
+ModuleInterface * ServerEngineDriver::_getAIModule()
+{
+	std::string aiModuleName = _options->moduleOptionsDatabase["testCasePlayer"]["ai"];
+	ModuleInterface * aiModule = _engine->getModule(aiModuleName);
+	if (aiModule == NULL) {
+		throw GenericException("the AI module \"" + aiModuleName + "\" of the testCasePlayer is not loaded.");
+	}
+	return aiModule;
+}
+
+
+//
+// _createSharedMemory() - creates and maps the shared memory object, and initializes its header.
+//
+void ServerEngineDriver::_createSharedMemory()
+{
+#ifndef _WIN32
+	const SimulationOptions::ServerEngineDriverOptions & serverOptions = _options->serverEngineDriverOptions;
+	size_t slotSize = sizeof(ServerStateSlotHeader) + (size_t)serverOptions.maxAgents * sizeof(ServerAgentState);
+	_sharedMemorySize = sizeof(ServerStateHeader) + (size_t)serverOptions.numStateSlots * slotSize;
+
+	// a server that crashed may have left the object behind, possibly with another size.
+	shm_unlink(serverOptions.sharedMemoryName.c_str());
+	_sharedMemoryFile = shm_open(serverOptions.sharedMemoryName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (_sharedMemoryFile < 0) {
+		throw GenericException("ServerEngineDriver could not create shared memory \"" + serverOptions.sharedMemoryName + "\": " + _errnoMessage());
+	}
+	if (ftruncate(_sharedMemoryFile, (off_t)_sharedMemorySize) != 0) {
+		std::string message = _errnoMessage();
+		_destroySharedMemory();
+		throw GenericException("ServerEngineDriver could not size shared memory \"" + serverOptions.sharedMemoryName + "\": " + message);
+	}
+	void * memory = mmap(NULL, _sharedMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, _sharedMemoryFile, 0);
+	if (memory == MAP_FAILED) {
+		std::string message = _errnoMessage();
+		_destroySharedMemory();
+		throw GenericException("ServerEngineDriver could not map shared memory \"" + serverOptions.sharedMemoryName + "\": " + message);
+	}
+	_sharedMemory = (unsigned char*)memory;
+
+	// ftruncate() zero-fills the object, so every slot starts out with sequence 0.
+	ServerStateHeader * header = (ServerStateHeader*)_sharedMemory;
+	header->version = SERVER_STATE_VERSION;
+	header->numSlots = serverOptions.numStateSlots;
+	header->maxAgents = serverOptions.maxAgents;
+	header->slotSize = (uint32_t)slotSize;
+	header->latestSequence = 0;
+	__sync_synchronize();
+	header->magic = SERVER_STATE_MAGIC;
+#endif
+}
+
+
+void ServerEngineDriver::_destroySharedMemory()
+{
+#ifndef _WIN32
+	if (_sharedMemory != NULL) {
+		munmap(_sharedMemory, _sharedMemorySize);
+		_sharedMemory = NULL;
+	}
+	if (_sharedMemoryFile >= 0) {
+		close(_sharedMemoryFile);
+		_sharedMemoryFile = -1;
+		shm_unlink(_options->serverEngineDriverOptions.sharedMemoryName.c_str());
+	}
+#endif
+}
+
+
+//
+// _createSocket() - creates the Unix domain socket that controllers connect to.
+//
+void ServerEngineDriver::_createSocket()
+{
+#ifndef _WIN32
+	const std::string & socketPath = _options->serverEngineDriverOptions.socketPath;
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		throw GenericException("ServerEngineDriver socket path \"" + socketPath + "\" is too long.");
+	}
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	_listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (_listenSocket < 0) {
+		throw GenericException("ServerEngineDriver could not create a socket: " + _errnoMessage());
+	}
+
+	// a server that crashed may have left the socket file behind.
+	unlink(socketPath.c_str());
+	if ((bind(_listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0) || (listen(_listenSocket, 1) != 0)) {
+		std::string message = _errnoMessage();
+		close(_listenSocket);
+		_listenSocket = -1;
+		throw GenericException("ServerEngineDriver could not listen on \"" + socketPath + "\": " + message);
+	}
+#endif
+}
+
+
+void ServerEngineDriver::_destroySocket()
+{
+#ifndef _WIN32
+	if (_listenSocket >= 0) {
+		close(_listenSocket);
+		_listenSocket = -1;
+		unlink(_options->serverEngineDriverOptions.socketPath.c_str());
+	}
+#endif
+}
+
+
+//
+// _serveConnection() - executes the commands of one controller, one reply line per command line.
+//
+void ServerEngineDriver::_serveConnection(int connection)
+{
+#ifndef _WIN32
+	std::string received;
+	char buffer[SERVER_MAX_COMMAND_LENGTH];
+	_closeRequested = false;
+
+	while (!_closeRequested) {
+		std::string::size_type endOfLine = received.find('\n');
+		if (endOfLine == std::string::npos) {
+			if (received.size() > SERVER_MAX_COMMAND_LENGTH) {
+				// not a controller speaking this protocol.
+				return;
+			}
+			ssize_t numBytes = recv(connection, buffer, sizeof(buffer), 0);
+			if (numBytes < 0 && errno == EINTR) {
+				continue;
+			}
+			if (numBytes <= 0) {
+				// the controller closed the connection.
+				return;
+			}
+			received.append(buffer, (size_t)numBytes);
+			continue;
+		}
+
+		std::string commandLine = received.substr(0, endOfLine);
+		received.erase(0, endOfLine + 1);
+		if (!commandLine.empty() && commandLine[commandLine.size()-1] == '\r') {
+			commandLine.erase(commandLine.size()-1);
+		}
+
+		std::string reply = executeCommand(commandLine) + "\n";
+		size_t numSent = 0;
+		while (numSent < reply.size()) {
+			ssize_t numBytes = send(connection, reply.data() + numSent, reply.size() - numSent, 0);
+			if (numBytes < 0 && errno == EINTR) {
+				continue;
+			}
+			if (numBytes <= 0) {
+				return;
+			}
+			numSent += (size_t)numBytes;
+		}
+	}
+#endif
+}
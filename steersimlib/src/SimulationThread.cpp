@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2009-2015 Glen Berseth, Mubbasir Kapadia, Shawn Singh, Petros Faloutsos, Glenn Reinman
+// See license.txt for complete license.
+//
+
+
+/// @file SimulationThread.cpp
+/// @brief Implements the SimulationThread functionality.
+
+#include <exception>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "core/SimulationThread.h"
+
+using namespace std;
+using namespace SteerLib;
+using namespace Util;
+
+
+//
+// _sleepWhilePaused() - gives up the processor for about a millisecond, so that a paused simulation does not spin.
+//
+static void _sleepWhilePaused()
+{
+#ifdef _WIN32
+	Sleep(1);
+#else
+	struct timespec t;
+	t.tv_sec = 0;
+	t.tv_nsec = 1000000;
+	nanosleep(&t, NULL);
+#endif
+}
+
+
+//
+// constructor
+//
+SimulationThread::SimulationThread(SimulationEngine * engine)
+{
+	_engine = engine;
+	_taskManager = NULL;
+	_paused = false;
+	_stopRequested = false;
+	_finished = false;
+	_numFramesToStep = 0;
+}
+
+
+SimulationThread::~SimulationThread()
+{
+	if (_taskManager != NULL) {
+		_stateLock.lock();
+		_stopRequested = true;
+		_stateLock.unlock();
+		_taskManager->waitForAllTasksToComplete();
+		delete _taskManager;
+		_taskManager = NULL;
+	}
+}
+
+
+//
+// start()
+//
+void SimulationThread::start(bool paused)
+{
+	if (_taskManager != NULL) {
+		throw GenericException("SimulationThread::start() was called while the simulation thread is already running.");
+	}
+	if (!_engine->getRenderSnapshotsEnabled()) {
+		throw GenericException("SimulationThread::start(): the engine must have render snapshots enabled.");
+	}
+
+	_paused = paused;
+	_stopRequested = false;
+	_finished = false;
+	_numFramesToStep = 0;
+	_errorMessage = "";
+
+	_taskManager = new ThreadedTaskManager(1);
+	Task task;
+	task.function = &SimulationThread::_runTask;
+	task.data = this;
+	_taskManager->addTask(task, true);
+}
+
+
+//
+// stop()
+//
+void SimulationThread::stop()
+{
+	if (_taskManager == NULL) {
+		return;
+	}
+
+	_stateLock.lock();
+	_stopRequested = true;
+	_stateLock.unlock();
+
+	_taskManager->waitForAllTasksToComplete();
+	delete _taskManager;
+	_taskManager = NULL;
+
+	if (_errorMessage != "") {
+		throw GenericException("Simulation thread stopped: " + _errorMessage);
+	}
+}
+
+
+bool SimulationThread::isFinished()
+{
+	_stateLock.lock();
+	bool finished = _finished;
+	_stateLock.unlock();
+	return finished;
+}
+
+
+void SimulationThread::setPaused(bool paused)
+{
+	_stateLock.lock();
+	_paused = paused;
+	_numFramesToStep = 0;
+	_stateLock.unlock();
+}
+
+
+bool SimulationThread::isPaused()
+{
+	_stateLock.lock();
+	bool paused = _paused;
+	_stateLock.unlock();
+	return paused;
+}
+
+
+void SimulationThread::stepOneFrame()
+{
+	_stateLock.lock();
+	_paused = true;
+	_numFramesToStep++;
+	_stateLock.unlock();
+}
+
+
+//
+// _runTask() - the task given to the Util::ThreadedTaskManager; runs until the simulation is done or stop() is called.
+//
+void SimulationThread::_runTask(unsigned int threadIndex, void * data)
+{
+	((SimulationThread*)data)->_run();
+}
+
+
+void SimulationThread::_run()
+{
+	while (true) {
+		_stateLock.lock();
+		bool stopRequested = _stopRequested;
+		bool advanceRealTimeOnly = _paused && (_numFramesToStep == 0);
+		if (!advanceRealTimeOnly && _paused) {
+			_numFramesToStep--;
+		}
+		_stateLock.unlock();
+
+		if (stopRequested) {
+			break;
+		}
+
+		bool simulationContinues = false;
+		_engineLock.lock();
+		try {
+			simulationContinues = _engine->update(advanceRealTimeOnly);
+		}
+		catch (std::exception & e) {
+			_errorMessage = e.what();
+		}
+		_engineLock.unlock();
+
+		if (!simulationContinues) {
+			_stateLock.lock();
+			_finished = true;
+			_stateLock.unlock();
+			break;
+		}
+
+		if (advanceRealTimeOnly) {
+			_sleepWhilePaused();
+		}
+	}
+}
@@ -179,6 +179,20 @@ LogData * init_steersuite(int argc, char ** argv)
 			cmd->finish();
 			std::cout << "finished command line engine driver" << std::endl;
 		}
+		else if (simulationOptions.globalOptions.engineDriver == "ensemble") {
+			EnsembleEngineDriver * driver = new EnsembleEngineDriver();
+			driver->init(&simulationOptions);
+			driver->run();
+			driver->finish();
+			delete driver;
+		}
+		else if (simulationOptions.globalOptions.engineDriver == "server") {
+			ServerEngineDriver * driver = new ServerEngineDriver();
+			driver->init(&simulationOptions);
+			driver->run();
+			driver->finish();
+			delete driver;
+		}
 		else if (simulationOptions.globalOptions.engineDriver == "glfw") {
 #ifdef ENABLE_GUI
 #ifdef ENABLE_GLFW
@@ -314,6 +328,8 @@ void initializeOptionsFromCommandLine( int argc, char **argv, SimulationOptions
 	bool qtSpecified = false;
 	bool glfwSpecified = false;
 	bool commandLineSpecified = false;
+	bool ensembleSpecified = false;
+	bool serverSpecified = false;
 	std::string engineDriverName = "";
 	std::string generateConfigFilename = "";
 
@@ -335,6 +351,8 @@ void initializeOptionsFromCommandLine( int argc, char **argv, SimulationOptions
 	opts.addOption("-GLFW", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &glfwSpecified, true);
 	opts.addOption("-commandLine", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &commandLineSpecified, true);
 	opts.addOption("-commandline", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &commandLineSpecified, true);
+	opts.addOption("-ensemble", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &ensembleSpecified, true);
+	opts.addOption("-server", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &serverSpecified, true);
 	opts.addOption("-engineDriver", &engineDriverName, OPTION_DATA_TYPE_STRING);
 	opts.addOption("-enginedriver", &engineDriverName, OPTION_DATA_TYPE_STRING);
 	opts.addOption("-generateConfig", &generateConfigFilename, OPTION_DATA_TYPE_STRING);
@@ -371,6 +389,14 @@ void initializeOptionsFromCommandLine( int argc, char **argv, SimulationOptions
 	opts.addOption( "-parameterDemo", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &simulationOptions.globalOptions.parameterDemo, true);
 	opts.addOption( "-noTweakBar", NULL, OPTION_DATA_TYPE_NO_DATA, 0, &simulationOptions.globalOptions.noTweakBar, true);
 	opts.addOption( "-dataFileName", &simulationOptions.globalOptions.dataFileName, OPTION_DATA_TYPE_STRING);
+	opts.addOption( "-ensembleRuns", &simulationOptions.ensembleEngineDriverOptions.runListFilename, OPTION_DATA_TYPE_STRING);
+	opts.addOption( "-numRuns", &simulationOptions.ensembleEngineDriverOptions.numRuns, OPTION_DATA_TYPE_UNSIGNED_INT);
+	opts.addOption( "-firstSeed", &simulationOptions.ensembleEngineDriverOptions.firstSeed, OPTION_DATA_TYPE_UNSIGNED_INT);
+	opts.addOption( "-ensembleThreads", &simulationOptions.ensembleEngineDriverOptions.numThreads, OPTION_DATA_TYPE_UNSIGNED_INT);
+	opts.addOption( "-ensembleOutput", &simulationOptions.ensembleEngineDriverOptions.outputFilename, OPTION_DATA_TYPE_STRING);
+	opts.addOption( "-serverSocket", &simulationOptions.serverEngineDriverOptions.socketPath, OPTION_DATA_TYPE_STRING);
+	opts.addOption( "-serverSharedMemory", &simulationOptions.serverEngineDriverOptions.sharedMemoryName, OPTION_DATA_TYPE_STRING);
+	opts.addOption( "-serverMaxAgents", &simulationOptions.serverEngineDriverOptions.maxAgents, OPTION_DATA_TYPE_UNSIGNED_INT);
 
 	// Dummy option parsing for the special options, but these are used earlier and ignored at this point.
 	opts.addOption("-config", NULL, OPTION_DATA_TYPE_STRING);
@@ -398,6 +424,8 @@ void initializeOptionsFromCommandLine( int argc, char **argv, SimulationOptions
 		if (engineDriverName == "qt") qtSpecified = true;
 		else if (engineDriverName == "glfw") glfwSpecified = true;
 		else if (engineDriverName == "commandline") commandLineSpecified = true;
+		else if (engineDriverName == "ensemble") ensembleSpecified = true;
+		else if (engineDriverName == "server") serverSpecified = true;
 	}
 
 	unsigned int numGUIOptionsSpecified = 0;
@@ -420,9 +448,21 @@ void initializeOptionsFromCommandLine( int argc, char **argv, SimulationOptions
 		engineDriverName = "commandline";
 	}
 
+	if (ensembleSpecified) {
+		numGUIOptionsSpecified++;
+		engineDriverName = "ensemble";
+	}
+
+	if (serverSpecified) {
+		numGUIOptionsSpecified++;
+		engineDriverName = "server";
+	}
+
 	if (numGUIOptionsSpecified > 1) {
 		throw GenericException("Multiple engine drivers were specified:"
 			+ toString(commandLineSpecified ? " commandLine" : "")
+			+ toString(ensembleSpecified ? " ensemble" : "")
+			+ toString(serverSpecified ? " server" : "")
 			+ toString(glfwSpecified ? " glfw" : "")
 			+ toString(qtSpecified ? " qt" : "")
 			+ "; Please specify only one engine driver.");
@@ -15,7 +15,8 @@
 
 
 /// Runs the specific unit test identified by its string name.
-void runUnitTest(const std::string & unitTestName);
+/// Non-empty search paths replace the engine defaults in the tests that simulate a test case.
+void runUnitTest(const std::string & unitTestName, const std::string & testCaseSearchPath = "", const std::string & moduleSearchPath = "");
 
 
 /**
@@ -63,6 +64,235 @@ public:
 	void runTest();
 };
 
+/**
+ * @brief Unit test for the frame pacing of SteerLib::Clock in real-time mode.
+ *
+ * Runs the clock at a fixed real-time frame rate with each frame pacing strategy, and reports the
+ * jitter statistics and how much of the waiting was spent spinning.  Fails if the frame rate is not
+ * kept, or if hybrid pacing does not spin much less than busy-waiting.
+ */
+class FramePacingTest
+{
+public:
+	FramePacingTest() { }
+	~FramePacingTest() { }
+	void runTest();
+protected:
+	/// Runs NUM_FRAMES frames with the given pacing, and returns the time spent spinning.
+	float _runFrames(SteerLib::Clock::FramePacingEnum framePacing, const std::string & name);
+
+	static const unsigned int NUM_FRAMES = 200;
+	static const unsigned int FRAMES_PER_SECOND = 100;
+};
+
+/**
+ * @brief Unit test for the SteerLib::HashedGridDatabase2D spatial database.
+ *
+ * Adds the same random circles to a GridDatabase2D and a HashedGridDatabase2D, and checks that their range
+ * queries and ray traces agree.  Then checks that circles far outside of the grid are still found by the hashed
+ * grid, and that its cells are released again once the circles are removed.
+ */
+class HashedGridDatabaseTest
+{
+public:
+	HashedGridDatabaseTest() { }
+	~HashedGridDatabaseTest() { }
+	void runTest();
+protected:
+	static const unsigned int NUM_CIRCLES = 300;
+	static const unsigned int NUM_QUERIES = 1000;
+};
+
+/**
+ * @brief Unit test for SteerLib::StaticObstacleGeometry on obstacles with many loops.
+ *
+ * Compiles a random GridMapObstacle, and checks that findFacingSegment() returns a segment of the blocked rectangle
+ * nearest to each query point, and that getLoopsInRange() finds exactly the rectangles that overlap each query range,
+ * by comparing with a search of all rectangles.
+ */
+class StaticObstacleGeometryTest
+{
+public:
+	StaticObstacleGeometryTest() { }
+	~StaticObstacleGeometryTest() { }
+	void runTest();
+protected:
+	static const unsigned int NUM_QUERIES = 2000;
+};
+
+/**
+ * @brief Unit test for the batch geometry functions in Geometry2D.h.
+ *
+ * Runs each batch function on random vectors and on degenerate ones (zero-length and collinear vectors, vectors whose
+ * squared length underflows or overflows, and circles that touch exactly at their boundaries), once over all vectors,
+ * which uses SSE where it is available, and once per vector, which always uses the scalar code.  Fails unless both
+ * give bitwise the same results as the single-vector functions.
+ */
+class Geometry2DTest
+{
+public:
+	Geometry2DTest() { }
+	~Geometry2DTest() { }
+	void runTest();
+protected:
+	void _compare(const std::vector<float> & expected, const std::vector<float> & batch, const std::vector<float> & scalar, const std::string & name);
+	void _testCircleOverlaps(MTRand & randomNumberGenerator);
+	static const unsigned int NUM_RANDOM_VECTORS = 1001;
+};
+
+/**
+ * @brief Unit test for compiled (binary) test cases.
+ *
+ * Writes an XML test case with every kind of agent, goal, obstacle and random region, compiles it with
+ * SteerLib::TestCaseBinaryWriter, reads the compiled file back, and checks that every header field, camera view,
+ * agent, agent emitter and obstacle is identical to the one read from the XML file.  Then does the same for a
+ * MovingAI map, which becomes a single grid map obstacle.
+ */
+class BinaryTestCaseTest
+{
+public:
+	BinaryTestCaseTest() { }
+	~BinaryTestCaseTest() { }
+	void runTest();
+protected:
+	static void _compareAgents(const SteerLib::AgentInitialConditions & xmlAgent, const SteerLib::AgentInitialConditions & binaryAgent, const std::string & agentName);
+	static void _compareObstacles(const SteerLib::ObstacleInitialConditions * xmlObstacle, const SteerLib::ObstacleInitialConditions * binaryObstacle, const std::string & obstacleName);
+};
+
+/**
+ * @brief Helpers for unit tests that simulate test cases and compare the trajectories of the agents.
+ */
+class SimulationTrajectoryTest
+{
+public:
+	/// If not empty, replaces the default test case search path of the engines; set by runUnitTest().
+	static std::string testCaseSearchPath;
+	/// If not empty, replaces the default module search path of the engines (a ':' separated list); set by runUnitTest().
+	static std::string moduleSearchPath;
+
+protected:
+	/// The position, velocity and enabled state of every agent, for every recorded frame.
+	struct AgentTrajectories {
+		std::vector<Util::Point> positions;
+		std::vector<Util::Vector> velocities;
+		std::vector<bool> enabled;
+	};
+
+	/// Creates an engine that runs the test case with the AI module; options may already hold options for the AI module.
+	SteerLib::SimulationEngine * _createEngine(SteerLib::SimulationOptions & options, const std::string & testCaseName, const std::string & aiModuleName, unsigned int numFrames);
+	void _destroyEngine(SteerLib::SimulationEngine * engine);
+	void _simulateFrames(SteerLib::SimulationEngine * engine, unsigned int numFrames, AgentTrajectories & trajectories);
+	/// Throws if any position or velocity differs by more than tolerance, or if any agent was enabled differently.
+	void _compareTrajectories(const AgentTrajectories & expected, const AgentTrajectories & actual, const std::string & name, float tolerance);
+
+	/// Does not support any controls; the test drives the engine directly.
+	class TestEngineController : public SteerLib::EngineControllerInterface
+	{
+	public:
+		bool isStartupControlSupported() { return false; }
+		bool isPausingControlSupported() { return false; }
+		bool isPaused() { return false; }
+		void loadSimulation() { }
+		void unloadSimulation() { }
+		void startSimulation() { }
+		void stopSimulation() { }
+		void pauseSimulation() { }
+		void unpauseSimulation() { }
+		void togglePausedState() { }
+		void pauseAndStepOneFrame() { }
+	};
+
+	TestEngineController _engineController;
+};
+
+/**
+ * @brief Unit test for SteerLib::SimulationSnapshot.
+ *
+ * Runs a test case with each AI module for a few frames, saves a snapshot, and records the trajectories of the
+ * following frames.  Then restores the snapshot, both from memory and from a snapshot file, and checks that re-simulating
+ * those frames gives exactly the same trajectories.  Restoring into a new engine is only checked up to rounding, because
+ * the AI modules visit neighbors in address order.  The AI modules are loaded from the default module search path, so
+ * this test should be run from the same directory as steersim, unless steertool is given -moduleSearchPath.
+ */
+class SimulationSnapshotTest : public SimulationTrajectoryTest
+{
+public:
+	SimulationSnapshotTest() { }
+	~SimulationSnapshotTest() { }
+	void runTest();
+protected:
+	void _runTest(const std::string & aiModuleName);
+	SteerLib::SimulationEngine * _createEngine(SteerLib::SimulationOptions & options, const std::string & aiModuleName);
+
+	static const unsigned int NUM_WARMUP_FRAMES = 100;
+	static const unsigned int NUM_BRANCH_FRAMES = 100;
+	static const float NEW_ENGINE_TOLERANCE;
+};
+
+/**
+ * @brief Unit test for the batch mode of the Social Forces AI module.
+ *
+ * Runs test cases with the batch_check option of the sfAI module, which compares the forces of the batch kernel with
+ * the scalar force functions on the same state every frame, and checks that no frame differs by more than TOLERANCE.
+ * The trajectories themselves are not compared: the per-agent mode updates the agents one after another, so it
+ * integrates differently from batch mode.  The sfAI module is loaded from the default module search path, so this test
+ * should be run from the same directory as steersim.
+ */
+class SocialForcesBatchTest : public SimulationTrajectoryTest
+{
+public:
+	SocialForcesBatchTest() { }
+	~SocialForcesBatchTest() { }
+	void runTest();
+protected:
+	void _runTest(const std::string & testCaseName);
+
+	static const unsigned int NUM_FRAMES = 200;
+	static const float TOLERANCE;
+};
+
+/**
+ * @brief Unit test for the batch mode of the RVO2D AI module.
+ *
+ * Runs test cases with the rvo2AI module, once with the start_of_frame option, where the module solves the agents one at a
+ * time from the state at the start of each frame, and once in batch mode on several threads.  Every velocity only depends
+ * on the start-of-frame state, so the trajectories must be identical.  The rvo2AI module is loaded from the default
+ * module search path, so this test should be run from the same directory as steersim.
+ */
+class RVO2DBatchTest : public SimulationTrajectoryTest
+{
+public:
+	RVO2DBatchTest() { }
+	~RVO2DBatchTest() { }
+	void runTest();
+protected:
+	void _runTest(const std::string & testCaseName);
+
+	static const unsigned int NUM_FRAMES = 200;
+	static const unsigned int NUM_THREADS = 4;
+};
+
+/**
+ * @brief Unit test for the neighbor queries of the RVO2D AI module.
+ *
+ * Runs small test cases with the rvo2AI module and checks that no agent overlaps another agent or an obstacle by more
+ * than MAX_PENETRATION; without agent and obstacle neighbors, ORCA walks the agents straight through each other.  The
+ * rvo2AI module is loaded from the default module search path, so this test should be run from the same directory as
+ * steersim.
+ */
+class RVO2DAvoidanceTest : public SimulationTrajectoryTest
+{
+public:
+	RVO2DAvoidanceTest() { }
+	~RVO2DAvoidanceTest() { }
+	void runTest();
+protected:
+	void _runTest(const std::string & testCaseName);
+
+	static const unsigned int MAX_FRAMES = 1000;
+	static const float MAX_PENETRATION;
+};
+
 /**
  * @brief Unit test for the helper file functions.
  */
@@ -29,11 +29,27 @@ int main(int argc, char** argv)
 		std::string validationFileName = "";
 		std::string infoFileName = "";
 		std::string testCaseSearchPath = "";
+		std::string moduleSearchPath = "";
+
+		std::string compileFileNames[2];
+		compileFileNames[0] = "";
+		compileFileNames[1] = "";
 
 		std::string endianFileNames[2];
 		endianFileNames[0] = "";
 		endianFileNames[1] = "";
 
+		std::string benchmarkPathsFileNames[2];
+		benchmarkPathsFileNames[0] = "";
+		benchmarkPathsFileNames[1] = "";
+		unsigned int maxNodesToExpand = DEFAULT_PATH_BENCHMARK_MAX_NODES;
+
+		std::string renderFileNames[2];
+		renderFileNames[0] = "";
+		renderFileNames[1] = "";
+		SteerLib::TopDownRendererOptions renderOptions;
+		unsigned int renderFrameStep = 1;
+
 		CommandLineParser opts;
 		opts.addOption("-test",     &unitTestName, OPTION_DATA_TYPE_STRING);
 		opts.addOption("-unit",     &unitTestName, OPTION_DATA_TYPE_STRING);
@@ -44,13 +60,24 @@ int main(int argc, char** argv)
 		opts.addOption("-info", &infoFileName, OPTION_DATA_TYPE_STRING);
 		opts.addOption("-swapendian", endianFileNames, OPTION_DATA_TYPE_STRING, 2);
 		opts.addOption("-swapEndian", endianFileNames, OPTION_DATA_TYPE_STRING, 2);
+		opts.addOption("-compile", compileFileNames, OPTION_DATA_TYPE_STRING, 2);
 		opts.addOption("-testcasepath", &testCaseSearchPath, OPTION_DATA_TYPE_STRING);
 		opts.addOption("-testCasePath", &testCaseSearchPath, OPTION_DATA_TYPE_STRING);
+		opts.addOption("-moduleSearchPath", &moduleSearchPath, OPTION_DATA_TYPE_STRING);
+		opts.addOption("-modulesearchpath", &moduleSearchPath, OPTION_DATA_TYPE_STRING);
+		opts.addOption("-benchmarkPaths", benchmarkPathsFileNames, OPTION_DATA_TYPE_STRING, 2);
+		opts.addOption("-maxNodes", &maxNodesToExpand, OPTION_DATA_TYPE_UNSIGNED_INT);
+		opts.addOption("-render", renderFileNames, OPTION_DATA_TYPE_STRING, 2);
+		opts.addOption("-width", &renderOptions.imageWidth, OPTION_DATA_TYPE_UNSIGNED_INT);
+		opts.addOption("-height", &renderOptions.imageHeight, OPTION_DATA_TYPE_UNSIGNED_INT);
+		opts.addOption("-frameStep", &renderFrameStep, OPTION_DATA_TYPE_UNSIGNED_INT);
+		opts.addOption("-threads", &renderOptions.numThreads, OPTION_DATA_TYPE_UNSIGNED_INT);
+		opts.addOption("-trail", &renderOptions.trailLength, OPTION_DATA_TYPE_UNSIGNED_INT);
 
 		opts.parse(argc, argv, true, true);
 		
 		if (unitTestName != "") {
-			runUnitTest(unitTestName);
+			runUnitTest(unitTestName, testCaseSearchPath, moduleSearchPath);
 		}
 		else if (validationFileName != "") {
 			throw GenericException("Validating rec files is not implemented yet.");
@@ -67,7 +94,7 @@ int main(int argc, char** argv)
 				std::cout << "   Number of agents: " << recFile.getNumAgents() << "\n";
 				std::cout << "Number of obstacles: " << recFile.getNumObstacles() << "\n";
 			}
-			else if (endsWith(infoFileName, ".xml")) {
+			else if (endsWith(infoFileName, ".xml") || SteerLib::TestCaseReader::isAValidBinaryTestCase(infoFileName)) {
 				SteerLib::TestCaseReader testCase;
 				testCase.readTestCaseFromFile(infoFileName);
 				std::cout << "           filename: " << basename(infoFileName,"") << "\n";
@@ -85,16 +112,52 @@ int main(int argc, char** argv)
 			}
 
 
+		}
+		else if (compileFileNames[0] != "") {
+			SteerLib::TestCaseReader testCase;
+			testCase.readTestCaseFromFile(compileFileNames[0]);
+			SteerLib::TestCaseBinaryWriter writer;
+			writer.writeBinaryTestCase(compileFileNames[1], testCase, compileFileNames[0]);
+			std::cout << "compiled " << compileFileNames[0] << " into " << compileFileNames[1] << " (" << testCase.getNumAgents() << " agents, " << testCase.getNumObstacles() << " obstacles)\n";
+		}
+		else if (benchmarkPathsFileNames[0] != "") {
+			// the grid A* searches a grid database with one grid cell per map cell.  Planners that need the engine,
+			// such as the navigation mesh, are benchmarked by the pathPlanningBenchmark module of steersim instead.
+			GridMapObstacle * map = MovingAIReader::readMap(benchmarkPathsFileNames[0]);
+			std::vector<MovingAIScenarioEntry> entries;
+			MovingAIReader::readScenario(benchmarkPathsFileNames[1], entries);
+			GridDatabase2D * grid = PathPlanningBenchmark::createGridDatabaseForMap(map);
+			GridDatabasePlanningDomain gridDomain(grid, NULL);
+
+			PathPlanningBenchmark benchmark(map, entries);
+			PathPlanningBenchmarkResults results;
+			benchmark.run("gridDomain", &gridDomain, maxNodesToExpand, results);
+			std::cout << "                 map: " << basename(benchmarkPathsFileNames[0],"") << " (" << map->getNumCellsX() << "x" << map->getNumCellsZ() << ")\n";
+			PathPlanningBenchmark::printResults(std::cout, results);
+
+			delete grid;
+			delete map;
+		}
+		else if (renderFileNames[0] != "") {
+			SteerLib::RecFileReader recFile(renderFileNames[0]);
+			SteerLib::TopDownRenderer renderer(renderOptions);
+			unsigned long long startTicks = getHighResCounterValue();
+			unsigned int numFramesWritten = renderer.renderRecFile(recFile, renderFileNames[1], renderFrameStep);
+			float seconds = (float)(getHighResCounterValue() - startTicks) / (float)getHighResCounterFrequency();
+			std::cout << "rendered " << numFramesWritten << " frames of " << basename(renderFileNames[0],"") << " to " << renderFileNames[1] << "NNNNN.png in " << seconds << " seconds\n";
 		}
 		else if (endianFileNames[0] != "") {
 			throw GenericException("Swapping endian-ness is not implemented yet.");
 		}
 		else {
 			throw GenericException(std::string("Please specify an action for SteerTool.\nPossible actions include:\n")
-				+ std::string("    -test <testName> - performs a hard-coded unit test\n")
+				+ std::string("    -test <testName> [-testCasePath <dir>] [-moduleSearchPath <dirs>] - performs a hard-coded unit test\n")
 				+ std::string("    -validate <filename> - validates a recording against the corresponding XML test case\n")
 				+ std::string("    -info <filename> - outputs human-readable information of the recording or XML test case\n")
-				+ std::string("    -swapendian <inputFilename> <outputFilename> - changes the endian-ness of a rec file\n"));
+				+ std::string("    -swapendian <inputFilename> <outputFilename> - changes the endian-ness of a rec file\n")
+				+ std::string("    -compile <testcase.xml> <outputFilename> - compiles an XML test case into a binary test case (" + std::string(SteerLib::TESTCASE_BINARY_EXTENSION) + ") that loads much faster\n")
+				+ std::string("    -benchmarkPaths <map file> <scen file> [-maxNodes <n>] - plans the queries of a MovingAI scenario with the grid A* and reports queries/sec, nodes expanded, memory, and suboptimality\n")
+				+ std::string("    -render <recfile> <outputPrefix> [-width <w>] [-height <h>] [-frameStep <n>] [-threads <n>] [-trail <frames>] - renders top-down PNG frames of a recording without openGL\n"));
 		}
 
 	}
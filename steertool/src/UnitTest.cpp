@@ -9,8 +9,13 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 #include "UnitTest.h"
+#include "mersenne/MersenneTwister.h"
 
 using namespace SteerLib;
 using namespace Util;
@@ -18,8 +23,11 @@ using namespace std;
 
 
 
-void runUnitTest(const std::string & unitTestName)
+void runUnitTest(const std::string & unitTestName, const std::string & testCaseSearchPath, const std::string & moduleSearchPath)
 {
+	SimulationTrajectoryTest::testCaseSearchPath = testCaseSearchPath;
+	SimulationTrajectoryTest::moduleSearchPath = moduleSearchPath;
+
 	std::string caseInsensitiveTestName = unitTestName;
 	std::transform(caseInsensitiveTestName.begin(), caseInsensitiveTestName.end(), caseInsensitiveTestName.begin(), (int(*)(int))tolower);
 	if (caseInsensitiveTestName == "threadpool") {
@@ -30,6 +38,42 @@ void runUnitTest(const std::string & unitTestName)
 		TimingTest timingTest;
 		timingTest.runTest();
 	}
+	else if (caseInsensitiveTestName == "framepacing") {
+		FramePacingTest framePacingTest;
+		framePacingTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "hashedgrid") {
+		HashedGridDatabaseTest hashedGridTest;
+		hashedGridTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "staticgeometry") {
+		StaticObstacleGeometryTest staticGeometryTest;
+		staticGeometryTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "geometry2d") {
+		Geometry2DTest geometry2DTest;
+		geometry2DTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "binarytestcase") {
+		BinaryTestCaseTest binaryTestCaseTest;
+		binaryTestCaseTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "snapshot") {
+		SimulationSnapshotTest snapshotTest;
+		snapshotTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "sfbatch") {
+		SocialForcesBatchTest socialForcesBatchTest;
+		socialForcesBatchTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "rvobatch") {
+		RVO2DBatchTest rvoBatchTest;
+		rvoBatchTest.runTest();
+	}
+	else if (caseInsensitiveTestName == "rvoavoidance") {
+		RVO2DAvoidanceTest rvoAvoidanceTest;
+		rvoAvoidanceTest.runTest();
+	}
 	else if (caseInsensitiveTestName == "fileutil") {
 		FileUtilTest fileTest;
 		fileTest.runTest();
@@ -262,6 +306,852 @@ void TimingTest::runTest()
 	/// @todo fill in the rest of the timing test unit test
 }
 
+
+void FramePacingTest::runTest()
+{
+	float busyWaitSpinTime = _runFrames(Clock::FRAME_PACING_BUSY_WAIT, "busy-wait");
+	_runFrames(Clock::FRAME_PACING_SLEEP, "sleep");
+	float hybridSpinTime = _runFrames(Clock::FRAME_PACING_HYBRID, "hybrid");
+
+	// the hybrid pacing only spins for the last 2 ms of each 10 ms frame.
+	if (hybridSpinTime > 0.5f * busyWaitSpinTime) {
+		throw GenericException("FAILED: hybrid frame pacing spun for " + toString(hybridSpinTime) + " seconds, busy-waiting spun for " + toString(busyWaitSpinTime) + " seconds.");
+	}
+}
+
+
+float FramePacingTest::_runFrames(Clock::FramePacingEnum framePacing, const std::string & name)
+{
+	float frameTime = 1.0f / (float)FRAMES_PER_SECOND;
+	Clock clock(Clock::CLOCK_MODE_FIXED_REAL_TIME, (float)FRAMES_PER_SECOND, 0.01f, 0.1f);
+	clock.setFramePacing(framePacing, 0.002f);
+	clock.reset();
+
+	clock.advanceSimulationAndUpdateRealTime();
+	clock.resetPacingStatistics();
+	float startTime = clock.getCurrentRealTime();
+	for (unsigned int i=0; i < NUM_FRAMES; i++) {
+		clock.advanceSimulationAndUpdateRealTime();
+	}
+	float meanFrameTime = (clock.getCurrentRealTime() - startTime) / (float)NUM_FRAMES;
+
+	std::cout << name << " frame pacing, " << NUM_FRAMES << " frames at " << FRAMES_PER_SECOND << " fps:\n";
+	std::cout << "   mean frame time:           " << meanFrameTime * 1000.0f << " ms\n";
+	std::cout << "   mean lateness:             " << clock.getMeanPacingLateness() * 1000000.0f << " us\n";
+	std::cout << "   lateness std deviation:    " << clock.getPacingLatenessStandardDeviation() * 1000000.0f << " us\n";
+	std::cout << "   max lateness:              " << clock.getMaxPacingLateness() * 1000000.0f << " us\n";
+	std::cout << "   time spent sleeping:       " << clock.getTotalPacingSleepTime() << " s\n";
+	std::cout << "   time spent spinning:       " << clock.getTotalPacingSpinTime() << " s\n";
+
+	if (clock.getNumPacedFrames() != NUM_FRAMES) {
+		throw GenericException("FAILED: " + toString(clock.getNumPacedFrames()) + " of " + toString((unsigned int)NUM_FRAMES) + " frames waited for their deadline with " + name + " frame pacing.");
+	}
+	// each deadline is one frame after the previous frame started, so the lateness adds to the frame time.
+	if ((meanFrameTime < frameTime) || (meanFrameTime > 1.1f * frameTime)) {
+		throw GenericException("FAILED: the mean frame time was " + toString(meanFrameTime) + " seconds with " + name + " frame pacing, expected " + toString(frameTime) + " seconds.");
+	}
+	return clock.getTotalPacingSpinTime();
+}
+
+void HashedGridDatabaseTest::runTest()
+{
+	MTRand randomNumberGenerator(7);
+	GridDatabase2D grid(-50.0f, 50.0f, -50.0f, 50.0f, 100, 100, 15, false);
+	HashedGridDatabase2D hashedGrid(-50.0f, 50.0f, -50.0f, 50.0f, 100, 100, false);
+
+	std::vector<CircleObstacle*> circles;
+	for (unsigned int i=0; i < NUM_CIRCLES; i++) {
+		Point center(-45.0f + (float)randomNumberGenerator.rand(90.0), 0.0f, -45.0f + (float)randomNumberGenerator.rand(90.0));
+		CircleObstacle * circle = new CircleObstacle(center, 0.2f + (float)randomNumberGenerator.rand(0.8), 0.0f, 1.0f);
+		circles.push_back(circle);
+		grid.addObject(circle, circle->getBounds());
+		hashedGrid.addObject(circle, circle->getBounds());
+	}
+
+	// both databases may return circles slightly outside of the range, so only the circles whose bounds overlap it are compared.
+	for (unsigned int i=0; i < NUM_QUERIES; i++) {
+		float xmin = -50.0f + (float)randomNumberGenerator.rand(95.0);
+		float zmin = -50.0f + (float)randomNumberGenerator.rand(95.0);
+		float xmax = xmin + (float)randomNumberGenerator.rand(10.0);
+		float zmax = zmin + (float)randomNumberGenerator.rand(10.0);
+		std::set<SpatialDatabaseItemPtr> gridItems, hashedGridItems;
+		grid.getItemsInRange(gridItems, xmin, xmax, zmin, zmax, NULL);
+		hashedGrid.getItemsInRange(hashedGridItems, xmin, xmax, zmin, zmax, NULL);
+		for (unsigned int j=0; j < circles.size(); j++) {
+			const AxisAlignedBox & bounds = circles[j]->getBounds();
+			if ((bounds.xmax < xmin) || (bounds.xmin > xmax) || (bounds.zmax < zmin) || (bounds.zmin > zmax)) continue;
+			if ((gridItems.count(circles[j]) == 0) || (hashedGridItems.count(circles[j]) == 0)) {
+				throw GenericException("FAILED: circle " + toString(j) + " overlaps the range query " + toString(i) + ", but the grid found it " + toString(gridItems.count(circles[j])) + " times and the hashed grid " + toString(hashedGridItems.count(circles[j])) + " times.");
+			}
+		}
+
+		Point start(-45.0f + (float)randomNumberGenerator.rand(90.0), 0.5f, -45.0f + (float)randomNumberGenerator.rand(90.0));
+		Point end(-45.0f + (float)randomNumberGenerator.rand(90.0), 0.5f, -45.0f + (float)randomNumberGenerator.rand(90.0));
+		Ray r;
+		r.initWithUnitInterval(start, end - start);
+		float gridT = 0.0f, hashedGridT = 0.0f;
+		SpatialDatabaseItemPtr gridHit = NULL, hashedGridHit = NULL;
+		bool gridFoundHit = grid.trace(r, gridT, gridHit, NULL, false);
+		bool hashedGridFoundHit = hashedGrid.trace(r, hashedGridT, hashedGridHit, NULL, false);
+		if ((gridFoundHit != hashedGridFoundHit) || (gridFoundHit && (fabsf(gridT - hashedGridT) > 0.0001f))) {
+			throw GenericException("FAILED: ray " + toString(i) + " from " + toString(start) + " to " + toString(end) + " hit at t=" + toString(gridT) + " (" + toString(gridFoundHit) + ") in the grid, and at t=" + toString(hashedGridT) + " (" + toString(hashedGridFoundHit) + ") in the hashed grid.");
+		}
+		if (grid.hasLineOfSight(r, NULL, NULL) != hashedGrid.hasLineOfSight(r, NULL, NULL)) {
+			throw GenericException("FAILED: the grid and the hashed grid disagree on the line of sight of ray " + toString(i) + ".");
+		}
+	}
+
+	std::cout << NUM_CIRCLES << " circles in a 100x100 window: " << hashedGrid.getNumAllocatedCells() << " cells allocated, "
+		<< hashedGrid.getMemoryUsage() << " bytes (grid: " << grid.getMemoryUsage() << " bytes)\n";
+
+	for (unsigned int i=0; i < circles.size(); i++) {
+		hashedGrid.removeObject(circles[i], circles[i]->getBounds());
+	}
+	std::cout << "after removing all circles: " << hashedGrid.getNumAllocatedCells() << " cells allocated, " << hashedGrid.getMemoryUsage() << " bytes\n";
+	if (hashedGrid.getNumAllocatedCells() >= 64) {
+		throw GenericException("FAILED: " + toString(hashedGrid.getNumAllocatedCells()) + " empty cells were not released.");
+	}
+
+	// the grid would not see this circle at all.
+	CircleObstacle * farCircle = new CircleObstacle(Point(600.0f, 0.0f, -800.0f), 1.0f, 0.0f, 1.0f);
+	circles.push_back(farCircle);
+	hashedGrid.addObject(farCircle, farCircle->getBounds());
+	if (hashedGrid.getCellIndexFromLocation(farCircle->position()) != -1) {
+		throw GenericException("FAILED: a location outside of the window has the cell index " + toString(hashedGrid.getCellIndexFromLocation(farCircle->position())) + ".");
+	}
+	std::set<SpatialDatabaseItemPtr> farItems;
+	hashedGrid.getItemsInRange(farItems, 595.0f, 605.0f, -805.0f, -795.0f, NULL);
+	if ((farItems.size() != 1) || (farItems.count(farCircle) != 1)) {
+		throw GenericException("FAILED: the range query around the circle outside of the window found " + toString(farItems.size()) + " items.");
+	}
+	Ray farRay;
+	farRay.initWithUnitInterval(Point(580.0f, 0.0f, -800.0f), Vector(40.0f, 0.0f, 0.0f));
+	float farT = 0.0f;
+	SpatialDatabaseItemPtr farHit = NULL;
+	if (!hashedGrid.trace(farRay, farT, farHit, NULL, false) || (farHit != farCircle) || (fabsf(farT - 19.0f / 40.0f) > 0.0001f)) {
+		throw GenericException("FAILED: the ray towards the circle outside of the window hit at t=" + toString(farT) + ".");
+	}
+	// a ray that starts inside the window and ends outside of it.
+	farRay.initWithUnitInterval(Point(0.0f, 0.0f, 0.0f), Vector(600.0f, 0.0f, -800.0f));
+	if (hashedGrid.hasLineOfSight(farRay, NULL, NULL) || !hashedGrid.hasLineOfSight(farRay, farCircle, NULL)) {
+		throw GenericException("FAILED: the circle outside of the window did not block the line of sight.");
+	}
+	hashedGrid.removeObject(farCircle, farCircle->getBounds());
+
+	for (unsigned int i=0; i < circles.size(); i++) {
+		delete circles[i];
+	}
+}
+
+void StaticObstacleGeometryTest::runTest()
+{
+	MTRand randomNumberGenerator(3);
+	GridMapObstacle map(-50.0f, -50.0f, 1.0f, 100, 100);
+	for (unsigned int x=0; x < map.getNumCellsX(); x++) {
+		for (unsigned int z=0; z < map.getNumCellsZ(); z++) {
+			// scattered cells, and a few long walls that become long rectangles.
+			if ((randomNumberGenerator.rand() < 0.1) || ((z % 25 == 0) && (x % 40 != 0))) {
+				map.setBlocked(x, z, true);
+			}
+		}
+	}
+
+	StaticObstacleGeometry geometry;
+	geometry.addObstacle(&map);
+	const StaticObstacleGeometry::CompiledObstacle * compiled = geometry.getCompiledObstacle(&map);
+	const std::vector<StaticObstacleGeometry::Loop> & loops = geometry.getLoops();
+	if ((compiled == NULL) || (compiled->numLoops < 100)) {
+		throw GenericException("FAILED: the grid map was not compiled into separate loops.");
+	}
+
+	for (unsigned int i=0; i < NUM_QUERIES; i++) {
+		Point p(-60.0f + (float)randomNumberGenerator.rand(120.0), 0.0f, -60.0f + (float)randomNumberGenerator.rand(120.0));
+
+		// the rectangles are disjoint, so the distance to the nearest one is the distance to its bounds.
+		float nearestDistance = FLT_MAX;
+		for (unsigned int l = compiled->firstLoop; l < compiled->firstLoop + compiled->numLoops; l++) {
+			const AxisAlignedBox & bounds = loops[l].bounds;
+			float dx = std::max(0.0f, std::max(bounds.xmin - p.x, p.x - bounds.xmax));
+			float dz = std::max(0.0f, std::max(bounds.zmin - p.z, p.z - bounds.zmax));
+			nearestDistance = std::min(nearestDistance, sqrtf(dx*dx + dz*dz));
+		}
+
+		const StaticObstacleGeometry::Segment * face = geometry.findFacingSegment(&map, p);
+		if (face == NULL) {
+			throw GenericException("FAILED: no facing segment was found for " + toString(p) + ".");
+		}
+		unsigned int faceIndex = (unsigned int)(face - &geometry.getSegments()[0]);
+		for (unsigned int l = compiled->firstLoop; l < compiled->firstLoop + compiled->numLoops; l++) {
+			if ((faceIndex < loops[l].firstSegment) || (faceIndex >= loops[l].firstSegment + loops[l].numSegments)) continue;
+			const AxisAlignedBox & bounds = loops[l].bounds;
+			float dx = std::max(0.0f, std::max(bounds.xmin - p.x, p.x - bounds.xmax));
+			float dz = std::max(0.0f, std::max(bounds.zmin - p.z, p.z - bounds.zmax));
+			if (fabsf(sqrtf(dx*dx + dz*dz) - nearestDistance) > 0.0001f) {
+				throw GenericException("FAILED: the facing segment for " + toString(p) + " belongs to a rectangle " + toString(sqrtf(dx*dx + dz*dz)) + " away, but the nearest rectangle is " + toString(nearestDistance) + " away.");
+			}
+			for (unsigned int s = loops[l].firstSegment; s < loops[l].firstSegment + loops[l].numSegments; s++) {
+				if (StaticObstacleGeometry::signedDistance(geometry.getSegments()[s], p) > StaticObstacleGeometry::signedDistance(*face, p)) {
+					throw GenericException("FAILED: the facing segment for " + toString(p) + " is not the segment of its rectangle that faces the point.");
+				}
+			}
+		}
+
+		float xmin = p.x - (float)randomNumberGenerator.rand(5.0);
+		float xmax = p.x + (float)randomNumberGenerator.rand(5.0);
+		float zmin = p.z - (float)randomNumberGenerator.rand(5.0);
+		float zmax = p.z + (float)randomNumberGenerator.rand(5.0);
+		std::vector<unsigned int> loopsInRange, expectedLoops;
+		geometry.getLoopsInRange(&map, xmin, xmax, zmin, zmax, loopsInRange);
+		for (unsigned int l = compiled->firstLoop; l < compiled->firstLoop + compiled->numLoops; l++) {
+			const AxisAlignedBox & bounds = loops[l].bounds;
+			if ((bounds.xmin <= xmax) && (bounds.xmax >= xmin) && (bounds.zmin <= zmax) && (bounds.zmax >= zmin)) {
+				expectedLoops.push_back(l);
+			}
+		}
+		if (loopsInRange != expectedLoops) {
+			throw GenericException("FAILED: the range query " + toString(i) + " found " + toString(loopsInRange.size()) + " rectangles, expected " + toString(expectedLoops.size()) + ".");
+		}
+	}
+
+	std::cout << map.getNumBlockedCells() << " blocked cells compiled into " << compiled->numLoops << " rectangles.\n";
+}
+
+//
+// sameResult() - returns true if two results are bitwise equal, or are both NaN.
+//
+static bool sameResult(float a, float b)
+{
+	return (memcmp(&a, &b, sizeof(float)) == 0) || ((a != a) && (b != b));
+}
+
+void Geometry2DTest::runTest()
+{
+	// degenerate pairs first: collinear vectors pointing the same way and opposite ways, zero-length vectors
+	// (including -0), vectors whose squared length underflows or overflows, and perpendicular vectors.
+	const float pairs[][4] = {
+		{ 1.0f, 2.0f, -2.0f, -4.0f },
+		{ 3.0f, 6.0f, 1.0f, 2.0f },
+		{ -1.5f, 0.0f, 4.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 0.0f },
+		{ -0.0f, 0.0f, 5.0f, -1.0f },
+		{ 1e-30f, -1e-30f, 1e-30f, 1e-30f },
+		{ 1e30f, 1e30f, -1e30f, 2e30f },
+		{ 3.0f, 4.0f, -4.0f, 3.0f }
+	};
+	const unsigned int numPairs = sizeof(pairs) / sizeof(pairs[0]);
+
+	MTRand randomNumberGenerator(5);
+	Vector2DArray vecs1, vecs2;
+	for (unsigned int i=0; i < numPairs; i++) {
+		vecs1.push_back(Vector2D(pairs[i][0], pairs[i][1]));
+		vecs2.push_back(Vector2D(pairs[i][2], pairs[i][3]));
+	}
+	for (unsigned int i=0; i < NUM_RANDOM_VECTORS; i++) {
+		Vector2D vec(-10.0f + (float)randomNumberGenerator.rand(20.0), -10.0f + (float)randomNumberGenerator.rand(20.0));
+		vecs1.push_back(vec);
+		if (i % 4 == 0) {
+			vecs2.push_back(vec * (-2.0f + (float)randomNumberGenerator.rand(4.0)));
+		}
+		else {
+			vecs2.push_back(Vector2D(-10.0f + (float)randomNumberGenerator.rand(20.0), -10.0f + (float)randomNumberGenerator.rand(20.0)));
+		}
+	}
+
+	// each function runs once over all vectors, which uses SSE where it is available (except for the last n % 4
+	// vectors), and once per vector, which always uses the scalar code.  Normalizing and rotating run in place.
+	size_t n = vecs1.size();
+	const float * x1 = vecs1.getX();
+	const float * z1 = vecs1.getZ();
+	const float * x2 = vecs2.getX();
+	const float * z2 = vecs2.getZ();
+	std::vector<float> expectedX(n), expectedZ(n), batchX(x1, x1 + n), batchZ(z1, z1 + n), scalarX(n), scalarZ(n);
+
+	for (size_t i=0; i < n; i++) {
+		Vector2D vec = normalize(vecs1.get(i));
+		expectedX[i] = vec.x;
+		expectedZ[i] = vec.z;
+		normalize2D(x1 + i, z1 + i, &scalarX[i], &scalarZ[i], 1);
+	}
+	normalize2D(&batchX[0], &batchZ[0], &batchX[0], &batchZ[0], n);
+	_compare(expectedX, batchX, scalarX, "normalize2D() x");
+	_compare(expectedZ, batchZ, scalarZ, "normalize2D() z");
+
+	batchX.assign(x1, x1 + n);
+	batchZ.assign(z1, z1 + n);
+	for (size_t i=0; i < n; i++) {
+		Vector2D vec = rightSideInXZPlane(vecs1.get(i));
+		expectedX[i] = vec.x;
+		expectedZ[i] = vec.z;
+		rightSideInXZPlane2D(x1 + i, z1 + i, &scalarX[i], &scalarZ[i], 1);
+	}
+	rightSideInXZPlane2D(&batchX[0], &batchZ[0], &batchX[0], &batchZ[0], n);
+	_compare(expectedX, batchX, scalarX, "rightSideInXZPlane2D() x");
+	_compare(expectedZ, batchZ, scalarZ, "rightSideInXZPlane2D() z");
+
+	for (size_t i=0; i < n; i++) {
+		expectedX[i] = vecs1.get(i).length();
+		length2D(x1 + i, z1 + i, &scalarX[i], 1);
+	}
+	length2D(vecs1, &batchX[0]);
+	_compare(expectedX, batchX, scalarX, "length2D()");
+
+	for (size_t i=0; i < n; i++) {
+		expectedX[i] = dot(vecs1.get(i), vecs2.get(i));
+		dot2D(x1 + i, z1 + i, x2 + i, z2 + i, &scalarX[i], 1);
+	}
+	dot2D(x1, z1, x2, z2, &batchX[0], n);
+	_compare(expectedX, batchX, scalarX, "dot2D()");
+
+	_testCircleOverlaps(randomNumberGenerator);
+
+#ifdef __SSE2__
+	std::cout << "Compared the SSE and scalar paths on " << n << " vectors.\n";
+#else
+	std::cout << "Compared the batch and scalar paths on " << n << " vectors (SSE2 is not enabled in this build).\n";
+#endif
+}
+
+void Geometry2DTest::_testCircleOverlaps(MTRand & randomNumberGenerator)
+{
+	// circles exactly on the boundary of the query circle (the distance between the centers is exactly the sum of the
+	// radii, including circles of radius 0) do not overlap it; the last two circles are just inside it.
+	const Vector2D center(0.5f, -1.5f);
+	const float radius = 2.0f;
+	const float touching[][3] = {
+		{ 3.0f, 4.0f, 3.0f },
+		{ -5.0f, 0.0f, 3.0f },
+		{ 0.0f, 2.0f, 0.0f },
+		{ 6.0f, -8.0f, 8.0f },
+		{ 3.0f, 4.0f, 3.001f },
+		{ 0.0f, 0.0f, 0.0f }
+	};
+	const unsigned int numTouching = sizeof(touching) / sizeof(touching[0]);
+
+	Vector2DArray circles;
+	std::vector<float> radii;
+	for (unsigned int i=0; i < numTouching; i++) {
+		circles.push_back(center + Vector2D(touching[i][0], touching[i][1]));
+		radii.push_back(touching[i][2]);
+	}
+	for (unsigned int i=0; i < NUM_RANDOM_VECTORS; i++) {
+		circles.push_back(Vector2D(-10.0f + (float)randomNumberGenerator.rand(20.0), -10.0f + (float)randomNumberGenerator.rand(20.0)));
+		radii.push_back((float)randomNumberGenerator.rand(3.0));
+	}
+
+	size_t n = circles.size();
+	std::vector<unsigned char> batchOverlaps(n), scalarOverlaps(n);
+	size_t numBatchOverlaps = circleOverlapsCircle2D(center, radius, circles.getX(), circles.getZ(), &radii[0], &batchOverlaps[0], n);
+	size_t numExpectedOverlaps = 0;
+	for (size_t i=0; i < n; i++) {
+		unsigned char expected = circleOverlapsCircle2D(center, radius, circles.get(i), radii[i]) ? 1 : 0;
+		circleOverlapsCircle2D(center, radius, circles.getX() + i, circles.getZ() + i, &radii[i], &scalarOverlaps[i], 1);
+		if ((batchOverlaps[i] != expected) || (scalarOverlaps[i] != expected)) {
+			throw GenericException("FAILED: circleOverlapsCircle2D() of circle " + toString(i) + " is " + toString((int)batchOverlaps[i]) + " on the batch path and " + toString((int)scalarOverlaps[i]) + " on the scalar path, expected " + toString((int)expected) + ".");
+		}
+		if ((i < numTouching) && (expected != ((i + 2 >= numTouching) ? 1 : 0))) {
+			throw GenericException("FAILED: circle " + toString(i) + " on the boundary of the query circle is classified as " + toString((int)expected) + " by the single-circle function.");
+		}
+		numExpectedOverlaps += expected;
+	}
+	if (numBatchOverlaps != numExpectedOverlaps) {
+		throw GenericException("FAILED: circleOverlapsCircle2D() counted " + toString(numBatchOverlaps) + " overlaps, expected " + toString(numExpectedOverlaps) + ".");
+	}
+}
+
+void Geometry2DTest::_compare(const std::vector<float> & expected, const std::vector<float> & batch, const std::vector<float> & scalar, const std::string & name)
+{
+	for (unsigned int i=0; i < expected.size(); i++) {
+		if (!sameResult(batch[i], expected[i])) {
+			throw GenericException("FAILED: " + name + " of vector " + toString(i) + " is " + toString(batch[i]) + " on the batch path, expected " + toString(expected[i]) + ".");
+		}
+		if (!sameResult(scalar[i], expected[i])) {
+			throw GenericException("FAILED: " + name + " of vector " + toString(i) + " is " + toString(scalar[i]) + " on the scalar path, expected " + toString(expected[i]) + ".");
+		}
+	}
+}
+
+void BinaryTestCaseTest::runTest()
+{
+	const std::string xmlFilename = "binarytestcase-unittest.xml";
+	const std::string binaryFilename = "binarytestcase-unittest.bin";
+
+	std::ofstream xmlFile(xmlFilename.c_str());
+	xmlFile <<
+		"<SteerBenchTestCase xmlns=\"http://www.magix.ucla.edu/steerbench\">\n"
+		"  <header>\n"
+		"    <version>1.0</version>\n"
+		"    <name>binary-round-trip</name>\n"
+		"    <description>every kind of agent, goal, obstacle and region</description>\n"
+		"    <worldBounds> <xmin>-50</xmin> <xmax>50</xmax> <ymin>0</ymin> <ymax>0</ymax> <zmin>-50</zmin> <zmax>50</zmax> </worldBounds>\n"
+		"  </header>\n"
+		"  <suggestedCameraView>\n"
+		"    <position> <x>0</x> <y>35</y> <z>-10</z> </position> <lookat> <x>1</x> <y>0</y> <z>2</z> </lookat> <up> <x>0</x> <y>1</y> <z>0</z> </up> <fovy>45</fovy>\n"
+		"  </suggestedCameraView>\n"
+		"  <obstacle> <xmin>-20</xmin> <xmax>20</xmax> <ymin>0</ymin> <ymax>1</ymax> <zmin>1.25</zmin> <zmax>3</zmax> </obstacle>\n"
+		"  <circleObstacle> <radius>1.5</radius> <height>1</height> <position> <x>5</x> <y>0</y> <z>15</z> </position> </circleObstacle>\n"
+		"  <orientedBoxObstacle> <thetaY>20</thetaY> <size> <x>2</x> <y>1</y> <z>3</z> </size> <position> <x>-10</x> <y>0</y> <z>20</z> </position> </orientedBoxObstacle>\n"
+		"  <orientedWallObstacle> <thetaY>0</thetaY> <size> <x>10</x> <y>1</y> <z>0.5</z> </size> <position> <x>30</x> <y>0</y> <z>-30</z> </position>\n"
+		"    <doorway> <value>0.3</value> <doorRadius>1.2</doorRadius> </doorway> </orientedWallObstacle>\n"
+		"  <polygonObstacle> <vertex> <x>-30</x> <y>0</y> <z>-30</z> </vertex> <vertex> <x>-25</x> <y>0</y> <z>-30</z> </vertex> <vertex> <x>-27</x> <y>0</y> <z>-24</z> </vertex> </polygonObstacle>\n"
+		"  <obstacleRegion> <numObstacles>5</numObstacles> <obstacleSize>2.0</obstacleSize> <obstacleHeight>0.2</obstacleHeight>\n"
+		"    <regionBounds> <xmin>-40</xmin> <xmax>40</xmax> <ymin>0</ymin> <ymax>1</ymax> <zmin>-45</zmin> <zmax>-35</zmax> </regionBounds> </obstacleRegion>\n"
+		"  <agent>\n"
+		"    <name>A</name>\n"
+		"    <initialConditions> <radius>0.5</radius> <position> <x>-5</x> <y>0</y> <z>-5</z> </position> <direction> <x>1</x> <y>0</y> <z>0</z> </direction> <speed>0.5</speed>\n"
+		"      <color> <r>0.2</r> <g>0.4</g> <b>0.6</b> </color> </initialConditions>\n"
+		"    <goalSequence>\n"
+		"      <seekStaticTarget> <targetLocation> <x>10</x> <y>0</y> <z>-5</z> </targetLocation> <desiredSpeed>1.3</desiredSpeed> <timeDuration>1000.0</timeDuration>\n"
+		"        <Behaviour> <SteeringAlgorithm>pprAI</SteeringAlgorithm> <Parameters> <parameter> <key>max_speed</key> <value>4.73</value> </parameter> </Parameters> </Behaviour>\n"
+		"      </seekStaticTarget>\n"
+		"      <seekAxisAlignedBoxRegion> <targetLocation> <x>20</x> <y>0</y> <z>-5</z> </targetLocation> <desiredSpeed>1.1</desiredSpeed> <timeDuration>500.0</timeDuration>\n"
+		"        <goalRegionBounds> <xmin>18</xmin> <xmax>22</xmax> <ymin>0</ymin> <ymax>0</ymax> <zmin>-7</zmin> <zmax>-3</zmax> </goalRegionBounds> </seekAxisAlignedBoxRegion>\n"
+		"      <seekDynamicTarget> <targetName>B</targetName> <desiredSpeed>1.2</desiredSpeed> <timeDuration>100.0</timeDuration> </seekDynamicTarget>\n"
+		"      <flowStaticDirection> <targetDirection> <x>0</x> <y>0</y> <z>1</z> </targetDirection> <desiredSpeed>1.0</desiredSpeed> <timeDuration>10.0</timeDuration> </flowStaticDirection>\n"
+		"      <idle> <targetLocation> <random>true</random> </targetLocation> <timeDuration>5.0</timeDuration> </idle>\n"
+		"    </goalSequence>\n"
+		"  </agent>\n"
+		"  <agent>\n"
+		"    <name>B</name>\n"
+		"    <initialConditions> <radius>0.4</radius> <position> <random>true</random> </position> <direction> <random>true</random> </direction> <speed>0</speed> </initialConditions>\n"
+		"    <goalSequence> <seekStaticTarget> <targetLocation> <random>true</random> </targetLocation> <desiredSpeed>1.3</desiredSpeed> <timeDuration>1000.0</timeDuration> </seekStaticTarget> </goalSequence>\n"
+		"  </agent>\n"
+		"  <agentEmitter>\n"
+		"    <name>EmitA</name>\n"
+		"    <initialConditions> <radius>0.5</radius> <position> <x>-1</x> <y>0</y> <z>0</z> </position> <direction> <x>0</x> <y>0</y> <z>-1</z> </direction> <speed>0</speed> </initialConditions>\n"
+		"    <goalSequence> <seekStaticTarget> <targetLocation> <x>-1</x> <y>0</y> <z>1</z> </targetLocation> <desiredSpeed>1.3</desiredSpeed> <timeDuration>1000.0</timeDuration> </seekStaticTarget> </goalSequence>\n"
+		"  </agentEmitter>\n"
+		"  <agentRegion>\n"
+		"    <numAgents>20</numAgents>\n"
+		"    <regionBounds> <xmin>-45</xmin> <xmax>-35</xmax> <ymin>0</ymin> <ymax>0</ymax> <zmin>30</zmin> <zmax>45</zmax> </regionBounds>\n"
+		"    <initialConditions> <radius>0.5</radius> <direction> <random>true</random> </direction> <speed>0</speed> </initialConditions>\n"
+		"    <goalSequence> <seekStaticTarget> <targetLocation> <x>40</x> <y>0</y> <z>40</z> </targetLocation> <desiredSpeed>1.3</desiredSpeed> <timeDuration>1000.0</timeDuration> </seekStaticTarget> </goalSequence>\n"
+		"  </agentRegion>\n"
+		"</SteerBenchTestCase>\n";
+	xmlFile.close();
+
+	TestCaseReader xmlTestCase;
+	xmlTestCase.setRandomSeed(11);
+	xmlTestCase.readTestCaseFromFile(xmlFilename);
+	TestCaseBinaryWriter().writeBinaryTestCase(binaryFilename, xmlTestCase, xmlFilename);
+
+	if (!TestCaseReader::isAValidBinaryTestCase(binaryFilename)) {
+		throw GenericException("FAILED: " + binaryFilename + " is not recognized as a compiled test case.");
+	}
+	// a different seed makes sure that nothing random is resolved a second time when the compiled file is read.
+	TestCaseReader binaryTestCase;
+	binaryTestCase.setRandomSeed(12);
+	binaryTestCase.readTestCaseFromFile(binaryFilename);
+
+	if ((xmlTestCase.getTestCaseName() != binaryTestCase.getTestCaseName()) || (xmlTestCase.getDescription() != binaryTestCase.getDescription()) ||
+		(xmlTestCase.getVersion() != binaryTestCase.getVersion()) || (xmlTestCase.getPassingCriteria() != binaryTestCase.getPassingCriteria())) {
+		throw GenericException("FAILED: the header of the compiled test case is different.");
+	}
+	const AxisAlignedBox & xmlBounds = xmlTestCase.getWorldBounds();
+	const AxisAlignedBox & binaryBounds = binaryTestCase.getWorldBounds();
+	if ((xmlBounds.xmin != binaryBounds.xmin) || (xmlBounds.xmax != binaryBounds.xmax) || (xmlBounds.ymin != binaryBounds.ymin) ||
+		(xmlBounds.ymax != binaryBounds.ymax) || (xmlBounds.zmin != binaryBounds.zmin) || (xmlBounds.zmax != binaryBounds.zmax)) {
+		throw GenericException("FAILED: the world bounds of the compiled test case are different.");
+	}
+
+	if (xmlTestCase.getNumCameraViews() != binaryTestCase.getNumCameraViews()) {
+		throw GenericException("FAILED: the compiled test case has " + toString(binaryTestCase.getNumCameraViews()) + " camera views, expected " + toString(xmlTestCase.getNumCameraViews()) + ".");
+	}
+	for (unsigned int i=0; i < xmlTestCase.getNumCameraViews(); i++) {
+		const CameraView & xmlView = xmlTestCase.getCameraView(i);
+		const CameraView & binaryView = binaryTestCase.getCameraView(i);
+		if ((xmlView.position != binaryView.position) || (xmlView.lookat != binaryView.lookat) || (xmlView.up != binaryView.up) || (xmlView.fovy != binaryView.fovy)) {
+			throw GenericException("FAILED: camera view " + toString(i) + " of the compiled test case is different.");
+		}
+	}
+
+	if ((xmlTestCase.getNumAgents() != binaryTestCase.getNumAgents()) || (xmlTestCase.getNumAgentEmitters() != binaryTestCase.getNumAgentEmitters())) {
+		throw GenericException("FAILED: the compiled test case has " + toString(binaryTestCase.getNumAgents()) + " agents and " + toString(binaryTestCase.getNumAgentEmitters()) +
+			" agent emitters, expected " + toString(xmlTestCase.getNumAgents()) + " and " + toString(xmlTestCase.getNumAgentEmitters()) + ".");
+	}
+	for (unsigned int i=0; i < xmlTestCase.getNumAgents(); i++) {
+		_compareAgents(xmlTestCase.getAgentInitialConditions(i), binaryTestCase.getAgentInitialConditions(i), "agent " + toString(i));
+	}
+	for (unsigned int i=0; i < xmlTestCase.getNumAgentEmitters(); i++) {
+		_compareAgents(xmlTestCase.getAgentEmitterInitialConditions(i), binaryTestCase.getAgentEmitterInitialConditions(i), "agent emitter " + toString(i));
+	}
+
+	if (xmlTestCase.getNumObstacles() != binaryTestCase.getNumObstacles()) {
+		throw GenericException("FAILED: the compiled test case has " + toString(binaryTestCase.getNumObstacles()) + " obstacles, expected " + toString(xmlTestCase.getNumObstacles()) + ".");
+	}
+	for (unsigned int i=0; i < xmlTestCase.getNumObstacles(); i++) {
+		_compareObstacles(xmlTestCase.getObstacleInitialConditions(i), binaryTestCase.getObstacleInitialConditions(i), "obstacle " + toString(i));
+	}
+
+	std::cout << xmlTestCase.getNumAgents() << " agents, " << xmlTestCase.getNumAgentEmitters() << " agent emitters and " << xmlTestCase.getNumObstacles() << " obstacles are identical after compiling.\n";
+
+	// a MovingAI map becomes a single grid map obstacle; its width is not a multiple of 32, so each row of the bitmap is padded.
+	const std::string mapFilename = "binarytestcase-unittest.map";
+	MTRand randomNumberGenerator(5);
+	std::ofstream mapFile(mapFilename.c_str());
+	mapFile << "type octile\nheight 23\nwidth 37\nmap\n";
+	for (unsigned int z=0; z < 23; z++) {
+		for (unsigned int x=0; x < 37; x++) {
+			mapFile << ((randomNumberGenerator.rand() < 0.3) ? '@' : '.');
+		}
+		mapFile << "\n";
+	}
+	mapFile.close();
+
+	TestCaseReader mapTestCase;
+	mapTestCase.readTestCaseFromFile(mapFilename);
+	TestCaseBinaryWriter().writeBinaryTestCase(binaryFilename, mapTestCase, mapFilename);
+	TestCaseReader binaryMapTestCase;
+	binaryMapTestCase.readTestCaseFromFile(binaryFilename);
+	if ((mapTestCase.getNumObstacles() != 1) || (binaryMapTestCase.getNumObstacles() != 1)) {
+		throw GenericException("FAILED: the map was read as " + toString(mapTestCase.getNumObstacles()) + " obstacles, and compiled into " + toString(binaryMapTestCase.getNumObstacles()) + " obstacles.");
+	}
+	_compareObstacles(mapTestCase.getObstacleInitialConditions(0), binaryMapTestCase.getObstacleInitialConditions(0), "the grid map");
+	std::cout << "the grid map is identical after compiling.\n";
+
+	remove(xmlFilename.c_str());
+	remove(mapFilename.c_str());
+	remove(binaryFilename.c_str());
+}
+
+void BinaryTestCaseTest::_compareAgents(const AgentInitialConditions & xmlAgent, const AgentInitialConditions & binaryAgent, const std::string & agentName)
+{
+	const AxisAlignedBox & xmlBox = xmlAgent.randBox;
+	const AxisAlignedBox & binaryBox = binaryAgent.randBox;
+	if ((xmlAgent.name != binaryAgent.name) || (xmlAgent.position != binaryAgent.position) || (xmlAgent.direction != binaryAgent.direction) ||
+		(xmlAgent.radius != binaryAgent.radius) || (xmlAgent.speed != binaryAgent.speed) || (xmlAgent.colorSet != binaryAgent.colorSet) ||
+		(xmlAgent.colorSet && ((xmlAgent.color.r != binaryAgent.color.r) || (xmlAgent.color.g != binaryAgent.color.g) || (xmlAgent.color.b != binaryAgent.color.b)))) {
+		throw GenericException("FAILED: the initial conditions of " + agentName + " of the compiled test case are different.");
+	}
+	if ((xmlAgent.fromRandom != binaryAgent.fromRandom) || (xmlAgent.fromRandom && ((xmlBox.xmin != binaryBox.xmin) || (xmlBox.xmax != binaryBox.xmax) ||
+		(xmlBox.ymin != binaryBox.ymin) || (xmlBox.ymax != binaryBox.ymax) || (xmlBox.zmin != binaryBox.zmin) || (xmlBox.zmax != binaryBox.zmax)))) {
+		throw GenericException("FAILED: the random region of " + agentName + " of the compiled test case is different.");
+	}
+
+	if (xmlAgent.goals.size() != binaryAgent.goals.size()) {
+		throw GenericException("FAILED: " + agentName + " of the compiled test case has " + toString(binaryAgent.goals.size()) + " goals, expected " + toString(xmlAgent.goals.size()) + ".");
+	}
+	for (unsigned int i=0; i < xmlAgent.goals.size(); i++) {
+		const AgentGoalInfo & xmlGoal = xmlAgent.goals[i];
+		const AgentGoalInfo & binaryGoal = binaryAgent.goals[i];
+		const AxisAlignedBox & xmlRegion = xmlGoal.targetRegion;
+		const AxisAlignedBox & binaryRegion = binaryGoal.targetRegion;
+		if ((xmlGoal.goalType != binaryGoal.goalType) || (xmlGoal.targetIsRandom != binaryGoal.targetIsRandom) || (xmlGoal.timeDuration != binaryGoal.timeDuration) ||
+			(xmlGoal.desiredSpeed != binaryGoal.desiredSpeed) || (xmlGoal.targetLocation != binaryGoal.targetLocation) || (xmlGoal.targetName != binaryGoal.targetName) ||
+			(xmlGoal.targetDirection != binaryGoal.targetDirection) || (xmlGoal.flowType != binaryGoal.flowType)) {
+			throw GenericException("FAILED: goal " + toString(i) + " of " + agentName + " of the compiled test case is different.");
+		}
+		if ((xmlRegion.xmin != binaryRegion.xmin) || (xmlRegion.xmax != binaryRegion.xmax) || (xmlRegion.ymin != binaryRegion.ymin) ||
+			(xmlRegion.ymax != binaryRegion.ymax) || (xmlRegion.zmin != binaryRegion.zmin) || (xmlRegion.zmax != binaryRegion.zmax)) {
+			throw GenericException("FAILED: the target region of goal " + toString(i) + " of " + agentName + " of the compiled test case is different.");
+		}
+
+		std::vector<BehaviourParameter> xmlParameters = xmlGoal.targetBehaviour.getParameters();
+		std::vector<BehaviourParameter> binaryParameters = binaryGoal.targetBehaviour.getParameters();
+		if ((xmlGoal.targetBehaviour.getSteeringAlg() != binaryGoal.targetBehaviour.getSteeringAlg()) || (xmlParameters.size() != binaryParameters.size())) {
+			throw GenericException("FAILED: the behaviour of goal " + toString(i) + " of " + agentName + " of the compiled test case is different.");
+		}
+		for (unsigned int p=0; p < xmlParameters.size(); p++) {
+			if ((xmlParameters[p].key != binaryParameters[p].key) || (xmlParameters[p].value != binaryParameters[p].value)) {
+				throw GenericException("FAILED: behaviour parameter " + toString(p) + " of goal " + toString(i) + " of " + agentName + " of the compiled test case is different.");
+			}
+		}
+	}
+}
+
+void BinaryTestCaseTest::_compareObstacles(const ObstacleInitialConditions * xmlObstacle, const ObstacleInitialConditions * binaryObstacle, const std::string & obstacleName)
+{
+	bool identical = false;
+
+	// test the derived wall type before its oriented box base class.
+	if (const OrientedWallObstacleInitialConditions * xmlWall = dynamic_cast<const OrientedWallObstacleInitialConditions*>(xmlObstacle)) {
+		const OrientedWallObstacleInitialConditions * binaryWall = dynamic_cast<const OrientedWallObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryWall != NULL) && (xmlWall->position == binaryWall->position) && (xmlWall->lengthX == binaryWall->lengthX) && (xmlWall->lengthZ == binaryWall->lengthZ) &&
+			(xmlWall->height == binaryWall->height) && (xmlWall->thetaY == binaryWall->thetaY) && (xmlWall->doorLocation == binaryWall->doorLocation) && (xmlWall->doorRadius == binaryWall->doorRadius);
+	}
+	else if (const OrientedBoxObstacleInitialConditions * xmlOrientedBox = dynamic_cast<const OrientedBoxObstacleInitialConditions*>(xmlObstacle)) {
+		const OrientedBoxObstacleInitialConditions * binaryOrientedBox = dynamic_cast<const OrientedBoxObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryOrientedBox != NULL) && (dynamic_cast<const OrientedWallObstacleInitialConditions*>(binaryObstacle) == NULL) &&
+			(xmlOrientedBox->position == binaryOrientedBox->position) && (xmlOrientedBox->lengthX == binaryOrientedBox->lengthX) && (xmlOrientedBox->lengthZ == binaryOrientedBox->lengthZ) &&
+			(xmlOrientedBox->height == binaryOrientedBox->height) && (xmlOrientedBox->thetaY == binaryOrientedBox->thetaY);
+	}
+	else if (const BoxObstacleInitialConditions * xmlBox = dynamic_cast<const BoxObstacleInitialConditions*>(xmlObstacle)) {
+		const BoxObstacleInitialConditions * binaryBox = dynamic_cast<const BoxObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryBox != NULL) && (xmlBox->xmin == binaryBox->xmin) && (xmlBox->xmax == binaryBox->xmax) && (xmlBox->ymin == binaryBox->ymin) &&
+			(xmlBox->ymax == binaryBox->ymax) && (xmlBox->zmin == binaryBox->zmin) && (xmlBox->zmax == binaryBox->zmax);
+	}
+	else if (const CircleObstacleInitialConditions * xmlCircle = dynamic_cast<const CircleObstacleInitialConditions*>(xmlObstacle)) {
+		const CircleObstacleInitialConditions * binaryCircle = dynamic_cast<const CircleObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryCircle != NULL) && (xmlCircle->position == binaryCircle->position) && (xmlCircle->radius == binaryCircle->radius) && (xmlCircle->height == binaryCircle->height);
+	}
+	else if (const PolygonObstacleInitialConditions * xmlPolygon = dynamic_cast<const PolygonObstacleInitialConditions*>(xmlObstacle)) {
+		const PolygonObstacleInitialConditions * binaryPolygon = dynamic_cast<const PolygonObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryPolygon != NULL) && (xmlPolygon->_vertices == binaryPolygon->_vertices);
+	}
+	else if (const GridMapObstacleInitialConditions * xmlGridMap = dynamic_cast<const GridMapObstacleInitialConditions*>(xmlObstacle)) {
+		const GridMapObstacleInitialConditions * binaryGridMap = dynamic_cast<const GridMapObstacleInitialConditions*>(binaryObstacle);
+		identical = (binaryGridMap != NULL) && (xmlGridMap->map.getOriginX() == binaryGridMap->map.getOriginX()) && (xmlGridMap->map.getOriginZ() == binaryGridMap->map.getOriginZ()) &&
+			(xmlGridMap->map.getCellSize() == binaryGridMap->map.getCellSize()) && (xmlGridMap->map.getNumCellsX() == binaryGridMap->map.getNumCellsX()) &&
+			(xmlGridMap->map.getNumCellsZ() == binaryGridMap->map.getNumCellsZ()) && (xmlGridMap->map.getNumBlockedCells() == binaryGridMap->map.getNumBlockedCells());
+		for (unsigned int x=0; identical && (x < xmlGridMap->map.getNumCellsX()); x++) {
+			for (unsigned int z=0; z < xmlGridMap->map.getNumCellsZ(); z++) {
+				identical = identical && (xmlGridMap->map.isBlocked(x, z) == binaryGridMap->map.isBlocked(x, z));
+			}
+		}
+	}
+	else {
+		throw GenericException("FAILED: " + obstacleName + " has a type that the test does not know.");
+	}
+
+	if (!identical) {
+		throw GenericException("FAILED: " + obstacleName + " of the compiled test case is different.");
+	}
+}
+
+const float SimulationSnapshotTest::NEW_ENGINE_TOLERANCE = 0.0001f;
+
+void SimulationSnapshotTest::runTest()
+{
+	_runTest("sfAI");
+	_runTest("rvo2AI");
+	_runTest("pprAI");
+}
+
+void SimulationSnapshotTest::_runTest(const std::string & aiModuleName)
+{
+	const std::string snapshotFilename = "snapshot-unittest.snapshot";
+
+	SimulationOptions options;
+	SimulationEngine * engine = _createEngine(options, aiModuleName);
+	AgentTrajectories warmupTrajectories;
+	_simulateFrames(engine, NUM_WARMUP_FRAMES, warmupTrajectories);
+
+	SimulationSnapshot snapshot;
+	engine->saveSnapshot(snapshot);
+	snapshot.writeToFile(snapshotFilename);
+	AgentTrajectories expectedTrajectories;
+	_simulateFrames(engine, NUM_BRANCH_FRAMES, expectedTrajectories);
+
+	// branch again from the same engine, after it has moved on.
+	engine->restoreSnapshot(snapshot);
+	if (engine->getClock().getCurrentFrameNumber() != snapshot.getFrameNumber()) {
+		throw GenericException("FAILED: the " + aiModuleName + " simulation is at frame " + toString(engine->getClock().getCurrentFrameNumber()) + " after restoring a snapshot of frame " + toString(snapshot.getFrameNumber()) + ".");
+	}
+	AgentTrajectories restoredTrajectories;
+	_simulateFrames(engine, NUM_BRANCH_FRAMES, restoredTrajectories);
+	_compareTrajectories(expectedTrajectories, restoredTrajectories, aiModuleName + " restored into the same engine", 0.0f);
+
+	SimulationSnapshot snapshotFromFile;
+	snapshotFromFile.readFromFile(snapshotFilename);
+	engine->restoreSnapshot(snapshotFromFile);
+	AgentTrajectories restoredFromFileTrajectories;
+	_simulateFrames(engine, NUM_BRANCH_FRAMES, restoredFromFileTrajectories);
+	_compareTrajectories(expectedTrajectories, restoredFromFileTrajectories, aiModuleName + " restored from a file into the same engine", 0.0f);
+	_destroyEngine(engine);
+
+	// a new engine that only loaded the same test case.  The AI modules visit neighbors in the order of their addresses, which
+	// differ between engines, so forces are summed in a different order and the trajectories are only identical up to rounding.
+	SimulationOptions newOptions;
+	SimulationEngine * newEngine = _createEngine(newOptions, aiModuleName);
+	newEngine->restoreSnapshot(snapshotFromFile);
+	AgentTrajectories newEngineTrajectories;
+	_simulateFrames(newEngine, NUM_BRANCH_FRAMES, newEngineTrajectories);
+	_compareTrajectories(expectedTrajectories, newEngineTrajectories, aiModuleName + " restored from a file into a new engine", NEW_ENGINE_TOLERANCE);
+	_destroyEngine(newEngine);
+
+	remove(snapshotFilename.c_str());
+	std::cout << aiModuleName << ": " << snapshot.getNumAgents() << " agents re-simulated " << NUM_BRANCH_FRAMES << " frames from a snapshot of frame " << snapshot.getFrameNumber() << ".\n";
+}
+
+SimulationEngine * SimulationSnapshotTest::_createEngine(SimulationOptions & options, const std::string & aiModuleName)
+{
+	return SimulationTrajectoryTest::_createEngine(options, "oncoming-groups", aiModuleName, NUM_WARMUP_FRAMES + 2 * NUM_BRANCH_FRAMES);
+}
+
+const unsigned int SocialForcesBatchTest::NUM_FRAMES;
+const float SocialForcesBatchTest::TOLERANCE = 0.0001f;
+
+void SocialForcesBatchTest::runTest()
+{
+	_runTest("oncoming-groups");
+	_runTest("hallway-one-way");
+	_runTest("4-way-oncomming-circle-obstacle");
+}
+
+void SocialForcesBatchTest::_runTest(const std::string & testCaseName)
+{
+	// the engine stops on its last frame, so it is given one more frame than is simulated.
+	SimulationOptions options;
+	options.moduleOptionsDatabase["sfAI"]["batch_check"] = "true";
+	options.moduleOptionsDatabase["sfAI"]["batch_check_tolerance"] = toString(TOLERANCE);
+	SimulationEngine * engine = _createEngine(options, testCaseName, "sfAI", NUM_FRAMES + 1);
+	AgentTrajectories trajectories;
+	_simulateFrames(engine, NUM_FRAMES, trajectories);
+
+	// the module adds the results of the check to its data when the simulation is cleaned up.
+	engine->postprocessSimulation();
+	engine->cleanupSimulation();
+	std::istringstream data(engine->getModule("sfAI")->getData());
+	engine->finish();
+	delete engine;
+
+	std::string line;
+	while (std::getline(data, line) && (line.compare(0, 12, "batch_check ") != 0)) { }
+	std::istringstream results(line);
+	std::string label;
+	unsigned int numFrames = 0;
+	unsigned int numFailedFrames = 0;
+	float maxError = 0.0f;
+	if (!(results >> label >> numFrames >> numFailedFrames >> maxError)) {
+		throw GenericException("FAILED: sfAI did not report the results of batch_check on " + testCaseName + ".");
+	}
+	if (numFrames != NUM_FRAMES) {
+		throw GenericException("FAILED: sfAI checked " + toString(numFrames) + " of " + toString(NUM_FRAMES) + " frames on " + testCaseName + ".");
+	}
+	if (numFailedFrames != 0) {
+		throw GenericException("FAILED: on " + testCaseName + ", " + toString(numFailedFrames) + " frames of sfAI batch mode differ from the scalar forces by more than "
+			+ toString(TOLERANCE) + " (largest difference " + toString(maxError) + ").");
+	}
+	std::cout << testCaseName << ": the batch forces of " << NUM_FRAMES << " frames agree with the scalar forces within " << TOLERANCE
+		<< " (largest difference " << maxError << ").\n";
+}
+
+const unsigned int RVO2DBatchTest::NUM_FRAMES;
+const unsigned int RVO2DBatchTest::NUM_THREADS;
+
+void RVO2DBatchTest::runTest()
+{
+	_runTest("oncoming-groups");
+	_runTest("hallway-one-way");
+	_runTest("4-way-oncomming-circle-obstacle");
+}
+
+void RVO2DBatchTest::_runTest(const std::string & testCaseName)
+{
+	// the engine stops on its last frame, so it is given one more frame than is simulated.
+	SimulationOptions options;
+	options.moduleOptionsDatabase["rvo2AI"]["start_of_frame"] = "true";
+	SimulationEngine * engine = _createEngine(options, testCaseName, "rvo2AI", NUM_FRAMES + 1);
+	AgentTrajectories perAgentTrajectories;
+	_simulateFrames(engine, NUM_FRAMES, perAgentTrajectories);
+	_destroyEngine(engine);
+
+	SimulationOptions batchOptions;
+	batchOptions.moduleOptionsDatabase["rvo2AI"]["batch"] = "true";
+	batchOptions.moduleOptionsDatabase["rvo2AI"]["batch_threads"] = toString(NUM_THREADS);
+	SimulationEngine * batchEngine = _createEngine(batchOptions, testCaseName, "rvo2AI", NUM_FRAMES + 1);
+	AgentTrajectories batchTrajectories;
+	_simulateFrames(batchEngine, NUM_FRAMES, batchTrajectories);
+	_destroyEngine(batchEngine);
+
+	_compareTrajectories(perAgentTrajectories, batchTrajectories, "rvo2AI batch mode on " + testCaseName, 0.0f);
+	std::cout << testCaseName << ": " << NUM_FRAMES << " frames of rvo2AI batch mode on " << NUM_THREADS << " threads are identical to the per-agent start_of_frame update.\n";
+}
+
+const unsigned int RVO2DAvoidanceTest::MAX_FRAMES;
+const float RVO2DAvoidanceTest::MAX_PENETRATION = 0.05f;
+
+void RVO2DAvoidanceTest::runTest()
+{
+	_runTest("3-squeeze");
+	_runTest("doorway-two-way");
+	_runTest("4-way-confusion-obstacle");
+}
+
+void RVO2DAvoidanceTest::_runTest(const std::string & testCaseName)
+{
+	SimulationOptions options;
+	SimulationEngine * engine = _createEngine(options, testCaseName, "rvo2AI", MAX_FRAMES);
+	float maxAgentPenetration = 0.0f;
+	float maxObstaclePenetration = 0.0f;
+	while (engine->update(false)) {
+		const std::vector<AgentInterface*> & agents = engine->getAgents();
+		const std::set<ObstacleInterface*> & obstacles = engine->getObstacles();
+		for (unsigned int a=0; a < agents.size(); a++) {
+			if (!agents[a]->enabled()) continue;
+			for (unsigned int b=a+1; b < agents.size(); b++) {
+				if (!agents[b]->enabled()) continue;
+				float penetration = agents[a]->radius() + agents[b]->radius() - (agents[a]->position() - agents[b]->position()).length();
+				maxAgentPenetration = std::max(maxAgentPenetration, penetration);
+			}
+			for (std::set<ObstacleInterface*>::const_iterator obstacle = obstacles.begin(); obstacle != obstacles.end(); ++obstacle) {
+				maxObstaclePenetration = std::max(maxObstaclePenetration, (*obstacle)->computePenetration(agents[a]->position(), agents[a]->radius()));
+			}
+		}
+	}
+	unsigned int numFrames = engine->getClock().getCurrentFrameNumber();
+	_destroyEngine(engine);
+
+	if (maxAgentPenetration > MAX_PENETRATION) {
+		throw GenericException("FAILED: rvo2AI agents on " + testCaseName + " overlapped each other by " + toString(maxAgentPenetration) + " m.");
+	}
+	if (maxObstaclePenetration > MAX_PENETRATION) {
+		throw GenericException("FAILED: rvo2AI agents on " + testCaseName + " overlapped an obstacle by " + toString(maxObstaclePenetration) + " m.");
+	}
+	std::cout << testCaseName << ": in " << numFrames << " frames, rvo2AI agents overlapped other agents by at most " << maxAgentPenetration
+		<< " m and obstacles by at most " << maxObstaclePenetration << " m.\n";
+}
+
+std::string SimulationTrajectoryTest::testCaseSearchPath;
+std::string SimulationTrajectoryTest::moduleSearchPath;
+
+SimulationEngine * SimulationTrajectoryTest::_createEngine(SimulationOptions & options, const std::string & testCaseName, const std::string & aiModuleName, unsigned int numFrames)
+{
+	if (testCaseSearchPath != "") {
+		options.engineOptions.testCaseSearchPath = testCaseSearchPath;
+	}
+	if (moduleSearchPath != "") {
+		options.engineOptions.moduleSearchPath = moduleSearchPath;
+	}
+	options.engineOptions.startupModules.clear();
+	options.engineOptions.startupModules.insert("testCasePlayer");
+	options.engineOptions.numFramesToSimulate = numFrames;
+	options.moduleOptionsDatabase["testCasePlayer"]["testcase"] = testCaseName;
+	options.moduleOptionsDatabase["testCasePlayer"]["ai"] = aiModuleName;
+
+	SimulationEngine * engine = new SimulationEngine();
+	engine->init(&options, &_engineController);
+	engine->initializeSimulation();
+	engine->preprocessSimulation();
+	return engine;
+}
+
+void SimulationTrajectoryTest::_destroyEngine(SimulationEngine * engine)
+{
+	engine->postprocessSimulation();
+	engine->cleanupSimulation();
+	engine->finish();
+	delete engine;
+}
+
+void SimulationTrajectoryTest::_simulateFrames(SimulationEngine * engine, unsigned int numFrames, AgentTrajectories & trajectories)
+{
+	for (unsigned int i=0; i < numFrames; i++) {
+		if (!engine->update(false)) {
+			throw GenericException("FAILED: the simulation stopped after " + toString(i) + " of " + toString(numFrames) + " frames.");
+		}
+		const std::vector<AgentInterface*> & agents = engine->getAgents();
+		for (unsigned int a=0; a < agents.size(); a++) {
+			trajectories.positions.push_back(agents[a]->position());
+			trajectories.velocities.push_back(agents[a]->velocity());
+			trajectories.enabled.push_back(agents[a]->enabled());
+		}
+	}
+}
+
+void SimulationTrajectoryTest::_compareTrajectories(const AgentTrajectories & expected, const AgentTrajectories & actual, const std::string & name, float tolerance)
+{
+	if (expected.positions.size() != actual.positions.size()) {
+		throw GenericException("FAILED: " + name + " recorded " + toString(actual.positions.size()) + " agent states, expected " + toString(expected.positions.size()) + ".");
+	}
+	for (unsigned int i=0; i < expected.positions.size(); i++) {
+		float positionError = (expected.positions[i] - actual.positions[i]).length();
+		float velocityError = (expected.velocities[i] - actual.velocities[i]).length();
+		if ((positionError > tolerance) || (velocityError > tolerance) || (expected.enabled[i] != actual.enabled[i])) {
+			throw GenericException("FAILED: " + name + " diverged at agent state " + toString(i) + ": position " + toString(actual.positions[i]) + ", expected " + toString(expected.positions[i]) + " (error " + toString(positionError) + ").");
+		}
+	}
+}
+
 void FileUtilTest::runTest()
 {
 	if (!pathExists(".")) {